@@ -0,0 +1,1628 @@
+#include "csv_viewer_screen.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "fs_csv.h"
+#include "fs_text_ops.h"
+#include "esp_log.h"
+#include "styles.h"
+
+#define CSV_VIEWER_PAGE_BYTES       (8 * 1024)  /* Parsed records around the view */
+#define CSV_VIEWER_PAGE_ROWS        64          /* Records kept in the page at most */
+#define CSV_VIEWER_SAMPLE_ROWS      64          /* Leading records measured for the column widths */
+#define CSV_VIEWER_CELL_PAD         4           /* Pixels left and right of a cell's text */
+#define CSV_VIEWER_MIN_COL_DIGITS   3           /* Narrowest column, in digit widths */
+#define CSV_VIEWER_SLIDER_STEPS     1000
+#define CSV_VIEWER_THROW_PERIOD_MS  20
+#define CSV_VIEWER_THROW_DECAY      10          /* Percent of the fling speed lost per period */
+#define CSV_VIEWER_TAP_SLOP         6           /* Pixels a press may travel and still select a column */
+#define CSV_VIEWER_INDEX_POLL_MS    200
+#define CSV_VIEWER_JOB_POLL_MS      100
+#define CSV_VIEWER_STATUS_HOLD      10          /* Index polls a message stays before the row count returns */
+
+/**
+ * @brief One record of the page.
+ */
+typedef struct
+{
+    uint32_t offset;                            /**< File offset of the record */
+    uint32_t number;                            /**< Data row number shown in the gutter (1 is the first row after the header) */
+    uint8_t fields;                             /**< Fields split out of the record */
+} csv_viewer_row_t;
+
+/**
+ * @brief Buffers allocated while the viewer is open.
+ */
+typedef struct
+{
+    char page[CSV_VIEWER_PAGE_BYTES];           /**< Records of the page, split in place */
+    uint16_t cells[CSV_VIEWER_PAGE_ROWS][FS_CSV_MAX_FIELDS]; /**< Field starts in @c page, per page row */
+    csv_viewer_row_t rows[CSV_VIEWER_PAGE_ROWS];
+    char header[FS_CSV_MAX_RECORD + 1];         /**< First record, split in place */
+    uint16_t header_cells[FS_CSV_MAX_FIELDS];   /**< Field starts in @c header */
+} csv_viewer_buffers_t;
+
+/**
+ * @brief Dialogs sharing the single prompt of the screen.
+ */
+typedef enum
+{
+    CSV_VIEWER_DIALOG_NONE = 0,
+    CSV_VIEWER_DIALOG_GOTO,
+    CSV_VIEWER_DIALOG_STATS,
+} csv_viewer_dialog_t;
+
+/**
+ * @brief Runtime state for the singleton CSV viewer screen.
+ */
+typedef struct
+{
+    bool active;                                /**< True while the viewer screen is active */
+    fs_text_reader_t reader;                    /**< Open file (the index task has its own handle) */
+    csv_viewer_buffers_t *buf;                  /**< Page and header buffers */
+    char delim;                                 /**< Field delimiter guessed from the header */
+    size_t columns;                             /**< Fields in the header (0 for an empty file) */
+    size_t data_offset;                         /**< File offset of the first record after the header */
+    int32_t text_w[FS_CSV_MAX_FIELDS];          /**< Widest text of each column in the sample */
+    int32_t col_x[FS_CSV_MAX_FIELDS + 1];       /**< Left edge of each column; col_x[columns] is the table width */
+    uint32_t page_first;                        /**< Row the page starts at, UINT32_MAX if stale */
+    uint32_t page_rows;                         /**< Rows in the page */
+    size_t page_next;                           /**< File offset after the last page record */
+    uint32_t rows_total;                        /**< Data rows indexed so far */
+    uint8_t index_percent;                      /**< Progress of the index scan */
+    bool index_failed;                          /**< The scan stopped early; @c rows_total is what it saw */
+    fs_csv_sort_entry_t *sorted;                /**< Rows in sort order, NULL in file order */
+    uint32_t sorted_count;
+    size_t sort_col;                            /**< Column @c sorted is ordered by */
+    bool sort_desc;                             /**< @c sorted is in descending order */
+    uint32_t top_row;                           /**< Row at the top of the body */
+    int32_t top_px;                             /**< Pixels of @c top_row scrolled out above the body */
+    int32_t scroll_x;                           /**< Pixels of the table scrolled out on the left */
+    uint32_t rows_visible;                      /**< Rows drawn (the last one may be cut) */
+    int32_t row_h;                              /**< Row height in pixels (the header takes one) */
+    int32_t view_h;                             /**< Content height of the view */
+    int32_t view_w;                             /**< Content width of the view */
+    int32_t num_w;                              /**< Width of the row number gutter */
+    int num_digits;                             /**< Digits the gutter is sized for */
+    const lv_font_t *font;                      /**< Font the table is drawn with */
+    int32_t letter_space;
+    int selected;                               /**< Selected column, -1 if none */
+    int32_t throw_vx;                           /**< Fling speed in pixels per period */
+    int32_t throw_vy;
+    int32_t drag_dist;                          /**< Pixels travelled since the press */
+    lv_timer_t *throw_timer;                    /**< Timer carrying the fling after release */
+    lv_timer_t *index_timer;                    /**< Timer polling the index, NULL once it is complete */
+    lv_timer_t *column_timer;                   /**< Timer polling a sort or stats job, NULL when idle */
+    fs_csv_column_op_t column_op;               /**< Job @c column_timer waits for */
+    size_t column_col;                          /**< Column of that job */
+    uint8_t status_hold;                        /**< Index polls left before the row count replaces the status */
+    lv_obj_t *screen;                           /**< Root LVGL screen object */
+    lv_obj_t *status_label;                     /**< Label showing the row count and transient messages */
+    lv_obj_t *view;                             /**< Custom-drawn table */
+    lv_obj_t *slider;                           /**< Vertical slider over all rows */
+    lv_obj_t *keyboard;                         /**< On-screen keyboard for the go-to dialog */
+    lv_obj_t *dialog;                           /**< Go-to-row dialog or stats box */
+    lv_obj_t *dialog_textarea;                  /**< Entry inside the go-to dialog */
+    csv_viewer_dialog_t dialog_kind;            /**< Which dialog @c dialog is */
+    bool slider_suppress_change;                /**< Guard slider callbacks while syncing */
+    lv_obj_t *return_screen;                    /**< Screen to return to on close */
+    char path[FS_TEXT_MAX_PATH];                /**< Current file path */
+} csv_viewer_ctx_t;
+
+static const char *TAG = "csv_viewer";
+static csv_viewer_ctx_t s_csv;
+
+/************************************** UI Setup & State *************************************/
+
+/**
+ * @brief Build all LVGL widgets for the CSV viewer screen.
+ *
+ * @param ctx Viewer context (must be non-NULL).
+ */
+static void csv_viewer_build_screen(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Read and split the header record and guess the delimiter.
+ *
+ * @param ctx Viewer context.
+ *
+ * @return ESP_OK (also for an empty file) or ESP_FAIL if the file cannot be read.
+ */
+static esp_err_t csv_viewer_read_header(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Measure the header and the first CSV_VIEWER_SAMPLE_ROWS records for the column widths.
+ *
+ * Uses the page buffer, so the page is stale afterwards.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_measure(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Measure the font and the view, then size the gutter and the columns.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_layout(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Set the status label text.
+ *
+ * @param ctx  Viewer context.
+ * @param msg  Message (ignored if NULL).
+ * @param hold Keep it for a while instead of letting the row count replace it at the next index poll.
+ */
+static void csv_viewer_set_status(csv_viewer_ctx_t *ctx, const char *msg, bool hold);
+
+/**
+ * @brief Show the row count, the index progress or the sort order in the status label.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_show_summary(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Name of column @p col for messages ("#3" when the header cell is empty).
+ */
+static const char *csv_viewer_column_name(csv_viewer_ctx_t *ctx, size_t col, char *tmp, size_t tmp_len);
+
+/**
+ * @brief Close the file, stop the background jobs, drop the screen and return to the previous one.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_close(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief "Back" button handler.
+ *
+ * @param e LVGL event.
+ */
+static void csv_viewer_on_back(lv_event_t *e);
+
+/*********************************************************************************************/
+
+/************************************** Rows & scrolling *************************************/
+
+/**
+ * @brief Rows the view can show: the sorted rows, or the data rows indexed so far.
+ */
+static uint32_t csv_viewer_row_count(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Read and split the records of rows @p first onwards into the page.
+ *
+ * In file order the records are read in blocks from the offset of @p first
+ * (known from the current page, or looked up in the index); in sort order
+ * each record is read at its own offset.
+ *
+ * @param ctx   Viewer context.
+ * @param first First row of the page.
+ */
+static void csv_viewer_load_page(csv_viewer_ctx_t *ctx, uint32_t first);
+
+/**
+ * @brief Reload the page if it does not hold every row on screen.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_fill_rows(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Drop the page, e.g. when the row order changes.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_invalidate_page(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Current vertical scroll position and the largest one, in pixels.
+ */
+static uint64_t csv_viewer_scroll_pos(csv_viewer_ctx_t *ctx, uint64_t *out_max);
+
+/**
+ * @brief Scroll to absolute pixel position @p pos (clamped), refresh the rows and the slider.
+ *
+ * @param ctx Viewer context.
+ * @param pos Pixels from the top of the first row.
+ */
+static void csv_viewer_scroll_to(csv_viewer_ctx_t *ctx, uint64_t pos);
+
+/**
+ * @brief Scroll by @p dx, @p dy pixels (positive shows columns to the right, rows below).
+ *
+ * @param ctx Viewer context.
+ * @param dx  Horizontal pixel delta.
+ * @param dy  Vertical pixel delta.
+ */
+static void csv_viewer_scroll_by(csv_viewer_ctx_t *ctx, int32_t dx, int32_t dy);
+
+/**
+ * @brief Draw the gutter and the cells of one row (or of the header) at @p y.
+ *
+ * @param ctx    Viewer context.
+ * @param layer  Layer to draw on.
+ * @param clip   Area the row may draw in.
+ * @param x0     Left edge of the content.
+ * @param y      Top of the row.
+ * @param number Gutter text, NULL for none.
+ * @param base   Buffer the fields were split in.
+ * @param cells  Field starts in @p base.
+ * @param fields Number of fields.
+ */
+static void csv_viewer_draw_row(csv_viewer_ctx_t *ctx, lv_layer_t *layer, const lv_area_t *clip, int32_t x0,
+                                int32_t y, const char *number, const char *base, const uint16_t *cells,
+                                size_t fields);
+
+/**
+ * @brief Draw the visible rows with the header pinned on top.
+ *
+ * @param e LVGL event (LV_EVENT_DRAW_MAIN).
+ */
+static void csv_viewer_on_draw(lv_event_t *e);
+
+/**
+ * @brief Drag-to-scroll, fling, tap-to-select and resize handling of the view.
+ *
+ * @param e LVGL event.
+ */
+static void csv_viewer_on_view_event(lv_event_t *e);
+
+/**
+ * @brief Select the column under @p point.
+ *
+ * @param ctx   Viewer context.
+ * @param point Screen coordinates of the tap.
+ */
+static void csv_viewer_select_at(csv_viewer_ctx_t *ctx, const lv_point_t *point);
+
+/**
+ * @brief Carry on a fling after release, slowing down every period.
+ *
+ * @param timer LVGL timer (user data: viewer context).
+ */
+static void csv_viewer_on_throw_timer(lv_timer_t *timer);
+
+/**
+ * @brief Stop a fling in progress.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_stop_throw(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Sync the slider with the scroll position.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_update_slider(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Slider handler: jump to the matching row.
+ *
+ * @param e LVGL event.
+ */
+static void csv_viewer_on_slider(lv_event_t *e);
+
+/*********************************************************************************************/
+
+/************************************ Index, sort & stats ************************************/
+
+/**
+ * @brief Poll the background index: grow the row count, resize the gutter, refresh the status.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_update_index(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Index poll timer.
+ *
+ * @param timer LVGL timer (user data: viewer context).
+ */
+static void csv_viewer_on_index_timer(lv_timer_t *timer);
+
+/**
+ * @brief Start @p op over the selected column on the background task.
+ *
+ * @param ctx Viewer context.
+ * @param op  Sort or stats.
+ */
+static void csv_viewer_start_column(csv_viewer_ctx_t *ctx, fs_csv_column_op_t op);
+
+/**
+ * @brief Poll the column job, show its progress and apply its result.
+ *
+ * @param timer LVGL timer (user data: viewer context).
+ */
+static void csv_viewer_on_column_timer(lv_timer_t *timer);
+
+/**
+ * @brief Cancel a column job and drop its timer.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_stop_column(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Go back to file order.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_clear_sort(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief "Sort" button handler: ascending, then descending, then file order for the selected column.
+ *
+ * @param e LVGL event.
+ */
+static void csv_viewer_on_sort(lv_event_t *e);
+
+/**
+ * @brief "Stats" button handler: min/max/mean of the selected column.
+ *
+ * @param e LVGL event.
+ */
+static void csv_viewer_on_stats(lv_event_t *e);
+
+/*********************************************************************************************/
+
+/*************************************** Dialogs *********************************************/
+
+/**
+ * @brief Show the go-to-row dialog (with the keyboard under it) or the stats box.
+ *
+ * @param ctx   Viewer context.
+ * @param kind  Dialog to show.
+ * @param stats Stats box text (CSV_VIEWER_DIALOG_STATS only).
+ */
+static void csv_viewer_show_dialog(csv_viewer_ctx_t *ctx, csv_viewer_dialog_t kind, const char *stats);
+
+/**
+ * @brief Close the dialog (if present) and hide the keyboard.
+ *
+ * @param ctx Viewer context.
+ */
+static void csv_viewer_close_dialog(csv_viewer_ctx_t *ctx);
+
+/**
+ * @brief Dialog button handler (also used by the keyboard's OK button).
+ *
+ * @param e LVGL event.
+ */
+static void csv_viewer_on_dialog(lv_event_t *e);
+
+/**
+ * @brief Keyboard cancel handler: close the dialog.
+ *
+ * @param e LVGL event.
+ */
+static void csv_viewer_on_keyboard_cancel(lv_event_t *e);
+
+/**
+ * @brief "Row" button handler.
+ *
+ * @param e LVGL event.
+ */
+static void csv_viewer_on_goto(lv_event_t *e);
+
+/*********************************************************************************************/
+
+esp_err_t csv_viewer_open(const csv_viewer_open_opts_t *opts)
+{
+    if (!opts || !opts->return_screen || !opts->path || strlen(opts->path) >= sizeof(s_csv.path))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    csv_viewer_ctx_t *ctx = &s_csv;
+    csv_viewer_buffers_t *buf = malloc(sizeof(csv_viewer_buffers_t));
+    if (!buf)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    fs_text_reader_t reader;
+    esp_err_t err = fs_text_reader_open_binary(&reader, opts->path);
+    if (err != ESP_OK)
+    {
+        free(buf);
+        return err;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->reader = reader;
+    ctx->buf = buf;
+    ctx->page_first = UINT32_MAX;
+    ctx->selected = -1;
+    ctx->return_screen = opts->return_screen;
+    strlcpy(ctx->path, opts->path, sizeof(ctx->path));
+
+    err = csv_viewer_read_header(ctx);
+    if (err == ESP_OK)
+    {
+        err = fs_csv_index_start(ctx->path);
+    }
+    if (err != ESP_OK)
+    {
+        fs_text_reader_close(&ctx->reader);
+        free(ctx->buf);
+        ctx->buf = NULL;
+        return err;
+    }
+    ctx->active = true;
+
+    csv_viewer_build_screen(ctx);
+    lv_screen_load(ctx->screen);
+    lv_obj_update_layout(ctx->screen);
+    csv_viewer_measure(ctx);
+    csv_viewer_layout(ctx);
+    csv_viewer_scroll_to(ctx, 0);
+
+    ctx->index_timer = lv_timer_create(csv_viewer_on_index_timer, CSV_VIEWER_INDEX_POLL_MS, ctx);
+    csv_viewer_update_index(ctx);
+    return ESP_OK;
+}
+
+static void csv_viewer_build_screen(csv_viewer_ctx_t *ctx)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(scr, UI_COLOR_BG_DARK, 0);
+    lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, 0);
+    lv_obj_set_style_text_color(scr, UI_COLOR_TEXT_DARK, 0);
+    lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(scr, 2, 0);
+    lv_obj_set_style_pad_gap(scr, 5, 0);
+    lv_obj_set_flex_flow(scr, LV_FLEX_FLOW_COLUMN);
+    ctx->screen = scr;
+
+    lv_obj_t *toolbar = lv_obj_create(scr);
+    lv_obj_remove_style_all(toolbar);
+    lv_obj_set_size(toolbar, LV_PCT(100), LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(toolbar, LV_FLEX_FLOW_ROW);
+    lv_obj_set_style_pad_gap(toolbar, 3, 0);
+    lv_obj_set_flex_align(toolbar, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_bg_color(toolbar, UI_COLOR_CARD_DARK, 0);
+    lv_obj_set_style_bg_opa(toolbar, LV_OPA_COVER, 0);
+    lv_obj_clear_flag(toolbar, LV_OBJ_FLAG_SCROLLABLE);
+
+    static const struct
+    {
+        const char *text;
+        lv_event_cb_t cb;
+    } buttons[] = {
+        {LV_SYMBOL_LEFT " Back", csv_viewer_on_back},
+        {LV_SYMBOL_RIGHT " Row", csv_viewer_on_goto},
+        {LV_SYMBOL_SHUFFLE " Sort", csv_viewer_on_sort},
+        {LV_SYMBOL_LIST " Stats", csv_viewer_on_stats},
+    };
+    for (size_t i = 0; i < sizeof(buttons) / sizeof(buttons[0]); i++)
+    {
+        lv_obj_t *btn = lv_button_create(toolbar);
+        lv_obj_set_style_radius(btn, 6, 0);
+        lv_obj_set_style_pad_all(btn, 6, 0);
+        styles_build_button(btn);
+        lv_obj_add_event_cb(btn, buttons[i].cb, LV_EVENT_CLICKED, ctx);
+        lv_obj_t *lbl = lv_label_create(btn);
+        lv_label_set_text(lbl, buttons[i].text);
+        lv_obj_set_style_text_color(lbl, UI_COLOR_TEXT_DARK, 0);
+        lv_obj_center(lbl);
+    }
+
+    ctx->status_label = lv_label_create(toolbar);
+    lv_label_set_text(ctx->status_label, "");
+    lv_label_set_long_mode(ctx->status_label, LV_LABEL_LONG_CLIP);
+    lv_obj_set_flex_grow(ctx->status_label, 1);
+    lv_obj_set_style_text_align(ctx->status_label, LV_TEXT_ALIGN_CENTER, 0);
+    lv_obj_set_style_text_color(ctx->status_label, UI_COLOR_TEXT_DARK, 0);
+
+    lv_obj_t *path_label = lv_label_create(scr);
+    lv_label_set_long_mode(path_label, LV_LABEL_LONG_SCROLL_CIRCULAR);
+    lv_obj_set_width(path_label, LV_PCT(100));
+    lv_obj_set_style_text_color(path_label, UI_COLOR_TEXT_DARK, 0);
+    lv_label_set_text(path_label, ctx->path);
+
+    lv_coord_t slider_gap = 6;
+
+    lv_obj_t *body = lv_obj_create(scr);
+    lv_obj_remove_style_all(body);
+    lv_obj_set_size(body, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_flex_flow(body, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(body, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_gap(body, slider_gap, 0);
+    lv_obj_set_style_pad_right(body, slider_gap, 0);
+    lv_obj_set_flex_grow(body, 1);
+    lv_obj_clear_flag(body, LV_OBJ_FLAG_SCROLLABLE);
+
+    /* Cells are drawn on demand: the object itself never scrolls or holds text */
+    ctx->view = lv_obj_create(body);
+    lv_obj_remove_style_all(ctx->view);
+    lv_obj_set_flex_grow(ctx->view, 1);
+    lv_obj_set_height(ctx->view, LV_PCT(100));
+    lv_obj_set_style_pad_all(ctx->view, 2, 0);
+    lv_obj_set_style_bg_color(ctx->view, UI_COLOR_CARD_DARK, 0);
+    lv_obj_set_style_bg_opa(ctx->view, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_color(ctx->view, UI_COLOR_BORDER_DARK, 0);
+    lv_obj_set_style_border_width(ctx->view, 1, 0);
+    lv_obj_set_style_text_color(ctx->view, UI_COLOR_TEXT_DARK, 0);
+    lv_obj_clear_flag(ctx->view, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(ctx->view, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(ctx->view, csv_viewer_on_draw, LV_EVENT_DRAW_MAIN, ctx);
+    lv_obj_add_event_cb(ctx->view, csv_viewer_on_view_event, LV_EVENT_PRESSED, ctx);
+    lv_obj_add_event_cb(ctx->view, csv_viewer_on_view_event, LV_EVENT_PRESSING, ctx);
+    lv_obj_add_event_cb(ctx->view, csv_viewer_on_view_event, LV_EVENT_RELEASED, ctx);
+    lv_obj_add_event_cb(ctx->view, csv_viewer_on_view_event, LV_EVENT_CLICKED, ctx);
+    lv_obj_add_event_cb(ctx->view, csv_viewer_on_view_event, LV_EVENT_SIZE_CHANGED, ctx);
+
+    lv_obj_t *slider = lv_slider_create(body);
+    lv_slider_set_orientation(slider, LV_SLIDER_ORIENTATION_VERTICAL);
+    lv_slider_set_range(slider, CSV_VIEWER_SLIDER_STEPS, 0); /* Min at top, max at bottom */
+    lv_slider_set_value(slider, 0, LV_ANIM_OFF);
+    lv_obj_set_width(slider, 14);
+    lv_obj_set_height(slider, LV_PCT(85));
+    lv_obj_set_style_pad_all(slider, 0, 0);
+    lv_obj_set_style_translate_y(slider, 2, 0);
+    lv_obj_set_style_bg_color(slider, UI_COLOR_BORDER_DARK, 0);
+    lv_obj_set_style_bg_opa(slider, LV_OPA_60, 0);
+    lv_obj_set_style_radius(slider, 8, 0);
+    lv_obj_set_style_bg_color(slider, UI_COLOR_ACCENT_BLUE_DARK, LV_PART_INDICATOR);
+    lv_obj_set_style_bg_opa(slider, LV_OPA_COVER, LV_PART_INDICATOR);
+    lv_obj_set_style_radius(slider, 8, LV_PART_INDICATOR);
+    lv_obj_set_style_bg_color(slider, UI_COLOR_ACCENT_BLUE_DARK, LV_PART_KNOB);
+    lv_obj_set_style_bg_opa(slider, LV_OPA_COVER, LV_PART_KNOB);
+    lv_obj_set_style_border_color(slider, UI_COLOR_BUTTON_BORDER_DARK, LV_PART_KNOB);
+    lv_obj_set_style_border_width(slider, 1, LV_PART_KNOB);
+    lv_obj_set_style_radius(slider, 6, LV_PART_KNOB);
+    lv_obj_set_style_width(slider, 12, LV_PART_KNOB);
+    lv_obj_set_style_height(slider, 12, LV_PART_KNOB);
+    lv_obj_add_event_cb(slider, csv_viewer_on_slider, LV_EVENT_VALUE_CHANGED, ctx);
+    lv_obj_clear_flag(slider, LV_OBJ_FLAG_SCROLL_CHAIN);
+    ctx->slider = slider;
+
+    ctx->keyboard = lv_keyboard_create(scr);
+    styles_build_keyboard(ctx->keyboard);
+    lv_keyboard_set_textarea(ctx->keyboard, NULL);
+    lv_obj_add_flag(ctx->keyboard, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_event_cb(ctx->keyboard, csv_viewer_on_keyboard_cancel, LV_EVENT_CANCEL, ctx);
+    lv_obj_add_event_cb(ctx->keyboard, csv_viewer_on_dialog, LV_EVENT_READY, ctx);
+}
+
+static esp_err_t csv_viewer_read_header(csv_viewer_ctx_t *ctx)
+{
+    csv_viewer_buffers_t *b = ctx->buf;
+    fs_csv_record_t rec;
+    size_t count = 0;
+    size_t next = 0;
+    esp_err_t err = fs_csv_read_records(&ctx->reader, 0, b->header, sizeof(b->header), &rec, 1, &count, &next);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to read the header of %s: %s", ctx->path, esp_err_to_name(err));
+        return ESP_FAIL;
+    }
+
+    ctx->delim = ',';
+    ctx->columns = 0;
+    ctx->data_offset = next;
+    if (count == 1)
+    {
+        ctx->delim = fs_csv_detect_delimiter(b->header, rec.len);
+        ctx->columns = fs_csv_split(b->header, rec.len, ctx->delim, b->header_cells, FS_CSV_MAX_FIELDS);
+    }
+    return ESP_OK;
+}
+
+static void csv_viewer_measure(csv_viewer_ctx_t *ctx)
+{
+    csv_viewer_buffers_t *b = ctx->buf;
+    ctx->font = lv_obj_get_style_text_font(ctx->view, LV_PART_MAIN);
+    ctx->letter_space = lv_obj_get_style_text_letter_space(ctx->view, LV_PART_MAIN);
+
+    lv_point_t size;
+    for (size_t c = 0; c < ctx->columns; c++)
+    {
+        lv_text_get_size(&size, b->header + b->header_cells[c], ctx->font, ctx->letter_space, 0,
+                         LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+        ctx->text_w[c] = size.x;
+    }
+
+    /* The first records stand for the rest: a log's columns keep their width */
+    size_t offset = ctx->data_offset;
+    size_t used = 0;
+    uint32_t sampled = 0;
+    while (sampled < CSV_VIEWER_SAMPLE_ROWS && offset < ctx->reader.size)
+    {
+        size_t cap = CSV_VIEWER_PAGE_BYTES - used;
+        cap = (cap < FS_CSV_MAX_RECORD + 1) ? cap : FS_CSV_MAX_RECORD + 1;
+        fs_csv_record_t recs[16];
+        size_t want = CSV_VIEWER_SAMPLE_ROWS - sampled;
+        size_t count = 0;
+        size_t next = 0;
+        if (cap < 2 ||
+            fs_csv_read_records(&ctx->reader, offset, b->page + used, cap, recs, want < 16 ? want : 16,
+                                &count, &next) != ESP_OK ||
+            count == 0)
+        {
+            break;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            char *rec = b->page + used + recs[i].start;
+            uint16_t *cells = b->cells[0];
+            size_t fields = fs_csv_split(rec, recs[i].len, ctx->delim, cells, FS_CSV_MAX_FIELDS);
+            for (size_t c = 0; c < fields && c < ctx->columns; c++)
+            {
+                lv_text_get_size(&size, rec + cells[c], ctx->font, ctx->letter_space, 0,
+                                 LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+                ctx->text_w[c] = (size.x > ctx->text_w[c]) ? size.x : ctx->text_w[c];
+            }
+        }
+        sampled += (uint32_t)count;
+        used += recs[count - 1].start + recs[count - 1].len + 1;
+        offset = next;
+    }
+    csv_viewer_invalidate_page(ctx);
+}
+
+static void csv_viewer_layout(csv_viewer_ctx_t *ctx)
+{
+    ctx->font = lv_obj_get_style_text_font(ctx->view, LV_PART_MAIN);
+    ctx->letter_space = lv_obj_get_style_text_letter_space(ctx->view, LV_PART_MAIN);
+    ctx->row_h = lv_font_get_line_height(ctx->font) + 4;
+    ctx->view_h = lv_obj_get_content_height(ctx->view);
+    ctx->view_w = lv_obj_get_content_width(ctx->view);
+
+    int32_t digit_w = 0;
+    for (const char *c = "0123456789"; *c; c++)
+    {
+        int32_t w = lv_font_get_glyph_width(ctx->font, (uint32_t)*c, '\0');
+        digit_w = (w > digit_w) ? w : digit_w;
+    }
+    int digits = 1;
+    for (uint32_t n = csv_viewer_row_count(ctx); n >= 10; n /= 10)
+    {
+        digits++;
+    }
+    ctx->num_digits = (digits > 3) ? digits : 3;
+    ctx->num_w = (ctx->num_digits + 1) * digit_w;
+
+    /* Fixed widths: the widest sampled text, at most two thirds of the cell area */
+    int32_t min_w = CSV_VIEWER_MIN_COL_DIGITS * digit_w + 2 * CSV_VIEWER_CELL_PAD;
+    int32_t max_w = (ctx->view_w - ctx->num_w) * 2 / 3;
+    max_w = (max_w > min_w) ? max_w : min_w;
+    int32_t x = 0;
+    for (size_t c = 0; c < ctx->columns; c++)
+    {
+        int32_t w = ctx->text_w[c] + 2 * CSV_VIEWER_CELL_PAD;
+        w = (w < min_w) ? min_w : (w > max_w) ? max_w : w;
+        ctx->col_x[c] = x;
+        x += w;
+    }
+    ctx->col_x[ctx->columns] = x;
+
+    int32_t max_x = x - (ctx->view_w - ctx->num_w);
+    max_x = (max_x > 0) ? max_x : 0;
+    ctx->scroll_x = (ctx->scroll_x < max_x) ? ctx->scroll_x : max_x;
+
+    uint32_t rows = (ctx->row_h > 0) ? (uint32_t)((ctx->view_h - ctx->row_h) / ctx->row_h) + 2 : 1;
+    ctx->rows_visible = (rows > CSV_VIEWER_PAGE_ROWS / 2) ? CSV_VIEWER_PAGE_ROWS / 2 : rows;
+}
+
+static void csv_viewer_set_status(csv_viewer_ctx_t *ctx, const char *msg, bool hold)
+{
+    if (ctx->status_label && msg)
+    {
+        lv_label_set_text(ctx->status_label, msg);
+        ctx->status_hold = hold ? CSV_VIEWER_STATUS_HOLD : 0;
+    }
+}
+
+static void csv_viewer_show_summary(csv_viewer_ctx_t *ctx)
+{
+    char status[48];
+    if (ctx->columns == 0)
+    {
+        snprintf(status, sizeof(status), "Empty file");
+    }
+    else if (ctx->sorted)
+    {
+        char tmp[8];
+        snprintf(status, sizeof(status), "%s %.16s, top %" PRIu32, ctx->sort_desc ? LV_SYMBOL_DOWN : LV_SYMBOL_UP,
+                 csv_viewer_column_name(ctx, ctx->sort_col, tmp, sizeof(tmp)), ctx->sorted_count);
+    }
+    else if (ctx->index_timer)
+    {
+        snprintf(status, sizeof(status), "%" PRIu32 " rows, %u%%", ctx->rows_total, (unsigned)ctx->index_percent);
+    }
+    else
+    {
+        snprintf(status, sizeof(status), "%" PRIu32 " rows%s", ctx->rows_total, ctx->index_failed ? "+" : "");
+    }
+    csv_viewer_set_status(ctx, status, false);
+}
+
+static const char *csv_viewer_column_name(csv_viewer_ctx_t *ctx, size_t col, char *tmp, size_t tmp_len)
+{
+    const char *name = (col < ctx->columns) ? ctx->buf->header + ctx->buf->header_cells[col] : "";
+    if (name[0] != '\0')
+    {
+        return name;
+    }
+    snprintf(tmp, tmp_len, "#%u", (unsigned)(col + 1));
+    return tmp;
+}
+
+static void csv_viewer_close(csv_viewer_ctx_t *ctx)
+{
+    csv_viewer_close_dialog(ctx);
+    csv_viewer_stop_column(ctx);
+    csv_viewer_stop_throw(ctx);
+    if (ctx->index_timer)
+    {
+        lv_timer_del(ctx->index_timer);
+        ctx->index_timer = NULL;
+    }
+    fs_csv_index_stop();
+    fs_text_reader_close(&ctx->reader);
+    free(ctx->sorted);
+    ctx->sorted = NULL;
+    free(ctx->buf);
+    ctx->buf = NULL;
+    ctx->active = false;
+    if (ctx->return_screen)
+    {
+        lv_screen_load(ctx->return_screen);
+    }
+    if (ctx->screen)
+    {
+        lv_obj_del(ctx->screen);
+        ctx->screen = NULL;
+        ctx->status_label = NULL;
+        ctx->view = NULL;
+        ctx->slider = NULL;
+        ctx->keyboard = NULL;
+    }
+}
+
+static void csv_viewer_on_back(lv_event_t *e)
+{
+    csv_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active)
+    {
+        return;
+    }
+    csv_viewer_close(ctx);
+}
+
+static uint32_t csv_viewer_row_count(csv_viewer_ctx_t *ctx)
+{
+    return ctx->sorted ? ctx->sorted_count : ctx->rows_total;
+}
+
+static void csv_viewer_load_page(csv_viewer_ctx_t *ctx, uint32_t first)
+{
+    csv_viewer_buffers_t *b = ctx->buf;
+    uint32_t total = csv_viewer_row_count(ctx);
+
+    size_t offset = 0;
+    esp_err_t err = ESP_OK;
+    if (!ctx->sorted)
+    {
+        /* Continue from the page when it reaches @p first, else ask the index (data row n is record n) */
+        if (ctx->page_first != UINT32_MAX && first >= ctx->page_first && first < ctx->page_first + ctx->page_rows)
+        {
+            offset = b->rows[first - ctx->page_first].offset;
+        }
+        else if (ctx->page_first != UINT32_MAX && first == ctx->page_first + ctx->page_rows)
+        {
+            offset = ctx->page_next;
+        }
+        else
+        {
+            err = fs_csv_index_row_offset(&ctx->reader, first + 1, &offset);
+        }
+    }
+
+    ctx->page_first = first;
+    ctx->page_rows = 0;
+    size_t used = 0;
+    while (err == ESP_OK && ctx->page_rows < CSV_VIEWER_PAGE_ROWS && first + ctx->page_rows < total)
+    {
+        size_t cap = CSV_VIEWER_PAGE_BYTES - used;
+        cap = (cap < FS_CSV_MAX_RECORD + 1) ? cap : FS_CSV_MAX_RECORD + 1;
+        if (cap < 2)
+        {
+            break;
+        }
+        size_t want = CSV_VIEWER_PAGE_ROWS - ctx->page_rows;
+        if (want > total - (first + ctx->page_rows))
+        {
+            want = total - (first + ctx->page_rows);
+        }
+        if (ctx->sorted)
+        {
+            offset = ctx->sorted[first + ctx->page_rows].offset;
+            want = 1;
+        }
+
+        fs_csv_record_t recs[CSV_VIEWER_PAGE_ROWS];
+        size_t count = 0;
+        size_t next = 0;
+        err = fs_csv_read_records(&ctx->reader, offset, b->page + used, cap, recs, want, &count, &next);
+        if (err != ESP_OK || count == 0)
+        {
+            break;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t r = ctx->page_rows++;
+            uint32_t base = (uint32_t)(used + recs[i].start);
+            csv_viewer_row_t *row = &b->rows[r];
+            row->offset = recs[i].offset;
+            row->number = ctx->sorted ? ctx->sorted[first + r].row : first + r + 1;
+            row->fields = (uint8_t)fs_csv_split(b->page + base, recs[i].len, ctx->delim, b->cells[r],
+                                                FS_CSV_MAX_FIELDS);
+            for (size_t f = 0; f < row->fields; f++)
+            {
+                b->cells[r][f] += (uint16_t)base;
+            }
+        }
+        used += recs[count - 1].start + recs[count - 1].len + 1;
+        offset = next;
+    }
+    ctx->page_next = offset;
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to read rows from %" PRIu32 ": %s", first, esp_err_to_name(err));
+        csv_viewer_set_status(ctx, "Read failed", true);
+    }
+}
+
+static void csv_viewer_fill_rows(csv_viewer_ctx_t *ctx)
+{
+    uint32_t total = csv_viewer_row_count(ctx);
+    uint32_t end = ctx->top_row + ctx->rows_visible;
+    end = (end < total) ? end : total;
+    bool valid = ctx->page_first != UINT32_MAX;
+    if (valid && ctx->top_row >= ctx->page_first && end <= ctx->page_first + ctx->page_rows)
+    {
+        return;
+    }
+
+    uint32_t first = ctx->top_row;
+    if (valid && ctx->top_row < ctx->page_first)
+    {
+        /* Scrolling up: take the rows above too, so the next steps stay in the page */
+        uint32_t back = CSV_VIEWER_PAGE_ROWS - ctx->rows_visible;
+        first = (ctx->top_row > back) ? ctx->top_row - back : 0;
+    }
+    csv_viewer_load_page(ctx, first);
+    if (end > ctx->page_first + ctx->page_rows && first != ctx->top_row)
+    {
+        csv_viewer_load_page(ctx, ctx->top_row); // Long records: the page did not reach the view
+    }
+}
+
+static void csv_viewer_invalidate_page(csv_viewer_ctx_t *ctx)
+{
+    ctx->page_first = UINT32_MAX;
+    ctx->page_rows = 0;
+}
+
+static uint64_t csv_viewer_scroll_pos(csv_viewer_ctx_t *ctx, uint64_t *out_max)
+{
+    uint64_t content = (uint64_t)csv_viewer_row_count(ctx) * (uint64_t)ctx->row_h;
+    int32_t body_h = ctx->view_h - ctx->row_h;
+    body_h = (body_h > 0) ? body_h : 0;
+    *out_max = (content > (uint64_t)body_h) ? content - (uint64_t)body_h : 0;
+    return (uint64_t)ctx->top_row * (uint64_t)ctx->row_h + (uint64_t)ctx->top_px;
+}
+
+static void csv_viewer_scroll_to(csv_viewer_ctx_t *ctx, uint64_t pos)
+{
+    if (ctx->row_h <= 0)
+    {
+        return;
+    }
+    uint64_t max = 0;
+    csv_viewer_scroll_pos(ctx, &max);
+    if (pos > max)
+    {
+        pos = max;
+    }
+    ctx->top_row = (uint32_t)(pos / (uint64_t)ctx->row_h);
+    ctx->top_px = (int32_t)(pos % (uint64_t)ctx->row_h);
+    csv_viewer_fill_rows(ctx);
+    lv_obj_invalidate(ctx->view);
+    csv_viewer_update_slider(ctx);
+}
+
+static void csv_viewer_scroll_by(csv_viewer_ctx_t *ctx, int32_t dx, int32_t dy)
+{
+    if (dx != 0)
+    {
+        int32_t max_x = ctx->col_x[ctx->columns] - (ctx->view_w - ctx->num_w);
+        int32_t x = ctx->scroll_x + dx;
+        x = (x < max_x) ? x : max_x;
+        x = (x > 0) ? x : 0;
+        if (x != ctx->scroll_x)
+        {
+            ctx->scroll_x = x;
+            lv_obj_invalidate(ctx->view);
+        }
+    }
+    if (dy != 0)
+    {
+        uint64_t max = 0;
+        uint64_t pos = csv_viewer_scroll_pos(ctx, &max);
+        if (dy < 0)
+        {
+            pos = ((uint64_t)-(int64_t)dy > pos) ? 0 : pos - (uint64_t)-(int64_t)dy;
+        }
+        else
+        {
+            pos += (uint64_t)dy;
+        }
+        csv_viewer_scroll_to(ctx, pos);
+    }
+}
+
+static void csv_viewer_draw_row(csv_viewer_ctx_t *ctx, lv_layer_t *layer, const lv_area_t *clip, int32_t x0,
+                                int32_t y, const char *number, const char *base, const uint16_t *cells,
+                                size_t fields)
+{
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.font = ctx->font;
+    dsc.letter_space = ctx->letter_space;
+    dsc.color = UI_COLOR_TEXT_DARK;
+
+    lv_draw_rect_dsc_t line;
+    lv_draw_rect_dsc_init(&line);
+    line.bg_color = UI_COLOR_BORDER_DARK;
+    line.bg_opa = LV_OPA_COVER;
+
+    if (number)
+    {
+        lv_area_t cell = {x0, y + 2, x0 + ctx->num_w - CSV_VIEWER_CELL_PAD, y + ctx->row_h - 1};
+        dsc.text = number;
+        dsc.text_local = 1;
+        dsc.align = LV_TEXT_ALIGN_RIGHT;
+        dsc.opa = LV_OPA_60;
+        lv_draw_label(layer, &dsc, &cell);
+        dsc.text_local = 0;
+        dsc.align = LV_TEXT_ALIGN_LEFT;
+        dsc.opa = LV_OPA_COVER;
+    }
+
+    /* Cells never spill into the gutter or into each other: each gets its own clip */
+    lv_area_t cells_clip = *clip;
+    cells_clip.x1 = LV_MAX(cells_clip.x1, x0 + ctx->num_w);
+    dsc.flag = LV_TEXT_FLAG_EXPAND;
+    for (size_t c = 0; c < ctx->columns; c++)
+    {
+        int32_t cx = x0 + ctx->num_w + ctx->col_x[c] - ctx->scroll_x;
+        int32_t cw = ctx->col_x[c + 1] - ctx->col_x[c];
+        if (cx + cw <= cells_clip.x1)
+        {
+            continue;
+        }
+        if (cx > cells_clip.x2)
+        {
+            break;
+        }
+
+        lv_area_t sep = {cx + cw - 1, y, cx + cw - 1, y + ctx->row_h - 1};
+        layer->_clip_area = cells_clip;
+        lv_draw_rect(layer, &line, &sep);
+
+        const char *text = (c < fields) ? base + cells[c] : "";
+        if (text[0] == '\0')
+        {
+            continue;
+        }
+        lv_area_t area = {cx + CSV_VIEWER_CELL_PAD, y + 2, cx + cw - 1 - CSV_VIEWER_CELL_PAD, y + ctx->row_h - 1};
+        lv_area_t text_clip = {
+            LV_MAX(area.x1, cells_clip.x1), LV_MAX(area.y1, cells_clip.y1),
+            LV_MIN(area.x2, cells_clip.x2), LV_MIN(area.y2, cells_clip.y2),
+        };
+        if (text_clip.x1 > text_clip.x2 || text_clip.y1 > text_clip.y2)
+        {
+            continue;
+        }
+        layer->_clip_area = text_clip;
+        dsc.text = text;
+        lv_draw_label(layer, &dsc, &area);
+    }
+    layer->_clip_area = *clip;
+}
+
+static void csv_viewer_on_draw(lv_event_t *e)
+{
+    csv_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    lv_layer_t *layer = lv_event_get_layer(e);
+    if (!ctx || !ctx->active || !layer || ctx->columns == 0)
+    {
+        return;
+    }
+    csv_viewer_buffers_t *b = ctx->buf;
+
+    lv_area_t content;
+    lv_obj_get_content_coords(ctx->view, &content);
+    lv_area_t clip = {
+        LV_MAX(layer->_clip_area.x1, content.x1), LV_MAX(layer->_clip_area.y1, content.y1),
+        LV_MIN(layer->_clip_area.x2, content.x2), LV_MIN(layer->_clip_area.y2, content.y2),
+    };
+    if (clip.x1 > clip.x2 || clip.y1 > clip.y2)
+    {
+        return;
+    }
+    lv_area_t old_clip = layer->_clip_area;
+
+    lv_draw_rect_dsc_t fill;
+    lv_draw_rect_dsc_init(&fill);
+
+    /* Rows scroll under the header, so they get the area below it */
+    lv_area_t body = clip;
+    body.y1 = LV_MAX(body.y1, content.y1 + ctx->row_h);
+    int32_t sel_x = content.x1 + ctx->num_w - ctx->scroll_x;
+    if (ctx->selected >= 0)
+    {
+        sel_x += ctx->col_x[ctx->selected];
+    }
+    int32_t sel_w = (ctx->selected >= 0) ? ctx->col_x[ctx->selected + 1] - ctx->col_x[ctx->selected] : 0;
+
+    if (body.y1 <= body.y2 && ctx->page_first != UINT32_MAX)
+    {
+        layer->_clip_area = body;
+        if (sel_w > 0)
+        {
+            lv_area_t col = {LV_MAX(sel_x, content.x1 + ctx->num_w), body.y1, sel_x + sel_w - 1, body.y2};
+            fill.bg_color = UI_COLOR_ACCENT_BLUE_DARK;
+            fill.bg_opa = LV_OPA_30;
+            if (col.x1 <= col.x2)
+            {
+                lv_draw_rect(layer, &fill, &col);
+            }
+        }
+        for (uint32_t r = 0; r < ctx->rows_visible; r++)
+        {
+            uint32_t v = ctx->top_row + r;
+            if (v < ctx->page_first)
+            {
+                continue;
+            }
+            if (v >= ctx->page_first + ctx->page_rows)
+            {
+                break;
+            }
+            uint32_t p = v - ctx->page_first;
+            int32_t y = content.y1 + ctx->row_h - ctx->top_px + (int32_t)r * ctx->row_h;
+            if (v & 1u)
+            {
+                lv_area_t stripe = {content.x1, y, content.x2, y + ctx->row_h - 1};
+                fill.bg_color = UI_COLOR_BORDER_DARK;
+                fill.bg_opa = LV_OPA_40;
+                lv_draw_rect(layer, &fill, &stripe);
+            }
+            char number[12];
+            snprintf(number, sizeof(number), "%" PRIu32, b->rows[p].number);
+            csv_viewer_draw_row(ctx, layer, &body, content.x1, y, number, b->page, b->cells[p], b->rows[p].fields);
+        }
+    }
+
+    lv_area_t head = clip;
+    head.y2 = LV_MIN(head.y2, content.y1 + ctx->row_h - 1);
+    if (head.y1 <= head.y2)
+    {
+        layer->_clip_area = head;
+        lv_area_t band = {content.x1, content.y1, content.x2, content.y1 + ctx->row_h - 1};
+        fill.bg_color = UI_COLOR_BORDER_DARK;
+        fill.bg_opa = LV_OPA_COVER;
+        lv_draw_rect(layer, &fill, &band);
+        if (sel_w > 0)
+        {
+            lv_area_t col = {LV_MAX(sel_x, content.x1 + ctx->num_w), band.y1, sel_x + sel_w - 1, band.y2};
+            fill.bg_color = UI_COLOR_ACCENT_BLUE_DARK;
+            fill.bg_opa = LV_OPA_70;
+            if (col.x1 <= col.x2)
+            {
+                lv_draw_rect(layer, &fill, &col);
+            }
+        }
+        csv_viewer_draw_row(ctx, layer, &head, content.x1, content.y1, NULL, b->header, b->header_cells,
+                            ctx->columns);
+    }
+
+    layer->_clip_area = old_clip;
+}
+
+static void csv_viewer_on_view_event(lv_event_t *e)
+{
+    csv_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active)
+    {
+        return;
+    }
+
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_SIZE_CHANGED)
+    {
+        uint32_t top = ctx->top_row;
+        csv_viewer_layout(ctx);
+        csv_viewer_scroll_to(ctx, (uint64_t)top * (uint64_t)ctx->row_h);
+    }
+    else if (code == LV_EVENT_PRESSED)
+    {
+        csv_viewer_stop_throw(ctx);
+        ctx->throw_vx = 0;
+        ctx->throw_vy = 0;
+        ctx->drag_dist = 0;
+    }
+    else if (code == LV_EVENT_PRESSING)
+    {
+        lv_point_t vect = {0};
+        lv_indev_get_vect(lv_indev_active(), &vect);
+        if (vect.x != 0 || vect.y != 0)
+        {
+            ctx->drag_dist += LV_ABS(vect.x) + LV_ABS(vect.y);
+            ctx->throw_vx = -vect.x;
+            ctx->throw_vy = -vect.y;
+            csv_viewer_scroll_by(ctx, -vect.x, -vect.y);
+        }
+    }
+    else if (code == LV_EVENT_RELEASED)
+    {
+        if (ctx->throw_vx > 1 || ctx->throw_vx < -1 || ctx->throw_vy > 1 || ctx->throw_vy < -1)
+        {
+            ctx->throw_timer = lv_timer_create(csv_viewer_on_throw_timer, CSV_VIEWER_THROW_PERIOD_MS, ctx);
+        }
+    }
+    else if (code == LV_EVENT_CLICKED && ctx->drag_dist <= CSV_VIEWER_TAP_SLOP)
+    {
+        lv_point_t point = {0};
+        lv_indev_get_point(lv_indev_active(), &point);
+        csv_viewer_select_at(ctx, &point);
+    }
+}
+
+static void csv_viewer_select_at(csv_viewer_ctx_t *ctx, const lv_point_t *point)
+{
+    lv_area_t content;
+    lv_obj_get_content_coords(ctx->view, &content);
+    int32_t x = point->x - content.x1 - ctx->num_w + ctx->scroll_x;
+    if (point->x < content.x1 + ctx->num_w)
+    {
+        return;
+    }
+    for (size_t c = 0; c < ctx->columns; c++)
+    {
+        if (x >= ctx->col_x[c] && x < ctx->col_x[c + 1])
+        {
+            ctx->selected = (int)c;
+            char tmp[8];
+            char status[40];
+            snprintf(status, sizeof(status), "Column %.24s", csv_viewer_column_name(ctx, c, tmp, sizeof(tmp)));
+            csv_viewer_set_status(ctx, status, true);
+            lv_obj_invalidate(ctx->view);
+            return;
+        }
+    }
+}
+
+static void csv_viewer_on_throw_timer(lv_timer_t *timer)
+{
+    csv_viewer_ctx_t *ctx = lv_timer_get_user_data(timer);
+    ctx->throw_vx = ctx->throw_vx * (100 - CSV_VIEWER_THROW_DECAY) / 100;
+    ctx->throw_vy = ctx->throw_vy * (100 - CSV_VIEWER_THROW_DECAY) / 100;
+    if (ctx->throw_vx == 0 && ctx->throw_vy == 0)
+    {
+        csv_viewer_stop_throw(ctx);
+        return;
+    }
+    csv_viewer_scroll_by(ctx, ctx->throw_vx, ctx->throw_vy);
+}
+
+static void csv_viewer_stop_throw(csv_viewer_ctx_t *ctx)
+{
+    if (ctx->throw_timer)
+    {
+        lv_timer_del(ctx->throw_timer);
+        ctx->throw_timer = NULL;
+    }
+}
+
+static void csv_viewer_update_slider(csv_viewer_ctx_t *ctx)
+{
+    if (!ctx->slider)
+    {
+        return;
+    }
+    uint64_t max = 0;
+    uint64_t pos = csv_viewer_scroll_pos(ctx, &max);
+    bool prev = ctx->slider_suppress_change;
+    ctx->slider_suppress_change = true;
+    if (max == 0)
+    {
+        lv_slider_set_value(ctx->slider, 0, LV_ANIM_OFF);
+        lv_obj_add_state(ctx->slider, LV_STATE_DISABLED);
+    }
+    else
+    {
+        lv_slider_set_value(ctx->slider, (int32_t)(pos * CSV_VIEWER_SLIDER_STEPS / max), LV_ANIM_OFF);
+        lv_obj_remove_state(ctx->slider, LV_STATE_DISABLED);
+    }
+    ctx->slider_suppress_change = prev;
+}
+
+static void csv_viewer_on_slider(lv_event_t *e)
+{
+    csv_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active || ctx->slider_suppress_change)
+    {
+        return;
+    }
+    csv_viewer_stop_throw(ctx);
+    uint64_t max = 0;
+    csv_viewer_scroll_pos(ctx, &max);
+    int32_t value = lv_slider_get_value(ctx->slider);
+
+    /* Land on a row edge: a jump of the slider is never finer than a row anyway */
+    uint64_t pos = max * (uint64_t)value / CSV_VIEWER_SLIDER_STEPS;
+    pos -= pos % (uint64_t)ctx->row_h;
+    bool prev = ctx->slider_suppress_change;
+    ctx->slider_suppress_change = true;
+    csv_viewer_scroll_to(ctx, value >= CSV_VIEWER_SLIDER_STEPS ? max : pos);
+    ctx->slider_suppress_change = prev;
+}
+
+static void csv_viewer_update_index(csv_viewer_ctx_t *ctx)
+{
+    uint32_t records = 0;
+    uint8_t percent = 0;
+    esp_err_t err = fs_csv_index_poll(&records, &percent);
+    ctx->index_percent = percent;
+    if (err != ESP_ERR_NOT_FINISHED && ctx->index_timer)
+    {
+        lv_timer_del(ctx->index_timer);
+        ctx->index_timer = NULL;
+        if (err != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Index of %s incomplete: %s", ctx->path, esp_err_to_name(err));
+            ctx->index_failed = true;
+        }
+    }
+
+    uint32_t rows = (records > 0) ? records - 1 : 0; // The header is not a data row
+    if (rows != ctx->rows_total)
+    {
+        ctx->rows_total = rows;
+        if (!ctx->sorted)
+        {
+            csv_viewer_layout(ctx); // The gutter grows with the row count
+            csv_viewer_fill_rows(ctx);
+            csv_viewer_update_slider(ctx);
+            lv_obj_invalidate(ctx->view);
+        }
+    }
+
+    if (ctx->status_hold > 0)
+    {
+        ctx->status_hold--;
+    }
+    else
+    {
+        csv_viewer_show_summary(ctx);
+    }
+}
+
+static void csv_viewer_on_index_timer(lv_timer_t *timer)
+{
+    csv_viewer_ctx_t *ctx = lv_timer_get_user_data(timer);
+    csv_viewer_update_index(ctx);
+}
+
+static void csv_viewer_start_column(csv_viewer_ctx_t *ctx, fs_csv_column_op_t op)
+{
+    esp_err_t err = fs_csv_column_start(ctx->path, ctx->delim, (uint32_t)ctx->selected, op);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Column scan not started: %s", esp_err_to_name(err));
+        csv_viewer_set_status(ctx, "Scan failed", true);
+        return;
+    }
+    ctx->column_op = op;
+    ctx->column_col = (size_t)ctx->selected;
+    csv_viewer_set_status(ctx, "Scanning...", true);
+    if (!ctx->column_timer)
+    {
+        ctx->column_timer = lv_timer_create(csv_viewer_on_column_timer, CSV_VIEWER_JOB_POLL_MS, ctx);
+    }
+}
+
+static void csv_viewer_on_column_timer(lv_timer_t *timer)
+{
+    csv_viewer_ctx_t *ctx = lv_timer_get_user_data(timer);
+    fs_csv_column_result_t res;
+    uint8_t percent = 0;
+    esp_err_t err = fs_csv_column_poll(&res, &percent);
+    if (err == ESP_ERR_NOT_FINISHED)
+    {
+        char status[24];
+        snprintf(status, sizeof(status), "%s %u%%", ctx->column_op == FS_CSV_COLUMN_STATS ? "Scanning" : "Sorting",
+                 (unsigned)percent);
+        csv_viewer_set_status(ctx, status, true);
+        return;
+    }
+    lv_timer_del(timer);
+    ctx->column_timer = NULL;
+    if (err != ESP_OK)
+    {
+        if (err != ESP_ERR_INVALID_STATE)
+        {
+            ESP_LOGE(TAG, "Column scan failed: %s", esp_err_to_name(err));
+            csv_viewer_set_status(ctx, "Scan failed", true);
+        }
+        return;
+    }
+
+    char tmp[8];
+    const char *name = csv_viewer_column_name(ctx, ctx->column_col, tmp, sizeof(tmp));
+    if (res.numeric == 0)
+    {
+        char status[40];
+        snprintf(status, sizeof(status), "No numbers in %.20s", name);
+        csv_viewer_set_status(ctx, status, true);
+        fs_csv_column_free(&res);
+        return;
+    }
+
+    if (ctx->column_op == FS_CSV_COLUMN_STATS)
+    {
+        char text[160];
+        snprintf(text, sizeof(text), "%.24s\nRows: %" PRIu32 "\nNumbers: %" PRIu32 "\nMin: %g\nMax: %g\nMean: %g",
+                 name, res.rows, res.numeric, res.min, res.max, res.sum / res.numeric);
+        fs_csv_column_free(&res);
+        csv_viewer_show_summary(ctx);
+        csv_viewer_show_dialog(ctx, CSV_VIEWER_DIALOG_STATS, text);
+        return;
+    }
+
+    free(ctx->sorted);
+    ctx->sorted = res.sorted;
+    ctx->sorted_count = res.sorted_count;
+    ctx->sort_col = ctx->column_col;
+    ctx->sort_desc = ctx->column_op == FS_CSV_COLUMN_SORT_DESC;
+    csv_viewer_invalidate_page(ctx);
+    csv_viewer_layout(ctx);
+    ctx->top_row = 0;
+    ctx->top_px = 0;
+    csv_viewer_scroll_to(ctx, 0);
+    csv_viewer_show_summary(ctx);
+}
+
+static void csv_viewer_stop_column(csv_viewer_ctx_t *ctx)
+{
+    fs_csv_column_stop();
+    if (ctx->column_timer)
+    {
+        lv_timer_del(ctx->column_timer);
+        ctx->column_timer = NULL;
+    }
+}
+
+static void csv_viewer_clear_sort(csv_viewer_ctx_t *ctx)
+{
+    free(ctx->sorted);
+    ctx->sorted = NULL;
+    ctx->sorted_count = 0;
+    csv_viewer_invalidate_page(ctx);
+    csv_viewer_layout(ctx);
+    csv_viewer_scroll_to(ctx, 0);
+    csv_viewer_show_summary(ctx);
+}
+
+static void csv_viewer_on_sort(lv_event_t *e)
+{
+    csv_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active)
+    {
+        return;
+    }
+    if (ctx->column_timer)
+    {
+        csv_viewer_stop_column(ctx);
+        csv_viewer_set_status(ctx, "Cancelled", true);
+        return;
+    }
+    if (ctx->selected < 0)
+    {
+        if (ctx->sorted)
+        {
+            csv_viewer_clear_sort(ctx);
+            return;
+        }
+        csv_viewer_set_status(ctx, "Tap a column first", true);
+        return;
+    }
+
+    bool same = ctx->sorted && ctx->sort_col == (size_t)ctx->selected;
+    if (same && ctx->sort_desc)
+    {
+        csv_viewer_clear_sort(ctx);
+        return;
+    }
+    csv_viewer_start_column(ctx, same ? FS_CSV_COLUMN_SORT_DESC : FS_CSV_COLUMN_SORT_ASC);
+}
+
+static void csv_viewer_on_stats(lv_event_t *e)
+{
+    csv_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active)
+    {
+        return;
+    }
+    if (ctx->column_timer)
+    {
+        csv_viewer_stop_column(ctx);
+        csv_viewer_set_status(ctx, "Cancelled", true);
+        return;
+    }
+    if (ctx->selected < 0)
+    {
+        csv_viewer_set_status(ctx, "Tap a column first", true);
+        return;
+    }
+    csv_viewer_start_column(ctx, FS_CSV_COLUMN_STATS);
+}
+
+static void csv_viewer_show_dialog(csv_viewer_ctx_t *ctx, csv_viewer_dialog_t kind, const char *stats)
+{
+    if (ctx->dialog)
+    {
+        return;
+    }
+    lv_obj_t *dlg = lv_msgbox_create(ctx->screen);
+    styles_build_msgbox(dlg);
+    ctx->dialog = dlg;
+    ctx->dialog_kind = kind;
+    lv_obj_add_flag(dlg, LV_OBJ_FLAG_FLOATING);
+    lv_obj_set_style_max_width(dlg, LV_PCT(65), 0);
+    lv_obj_set_width(dlg, LV_PCT(65));
+
+    lv_obj_t *content = lv_msgbox_get_content(dlg);
+    lv_obj_t *label = lv_label_create(content);
+    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+    lv_obj_set_width(label, LV_PCT(100));
+    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_LEFT, 0);
+
+    if (kind == CSV_VIEWER_DIALOG_STATS)
+    {
+        lv_label_set_text(label, stats ? stats : "");
+        lv_obj_t *ok_btn = lv_msgbox_add_footer_button(dlg, "OK");
+        lv_obj_set_user_data(ok_btn, (void *)0);
+        styles_build_button(ok_btn);
+        lv_obj_add_event_cb(ok_btn, csv_viewer_on_dialog, LV_EVENT_CLICKED, ctx);
+        lv_obj_center(dlg);
+        return;
+    }
+
+    lv_label_set_text_fmt(label, "Go to row (1-%" PRIu32 ")", csv_viewer_row_count(ctx));
+    ctx->dialog_textarea = lv_textarea_create(content);
+    lv_textarea_set_one_line(ctx->dialog_textarea, true);
+    lv_textarea_set_accepted_chars(ctx->dialog_textarea, "0123456789");
+    lv_textarea_set_max_length(ctx->dialog_textarea, 10);
+    lv_obj_add_state(ctx->dialog_textarea, LV_STATE_FOCUSED);
+    styles_build_textarea(ctx->dialog_textarea);
+    lv_obj_set_width(ctx->dialog_textarea, LV_PCT(100));
+
+    lv_obj_t *go_btn = lv_msgbox_add_footer_button(dlg, "Go");
+    lv_obj_set_user_data(go_btn, (void *)1);
+    styles_build_button(go_btn);
+    lv_obj_add_event_cb(go_btn, csv_viewer_on_dialog, LV_EVENT_CLICKED, ctx);
+
+    lv_obj_t *cancel_btn = lv_msgbox_add_footer_button(dlg, "Cancel");
+    lv_obj_set_user_data(cancel_btn, (void *)0);
+    styles_build_button(cancel_btn);
+    lv_obj_add_event_cb(cancel_btn, csv_viewer_on_dialog, LV_EVENT_CLICKED, ctx);
+
+    lv_keyboard_set_mode(ctx->keyboard, LV_KEYBOARD_MODE_NUMBER);
+    lv_keyboard_set_textarea(ctx->keyboard, ctx->dialog_textarea);
+    lv_obj_clear_flag(ctx->keyboard, LV_OBJ_FLAG_HIDDEN);
+
+    lv_obj_update_layout(ctx->keyboard);
+    lv_obj_update_layout(dlg);
+    lv_coord_t keyboard_top = lv_obj_get_y(ctx->keyboard);
+    lv_coord_t dialog_h = lv_obj_get_height(dlg);
+    lv_coord_t margin = 10;
+    if (keyboard_top > dialog_h)
+    {
+        lv_coord_t candidate = (keyboard_top - dialog_h) / 2;
+        if (candidate > 0)
+        {
+            margin = candidate;
+        }
+    }
+    lv_obj_align(dlg, LV_ALIGN_TOP_MID, 0, margin);
+}
+
+static void csv_viewer_close_dialog(csv_viewer_ctx_t *ctx)
+{
+    if (!ctx->dialog)
+    {
+        return;
+    }
+    lv_msgbox_close(ctx->dialog);
+    ctx->dialog = NULL;
+    ctx->dialog_textarea = NULL;
+    ctx->dialog_kind = CSV_VIEWER_DIALOG_NONE;
+    if (ctx->keyboard)
+    {
+        lv_keyboard_set_textarea(ctx->keyboard, NULL);
+        lv_obj_add_flag(ctx->keyboard, LV_OBJ_FLAG_HIDDEN);
+        lv_keyboard_set_mode(ctx->keyboard, LV_KEYBOARD_MODE_TEXT_LOWER);
+    }
+}
+
+static void csv_viewer_on_dialog(lv_event_t *e)
+{
+    csv_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->dialog)
+    {
+        return;
+    }
+    /* The keyboard's OK button lands here too and confirms */
+    lv_obj_t *target = lv_event_get_target(e);
+    uintptr_t action = (target == ctx->keyboard) ? 1u : (uintptr_t)lv_obj_get_user_data(target);
+    if (action == 0 || ctx->dialog_kind != CSV_VIEWER_DIALOG_GOTO)
+    {
+        csv_viewer_close_dialog(ctx);
+        return;
+    }
+
+    const char *raw = ctx->dialog_textarea ? lv_textarea_get_text(ctx->dialog_textarea) : "";
+    raw = raw ? raw : "";
+    char *end = NULL;
+    unsigned long row = strtoul(raw, &end, 10);
+    if (raw[0] == '\0' || !end || *end != '\0' || row == 0)
+    {
+        csv_viewer_set_status(ctx, "Invalid row", true);
+        return;
+    }
+    csv_viewer_close_dialog(ctx);
+    uint32_t count = csv_viewer_row_count(ctx);
+    if (count == 0)
+    {
+        return;
+    }
+    if (row > count)
+    {
+        row = count;
+        csv_viewer_set_status(ctx, ctx->index_timer ? "Not indexed yet: last row so far" : "Past the end: last row",
+                              true);
+    }
+    csv_viewer_scroll_to(ctx, (uint64_t)(row - 1) * (uint64_t)ctx->row_h);
+}
+
+static void csv_viewer_on_keyboard_cancel(lv_event_t *e)
+{
+    csv_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx)
+    {
+        return;
+    }
+    csv_viewer_close_dialog(ctx);
+}
+
+static void csv_viewer_on_goto(lv_event_t *e)
+{
+    csv_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active)
+    {
+        return;
+    }
+    csv_viewer_show_dialog(ctx, CSV_VIEWER_DIALOG_GOTO, NULL);
+}
@@ -20,8 +20,12 @@
 #include "lvgl.h"
 
 #include "text_viewer_screen.h"
+#include "hex_viewer_screen.h"
+#include "csv_viewer_screen.h"
+#include "fs_csv.h"
 #include "fs_navigator.h"
 #include "fs_text_ops.h"
+#include "fs_tree_ops.h"
 #include "Domine_16.h"
 #include "settings.h"
 #include "styles.h"
@@ -133,17 +137,60 @@ static TaskHandle_t file_manager_wait_task = NULL;
 static bool file_manager_is_image(const char *name);
 
 /**
- * @brief Returns true if filename ends in .jpg or .jpeg (case-insensitive).
+ * @brief Returns true if the image viewer can open the file (case-insensitive extension).
+ *
+ * Always .jpg/.jpeg; .png and .bmp when their streaming decoders are enabled.
  */
-static bool file_manager_is_jpeg(const char *name);
+static bool file_manager_is_viewable_image(const char *name);
 
 /**
- * @brief Item click handler for JPEG files (path composition + view stub).
+ * @brief Item click handler for viewable image files (path composition + viewer).
  *
  * @param ctx   Active browser context.
  * @param item  Navigator item selected from the list.
  */
-static void file_manager_handle_jpeg(file_manager_ctx_t *ctx, const fs_nav_item_t *item);
+static void file_manager_handle_image(file_manager_ctx_t *ctx, const fs_nav_item_t *item);
+
+/**
+ * @brief Build the LVGL "S:" path of an item in the current directory.
+ *
+ * @param ctx      Active browser context.
+ * @param name     Item name.
+ * @param out      Output buffer.
+ * @param out_len  Size of @p out.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the path does not fit.
+ */
+static esp_err_t file_manager_compose_lv_path(file_manager_ctx_t *ctx, const char *name, char *out, size_t out_len);
+
+/**
+ * @brief Image viewer step callback: find the neighbouring viewable image in the loaded items.
+ *
+ * Walks the navigator buffer from the current image in direction @p dir,
+ * wrapping at both ends and skipping folders and files the viewer cannot open.
+ * For unsorted directories larger than the navigator window only the loaded
+ * window is visited.
+ *
+ * @param user     Browser context.
+ * @param current  "S:" path of the image on screen.
+ * @param dir      +1 next, -1 previous.
+ * @param out      Output buffer for the neighbour's "S:" path.
+ * @param out_len  Size of @p out.
+ *
+ * @return true if another image was found.
+ */
+static bool file_manager_step_image(void *user, const char *current, int dir, char *out, size_t out_len);
+
+/**
+ * @brief Explain why an image could not be opened (viewer on_error callback).
+ *
+ * Maps the viewer's error code to the matching prompt; anything unexpected is
+ * treated as an SD card problem and triggers a remount attempt.
+ *
+ * @param user Browser context.
+ * @param err  Error from jpg_viewer_open() or from the background decode.
+ */
+static void file_manager_on_image_error(void *user, esp_err_t err);
 
 /************************************ UI & Data Refresh Helpers ***********************************/
 
@@ -472,7 +519,7 @@ static void file_manager_show_image_resolution_too_large_to_display_prompt(void)
 static void file_manager_show_not_enough_memory_prompt(void);
 
 /**
- * @brief Show an informational prompt for unsupported jpeg formats.
+ * @brief Show an informational prompt for unsupported or corrupted image files.
  */
 static void file_manager_show_jpeg_unsupported_prompt(void);
 
@@ -742,35 +789,6 @@ static void file_manager_on_folder_textarea_clicked(lv_event_t *e);
  */
  static void file_manager_trim_whitespace(char *name);
 
-/**
- * @brief Recursively delete a path, which may be a file or directory tree.
- *
- * Uses @c stat() to determine whether the path is a directory. If so, iterates
- * over items with @c opendir()/readdir(), recursively deletes children and
- * finally removes the directory. If it is a file, calls @c remove().
- *
- * Missing paths (ENOENT) are treated as success.
- *
- * @param path Path to delete (must be non-empty string).
- * @return ESP_OK on success,
- *         ESP_ERR_INVALID_ARG for invalid input,
- *         ESP_ERR_INVALID_SIZE if child path buffer would overflow,
- *         ESP_FAIL on other filesystem/errno-based errors.
- */
- static esp_err_t file_manager_delete_path(const char *path);
-
-/**
- * @brief Recursively accumulate byte size for a file or directory tree.
- *
- * @param path  Absolute path to a file or directory.
- * @param bytes In/out accumulator; on success, increased by the size found.
- * @return ESP_OK on success,
- *         ESP_ERR_INVALID_ARG for invalid input,
- *         ESP_ERR_INVALID_SIZE if a composed child path would overflow,
- *         ESP_FAIL on stat/opendir errors.
- */
-static esp_err_t file_manager_compute_total_size(const char *path, uint64_t *bytes);
-
 /**************************************************************************************************/
 
 /*************************************** Clipboard & Paste Helpers ********************************/
@@ -871,36 +889,6 @@ static void file_manager_hide_loading(file_manager_ctx_t *ctx);
  */
 static esp_err_t file_manager_perform_paste(file_manager_ctx_t *ctx, const char *dest_path, bool allow_overwrite);
 
-/**
- * @brief Recursive copy (file or directory).
- *
- * @param src  Absolute source path.
- * @param dest Absolute destination path.
- * @return ESP_OK on success or an error from @c file_manager_copy_file/dir.
- */
-static esp_err_t file_manager_copy_item(const char *src, const char *dest);
-
-/**
- * @brief Copy a single file from src to dest using buffered I/O.
- *
- * @param src  Absolute source file path.
- * @param dest Absolute destination file path (created/overwritten).
- * @return ESP_OK on success; ESP_FAIL on fopen/fread/fwrite errors.
- */
-static esp_err_t file_manager_copy_file(const char *src, const char *dest);
-
-/**
- * @brief Recursively copy a directory tree.
- *
- * Creates the destination directory, then copies children recursively
- * via @c file_manager_copy_item().
- *
- * @param src  Absolute source directory path.
- * @param dest Absolute destination directory path (created).
- * @return ESP_OK on success; ESP_FAIL/ESP_ERR_INVALID_SIZE on errors.
- */
-static esp_err_t file_manager_copy_dir(const char *src, const char *dest);
-
 /**
  * @brief Check if a path is a subpath of another (prefix + separator).
  *
@@ -1998,27 +1986,76 @@ static bool file_manager_is_image(const char *name)
            strcasecmp(dot, ".gif") == 0;
 }
 
-static bool file_manager_is_jpeg(const char *name)
+static bool file_manager_is_viewable_image(const char *name)
 {
     const char *dot = strrchr(name, '.');
     if (!dot) {
         return false;
     }
+#if CONFIG_JPG_VIEWER_PNG
+    if (strcasecmp(dot, ".png") == 0) {
+        return true;
+    }
+#endif
+#if CONFIG_JPG_VIEWER_BMP
+    if (strcasecmp(dot, ".bmp") == 0) {
+        return true;
+    }
+#endif
     return strcasecmp(dot, ".jpg") == 0 || strcasecmp(dot, ".jpeg") == 0;
 }
 
-static void file_manager_handle_jpeg(file_manager_ctx_t *ctx, const fs_nav_item_t *item)
+static void file_manager_handle_image(file_manager_ctx_t *ctx, const fs_nav_item_t *item)
 {
     if (!ctx || !item) {
         return;
     }
 
-    char path[FS_NAV_MAX_PATH];
-    if (fs_nav_compose_path(&ctx->nav, item->name, path, sizeof(path)) != ESP_OK) {
+    char lv_path[FS_NAV_MAX_PATH + 4];
+    if (file_manager_compose_lv_path(ctx, item->name, lv_path, sizeof(lv_path)) != ESP_OK) {
         ESP_LOGE(TAG, "Path too long for \"%s\"", item->name);
         return;
     }
 
+    jpg_viewer_open_opts_t opts = {
+        .path = lv_path,
+        .return_screen = ctx->screen,
+        .step = file_manager_step_image,
+        .on_error = file_manager_on_image_error,
+        .user = ctx,
+    };
+
+    esp_err_t err = jpg_viewer_open(&opts);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open image \"%s\": %s", lv_path, esp_err_to_name(err));
+        file_manager_on_image_error(ctx, err);
+    }
+}
+
+static void file_manager_on_image_error(void *user, esp_err_t err)
+{
+    (void)user;
+    if (err == ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGE(TAG, "The image is corrupted or this specific image type is not supported by the system.");
+        file_manager_show_jpeg_unsupported_prompt();
+    } else if (err == ESP_ERR_NO_MEM){
+        ESP_LOGE(TAG, "The image is too large or there is no more internal memory to open it.");
+        file_manager_show_not_enough_memory_prompt();
+    }else if (err == ESP_ERR_INVALID_SIZE){
+        ESP_LOGE(TAG, "The image resolution is too large do display.");
+        file_manager_show_image_resolution_too_large_to_display_prompt();
+    }else{
+        sdspi_schedule_sd_retry();
+    }
+}
+
+static esp_err_t file_manager_compose_lv_path(file_manager_ctx_t *ctx, const char *name, char *out, size_t out_len)
+{
+    char path[FS_NAV_MAX_PATH];
+    if (fs_nav_compose_path(&ctx->nav, name, path, sizeof(path)) != ESP_OK) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
     const char *root = CONFIG_SDSPI_MOUNT_POINT;
     size_t root_len = strlen(root);
     const char *relative = path;
@@ -2026,34 +2063,44 @@ static void file_manager_handle_jpeg(file_manager_ctx_t *ctx, const fs_nav_item_
         relative = path + root_len; /* keep leading slash after mountpoint */
     }
 
-    char lv_path[FS_NAV_MAX_PATH + 4];
-    int needed = snprintf(lv_path, sizeof(lv_path), "S:%s", relative);
-    if (needed < 0 || needed >= (int)sizeof(lv_path)) {
-        ESP_LOGE(TAG, "LVGL path too long for \"%s\"", item->name);
-        return;
+    int needed = snprintf(out, out_len, "S:%s", relative);
+    if (needed < 0 || needed >= (int)out_len) {
+        return ESP_ERR_INVALID_SIZE;
     }
+    return ESP_OK;
+}
 
-    jpg_viewer_open_opts_t opts = {
-        .path = lv_path,
-        .return_screen = ctx->screen
-    };
+static bool file_manager_step_image(void *user, const char *current, int dir, char *out, size_t out_len)
+{
+    file_manager_ctx_t *ctx = (file_manager_ctx_t *)user;
+    if (!ctx || !current || !out || !ctx->nav.items || ctx->nav.item_count < 2) {
+        return false;
+    }
 
-    esp_err_t err = jpg_viewer_open(&opts);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NOT_SUPPORTED) {
-            ESP_LOGE(TAG, "The image is corrupted or this specific JPG type is not supported by the system.");
-            file_manager_show_jpeg_unsupported_prompt();
-        } else if (err == ESP_ERR_NO_MEM){
-            ESP_LOGE(TAG, "The image is too large or there is no more internal memory to open it.");
-            file_manager_show_not_enough_memory_prompt();
-        }else if (err == ESP_ERR_INVALID_SIZE){
-            ESP_LOGE(TAG, "The image resolution is too large do display.");
-            file_manager_show_image_resolution_too_large_to_display_prompt();
-        }else{
-            ESP_LOGE(TAG, "Failed to open JPEG \"%s\": %s", path, esp_err_to_name(err));
-            sdspi_schedule_sd_retry();
+    const char *name = strrchr(current, '/');
+    name = name ? name + 1 : current;
+
+    const fs_nav_item_t *items = ctx->nav.items;
+    const size_t count = ctx->nav.item_count;
+    size_t index = count;
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(items[i].name, name) == 0) {
+            index = i;
+            break;
+        }
+    }
+    if (index == count) {
+        return false;
+    }
+
+    for (size_t n = 1; n < count; n++) {
+        size_t i = dir > 0 ? (index + n) % count : (index + count - n) % count;
+        if (items[i].is_dir || !file_manager_is_viewable_image(items[i].name)) {
+            continue;
         }
+        return file_manager_compose_lv_path(ctx, items[i].name, out, out_len) == ESP_OK;
     }
+    return false;
 }
 
 static esp_err_t file_manager_reload(void)
@@ -2179,7 +2226,7 @@ static void file_manager_show_jpeg_unsupported_prompt(void)
     lv_obj_center(mbox);
 
     lv_obj_t *label = lv_label_create(mbox);
-    lv_label_set_text(label, "The image is corrupted or this specific JPG type is not supported by the system.");
+    lv_label_set_text(label, "The image is corrupted or this specific image type is not supported by the system.");
     lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
     lv_obj_set_style_text_color(label, UI_COLOR_TEXT_DARK, 0);
     lv_obj_set_width(label, LV_PCT(100));
@@ -2357,12 +2404,57 @@ static void file_manager_on_item_click(lv_event_t *e)
         return;
     }
 
-    if (file_manager_is_jpeg(item->name)) {
-        file_manager_handle_jpeg(ctx, item);
+    if (fs_csv_is_csv(item->name)) {
+        ctx->reload_anchor_index = ctx->list_window_start + index;
+        char path[FS_NAV_MAX_PATH];
+        if (fs_nav_compose_path(&ctx->nav, item->name, path, sizeof(path)) == ESP_OK) {
+            csv_viewer_open_opts_t opts = {
+                .path = path,
+                .return_screen = ctx->screen,
+            };
+            file_manager_show_loading(ctx);
+            esp_err_t err = csv_viewer_open(&opts);
+            file_manager_hide_loading(ctx);
+            if (err == ESP_FAIL) {
+                ESP_LOGE(TAG, "Failed to open \"%s\"", item->name);
+                sdspi_schedule_sd_retry();
+            } else if (err != ESP_OK) {
+                ESP_LOGE(TAG, "CSV viewer unavailable for \"%s\": %s", item->name, esp_err_to_name(err));
+                file_manager_show_unsupported_prompt();
+            }
+        } else {
+            ESP_LOGE(TAG, "Path too long for \"%s\"", item->name);
+        }
+        return;
+    }
+
+    if (file_manager_is_viewable_image(item->name)) {
+        file_manager_handle_image(ctx, item);
         return;
     }
 
-    file_manager_show_unsupported_prompt();
+    /* Anything else opens as raw bytes */
+    ctx->reload_anchor_index = ctx->list_window_start + index;
+    char path[FS_NAV_MAX_PATH];
+    if (fs_nav_compose_path(&ctx->nav, item->name, path, sizeof(path)) != ESP_OK) {
+        ESP_LOGE(TAG, "Path too long for \"%s\"", item->name);
+        file_manager_show_unsupported_prompt();
+        return;
+    }
+    hex_viewer_open_opts_t opts = {
+        .path = path,
+        .return_screen = ctx->screen,
+    };
+    file_manager_show_loading(ctx);
+    esp_err_t err = hex_viewer_open(&opts);
+    file_manager_hide_loading(ctx);
+    if (err == ESP_FAIL) {
+        ESP_LOGE(TAG, "Failed to open \"%s\"", item->name);
+        sdspi_schedule_sd_retry();
+    } else if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Hex viewer unavailable for \"%s\": %s", item->name, esp_err_to_name(err));
+        file_manager_show_unsupported_prompt();
+    }
 }
 
 static void file_manager_on_list_scrolled(lv_event_t *e)
@@ -3049,100 +3141,6 @@ static void file_manager_trim_whitespace(char *name)
     }
 }
 
-static esp_err_t file_manager_delete_path(const char *path)
-{
-    if (!path || path[0] == '\0') {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    struct stat st = {0};
-    if (stat(path, &st) != 0) {
-        if (errno == ENOENT) {
-            return ESP_OK;
-        }
-        ESP_LOGE(TAG, "stat(%s) failed (errno=%d)", path, errno);
-        return ESP_FAIL;
-    }
-
-    if (S_ISDIR(st.st_mode)) {
-        DIR *dir = opendir(path);
-        if (!dir) {
-            ESP_LOGE(TAG, "opendir(%s) failed (errno=%d)", path, errno);
-            return ESP_FAIL;
-        }
-        struct dirent *dent = NULL;
-        while ((dent = readdir(dir)) != NULL) {
-            if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0) {
-                continue;
-            }
-            char child[FS_NAV_MAX_PATH];
-            int needed = snprintf(child, sizeof(child), "%s/%s", path, dent->d_name);
-            if (needed < 0 || needed >= (int)sizeof(child)) {
-                closedir(dir);
-                return ESP_ERR_INVALID_SIZE;
-            }
-            esp_err_t err = file_manager_delete_path(child);
-            if (err != ESP_OK) {
-                closedir(dir);
-                return err;
-            }
-        }
-        closedir(dir);
-        if (rmdir(path) != 0) {
-            ESP_LOGE(TAG, "rmdir(%s) failed (errno=%d)", path, errno);
-            return ESP_FAIL;
-        }
-        return ESP_OK;
-    }
-
-    if (remove(path) != 0) {
-        ESP_LOGE(TAG, "remove(%s) failed (errno=%d)", path, errno);
-        return ESP_FAIL;
-    }
-    return ESP_OK;
-}
-
-static esp_err_t file_manager_compute_total_size(const char *path, uint64_t *bytes)
-{
-    if (!path || !bytes || path[0] == '\0') {
-        return ESP_ERR_INVALID_ARG;
-    }
-    struct stat st;
-    if (stat(path, &st) != 0) {
-        ESP_LOGE(TAG, "stat(%s) failed (errno=%d)", path, errno);
-        return ESP_FAIL;
-    }
-    if (!S_ISDIR(st.st_mode)) {
-        *bytes += (uint64_t)st.st_size;
-        return ESP_OK;
-    }
-
-    DIR *dir = opendir(path);
-    if (!dir) {
-        ESP_LOGE(TAG, "opendir(%s) failed (errno=%d)", path, errno);
-        return ESP_FAIL;
-    }
-    struct dirent *dent = NULL;
-    while ((dent = readdir(dir)) != NULL) {
-        if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0) {
-            continue;
-        }
-        char child[FS_NAV_MAX_PATH];
-        int needed = snprintf(child, sizeof(child), "%s/%s", path, dent->d_name);
-        if (needed < 0 || needed >= (int)sizeof(child)) {
-            closedir(dir);
-            return ESP_ERR_INVALID_SIZE;
-        }
-        esp_err_t err = file_manager_compute_total_size(child, bytes);
-        if (err != ESP_OK) {
-            closedir(dir);
-            return err;
-        }
-    }
-    closedir(dir);
-    return ESP_OK;
-}
-
 static void file_manager_show_message(const char *msg)
 {
     if (!msg) {
@@ -3217,102 +3215,6 @@ static bool file_manager_is_subpath(const char *parent, const char *child)
     return child[parent_len] == '/';
 }
 
-static esp_err_t file_manager_copy_file(const char *src, const char *dest)
-{
-    FILE *in = fopen(src, "rb");
-    if (!in) {
-        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", src, errno);
-        return ESP_FAIL;
-    }
-    FILE *out = fopen(dest, "wb");
-    if (!out) {
-        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", dest, errno);
-        fclose(in);
-        return ESP_FAIL;
-    }
-
-    uint8_t buf[4096];
-    size_t r = 0;
-    esp_err_t err = ESP_OK;
-    while ((r = fread(buf, 1, sizeof(buf), in)) > 0) {
-        size_t w = fwrite(buf, 1, r, out);
-        if (w != r) {
-            ESP_LOGE(TAG, "fwrite(%s) failed (errno=%d)", dest, errno);
-            err = ESP_FAIL;
-            break;
-        }
-    }
-
-    if (ferror(in)) {
-        ESP_LOGE(TAG, "fread(%s) failed (errno=%d)", src, errno);
-        err = ESP_FAIL;
-    }
-
-    fclose(out);
-    fclose(in);
-    if (err != ESP_OK) {
-        remove(dest);
-    }
-    return err;
-}
-
-static esp_err_t file_manager_copy_dir(const char *src, const char *dest)
-{
-    if (mkdir(dest, 0775) != 0) {
-        ESP_LOGE(TAG, "mkdir(%s) failed (errno=%d)", dest, errno);
-        return ESP_FAIL;
-    }
-
-    DIR *dir = opendir(src);
-    if (!dir) {
-        ESP_LOGE(TAG, "opendir(%s) failed (errno=%d)", src, errno);
-        rmdir(dest);
-        return ESP_FAIL;
-    }
-
-    struct dirent *dent = NULL;
-    while ((dent = readdir(dir)) != NULL) {
-        if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0) {
-            continue;
-        }
-        char child_src[FS_NAV_MAX_PATH];
-        char child_dest[FS_NAV_MAX_PATH];
-        int ns = snprintf(child_src, sizeof(child_src), "%s/%s", src, dent->d_name);
-        int nd = snprintf(child_dest, sizeof(child_dest), "%s/%s", dest, dent->d_name);
-        if (ns < 0 || ns >= (int)sizeof(child_src) || nd < 0 || nd >= (int)sizeof(child_dest)) {
-            closedir(dir);
-            file_manager_delete_path(dest);
-            return ESP_ERR_INVALID_SIZE;
-        }
-        esp_err_t err = file_manager_copy_item(child_src, child_dest);
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to copy item: (%s)", esp_err_to_name(err));
-            closedir(dir);
-            file_manager_delete_path(dest);
-            return err;
-        }
-    }
-    closedir(dir);
-    return ESP_OK;
-}
-
-static esp_err_t file_manager_copy_item(const char *src, const char *dest)
-{
-    if (!src || !dest) {
-        return ESP_ERR_INVALID_ARG;
-    }
-    struct stat st;
-    if (stat(src, &st) != 0) {
-        ESP_LOGE(TAG, "stat(%s) failed (errno=%d)", src, errno);
-        return ESP_FAIL;
-    }
-
-    if (S_ISDIR(st.st_mode)) {
-        return file_manager_copy_dir(src, dest);
-    }
-    return file_manager_copy_file(src, dest);
-}
-
 static esp_err_t file_manager_generate_copy_name(const char *directory, const char *name, char *out, size_t out_len)
 {
     if (!directory || !name || !out || out_len == 0) {
@@ -3438,7 +3340,7 @@ static esp_err_t file_manager_perform_paste(file_manager_ctx_t *ctx, const char
     }
 
     if (allow_overwrite && file_manager_path_exists(dest_path)) {
-        esp_err_t del = file_manager_delete_path(dest_path);
+        esp_err_t del = fs_tree_delete(dest_path);
         if (del != ESP_OK) {
             ESP_LOGE(TAG, "Failed to delete destination before overwrite: %s", esp_err_to_name(del));
             return del;
@@ -3451,9 +3353,9 @@ static esp_err_t file_manager_perform_paste(file_manager_ctx_t *ctx, const char
             if (errno != EXDEV) {
                 ESP_LOGW(TAG, "rename(%s -> %s) failed (errno=%d), falling back to copy+delete", ctx->clipboard.src_path, dest_path, errno);
             }
-            err = file_manager_copy_item(ctx->clipboard.src_path, dest_path);
+            err = fs_tree_copy(ctx->clipboard.src_path, dest_path);
             if (err == ESP_OK) {
-                err = file_manager_delete_path(ctx->clipboard.src_path);
+                err = fs_tree_delete(ctx->clipboard.src_path);
                 if (err != ESP_OK) {
                     ESP_LOGE(TAG, "Failed to remove source after cut: %s", esp_err_to_name(err));
                 }
@@ -3466,7 +3368,7 @@ static esp_err_t file_manager_perform_paste(file_manager_ctx_t *ctx, const char
         return err;
     }
 
-    err = file_manager_copy_item(ctx->clipboard.src_path, dest_path);
+    err = fs_tree_copy(ctx->clipboard.src_path, dest_path);
     if (err == ESP_OK) {
         file_manager_clear_clipboard(ctx);
         file_manager_update_second_header(ctx);
@@ -3504,7 +3406,7 @@ static void file_manager_on_paste_click(lv_event_t *e)
 
     if (!ctx->clipboard.cut) {
         uint64_t total = 0;
-        esp_err_t size_err = file_manager_compute_total_size(ctx->clipboard.src_path, &total);
+        esp_err_t size_err = fs_tree_total_size(ctx->clipboard.src_path, &total);
         if (size_err != ESP_OK) {
             sdspi_schedule_sd_retry();
             return;
@@ -4029,7 +3931,7 @@ static esp_err_t file_manager_delete_selected_item(file_manager_ctx_t *ctx)
         return err;
     }
 
-    err = file_manager_delete_path(path);
+    err = fs_tree_delete(path);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to delete %s: %s", path, esp_err_to_name(err));
         return err;
@@ -0,0 +1,338 @@
+#include "fs_append.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define FS_APPEND_ZERO_BLOCK    512
+
+static const char *TAG = "fs_append";
+static const uint8_t s_zeros[FS_APPEND_ZERO_BLOCK];
+
+/**
+ * @brief write() all of @p len bytes, resuming after short writes.
+ */
+static esp_err_t fs_append_write_all(int fd, const void *data, size_t len);
+
+/**
+ * @brief Find the end of the data in a preallocated file, scanning back from @p size.
+ *
+ * Flushes never write records up to the last byte of the reserve, so a file
+ * that does not end in zeros was closed properly and ends at @p size.
+ * Otherwise the data ends after the last newline before the zeros: a flush
+ * cut by a power loss may have left part of a record over the reserve. Reads
+ * through the stream buffer, which is empty at this point.
+ */
+static esp_err_t fs_append_find_end(fs_append_t *stream, uint64_t size, uint64_t *out_end);
+
+/**
+ * @brief Write @p len bytes at the end of the data and fsync().
+ *
+ * With preallocation, a write that would reach the end of the reserve first
+ * extends it with zeros and fsync()s, so the data always has a zero after it.
+ * On failure the file position goes back to the end of the durable data, so
+ * the next attempt writes the same bytes again.
+ */
+static esp_err_t fs_append_commit(fs_append_t *stream, const void *data, size_t len);
+
+/**
+ * @brief fs_append_commit() the buffered records and empty the buffer on success.
+ */
+static esp_err_t fs_append_flush_buffer(fs_append_t *stream);
+
+/**
+ * @brief Whether the oldest buffered record is older than @c flush_ms.
+ */
+static bool fs_append_due(const fs_append_t *stream);
+
+esp_err_t fs_append_open(fs_append_t *stream, const char *path, const fs_append_config_t *config)
+{
+    if (!stream || !path || path[0] != '/' || strlen(path) >= sizeof(stream->path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(stream, 0, sizeof(*stream));
+    stream->fd = -1;
+    strlcpy(stream->path, path, sizeof(stream->path));
+    if (config) {
+        stream->config = *config;
+    }
+    if (stream->config.buffer_size == 0) {
+        stream->config.buffer_size = FS_APPEND_DEFAULT_BUFFER;
+    }
+
+    stream->buf = malloc(stream->config.buffer_size);
+    if (!stream->buf) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* Not O_APPEND: flushes overwrite the preallocated zeros in place */
+    stream->fd = open(path, O_RDWR | O_CREAT, 0664);
+    if (stream->fd < 0) {
+        ESP_LOGE(TAG, "open(%s) failed (errno=%d)", path, errno);
+        free(stream->buf);
+        stream->buf = NULL;
+        return ESP_FAIL;
+    }
+
+    struct stat st;
+    esp_err_t err = (fstat(stream->fd, &st) == 0) ? ESP_OK : ESP_FAIL;
+    if (err == ESP_OK) {
+        stream->alloc_end = (uint64_t)st.st_size;
+        stream->data_end = stream->alloc_end;
+        if (stream->config.prealloc > 0) {
+            /* Zeros left by a power loss (or a crash before fs_append_close()) */
+            err = fs_append_find_end(stream, stream->alloc_end, &stream->data_end);
+        }
+    }
+    if (err == ESP_OK && stream->data_end < stream->alloc_end) {
+        /* Cut the leftovers now so the next record starts on a line of its own */
+        ESP_LOGW(TAG, "%s was not closed, trimming it to %llu bytes", path, (unsigned long long)stream->data_end);
+        if (ftruncate(stream->fd, (off_t)stream->data_end) != 0 || fsync(stream->fd) != 0) {
+            err = ESP_FAIL;
+        }
+        stream->alloc_end = stream->data_end;
+    }
+    if (err == ESP_OK && lseek(stream->fd, (off_t)stream->data_end, SEEK_SET) != (off_t)stream->data_end) {
+        err = ESP_FAIL;
+    }
+    if (err == ESP_OK) {
+        stream->lock = xSemaphoreCreateMutex();
+        if (!stream->lock) {
+            err = ESP_ERR_NO_MEM;
+        }
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Opening %s failed (errno=%d)", path, errno);
+        close(stream->fd);
+        free(stream->buf);
+        memset(stream, 0, sizeof(*stream));
+        stream->fd = -1;
+        return err;
+    }
+    return ESP_OK;
+}
+
+esp_err_t fs_append_write(fs_append_t *stream, const void *data, size_t len)
+{
+    if (!stream || (!data && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!stream->lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (len == 0) {
+        return ESP_OK;
+    }
+    if (stream->config.prealloc > 0 && ((const char *)data)[len - 1] != '\n') {
+        /* Recovery in fs_append_open() keeps whole lines only */
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(stream->lock, portMAX_DELAY);
+    size_t cap = stream->config.buffer_size;
+    esp_err_t err = ESP_OK;
+    if (stream->used > 0 && len > cap - stream->used) {
+        err = fs_append_flush_buffer(stream);
+    }
+    if (err == ESP_OK) {
+        if (len >= cap) {
+            err = fs_append_commit(stream, data, len);
+        } else {
+            if (stream->used == 0) {
+                stream->first_us = esp_timer_get_time();
+            }
+            memcpy(stream->buf + stream->used, data, len);
+            stream->used += len;
+            if (stream->used == cap || fs_append_due(stream)) {
+                err = fs_append_flush_buffer(stream);
+            }
+        }
+    }
+    xSemaphoreGive(stream->lock);
+    return err;
+}
+
+esp_err_t fs_append_flush(fs_append_t *stream)
+{
+    if (!stream) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!stream->lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(stream->lock, portMAX_DELAY);
+    esp_err_t err = fs_append_flush_buffer(stream);
+    xSemaphoreGive(stream->lock);
+    return err;
+}
+
+esp_err_t fs_append_poll(fs_append_t *stream)
+{
+    if (!stream) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!stream->lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(stream->lock, portMAX_DELAY);
+    esp_err_t err = fs_append_due(stream) ? fs_append_flush_buffer(stream) : ESP_OK;
+    xSemaphoreGive(stream->lock);
+    return err;
+}
+
+esp_err_t fs_append_close(fs_append_t *stream)
+{
+    if (!stream || !stream->lock) {
+        return ESP_OK;
+    }
+
+    xSemaphoreTake(stream->lock, portMAX_DELAY);
+    esp_err_t err = fs_append_flush_buffer(stream);
+    if (stream->alloc_end > stream->data_end) {
+        if (ftruncate(stream->fd, (off_t)stream->data_end) != 0 || fsync(stream->fd) != 0) {
+            ESP_LOGE(TAG, "Trimming %s failed (errno=%d)", stream->path, errno);
+            err = ESP_FAIL;
+        }
+    }
+    if (close(stream->fd) != 0 && err == ESP_OK) {
+        ESP_LOGE(TAG, "close(%s) failed (errno=%d)", stream->path, errno);
+        err = ESP_FAIL;
+    }
+    if (stream->used > 0) {
+        ESP_LOGW(TAG, "%s closed with %u bytes not written", stream->path, (unsigned)stream->used);
+    }
+    free(stream->buf);
+    xSemaphoreGive(stream->lock);
+    vSemaphoreDelete(stream->lock);
+    memset(stream, 0, sizeof(*stream));
+    stream->fd = -1;
+    return err;
+}
+
+static esp_err_t fs_append_write_all(int fd, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) {
+            return ESP_FAIL;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t fs_append_find_end(fs_append_t *stream, uint64_t size, uint64_t *out_end)
+{
+    uint64_t end = size;
+    bool past_zeros = false;
+    while (end > 0) {
+        size_t n = (end < stream->config.buffer_size) ? (size_t)end : stream->config.buffer_size;
+        uint64_t at = end - n;
+        if (lseek(stream->fd, (off_t)at, SEEK_SET) != (off_t)at ||
+            read(stream->fd, stream->buf, n) != (ssize_t)n) {
+            return ESP_FAIL;
+        }
+        if (!past_zeros) {
+            while (n > 0 && stream->buf[n - 1] == 0) {
+                n--;
+            }
+            if (n > 0 && at + n == size) {
+                break;
+            }
+            past_zeros = (n > 0);
+        }
+        while (n > 0 && stream->buf[n - 1] != '\n') {
+            n--;
+        }
+        if (n > 0) {
+            end = at + n;
+            break;
+        }
+        end = at;
+    }
+    *out_end = end;
+    return ESP_OK;
+}
+
+static esp_err_t fs_append_commit(fs_append_t *stream, const void *data, size_t len)
+{
+    uint64_t end = stream->data_end + len;
+    esp_err_t err = ESP_OK;
+
+    if (stream->config.prealloc > 0 && end >= stream->alloc_end) {
+        /*
+         * Zeros first, made durable on their own: if the records and the new
+         * size went out together, a torn flush could end exactly at the old
+         * size with no zero after it and pass for a properly closed file.
+         */
+        uint64_t target = end + stream->config.prealloc;
+        if (lseek(stream->fd, (off_t)stream->alloc_end, SEEK_SET) != (off_t)stream->alloc_end) {
+            err = ESP_FAIL;
+        }
+        for (uint64_t at = stream->alloc_end; err == ESP_OK && at < target; at += FS_APPEND_ZERO_BLOCK) {
+            uint64_t n = target - at;
+            err = fs_append_write_all(stream->fd, s_zeros, (n < FS_APPEND_ZERO_BLOCK) ? (size_t)n : FS_APPEND_ZERO_BLOCK);
+        }
+        if (err == ESP_OK && fsync(stream->fd) != 0) {
+            err = ESP_FAIL;
+        }
+        if (err == ESP_OK) {
+            stream->alloc_end = target;
+        }
+        if (err == ESP_OK && lseek(stream->fd, (off_t)stream->data_end, SEEK_SET) != (off_t)stream->data_end) {
+            err = ESP_FAIL;
+        }
+    }
+    if (err == ESP_OK) {
+        err = fs_append_write_all(stream->fd, data, len);
+    }
+    if (err == ESP_OK && end > stream->alloc_end) {
+        stream->alloc_end = end;
+    }
+    if (err == ESP_OK && fsync(stream->fd) != 0) {
+        err = ESP_FAIL;
+    }
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Flushing %u bytes to %s failed (errno=%d)", (unsigned)len, stream->path, errno);
+        struct stat st;
+        if (fstat(stream->fd, &st) == 0 && (uint64_t)st.st_size > stream->alloc_end) {
+            /* Partly written: fs_append_close() trims it back to the durable data */
+            stream->alloc_end = (uint64_t)st.st_size;
+        }
+        lseek(stream->fd, (off_t)stream->data_end, SEEK_SET);
+        return err;
+    }
+    stream->data_end = end;
+    stream->flushes++;
+    return ESP_OK;
+}
+
+static esp_err_t fs_append_flush_buffer(fs_append_t *stream)
+{
+    if (stream->used == 0) {
+        return ESP_OK;
+    }
+    esp_err_t err = fs_append_commit(stream, stream->buf, stream->used);
+    if (err == ESP_OK) {
+        stream->used = 0;
+    }
+    return err;
+}
+
+static bool fs_append_due(const fs_append_t *stream)
+{
+    return stream->used > 0 && stream->config.flush_ms > 0 &&
+           esp_timer_get_time() - stream->first_us >= (int64_t)stream->config.flush_ms * 1000;
+}
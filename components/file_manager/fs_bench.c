@@ -0,0 +1,493 @@
+#include "fs_bench.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "esp_log.h"
+#include "fs_append.h"
+#include "fs_navigator.h"
+#include "fs_text_ops.h"
+#include "fs_tree_ops.h"
+
+static const char *TAG = "fs_bench";
+
+#define FS_BENCH_TREE_DIR   "tree"
+#define FS_BENCH_COPY_DIR   "copy"
+#define FS_BENCH_APPEND_FILE "append.txt"
+
+/* Heap state and clock at the start of a step */
+typedef struct {
+    const fs_bench_probe_t *probe;
+    int64_t t0;
+    int32_t allocs;
+    size_t blocks;
+    size_t bytes;
+} fs_bench_mark_t;
+
+static const fs_bench_tree_spec_t s_presets[] = {
+    { .name = "flat_10",  .files = 10,    .depth = 0,  .file_bytes = 256,              .max_items = 64 },
+    { .name = "flat_1k",  .files = 1000,  .depth = 0,  .file_bytes = 256,              .max_items = 1000 },
+    { .name = "flat_50k", .files = 50000, .depth = 0,  .file_bytes = 0,                .max_items = 64,  .slow = true },
+    { .name = "deep_32",  .files = 4,     .depth = 32, .file_bytes = 256,              .max_items = 64 },
+    { .name = "large",    .files = 4,     .depth = 0,  .file_bytes = 8 * 1024 * 1024,  .max_items = 64,  .slow = true },
+};
+
+static const char *const s_step_names[FS_BENCH_STEP_COUNT] = {
+    [FS_BENCH_STEP_CREATE] = "create",
+    [FS_BENCH_STEP_REFRESH] = "refresh",
+    [FS_BENCH_STEP_PAGE] = "page",
+    [FS_BENCH_STEP_STAT] = "stat",
+    [FS_BENCH_STEP_SORT] = "sort",
+    [FS_BENCH_STEP_WALK] = "walk",
+    [FS_BENCH_STEP_SIZE] = "size",
+    [FS_BENCH_STEP_COPY] = "copy",
+    [FS_BENCH_STEP_DELETE] = "delete",
+};
+
+static const char *const s_append_names[FS_BENCH_APPEND_MODE_COUNT] = {
+    [FS_BENCH_APPEND_DIRECT] = "direct",
+    [FS_BENCH_APPEND_STREAM] = "stream",
+    [FS_BENCH_APPEND_PREALLOC] = "prealloc",
+};
+
+/**
+ * @brief Snapshot the heap through @p probe, then start its clock.
+ */
+static void fs_bench_begin(const fs_bench_probe_t *probe, fs_bench_mark_t *mark);
+
+/**
+ * @brief Stop the clock, then record the time and heap change since @p mark into @p out.
+ */
+static void fs_bench_end(const fs_bench_mark_t *mark, esp_err_t err, fs_bench_result_t *out);
+
+/**
+ * @brief Write a file of @p bytes bytes from the pattern in @p buf (FS_TREE_COPY_BLOCK bytes).
+ */
+static esp_err_t fs_bench_write_file(const char *path, uint32_t bytes, const uint8_t *buf);
+
+/**
+ * @brief Create the tree described by @p spec at @p root, counting what was created into @p out.
+ */
+static esp_err_t fs_bench_make_tree(const char *root, const fs_bench_tree_spec_t *spec, fs_bench_tree_report_t *out);
+
+/**
+ * @brief Run the navigator steps (refresh, page, stat, sort, walk) on the tree at @p root.
+ */
+static void fs_bench_run_nav(const char *root, const fs_bench_tree_spec_t *spec, const fs_bench_probe_t *probe,
+                             fs_bench_tree_report_t *out);
+
+/**
+ * @brief Enter the first subdirectory in the loaded window.
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if the window holds no directory, or the fs_nav_enter() error.
+ */
+static esp_err_t fs_bench_enter_first_dir(fs_nav_t *nav);
+
+/**
+ * @brief Append @p records copies of @p line to @p path the way @p mode does.
+ */
+static esp_err_t fs_bench_append_lines(const char *path, fs_bench_append_mode_t mode, const char *line,
+                                       uint32_t records, uint32_t record_bytes);
+
+const fs_bench_tree_spec_t *fs_bench_tree_presets(size_t *out_count)
+{
+    if (out_count) {
+        *out_count = sizeof(s_presets) / sizeof(s_presets[0]);
+    }
+    return s_presets;
+}
+
+const char *fs_bench_step_name(fs_bench_step_t step)
+{
+    return (step < FS_BENCH_STEP_COUNT) ? s_step_names[step] : "?";
+}
+
+esp_err_t fs_bench_tree_run(const char *scratch_dir, const fs_bench_tree_spec_t *spec,
+                            const fs_bench_probe_t *probe, fs_bench_tree_report_t *out)
+{
+    if (!scratch_dir || scratch_dir[0] != '/' || !spec || !probe || !probe->now_us || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->spec = spec;
+    for (size_t i = 0; i < FS_BENCH_STEP_COUNT; ++i) {
+        out->steps[i].err = ESP_ERR_NOT_SUPPORTED;
+        out->steps[i].allocs = -1;
+    }
+
+    char tree[FS_NAV_MAX_PATH];
+    char copy[FS_NAV_MAX_PATH];
+    int nt = snprintf(tree, sizeof(tree), "%s/%s", scratch_dir, FS_BENCH_TREE_DIR);
+    int nc = snprintf(copy, sizeof(copy), "%s/%s", scratch_dir, FS_BENCH_COPY_DIR);
+    if (nt < 0 || nt >= (int)sizeof(tree) || nc < 0 || nc >= (int)sizeof(copy)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (mkdir(scratch_dir, 0775) != 0 && errno != EEXIST) {
+        ESP_LOGE(TAG, "mkdir(%s) failed (errno=%d)", scratch_dir, errno);
+        return ESP_FAIL;
+    }
+    esp_err_t err = fs_tree_delete(tree);
+    if (err == ESP_OK) {
+        err = fs_tree_delete(copy);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    fs_bench_mark_t mark;
+    fs_bench_begin(probe, &mark);
+    err = fs_bench_make_tree(tree, spec, out);
+    fs_bench_end(&mark, err, &out->steps[FS_BENCH_STEP_CREATE]);
+    if (err != ESP_OK) {
+        fs_tree_delete(tree);
+        return err;
+    }
+
+    fs_bench_run_nav(tree, spec, probe, out);
+
+    uint64_t bytes = 0;
+    fs_bench_begin(probe, &mark);
+    err = fs_tree_total_size(tree, &bytes);
+    fs_bench_end(&mark, err, &out->steps[FS_BENCH_STEP_SIZE]);
+
+    fs_bench_begin(probe, &mark);
+    err = fs_tree_copy(tree, copy);
+    fs_bench_end(&mark, err, &out->steps[FS_BENCH_STEP_COPY]);
+
+    if (err == ESP_OK) {
+        fs_bench_begin(probe, &mark);
+        err = fs_tree_delete(copy);
+        fs_bench_end(&mark, err, &out->steps[FS_BENCH_STEP_DELETE]);
+    }
+
+    fs_tree_delete(copy);
+    fs_tree_delete(tree);
+    return ESP_OK;
+}
+
+void fs_bench_tree_log(const fs_bench_tree_report_t *report)
+{
+    if (!report || !report->spec) {
+        return;
+    }
+    ESP_LOGI(TAG, "%s: %" PRIu32 " entries, %" PRIu64 " bytes",
+             report->spec->name, report->entries, report->bytes);
+    for (size_t i = 0; i < FS_BENCH_STEP_COUNT; ++i) {
+        const fs_bench_result_t *r = &report->steps[i];
+        if (r->err == ESP_ERR_NOT_SUPPORTED) {
+            ESP_LOGI(TAG, "  %-8s n/a", s_step_names[i]);
+        } else if (r->err != ESP_OK) {
+            ESP_LOGI(TAG, "  %-8s failed (%s)", s_step_names[i], esp_err_to_name(r->err));
+        } else {
+            ESP_LOGI(TAG, "  %-8s %10" PRId64 " us %7" PRId32 " allocs %+6" PRId32 " blocks %+8" PRId32 " B",
+                     s_step_names[i], r->us, r->allocs, r->net_blocks, r->net_bytes);
+        }
+    }
+}
+
+const char *fs_bench_append_mode_name(fs_bench_append_mode_t mode)
+{
+    return (mode < FS_BENCH_APPEND_MODE_COUNT) ? s_append_names[mode] : "?";
+}
+
+esp_err_t fs_bench_append_run(const char *scratch_dir, uint32_t records, uint32_t record_bytes,
+                              const fs_bench_probe_t *probe, fs_bench_append_report_t *out)
+{
+    if (!scratch_dir || scratch_dir[0] != '/' || records == 0 || record_bytes < 2 ||
+        !probe || !probe->now_us || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->records = records;
+    out->record_bytes = record_bytes;
+
+    char path[FS_NAV_MAX_PATH];
+    int np = snprintf(path, sizeof(path), "%s/%s", scratch_dir, FS_BENCH_APPEND_FILE);
+    if (np < 0 || np >= (int)sizeof(path)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (mkdir(scratch_dir, 0775) != 0 && errno != EEXIST) {
+        ESP_LOGE(TAG, "mkdir(%s) failed (errno=%d)", scratch_dir, errno);
+        return ESP_FAIL;
+    }
+
+    char *line = malloc(record_bytes);
+    if (!line) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint32_t i = 0; i + 1 < record_bytes; ++i) {
+        line[i] = (char)('a' + i % 26);
+    }
+    line[record_bytes - 1] = '\n';
+
+    for (size_t m = 0; m < FS_BENCH_APPEND_MODE_COUNT; ++m) {
+        fs_bench_mark_t mark;
+        remove(path);
+        fs_bench_begin(probe, &mark);
+        esp_err_t err = fs_bench_append_lines(path, (fs_bench_append_mode_t)m, line, records, record_bytes);
+        fs_bench_end(&mark, err, &out->modes[m]);
+
+        struct stat st;
+        if (err == ESP_OK && (stat(path, &st) != 0 || (uint64_t)st.st_size != (uint64_t)records * record_bytes)) {
+            ESP_LOGE(TAG, "%s: %s has the wrong size", s_append_names[m], path);
+            out->modes[m].err = ESP_ERR_INVALID_SIZE;
+        }
+    }
+    remove(path);
+    free(line);
+    return ESP_OK;
+}
+
+void fs_bench_append_log(const fs_bench_append_report_t *report)
+{
+    if (!report) {
+        return;
+    }
+    ESP_LOGI(TAG, "append: %" PRIu32 " lines of %" PRIu32 " bytes", report->records, report->record_bytes);
+    for (size_t i = 0; i < FS_BENCH_APPEND_MODE_COUNT; ++i) {
+        const fs_bench_result_t *r = &report->modes[i];
+        if (r->err != ESP_OK) {
+            ESP_LOGI(TAG, "  %-8s failed (%s)", s_append_names[i], esp_err_to_name(r->err));
+        } else {
+            int64_t us = r->us > 0 ? r->us : 1;
+            ESP_LOGI(TAG, "  %-8s %10" PRId64 " us %8" PRId64 " lines/s %7" PRId32 " allocs",
+                     s_append_names[i], r->us, (int64_t)report->records * 1000000 / us, r->allocs);
+        }
+    }
+}
+
+static void fs_bench_begin(const fs_bench_probe_t *probe, fs_bench_mark_t *mark)
+{
+    mark->probe = probe;
+    mark->blocks = 0;
+    mark->bytes = 0;
+    if (probe->heap_held) {
+        probe->heap_held(&mark->blocks, &mark->bytes);
+    }
+    mark->allocs = probe->allocs ? probe->allocs() : 0;
+    mark->t0 = probe->now_us();
+}
+
+static void fs_bench_end(const fs_bench_mark_t *mark, esp_err_t err, fs_bench_result_t *out)
+{
+    const fs_bench_probe_t *probe = mark->probe;
+    int64_t t1 = probe->now_us();
+    int32_t allocs = probe->allocs ? probe->allocs() : 0;
+    size_t blocks = 0;
+    size_t bytes = 0;
+    if (probe->heap_held) {
+        probe->heap_held(&blocks, &bytes);
+    }
+
+    out->err = err;
+    out->us = t1 - mark->t0;
+    out->allocs = probe->allocs ? allocs - mark->allocs : -1;
+    out->net_blocks = (int32_t)blocks - (int32_t)mark->blocks;
+    out->net_bytes = (int32_t)bytes - (int32_t)mark->bytes;
+}
+
+static esp_err_t fs_bench_write_file(const char *path, uint32_t bytes, const uint8_t *buf)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    esp_err_t err = ESP_OK;
+    while (bytes > 0) {
+        size_t chunk = bytes < FS_TREE_COPY_BLOCK ? bytes : FS_TREE_COPY_BLOCK;
+        if (fwrite(buf, 1, chunk, f) != chunk) {
+            ESP_LOGE(TAG, "fwrite(%s) failed (errno=%d)", path, errno);
+            err = ESP_FAIL;
+            break;
+        }
+        bytes -= chunk;
+    }
+    if (fclose(f) != 0 && err == ESP_OK) {
+        ESP_LOGE(TAG, "fclose(%s) failed (errno=%d)", path, errno);
+        err = ESP_FAIL;
+    }
+    return err;
+}
+
+static esp_err_t fs_bench_make_tree(const char *root, const fs_bench_tree_spec_t *spec, fs_bench_tree_report_t *out)
+{
+    uint8_t *buf = NULL;
+    if (spec->file_bytes > 0) {
+        buf = malloc(FS_TREE_COPY_BLOCK);
+        if (!buf) {
+            return ESP_ERR_NO_MEM;
+        }
+        for (size_t i = 0; i < FS_TREE_COPY_BLOCK; ++i) {
+            buf[i] = (uint8_t)(i * 31u);
+        }
+    }
+
+    char dir[FS_NAV_MAX_PATH];
+    strlcpy(dir, root, sizeof(dir));
+    esp_err_t err = ESP_OK;
+    if (mkdir(dir, 0775) != 0) {
+        ESP_LOGE(TAG, "mkdir(%s) failed (errno=%d)", dir, errno);
+        err = ESP_FAIL;
+    }
+
+    for (uint32_t level = 0; err == ESP_OK && level <= spec->depth; ++level) {
+        for (uint32_t i = 0; err == ESP_OK && i < spec->files; ++i) {
+            char path[FS_NAV_MAX_PATH];
+            int n = snprintf(path, sizeof(path), "%s/f%05" PRIu32 ".dat", dir, i);
+            if (n < 0 || n >= (int)sizeof(path)) {
+                err = ESP_ERR_INVALID_SIZE;
+                break;
+            }
+            err = fs_bench_write_file(path, spec->file_bytes, buf);
+            if (err == ESP_OK) {
+                out->entries++;
+                out->bytes += spec->file_bytes;
+            }
+        }
+        if (err != ESP_OK || level == spec->depth) {
+            break;
+        }
+
+        size_t len = strlen(dir);
+        int n = snprintf(dir + len, sizeof(dir) - len, "/d%02" PRIu32, level + 1);
+        if (n < 0 || (size_t)n >= sizeof(dir) - len) {
+            err = ESP_ERR_INVALID_SIZE;
+            break;
+        }
+        if (mkdir(dir, 0775) != 0) {
+            ESP_LOGE(TAG, "mkdir(%s) failed (errno=%d)", dir, errno);
+            err = ESP_FAIL;
+            break;
+        }
+        out->entries++;
+    }
+
+    free(buf);
+    return err;
+}
+
+static void fs_bench_run_nav(const char *root, const fs_bench_tree_spec_t *spec, const fs_bench_probe_t *probe,
+                             fs_bench_tree_report_t *out)
+{
+    fs_nav_t *nav = calloc(1, sizeof(*nav));
+    if (!nav) {
+        out->steps[FS_BENCH_STEP_REFRESH].err = ESP_ERR_NO_MEM;
+        return;
+    }
+
+    fs_nav_config_t cfg = {
+        .root_path = root,
+        .max_items = spec->max_items,
+        .stateless = true,
+    };
+    fs_bench_mark_t mark;
+    fs_bench_begin(probe, &mark);
+    esp_err_t err = fs_nav_init(nav, &cfg);
+    fs_bench_end(&mark, err, &out->steps[FS_BENCH_STEP_REFRESH]);
+    if (err != ESP_OK) {
+        fs_nav_deinit(nav);
+        free(nav);
+        return;
+    }
+
+    size_t total = fs_nav_total_items(nav);
+    fs_bench_begin(probe, &mark);
+    err = ESP_OK;
+    for (size_t i = 1; err == ESP_OK && i <= FS_BENCH_PAGE_COUNT && i * FS_BENCH_PAGE_WINDOW < total; ++i) {
+        err = fs_nav_set_window(nav, i * FS_BENCH_PAGE_WINDOW, FS_BENCH_PAGE_WINDOW);
+    }
+    if (err == ESP_OK && total > FS_BENCH_PAGE_WINDOW) {
+        err = fs_nav_set_window(nav, total - FS_BENCH_PAGE_WINDOW, FS_BENCH_PAGE_WINDOW);
+    }
+    if (err == ESP_OK) {
+        err = fs_nav_set_window(nav, 0, FS_BENCH_PAGE_WINDOW);
+    }
+    fs_bench_end(&mark, err, &out->steps[FS_BENCH_STEP_PAGE]);
+
+    /* From window 0, item_count covers every loaded item, sorted or not */
+    if (err == ESP_OK) {
+        fs_bench_begin(probe, &mark);
+        for (size_t i = 0; err == ESP_OK && i < nav->item_count; ++i) {
+            err = fs_nav_ensure_meta(nav, i);
+        }
+        fs_bench_end(&mark, err, &out->steps[FS_BENCH_STEP_STAT]);
+    }
+
+    if (err == ESP_OK && fs_nav_is_sort_enabled(nav)) {
+        static const fs_nav_sort_mode_t modes[] = {
+            FS_NAV_SORT_NAME, FS_NAV_SORT_DATE, FS_NAV_SORT_SIZE, FS_NAV_SORT_NAME,
+        };
+        fs_bench_begin(probe, &mark);
+        for (size_t i = 0; err == ESP_OK && i < sizeof(modes) / sizeof(modes[0]); ++i) {
+            err = fs_nav_set_sort(nav, modes[i], i != 0);
+        }
+        fs_bench_end(&mark, err, &out->steps[FS_BENCH_STEP_SORT]);
+    }
+
+    if (err == ESP_OK && spec->depth > 0) {
+        fs_bench_begin(probe, &mark);
+        uint32_t entered = 0;
+        while (err == ESP_OK && entered < spec->depth) {
+            err = fs_bench_enter_first_dir(nav);
+            if (err == ESP_OK) {
+                entered++;
+            }
+        }
+        while (err == ESP_OK && fs_nav_can_go_parent(nav)) {
+            err = fs_nav_go_parent(nav);
+        }
+        fs_bench_end(&mark, err, &out->steps[FS_BENCH_STEP_WALK]);
+    }
+
+    fs_nav_deinit(nav);
+    free(nav);
+}
+
+static esp_err_t fs_bench_enter_first_dir(fs_nav_t *nav)
+{
+    size_t count = 0;
+    const fs_nav_item_t *items = fs_nav_items(nav, &count);
+    for (size_t i = 0; items && i < count; ++i) {
+        if (items[i].is_dir) {
+            return fs_nav_enter(nav, i);
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+static esp_err_t fs_bench_append_lines(const char *path, fs_bench_append_mode_t mode, const char *line,
+                                       uint32_t records, uint32_t record_bytes)
+{
+    if (mode == FS_BENCH_APPEND_DIRECT) {
+        for (uint32_t i = 0; i < records; ++i) {
+            esp_err_t err = fs_text_append(path, line, record_bytes);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        return ESP_OK;
+    }
+
+    fs_append_config_t config = {
+        .prealloc = (mode == FS_BENCH_APPEND_PREALLOC) ? FS_APPEND_PREALLOC_STEP : 0,
+    };
+    fs_append_t stream;
+    esp_err_t err = fs_append_open(&stream, path, &config);
+    if (err != ESP_OK) {
+        return err;
+    }
+    for (uint32_t i = 0; err == ESP_OK && i < records; ++i) {
+        err = fs_append_write(&stream, line, record_bytes);
+    }
+    esp_err_t close_err = fs_append_close(&stream);
+    return (err != ESP_OK) ? err : close_err;
+}
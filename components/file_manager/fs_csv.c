@@ -0,0 +1,781 @@
+#include "fs_csv.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "fs_text_index.h"
+
+static const char *TAG = "fs_csv";
+
+#define FS_CSV_BLOCK                (4 * 1024)      /* Bytes scanned between two cancel checks */
+#define FS_CSV_INDEX_BLOCK_ENTRIES  1024            /* Checkpoints per allocation */
+#define FS_CSV_INDEX_MAX_BLOCKS     256             /* 16M records at the default stride */
+#define FS_CSV_NUMBER_MAX           47              /* Longest cell tried as a number */
+#define FS_CSV_TASK_STACK           (4 * 1024)
+#define FS_CSV_TASK_PRIO            (1)             /* Below the LVGL task: the scan only uses idle time */
+
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t exited;   /* Given by the worker right before it deletes itself */
+    SemaphoreHandle_t lock;     /* Guards @c count and @c rows while the UI reads them */
+    char path[FS_TEXT_MAX_PATH];
+    uint32_t *blocks[FS_CSV_INDEX_MAX_BLOCKS]; /* Checkpoint k is blocks[k / ENTRIES][k % ENTRIES]; blocks never move */
+    uint32_t count;             /* Checkpoints published */
+    uint32_t rows;              /* Records counted so far */
+    volatile size_t total;      /* Bytes the scan reads, set once the file is open */
+    volatile size_t scanned;    /* Bytes read so far */
+    esp_err_t err;
+    volatile bool done;
+    volatile bool cancel;       /* Polled by the scan */
+} fs_csv_index_job_t;
+
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t exited;   /* Given by the worker right before it deletes itself */
+    char path[FS_TEXT_MAX_PATH];
+    char delim;
+    uint32_t column;
+    fs_csv_column_op_t op;
+    volatile size_t total;      /* Bytes the job reads, set once the file is open */
+    volatile size_t scanned;    /* Bytes read so far */
+    fs_csv_column_result_t result; /* Owned here until fs_csv_column_poll() hands it over */
+    esp_err_t err;
+    volatile bool done;
+    volatile bool cancel;       /* Polled by the scan */
+} fs_csv_column_job_t;
+
+static fs_csv_index_job_t s_index;
+static fs_csv_column_job_t s_column;
+
+/**
+ * @brief Skip @p count records from @p offset, starting with quote state @p in_quotes.
+ */
+static esp_err_t fs_csv_skip(fs_text_reader_t *reader, size_t offset, bool in_quotes, uint32_t count,
+                             size_t *out_offset);
+
+/**
+ * @brief Append checkpoint @p offset, allocating a new block when the last one is full.
+ *
+ * @return false if out of memory or past FS_CSV_INDEX_MAX_BLOCKS blocks.
+ */
+static bool fs_csv_index_push(fs_csv_index_job_t *job, uint32_t offset);
+
+/**
+ * @brief Count the records of the job file and publish a checkpoint every FS_CSV_INDEX_STRIDE records.
+ */
+static esp_err_t fs_csv_index_scan(fs_csv_index_job_t *job);
+
+static void fs_csv_index_task(void *arg);
+
+/**
+ * @brief Parse a whole cell as a finite number; leading and trailing spaces are allowed.
+ */
+static bool fs_csv_parse_number(const char *cell, double *out);
+
+/**
+ * @brief True if @p a goes before @p b in the sort order (ties keep file order).
+ */
+static bool fs_csv_sort_before(const fs_csv_sort_entry_t *a, const fs_csv_sort_entry_t *b, bool asc);
+
+/**
+ * @brief Restore the heap below @p i: every parent goes after its children, so the root is the row to drop first.
+ */
+static void fs_csv_heap_down(fs_csv_sort_entry_t *heap, uint32_t count, uint32_t i, bool asc);
+
+/**
+ * @brief Feed the cell of one data row to the stats and the sort heap.
+ */
+static void fs_csv_column_take(fs_csv_column_job_t *job, const char *cell, bool too_long,
+                               uint32_t offset, uint32_t row);
+
+/**
+ * @brief Stream the job file once, extracting the job column of every record.
+ */
+static esp_err_t fs_csv_column_scan(fs_csv_column_job_t *job);
+
+static void fs_csv_column_task(void *arg);
+
+bool fs_csv_is_csv(const char *name)
+{
+    if (!name) {
+        return false;
+    }
+    const char *dot = strrchr(name, '.');
+    return dot && strcasecmp(dot, ".csv") == 0;
+}
+
+char fs_csv_detect_delimiter(const char *buf, size_t len)
+{
+    static const char candidates[] = {',', ';', '\t'};
+    size_t counts[sizeof(candidates)] = {0};
+    bool in_quotes = false;
+
+    for (size_t i = 0; i < len && (in_quotes || buf[i] != '\n'); i++) {
+        if (buf[i] == '"') {
+            in_quotes = !in_quotes;
+            continue;
+        }
+        for (size_t k = 0; !in_quotes && k < sizeof(candidates); k++) {
+            counts[k] += (buf[i] == candidates[k]);
+        }
+    }
+
+    size_t best = 0;
+    for (size_t k = 1; k < sizeof(candidates); k++) {
+        if (counts[k] > counts[best]) {
+            best = k;
+        }
+    }
+    return candidates[best];
+}
+
+bool fs_csv_record_end(const char *buf, size_t len, bool *in_quotes, size_t *out_len)
+{
+    bool quoted = *in_quotes;
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] == '"') {
+            quoted = !quoted;
+        } else if (buf[i] == '\n' && !quoted) {
+            *in_quotes = false;
+            *out_len = i + 1;
+            return true;
+        }
+    }
+    *in_quotes = quoted;
+    *out_len = len;
+    return false;
+}
+
+size_t fs_csv_split(char *rec, size_t len, char delim, uint16_t *out_starts, size_t max)
+{
+    size_t count = 1;
+    size_t w = 0;
+    bool in_quotes = false;
+    bool after_quote = false;
+    out_starts[0] = 0;
+
+    for (size_t r = 0; r < len; r++) {
+        char c = rec[r];
+        if (c == '"') {
+            /* A quote right after a closing one is an escaped quote */
+            if (!in_quotes && after_quote) {
+                rec[w++] = '"';
+            }
+            in_quotes = !in_quotes;
+            after_quote = true;
+            continue;
+        }
+        after_quote = false;
+        if (c == delim && !in_quotes) {
+            rec[w++] = '\0';
+            if (count == max) {
+                return count;
+            }
+            out_starts[count++] = (uint16_t)w;
+            continue;
+        }
+        rec[w++] = c;
+    }
+
+    if (w > out_starts[count - 1] && rec[w - 1] == '\r') {
+        w--;
+    }
+    rec[w] = '\0';
+    return count;
+}
+
+esp_err_t fs_csv_skip_records(fs_text_reader_t *reader, size_t offset, uint32_t count, size_t *out_offset)
+{
+    if (!reader || !reader->file || !out_offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return fs_csv_skip(reader, offset, false, count, out_offset);
+}
+
+esp_err_t fs_csv_read_records(fs_text_reader_t *reader, size_t offset, char *buf, size_t cap,
+                              fs_csv_record_t *out_records, size_t max, size_t *out_count, size_t *out_next)
+{
+    if (!reader || !reader->file || !buf || cap < 2 || cap > FS_CSV_MAX_RECORD + 1 ||
+        !out_records || max == 0 || !out_count || !out_next) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_count = 0;
+    *out_next = offset;
+
+    size_t got = 0;
+    esp_err_t err = fs_text_reader_pread(reader, offset, buf, cap - 1, &got);
+    if (err != ESP_OK) {
+        return err;
+    }
+    bool at_eof = offset + got >= reader->size;
+
+    size_t pos = 0;
+    size_t count = 0;
+    while (pos < got && count < max) {
+        bool in_quotes = false;
+        size_t n = 0;
+        bool ended = fs_csv_record_end(buf + pos, got - pos, &in_quotes, &n);
+        if (!ended && !at_eof) {
+            if (count > 0) {
+                break; // Read again from this record
+            }
+            /* Longer than the buffer: keep the head, find the tail */
+            out_records[0] = (fs_csv_record_t){(uint32_t)offset, 0, (uint16_t)got};
+            *out_count = 1;
+            return fs_csv_skip(reader, offset + got, in_quotes, 1, out_next);
+        }
+        out_records[count++] = (fs_csv_record_t){(uint32_t)(offset + pos), (uint16_t)pos,
+                                                 (uint16_t)(ended ? n - 1 : n)};
+        pos += n;
+    }
+
+    *out_count = count;
+    *out_next = offset + pos;
+    return ESP_OK;
+}
+
+esp_err_t fs_csv_index_start(const char *path)
+{
+    if (!path || strlen(path) >= sizeof(s_index.path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    fs_csv_index_stop();
+
+    fs_csv_index_job_t *job = &s_index;
+    strlcpy(job->path, path, sizeof(job->path));
+    job->exited = xSemaphoreCreateBinary();
+    job->lock = xSemaphoreCreateMutex();
+    if (!job->exited || !job->lock) {
+        goto fail;
+    }
+    if (xTaskCreate(fs_csv_index_task, "fs_csv_index", FS_CSV_TASK_STACK,
+                    job, FS_CSV_TASK_PRIO, &job->task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start the index task");
+        goto fail;
+    }
+    return ESP_OK;
+
+fail:
+    if (job->exited) {
+        vSemaphoreDelete(job->exited);
+    }
+    if (job->lock) {
+        vSemaphoreDelete(job->lock);
+    }
+    memset(job, 0, sizeof(*job));
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t fs_csv_index_poll(uint32_t *out_rows, uint8_t *out_percent)
+{
+    fs_csv_index_job_t *job = &s_index;
+    if (!out_rows) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!job->task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(job->lock, portMAX_DELAY);
+    *out_rows = job->rows;
+    xSemaphoreGive(job->lock);
+    if (out_percent) {
+        size_t total = job->total;
+        *out_percent = total ? (uint8_t)((uint64_t)job->scanned * 100 / total) : 0;
+    }
+    return job->done ? job->err : ESP_ERR_NOT_FINISHED;
+}
+
+esp_err_t fs_csv_index_row_offset(fs_text_reader_t *reader, uint32_t row, size_t *out_offset)
+{
+    fs_csv_index_job_t *job = &s_index;
+    if (!reader || !out_offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!job->task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t k = row / FS_CSV_INDEX_STRIDE;
+    uint32_t offset = 0;
+    xSemaphoreTake(job->lock, portMAX_DELAY);
+    if (job->count == 0) {
+        k = 0;
+    } else {
+        k = (k < job->count) ? k : job->count - 1;
+        offset = job->blocks[k / FS_CSV_INDEX_BLOCK_ENTRIES][k % FS_CSV_INDEX_BLOCK_ENTRIES];
+    }
+    xSemaphoreGive(job->lock);
+
+    return fs_csv_skip_records(reader, offset, row - k * FS_CSV_INDEX_STRIDE, out_offset);
+}
+
+void fs_csv_index_stop(void)
+{
+    fs_csv_index_job_t *job = &s_index;
+    if (!job->task) {
+        return;
+    }
+
+    job->cancel = true;
+    xSemaphoreTake(job->exited, portMAX_DELAY);
+    for (size_t i = 0; i < FS_CSV_INDEX_MAX_BLOCKS && job->blocks[i]; i++) {
+        heap_caps_free(job->blocks[i]);
+    }
+    vSemaphoreDelete(job->exited);
+    vSemaphoreDelete(job->lock);
+    memset(job, 0, sizeof(*job));
+}
+
+esp_err_t fs_csv_column_start(const char *path, char delim, uint32_t column, fs_csv_column_op_t op)
+{
+    if (!path || strlen(path) >= sizeof(s_column.path) || column >= FS_CSV_MAX_FIELDS ||
+        op > FS_CSV_COLUMN_SORT_DESC) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    fs_csv_column_stop();
+
+    fs_csv_column_job_t *job = &s_column;
+    strlcpy(job->path, path, sizeof(job->path));
+    job->delim = delim;
+    job->column = column;
+    job->op = op;
+    job->exited = xSemaphoreCreateBinary();
+    if (!job->exited) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(fs_csv_column_task, "fs_csv_column", FS_CSV_TASK_STACK,
+                    job, FS_CSV_TASK_PRIO, &job->task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start the column task");
+        vSemaphoreDelete(job->exited);
+        memset(job, 0, sizeof(*job));
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t fs_csv_column_poll(fs_csv_column_result_t *out, uint8_t *out_percent)
+{
+    fs_csv_column_job_t *job = &s_column;
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!job->task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (out_percent) {
+        size_t total = job->total;
+        *out_percent = total ? (uint8_t)((uint64_t)job->scanned * 100 / total) : 0;
+    }
+    if (!job->done) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    xSemaphoreTake(job->exited, portMAX_DELAY);
+    esp_err_t err = job->err;
+    if (err == ESP_OK) {
+        *out = job->result;
+    } else {
+        fs_csv_column_free(&job->result);
+    }
+    vSemaphoreDelete(job->exited);
+    memset(job, 0, sizeof(*job));
+    return err;
+}
+
+void fs_csv_column_stop(void)
+{
+    fs_csv_column_job_t *job = &s_column;
+    if (!job->task) {
+        return;
+    }
+
+    job->cancel = true;
+    xSemaphoreTake(job->exited, portMAX_DELAY);
+    fs_csv_column_free(&job->result);
+    vSemaphoreDelete(job->exited);
+    memset(job, 0, sizeof(*job));
+}
+
+void fs_csv_column_free(fs_csv_column_result_t *result)
+{
+    if (!result) {
+        return;
+    }
+    free(result->sorted);
+    memset(result, 0, sizeof(*result));
+}
+
+static esp_err_t fs_csv_skip(fs_text_reader_t *reader, size_t offset, bool in_quotes, uint32_t count,
+                             size_t *out_offset)
+{
+    *out_offset = offset;
+    if (count == 0) {
+        return ESP_OK;
+    }
+    char *buf = malloc(FS_CSV_BLOCK);
+    if (!buf) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t pos = offset;
+    esp_err_t err = ESP_OK;
+    while (count > 0 && pos < reader->size) {
+        size_t got = 0;
+        err = fs_text_reader_pread(reader, pos, buf, FS_CSV_BLOCK, &got);
+        if (err != ESP_OK || got == 0) {
+            break;
+        }
+        size_t i = 0;
+        while (i < got && count > 0) {
+            size_t n = 0;
+            if (fs_csv_record_end(buf + i, got - i, &in_quotes, &n)) {
+                count--;
+            }
+            i += n;
+        }
+        pos += i;
+    }
+    free(buf);
+
+    *out_offset = pos;
+    return err;
+}
+
+static bool fs_csv_index_push(fs_csv_index_job_t *job, uint32_t offset)
+{
+    uint32_t block = job->count / FS_CSV_INDEX_BLOCK_ENTRIES;
+    if (block >= FS_CSV_INDEX_MAX_BLOCKS) {
+        return false;
+    }
+    if (!job->blocks[block]) {
+        size_t bytes = FS_CSV_INDEX_BLOCK_ENTRIES * sizeof(uint32_t);
+        uint32_t *entries = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!entries) {
+            entries = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+        }
+        if (!entries) {
+            return false;
+        }
+        job->blocks[block] = entries;
+    }
+    job->blocks[block][job->count % FS_CSV_INDEX_BLOCK_ENTRIES] = offset;
+
+    /* The entry is in place before the count that exposes it */
+    xSemaphoreTake(job->lock, portMAX_DELAY);
+    job->count++;
+    xSemaphoreGive(job->lock);
+    return true;
+}
+
+static esp_err_t fs_csv_index_scan(fs_csv_index_job_t *job)
+{
+    fs_text_reader_t reader;
+    esp_err_t err = fs_text_reader_open_binary(&reader, job->path);
+    if (err != ESP_OK) {
+        return err;
+    }
+    job->total = reader.size;
+    if ((uint64_t)reader.size > UINT32_MAX) {
+        fs_text_reader_close(&reader);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    char *buf = malloc(FS_CSV_BLOCK);
+    if (!buf || !fs_csv_index_push(job, 0)) {
+        free(buf);
+        fs_text_reader_close(&reader);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t records = 0;
+    uint32_t next = FS_CSV_INDEX_STRIDE;
+    size_t pos = 0;
+    bool in_quotes = false;
+    char last = '\n';
+    while (pos < reader.size) {
+        if (job->cancel) {
+            err = ESP_ERR_INVALID_STATE;
+            break;
+        }
+        size_t got = 0;
+        err = fs_text_reader_pread(&reader, pos, buf, FS_CSV_BLOCK, &got);
+        if (err != ESP_OK || got == 0) {
+            break;
+        }
+
+        /* Most log blocks hold no quote at all: count newlines a word at a time */
+        bool plain = !in_quotes && !memchr(buf, '"', got);
+        size_t n = plain ? fs_text_count_newlines(buf, got) : 0;
+        if (plain && records + n < next) {
+            records += (uint32_t)n;
+        } else {
+            for (size_t i = 0; i < got; i++) {
+                if (buf[i] == '"') {
+                    in_quotes = !in_quotes;
+                } else if (buf[i] == '\n' && !in_quotes && ++records == next) {
+                    if (pos + i + 1 < reader.size && !fs_csv_index_push(job, (uint32_t)(pos + i + 1))) {
+                        err = ESP_ERR_NO_MEM;
+                        break;
+                    }
+                    next += FS_CSV_INDEX_STRIDE;
+                }
+            }
+            if (err != ESP_OK) {
+                break;
+            }
+        }
+        last = buf[got - 1];
+        pos += got;
+        job->scanned = pos;
+
+        xSemaphoreTake(job->lock, portMAX_DELAY);
+        job->rows = records;
+        xSemaphoreGive(job->lock);
+    }
+
+    if (err == ESP_OK && pos > 0 && last != '\n') {
+        /* A last record without a trailing newline */
+        xSemaphoreTake(job->lock, portMAX_DELAY);
+        job->rows = records + 1;
+        xSemaphoreGive(job->lock);
+    }
+    free(buf);
+    fs_text_reader_close(&reader);
+
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Indexed %s: %lu records, %lu checkpoints", job->path,
+                 (unsigned long)job->rows, (unsigned long)job->count);
+    } else if (err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Indexing %s failed: %s", job->path, esp_err_to_name(err));
+    }
+    return err;
+}
+
+static void fs_csv_index_task(void *arg)
+{
+    fs_csv_index_job_t *job = (fs_csv_index_job_t *)arg;
+
+    job->err = fs_csv_index_scan(job);
+    job->done = true;
+
+    xSemaphoreGive(job->exited);
+    vTaskDelete(NULL);
+}
+
+static bool fs_csv_parse_number(const char *cell, double *out)
+{
+    char *end = NULL;
+    double v = strtod(cell, &end);
+    if (end == cell) {
+        return false;
+    }
+    while (*end == ' ' || *end == '\t') {
+        end++;
+    }
+    if (*end != '\0' || !isfinite(v)) {
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+static bool fs_csv_sort_before(const fs_csv_sort_entry_t *a, const fs_csv_sort_entry_t *b, bool asc)
+{
+    if (a->key != b->key) {
+        return asc ? a->key < b->key : a->key > b->key;
+    }
+    return a->row < b->row;
+}
+
+static void fs_csv_heap_down(fs_csv_sort_entry_t *heap, uint32_t count, uint32_t i, bool asc)
+{
+    for (;;) {
+        uint32_t last = i;
+        uint32_t l = 2 * i + 1;
+        uint32_t r = l + 1;
+        if (l < count && fs_csv_sort_before(&heap[last], &heap[l], asc)) {
+            last = l;
+        }
+        if (r < count && fs_csv_sort_before(&heap[last], &heap[r], asc)) {
+            last = r;
+        }
+        if (last == i) {
+            return;
+        }
+        fs_csv_sort_entry_t tmp = heap[i];
+        heap[i] = heap[last];
+        heap[last] = tmp;
+        i = last;
+    }
+}
+
+static void fs_csv_column_take(fs_csv_column_job_t *job, const char *cell, bool too_long,
+                               uint32_t offset, uint32_t row)
+{
+    fs_csv_column_result_t *res = &job->result;
+    res->rows++;
+
+    double v = 0;
+    if (too_long || !fs_csv_parse_number(cell, &v)) {
+        return;
+    }
+    if (res->numeric == 0 || v < res->min) {
+        res->min = v;
+    }
+    if (res->numeric == 0 || v > res->max) {
+        res->max = v;
+    }
+    res->numeric++;
+    res->sum += v;
+
+    if (job->op == FS_CSV_COLUMN_STATS) {
+        return;
+    }
+    bool asc = job->op == FS_CSV_COLUMN_SORT_ASC;
+    fs_csv_sort_entry_t entry = {v, offset, row};
+    fs_csv_sort_entry_t *heap = res->sorted;
+    if (res->sorted_count < FS_CSV_SORT_MAX) {
+        uint32_t i = res->sorted_count++;
+        while (i > 0 && fs_csv_sort_before(&heap[(i - 1) / 2], &entry, asc)) {
+            heap[i] = heap[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        heap[i] = entry;
+    } else if (fs_csv_sort_before(&entry, &heap[0], asc)) {
+        heap[0] = entry;
+        fs_csv_heap_down(heap, res->sorted_count, 0, asc);
+    }
+}
+
+static esp_err_t fs_csv_column_scan(fs_csv_column_job_t *job)
+{
+    fs_text_reader_t reader;
+    esp_err_t err = fs_text_reader_open_binary(&reader, job->path);
+    if (err != ESP_OK) {
+        return err;
+    }
+    job->total = reader.size;
+
+    char *buf = malloc(FS_CSV_BLOCK);
+    if (job->op != FS_CSV_COLUMN_STATS) {
+        job->result.sorted = malloc(FS_CSV_SORT_MAX * sizeof(fs_csv_sort_entry_t));
+    }
+    if (!buf || (job->op != FS_CSV_COLUMN_STATS && !job->result.sorted)) {
+        free(buf);
+        fs_text_reader_close(&reader);
+        return ESP_ERR_NO_MEM;
+    }
+
+    char cell[FS_CSV_NUMBER_MAX + 1];
+    size_t cell_len = 0;
+    bool too_long = false;
+    uint32_t field = 0;
+    uint32_t row = 0;
+    size_t row_offset = 0;
+    bool in_quotes = false;
+    bool after_quote = false;
+    size_t pos = 0;
+    while (pos < reader.size) {
+        if (job->cancel) {
+            err = ESP_ERR_INVALID_STATE;
+            break;
+        }
+        size_t got = 0;
+        err = fs_text_reader_pread(&reader, pos, buf, FS_CSV_BLOCK, &got);
+        if (err != ESP_OK || got == 0) {
+            break;
+        }
+
+        for (size_t i = 0; i < got; i++) {
+            char c = buf[i];
+            if (c == '"') {
+                if (!in_quotes && after_quote && field == job->column) {
+                    c = '"'; // Escaped quote: keep one
+                } else {
+                    in_quotes = !in_quotes;
+                    after_quote = true;
+                    continue;
+                }
+                in_quotes = true;
+            }
+            after_quote = false;
+            if (!in_quotes) {
+                if (c == '\n') {
+                    cell[cell_len] = '\0';
+                    if (row > 0) {
+                        fs_csv_column_take(job, cell, too_long, (uint32_t)row_offset, row);
+                    }
+                    row++;
+                    row_offset = pos + i + 1;
+                    field = 0;
+                    cell_len = 0;
+                    too_long = false;
+                    continue;
+                }
+                if (c == job->delim) {
+                    field++;
+                    continue;
+                }
+                if (c == '\r') {
+                    continue;
+                }
+            }
+            if (field == job->column) {
+                if (cell_len < FS_CSV_NUMBER_MAX) {
+                    cell[cell_len++] = c;
+                } else {
+                    too_long = true;
+                }
+            }
+        }
+        pos += got;
+        job->scanned = pos;
+    }
+
+    if (err == ESP_OK && row_offset < pos) {
+        /* A last record without a trailing newline */
+        cell[cell_len] = '\0';
+        if (row > 0) {
+            fs_csv_column_take(job, cell, too_long, (uint32_t)row_offset, row);
+        }
+    }
+    free(buf);
+    fs_text_reader_close(&reader);
+
+    if (err == ESP_OK && job->result.sorted) {
+        /* Heap sort in place: the root goes after everything left, so pop it to the back */
+        bool asc = job->op == FS_CSV_COLUMN_SORT_ASC;
+        fs_csv_sort_entry_t *heap = job->result.sorted;
+        for (uint32_t n = job->result.sorted_count; n > 1; n--) {
+            fs_csv_sort_entry_t tmp = heap[0];
+            heap[0] = heap[n - 1];
+            heap[n - 1] = tmp;
+            fs_csv_heap_down(heap, n - 1, 0, asc);
+        }
+    }
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Column scan of %s failed: %s", job->path, esp_err_to_name(err));
+    }
+    return err;
+}
+
+static void fs_csv_column_task(void *arg)
+{
+    fs_csv_column_job_t *job = (fs_csv_column_job_t *)arg;
+
+    job->err = fs_csv_column_scan(job);
+    job->done = true;
+
+    xSemaphoreGive(job->exited);
+    vTaskDelete(NULL);
+}
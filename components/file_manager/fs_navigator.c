@@ -82,7 +82,7 @@ static esp_err_t fs_nav_set_relative(fs_nav_t *nav, const char *relative);
 /**
  * @brief Persist current relative path and sort settings to NVS.
  *
- * Computes CRC32 over blob fields and commits.
+ * Computes CRC32 over blob fields and commits. Does nothing for a stateless navigator.
  *
  * @param[in] nav Navigator.
  * @return
@@ -143,6 +143,7 @@ esp_err_t fs_nav_init(fs_nav_t *nav, const fs_nav_config_t *cfg)
 
     memset(nav, 0, sizeof(*nav));
     nav->max_items = cfg->max_items;
+    nav->stateless = cfg->stateless;
     nav->sort_mode = FS_NAV_SORT_NAME;
     nav->ascending = true;
     nav->sort_enabled = true;
@@ -174,9 +175,11 @@ esp_err_t fs_nav_init(fs_nav_t *nav, const fs_nav_config_t *cfg)
         return ESP_ERR_NOT_FOUND;
     }
 
-    esp_err_t state_err = fs_nav_load_state(nav);
-    if (state_err != ESP_OK) {
-        ESP_LOGW(TAG, "Using default navigator state (%s)", esp_err_to_name(state_err));
+    if (!nav->stateless) {
+        esp_err_t state_err = fs_nav_load_state(nav);
+        if (state_err != ESP_OK) {
+            ESP_LOGW(TAG, "Using default navigator state (%s)", esp_err_to_name(state_err));
+        }
     }
 
     err = fs_nav_refresh(nav);
@@ -747,6 +750,10 @@ static esp_err_t fs_nav_set_relative(fs_nav_t *nav, const char *relative)
 
 static esp_err_t fs_nav_store_state(const fs_nav_t *nav)
 {
+    if (nav->stateless) {
+        return ESP_OK;
+    }
+
     nvs_handle_t handle;
     esp_err_t err = nvs_open(FS_NAV_NVS_NAMESPACE, NVS_READWRITE, &handle);
     if (err != ESP_OK) {
@@ -0,0 +1,422 @@
+#include "fs_text_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "fs_text_ops.h"
+
+static const char *TAG = "fs_text_cache";
+
+#define FS_TEXT_CACHE_TASK_STACK    (4 * 1024)
+#define FS_TEXT_CACHE_TASK_PRIO     (1)             /* Below the LVGL task: read-ahead only uses idle time */
+
+typedef struct {
+    size_t offset;              /* Chunk boundary, SIZE_MAX if the slot is empty */
+    size_t len;
+    size_t before_of;           /* Boundary this chunk is fs_text_chunk_before() of, SIZE_MAX if unknown */
+    char data[READ_CHUNK_SIZE_B];
+} fs_text_cache_slot_t;
+
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t lock;     /* Guards the slots, the requests and the counters */
+    SemaphoreHandle_t exited;   /* Given by the worker right before it deletes itself */
+    fs_text_cache_slot_t *slots;
+    size_t head;                /* Next slot the ring overwrites */
+    fs_text_reader_t fg;        /* Handle for on-demand reads (caller's task) */
+    fs_text_reader_t bg;        /* Handle for read-ahead (worker task) */
+    char *scratch;              /* Worker chunk buffer, READ_CHUNK_SIZE_B + 1 bytes */
+    size_t want_next;           /* Pending read-ahead requests, SIZE_MAX if none */
+    size_t want_prev_end;
+    uint32_t generation;        /* Bumped when the file grows; chunks read before that are not stored */
+    uint32_t bg_generation;     /* Generation the worker's reader was opened at */
+    char path[FS_TEXT_MAX_PATH];
+    fs_text_cache_stats_t stats;
+    volatile bool quit;
+} fs_text_cache_ctx_t;
+
+static fs_text_cache_ctx_t s_cache;
+
+/**
+ * @brief Returns true if chunks of @p path are cached here.
+ */
+static bool fs_text_cache_serves(const char *path);
+
+/**
+ * @brief Find the slot holding the chunk at @p offset. Call with the lock held.
+ *
+ * @return The slot, or NULL.
+ */
+static fs_text_cache_slot_t *fs_text_cache_find(size_t offset);
+
+/**
+ * @brief Store a chunk in the ring. Call with the lock held.
+ */
+static void fs_text_cache_store(size_t offset, const char *data, size_t len, size_t before_of);
+
+/**
+ * @brief Drop the slots that depend on bytes at or past @p size. Call with the lock held.
+ */
+static void fs_text_cache_drop_from(size_t size);
+
+/**
+ * @brief fs_text_reader_chunk_before() on @p reader, answered from the ring when it is known.
+ */
+static esp_err_t fs_text_cache_resolve(fs_text_reader_t *reader, size_t end, size_t *out_offset);
+
+/**
+ * @brief Read the chunk at @p offset into the ring if it is not cached yet (read-ahead task).
+ *
+ * @param offset     Chunk boundary.
+ * @param before_of  Boundary @p offset is fs_text_chunk_before() of, or SIZE_MAX.
+ * @param generation Generation the request was taken at; the chunk is dropped if the file grew since.
+ * @param out_len    Receives the chunk length.
+ *
+ * @return true if the chunk is cached now.
+ */
+static bool fs_text_cache_fetch(size_t offset, size_t before_of, uint32_t generation, size_t *out_len);
+
+/**
+ * @brief Read-ahead task: serve the pending requests until told to quit.
+ *
+ * @param arg Unused.
+ */
+static void fs_text_cache_task(void *arg);
+
+esp_err_t fs_text_cache_open(const char *path)
+{
+    fs_text_cache_ctx_t *ctx = &s_cache;
+    if (!path || strlen(path) >= sizeof(ctx->path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ctx->task && strcmp(ctx->path, path) == 0) {
+        return ESP_OK;
+    }
+    fs_text_cache_close();
+
+    fs_text_cache_stats_t stats = ctx->stats;
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->stats = stats;
+    strlcpy(ctx->path, path, sizeof(ctx->path));
+    ctx->want_next = SIZE_MAX;
+    ctx->want_prev_end = SIZE_MAX;
+
+    esp_err_t err = fs_text_reader_open(&ctx->fg, path);
+    if (err == ESP_OK) {
+        err = fs_text_reader_open(&ctx->bg, path);
+    }
+    if (err != ESP_OK) {
+        goto fail;
+    }
+    err = ESP_ERR_NO_MEM;
+    ctx->slots = malloc(FS_TEXT_CACHE_SLOTS * sizeof(fs_text_cache_slot_t));
+    ctx->scratch = malloc(READ_CHUNK_SIZE_B + 1);
+    ctx->lock = xSemaphoreCreateMutex();
+    ctx->exited = xSemaphoreCreateBinary();
+    if (!ctx->slots || !ctx->scratch || !ctx->lock || !ctx->exited) {
+        goto fail;
+    }
+    for (size_t i = 0; i < FS_TEXT_CACHE_SLOTS; i++) {
+        ctx->slots[i].offset = SIZE_MAX;
+    }
+
+    if (xTaskCreate(fs_text_cache_task, "fs_text_cache", FS_TEXT_CACHE_TASK_STACK,
+                    ctx, FS_TEXT_CACHE_TASK_PRIO, &ctx->task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start the read-ahead task");
+        ctx->task = NULL;
+        goto fail;
+    }
+    return ESP_OK;
+
+fail:
+    fs_text_reader_close(&ctx->fg);
+    fs_text_reader_close(&ctx->bg);
+    free(ctx->slots);
+    free(ctx->scratch);
+    if (ctx->lock) {
+        vSemaphoreDelete(ctx->lock);
+    }
+    if (ctx->exited) {
+        vSemaphoreDelete(ctx->exited);
+    }
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->stats = stats;
+    return err;
+}
+
+void fs_text_cache_close(void)
+{
+    fs_text_cache_ctx_t *ctx = &s_cache;
+    if (!ctx->task) {
+        return;
+    }
+
+    ctx->quit = true;
+    xTaskNotifyGive(ctx->task);
+    xSemaphoreTake(ctx->exited, portMAX_DELAY);
+    ESP_LOGD(TAG, "Closed %s (%lu hits / %lu misses / %lu prefetched)", ctx->path,
+             (unsigned long)ctx->stats.hits, (unsigned long)ctx->stats.misses,
+             (unsigned long)ctx->stats.prefetched);
+
+    fs_text_cache_stats_t stats = ctx->stats;
+    fs_text_reader_close(&ctx->fg);
+    fs_text_reader_close(&ctx->bg);
+    free(ctx->slots);
+    free(ctx->scratch);
+    vSemaphoreDelete(ctx->lock);
+    vSemaphoreDelete(ctx->exited);
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->stats = stats;
+}
+
+esp_err_t fs_text_cache_read(const char *path, size_t offset, char *buf, size_t *out_len)
+{
+    fs_text_cache_ctx_t *ctx = &s_cache;
+    if (!buf || !out_len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!fs_text_cache_serves(path)) {
+        fs_text_reader_t reader;
+        esp_err_t err = fs_text_reader_open(&reader, path);
+        if (err == ESP_OK) {
+            err = fs_text_reader_chunk(&reader, offset, buf, out_len);
+            fs_text_reader_close(&reader);
+        }
+        return err;
+    }
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    fs_text_cache_slot_t *slot = fs_text_cache_find(offset);
+    if (slot) {
+        memcpy(buf, slot->data, slot->len);
+        buf[slot->len] = '\0';
+        *out_len = slot->len;
+        ctx->stats.hits++;
+        xSemaphoreGive(ctx->lock);
+        return ESP_OK;
+    }
+    ctx->stats.misses++;
+    xSemaphoreGive(ctx->lock);
+
+    esp_err_t err = fs_text_reader_chunk(&ctx->fg, offset, buf, out_len);
+    if (err != ESP_OK) {
+        return err;
+    }
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    fs_text_cache_store(offset, buf, *out_len, SIZE_MAX);
+    xSemaphoreGive(ctx->lock);
+    return ESP_OK;
+}
+
+esp_err_t fs_text_cache_before(const char *path, size_t end, size_t *out_offset)
+{
+    fs_text_cache_ctx_t *ctx = &s_cache;
+    if (!out_offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (fs_text_cache_serves(path)) {
+        return fs_text_cache_resolve(&ctx->fg, end, out_offset);
+    }
+    return fs_text_chunk_before(path, end, out_offset);
+}
+
+esp_err_t fs_text_cache_refresh(void)
+{
+    fs_text_cache_ctx_t *ctx = &s_cache;
+    if (!ctx->task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t old_size = ctx->fg.size;
+    fs_text_reader_close(&ctx->fg);
+    esp_err_t err = fs_text_reader_open(&ctx->fg, ctx->path);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to reopen %s", ctx->path);
+        fs_text_cache_close();
+        return err;
+    }
+
+    /* Chunks cut before the old end keep their boundaries; the one that reached it does not */
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    ctx->generation++;
+    fs_text_cache_drop_from(old_size < ctx->fg.size ? old_size : ctx->fg.size);
+    xSemaphoreGive(ctx->lock);
+    return ESP_OK;
+}
+
+void fs_text_cache_prefetch(size_t next, size_t prev_end)
+{
+    fs_text_cache_ctx_t *ctx = &s_cache;
+    if (!ctx->task) {
+        return;
+    }
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    if (next != SIZE_MAX) {
+        ctx->want_next = next;
+    }
+    if (prev_end != SIZE_MAX) {
+        ctx->want_prev_end = prev_end;
+    }
+    xSemaphoreGive(ctx->lock);
+    xTaskNotifyGive(ctx->task);
+}
+
+void fs_text_cache_get_stats(fs_text_cache_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    *out = s_cache.stats;
+}
+
+static bool fs_text_cache_serves(const char *path)
+{
+    return s_cache.task && path && strcmp(s_cache.path, path) == 0;
+}
+
+static fs_text_cache_slot_t *fs_text_cache_find(size_t offset)
+{
+    for (size_t i = 0; i < FS_TEXT_CACHE_SLOTS; i++) {
+        if (s_cache.slots[i].offset == offset) {
+            return &s_cache.slots[i];
+        }
+    }
+    return NULL;
+}
+
+static void fs_text_cache_store(size_t offset, const char *data, size_t len, size_t before_of)
+{
+    fs_text_cache_ctx_t *ctx = &s_cache;
+    if (len > READ_CHUNK_SIZE_B) {
+        return;
+    }
+
+    fs_text_cache_slot_t *slot = fs_text_cache_find(offset);
+    if (!slot) {
+        slot = &ctx->slots[ctx->head];
+        ctx->head = (ctx->head + 1) % FS_TEXT_CACHE_SLOTS;
+        slot->before_of = SIZE_MAX;
+    }
+    slot->offset = offset;
+    slot->len = len;
+    memcpy(slot->data, data, len);
+    if (before_of != SIZE_MAX) {
+        slot->before_of = before_of;
+    }
+}
+
+static void fs_text_cache_drop_from(size_t size)
+{
+    for (size_t i = 0; i < FS_TEXT_CACHE_SLOTS; i++) {
+        fs_text_cache_slot_t *slot = &s_cache.slots[i];
+        if (slot->offset != SIZE_MAX && slot->offset + READ_CHUNK_SIZE_B > size) {
+            slot->offset = SIZE_MAX;
+        } else if (slot->before_of != SIZE_MAX && slot->before_of > size) {
+            slot->before_of = SIZE_MAX;
+        }
+    }
+}
+
+static esp_err_t fs_text_cache_resolve(fs_text_reader_t *reader, size_t end, size_t *out_offset)
+{
+    fs_text_cache_ctx_t *ctx = &s_cache;
+    bool found = false;
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    for (size_t i = 0; i < FS_TEXT_CACHE_SLOTS; i++) {
+        if (ctx->slots[i].offset != SIZE_MAX && ctx->slots[i].before_of == end) {
+            *out_offset = ctx->slots[i].offset;
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(ctx->lock);
+    if (found) {
+        return ESP_OK;
+    }
+    return fs_text_reader_chunk_before(reader, end, out_offset);
+}
+
+static bool fs_text_cache_fetch(size_t offset, size_t before_of, uint32_t generation, size_t *out_len)
+{
+    fs_text_cache_ctx_t *ctx = &s_cache;
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    fs_text_cache_slot_t *slot = fs_text_cache_find(offset);
+    if (slot) {
+        if (before_of != SIZE_MAX) {
+            slot->before_of = before_of;
+        }
+        *out_len = slot->len;
+    }
+    xSemaphoreGive(ctx->lock);
+    if (slot) {
+        return true;
+    }
+
+    size_t len = 0;
+    if (fs_text_reader_chunk(&ctx->bg, offset, ctx->scratch, &len) != ESP_OK) {
+        return false;
+    }
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    if (ctx->generation == generation) {
+        fs_text_cache_store(offset, ctx->scratch, len, before_of);
+        ctx->stats.prefetched++;
+    }
+    xSemaphoreGive(ctx->lock);
+
+    *out_len = len;
+    return true;
+}
+
+static void fs_text_cache_task(void *arg)
+{
+    fs_text_cache_ctx_t *ctx = (fs_text_cache_ctx_t *)arg;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (ctx->quit) {
+            break;
+        }
+
+        xSemaphoreTake(ctx->lock, portMAX_DELAY);
+        size_t next = ctx->want_next;
+        size_t prev_end = ctx->want_prev_end;
+        ctx->want_next = SIZE_MAX;
+        ctx->want_prev_end = SIZE_MAX;
+        uint32_t generation = ctx->generation;
+        xSemaphoreGive(ctx->lock);
+
+        /* The file grew: this handle still sees the old size */
+        if (ctx->bg_generation != generation) {
+            fs_text_reader_close(&ctx->bg);
+            if (fs_text_reader_open(&ctx->bg, ctx->path) != ESP_OK) {
+                continue;
+            }
+            ctx->bg_generation = generation;
+        }
+
+        size_t len = 0;
+        if (next != SIZE_MAX) {
+            fs_text_cache_fetch(next, SIZE_MAX, generation, &len);
+        }
+
+        /* The window before @p prev_end is its two chunks: resolve the boundary once and keep it */
+        size_t start = 0;
+        if (prev_end != SIZE_MAX && !ctx->quit &&
+            fs_text_cache_resolve(&ctx->bg, prev_end, &start) == ESP_OK &&
+            fs_text_cache_fetch(start, prev_end, generation, &len) && !ctx->quit) {
+            fs_text_cache_fetch(start + len, SIZE_MAX, generation, &len);
+        }
+    }
+
+    xSemaphoreGive(ctx->exited);
+    vTaskDelete(NULL);
+}
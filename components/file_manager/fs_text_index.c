@@ -0,0 +1,543 @@
+#include "fs_text_index.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "sdkconfig.h"
+#include "fs_text_ops.h"
+
+static const char *TAG = "fs_text_index";
+
+#define FS_TEXT_INDEX_MAGIC         0x5844494Cu     /* "LIDX" */
+#define FS_TEXT_INDEX_BLOCK         (4 * 1024)      /* Bytes scanned between two cancel checks */
+#define FS_TEXT_INDEX_MIN_CAP       64              /* Checkpoints allocated up front */
+#define FS_TEXT_INDEX_TASK_STACK    (4 * 1024)
+#define FS_TEXT_INDEX_TASK_PRIO     (1)             /* Below the LVGL task: the scan only uses idle time */
+
+/*
+ * Sidecar layout: this header, then @c count little-endian uint32 offsets.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t stride;            /* Stride the file was built with */
+    uint32_t lines;
+    uint32_t count;
+    uint32_t size;              /* File size at build time */
+    int64_t mtime;              /* File modification time at build time */
+    uint32_t offsets_crc;       /* CRC32 of the offsets */
+    uint32_t crc;               /* CRC32 of the fields above */
+} fs_text_index_hdr_t;
+
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t exited;   /* Given by the worker right before it deletes itself */
+    char path[FS_TEXT_MAX_PATH];
+    fs_text_index_t index;      /* Result, owned here until fs_text_index_poll() hands it over */
+    esp_err_t err;
+    volatile bool done;
+    volatile bool cancel;       /* Polled by the scan */
+} fs_text_index_job_t;
+
+static fs_text_index_job_t s_job;
+
+/**
+ * @brief Build "<dir>/.<name>.idx" for @p path.
+ *
+ * @retval ESP_OK               On success.
+ * @retval ESP_ERR_INVALID_SIZE The sidecar path does not fit @p out_len.
+ */
+static esp_err_t fs_text_index_sidecar(const char *path, char *out, size_t out_len);
+
+/**
+ * @brief Load the sidecar of @p path if it matches @p size and @p mtime.
+ *
+ * @return true if @p out now holds the persisted index.
+ */
+static bool fs_text_index_load(const char *path, uint32_t size, int64_t mtime, fs_text_index_t *out);
+
+/**
+ * @brief Persist @p index next to @p path; a failure only costs the next open a rescan.
+ */
+static void fs_text_index_save(const char *path, const fs_text_index_t *index);
+
+/**
+ * @brief Append a checkpoint, growing the array (in PSRAM when available).
+ *
+ * Once FS_TEXT_INDEX_MAX_POINTS are stored, every other checkpoint is dropped
+ * in place and the stride doubles. The caller computes its next checkpoint
+ * from @c index->stride afterwards.
+ *
+ * @return true on success.
+ */
+static bool fs_text_index_push(fs_text_index_t *index, uint32_t *cap, uint32_t offset);
+
+/**
+ * @brief Scan @p f from @p offset until @p newlines more newlines have been passed.
+ *
+ * @param out_offset Receives the offset right after the last of them (EOF if the file ends first).
+ */
+static esp_err_t fs_text_index_skip_lines(FILE *f, uint32_t offset, uint32_t newlines, size_t *out_offset);
+
+/**
+ * @brief Worker task: run one build for @c s_job and exit.
+ *
+ * @param arg Unused.
+ */
+static void fs_text_index_task(void *arg);
+
+size_t fs_text_count_newlines(const char *buf, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+    size_t count = 0;
+
+    while (len > 0 && ((uintptr_t)p & 3u) != 0) {
+        count += (*p++ == '\n');
+        len--;
+    }
+
+    /* Per word: 0x80 in every byte that equals '\n', then sum the flags with one multiply */
+    const uint32_t *w = (const uint32_t *)p;
+    for (; len >= 4; len -= 4) {
+        uint32_t x = *w++ ^ 0x0A0A0A0Au;
+        uint32_t y = ~(((x & 0x7F7F7F7Fu) + 0x7F7F7F7Fu) | x | 0x7F7F7F7Fu);
+        count += ((y >> 7) * 0x01010101u) >> 24;
+    }
+
+    p = (const unsigned char *)w;
+    while (len-- > 0) {
+        count += (*p++ == '\n');
+    }
+    return count;
+}
+
+esp_err_t fs_text_index_build(const char *path, fs_text_index_t *out, const volatile bool *cancel)
+{
+    if (!path || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(out, 0, sizeof(*out));
+
+    struct stat st = {0};
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ESP_LOGE(TAG, "stat(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    if ((uint64_t)st.st_size > UINT32_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint32_t size = (uint32_t)st.st_size;
+    const int64_t mtime = (int64_t)st.st_mtime;
+
+    if (size >= FS_TEXT_INDEX_PERSIST_MIN && fs_text_index_load(path, size, mtime, out)) {
+        ESP_LOGI(TAG, "Loaded index of %s (%lu lines)", path, (unsigned long)out->lines);
+        return ESP_OK;
+    }
+
+    FILE *f = fopen(path, "rb");
+    char *buf = malloc(FS_TEXT_INDEX_BLOCK);
+    uint32_t cap = 0;
+    esp_err_t err = ESP_OK;
+    if (!f || !buf) {
+        err = f ? ESP_ERR_NO_MEM : ESP_FAIL;
+        goto done;
+    }
+    out->stride = FS_TEXT_INDEX_STRIDE;
+    if (!fs_text_index_push(out, &cap, 0)) {
+        err = ESP_ERR_NO_MEM;
+        goto done;
+    }
+
+    uint32_t newlines = 0;
+    uint32_t next = out->stride;
+    uint32_t pos = 0;
+    char last = '\n';
+    for (;;) {
+        if (cancel && *cancel) {
+            err = ESP_ERR_INVALID_STATE;
+            goto done;
+        }
+        size_t got = fread(buf, 1, FS_TEXT_INDEX_BLOCK, f);
+        if (got == 0) {
+            if (ferror(f)) {
+                ESP_LOGE(TAG, "fread(%s) failed (errno=%d)", path, errno);
+                err = ESP_FAIL;
+                goto done;
+            }
+            break;
+        }
+
+        size_t n = fs_text_count_newlines(buf, got);
+        if (newlines + n < next) {
+            newlines += n;
+        } else {
+            /* A checkpoint falls into this block: walk it byte by byte */
+            for (size_t i = 0; i < got; i++) {
+                if (buf[i] == '\n' && ++newlines == next) {
+                    if (!fs_text_index_push(out, &cap, pos + (uint32_t)i + 1)) {
+                        err = ESP_ERR_NO_MEM;
+                        goto done;
+                    }
+                    next += out->stride;
+                }
+            }
+        }
+        last = buf[got - 1];
+        pos += (uint32_t)got;
+    }
+
+    out->lines = newlines + (last != '\n' ? 1 : 0);
+    if (out->count > 1 && out->offsets[out->count - 1] >= pos) {
+        /* The file ends with the newline that completed the last stride */
+        out->count--;
+    }
+    out->size = pos;
+    out->mtime = mtime;
+
+done:
+    free(buf);
+    if (f) {
+        fclose(f);
+    }
+    if (err != ESP_OK) {
+        if (err != ESP_ERR_INVALID_STATE) {
+            ESP_LOGE(TAG, "Indexing %s failed: %s", path, esp_err_to_name(err));
+        }
+        fs_text_index_free(out);
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Indexed %s: %lu lines, %lu checkpoints every %lu lines", path,
+             (unsigned long)out->lines, (unsigned long)out->count, (unsigned long)out->stride);
+    if (size >= FS_TEXT_INDEX_PERSIST_MIN) {
+        fs_text_index_save(path, out);
+    }
+    return ESP_OK;
+}
+
+esp_err_t fs_text_index_start(const char *path)
+{
+    if (!path || strlen(path) >= sizeof(s_job.path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    fs_text_index_stop();
+
+    fs_text_index_job_t *job = &s_job;
+    strlcpy(job->path, path, sizeof(job->path));
+    job->exited = xSemaphoreCreateBinary();
+    if (!job->exited) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(fs_text_index_task, "fs_text_index", FS_TEXT_INDEX_TASK_STACK,
+                    job, FS_TEXT_INDEX_TASK_PRIO, &job->task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start the index task");
+        vSemaphoreDelete(job->exited);
+        memset(job, 0, sizeof(*job));
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t fs_text_index_poll(fs_text_index_t *out)
+{
+    fs_text_index_job_t *job = &s_job;
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!job->task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!job->done) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    xSemaphoreTake(job->exited, portMAX_DELAY);
+    esp_err_t err = job->err;
+    if (err == ESP_OK) {
+        *out = job->index;
+    }
+    vSemaphoreDelete(job->exited);
+    memset(job, 0, sizeof(*job));
+    return err;
+}
+
+void fs_text_index_stop(void)
+{
+    fs_text_index_job_t *job = &s_job;
+    if (!job->task) {
+        return;
+    }
+
+    job->cancel = true;
+    xSemaphoreTake(job->exited, portMAX_DELAY);
+    fs_text_index_free(&job->index);
+    vSemaphoreDelete(job->exited);
+    memset(job, 0, sizeof(*job));
+}
+
+void fs_text_index_free(fs_text_index_t *index)
+{
+    if (!index) {
+        return;
+    }
+    heap_caps_free(index->offsets);
+    memset(index, 0, sizeof(*index));
+}
+
+void fs_text_index_forget(const char *path)
+{
+    char sidecar[FS_TEXT_MAX_PATH + 8];
+    if (path && fs_text_index_sidecar(path, sidecar, sizeof(sidecar)) == ESP_OK) {
+        remove(sidecar);
+    }
+}
+
+esp_err_t fs_text_index_line_offset(const char *path, const fs_text_index_t *index, uint32_t line, size_t *out_offset)
+{
+    if (!path || !index || !index->offsets || index->stride == 0 || !out_offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (index->lines == 0) {
+        *out_offset = 0;
+        return ESP_OK;
+    }
+    if (line >= index->lines) {
+        line = index->lines - 1;
+    }
+
+    uint32_t k = line / index->stride;
+    if (k >= index->count) {
+        k = index->count - 1;
+    }
+    uint32_t skip = line - k * index->stride;
+    if (skip == 0) {
+        *out_offset = index->offsets[k];
+        return ESP_OK;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    esp_err_t err = fs_text_index_skip_lines(f, index->offsets[k], skip, out_offset);
+    fclose(f);
+    return err;
+}
+
+esp_err_t fs_text_index_offset_line(const char *path, const fs_text_index_t *index, size_t offset, uint32_t *out_line)
+{
+    if (!path || !index || !index->offsets || index->count == 0 || index->stride == 0 || !out_line) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset > index->size) {
+        offset = index->size;
+    }
+
+    /* Last checkpoint at or before @p offset */
+    uint32_t lo = 0;
+    uint32_t hi = index->count - 1;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo + 1) / 2;
+        if (index->offsets[mid] <= offset) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    uint32_t line = lo * index->stride;
+    size_t pos = index->offsets[lo];
+    if (pos < offset) {
+        FILE *f = fopen(path, "rb");
+        char *buf = malloc(FS_TEXT_INDEX_BLOCK);
+        if (!f || !buf || fseek(f, (long)pos, SEEK_SET) != 0) {
+            esp_err_t err = (f && !buf) ? ESP_ERR_NO_MEM : ESP_FAIL;
+            free(buf);
+            if (f) {
+                fclose(f);
+            }
+            return err;
+        }
+        while (pos < offset) {
+            size_t want = offset - pos < FS_TEXT_INDEX_BLOCK ? offset - pos : FS_TEXT_INDEX_BLOCK;
+            size_t got = fread(buf, 1, want, f);
+            if (got == 0) {
+                break;
+            }
+            line += (uint32_t)fs_text_count_newlines(buf, got);
+            pos += got;
+        }
+        free(buf);
+        fclose(f);
+    }
+
+    *out_line = line;
+    return ESP_OK;
+}
+
+static esp_err_t fs_text_index_sidecar(const char *path, char *out, size_t out_len)
+{
+    const char *slash = strrchr(path, '/');
+    int dir_len = slash ? (int)(slash - path) : 0;
+    const char *name = slash ? slash + 1 : path;
+    int n = slash ? snprintf(out, out_len, "%.*s/.%s.idx", dir_len, path, name)
+                  : snprintf(out, out_len, ".%s.idx", name);
+    return (n < 0 || (size_t)n >= out_len) ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
+
+static bool fs_text_index_load(const char *path, uint32_t size, int64_t mtime, fs_text_index_t *out)
+{
+    char sidecar[FS_TEXT_MAX_PATH + 8];
+    if (fs_text_index_sidecar(path, sidecar, sizeof(sidecar)) != ESP_OK) {
+        return false;
+    }
+    FILE *f = fopen(sidecar, "rb");
+    if (!f) {
+        return false;
+    }
+
+    fs_text_index_hdr_t hdr;
+    bool ok = fread(&hdr, 1, sizeof(hdr), f) == sizeof(hdr) &&
+              hdr.magic == FS_TEXT_INDEX_MAGIC &&
+              hdr.crc == esp_rom_crc32_le(0, (const uint8_t *)&hdr, offsetof(fs_text_index_hdr_t, crc)) &&
+              hdr.stride >= FS_TEXT_INDEX_STRIDE && hdr.stride % FS_TEXT_INDEX_STRIDE == 0 &&
+              hdr.size == size && hdr.mtime == mtime &&
+              hdr.count > 0 && hdr.count <= FS_TEXT_INDEX_MAX_POINTS && hdr.count <= size / hdr.stride + 1;
+    if (ok) {
+        uint32_t cap = hdr.count;
+        out->offsets = heap_caps_malloc(cap * sizeof(uint32_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!out->offsets) {
+            out->offsets = malloc(cap * sizeof(uint32_t));
+        }
+        ok = out->offsets &&
+             fread(out->offsets, sizeof(uint32_t), hdr.count, f) == hdr.count &&
+             esp_rom_crc32_le(0, (const uint8_t *)out->offsets, hdr.count * sizeof(uint32_t)) == hdr.offsets_crc;
+    }
+    fclose(f);
+
+    if (!ok) {
+        fs_text_index_free(out);
+        return false;
+    }
+    out->lines = hdr.lines;
+    out->count = hdr.count;
+    out->stride = hdr.stride;
+    out->size = hdr.size;
+    out->mtime = hdr.mtime;
+    return true;
+}
+
+static void fs_text_index_save(const char *path, const fs_text_index_t *index)
+{
+    char sidecar[FS_TEXT_MAX_PATH + 8];
+    if (fs_text_index_sidecar(path, sidecar, sizeof(sidecar)) != ESP_OK) {
+        return;
+    }
+
+    fs_text_index_hdr_t hdr = {
+        .magic = FS_TEXT_INDEX_MAGIC,
+        .stride = index->stride,
+        .lines = index->lines,
+        .count = index->count,
+        .size = index->size,
+        .mtime = index->mtime,
+        .offsets_crc = esp_rom_crc32_le(0, (const uint8_t *)index->offsets, index->count * sizeof(uint32_t)),
+    };
+    hdr.crc = esp_rom_crc32_le(0, (const uint8_t *)&hdr, offsetof(fs_text_index_hdr_t, crc));
+
+    FILE *f = fopen(sidecar, "wb");
+    if (!f) {
+        ESP_LOGW(TAG, "Cannot write %s (errno=%d)", sidecar, errno);
+        return;
+    }
+    bool ok = fwrite(&hdr, 1, sizeof(hdr), f) == sizeof(hdr) &&
+              fwrite(index->offsets, sizeof(uint32_t), index->count, f) == index->count;
+    if (fclose(f) != 0 || !ok) {
+        ESP_LOGW(TAG, "Writing %s failed, dropping it", sidecar);
+        remove(sidecar);
+    }
+}
+
+static bool fs_text_index_push(fs_text_index_t *index, uint32_t *cap, uint32_t offset)
+{
+    if (index->count == FS_TEXT_INDEX_MAX_POINTS) {
+        /* Keep lines 0, 2s, 4s...: the pending checkpoint then lands on the doubled stride */
+        for (uint32_t k = 1; k < index->count / 2; k++) {
+            index->offsets[k] = index->offsets[2 * k];
+        }
+        index->count /= 2;
+        index->stride *= 2;
+    }
+    if (index->count == *cap) {
+        uint32_t new_cap = *cap ? *cap * 2 : FS_TEXT_INDEX_MIN_CAP;
+        uint32_t *grown = heap_caps_realloc(index->offsets, new_cap * sizeof(uint32_t),
+                                            MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!grown) {
+            grown = heap_caps_realloc(index->offsets, new_cap * sizeof(uint32_t), MALLOC_CAP_8BIT);
+        }
+        if (!grown) {
+            return false;
+        }
+        index->offsets = grown;
+        *cap = new_cap;
+    }
+    index->offsets[index->count++] = offset;
+    return true;
+}
+
+static esp_err_t fs_text_index_skip_lines(FILE *f, uint32_t offset, uint32_t newlines, size_t *out_offset)
+{
+    if (fseek(f, (long)offset, SEEK_SET) != 0) {
+        return ESP_FAIL;
+    }
+    char *buf = malloc(FS_TEXT_INDEX_BLOCK);
+    if (!buf) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t pos = offset;
+    esp_err_t err = ESP_OK;
+    while (newlines > 0) {
+        size_t got = fread(buf, 1, FS_TEXT_INDEX_BLOCK, f);
+        if (got == 0) {
+            err = ferror(f) ? ESP_FAIL : ESP_OK;
+            break;
+        }
+        size_t i = 0;
+        while (i < got && newlines > 0) {
+            const char *nl = memchr(buf + i, '\n', got - i);
+            if (!nl) {
+                i = got;
+                break;
+            }
+            i = (size_t)(nl - buf) + 1;
+            newlines--;
+        }
+        pos += i;
+    }
+    free(buf);
+
+    *out_offset = pos;
+    return err;
+}
+
+static void fs_text_index_task(void *arg)
+{
+    fs_text_index_job_t *job = (fs_text_index_job_t *)arg;
+
+    job->err = fs_text_index_build(job->path, &job->index, &job->cancel);
+    job->done = true;
+
+    xSemaphoreGive(job->exited);
+    vTaskDelete(NULL);
+}
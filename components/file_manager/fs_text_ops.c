@@ -1,16 +1,58 @@
 #include "fs_text_ops.h"
 
 #include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include "esp_log.h"
+#include "esp_rom_crc.h"
 
 static const char *TAG = "fs_text";
 
+#define FS_TEXT_JOURNAL_NAME    "patchjnl.tmp"
+#define FS_TEXT_JOURNAL_MAGIC   0x4C4E4A50u     /* "PJNL" */
+#define FS_TEXT_SHIFT_BLOCK     (8 * 1024)      /* Tail bytes moved (and journaled) per step */
+
+/*
+ * Patch journal layout: header, target file name, replacement data, then two
+ * step slots (record + block) used alternately, so a torn slot write never
+ * destroys the last completed step.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t name_len;          /* Bytes of the target name following the header */
+    uint32_t offset;            /* First replaced byte */
+    uint32_t old_len;           /* Bytes replaced */
+    uint32_t new_len;           /* Bytes of replacement data following the name */
+    uint32_t old_size;          /* File size before the patch */
+    uint32_t data_crc;          /* CRC32 of the name and the replacement data */
+    uint32_t crc;               /* CRC32 of the fields above */
+} fs_text_journal_hdr_t;
+
+typedef struct {
+    uint32_t seq;               /* Step number; the valid slot with the highest one is the latest */
+    uint32_t src;               /* File offset the block was read from */
+    uint32_t len;               /* Block bytes following the record */
+    uint32_t crc;               /* CRC32 of the header CRC, the fields above and the block */
+} fs_text_journal_step_t;
+
+typedef struct {
+    FILE *file;                 /* Patched file, opened "r+b" */
+    FILE *jnl;                  /* Journal */
+    fs_text_journal_hdr_t hdr;
+    long slots;                 /* Journal offset of the first step slot */
+    const char *data;           /* Replacement data */
+    uint8_t *buf;               /* FS_TEXT_SHIFT_BLOCK bytes */
+    uint32_t seq;               /* Number of the next step */
+    uint32_t pos;               /* Edge of the part of the tail still to move */
+} fs_text_patch_run_t;
+
 /**
  * @brief Write data atomically by using a temporary file and rename().
  *
@@ -54,6 +96,90 @@ static esp_err_t fs_text_write_atomic(const char *path, const char *data, size_t
  */
 static bool fs_text_check_path(const char *path);
 
+/**
+ * @brief Read @p len bytes at @p offset straight from the file of @p reader.
+ *
+ * Seeks only when @p offset is not the current position.
+ *
+ * @param read Receives the number of bytes read (short at EOF).
+ * @retval ESP_OK On success.
+ * @retval ESP_FAIL If fseek or fread fail.
+ */
+static esp_err_t fs_text_reader_raw(fs_text_reader_t *reader, size_t offset, void *buf, size_t len, size_t *read);
+
+/**
+ * @brief Load the reader block with the bytes starting at @p offset.
+ */
+static esp_err_t fs_text_reader_load(fs_text_reader_t *reader, size_t offset);
+
+/**
+ * @brief Length to keep of a chunk that does not reach EOF.
+ *
+ * Cuts after the last newline if that keeps at least half of @p len, else
+ * before a trailing incomplete UTF-8 sequence.
+ */
+static size_t fs_text_chunk_cut(const char *buf, size_t len);
+
+/**
+ * @brief Copy the directory part of @p path ("/" for root entries, "." if none) into @p dir.
+ *
+ * @retval ESP_OK               On success.
+ * @retval ESP_ERR_INVALID_SIZE Directory does not fit @p dir_len.
+ */
+static esp_err_t fs_text_dir_of(const char *path, char *dir, size_t dir_len);
+
+/**
+ * @brief Build the path of the patch journal that belongs to the directory of @p path.
+ */
+static esp_err_t fs_text_journal_path(const char *path, char *out, size_t out_len);
+
+/**
+ * @brief Flush stdio buffers and fsync() @p f to the card.
+ */
+static bool fs_text_sync(FILE *f);
+
+/**
+ * @brief Read/write exactly @p len bytes at @p offset.
+ */
+static bool fs_text_pread(FILE *f, long offset, void *buf, size_t len);
+static bool fs_text_pwrite(FILE *f, long offset, const void *buf, size_t len);
+
+/**
+ * @brief CRC32 of a step record and its block, chained to the journal header.
+ */
+static uint32_t fs_text_step_crc(const fs_text_journal_hdr_t *hdr, const fs_text_journal_step_t *step, const uint8_t *block);
+
+/**
+ * @brief Move one tail block by the patch length difference.
+ *
+ * With @p journal the block is read from the file and committed to the next
+ * step slot before the file is written; without it @c run->buf already holds
+ * the block (replay of the last journaled step).
+ *
+ * @param run     Patch state; @c seq and @c pos advance on success.
+ * @param src     File offset of the block before the move.
+ * @param len     Block length (at most FS_TEXT_SHIFT_BLOCK).
+ * @param journal Journal the block first.
+ * @return true on success.
+ */
+static bool fs_text_patch_move(fs_text_patch_run_t *run, uint32_t src, uint32_t len, bool journal);
+
+/**
+ * @brief Move the rest of the tail, write the replacement data and fix the file size.
+ *
+ * Idempotent from any committed step, which is what makes recovery a replay.
+ */
+static esp_err_t fs_text_patch_run(fs_text_patch_run_t *run);
+
+/**
+ * @brief Complete (or discard a torn) journal found in the directory of @p path.
+ *
+ * @param path    Any path inside the directory.
+ * @param expect  Optional header of a patch about to be applied.
+ * @param matched Set if the replayed journal was that same patch (may be NULL).
+ */
+static esp_err_t fs_text_journal_replay(const char *path, const fs_text_journal_hdr_t *expect, bool *matched);
+
 bool fs_text_is_txt(const char *name)
 {
     if (!name) {
@@ -83,78 +209,226 @@ esp_err_t fs_text_create(const char *path)
     return ESP_OK;
 }
 
-esp_err_t fs_text_read_range(const char *path, size_t offset_kb, char **out_buf, size_t *out_len)
+esp_err_t fs_text_reader_open(fs_text_reader_t *reader, const char *path)
+{
+    if (!reader || !fs_text_check_path(path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return fs_text_reader_open_binary(reader, path);
+}
+
+esp_err_t fs_text_reader_open_binary(fs_text_reader_t *reader, const char *path)
 {
-    if (!out_buf || !fs_text_check_path(path)) {
+    if (!reader || !path) {
         return ESP_ERR_INVALID_ARG;
     }
+    size_t len = strnlen(path, FS_TEXT_MAX_PATH + 1);
+    if (len == 0 || len >= FS_TEXT_MAX_PATH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(reader, 0, sizeof(*reader));
+    reader->block_offset = SIZE_MAX;
 
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
     struct stat st = {0};
-    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
-        ESP_LOGE(TAG, "stat(%s) failed (errno=%d)", path, errno);
+    if (fstat(fileno(f), &st) != 0 || !S_ISREG(st.st_mode)) {
+        ESP_LOGE(TAG, "fstat(%s) failed (errno=%d)", path, errno);
+        fclose(f);
         return ESP_FAIL;
     }
+    /* The reader keeps its own block: a stdio buffer would only add a copy */
+    setvbuf(f, NULL, _IONBF, 0);
+
+    reader->file = f;
+    reader->size = (size_t)st.st_size;
+    reader->mtime = (int64_t)st.st_mtime;
+    return ESP_OK;
+}
 
-    if (offset_kb > SIZE_MAX / 1024) {
-        return ESP_ERR_INVALID_ARG; 
+void fs_text_reader_close(fs_text_reader_t *reader)
+{
+    if (!reader) {
+        return;
+    }
+    if (reader->file) {
+        fclose(reader->file);
     }
-    size_t offset_bytes = offset_kb * 1024u;
+    memset(reader, 0, sizeof(*reader));
+    reader->block_offset = SIZE_MAX;
+}
 
-    size_t file_size = (size_t)st.st_size;
-    size_t file_size_kb = file_size / 1024;
-    if (offset_bytes >= file_size) {
-        offset_bytes = file_size_kb * 1024;
+esp_err_t fs_text_reader_pread(fs_text_reader_t *reader, size_t offset, void *buf, size_t len, size_t *out_read)
+{
+    if (!reader || !reader->file || (!buf && len > 0) || !out_read) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_read = 0;
+    if (offset >= reader->size || len == 0) {
+        return ESP_OK;
+    }
+    if (len > reader->size - offset) {
+        len = reader->size - offset;
     }
 
-    size_t max_available = file_size - offset_bytes;
-    size_t to_read = READ_CHUNK_SIZE_B;
-    if (to_read > max_available) {
-        to_read = max_available; 
+    if (len >= FS_TEXT_READER_BLOCK) {
+        return fs_text_reader_raw(reader, offset, buf, len, out_read);
+    }
+    if (reader->block_offset == SIZE_MAX || offset < reader->block_offset ||
+        offset + len > reader->block_offset + reader->block_len) {
+        esp_err_t err = fs_text_reader_load(reader, offset);
+        if (err != ESP_OK) {
+            return err;
+        }
     }
 
-#ifdef FS_TEXT_MAX_BYTES
-    if (to_read > FS_TEXT_MAX_BYTES) {
-        ESP_LOGE(TAG, "Requested range too large (%zu bytes)", to_read);
-        return ESP_ERR_INVALID_SIZE;
+    size_t avail = reader->block_offset + reader->block_len - offset;
+    size_t n = (len < avail) ? len : avail;
+    memcpy(buf, reader->block + (offset - reader->block_offset), n);
+    *out_read = n;
+    return ESP_OK;
+}
+
+esp_err_t fs_text_reader_chunk(fs_text_reader_t *reader, size_t offset, char *buf, size_t *out_len)
+{
+    if (!reader || !reader->file || !buf || !out_len) {
+        return ESP_ERR_INVALID_ARG;
     }
-#endif
 
-    FILE *f = fopen(path, "rb");
-    if (!f) {
-        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", path, errno);
+    if (offset > reader->size) {
+        offset = reader->size;
+    }
+    size_t to_read = reader->size - offset;
+    if (to_read > READ_CHUNK_SIZE_B) {
+        to_read = READ_CHUNK_SIZE_B;
+    }
+
+    size_t read = 0;
+    if (to_read > 0 && fs_text_reader_pread(reader, offset, buf, to_read, &read) != ESP_OK) {
         return ESP_FAIL;
     }
+    if (offset + read < reader->size) {
+        read = fs_text_chunk_cut(buf, read);
+    }
+    buf[read] = '\0';
+    *out_len = read;
+    return ESP_OK;
+}
 
-    if (fseek(f, (long)offset_bytes, SEEK_SET) != 0) {
-        ESP_LOGE(TAG, "fseek(%s, %zu) failed (errno=%d)", path, offset_bytes, errno);
-        fclose(f);
+esp_err_t fs_text_reader_chunk_align(fs_text_reader_t *reader, size_t offset, size_t *out_offset)
+{
+    if (!reader || !reader->file || !out_offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset == 0) {
+        *out_offset = 0;
+        return ESP_OK;
+    }
+
+    /* Include the byte before @p offset so a line starting right there is kept */
+    char buf[READ_CHUNK_SIZE_B / 2 + 1];
+    size_t read = 0;
+    if (fs_text_reader_pread(reader, offset - 1, buf, sizeof(buf), &read) != ESP_OK) {
         return ESP_FAIL;
     }
+    if (read <= 1) {
+        *out_offset = offset - 1 + read; // At or past EOF
+        return ESP_OK;
+    }
+
+    const char *nl = memchr(buf, '\n', read);
+    size_t skip = 1;
+    if (nl) {
+        skip = (size_t)(nl - buf) + 1;
+    } else {
+        while (skip < read && ((unsigned char)buf[skip] & 0xC0) == 0x80) {
+            skip++; // Continuation byte
+        }
+    }
+    *out_offset = offset - 1 + skip;
+    return ESP_OK;
+}
+
+esp_err_t fs_text_reader_chunk_before(fs_text_reader_t *reader, size_t end, size_t *out_offset)
+{
+    if (!reader || !reader->file || !out_offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (end <= READ_CHUNK_SIZE_B) {
+        *out_offset = 0;
+        return ESP_OK;
+    }
+    /* The boundary found lies within the first half, so the chunk keeps at least half its size */
+    return fs_text_reader_chunk_align(reader, end - READ_CHUNK_SIZE_B, out_offset);
+}
+
+esp_err_t fs_text_read_chunk(const char *path, size_t offset, char **out_buf, size_t *out_len)
+{
+    if (!out_buf) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-    char *buf = (char *)malloc(to_read + 1);
+    fs_text_reader_t reader;
+    esp_err_t err = fs_text_reader_open(&reader, path);
+    if (err != ESP_OK) {
+        return err;
+    }
+    char *buf = (char *)malloc(READ_CHUNK_SIZE_B + 1);
     if (!buf) {
-        fclose(f);
+        fs_text_reader_close(&reader);
         return ESP_ERR_NO_MEM;
     }
 
-    size_t read = fread(buf, 1, to_read, f);
-    if (read == 0 && ferror(f)) {
-        ESP_LOGE(TAG, "fread(%s) failed (errno=%d)", path, errno);
+    size_t len = 0;
+    err = fs_text_reader_chunk(&reader, offset, buf, &len);
+    fs_text_reader_close(&reader);
+    if (err != ESP_OK) {
         free(buf);
-        fclose(f);
-        return ESP_FAIL;
+        return err;
     }
-    buf[read] = '\0';
 
-    fclose(f);
     *out_buf = buf;
     if (out_len) {
-        *out_len = read;
+        *out_len = len;
     }
-
     return ESP_OK;
 }
 
+esp_err_t fs_text_chunk_align(const char *path, size_t offset, size_t *out_offset)
+{
+    if (!out_offset || !fs_text_check_path(path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset == 0) {
+        *out_offset = 0;
+        return ESP_OK;
+    }
+
+    fs_text_reader_t reader;
+    esp_err_t err = fs_text_reader_open(&reader, path);
+    if (err == ESP_OK) {
+        err = fs_text_reader_chunk_align(&reader, offset, out_offset);
+        fs_text_reader_close(&reader);
+    }
+    return err;
+}
+
+esp_err_t fs_text_chunk_before(const char *path, size_t end, size_t *out_offset)
+{
+    if (!out_offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (end <= READ_CHUNK_SIZE_B) {
+        *out_offset = 0;
+        return fs_text_check_path(path) ? ESP_OK : ESP_ERR_INVALID_ARG;
+    }
+    /* The boundary found lies within the first half, so the chunk keeps at least half its size */
+    return fs_text_chunk_align(path, end - READ_CHUNK_SIZE_B, out_offset);
+}
+
 esp_err_t fs_text_write(const char *path, const char *data, size_t len)
 {
     if (!fs_text_check_path(path) || (!data && len > 0)) {
@@ -166,6 +440,120 @@ esp_err_t fs_text_write(const char *path, const char *data, size_t len)
     return fs_text_write_atomic(path, data, len);
 }
 
+esp_err_t fs_text_patch(const char *path, size_t offset, size_t old_len, const char *data, size_t new_len)
+{
+    if (!fs_text_check_path(path) || (!data && new_len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset > UINT32_MAX || old_len > UINT32_MAX - offset || new_len > UINT32_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const char *name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    fs_text_patch_run_t run = {
+        .hdr = {
+            .magic = FS_TEXT_JOURNAL_MAGIC,
+            .name_len = (uint32_t)strlen(name),
+            .offset = (uint32_t)offset,
+            .old_len = (uint32_t)old_len,
+            .new_len = (uint32_t)new_len,
+        },
+        .data = data,
+        .seq = 1,
+    };
+    run.hdr.data_crc = esp_rom_crc32_le(0, (const uint8_t *)name, run.hdr.name_len);
+    run.hdr.data_crc = esp_rom_crc32_le(run.hdr.data_crc, (const uint8_t *)data, (uint32_t)new_len);
+
+    /* A failed earlier attempt of this very patch may be left in the journal: finish it, don't apply twice */
+    bool matched = false;
+    esp_err_t err = fs_text_journal_replay(path, &run.hdr, &matched);
+    if (err != ESP_OK || matched) {
+        return err;
+    }
+
+    struct stat st = {0};
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ESP_LOGE(TAG, "stat(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    size_t old_size = (size_t)st.st_size;
+    if (offset > old_size || old_len > old_size - offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((uint64_t)old_size - old_len + new_len > UINT32_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (old_len == 0 && new_len == 0) {
+        return ESP_OK;
+    }
+    run.hdr.old_size = (uint32_t)old_size;
+    run.hdr.crc = esp_rom_crc32_le(0, (const uint8_t *)&run.hdr, offsetof(fs_text_journal_hdr_t, crc));
+    run.slots = (long)(sizeof(run.hdr) + run.hdr.name_len + new_len);
+    run.pos = (new_len > old_len) ? run.hdr.old_size : run.hdr.offset + run.hdr.old_len;
+
+    char jnl_path[FS_TEXT_MAX_PATH];
+    err = fs_text_journal_path(path, jnl_path, sizeof(jnl_path));
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (new_len != old_len && offset + old_len < old_size) {
+        run.buf = malloc(FS_TEXT_SHIFT_BLOCK);
+        if (!run.buf) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    /* Nothing touches the file until the replacement data is on the card */
+    run.jnl = fopen(jnl_path, "w+b");
+    if (!run.jnl) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", jnl_path, errno);
+        free(run.buf);
+        return ESP_FAIL;
+    }
+    if (fwrite(&run.hdr, 1, sizeof(run.hdr), run.jnl) != sizeof(run.hdr) ||
+        fwrite(name, 1, run.hdr.name_len, run.jnl) != run.hdr.name_len ||
+        (new_len > 0 && fwrite(data, 1, new_len, run.jnl) != new_len) ||
+        !fs_text_sync(run.jnl)) {
+        ESP_LOGE(TAG, "journal write(%s) failed (errno=%d)", jnl_path, errno);
+        err = ESP_FAIL;
+        goto discard;
+    }
+
+    run.file = fopen(path, "r+b");
+    if (!run.file) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", path, errno);
+        err = ESP_FAIL;
+        goto discard;
+    }
+
+    err = fs_text_patch_run(&run);
+    fclose(run.file);
+    fclose(run.jnl);
+    free(run.buf);
+    if (err != ESP_OK) {
+        /* Keep the journal: fs_text_recover() finishes the patch once the card is back */
+        ESP_LOGE(TAG, "patch(%s) interrupted, journal kept", path);
+        return err;
+    }
+    remove(jnl_path);
+    return ESP_OK;
+
+discard:
+    fclose(run.jnl);
+    remove(jnl_path);
+    free(run.buf);
+    return err;
+}
+
+esp_err_t fs_text_recover(const char *path)
+{
+    if (!path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return fs_text_journal_replay(path, NULL, NULL);
+}
+
 esp_err_t fs_text_append(const char *path, const char *data, size_t len)
 {
     if (!fs_text_check_path(path) || !data) {
@@ -208,20 +596,9 @@ esp_err_t fs_text_delete(const char *path)
 static esp_err_t fs_text_write_atomic(const char *path, const char *data, size_t len)
 {
     char dir[FS_TEXT_MAX_PATH];
-    const char *slash = strrchr(path, '/');
-    if (slash) {
-        size_t dir_len = (size_t)(slash - path);
-        if (dir_len == 0) {
-            dir[0] = '/';
-            dir[1] = '\0';
-        } else if (dir_len < sizeof(dir)) {
-            memcpy(dir, path, dir_len);
-            dir[dir_len] = '\0';
-        } else {
-            return ESP_ERR_INVALID_SIZE;
-        }
-    } else {
-        strlcpy(dir, ".", sizeof(dir));
+    esp_err_t err = fs_text_dir_of(path, dir, sizeof(dir));
+    if (err != ESP_OK) {
+        return err;
     }
 
     char tmp_path[FS_TEXT_MAX_PATH];
@@ -267,4 +644,287 @@ static bool fs_text_check_path(const char *path)
     }
     size_t len = strnlen(path, FS_TEXT_MAX_PATH + 1);
     return len > 0 && len < FS_TEXT_MAX_PATH;
-}
\ No newline at end of file
+}
+
+static esp_err_t fs_text_dir_of(const char *path, char *dir, size_t dir_len)
+{
+    const char *slash = strrchr(path, '/');
+    if (!slash) {
+        strlcpy(dir, ".", dir_len);
+        return ESP_OK;
+    }
+
+    size_t len = (size_t)(slash - path);
+    if (len == 0) {
+        strlcpy(dir, "/", dir_len);
+    } else if (len < dir_len) {
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+    } else {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t fs_text_journal_path(const char *path, char *out, size_t out_len)
+{
+    char dir[FS_TEXT_MAX_PATH];
+    esp_err_t err = fs_text_dir_of(path, dir, sizeof(dir));
+    if (err != ESP_OK) {
+        return err;
+    }
+    int needed = snprintf(out, out_len, "%s/" FS_TEXT_JOURNAL_NAME, dir);
+    if (needed < 0 || needed >= (int)out_len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+static bool fs_text_sync(FILE *f)
+{
+    return fflush(f) == 0 && fsync(fileno(f)) == 0;
+}
+
+static bool fs_text_pread(FILE *f, long offset, void *buf, size_t len)
+{
+    return fseek(f, offset, SEEK_SET) == 0 && fread(buf, 1, len, f) == len;
+}
+
+static bool fs_text_pwrite(FILE *f, long offset, const void *buf, size_t len)
+{
+    return fseek(f, offset, SEEK_SET) == 0 && fwrite(buf, 1, len, f) == len;
+}
+
+static uint32_t fs_text_step_crc(const fs_text_journal_hdr_t *hdr, const fs_text_journal_step_t *step, const uint8_t *block)
+{
+    uint32_t crc = esp_rom_crc32_le(hdr->crc, (const uint8_t *)step, offsetof(fs_text_journal_step_t, crc));
+    return esp_rom_crc32_le(crc, block, step->len);
+}
+
+static bool fs_text_patch_move(fs_text_patch_run_t *run, uint32_t src, uint32_t len, bool journal)
+{
+    int64_t delta = (int64_t)run->hdr.new_len - (int64_t)run->hdr.old_len;
+
+    if (journal) {
+        if (!fs_text_pread(run->file, (long)src, run->buf, len)) {
+            return false;
+        }
+        fs_text_journal_step_t step = {
+            .seq = run->seq,
+            .src = src,
+            .len = len,
+        };
+        step.crc = fs_text_step_crc(&run->hdr, &step, run->buf);
+        long slot = run->slots + (long)(run->seq & 1u) * (long)(sizeof(step) + FS_TEXT_SHIFT_BLOCK);
+        if (!fs_text_pwrite(run->jnl, slot, &step, sizeof(step)) ||
+            fwrite(run->buf, 1, len, run->jnl) != len || !fs_text_sync(run->jnl)) {
+            return false;
+        }
+    }
+
+    if (!fs_text_pwrite(run->file, (long)((int64_t)src + delta), run->buf, len) || !fs_text_sync(run->file)) {
+        return false;
+    }
+    run->seq++;
+    run->pos = (delta > 0) ? src : src + len;
+    return true;
+}
+
+static esp_err_t fs_text_patch_run(fs_text_patch_run_t *run)
+{
+    const fs_text_journal_hdr_t *hdr = &run->hdr;
+    uint32_t tail = hdr->offset + hdr->old_len;
+    uint32_t new_size = hdr->old_size - hdr->old_len + hdr->new_len;
+
+    if (hdr->new_len > hdr->old_len) {
+        /* Growing: move from the end so no block lands on bytes still to be read */
+        while (run->pos > tail) {
+            uint32_t len = (run->pos - tail > FS_TEXT_SHIFT_BLOCK) ? FS_TEXT_SHIFT_BLOCK : run->pos - tail;
+            if (!fs_text_patch_move(run, run->pos - len, len, true)) {
+                ESP_LOGE(TAG, "tail shift at %u failed (errno=%d)", (unsigned)(run->pos - len), errno);
+                return ESP_FAIL;
+            }
+        }
+    } else if (hdr->new_len < hdr->old_len) {
+        while (run->pos < hdr->old_size) {
+            uint32_t len = (hdr->old_size - run->pos > FS_TEXT_SHIFT_BLOCK) ? FS_TEXT_SHIFT_BLOCK : hdr->old_size - run->pos;
+            if (!fs_text_patch_move(run, run->pos, len, true)) {
+                ESP_LOGE(TAG, "tail shift at %u failed (errno=%d)", (unsigned)run->pos, errno);
+                return ESP_FAIL;
+            }
+        }
+    }
+
+    if (hdr->new_len > 0 && !fs_text_pwrite(run->file, (long)hdr->offset, run->data, hdr->new_len)) {
+        ESP_LOGE(TAG, "patch write at %u failed (errno=%d)", (unsigned)hdr->offset, errno);
+        return ESP_FAIL;
+    }
+    if (new_size < hdr->old_size && (fflush(run->file) != 0 || ftruncate(fileno(run->file), (off_t)new_size) != 0)) {
+        ESP_LOGE(TAG, "truncate to %u failed (errno=%d)", (unsigned)new_size, errno);
+        return ESP_FAIL;
+    }
+    if (!fs_text_sync(run->file)) {
+        ESP_LOGE(TAG, "fsync failed (errno=%d)", errno);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t fs_text_journal_replay(const char *path, const fs_text_journal_hdr_t *expect, bool *matched)
+{
+    if (matched) {
+        *matched = false;
+    }
+
+    char jnl_path[FS_TEXT_MAX_PATH];
+    esp_err_t err = fs_text_journal_path(path, jnl_path, sizeof(jnl_path));
+    if (err != ESP_OK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    fs_text_patch_run_t run = {
+        .jnl = fopen(jnl_path, "r+b"),
+    };
+    if (!run.jnl) {
+        return ESP_OK; // Nothing pending
+    }
+
+    /* A torn header or data means the patched file was never written: drop the journal */
+    fs_text_journal_hdr_t *hdr = &run.hdr;
+    char *blob = NULL;
+    if (fread(hdr, 1, sizeof(*hdr), run.jnl) != sizeof(*hdr) || hdr->magic != FS_TEXT_JOURNAL_MAGIC ||
+        hdr->crc != esp_rom_crc32_le(0, (const uint8_t *)hdr, offsetof(fs_text_journal_hdr_t, crc)) ||
+        hdr->name_len == 0 || hdr->name_len >= FS_TEXT_MAX_PATH) {
+        goto discard;
+    }
+    blob = malloc(hdr->name_len + hdr->new_len + 1);
+    run.buf = malloc(FS_TEXT_SHIFT_BLOCK);
+    if (!blob || !run.buf) {
+        err = ESP_ERR_NO_MEM;
+        goto keep;
+    }
+    if (fread(blob, 1, hdr->name_len + hdr->new_len, run.jnl) != hdr->name_len + hdr->new_len ||
+        esp_rom_crc32_le(0, (const uint8_t *)blob, hdr->name_len + hdr->new_len) != hdr->data_crc) {
+        goto discard;
+    }
+    run.data = blob + hdr->name_len;
+    run.slots = (long)(sizeof(*hdr) + hdr->name_len + hdr->new_len);
+
+    char dir[FS_TEXT_MAX_PATH];
+    char target[FS_TEXT_MAX_PATH];
+    fs_text_dir_of(path, dir, sizeof(dir));
+    int needed = snprintf(target, sizeof(target), "%s/%.*s", dir, (int)hdr->name_len, blob);
+    if (needed < 0 || needed >= (int)sizeof(target)) {
+        goto discard;
+    }
+    run.file = fopen(target, "r+b");
+    if (!run.file) {
+        if (errno == ENOENT) {
+            goto discard; // Patched file deleted since
+        }
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", target, errno);
+        err = ESP_FAIL;
+        goto keep;
+    }
+
+    /* Replay the latest committed step, then carry on from there */
+    fs_text_journal_step_t best = {0};
+    for (uint32_t slot = 0; slot < 2; slot++) {
+        fs_text_journal_step_t step;
+        long at = run.slots + (long)slot * (long)(sizeof(step) + FS_TEXT_SHIFT_BLOCK);
+        if (fs_text_pread(run.jnl, at, &step, sizeof(step)) && step.len > 0 && step.len <= FS_TEXT_SHIFT_BLOCK &&
+            step.seq > best.seq && fread(run.buf, 1, step.len, run.jnl) == step.len &&
+            fs_text_step_crc(hdr, &step, run.buf) == step.crc) {
+            best = step;
+        }
+    }
+    ESP_LOGW(TAG, "Completing interrupted patch of %s", target);
+    run.seq = 1;
+    run.pos = (hdr->new_len > hdr->old_len) ? hdr->old_size : hdr->offset + hdr->old_len;
+    if (best.seq > 0) {
+        long at = run.slots + (long)(best.seq & 1u) * (long)(sizeof(best) + FS_TEXT_SHIFT_BLOCK) + (long)sizeof(best);
+        run.seq = best.seq;
+        if (!fs_text_pread(run.jnl, at, run.buf, best.len) || !fs_text_patch_move(&run, best.src, best.len, false)) {
+            ESP_LOGE(TAG, "replay of step %u failed (errno=%d)", (unsigned)best.seq, errno);
+            err = ESP_FAIL;
+        }
+    }
+    if (err == ESP_OK) {
+        err = fs_text_patch_run(&run);
+    }
+    fclose(run.file);
+    if (err != ESP_OK) {
+        goto keep;
+    }
+    if (matched && expect && strcmp(target, path) == 0 && expect->offset == hdr->offset &&
+        expect->old_len == hdr->old_len && expect->new_len == hdr->new_len && expect->data_crc == hdr->data_crc) {
+        *matched = true;
+    }
+
+discard:
+    fclose(run.jnl);
+    remove(jnl_path);
+    free(blob);
+    free(run.buf);
+    return ESP_OK;
+
+keep:
+    fclose(run.jnl);
+    free(blob);
+    free(run.buf);
+    return err;
+}
+
+static esp_err_t fs_text_reader_raw(fs_text_reader_t *reader, size_t offset, void *buf, size_t len, size_t *read)
+{
+    if (reader->pos != offset) {
+        if (fseek(reader->file, (long)offset, SEEK_SET) != 0) {
+            ESP_LOGE(TAG, "fseek(%zu) failed (errno=%d)", offset, errno);
+            reader->pos = SIZE_MAX;
+            return ESP_FAIL;
+        }
+        reader->pos = offset;
+    }
+
+    *read = fread(buf, 1, len, reader->file);
+    if (*read < len && ferror(reader->file)) {
+        ESP_LOGE(TAG, "fread failed (errno=%d)", errno);
+        clearerr(reader->file);
+        reader->pos = SIZE_MAX;
+        return ESP_FAIL;
+    }
+    reader->pos += *read;
+    return ESP_OK;
+}
+
+static esp_err_t fs_text_reader_load(fs_text_reader_t *reader, size_t offset)
+{
+    size_t read = 0;
+    reader->block_offset = SIZE_MAX;
+    esp_err_t err = fs_text_reader_raw(reader, offset, reader->block, sizeof(reader->block), &read);
+    if (err != ESP_OK) {
+        return err;
+    }
+    reader->block_offset = offset;
+    reader->block_len = read;
+    return ESP_OK;
+}
+
+static size_t fs_text_chunk_cut(const char *buf, size_t len)
+{
+    for (size_t i = len; i > len / 2; i--) {
+        if (buf[i - 1] == '\n') {
+            return i;
+        }
+    }
+
+    /* Long line: drop a multi-byte sequence the chunk end would split */
+    for (size_t back = 1; back <= 4 && back <= len; back++) {
+        unsigned char c = (unsigned char)buf[len - back];
+        if ((c & 0xC0) == 0x80) {
+            continue; // Continuation byte
+        }
+        size_t need = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+        return (need > back && len > back) ? len - back : len;
+    }
+    return len;
+}
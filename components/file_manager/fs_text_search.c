@@ -0,0 +1,577 @@
+#include "fs_text_search.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "fs_text_search";
+
+#define FS_TEXT_SEARCH_TASK_STACK   (4 * 1024)
+#define FS_TEXT_SEARCH_TASK_PRIO    (1)             /* Below the LVGL task: the UI stays responsive while scanning */
+
+typedef struct {
+    const unsigned char *pattern;
+    size_t len;
+    uint8_t skip[256];          /* Horspool shift for the byte under the pattern's last position */
+} fs_text_search_matcher_t;
+
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t exited;   /* Given by the worker right before it deletes itself */
+    char path[FS_TEXT_MAX_PATH];
+    char pattern[FS_TEXT_SEARCH_MAX_PATTERN + 1];
+    size_t pattern_len;         /* Bytes of @c pattern (a byte pattern may hold zeros) */
+    bool binary;                /* Any file, not just .txt (byte searches) */
+    char replacement[FS_TEXT_SEARCH_MAX_PATTERN + 1];
+    bool replace;               /* Replace-all job instead of a search */
+    size_t from;
+    bool forward;
+    volatile size_t total;      /* Bytes the job reads, set once the file is open */
+    volatile size_t scanned;    /* Bytes read so far */
+    volatile size_t count;      /* Replacements made so far */
+    size_t offset;              /* Search result, valid if err == ESP_OK */
+    esp_err_t err;
+    volatile bool done;
+    volatile bool cancel;       /* Polled by the scan */
+} fs_text_search_job_t;
+
+static fs_text_search_job_t s_job;
+
+/**
+ * @brief Fill the Horspool shift table for @p pattern.
+ */
+static void fs_text_search_prepare(fs_text_search_matcher_t *m, const char *pattern, size_t len);
+
+/**
+ * @brief Find the first (or last) match of @p m in @p buf.
+ *
+ * @return Index of the match, SIZE_MAX if there is none.
+ */
+static size_t fs_text_search_scan(const fs_text_search_matcher_t *m, const unsigned char *buf, size_t len, bool first);
+
+/**
+ * @brief Scan [@p start, @p limit) front to back, carrying the last pattern length - 1 bytes across blocks.
+ */
+static esp_err_t fs_text_search_forward(fs_text_reader_t *reader, const fs_text_search_matcher_t *m,
+                                        unsigned char *buf, size_t start, size_t limit, size_t *out_offset,
+                                        const volatile bool *cancel, volatile size_t *scanned);
+
+/**
+ * @brief Scan [@p start, @p limit) back to front; consecutive blocks overlap by pattern length - 1 bytes.
+ */
+static esp_err_t fs_text_search_backward(fs_text_reader_t *reader, const fs_text_search_matcher_t *m,
+                                         unsigned char *buf, size_t start, size_t limit, size_t *out_offset,
+                                         const volatile bool *cancel, volatile size_t *scanned);
+
+/**
+ * @brief Allocate the block buffer (FS_TEXT_SEARCH_BLOCK + FS_TEXT_SEARCH_MAX_PATTERN bytes).
+ *
+ * DMA-capable memory lets FatFs hand whole sectors to the SD driver without a bounce copy.
+ */
+static unsigned char *fs_text_search_alloc(void);
+
+/**
+ * @brief Build "<dir>/.<name>.rpl", the replace-all copy of @p path.
+ *
+ * @retval ESP_OK               On success.
+ * @retval ESP_ERR_INVALID_SIZE The path does not fit @p out_len.
+ */
+static esp_err_t fs_text_replace_temp(const char *path, char *out, size_t out_len);
+
+/**
+ * @brief Write @p len bytes of @p data to @p f (nothing for 0).
+ */
+static bool fs_text_replace_write(FILE *f, const void *data, size_t len);
+
+/**
+ * @brief Start the worker for the job already described in @c s_job.
+ */
+static esp_err_t fs_text_search_spawn(void);
+
+/**
+ * @brief Worker task: run the search or replace of @c s_job and exit.
+ *
+ * @param arg Unused.
+ */
+static void fs_text_search_task(void *arg);
+
+esp_err_t fs_text_search_find(fs_text_reader_t *reader, const char *pattern, size_t start, size_t end,
+                              bool forward, size_t *out_offset, const volatile bool *cancel,
+                              volatile size_t *scanned)
+{
+    if (!pattern) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return fs_text_search_find_bytes(reader, pattern, strlen(pattern), start, end, forward,
+                                     out_offset, cancel, scanned);
+}
+
+esp_err_t fs_text_search_find_bytes(fs_text_reader_t *reader, const void *pattern, size_t len, size_t start,
+                                    size_t end, bool forward, size_t *out_offset,
+                                    const volatile bool *cancel, volatile size_t *scanned)
+{
+    if (!reader || !reader->file || !pattern || !out_offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len == 0 || len > FS_TEXT_SEARCH_MAX_PATTERN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (end > reader->size) {
+        end = reader->size;
+    }
+    if (start >= end || reader->size - start < len) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    /* A match starting right before @p end needs up to len - 1 bytes past it */
+    size_t limit = (end > reader->size - (len - 1)) ? reader->size : end + len - 1;
+
+    unsigned char *buf = fs_text_search_alloc();
+    if (!buf) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    fs_text_search_matcher_t m;
+    fs_text_search_prepare(&m, pattern, len);
+    esp_err_t err = forward
+                    ? fs_text_search_forward(reader, &m, buf, start, limit, out_offset, cancel, scanned)
+                    : fs_text_search_backward(reader, &m, buf, start, limit, out_offset, cancel, scanned);
+    free(buf);
+    return err;
+}
+
+esp_err_t fs_text_search_start(const char *path, const char *pattern, size_t from, bool forward)
+{
+    if (!path || strlen(path) >= sizeof(s_job.path) || !pattern || pattern[0] == '\0' ||
+        strlen(pattern) >= sizeof(s_job.pattern)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    fs_text_search_stop();
+
+    fs_text_search_job_t *job = &s_job;
+    strlcpy(job->path, path, sizeof(job->path));
+    strlcpy(job->pattern, pattern, sizeof(job->pattern));
+    job->pattern_len = strlen(pattern);
+    job->from = from;
+    job->forward = forward;
+    return fs_text_search_spawn();
+}
+
+esp_err_t fs_text_search_start_bytes(const char *path, const void *pattern, size_t len, size_t from, bool forward)
+{
+    if (!path || strlen(path) >= sizeof(s_job.path) || !pattern || len == 0 ||
+        len > FS_TEXT_SEARCH_MAX_PATTERN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    fs_text_search_stop();
+
+    fs_text_search_job_t *job = &s_job;
+    strlcpy(job->path, path, sizeof(job->path));
+    memcpy(job->pattern, pattern, len);
+    job->pattern_len = len;
+    job->binary = true;
+    job->from = from;
+    job->forward = forward;
+    return fs_text_search_spawn();
+}
+
+esp_err_t fs_text_search_poll(size_t *out_offset, uint8_t *out_percent)
+{
+    fs_text_search_job_t *job = &s_job;
+    if (!out_offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!job->task || job->replace) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (out_percent) {
+        size_t total = job->total;
+        uint64_t percent = total ? (uint64_t)job->scanned * 100u / total : 0;
+        *out_percent = (uint8_t)(percent > 100 ? 100 : percent);
+    }
+    if (!job->done) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    xSemaphoreTake(job->exited, portMAX_DELAY);
+    esp_err_t err = job->err;
+    if (err == ESP_OK) {
+        *out_offset = job->offset;
+    }
+    vSemaphoreDelete(job->exited);
+    memset(job, 0, sizeof(*job));
+    return err;
+}
+
+esp_err_t fs_text_replace_all(const char *path, const char *pattern, const char *replacement,
+                              volatile size_t *out_count, const volatile bool *cancel,
+                              volatile size_t *scanned)
+{
+    if (!path || !pattern || !replacement || !out_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t len = strlen(pattern);
+    size_t rep_len = strlen(replacement);
+    if (len == 0 || len > FS_TEXT_SEARCH_MAX_PATTERN || rep_len > FS_TEXT_SEARCH_MAX_PATTERN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_count = 0;
+
+    char tmp_path[FS_TEXT_MAX_PATH + 8];
+    esp_err_t err = fs_text_replace_temp(path, tmp_path, sizeof(tmp_path));
+    if (err != ESP_OK) {
+        return err;
+    }
+    fs_text_reader_t reader;
+    err = fs_text_reader_open(&reader, path);
+    if (err != ESP_OK) {
+        return err;
+    }
+    unsigned char *buf = fs_text_search_alloc();
+    if (!buf) {
+        fs_text_reader_close(&reader);
+        return ESP_ERR_NO_MEM;
+    }
+    remove(tmp_path);
+    FILE *out = fopen(tmp_path, "wb");
+    if (!out) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", tmp_path, errno);
+        err = ESP_FAIL;
+        goto done;
+    }
+
+    fs_text_search_matcher_t m;
+    fs_text_search_prepare(&m, pattern, len);
+    size_t carry = 0;
+    size_t pos = 0;
+    for (;;) {
+        if (cancel && *cancel) {
+            err = ESP_ERR_INVALID_STATE;
+            goto done;
+        }
+        size_t got = 0;
+        err = fs_text_reader_pread(&reader, pos, buf + carry, FS_TEXT_SEARCH_BLOCK, &got);
+        if (err != ESP_OK) {
+            goto done;
+        }
+        pos += got;
+        if (scanned) {
+            *scanned += got;
+        }
+        size_t n = carry + got;
+        bool eof = (got == 0 || pos >= reader.size);
+
+        size_t i = 0;
+        for (;;) {
+            size_t hit = fs_text_search_scan(&m, buf + i, n - i, true);
+            if (hit == SIZE_MAX) {
+                break;
+            }
+            if (!fs_text_replace_write(out, buf + i, hit) ||
+                !fs_text_replace_write(out, replacement, rep_len)) {
+                err = ESP_FAIL;
+                goto done;
+            }
+            (*out_count)++;
+            i += hit + len;
+        }
+
+        /* An unmatched tail may still be the start of a match that ends in the next block */
+        size_t keep = eof ? 0 : ((n - i < len - 1) ? n - i : len - 1);
+        if (!fs_text_replace_write(out, buf + i, n - i - keep)) {
+            err = ESP_FAIL;
+            goto done;
+        }
+        memmove(buf, buf + n - keep, keep);
+        carry = keep;
+        if (eof) {
+            break;
+        }
+    }
+
+    if (fflush(out) != 0 || fsync(fileno(out)) != 0) {
+        ESP_LOGE(TAG, "fsync(%s) failed (errno=%d)", tmp_path, errno);
+        err = ESP_FAIL;
+    }
+
+done:
+    free(buf);
+    fs_text_reader_close(&reader);
+    if (out && fclose(out) != 0 && err == ESP_OK) {
+        err = ESP_FAIL;
+    }
+    if (err != ESP_OK || *out_count == 0) {
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+            ESP_LOGE(TAG, "Replacing in %s failed: %s", path, esp_err_to_name(err));
+        }
+        remove(tmp_path);
+        return err;
+    }
+
+    if (rename(tmp_path, path) != 0) {
+        if (errno == EEXIST && remove(path) == 0 && rename(tmp_path, path) == 0) {
+            return ESP_OK;
+        }
+        ESP_LOGE(TAG, "rename(%s -> %s) failed (errno=%d)", tmp_path, path, errno);
+        remove(tmp_path);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t fs_text_replace_start(const char *path, const char *pattern, const char *replacement)
+{
+    if (!path || strlen(path) >= sizeof(s_job.path) || !pattern || pattern[0] == '\0' ||
+        strlen(pattern) >= sizeof(s_job.pattern) || !replacement ||
+        strlen(replacement) >= sizeof(s_job.replacement)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    fs_text_search_stop();
+
+    fs_text_search_job_t *job = &s_job;
+    strlcpy(job->path, path, sizeof(job->path));
+    strlcpy(job->pattern, pattern, sizeof(job->pattern));
+    strlcpy(job->replacement, replacement, sizeof(job->replacement));
+    job->replace = true;
+    return fs_text_search_spawn();
+}
+
+esp_err_t fs_text_replace_poll(size_t *out_count, uint8_t *out_percent)
+{
+    fs_text_search_job_t *job = &s_job;
+    if (!out_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!job->task || !job->replace) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *out_count = job->count;
+    if (out_percent) {
+        size_t total = job->total;
+        uint64_t percent = total ? (uint64_t)job->scanned * 100u / total : 0;
+        *out_percent = (uint8_t)(percent > 100 ? 100 : percent);
+    }
+    if (!job->done) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    xSemaphoreTake(job->exited, portMAX_DELAY);
+    esp_err_t err = job->err;
+    *out_count = job->count;
+    vSemaphoreDelete(job->exited);
+    memset(job, 0, sizeof(*job));
+    return err;
+}
+
+void fs_text_search_stop(void)
+{
+    fs_text_search_job_t *job = &s_job;
+    if (!job->task) {
+        return;
+    }
+
+    job->cancel = true;
+    xSemaphoreTake(job->exited, portMAX_DELAY);
+    vSemaphoreDelete(job->exited);
+    memset(job, 0, sizeof(*job));
+}
+
+static unsigned char *fs_text_search_alloc(void)
+{
+    const size_t cap = FS_TEXT_SEARCH_BLOCK + FS_TEXT_SEARCH_MAX_PATTERN;
+    unsigned char *buf = heap_caps_malloc(cap, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    return buf ? buf : malloc(cap);
+}
+
+static esp_err_t fs_text_replace_temp(const char *path, char *out, size_t out_len)
+{
+    const char *slash = strrchr(path, '/');
+    int dir_len = slash ? (int)(slash - path) : 0;
+    const char *name = slash ? slash + 1 : path;
+    int n = slash ? snprintf(out, out_len, "%.*s/.%s.rpl", dir_len, path, name)
+                  : snprintf(out, out_len, ".%s.rpl", name);
+    return (n < 0 || (size_t)n >= out_len) ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
+
+static bool fs_text_replace_write(FILE *f, const void *data, size_t len)
+{
+    return len == 0 || fwrite(data, 1, len, f) == len;
+}
+
+static esp_err_t fs_text_search_spawn(void)
+{
+    fs_text_search_job_t *job = &s_job;
+    job->exited = xSemaphoreCreateBinary();
+    if (!job->exited) {
+        memset(job, 0, sizeof(*job));
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(fs_text_search_task, "fs_text_search", FS_TEXT_SEARCH_TASK_STACK,
+                    job, FS_TEXT_SEARCH_TASK_PRIO, &job->task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start the search task");
+        vSemaphoreDelete(job->exited);
+        memset(job, 0, sizeof(*job));
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static void fs_text_search_prepare(fs_text_search_matcher_t *m, const char *pattern, size_t len)
+{
+    m->pattern = (const unsigned char *)pattern;
+    m->len = len;
+    memset(m->skip, (int)len, sizeof(m->skip));
+    for (size_t i = 0; i + 1 < len; i++) {
+        m->skip[m->pattern[i]] = (uint8_t)(len - 1 - i);
+    }
+}
+
+static size_t fs_text_search_scan(const fs_text_search_matcher_t *m, const unsigned char *buf, size_t len, bool first)
+{
+    if (len < m->len) {
+        return SIZE_MAX;
+    }
+    const size_t last = m->len - 1;
+    const unsigned char tail = m->pattern[last];
+    if (last == 0 && first) {
+        const unsigned char *hit = memchr(buf, tail, len);
+        return hit ? (size_t)(hit - buf) : SIZE_MAX;
+    }
+
+    size_t found = SIZE_MAX;
+    for (size_t i = 0; i + last < len; i += m->skip[buf[i + last]]) {
+        if (buf[i + last] == tail && memcmp(buf + i, m->pattern, last) == 0) {
+            if (first) {
+                return i;
+            }
+            found = i;
+        }
+    }
+    return found;
+}
+
+static esp_err_t fs_text_search_forward(fs_text_reader_t *reader, const fs_text_search_matcher_t *m,
+                                        unsigned char *buf, size_t start, size_t limit, size_t *out_offset,
+                                        const volatile bool *cancel, volatile size_t *scanned)
+{
+    size_t carry = 0;
+    size_t pos = start;
+    while (pos < limit) {
+        if (cancel && *cancel) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        size_t want = limit - pos;
+        if (want > FS_TEXT_SEARCH_BLOCK) {
+            want = FS_TEXT_SEARCH_BLOCK;
+        }
+        size_t got = 0;
+        esp_err_t err = fs_text_reader_pread(reader, pos, buf + carry, want, &got);
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (got == 0) {
+            break;
+        }
+        if (scanned) {
+            *scanned += got;
+        }
+
+        size_t n = carry + got;
+        size_t hit = fs_text_search_scan(m, buf, n, true);
+        if (hit != SIZE_MAX) {
+            *out_offset = pos - carry + hit;
+            return ESP_OK;
+        }
+        pos += got;
+
+        /* Keep the tail: a match may start here and end in the next block */
+        carry = (n < m->len - 1) ? n : m->len - 1;
+        memmove(buf, buf + n - carry, carry);
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+static esp_err_t fs_text_search_backward(fs_text_reader_t *reader, const fs_text_search_matcher_t *m,
+                                         unsigned char *buf, size_t start, size_t limit, size_t *out_offset,
+                                         const volatile bool *cancel, volatile size_t *scanned)
+{
+    const size_t span = FS_TEXT_SEARCH_BLOCK + m->len - 1;
+    size_t hi = limit;
+    for (;;) {
+        if (cancel && *cancel) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        size_t lo = (hi - start > span) ? hi - span : start;
+        size_t got = 0;
+        esp_err_t err = fs_text_reader_pread(reader, lo, buf, hi - lo, &got);
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (scanned) {
+            *scanned += got;
+        }
+
+        /* The len - 1 byte overlap with the previous block cannot hold a whole match: none is seen twice */
+        size_t hit = fs_text_search_scan(m, buf, got, false);
+        if (hit != SIZE_MAX) {
+            *out_offset = lo + hit;
+            return ESP_OK;
+        }
+        if (lo == start) {
+            break;
+        }
+        hi = lo + m->len - 1;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+static void fs_text_search_task(void *arg)
+{
+    fs_text_search_job_t *job = (fs_text_search_job_t *)arg;
+    int64_t t0 = esp_timer_get_time();
+
+    esp_err_t err = ESP_OK;
+    fs_text_reader_t reader;
+    if (job->replace) {
+        struct stat st = {0};
+        job->total = (stat(job->path, &st) == 0) ? (size_t)st.st_size : 0;
+        err = fs_text_replace_all(job->path, job->pattern, job->replacement, &job->count,
+                                  &job->cancel, &job->scanned);
+    } else if ((err = job->binary ? fs_text_reader_open_binary(&reader, job->path)
+                                  : fs_text_reader_open(&reader, job->path)) == ESP_OK) {
+        size_t from = (job->from < reader.size) ? job->from : reader.size;
+        job->total = reader.size;
+
+        /* The part on the search direction's side of @p from first, then wrap around */
+        size_t start = job->forward ? from : 0;
+        size_t end = job->forward ? SIZE_MAX : from;
+        err = fs_text_search_find_bytes(&reader, job->pattern, job->pattern_len, start, end, job->forward,
+                                        &job->offset, &job->cancel, &job->scanned);
+        if (err == ESP_ERR_NOT_FOUND) {
+            start = job->forward ? 0 : from;
+            end = job->forward ? from : SIZE_MAX;
+            err = fs_text_search_find_bytes(&reader, job->pattern, job->pattern_len, start, end, job->forward,
+                                            &job->offset, &job->cancel, &job->scanned);
+        }
+        fs_text_reader_close(&reader);
+    }
+
+    int64_t ms = (esp_timer_get_time() - t0) / 1000;
+    ESP_LOGD(TAG, "%s %zu bytes of %s in %lld ms: %s", job->replace ? "Rewrote" : "Searched",
+             (size_t)job->scanned, job->path, (long long)ms, esp_err_to_name(err));
+    job->err = err;
+    job->done = true;
+
+    xSemaphoreGive(job->exited);
+    vTaskDelete(NULL);
+}
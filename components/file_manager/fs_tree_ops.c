@@ -0,0 +1,215 @@
+#include "fs_tree_ops.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "fs_navigator.h"
+
+static const char *TAG = "fs_tree";
+
+/**
+ * @brief Copy a single file from @p src to @p dest, removing @p dest on failure.
+ */
+static esp_err_t fs_tree_copy_file(const char *src, const char *dest);
+
+/**
+ * @brief Create @p dest and copy the children of @p src into it via fs_tree_copy().
+ *
+ * On failure, the partially copied @p dest is deleted.
+ */
+static esp_err_t fs_tree_copy_dir(const char *src, const char *dest);
+
+esp_err_t fs_tree_delete(const char *path)
+{
+    if (!path || path[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct stat st = {0};
+    if (stat(path, &st) != 0) {
+        if (errno == ENOENT) {
+            return ESP_OK;
+        }
+        ESP_LOGE(TAG, "stat(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(path);
+        if (!dir) {
+            ESP_LOGE(TAG, "opendir(%s) failed (errno=%d)", path, errno);
+            return ESP_FAIL;
+        }
+        struct dirent *dent = NULL;
+        while ((dent = readdir(dir)) != NULL) {
+            if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0) {
+                continue;
+            }
+            char child[FS_NAV_MAX_PATH];
+            int needed = snprintf(child, sizeof(child), "%s/%s", path, dent->d_name);
+            if (needed < 0 || needed >= (int)sizeof(child)) {
+                closedir(dir);
+                return ESP_ERR_INVALID_SIZE;
+            }
+            esp_err_t err = fs_tree_delete(child);
+            if (err != ESP_OK) {
+                closedir(dir);
+                return err;
+            }
+        }
+        closedir(dir);
+        if (rmdir(path) != 0) {
+            ESP_LOGE(TAG, "rmdir(%s) failed (errno=%d)", path, errno);
+            return ESP_FAIL;
+        }
+        return ESP_OK;
+    }
+
+    if (remove(path) != 0) {
+        ESP_LOGE(TAG, "remove(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t fs_tree_total_size(const char *path, uint64_t *bytes)
+{
+    if (!path || !bytes || path[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        ESP_LOGE(TAG, "stat(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        *bytes += (uint64_t)st.st_size;
+        return ESP_OK;
+    }
+
+    DIR *dir = opendir(path);
+    if (!dir) {
+        ESP_LOGE(TAG, "opendir(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    struct dirent *dent = NULL;
+    while ((dent = readdir(dir)) != NULL) {
+        if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0) {
+            continue;
+        }
+        char child[FS_NAV_MAX_PATH];
+        int needed = snprintf(child, sizeof(child), "%s/%s", path, dent->d_name);
+        if (needed < 0 || needed >= (int)sizeof(child)) {
+            closedir(dir);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        esp_err_t err = fs_tree_total_size(child, bytes);
+        if (err != ESP_OK) {
+            closedir(dir);
+            return err;
+        }
+    }
+    closedir(dir);
+    return ESP_OK;
+}
+
+esp_err_t fs_tree_copy(const char *src, const char *dest)
+{
+    if (!src || !dest) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct stat st;
+    if (stat(src, &st) != 0) {
+        ESP_LOGE(TAG, "stat(%s) failed (errno=%d)", src, errno);
+        return ESP_FAIL;
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        return fs_tree_copy_dir(src, dest);
+    }
+    return fs_tree_copy_file(src, dest);
+}
+
+static esp_err_t fs_tree_copy_file(const char *src, const char *dest)
+{
+    FILE *in = fopen(src, "rb");
+    if (!in) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", src, errno);
+        return ESP_FAIL;
+    }
+    FILE *out = fopen(dest, "wb");
+    if (!out) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", dest, errno);
+        fclose(in);
+        return ESP_FAIL;
+    }
+
+    uint8_t buf[FS_TREE_COPY_BLOCK];
+    size_t r = 0;
+    esp_err_t err = ESP_OK;
+    while ((r = fread(buf, 1, sizeof(buf), in)) > 0) {
+        size_t w = fwrite(buf, 1, r, out);
+        if (w != r) {
+            ESP_LOGE(TAG, "fwrite(%s) failed (errno=%d)", dest, errno);
+            err = ESP_FAIL;
+            break;
+        }
+    }
+
+    if (ferror(in)) {
+        ESP_LOGE(TAG, "fread(%s) failed (errno=%d)", src, errno);
+        err = ESP_FAIL;
+    }
+
+    fclose(out);
+    fclose(in);
+    if (err != ESP_OK) {
+        remove(dest);
+    }
+    return err;
+}
+
+static esp_err_t fs_tree_copy_dir(const char *src, const char *dest)
+{
+    if (mkdir(dest, 0775) != 0) {
+        ESP_LOGE(TAG, "mkdir(%s) failed (errno=%d)", dest, errno);
+        return ESP_FAIL;
+    }
+
+    DIR *dir = opendir(src);
+    if (!dir) {
+        ESP_LOGE(TAG, "opendir(%s) failed (errno=%d)", src, errno);
+        rmdir(dest);
+        return ESP_FAIL;
+    }
+
+    struct dirent *dent = NULL;
+    while ((dent = readdir(dir)) != NULL) {
+        if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0) {
+            continue;
+        }
+        char child_src[FS_NAV_MAX_PATH];
+        char child_dest[FS_NAV_MAX_PATH];
+        int ns = snprintf(child_src, sizeof(child_src), "%s/%s", src, dent->d_name);
+        int nd = snprintf(child_dest, sizeof(child_dest), "%s/%s", dest, dent->d_name);
+        if (ns < 0 || ns >= (int)sizeof(child_src) || nd < 0 || nd >= (int)sizeof(child_dest)) {
+            closedir(dir);
+            fs_tree_delete(dest);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        esp_err_t err = fs_tree_copy(child_src, child_dest);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to copy item: (%s)", esp_err_to_name(err));
+            closedir(dir);
+            fs_tree_delete(dest);
+            return err;
+        }
+    }
+    closedir(dir);
+    return ESP_OK;
+}
@@ -0,0 +1,1196 @@
+#include "hex_viewer_screen.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <inttypes.h>
+
+#include "fs_text_ops.h"
+#include "fs_text_search.h"
+#include "esp_log.h"
+#include "styles.h"
+
+#define HEX_VIEWER_BLOCK_SIZE       512         /* Cache block, aligned in the file */
+#define HEX_VIEWER_CACHE_BLOCKS     8           /* Blocks kept (a few screens either way) */
+#define HEX_VIEWER_MAX_ROWS         32          /* Rows drawn at once (more than fit the panel) */
+#define HEX_VIEWER_MAX_ROW_BYTES    16
+#define HEX_VIEWER_SLIDER_STEPS     1000
+#define HEX_VIEWER_THROW_PERIOD_MS  20
+#define HEX_VIEWER_THROW_DECAY      10          /* Percent of the fling speed lost per period */
+#define HEX_VIEWER_SEARCH_POLL_MS   100
+
+/**
+ * @brief One aligned block of the file kept in memory.
+ */
+typedef struct
+{
+    size_t offset;                              /**< File offset (multiple of HEX_VIEWER_BLOCK_SIZE), SIZE_MAX if empty */
+    size_t len;                                 /**< Valid bytes (short at EOF) */
+    uint32_t used;                              /**< Access stamp for least-recently-used replacement */
+    uint8_t data[HEX_VIEWER_BLOCK_SIZE];
+} hex_viewer_block_t;
+
+/**
+ * @brief Dialogs sharing the single prompt of the screen.
+ */
+typedef enum
+{
+    HEX_VIEWER_DIALOG_NONE = 0,
+    HEX_VIEWER_DIALOG_GOTO,
+    HEX_VIEWER_DIALOG_FIND,
+} hex_viewer_dialog_t;
+
+/**
+ * @brief Runtime state for the singleton hex viewer screen.
+ */
+typedef struct
+{
+    bool active;                                /**< True while the viewer screen is active */
+    fs_text_reader_t reader;                    /**< Open file; its size is the one shown */
+    hex_viewer_block_t *blocks;                 /**< Block cache, HEX_VIEWER_CACHE_BLOCKS entries */
+    uint32_t clock;                             /**< Last access stamp handed out */
+    uint8_t rows[HEX_VIEWER_MAX_ROWS * HEX_VIEWER_MAX_ROW_BYTES]; /**< Bytes of the rows on screen */
+    size_t rows_len;                            /**< Valid bytes in @c rows */
+    size_t rows_first;                          /**< Row the @c rows buffer starts at, SIZE_MAX if stale */
+    size_t top_row;                             /**< Row at the top of the view */
+    int32_t top_px;                             /**< Pixels of @c top_row scrolled out above the view */
+    size_t row_bytes;                           /**< Bytes per row (4, 8 or 16, whatever fits) */
+    size_t total_rows;                          /**< Rows in the file */
+    size_t rows_visible;                        /**< Rows drawn (the last one may be cut) */
+    int32_t row_h;                              /**< Row height in pixels */
+    int32_t view_h;                             /**< Content height of the view */
+    int32_t offset_w;                           /**< Width of the offset column */
+    int32_t hex_cell_w;                         /**< Width of one hex byte */
+    int32_t ascii_x;                            /**< Start of the ASCII column */
+    int32_t ascii_cell_w;                       /**< Width of one ASCII character */
+    int offset_digits;                          /**< Hex digits of the offset column */
+    const lv_font_t *font;                      /**< Font the rows are drawn with */
+    size_t mark_offset;                         /**< First highlighted byte, SIZE_MAX if none */
+    size_t mark_len;                            /**< Highlighted bytes */
+    int32_t throw_v;                            /**< Fling speed in pixels per period */
+    lv_timer_t *throw_timer;                    /**< Timer carrying the fling after release */
+    lv_obj_t *screen;                           /**< Root LVGL screen object */
+    lv_obj_t *status_label;                     /**< Label showing transient status messages */
+    lv_obj_t *view;                             /**< Custom-drawn rows */
+    lv_obj_t *slider;                           /**< Vertical slider over the whole file */
+    lv_obj_t *keyboard;                         /**< On-screen keyboard for the dialogs */
+    lv_obj_t *dialog;                           /**< Go-to-offset or find dialog */
+    lv_obj_t *dialog_textarea;                  /**< Entry inside @c dialog */
+    hex_viewer_dialog_t dialog_kind;            /**< Which dialog @c dialog is */
+    bool slider_suppress_change;                /**< Guard slider callbacks while syncing */
+    lv_timer_t *search_timer;                   /**< Timer polling the background search, NULL when idle */
+    uint8_t pattern[FS_TEXT_SEARCH_MAX_PATTERN]; /**< Last byte pattern searched for */
+    size_t pattern_len;
+    char pattern_text[3 * FS_TEXT_SEARCH_MAX_PATTERN + 1]; /**< Pattern as typed */
+    lv_obj_t *return_screen;                    /**< Screen to return to on close */
+    char path[FS_TEXT_MAX_PATH];                /**< Current file path */
+} hex_viewer_ctx_t;
+
+static const char *TAG = "hex_viewer";
+static hex_viewer_ctx_t s_hex;
+static char s_hex_pairs[256][3];                /* "00".."FF", drawn without copies */
+static char s_hex_ascii[256][2];                /* Printable ASCII, '.' for the rest */
+
+/************************************** UI Setup & State *************************************/
+
+/**
+ * @brief Build all LVGL widgets for the hex viewer screen.
+ *
+ * @param ctx Viewer context (must be non-NULL).
+ */
+static void hex_viewer_build_screen(hex_viewer_ctx_t *ctx);
+
+/**
+ * @brief Measure the font and the view, then choose the row width and column positions.
+ *
+ * @param ctx Viewer context.
+ */
+static void hex_viewer_layout(hex_viewer_ctx_t *ctx);
+
+/**
+ * @brief Set the status label text.
+ *
+ * @param ctx Viewer context.
+ * @param msg Message (ignored if NULL).
+ */
+static void hex_viewer_set_status(hex_viewer_ctx_t *ctx, const char *msg);
+
+/**
+ * @brief Close the file, drop the screen and return to the previous one.
+ *
+ * @param ctx Viewer context.
+ */
+static void hex_viewer_close(hex_viewer_ctx_t *ctx);
+
+/**
+ * @brief "Back" button handler.
+ *
+ * @param e LVGL event.
+ */
+static void hex_viewer_on_back(lv_event_t *e);
+
+/*********************************************************************************************/
+
+/************************************** Rows & scrolling *************************************/
+
+/**
+ * @brief Copy @p len bytes at @p offset through the block cache.
+ *
+ * @param ctx      Viewer context.
+ * @param offset   File offset.
+ * @param buf      Destination.
+ * @param len      Bytes wanted.
+ * @param out_read Receives the bytes copied (short at EOF or on a read error).
+ *
+ * @return ESP_OK or the fs_text_reader_pread() error.
+ */
+static esp_err_t hex_viewer_read(hex_viewer_ctx_t *ctx, size_t offset, uint8_t *buf, size_t len, size_t *out_read);
+
+/**
+ * @brief Refill the row buffer if the top row moved.
+ *
+ * @param ctx Viewer context.
+ */
+static void hex_viewer_fill_rows(hex_viewer_ctx_t *ctx);
+
+/**
+ * @brief Scroll to absolute pixel position @p pos (clamped), refresh the rows and the slider.
+ *
+ * @param ctx Viewer context.
+ * @param pos Pixels from the top of the first row.
+ */
+static void hex_viewer_scroll_to(hex_viewer_ctx_t *ctx, uint64_t pos);
+
+/**
+ * @brief Scroll by @p dy pixels (positive shows later rows).
+ *
+ * @param ctx Viewer context.
+ * @param dy  Pixel delta.
+ */
+static void hex_viewer_scroll_by(hex_viewer_ctx_t *ctx, int32_t dy);
+
+/**
+ * @brief Current scroll position and the largest one, in pixels.
+ */
+static uint64_t hex_viewer_scroll_pos(hex_viewer_ctx_t *ctx, uint64_t *out_max);
+
+/**
+ * @brief Highlight [@p offset, @p offset + @p len) and bring its first row into view.
+ *
+ * @param ctx    Viewer context.
+ * @param offset File offset.
+ * @param len    Bytes to highlight.
+ */
+static void hex_viewer_show_offset(hex_viewer_ctx_t *ctx, size_t offset, size_t len);
+
+/**
+ * @brief Draw the visible rows (offset, hex bytes, ASCII).
+ *
+ * @param e LVGL event (LV_EVENT_DRAW_MAIN).
+ */
+static void hex_viewer_on_draw(lv_event_t *e);
+
+/**
+ * @brief Drag-to-scroll, fling and resize handling of the view.
+ *
+ * @param e LVGL event.
+ */
+static void hex_viewer_on_view_event(lv_event_t *e);
+
+/**
+ * @brief Carry on a fling after release, slowing down every period.
+ *
+ * @param timer LVGL timer (user data: viewer context).
+ */
+static void hex_viewer_on_throw_timer(lv_timer_t *timer);
+
+/**
+ * @brief Stop a fling in progress.
+ *
+ * @param ctx Viewer context.
+ */
+static void hex_viewer_stop_throw(hex_viewer_ctx_t *ctx);
+
+/**
+ * @brief Sync the slider with the scroll position.
+ *
+ * @param ctx Viewer context.
+ */
+static void hex_viewer_update_slider(hex_viewer_ctx_t *ctx);
+
+/**
+ * @brief Slider handler: jump to the matching position of the file.
+ *
+ * @param e LVGL event.
+ */
+static void hex_viewer_on_slider(lv_event_t *e);
+
+/*********************************************************************************************/
+
+/************************************ Go-to-offset & find ************************************/
+
+/**
+ * @brief Show the go-to-offset or find dialog with the keyboard under it.
+ *
+ * @param ctx  Viewer context.
+ * @param kind Dialog to show.
+ */
+static void hex_viewer_show_dialog(hex_viewer_ctx_t *ctx, hex_viewer_dialog_t kind);
+
+/**
+ * @brief Close the dialog (if present) and hide the keyboard.
+ *
+ * @param ctx Viewer context.
+ */
+static void hex_viewer_close_dialog(hex_viewer_ctx_t *ctx);
+
+/**
+ * @brief Dialog button handler (also used by the keyboard's OK button).
+ *
+ * @param e LVGL event.
+ */
+static void hex_viewer_on_dialog(lv_event_t *e);
+
+/**
+ * @brief Keyboard cancel handler: close the dialog.
+ *
+ * @param e LVGL event.
+ */
+static void hex_viewer_on_keyboard_cancel(lv_event_t *e);
+
+/**
+ * @brief "Offset" button handler.
+ *
+ * @param e LVGL event.
+ */
+static void hex_viewer_on_goto(lv_event_t *e);
+
+/**
+ * @brief "Find" button handler: opens the find dialog, or cancels a search in progress.
+ *
+ * @param e LVGL event.
+ */
+static void hex_viewer_on_find(lv_event_t *e);
+
+/**
+ * @brief Parse hex bytes ("de ad BE EF") or "quoted text" into @p out.
+ *
+ * @param text    Input as typed.
+ * @param out     Receives the bytes.
+ * @param cap     Capacity of @p out.
+ * @param out_len Receives the byte count.
+ *
+ * @return true if @p text is a non-empty pattern that fits.
+ */
+static bool hex_viewer_parse_pattern(const char *text, uint8_t *out, size_t cap, size_t *out_len);
+
+/**
+ * @brief Start a background search for ctx->pattern after (or before) the highlight or the top row.
+ *
+ * @param ctx     Viewer context.
+ * @param forward true for the next match, false for the previous one.
+ */
+static void hex_viewer_find(hex_viewer_ctx_t *ctx, bool forward);
+
+/**
+ * @brief Poll the background search, show its progress and highlight the match.
+ *
+ * @param timer LVGL timer (user data: viewer context).
+ */
+static void hex_viewer_on_search_timer(lv_timer_t *timer);
+
+/**
+ * @brief Cancel a background search and drop its timer.
+ *
+ * @param ctx Viewer context.
+ */
+static void hex_viewer_stop_search(hex_viewer_ctx_t *ctx);
+
+/*********************************************************************************************/
+
+esp_err_t hex_viewer_open(const hex_viewer_open_opts_t *opts)
+{
+    if (!opts || !opts->return_screen || !opts->path || strlen(opts->path) >= sizeof(s_hex.path))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    hex_viewer_ctx_t *ctx = &s_hex;
+    hex_viewer_block_t *blocks = malloc(HEX_VIEWER_CACHE_BLOCKS * sizeof(hex_viewer_block_t));
+    if (!blocks)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    fs_text_reader_t reader;
+    esp_err_t err = fs_text_reader_open_binary(&reader, opts->path);
+    if (err != ESP_OK)
+    {
+        free(blocks);
+        return err;
+    }
+
+    if (s_hex_pairs[0][0] == '\0')
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            snprintf(s_hex_pairs[i], sizeof(s_hex_pairs[i]), "%02X", i);
+            s_hex_ascii[i][0] = (i >= 0x20 && i < 0x7F) ? (char)i : '.';
+            s_hex_ascii[i][1] = '\0';
+        }
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->reader = reader;
+    ctx->blocks = blocks;
+    for (size_t i = 0; i < HEX_VIEWER_CACHE_BLOCKS; i++)
+    {
+        ctx->blocks[i].offset = SIZE_MAX;
+    }
+    ctx->rows_first = SIZE_MAX;
+    ctx->mark_offset = SIZE_MAX;
+    ctx->return_screen = opts->return_screen;
+    strlcpy(ctx->path, opts->path, sizeof(ctx->path));
+    ctx->active = true;
+
+    hex_viewer_build_screen(ctx);
+    lv_screen_load(ctx->screen);
+    lv_obj_update_layout(ctx->screen);
+    hex_viewer_layout(ctx);
+    hex_viewer_scroll_to(ctx, 0);
+
+    char status[32];
+    snprintf(status, sizeof(status), "%zu bytes", ctx->reader.size);
+    hex_viewer_set_status(ctx, status);
+    return ESP_OK;
+}
+
+static void hex_viewer_build_screen(hex_viewer_ctx_t *ctx)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(scr, UI_COLOR_BG_DARK, 0);
+    lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, 0);
+    lv_obj_set_style_text_color(scr, UI_COLOR_TEXT_DARK, 0);
+    lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(scr, 2, 0);
+    lv_obj_set_style_pad_gap(scr, 5, 0);
+    lv_obj_set_flex_flow(scr, LV_FLEX_FLOW_COLUMN);
+    ctx->screen = scr;
+
+    lv_obj_t *toolbar = lv_obj_create(scr);
+    lv_obj_remove_style_all(toolbar);
+    lv_obj_set_size(toolbar, LV_PCT(100), LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(toolbar, LV_FLEX_FLOW_ROW);
+    lv_obj_set_style_pad_gap(toolbar, 3, 0);
+    lv_obj_set_flex_align(toolbar, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_bg_color(toolbar, UI_COLOR_CARD_DARK, 0);
+    lv_obj_set_style_bg_opa(toolbar, LV_OPA_COVER, 0);
+    lv_obj_clear_flag(toolbar, LV_OBJ_FLAG_SCROLLABLE);
+
+    static const struct
+    {
+        const char *text;
+        lv_event_cb_t cb;
+    } buttons[] = {
+        {LV_SYMBOL_LEFT " Back", hex_viewer_on_back},
+        {LV_SYMBOL_RIGHT " Offset", hex_viewer_on_goto},
+        {LV_SYMBOL_EYE_OPEN " Find", hex_viewer_on_find},
+    };
+    for (size_t i = 0; i < sizeof(buttons) / sizeof(buttons[0]); i++)
+    {
+        lv_obj_t *btn = lv_button_create(toolbar);
+        lv_obj_set_style_radius(btn, 6, 0);
+        lv_obj_set_style_pad_all(btn, 6, 0);
+        styles_build_button(btn);
+        lv_obj_add_event_cb(btn, buttons[i].cb, LV_EVENT_CLICKED, ctx);
+        lv_obj_t *lbl = lv_label_create(btn);
+        lv_label_set_text(lbl, buttons[i].text);
+        lv_obj_set_style_text_color(lbl, UI_COLOR_TEXT_DARK, 0);
+        lv_obj_center(lbl);
+    }
+
+    ctx->status_label = lv_label_create(toolbar);
+    lv_label_set_text(ctx->status_label, "");
+    lv_label_set_long_mode(ctx->status_label, LV_LABEL_LONG_CLIP);
+    lv_obj_set_flex_grow(ctx->status_label, 1);
+    lv_obj_set_style_text_align(ctx->status_label, LV_TEXT_ALIGN_CENTER, 0);
+    lv_obj_set_style_text_color(ctx->status_label, UI_COLOR_TEXT_DARK, 0);
+
+    lv_obj_t *path_label = lv_label_create(scr);
+    lv_label_set_long_mode(path_label, LV_LABEL_LONG_SCROLL_CIRCULAR);
+    lv_obj_set_width(path_label, LV_PCT(100));
+    lv_obj_set_style_text_color(path_label, UI_COLOR_TEXT_DARK, 0);
+    lv_label_set_text(path_label, ctx->path);
+
+    lv_coord_t slider_gap = 6;
+
+    lv_obj_t *body = lv_obj_create(scr);
+    lv_obj_remove_style_all(body);
+    lv_obj_set_size(body, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_flex_flow(body, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(body, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_gap(body, slider_gap, 0);
+    lv_obj_set_style_pad_right(body, slider_gap, 0);
+    lv_obj_set_flex_grow(body, 1);
+    lv_obj_clear_flag(body, LV_OBJ_FLAG_SCROLLABLE);
+
+    /* Rows are drawn on demand: the object itself never scrolls or holds text */
+    ctx->view = lv_obj_create(body);
+    lv_obj_remove_style_all(ctx->view);
+    lv_obj_set_flex_grow(ctx->view, 1);
+    lv_obj_set_height(ctx->view, LV_PCT(100));
+    lv_obj_set_style_pad_all(ctx->view, 2, 0);
+    lv_obj_set_style_bg_color(ctx->view, UI_COLOR_CARD_DARK, 0);
+    lv_obj_set_style_bg_opa(ctx->view, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_color(ctx->view, UI_COLOR_BORDER_DARK, 0);
+    lv_obj_set_style_border_width(ctx->view, 1, 0);
+    lv_obj_set_style_text_color(ctx->view, UI_COLOR_TEXT_DARK, 0);
+    lv_obj_clear_flag(ctx->view, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(ctx->view, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(ctx->view, hex_viewer_on_draw, LV_EVENT_DRAW_MAIN, ctx);
+    lv_obj_add_event_cb(ctx->view, hex_viewer_on_view_event, LV_EVENT_PRESSED, ctx);
+    lv_obj_add_event_cb(ctx->view, hex_viewer_on_view_event, LV_EVENT_PRESSING, ctx);
+    lv_obj_add_event_cb(ctx->view, hex_viewer_on_view_event, LV_EVENT_RELEASED, ctx);
+    lv_obj_add_event_cb(ctx->view, hex_viewer_on_view_event, LV_EVENT_SIZE_CHANGED, ctx);
+
+    lv_obj_t *slider = lv_slider_create(body);
+    lv_slider_set_orientation(slider, LV_SLIDER_ORIENTATION_VERTICAL);
+    lv_slider_set_range(slider, HEX_VIEWER_SLIDER_STEPS, 0); /* Min at top, max at bottom */
+    lv_slider_set_value(slider, 0, LV_ANIM_OFF);
+    lv_obj_set_width(slider, 14);
+    lv_obj_set_height(slider, LV_PCT(85));
+    lv_obj_set_style_pad_all(slider, 0, 0);
+    lv_obj_set_style_translate_y(slider, 2, 0);
+    lv_obj_set_style_bg_color(slider, UI_COLOR_BORDER_DARK, 0);
+    lv_obj_set_style_bg_opa(slider, LV_OPA_60, 0);
+    lv_obj_set_style_radius(slider, 8, 0);
+    lv_obj_set_style_bg_color(slider, UI_COLOR_ACCENT_BLUE_DARK, LV_PART_INDICATOR);
+    lv_obj_set_style_bg_opa(slider, LV_OPA_COVER, LV_PART_INDICATOR);
+    lv_obj_set_style_radius(slider, 8, LV_PART_INDICATOR);
+    lv_obj_set_style_bg_color(slider, UI_COLOR_ACCENT_BLUE_DARK, LV_PART_KNOB);
+    lv_obj_set_style_bg_opa(slider, LV_OPA_COVER, LV_PART_KNOB);
+    lv_obj_set_style_border_color(slider, UI_COLOR_BUTTON_BORDER_DARK, LV_PART_KNOB);
+    lv_obj_set_style_border_width(slider, 1, LV_PART_KNOB);
+    lv_obj_set_style_radius(slider, 6, LV_PART_KNOB);
+    lv_obj_set_style_width(slider, 12, LV_PART_KNOB);
+    lv_obj_set_style_height(slider, 12, LV_PART_KNOB);
+    lv_obj_add_event_cb(slider, hex_viewer_on_slider, LV_EVENT_VALUE_CHANGED, ctx);
+    lv_obj_clear_flag(slider, LV_OBJ_FLAG_SCROLL_CHAIN);
+    ctx->slider = slider;
+
+    ctx->keyboard = lv_keyboard_create(scr);
+    styles_build_keyboard(ctx->keyboard);
+    lv_keyboard_set_textarea(ctx->keyboard, NULL);
+    lv_obj_add_flag(ctx->keyboard, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_event_cb(ctx->keyboard, hex_viewer_on_keyboard_cancel, LV_EVENT_CANCEL, ctx);
+    lv_obj_add_event_cb(ctx->keyboard, hex_viewer_on_dialog, LV_EVENT_READY, ctx);
+}
+
+static void hex_viewer_layout(hex_viewer_ctx_t *ctx)
+{
+    ctx->font = lv_obj_get_style_text_font(ctx->view, LV_PART_MAIN);
+    ctx->row_h = lv_font_get_line_height(ctx->font) + 2;
+    ctx->view_h = lv_obj_get_content_height(ctx->view);
+
+    /* Every byte gets a fixed cell, so the columns line up with a proportional font */
+    int32_t digit_w = 0;
+    for (const char *c = "0123456789ABCDEF"; *c; c++)
+    {
+        int32_t w = lv_font_get_glyph_width(ctx->font, (uint32_t)*c, '\0');
+        digit_w = (w > digit_w) ? w : digit_w;
+    }
+    ctx->offset_digits = (ctx->reader.size > 0xFFFFFF) ? 8 : 6;
+    ctx->offset_w = ctx->offset_digits * digit_w + digit_w;
+    ctx->hex_cell_w = 2 * digit_w + digit_w / 2 + 2;
+    ctx->ascii_cell_w = digit_w;
+
+    int32_t avail = lv_obj_get_content_width(ctx->view);
+    ctx->row_bytes = 4;
+    for (size_t n = HEX_VIEWER_MAX_ROW_BYTES; n > 4; n /= 2)
+    {
+        if (ctx->offset_w + (int32_t)n * (ctx->hex_cell_w + ctx->ascii_cell_w) + digit_w <= avail)
+        {
+            ctx->row_bytes = n;
+            break;
+        }
+    }
+    ctx->ascii_x = ctx->offset_w + (int32_t)ctx->row_bytes * ctx->hex_cell_w + digit_w;
+
+    size_t rows = (ctx->row_h > 0) ? (size_t)(ctx->view_h / ctx->row_h) + 2 : 1;
+    ctx->rows_visible = (rows > HEX_VIEWER_MAX_ROWS) ? HEX_VIEWER_MAX_ROWS : rows;
+    ctx->total_rows = (ctx->reader.size + ctx->row_bytes - 1) / ctx->row_bytes;
+    ctx->rows_first = SIZE_MAX;
+}
+
+static void hex_viewer_set_status(hex_viewer_ctx_t *ctx, const char *msg)
+{
+    if (ctx->status_label && msg)
+    {
+        lv_label_set_text(ctx->status_label, msg);
+    }
+}
+
+static void hex_viewer_close(hex_viewer_ctx_t *ctx)
+{
+    hex_viewer_close_dialog(ctx);
+    hex_viewer_stop_search(ctx);
+    hex_viewer_stop_throw(ctx);
+    fs_text_reader_close(&ctx->reader);
+    free(ctx->blocks);
+    ctx->blocks = NULL;
+    ctx->active = false;
+    if (ctx->return_screen)
+    {
+        lv_screen_load(ctx->return_screen);
+    }
+    if (ctx->screen)
+    {
+        lv_obj_del(ctx->screen);
+        ctx->screen = NULL;
+        ctx->status_label = NULL;
+        ctx->view = NULL;
+        ctx->slider = NULL;
+        ctx->keyboard = NULL;
+    }
+}
+
+static void hex_viewer_on_back(lv_event_t *e)
+{
+    hex_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active)
+    {
+        return;
+    }
+    hex_viewer_close(ctx);
+}
+
+static esp_err_t hex_viewer_read(hex_viewer_ctx_t *ctx, size_t offset, uint8_t *buf, size_t len, size_t *out_read)
+{
+    *out_read = 0;
+    while (len > 0 && offset < ctx->reader.size)
+    {
+        size_t base = offset - offset % HEX_VIEWER_BLOCK_SIZE;
+        hex_viewer_block_t *block = NULL;
+        hex_viewer_block_t *victim = &ctx->blocks[0];
+        for (size_t i = 0; i < HEX_VIEWER_CACHE_BLOCKS; i++)
+        {
+            if (ctx->blocks[i].offset == base)
+            {
+                block = &ctx->blocks[i];
+                break;
+            }
+            if (ctx->blocks[i].used < victim->used)
+            {
+                victim = &ctx->blocks[i];
+            }
+        }
+        if (!block)
+        {
+            /* A whole block goes straight from the card into the slot */
+            block = victim;
+            block->offset = SIZE_MAX;
+            esp_err_t err = fs_text_reader_pread(&ctx->reader, base, block->data, HEX_VIEWER_BLOCK_SIZE, &block->len);
+            if (err != ESP_OK)
+            {
+                return err;
+            }
+            block->offset = base;
+        }
+        block->used = ++ctx->clock;
+
+        size_t skip = offset - base;
+        if (skip >= block->len)
+        {
+            break;
+        }
+        size_t n = block->len - skip;
+        n = (n < len) ? n : len;
+        memcpy(buf, block->data + skip, n);
+        buf += n;
+        offset += n;
+        len -= n;
+        *out_read += n;
+    }
+    return ESP_OK;
+}
+
+static void hex_viewer_fill_rows(hex_viewer_ctx_t *ctx)
+{
+    if (ctx->rows_first == ctx->top_row)
+    {
+        return;
+    }
+    size_t got = 0;
+    esp_err_t err = hex_viewer_read(ctx, ctx->top_row * ctx->row_bytes, ctx->rows,
+                                    ctx->rows_visible * ctx->row_bytes, &got);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to read rows at %zu: %s", ctx->top_row * ctx->row_bytes, esp_err_to_name(err));
+        hex_viewer_set_status(ctx, "Read failed");
+    }
+    ctx->rows_len = got;
+    ctx->rows_first = ctx->top_row;
+}
+
+static uint64_t hex_viewer_scroll_pos(hex_viewer_ctx_t *ctx, uint64_t *out_max)
+{
+    uint64_t content = (uint64_t)ctx->total_rows * (uint64_t)ctx->row_h;
+    *out_max = (content > (uint64_t)ctx->view_h) ? content - (uint64_t)ctx->view_h : 0;
+    return (uint64_t)ctx->top_row * (uint64_t)ctx->row_h + (uint64_t)ctx->top_px;
+}
+
+static void hex_viewer_scroll_to(hex_viewer_ctx_t *ctx, uint64_t pos)
+{
+    if (ctx->row_h <= 0)
+    {
+        return;
+    }
+    uint64_t max = 0;
+    hex_viewer_scroll_pos(ctx, &max);
+    if (pos > max)
+    {
+        pos = max;
+    }
+    ctx->top_row = (size_t)(pos / (uint64_t)ctx->row_h);
+    ctx->top_px = (int32_t)(pos % (uint64_t)ctx->row_h);
+    hex_viewer_fill_rows(ctx);
+    lv_obj_invalidate(ctx->view);
+    hex_viewer_update_slider(ctx);
+}
+
+static void hex_viewer_scroll_by(hex_viewer_ctx_t *ctx, int32_t dy)
+{
+    uint64_t max = 0;
+    uint64_t pos = hex_viewer_scroll_pos(ctx, &max);
+    if (dy < 0)
+    {
+        pos = ((uint64_t)-(int64_t)dy > pos) ? 0 : pos - (uint64_t)-(int64_t)dy;
+    }
+    else
+    {
+        pos += (uint64_t)dy;
+    }
+    hex_viewer_scroll_to(ctx, pos);
+}
+
+static void hex_viewer_show_offset(hex_viewer_ctx_t *ctx, size_t offset, size_t len)
+{
+    ctx->mark_offset = offset;
+    ctx->mark_len = len;
+    size_t row = offset / ctx->row_bytes;
+    size_t full_rows = (ctx->row_h > 0) ? (size_t)(ctx->view_h / ctx->row_h) : 1;
+    if (row > ctx->top_row && row + 1 < ctx->top_row + full_rows)
+    {
+        lv_obj_invalidate(ctx->view);
+        return;
+    }
+    /* Leave a row of context above the target */
+    hex_viewer_scroll_to(ctx, (uint64_t)(row ? row - 1 : 0) * (uint64_t)ctx->row_h);
+}
+
+static void hex_viewer_on_draw(lv_event_t *e)
+{
+    hex_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    lv_layer_t *layer = lv_event_get_layer(e);
+    if (!ctx || !ctx->active || !layer || ctx->rows_first != ctx->top_row)
+    {
+        return;
+    }
+
+    lv_area_t content;
+    lv_obj_get_content_coords(ctx->view, &content);
+    lv_area_t clip = {
+        LV_MAX(layer->_clip_area.x1, content.x1), LV_MAX(layer->_clip_area.y1, content.y1),
+        LV_MIN(layer->_clip_area.x2, content.x2), LV_MIN(layer->_clip_area.y2, content.y2),
+    };
+    if (clip.x1 > clip.x2 || clip.y1 > clip.y2)
+    {
+        return;
+    }
+    lv_area_t old_clip = layer->_clip_area;
+    layer->_clip_area = clip;
+
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.font = ctx->font;
+    dsc.color = UI_COLOR_TEXT_DARK;
+
+    lv_draw_rect_dsc_t mark;
+    lv_draw_rect_dsc_init(&mark);
+    mark.bg_color = UI_COLOR_ACCENT_BLUE_DARK;
+    mark.bg_opa = LV_OPA_70;
+    mark.radius = 2;
+
+    for (size_t r = 0; r < ctx->rows_visible; r++)
+    {
+        size_t first = r * ctx->row_bytes;
+        if (first >= ctx->rows_len)
+        {
+            break;
+        }
+        size_t n = ctx->rows_len - first;
+        n = (n < ctx->row_bytes) ? n : ctx->row_bytes;
+        size_t offset = (ctx->top_row + r) * ctx->row_bytes;
+        int32_t y = content.y1 - ctx->top_px + (int32_t)r * ctx->row_h;
+        lv_area_t cell = {content.x1, y, content.x1 + ctx->offset_w - 1, y + ctx->row_h - 1};
+
+        char label[12];
+        snprintf(label, sizeof(label), "%0*zX", ctx->offset_digits, offset);
+        dsc.text = label;
+        dsc.text_local = 1;
+        dsc.align = LV_TEXT_ALIGN_LEFT;
+        dsc.opa = LV_OPA_60;
+        lv_draw_label(layer, &dsc, &cell);
+
+        /* Byte cells point at the static tables: nothing to copy per glyph */
+        dsc.text_local = 0;
+        dsc.text_static = 1;
+        dsc.align = LV_TEXT_ALIGN_CENTER;
+        dsc.opa = LV_OPA_COVER;
+        for (size_t i = 0; i < n; i++)
+        {
+            uint8_t byte = ctx->rows[first + i];
+            bool marked = ctx->mark_offset != SIZE_MAX && offset + i >= ctx->mark_offset &&
+                          offset + i - ctx->mark_offset < ctx->mark_len;
+
+            cell.x1 = content.x1 + ctx->offset_w + (int32_t)i * ctx->hex_cell_w;
+            cell.x2 = cell.x1 + ctx->hex_cell_w - 2;
+            if (marked)
+            {
+                lv_draw_rect(layer, &mark, &cell);
+            }
+            dsc.text = s_hex_pairs[byte];
+            lv_draw_label(layer, &dsc, &cell);
+
+            cell.x1 = content.x1 + ctx->ascii_x + (int32_t)i * ctx->ascii_cell_w;
+            cell.x2 = cell.x1 + ctx->ascii_cell_w - 1;
+            if (marked)
+            {
+                lv_draw_rect(layer, &mark, &cell);
+            }
+            dsc.text = s_hex_ascii[byte];
+            lv_draw_label(layer, &dsc, &cell);
+        }
+        dsc.text_static = 0;
+    }
+
+    layer->_clip_area = old_clip;
+}
+
+static void hex_viewer_on_view_event(lv_event_t *e)
+{
+    hex_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active)
+    {
+        return;
+    }
+
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_SIZE_CHANGED)
+    {
+        /* The row width may change: keep the same byte at the top */
+        size_t top_offset = ctx->top_row * ctx->row_bytes;
+        hex_viewer_layout(ctx);
+        hex_viewer_scroll_to(ctx, (uint64_t)(top_offset / ctx->row_bytes) * (uint64_t)ctx->row_h);
+    }
+    else if (code == LV_EVENT_PRESSED)
+    {
+        hex_viewer_stop_throw(ctx);
+        ctx->throw_v = 0;
+    }
+    else if (code == LV_EVENT_PRESSING)
+    {
+        lv_point_t vect = {0};
+        lv_indev_get_vect(lv_indev_active(), &vect);
+        if (vect.y != 0)
+        {
+            ctx->throw_v = -vect.y;
+            hex_viewer_scroll_by(ctx, -vect.y);
+        }
+    }
+    else if (code == LV_EVENT_RELEASED)
+    {
+        if (ctx->throw_v > 1 || ctx->throw_v < -1)
+        {
+            ctx->throw_timer = lv_timer_create(hex_viewer_on_throw_timer, HEX_VIEWER_THROW_PERIOD_MS, ctx);
+        }
+    }
+}
+
+static void hex_viewer_on_throw_timer(lv_timer_t *timer)
+{
+    hex_viewer_ctx_t *ctx = lv_timer_get_user_data(timer);
+    ctx->throw_v = ctx->throw_v * (100 - HEX_VIEWER_THROW_DECAY) / 100;
+    if (ctx->throw_v == 0)
+    {
+        hex_viewer_stop_throw(ctx);
+        return;
+    }
+    hex_viewer_scroll_by(ctx, ctx->throw_v);
+}
+
+static void hex_viewer_stop_throw(hex_viewer_ctx_t *ctx)
+{
+    if (ctx->throw_timer)
+    {
+        lv_timer_del(ctx->throw_timer);
+        ctx->throw_timer = NULL;
+    }
+}
+
+static void hex_viewer_update_slider(hex_viewer_ctx_t *ctx)
+{
+    if (!ctx->slider)
+    {
+        return;
+    }
+    uint64_t max = 0;
+    uint64_t pos = hex_viewer_scroll_pos(ctx, &max);
+    bool prev = ctx->slider_suppress_change;
+    ctx->slider_suppress_change = true;
+    if (max == 0)
+    {
+        lv_slider_set_value(ctx->slider, 0, LV_ANIM_OFF);
+        lv_obj_add_state(ctx->slider, LV_STATE_DISABLED);
+    }
+    else
+    {
+        lv_slider_set_value(ctx->slider, (int32_t)(pos * HEX_VIEWER_SLIDER_STEPS / max), LV_ANIM_OFF);
+        lv_obj_remove_state(ctx->slider, LV_STATE_DISABLED);
+    }
+    ctx->slider_suppress_change = prev;
+}
+
+static void hex_viewer_on_slider(lv_event_t *e)
+{
+    hex_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active || ctx->slider_suppress_change)
+    {
+        return;
+    }
+    hex_viewer_stop_throw(ctx);
+    uint64_t max = 0;
+    hex_viewer_scroll_pos(ctx, &max);
+    int32_t value = lv_slider_get_value(ctx->slider);
+
+    /* Land on a row edge: a jump of the slider is never finer than a row anyway */
+    uint64_t pos = max * (uint64_t)value / HEX_VIEWER_SLIDER_STEPS;
+    pos -= pos % (uint64_t)ctx->row_h;
+    bool prev = ctx->slider_suppress_change;
+    ctx->slider_suppress_change = true;
+    hex_viewer_scroll_to(ctx, value >= HEX_VIEWER_SLIDER_STEPS ? max : pos);
+    ctx->slider_suppress_change = prev;
+}
+
+static void hex_viewer_show_dialog(hex_viewer_ctx_t *ctx, hex_viewer_dialog_t kind)
+{
+    if (ctx->dialog)
+    {
+        return;
+    }
+    lv_obj_t *dlg = lv_msgbox_create(ctx->screen);
+    styles_build_msgbox(dlg);
+    ctx->dialog = dlg;
+    ctx->dialog_kind = kind;
+    lv_obj_add_flag(dlg, LV_OBJ_FLAG_FLOATING);
+    lv_obj_set_style_max_width(dlg, LV_PCT(65), 0);
+    lv_obj_set_width(dlg, LV_PCT(65));
+
+    lv_obj_t *content = lv_msgbox_get_content(dlg);
+    lv_obj_t *label = lv_label_create(content);
+    if (kind == HEX_VIEWER_DIALOG_GOTO)
+    {
+        lv_label_set_text_fmt(label, "Go to offset (hex, 0-%zX)", ctx->reader.size ? ctx->reader.size - 1 : 0);
+    }
+    else
+    {
+        lv_label_set_text(label, "Find hex bytes or \"text\"");
+    }
+    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+    lv_obj_set_width(label, LV_PCT(100));
+    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_LEFT, 0);
+
+    ctx->dialog_textarea = lv_textarea_create(content);
+    lv_textarea_set_one_line(ctx->dialog_textarea, true);
+    if (kind == HEX_VIEWER_DIALOG_GOTO)
+    {
+        lv_textarea_set_accepted_chars(ctx->dialog_textarea, "0123456789abcdefABCDEFx");
+        lv_textarea_set_max_length(ctx->dialog_textarea, 18);
+    }
+    else
+    {
+        lv_textarea_set_max_length(ctx->dialog_textarea, sizeof(ctx->pattern_text) - 1);
+        lv_textarea_set_text(ctx->dialog_textarea, ctx->pattern_text);
+    }
+    lv_obj_add_state(ctx->dialog_textarea, LV_STATE_FOCUSED);
+    styles_build_textarea(ctx->dialog_textarea);
+    lv_obj_set_width(ctx->dialog_textarea, LV_PCT(100));
+
+    if (kind == HEX_VIEWER_DIALOG_FIND)
+    {
+        lv_obj_t *prev_btn = lv_msgbox_add_footer_button(dlg, "Prev");
+        lv_obj_set_user_data(prev_btn, (void *)2);
+        styles_build_button(prev_btn);
+        lv_obj_add_event_cb(prev_btn, hex_viewer_on_dialog, LV_EVENT_CLICKED, ctx);
+    }
+
+    lv_obj_t *go_btn = lv_msgbox_add_footer_button(dlg, kind == HEX_VIEWER_DIALOG_GOTO ? "Go" : "Next");
+    lv_obj_set_user_data(go_btn, (void *)1);
+    styles_build_button(go_btn);
+    lv_obj_add_event_cb(go_btn, hex_viewer_on_dialog, LV_EVENT_CLICKED, ctx);
+
+    lv_obj_t *cancel_btn = lv_msgbox_add_footer_button(dlg, "Cancel");
+    lv_obj_set_user_data(cancel_btn, (void *)0);
+    styles_build_button(cancel_btn);
+    lv_obj_add_event_cb(cancel_btn, hex_viewer_on_dialog, LV_EVENT_CLICKED, ctx);
+
+    lv_keyboard_set_mode(ctx->keyboard, kind == HEX_VIEWER_DIALOG_GOTO ? LV_KEYBOARD_MODE_TEXT_UPPER
+                                                                       : LV_KEYBOARD_MODE_TEXT_LOWER);
+    lv_keyboard_set_textarea(ctx->keyboard, ctx->dialog_textarea);
+    lv_obj_clear_flag(ctx->keyboard, LV_OBJ_FLAG_HIDDEN);
+
+    lv_obj_update_layout(ctx->keyboard);
+    lv_obj_update_layout(dlg);
+    lv_coord_t keyboard_top = lv_obj_get_y(ctx->keyboard);
+    lv_coord_t dialog_h = lv_obj_get_height(dlg);
+    lv_coord_t margin = 10;
+    if (keyboard_top > dialog_h)
+    {
+        lv_coord_t candidate = (keyboard_top - dialog_h) / 2;
+        if (candidate > 0)
+        {
+            margin = candidate;
+        }
+    }
+    lv_obj_align(dlg, LV_ALIGN_TOP_MID, 0, margin);
+}
+
+static void hex_viewer_close_dialog(hex_viewer_ctx_t *ctx)
+{
+    if (!ctx->dialog)
+    {
+        return;
+    }
+    lv_msgbox_close(ctx->dialog);
+    ctx->dialog = NULL;
+    ctx->dialog_textarea = NULL;
+    ctx->dialog_kind = HEX_VIEWER_DIALOG_NONE;
+    if (ctx->keyboard)
+    {
+        lv_keyboard_set_textarea(ctx->keyboard, NULL);
+        lv_obj_add_flag(ctx->keyboard, LV_OBJ_FLAG_HIDDEN);
+        lv_keyboard_set_mode(ctx->keyboard, LV_KEYBOARD_MODE_TEXT_LOWER);
+    }
+}
+
+static void hex_viewer_on_dialog(lv_event_t *e)
+{
+    hex_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->dialog)
+    {
+        return;
+    }
+    /* The keyboard's OK button lands here too and confirms */
+    lv_obj_t *target = lv_event_get_target(e);
+    uintptr_t action = (target == ctx->keyboard) ? 1u : (uintptr_t)lv_obj_get_user_data(target);
+    if (action == 0)
+    {
+        hex_viewer_close_dialog(ctx);
+        return;
+    }
+
+    const char *raw = ctx->dialog_textarea ? lv_textarea_get_text(ctx->dialog_textarea) : "";
+    raw = raw ? raw : "";
+    if (ctx->dialog_kind == HEX_VIEWER_DIALOG_GOTO)
+    {
+        char *end = NULL;
+        unsigned long long offset = strtoull(raw, &end, 16);
+        if (raw[0] == '\0' || !end || *end != '\0')
+        {
+            hex_viewer_set_status(ctx, "Invalid offset");
+            return;
+        }
+        hex_viewer_close_dialog(ctx);
+        if (ctx->reader.size == 0)
+        {
+            return;
+        }
+        if (offset >= ctx->reader.size)
+        {
+            offset = ctx->reader.size - 1;
+            hex_viewer_set_status(ctx, "Past the end: last byte");
+        }
+        hex_viewer_show_offset(ctx, (size_t)offset, 1);
+        return;
+    }
+
+    uint8_t pattern[FS_TEXT_SEARCH_MAX_PATTERN];
+    size_t len = 0;
+    if (!hex_viewer_parse_pattern(raw, pattern, sizeof(pattern), &len))
+    {
+        hex_viewer_set_status(ctx, "Invalid pattern");
+        return;
+    }
+    if (len != ctx->pattern_len || memcmp(pattern, ctx->pattern, len) != 0)
+    {
+        memcpy(ctx->pattern, pattern, len);
+        ctx->pattern_len = len;
+        ctx->mark_offset = SIZE_MAX; // New pattern: start from the view
+    }
+    strlcpy(ctx->pattern_text, raw, sizeof(ctx->pattern_text));
+    hex_viewer_close_dialog(ctx);
+    hex_viewer_find(ctx, action == 1);
+}
+
+static void hex_viewer_on_keyboard_cancel(lv_event_t *e)
+{
+    hex_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx)
+    {
+        return;
+    }
+    hex_viewer_close_dialog(ctx);
+}
+
+static void hex_viewer_on_goto(lv_event_t *e)
+{
+    hex_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active)
+    {
+        return;
+    }
+    hex_viewer_show_dialog(ctx, HEX_VIEWER_DIALOG_GOTO);
+}
+
+static void hex_viewer_on_find(lv_event_t *e)
+{
+    hex_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active)
+    {
+        return;
+    }
+    if (ctx->search_timer)
+    {
+        hex_viewer_stop_search(ctx);
+        hex_viewer_set_status(ctx, "Search cancelled");
+        return;
+    }
+    hex_viewer_show_dialog(ctx, HEX_VIEWER_DIALOG_FIND);
+}
+
+static bool hex_viewer_parse_pattern(const char *text, uint8_t *out, size_t cap, size_t *out_len)
+{
+    size_t len = 0;
+    if (text[0] == '"')
+    {
+        text++;
+        size_t n = strlen(text);
+        if (n > 0 && text[n - 1] == '"')
+        {
+            n--;
+        }
+        if (n == 0 || n > cap)
+        {
+            return false;
+        }
+        memcpy(out, text, n);
+        *out_len = n;
+        return true;
+    }
+
+    int high = -1;
+    for (; *text; text++)
+    {
+        if (*text == ' ')
+        {
+            continue;
+        }
+        if (!isxdigit((unsigned char)*text))
+        {
+            return false;
+        }
+        int digit = isdigit((unsigned char)*text) ? *text - '0' : (tolower((unsigned char)*text) - 'a' + 10);
+        if (high < 0)
+        {
+            high = digit;
+            continue;
+        }
+        if (len == cap)
+        {
+            return false;
+        }
+        out[len++] = (uint8_t)(high << 4 | digit);
+        high = -1;
+    }
+    if (high >= 0 || len == 0)
+    {
+        return false; // Odd digit count or nothing
+    }
+    *out_len = len;
+    return true;
+}
+
+static void hex_viewer_find(hex_viewer_ctx_t *ctx, bool forward)
+{
+    size_t from = ctx->top_row * ctx->row_bytes;
+    if (ctx->mark_offset != SIZE_MAX)
+    {
+        from = forward ? ctx->mark_offset + 1 : ctx->mark_offset;
+    }
+    esp_err_t err = fs_text_search_start_bytes(ctx->path, ctx->pattern, ctx->pattern_len, from, forward);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Search not started: %s", esp_err_to_name(err));
+        hex_viewer_set_status(ctx, "Search failed");
+        return;
+    }
+    hex_viewer_set_status(ctx, "Searching...");
+    if (!ctx->search_timer)
+    {
+        ctx->search_timer = lv_timer_create(hex_viewer_on_search_timer, HEX_VIEWER_SEARCH_POLL_MS, ctx);
+    }
+}
+
+static void hex_viewer_on_search_timer(lv_timer_t *timer)
+{
+    hex_viewer_ctx_t *ctx = lv_timer_get_user_data(timer);
+    size_t offset = 0;
+    uint8_t percent = 0;
+    esp_err_t err = fs_text_search_poll(&offset, &percent);
+    if (err == ESP_ERR_NOT_FINISHED)
+    {
+        char status[24];
+        snprintf(status, sizeof(status), "Searching %u%%", (unsigned)percent);
+        hex_viewer_set_status(ctx, status);
+        return;
+    }
+    lv_timer_del(timer);
+    ctx->search_timer = NULL;
+
+    if (err == ESP_OK)
+    {
+        char status[32];
+        snprintf(status, sizeof(status), "Found at %zX", offset);
+        hex_viewer_set_status(ctx, status);
+        hex_viewer_show_offset(ctx, offset, ctx->pattern_len);
+    }
+    else if (err == ESP_ERR_NOT_FOUND)
+    {
+        hex_viewer_set_status(ctx, "Not found");
+    }
+    else if (err != ESP_ERR_INVALID_STATE)
+    {
+        ESP_LOGE(TAG, "Search failed: %s", esp_err_to_name(err));
+        hex_viewer_set_status(ctx, "Search failed");
+    }
+}
+
+static void hex_viewer_stop_search(hex_viewer_ctx_t *ctx)
+{
+    fs_text_search_stop();
+    if (ctx->search_timer)
+    {
+        lv_timer_del(ctx->search_timer);
+        ctx->search_timer = NULL;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+/**
+ * @brief Options describing how to open the CSV viewer.
+ */
+typedef struct {
+    const char *path;                 /**< Absolute path to an existing .csv file. */
+    lv_obj_t *return_screen;          /**< Screen to restore when the viewer closes. */
+} csv_viewer_open_opts_t;
+
+/**
+ * @brief Load the CSV table viewer screen, read-only.
+ *
+ * The first record is the pinned header; the delimiter (',', ';' or tab) is
+ * guessed from it and column widths from the first rows. Records are indexed
+ * on a background task (see fs_csv_index_start()) and only the rows and
+ * columns on screen are parsed, from a page buffer of a few KB, so a log of
+ * millions of rows opens at once and browses while the index grows. Dragging
+ * scrolls both ways, tapping a cell selects its column, "Sort" orders the
+ * table by that column and "Stats" shows its min/max/mean; both stream the
+ * file once on a background task (see fs_csv_column_start()).
+ *
+ * @param[in] opts Options:
+ *   - @c path: full path to the file
+ *   - @c return_screen (required): screen to return to on close
+ *
+ * @return
+ *   - ESP_OK on success
+ *   - ESP_ERR_INVALID_ARG if required options are missing or the path is too long
+ *   - ESP_ERR_NO_MEM if the page buffer cannot be allocated or the index task cannot start
+ *   - ESP_FAIL if the file cannot be opened or read
+ */
+esp_err_t csv_viewer_open(const csv_viewer_open_opts_t *opts);
+
+#ifdef __cplusplus
+}
+#endif
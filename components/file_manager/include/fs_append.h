@@ -0,0 +1,125 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#define FS_APPEND_MAX_PATH          256
+#define FS_APPEND_DEFAULT_BUFFER    (4 * 1024)      /* RAM buffer when the config leaves it at 0 */
+#define FS_APPEND_PREALLOC_STEP     (32 * 1024)     /* Suggested preallocation for text logs */
+
+/**
+ * @brief Tuning of an append stream; zero-initialise for the defaults.
+ */
+typedef struct {
+    size_t buffer_size;         /**< Records are coalesced up to this many bytes (0 = FS_APPEND_DEFAULT_BUFFER) */
+    uint32_t flush_ms;          /**< Oldest buffered record is flushed after this long (0 = only when full or asked) */
+    size_t prealloc;            /**< Zero-filled bytes kept ahead of the data, text lines only (0 = none, see fs_append_open()) */
+} fs_append_config_t;
+
+/**
+ * @brief Append stream: one open file and a RAM buffer of whole records.
+ *
+ * Lives wherever the caller puts it. Every call takes the stream's lock, so
+ * several tasks may log through the same stream.
+ */
+typedef struct {
+    int fd;                     /**< Open file */
+    SemaphoreHandle_t lock;     /**< NULL when closed (a zeroed stream is closed) */
+    char path[FS_APPEND_MAX_PATH];
+    fs_append_config_t config;
+    uint8_t *buf;               /**< config.buffer_size bytes */
+    size_t used;                /**< Buffered bytes not on the card yet */
+    int64_t first_us;           /**< esp_timer time of the oldest buffered byte */
+    uint64_t data_end;          /**< File offset where the next flush goes (end of the durable data) */
+    uint64_t alloc_end;         /**< File size on the card, preallocated zeros included */
+    uint32_t flushes;           /**< Flushes done, for statistics */
+} fs_append_t;
+
+/**
+ * @brief Open (or create) @p path for appending.
+ *
+ * The file stays open until fs_append_close(), so records cost a memcpy and
+ * the card only sees one write and one fsync() per flush. A flush is all or
+ * nothing: FatFs updates the directory entry (the file size) only when
+ * fsync() completes, so a power loss drops at worst the records written since
+ * the last flush and leaves the earlier ones intact. A record is never split
+ * across two flushes.
+ *
+ * With @c prealloc set, a flush that would reach the end of the reserved area
+ * first extends it with zeros to that many bytes past its records and
+ * fsync()s, so the cluster allocation and FAT updates happen once per step
+ * instead of once per cluster. The records are then written over the reserve
+ * in place, and always stop at least one zero short of the end of the file,
+ * so a power loss mid-flush can leave the start of a record before the zeros
+ * but never at the very end of the file. Records must therefore be text
+ * lines: the next fs_append_open() with @c prealloc set finds the zeros, cuts
+ * the file after the last newline before them and fsync()s the truncation,
+ * dropping the unfinished record.
+ *
+ * @param stream Stream to initialise.
+ * @param path   Absolute path; the directory must exist.
+ * @param config Tuning, or NULL for the defaults.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG on bad parameters
+ *      - ESP_ERR_NO_MEM if the buffer or the lock cannot be allocated
+ *      - ESP_FAIL if the file cannot be opened
+ */
+esp_err_t fs_append_open(fs_append_t *stream, const char *path, const fs_append_config_t *config);
+
+/**
+ * @brief Append one record.
+ *
+ * Flushes first if the record does not fit in what is left of the buffer,
+ * and afterwards if the buffer is full or its oldest record is older than
+ * @c flush_ms. Records larger than the buffer are written straight through.
+ *
+ * With @c prealloc set, every record must end in a newline.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG (also for a record without its newline
+ *         under @c prealloc), ESP_ERR_INVALID_STATE on a closed stream, or
+ *         ESP_FAIL if a flush failed (buffered records stay for the next
+ *         attempt; a record that could not be buffered is dropped).
+ */
+esp_err_t fs_append_write(fs_append_t *stream, const void *data, size_t len);
+
+/**
+ * @brief Write the buffered records and fsync() the file.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE, or ESP_FAIL.
+ */
+esp_err_t fs_append_flush(fs_append_t *stream);
+
+/**
+ * @brief Flush if the oldest buffered record is older than @c flush_ms.
+ *
+ * fs_append_write() only checks the age when a record arrives; call this from
+ * a periodic timer so a quiet stream still reaches the card in time.
+ *
+ * @return ESP_OK (also when nothing was due), or an fs_append_flush() error.
+ */
+esp_err_t fs_append_poll(fs_append_t *stream);
+
+/**
+ * @brief Flush, drop the preallocated zeros and close the file.
+ *
+ * The stream is closed even on failure. Safe on a closed stream; other tasks
+ * must be done writing to it.
+ *
+ * @return ESP_OK, or ESP_FAIL if the last flush or the truncation failed.
+ */
+esp_err_t fs_append_close(fs_append_t *stream);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,181 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define FS_BENCH_PAGE_WINDOW    32      /* Items per window when paging, like the browser list */
+#define FS_BENCH_PAGE_COUNT     8       /* Windows fetched by the paging step (plus one jump to the end) */
+#define FS_BENCH_APPEND_RECORDS 2000    /* Log lines appended per mode by fs_bench_append_run() */
+#define FS_BENCH_APPEND_BYTES   64      /* Bytes per log line, newline included */
+
+/**
+ * @brief Shape of a synthetic tree.
+ *
+ * Level 0 is the tree root; each of the @c depth nested levels below it is a
+ * single subdirectory, and every level holds @c files files of @c file_bytes.
+ */
+typedef struct {
+    const char *name;           /**< Label in the report */
+    uint32_t files;             /**< Files per level */
+    uint32_t depth;             /**< Nested directories below the root (0 = flat) */
+    uint32_t file_bytes;        /**< Size of each file */
+    size_t max_items;           /**< Navigator sort threshold, as in fs_nav_config_t */
+    bool slow;                  /**< Takes minutes on a card */
+} fs_bench_tree_spec_t;
+
+/**
+ * @brief Timed steps of a tree run, in execution order.
+ */
+typedef enum {
+    FS_BENCH_STEP_CREATE = 0,   /**< Generate the tree */
+    FS_BENCH_STEP_REFRESH,      /**< fs_nav_init() on the tree root (count pass + first load) */
+    FS_BENCH_STEP_PAGE,         /**< FS_BENCH_PAGE_COUNT windows forward, then the last window */
+    FS_BENCH_STEP_STAT,         /**< fs_nav_ensure_meta() on every loaded item */
+    FS_BENCH_STEP_SORT,         /**< Sort by name, date, size and name again (sortable trees only) */
+    FS_BENCH_STEP_WALK,         /**< Enter down to the deepest level and back up (nested trees only) */
+    FS_BENCH_STEP_SIZE,         /**< fs_tree_total_size(), as before a paste */
+    FS_BENCH_STEP_COPY,         /**< fs_tree_copy() of the whole tree */
+    FS_BENCH_STEP_DELETE,       /**< fs_tree_delete() of the copy */
+    FS_BENCH_STEP_COUNT
+} fs_bench_step_t;
+
+/**
+ * @brief Clock and heap counters of a run, supplied by the caller.
+ *
+ * The library itself only makes POSIX calls, so it runs wherever the storage
+ * core builds: the app plugs in esp_timer and the heap, the host build under
+ * host/ plugs in clock_gettime() and a counting malloc wrapper.
+ */
+typedef struct {
+    int64_t (*now_us)(void);                            /**< Monotonic clock in microseconds (required) */
+    int32_t (*allocs)(void);                            /**< Heap allocations made so far, NULL if not counted */
+    void (*heap_held)(size_t *blocks, size_t *bytes);   /**< Heap blocks and bytes held now, NULL if not tracked */
+} fs_bench_probe_t;
+
+/**
+ * @brief Cost of one step.
+ *
+ * Heap figures come from the probe; on the target they cover every task, so
+ * run the benchmark with the rest of the system idle.
+ */
+typedef struct {
+    esp_err_t err;              /**< ESP_OK, ESP_ERR_NOT_SUPPORTED if the step does not apply, or the step's error */
+    int64_t us;                 /**< Wall time */
+    int32_t allocs;             /**< Heap allocations made, -1 without a probe counter */
+    int32_t net_blocks;         /**< Heap blocks still held at the end minus at the start (0 untracked) */
+    int32_t net_bytes;          /**< Heap bytes still held at the end minus at the start (0 untracked) */
+} fs_bench_result_t;
+
+/**
+ * @brief Result of fs_bench_tree_run().
+ */
+typedef struct {
+    const fs_bench_tree_spec_t *spec;
+    uint32_t entries;           /**< Files and directories created */
+    uint64_t bytes;             /**< File bytes created */
+    fs_bench_result_t steps[FS_BENCH_STEP_COUNT];
+} fs_bench_tree_report_t;
+
+/**
+ * @brief Ways of appending log lines, in execution order.
+ */
+typedef enum {
+    FS_BENCH_APPEND_DIRECT = 0, /**< fs_text_append() per line: open, write, close */
+    FS_BENCH_APPEND_STREAM,     /**< fs_append_write() per line with the default buffer, close included */
+    FS_BENCH_APPEND_PREALLOC,   /**< Same, preallocating FS_APPEND_PREALLOC_STEP ahead */
+    FS_BENCH_APPEND_MODE_COUNT
+} fs_bench_append_mode_t;
+
+/**
+ * @brief Result of fs_bench_append_run().
+ */
+typedef struct {
+    uint32_t records;           /**< Lines appended per mode */
+    uint32_t record_bytes;      /**< Bytes per line */
+    fs_bench_result_t modes[FS_BENCH_APPEND_MODE_COUNT];
+} fs_bench_append_report_t;
+
+/**
+ * @brief Built-in trees: 10, 1k and 50k entries flat, 32 levels deep, and a few large files.
+ *
+ * The 50k-entry and large-file trees are marked @c slow.
+ *
+ * Like the rest of this header, only available when
+ * CONFIG_FILE_MANAGER_STORAGE_BENCHMARK is enabled.
+ *
+ * @param out_count Receives the number of presets.
+ */
+const fs_bench_tree_spec_t *fs_bench_tree_presets(size_t *out_count);
+
+/**
+ * @brief Short name of a step ("create", "refresh", ...).
+ */
+const char *fs_bench_step_name(fs_bench_step_t step);
+
+/**
+ * @brief Generate @p spec under @p scratch_dir and time the storage core on it.
+ *
+ * The tree is built in "<scratch_dir>/tree" and copied to "<scratch_dir>/copy";
+ * leftovers of an interrupted run are deleted first and both are deleted at
+ * the end. Only POSIX calls, fs_navigator and fs_tree_ops are involved, so any
+ * mounted VFS root can be measured: the SD card, a FAT image, a RAM disk.
+ * Blocks for the whole run, which takes minutes for the large presets on a
+ * card: call it from a worker task.
+ *
+ * A failing step is recorded in the report and the steps that depend on it
+ * are skipped.
+ *
+ * @param scratch_dir Directory to work in; created if missing.
+ * @param spec        Tree to generate.
+ * @param probe       Clock and heap counters.
+ * @param out         Receives the timings.
+ *
+ * @return ESP_OK if the tree was generated (check each step's @c err), ESP_ERR_INVALID_ARG,
+ *         ESP_ERR_INVALID_SIZE if the paths do not fit, ESP_ERR_NO_MEM, or ESP_FAIL.
+ */
+esp_err_t fs_bench_tree_run(const char *scratch_dir, const fs_bench_tree_spec_t *spec,
+                            const fs_bench_probe_t *probe, fs_bench_tree_report_t *out);
+
+/**
+ * @brief Log a report, one line per step.
+ */
+void fs_bench_tree_log(const fs_bench_tree_report_t *report);
+
+/**
+ * @brief Short name of an append mode ("direct", "stream", "prealloc").
+ */
+const char *fs_bench_append_mode_name(fs_bench_append_mode_t mode);
+
+/**
+ * @brief Append @p records lines of @p record_bytes to a file under @p scratch_dir, once per mode.
+ *
+ * Each mode starts from a new "<scratch_dir>/append.txt", which is checked for
+ * the expected size and deleted afterwards. A mode that fails is recorded in
+ * the report and the next one still runs. Blocks: call it from a worker task.
+ *
+ * @param scratch_dir  Directory to work in; created if missing.
+ * @param records      Lines per mode (FS_BENCH_APPEND_RECORDS for the reference run).
+ * @param record_bytes Bytes per line, at least 2 (FS_BENCH_APPEND_BYTES).
+ * @param probe        Clock and heap counters.
+ * @param out          Receives the timings.
+ *
+ * @return ESP_OK (check each mode's @c err), ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_SIZE, or ESP_FAIL.
+ */
+esp_err_t fs_bench_append_run(const char *scratch_dir, uint32_t records, uint32_t record_bytes,
+                              const fs_bench_probe_t *probe, fs_bench_append_report_t *out);
+
+/**
+ * @brief Log an append report, one line per mode with its lines per second.
+ */
+void fs_bench_append_log(const fs_bench_append_report_t *report);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,220 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "fs_text_ops.h"
+
+#define FS_CSV_INDEX_STRIDE     64                  /* Records between two checkpoints */
+#define FS_CSV_MAX_FIELDS       32                  /* Fields kept per record; the rest are dropped */
+#define FS_CSV_MAX_RECORD       (2 * 1024)          /* Longest record read in one go; longer ones are cut */
+#define FS_CSV_SORT_MAX         256                 /* Rows kept by a sort (the first ones in order) */
+
+/**
+ * @brief One record read by fs_csv_read_records(), located in the caller's buffer.
+ */
+typedef struct {
+    uint32_t offset;            /**< File offset of the record */
+    uint16_t start;             /**< First byte in the buffer */
+    uint16_t len;               /**< Bytes in the buffer, newline excluded (cut records are shorter than in the file) */
+} fs_csv_record_t;
+
+/**
+ * @brief What a column job computes.
+ */
+typedef enum {
+    FS_CSV_COLUMN_STATS = 0,    /**< Count, min, max and mean of the numeric cells */
+    FS_CSV_COLUMN_SORT_ASC,     /**< The FS_CSV_SORT_MAX rows with the smallest numeric cells, in order */
+    FS_CSV_COLUMN_SORT_DESC,    /**< The FS_CSV_SORT_MAX rows with the largest numeric cells, in order */
+} fs_csv_column_op_t;
+
+/**
+ * @brief A row kept by a sort.
+ */
+typedef struct {
+    double key;                 /**< Numeric value of the sorted cell */
+    uint32_t offset;            /**< File offset of the record */
+    uint32_t row;               /**< Record number (0 is the header) */
+} fs_csv_sort_entry_t;
+
+/**
+ * @brief Result of a column job.
+ */
+typedef struct {
+    uint32_t rows;              /**< Data rows seen (the header excluded) */
+    uint32_t numeric;           /**< Rows whose cell parsed as a number */
+    double min;                 /**< Smallest numeric cell (valid if numeric > 0) */
+    double max;                 /**< Largest numeric cell (valid if numeric > 0) */
+    double sum;                 /**< Sum of the numeric cells */
+    fs_csv_sort_entry_t *sorted; /**< Sort jobs: the rows in order, owned by the caller (fs_csv_column_free()) */
+    uint32_t sorted_count;      /**< Entries in @c sorted */
+} fs_csv_column_result_t;
+
+/**
+ * @brief Check whether a file name/path uses a .csv extension (case-insensitive).
+ */
+bool fs_csv_is_csv(const char *name);
+
+/**
+ * @brief Guess the delimiter from the first record in @p buf: ',', ';' or tab, whichever is most frequent.
+ *
+ * Delimiters inside quotes do not count. Falls back to ','.
+ */
+char fs_csv_detect_delimiter(const char *buf, size_t len);
+
+/**
+ * @brief Find the newline that ends the current record, continuing a scan across buffers.
+ *
+ * Quotes toggle @p in_quotes ("" inside quotes toggles twice), and only a
+ * newline outside quotes ends a record.
+ *
+ * @param buf       Bytes to scan.
+ * @param len       Number of bytes.
+ * @param in_quotes Quote state at @p buf (false at a record start); updated to the state at the end of the scan.
+ * @param out_len   Receives the bytes up to and including the newline, or @p len if there is none.
+ *
+ * @return true if the record ends within @p buf.
+ */
+bool fs_csv_record_end(const char *buf, size_t len, bool *in_quotes, size_t *out_len);
+
+/**
+ * @brief Split a record in place into null-terminated, unquoted fields.
+ *
+ * Delimiters become terminators and quoted fields are unescaped in place, so
+ * @p rec must have room for one byte past @p len. A trailing '\r' is dropped.
+ *
+ * @param rec        Record bytes, without its newline.
+ * @param len        Number of bytes.
+ * @param delim      Field delimiter.
+ * @param out_starts Receives the offset of each field in @p rec.
+ * @param max        Capacity of @p out_starts; extra fields are dropped.
+ *
+ * @return Number of fields (at least 1).
+ */
+size_t fs_csv_split(char *rec, size_t len, char delim, uint16_t *out_starts, size_t max);
+
+/**
+ * @brief Offset of the record @p count records after the one starting at @p offset.
+ *
+ * @param out_offset Receives the offset (the file size if the file ends first).
+ *
+ * @return ESP_OK, ESP_ERR_NO_MEM, or the fs_text_reader_pread() error.
+ */
+esp_err_t fs_csv_skip_records(fs_text_reader_t *reader, size_t offset, uint32_t count, size_t *out_offset);
+
+/**
+ * @brief Read the whole records starting at @p offset that fit into @p buf, with one read.
+ *
+ * The first record always counts: if it is longer than @p cap - 1 bytes it is
+ * cut, and the scan goes on to its real end. One byte is left after each
+ * record so fs_csv_split() can terminate it in place.
+ *
+ * @param reader      Open reader.
+ * @param offset      Record start.
+ * @param buf         Receives the bytes.
+ * @param cap         Size of @p buf (2 to FS_CSV_MAX_RECORD + 1).
+ * @param out_records Receives the records found.
+ * @param max         Capacity of @p out_records.
+ * @param out_count   Receives the number of records (0 only at the end of the file).
+ * @param out_next    Receives the offset after the last record.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM, or the fs_text_reader_pread() error.
+ */
+esp_err_t fs_csv_read_records(fs_text_reader_t *reader, size_t offset, char *buf, size_t cap,
+                              fs_csv_record_t *out_records, size_t max, size_t *out_count, size_t *out_next);
+
+/**
+ * @brief Index the records of @p path on a background task.
+ *
+ * The offset of every FS_CSV_INDEX_STRIDE-th record is published as soon as
+ * the scan passes it, so fs_csv_index_row_offset() works on the rows seen so
+ * far while the rest of the file is still being read. Checkpoints live in
+ * fixed blocks that never move, PSRAM first. An index already running is
+ * stopped first.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on a bad path, ESP_ERR_NO_MEM if the task cannot be created.
+ */
+esp_err_t fs_csv_index_start(const char *path);
+
+/**
+ * @brief Progress of the background index without blocking.
+ *
+ * @param out_rows    Receives the records counted so far (all of them once finished).
+ * @param out_percent Optional; receives how much of the file was scanned (0-100).
+ *
+ * @return
+ *      - ESP_OK when the whole file is indexed
+ *      - ESP_ERR_NOT_FINISHED while the scan is running
+ *      - ESP_ERR_INVALID_STATE if no index was started
+ *      - ESP_ERR_NO_MEM or ESP_FAIL if the scan stopped early (the rows counted so far stay usable)
+ */
+esp_err_t fs_csv_index_poll(uint32_t *out_rows, uint8_t *out_percent);
+
+/**
+ * @brief Offset of record @p row: the nearest checkpoint, then at most FS_CSV_INDEX_STRIDE - 1 records skipped.
+ *
+ * Rows past the ones counted so far are reached from the last checkpoint.
+ *
+ * @param reader     Reader of the indexed file (the caller's, not the scan's).
+ * @param row        Record number, 0 being the first record of the file.
+ * @param out_offset Receives the offset.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE without an index, or the fs_csv_skip_records() error.
+ */
+esp_err_t fs_csv_index_row_offset(fs_text_reader_t *reader, uint32_t row, size_t *out_offset);
+
+/**
+ * @brief Cancel the index scan, wait for its task to exit and free the checkpoints.
+ *
+ * Safe to call when nothing is running.
+ */
+void fs_csv_index_stop(void);
+
+/**
+ * @brief Compute @p op over column @p column of @p path on a background task, streaming the file once.
+ *
+ * The first record is the header and is skipped. A cell is numeric when all
+ * of it (spaces aside) parses as a finite number; other cells are counted but
+ * take no part in the stats or the sort. A sort keeps the best FS_CSV_SORT_MAX
+ * rows in a bounded heap, so memory does not depend on the file size. A column
+ * job already running is cancelled first.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on a bad path or column, ESP_ERR_NO_MEM if the task cannot be created.
+ */
+esp_err_t fs_csv_column_start(const char *path, char delim, uint32_t column, fs_csv_column_op_t op);
+
+/**
+ * @brief Collect the result of fs_csv_column_start() without blocking.
+ *
+ * @param out         Receives the result on ESP_OK; free it with fs_csv_column_free().
+ * @param out_percent Optional; receives how much of the file was scanned (0-100).
+ *
+ * @return
+ *      - ESP_OK when the job is over
+ *      - ESP_ERR_NOT_FINISHED while it is running
+ *      - ESP_ERR_INVALID_STATE if no job was started
+ *      - ESP_ERR_NO_MEM or ESP_FAIL if the job failed (the job is over)
+ */
+esp_err_t fs_csv_column_poll(fs_csv_column_result_t *out, uint8_t *out_percent);
+
+/**
+ * @brief Cancel a column job and wait for its task to exit (one block of work at most).
+ *
+ * Safe to call when nothing is running.
+ */
+void fs_csv_column_stop(void);
+
+/**
+ * @brief Free the sorted rows of @p result and clear it.
+ */
+void fs_csv_column_free(fs_csv_column_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
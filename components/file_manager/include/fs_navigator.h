@@ -42,18 +42,21 @@ typedef struct fs_nav {
     fs_nav_sort_mode_t sort_mode;
     bool ascending;
     bool sort_enabled;
+    bool stateless;          /* do not load/store state in NVS */
 } fs_nav_t;
 
 typedef struct {
     const char *root_path;
     size_t max_items;
+    bool stateless;          /* browse without restoring or persisting the last location (scratch trees, benchmarks) */
 } fs_nav_config_t;
 
 /**
  * @brief Initialize a navigator rooted at @p cfg->root_path and load persisted state if present.
  *
  * Trims trailing slashes, validates root is an absolute directory, restores last relative path,
- * sort mode and direction from NVS (best effort), then performs an initial directory scan.
+ * sort mode and direction from NVS (best effort, skipped when @c cfg->stateless), then performs
+ * an initial directory scan.
  *
  * @param[out] nav Navigator instance to initialize.
  * @param[in]  cfg Configuration (root path and item cap).
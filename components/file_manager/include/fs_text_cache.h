@@ -0,0 +1,99 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define FS_TEXT_CACHE_SLOTS     8       /* Chunks kept in the ring (READ_CHUNK_SIZE_B each) */
+
+/**
+ * @brief Counters exposed for tuning the ring size.
+ */
+typedef struct {
+    uint32_t hits;              /**< Chunks served from memory */
+    uint32_t misses;            /**< Chunks read from the card on demand */
+    uint32_t prefetched;        /**< Chunks read ahead by the background task */
+} fs_text_cache_stats_t;
+
+/**
+ * @brief Start caching chunks of @p path and the background read-ahead task.
+ *
+ * The file stays open (one reader for on-demand reads, one for the task)
+ * until fs_text_cache_close(). Chunks cached for another file are dropped;
+ * reopening the same file keeps them.
+ *
+ * @param path Absolute path to a .txt file.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG on a bad path
+ *      - ESP_FAIL if the file cannot be opened
+ *      - ESP_ERR_NO_MEM if the ring or the task cannot be allocated
+ */
+esp_err_t fs_text_cache_open(const char *path);
+
+/**
+ * @brief Stop the read-ahead task, close the file and release the ring.
+ *
+ * Call before writing the file; fs_text_cache_open() afterwards starts over on the new contents.
+ */
+void fs_text_cache_close(void);
+
+/**
+ * @brief Pick up bytes appended to the file since fs_text_cache_open().
+ *
+ * A FAT handle keeps the size the file had when it was opened, so the
+ * readers are reopened; only the chunks that reached the old end are dropped.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if the cache is not open
+ *      - ESP_FAIL if the file cannot be reopened (the cache is closed then)
+ */
+esp_err_t fs_text_cache_refresh(void);
+
+/**
+ * @brief Copy the chunk at @p offset into @p buf, reading it from the card on a miss.
+ *
+ * The chunk has the same boundaries as fs_text_read_chunk(), so the two can
+ * be mixed. Files other than the one passed to fs_text_cache_open() are read
+ * directly.
+ *
+ * @param path    File to read.
+ * @param offset  Chunk boundary.
+ * @param buf     Receives the null-terminated chunk; at least READ_CHUNK_SIZE_B + 1 bytes.
+ * @param out_len Receives the chunk length.
+ *
+ * @return ESP_OK or the fs_text_read_chunk() error codes.
+ */
+esp_err_t fs_text_cache_read(const char *path, size_t offset, char *buf, size_t *out_len);
+
+/**
+ * @brief fs_text_chunk_before(), answered from memory when the read-ahead already resolved it.
+ */
+esp_err_t fs_text_cache_before(const char *path, size_t end, size_t *out_offset);
+
+/**
+ * @brief Ask the background task to read the chunks a scroll is about to need.
+ *
+ * Returns at once. Chunks that are already cached are not read again.
+ *
+ * @param next      Boundary of the chunk after the window (SIZE_MAX for none).
+ * @param prev_end  Window start whose preceding window should be read (SIZE_MAX for none).
+ */
+void fs_text_cache_prefetch(size_t next, size_t prev_end);
+
+/**
+ * @brief Copy the current counters into @p out.
+ */
+void fs_text_cache_get_stats(fs_text_cache_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
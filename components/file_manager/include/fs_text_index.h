@@ -0,0 +1,128 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define FS_TEXT_INDEX_STRIDE        64                  /* Lines between two checkpoints, to begin with */
+#define FS_TEXT_INDEX_MAX_POINTS    4096                /* Checkpoints kept at most (16 KB); the stride doubles beyond */
+#define FS_TEXT_INDEX_PERSIST_MIN   (256 * 1024)        /* Smaller files are indexed in RAM only */
+
+/**
+ * @brief Sparse line index of a text file: the byte offset of every @c stride-th line.
+ *
+ * The stride starts at FS_TEXT_INDEX_STRIDE and doubles whenever the file
+ * would need more than FS_TEXT_INDEX_MAX_POINTS checkpoints, so the index of
+ * a file of any length fits a fixed amount of RAM.
+ *
+ * Lines are counted from 0 here; a last line without a trailing newline counts.
+ */
+typedef struct {
+    uint32_t lines;             /**< Lines in the file */
+    uint32_t count;             /**< Checkpoints in @c offsets (at least 1 once built) */
+    uint32_t stride;            /**< Lines between two checkpoints */
+    uint32_t *offsets;          /**< offsets[k]: byte offset of line k * stride */
+    uint32_t size;              /**< File size the index was built for */
+    int64_t mtime;              /**< File modification time the index was built for */
+} fs_text_index_t;
+
+/**
+ * @brief Count the newlines in @p buf, one 32-bit word at a time.
+ *
+ * @param buf Bytes to scan (any alignment).
+ * @param len Number of bytes.
+ * @return Number of '\n' bytes.
+ */
+size_t fs_text_count_newlines(const char *buf, size_t len);
+
+/**
+ * @brief Load the index of @p path from its sidecar, or build it by scanning the file.
+ *
+ * The sidecar "<dir>/.<name>.idx" is used only if the size and modification
+ * time it records still match the file; otherwise the file is scanned and,
+ * from FS_TEXT_INDEX_PERSIST_MIN bytes on, the sidecar is rewritten.
+ *
+ * @param path   Absolute path to a .txt file.
+ * @param out    Receives the index; release it with fs_text_index_free().
+ * @param cancel Optional flag polled between blocks; the scan stops once it is set.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG on bad parameters or a file beyond 4 GB
+ *      - ESP_ERR_INVALID_STATE if @p cancel was set
+ *      - ESP_ERR_NO_MEM if the index or the scan buffer cannot be allocated
+ *      - ESP_FAIL on I/O errors
+ */
+esp_err_t fs_text_index_build(const char *path, fs_text_index_t *out, const volatile bool *cancel);
+
+/**
+ * @brief Start fs_text_index_build() for @p path on a background task.
+ *
+ * A build already running is cancelled first. Collect the result with
+ * fs_text_index_poll().
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on a bad path, ESP_ERR_NO_MEM if the task cannot be created.
+ */
+esp_err_t fs_text_index_start(const char *path);
+
+/**
+ * @brief Collect the result of fs_text_index_start() without blocking.
+ *
+ * @param out Receives the index on ESP_OK (the caller owns it from then on).
+ *
+ * @return
+ *      - ESP_OK when the index was handed over
+ *      - ESP_ERR_NOT_FINISHED while the build is still running
+ *      - ESP_ERR_INVALID_STATE if no build was started
+ *      - the fs_text_index_build() error otherwise
+ */
+esp_err_t fs_text_index_poll(fs_text_index_t *out);
+
+/**
+ * @brief Cancel a background build and wait for its task to exit (one block of work at most).
+ *
+ * Safe to call when nothing is running; a finished but uncollected index is released.
+ */
+void fs_text_index_stop(void);
+
+/**
+ * @brief Release the checkpoints of @p index and clear it.
+ */
+void fs_text_index_free(fs_text_index_t *index);
+
+/**
+ * @brief Delete the sidecar of @p path after the file was rewritten.
+ *
+ * FAT keeps modification times to 2 s, so a same-size save right after a
+ * build could otherwise leave a sidecar that still looks current.
+ */
+void fs_text_index_forget(const char *path);
+
+/**
+ * @brief Byte offset of 0-based @p line: one checkpoint lookup plus (usually) one read.
+ *
+ * @param path       File the index belongs to.
+ * @param index      Built index.
+ * @param line       Line number; clamped to the last line.
+ * @param out_offset Receives the offset of the first byte of the line.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on bad parameters, ESP_ERR_NO_MEM or ESP_FAIL on read errors.
+ */
+esp_err_t fs_text_index_line_offset(const char *path, const fs_text_index_t *index, uint32_t line, size_t *out_offset);
+
+/**
+ * @brief 0-based line holding byte @p offset (the inverse of fs_text_index_line_offset()).
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on bad parameters, ESP_ERR_NO_MEM or ESP_FAIL on read errors.
+ */
+esp_err_t fs_text_index_offset_line(const char *path, const fs_text_index_t *index, size_t offset, uint32_t *out_line);
+
+#ifdef __cplusplus
+}
+#endif
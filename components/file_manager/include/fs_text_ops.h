@@ -6,11 +6,30 @@ extern "C" {
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 
 #include "esp_err.h"
 
 #define READ_CHUNK_SIZE_B   (1 * 1024)
 #define FS_TEXT_MAX_PATH    512
+#define FS_TEXT_READER_BLOCK 512       /* Bytes a reader keeps around for small reads */
+
+/**
+ * @brief Open text file for repeated reads without reopening, seeking or allocating per read.
+ *
+ * Lives wherever the caller puts it (stack, context struct). Not thread-safe:
+ * give each task its own reader.
+ */
+typedef struct {
+    FILE *file;                        /**< Unbuffered stdio handle, NULL when closed */
+    size_t size;                       /**< File size when opened */
+    int64_t mtime;                     /**< Modification time when opened */
+    size_t pos;                        /**< Current position of @c file (saves redundant seeks) */
+    size_t block_offset;               /**< File offset of @c block, SIZE_MAX if empty */
+    size_t block_len;                  /**< Valid bytes in @c block */
+    char block[FS_TEXT_READER_BLOCK];  /**< Last small read, served again without I/O */
+} fs_text_reader_t;
 
 /**
  * @brief Check whether a file name/path uses a .txt extension (case-insensitive).
@@ -39,37 +58,116 @@ bool fs_text_is_txt(const char *name);
 esp_err_t fs_text_create(const char *path);
 
 /**
- * @brief Read a fixed-size block of text bytes from a file starting at a given offset.
+ * @brief Open @p path for reading and cache its size and modification time.
  *
- * This function reads a chunk of data (READ_CHUNK_SIZE_B bytes) from a file,
- * starting at an offset specified in kilobytes. It validates the file path,
- * ensures the offset does not exceed the file size, adjusts the read length
- * when near EOF, and allocates a null-terminated buffer for the output.
+ * The handle is read-only, so with CONFIG_FATFS_USE_FASTSEEK the cluster map
+ * is built once here and every later pread() seeks without walking the FAT.
+ *
+ * @param reader Reader to initialise.
+ * @param path   Absolute path to a .txt file.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if parameters are invalid or the path fails validation
+ *      - ESP_FAIL if the file cannot be opened
+ */
+esp_err_t fs_text_reader_open(fs_text_reader_t *reader, const char *path);
+
+/**
+ * @brief fs_text_reader_open() for any regular file, whatever its extension (the hex viewer).
+ *
+ * Only fs_text_reader_pread() makes sense on binary contents.
+ */
+esp_err_t fs_text_reader_open_binary(fs_text_reader_t *reader, const char *path);
+
+/**
+ * @brief Close the file of @p reader (safe on a closed reader).
+ */
+void fs_text_reader_close(fs_text_reader_t *reader);
+
+/**
+ * @brief Read up to @p len bytes at @p offset into @p buf.
+ *
+ * Reads shorter than FS_TEXT_READER_BLOCK go through the reader's block, so
+ * neighbouring small reads cost one card access.
+ *
+ * @param reader   Open reader.
+ * @param offset   File offset.
+ * @param buf      Destination (caller-provided, @p len bytes).
+ * @param len      Bytes wanted.
+ * @param out_read Receives the bytes read (short at EOF).
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on bad parameters, ESP_FAIL on I/O errors.
+ */
+esp_err_t fs_text_reader_pread(fs_text_reader_t *reader, size_t offset, void *buf, size_t len, size_t *out_read);
+
+/**
+ * @brief fs_text_read_chunk() into a caller buffer of READ_CHUNK_SIZE_B + 1 bytes, without allocating.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG or ESP_FAIL.
+ */
+esp_err_t fs_text_reader_chunk(fs_text_reader_t *reader, size_t offset, char *buf, size_t *out_len);
+
+/**
+ * @brief fs_text_chunk_align() on an open reader.
+ */
+esp_err_t fs_text_reader_chunk_align(fs_text_reader_t *reader, size_t offset, size_t *out_offset);
+
+/**
+ * @brief fs_text_chunk_before() on an open reader.
+ */
+esp_err_t fs_text_reader_chunk_before(fs_text_reader_t *reader, size_t end, size_t *out_offset);
+
+/**
+ * @brief Read one chunk of text starting at byte @p offset, ending on a line or character boundary.
+ *
+ * Reads up to READ_CHUNK_SIZE_B bytes. Unless the chunk reaches EOF, its end is
+ * pulled back to just after the last newline, provided that keeps at least half
+ * of the chunk; for longer lines it is pulled back to the last complete UTF-8
+ * sequence instead. Chunks read back to back from a boundary returned by
+ * fs_text_chunk_align() therefore never split a character, and split lines
+ * only when a line is longer than half a chunk.
  *
  * The caller takes ownership of the allocated buffer and must free it.
  *
- * @param[in]  path        Absolute file path to read from.
- * @param[in]  offset_kb   Offset in kilobytes from the start of the file.
- *                         The actual byte offset becomes `offset_kb * 1024`.
- * @param[out] out_buf     Pointer to a char* that will receive the allocated buffer.
- *                         Must not be NULL.
- * @param[out] out_len     Optional pointer to receive the number of bytes actually read.
- *                         Can be NULL.
+ * @param[in]  path     Absolute file path to read from.
+ * @param[in]  offset   Byte offset of the chunk; clamped to the file size.
+ * @param[out] out_buf  Receives the allocated, null-terminated chunk. Must not be NULL.
+ * @param[out] out_len  Optional; receives the chunk length in bytes.
  *
  * @return
- *      - ESP_OK                   On success.
+ *      - ESP_OK                   On success (a chunk at EOF is empty).
  *      - ESP_ERR_INVALID_ARG      If parameters are invalid or the path fails validation.
- *      - ESP_ERR_INVALID_SIZE     If the requested read size exceeds FS_TEXT_MAX_BYTES.
  *      - ESP_ERR_NO_MEM           If memory allocation fails.
  *      - ESP_FAIL                 If file operations (stat, fopen, fseek, fread) fail.
+ */
+esp_err_t fs_text_read_chunk(const char *path, size_t offset, char **out_buf, size_t *out_len);
+
+/**
+ * @brief Snap @p offset forward to a chunk boundary.
+ *
+ * Returns the first line start at or after @p offset if one lies within half a
+ * chunk, otherwise the first UTF-8 character start. Offset 0 and EOF are
+ * boundaries.
+ *
+ * @param[in]  path       Absolute file path.
+ * @param[in]  offset     Any byte offset (e.g. a slider position).
+ * @param[out] out_offset Receives the boundary.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on bad parameters, ESP_FAIL on I/O errors.
+ */
+esp_err_t fs_text_chunk_align(const char *path, size_t offset, size_t *out_offset);
+
+/**
+ * @brief Find the boundary where the chunk ending at @p end starts (for scrolling back).
  *
- * @note
- * - The output buffer is always null-terminated, even when reading binary data.
- * - If the offset lands beyond EOF, a zero-length read is performed.
- * - READ_CHUNK_SIZE_B defines the number of bytes to read per call.
- * - The function only works with regular files.
+ * @param[in]  path       Absolute file path.
+ * @param[in]  end        Chunk boundary to read back from.
+ * @param[out] out_offset Receives a boundary at most READ_CHUNK_SIZE_B bytes before @p end.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on bad parameters, ESP_FAIL on I/O errors.
  */
-esp_err_t fs_text_read_range(const char *path, size_t offset_kb, char **out_buf, size_t *out_len);
+esp_err_t fs_text_chunk_before(const char *path, size_t end, size_t *out_offset);
 
 /**
  * @brief Atomically replace (or create) a text file with the provided buffer.
@@ -87,6 +185,48 @@ esp_err_t fs_text_read_range(const char *path, size_t offset_kb, char **out_buf,
  */
 esp_err_t fs_text_write(const char *path, const char *data, size_t len);
 
+/**
+ * @brief Replace @p old_len bytes at @p offset of an existing file with @p data, in place.
+ *
+ * Only the replaced range is written when the length is unchanged; otherwise
+ * the tail after the range is shifted by the difference in blocks, so the cost
+ * scales with the edit (plus the tail for inserts/deletes), not the file size.
+ *
+ * The operation is journaled in "<dir>/patchjnl.tmp": the replacement data and
+ * each tail block are fsync'd to the journal before the file is touched, so an
+ * interrupted patch is rolled forward by fs_text_recover() on the next access.
+ *
+ * @param path     Absolute path to an existing .txt file.
+ * @param offset   First byte of the replaced range.
+ * @param old_len  Bytes replaced in the file (offset + old_len must not exceed the size).
+ * @param data     Replacement bytes (can be NULL if @p new_len == 0).
+ * @param new_len  Number of replacement bytes.
+ *
+ * @retval ESP_OK               File patched and journal removed.
+ * @retval ESP_ERR_INVALID_ARG  Invalid path, range past EOF or missing data.
+ * @retval ESP_ERR_INVALID_SIZE Journal path too long or file beyond 4 GB.
+ * @retval ESP_ERR_NO_MEM       Shift buffer could not be allocated.
+ * @retval ESP_FAIL             I/O error; the journal is kept for recovery.
+ */
+esp_err_t fs_text_patch(const char *path, size_t offset, size_t old_len, const char *data, size_t new_len);
+
+/**
+ * @brief Finish an fs_text_patch() interrupted by power loss or card removal.
+ *
+ * Looks for the patch journal in the directory of @p path and, if it holds a
+ * complete record, replays the remaining steps on the file it names; a torn
+ * record means the file was never touched and is simply discarded. Cheap when
+ * no journal exists (one failed fopen()).
+ *
+ * @param path Any path inside the directory to check (typically the file about to be opened).
+ *
+ * @retval ESP_OK               No journal, or the pending patch was completed.
+ * @retval ESP_ERR_INVALID_ARG  @p path is NULL or its directory is too long.
+ * @retval ESP_ERR_NO_MEM       Recovery buffers could not be allocated.
+ * @retval ESP_FAIL             Replay failed; the journal is kept for another attempt.
+ */
+esp_err_t fs_text_recover(const char *path);
+
 /**
  * @brief Append binary/text data to an existing file (or create if missing).
  *
@@ -103,6 +243,9 @@ esp_err_t fs_text_write(const char *path, const char *data, size_t len);
  *
  * @note The file is opened in binary mode ("ab" or "wb"), suitable for both
  *       text and raw data. Data is flushed and file closed before returning.
+ * @note Every call pays for an open, a walk to the end of the file and a
+ *       directory update; for frequent small records use an fs_append_t
+ *       stream (fs_append.h) instead.
  * @warning If insufficient storage is available, partial writes may occur
  *          before failure is detected.
  */
@@ -0,0 +1,146 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "fs_text_ops.h"
+
+#define FS_TEXT_SEARCH_MAX_PATTERN  64                  /* Longest pattern (and replacement) in bytes */
+#define FS_TEXT_SEARCH_BLOCK        (16 * 1024)         /* Bytes read from the card per step */
+
+/**
+ * @brief Find @p pattern in the bytes of @p reader with Boyer-Moore-Horspool, one block at a time.
+ *
+ * Only matches that start in [@p start, @p end) count; a match may run past
+ * @p end and straddle any number of block edges. The comparison is exact
+ * (case-sensitive bytes).
+ *
+ * @param reader     Open reader.
+ * @param pattern    Null-terminated pattern, 1 to FS_TEXT_SEARCH_MAX_PATTERN bytes.
+ * @param start      First offset a match may start at.
+ * @param end        Offset past the last one (clamped to the file size).
+ * @param forward    true for the first match in the range, false for the last.
+ * @param out_offset Receives the offset of the match.
+ * @param cancel     Optional flag polled between blocks; the scan stops once it is set.
+ * @param scanned    Optional counter increased by the bytes read, for progress.
+ *
+ * @return
+ *      - ESP_OK when a match was found
+ *      - ESP_ERR_NOT_FOUND if there is none in the range
+ *      - ESP_ERR_INVALID_ARG on bad parameters
+ *      - ESP_ERR_INVALID_STATE if @p cancel was set
+ *      - ESP_ERR_NO_MEM if the block buffer cannot be allocated
+ *      - ESP_FAIL on I/O errors
+ */
+esp_err_t fs_text_search_find(fs_text_reader_t *reader, const char *pattern, size_t start, size_t end,
+                              bool forward, size_t *out_offset, const volatile bool *cancel,
+                              volatile size_t *scanned);
+
+/**
+ * @brief fs_text_search_find() for a byte pattern of @p len bytes, which may hold zeros.
+ */
+esp_err_t fs_text_search_find_bytes(fs_text_reader_t *reader, const void *pattern, size_t len, size_t start,
+                                    size_t end, bool forward, size_t *out_offset,
+                                    const volatile bool *cancel, volatile size_t *scanned);
+
+/**
+ * @brief Replace every match of @p pattern in @p path, streaming the file through a temp copy.
+ *
+ * The file is copied block by block into "<dir>/.<name>.rpl" with the matches
+ * replaced, then the copy is renamed over @p path. Memory use is one
+ * FS_TEXT_SEARCH_BLOCK plus the pattern length, whatever the file size.
+ * Matches are replaced left to right and do not overlap. Without a match the
+ * file is left untouched.
+ *
+ * @param path        Absolute path to a .txt file.
+ * @param pattern     Null-terminated pattern, 1 to FS_TEXT_SEARCH_MAX_PATTERN bytes.
+ * @param replacement Null-terminated replacement, up to FS_TEXT_SEARCH_MAX_PATTERN bytes (may be empty).
+ * @param out_count   Receives the number of replacements; kept current while the copy runs.
+ * @param cancel      Optional flag polled between blocks; the copy is dropped once it is set.
+ * @param scanned     Optional counter increased by the bytes read, for progress.
+ *
+ * @return
+ *      - ESP_OK on success (also when nothing matched)
+ *      - ESP_ERR_INVALID_ARG on bad parameters
+ *      - ESP_ERR_INVALID_SIZE if the temp path does not fit
+ *      - ESP_ERR_INVALID_STATE if @p cancel was set (the file is unchanged)
+ *      - ESP_ERR_NO_MEM if the block buffer cannot be allocated
+ *      - ESP_FAIL on I/O errors (the file is unchanged unless the final rename failed half-way)
+ */
+esp_err_t fs_text_replace_all(const char *path, const char *pattern, const char *replacement,
+                              volatile size_t *out_count, const volatile bool *cancel,
+                              volatile size_t *scanned);
+
+/**
+ * @brief Search @p path for @p pattern on a background task, wrapping around the file.
+ *
+ * Forward, the first match at or after @p from wins, then the first one before
+ * it. Backward, the last match before @p from wins, then the last one from
+ * @p from on. A search already running is cancelled first. Collect the result
+ * with fs_text_search_poll().
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on a bad path or pattern, ESP_ERR_NO_MEM if the task cannot be created.
+ */
+esp_err_t fs_text_search_start(const char *path, const char *pattern, size_t from, bool forward);
+
+/**
+ * @brief fs_text_search_start() for @p len bytes of @p pattern in any regular file (the hex viewer).
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on a bad path or pattern, ESP_ERR_NO_MEM if the task cannot be created.
+ */
+esp_err_t fs_text_search_start_bytes(const char *path, const void *pattern, size_t len, size_t from, bool forward);
+
+/**
+ * @brief Collect the result of fs_text_search_start() without blocking.
+ *
+ * @param out_offset  Receives the offset of the match on ESP_OK.
+ * @param out_percent Optional; receives how much of the file was scanned (0-100).
+ *
+ * @return
+ *      - ESP_OK when a match was found (the search is over)
+ *      - ESP_ERR_NOT_FINISHED while the search is still running
+ *      - ESP_ERR_INVALID_STATE if no search was started
+ *      - the fs_text_search_find() error otherwise (the search is over)
+ */
+esp_err_t fs_text_search_poll(size_t *out_offset, uint8_t *out_percent);
+
+/**
+ * @brief Run fs_text_replace_all() on the background task used by searches.
+ *
+ * A search or replace already running is cancelled first. Nothing else may
+ * hold @p path open until fs_text_replace_poll() reports the end.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on a bad path, pattern or replacement, ESP_ERR_NO_MEM if the task cannot be created.
+ */
+esp_err_t fs_text_replace_start(const char *path, const char *pattern, const char *replacement);
+
+/**
+ * @brief Collect the result of fs_text_replace_start() without blocking.
+ *
+ * @param out_count   Receives the replacements made so far (the total once finished).
+ * @param out_percent Optional; receives how much of the file was copied (0-100).
+ *
+ * @return
+ *      - ESP_OK when the replace is over
+ *      - ESP_ERR_NOT_FINISHED while it is still running
+ *      - ESP_ERR_INVALID_STATE if no replace was started
+ *      - the fs_text_replace_all() error otherwise
+ */
+esp_err_t fs_text_replace_poll(size_t *out_count, uint8_t *out_percent);
+
+/**
+ * @brief Cancel a background search or replace and wait for its task to exit (one block of work at most).
+ *
+ * Safe to call when nothing is running. A cancelled replace leaves the file unchanged.
+ */
+void fs_text_search_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define FS_TREE_COPY_BLOCK      (4 * 1024)      /* Bytes moved per fread()/fwrite() when copying a file */
+
+/**
+ * @brief Delete a file or a whole directory tree.
+ *
+ * Directories are emptied depth-first with opendir()/readdir(), then removed.
+ * Only POSIX calls are used, so this works on any mounted VFS root (the SD
+ * card, a FAT image, a host directory).
+ *
+ * @param path Path to delete.
+ *
+ * @return
+ *      - ESP_OK on success, also when @p path does not exist
+ *      - ESP_ERR_INVALID_ARG for an empty path
+ *      - ESP_ERR_INVALID_SIZE if a child path would not fit FS_NAV_MAX_PATH
+ *      - ESP_FAIL on other filesystem errors
+ */
+esp_err_t fs_tree_delete(const char *path);
+
+/**
+ * @brief Add the size of a file, or of every file below a directory, to @p bytes.
+ *
+ * @param path  File or directory.
+ * @param bytes In/out accumulator; increased by the size found.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_SIZE on a too long child path, or ESP_FAIL.
+ */
+esp_err_t fs_tree_total_size(const char *path, uint64_t *bytes);
+
+/**
+ * @brief Copy a file or a directory tree to @p dest.
+ *
+ * Files are copied in FS_TREE_COPY_BLOCK chunks and overwrite @p dest;
+ * directories are created, so @p dest must not exist. A failed copy removes
+ * what it wrote.
+ *
+ * @param src  Source file or directory.
+ * @param dest Destination path.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_SIZE on a too long child path, or ESP_FAIL.
+ */
+esp_err_t fs_tree_copy(const char *src, const char *dest);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+/**
+ * @brief Options describing how to open the hex viewer.
+ */
+typedef struct {
+    const char *path;                 /**< Absolute path to an existing file. */
+    lv_obj_t *return_screen;          /**< Screen to restore when the viewer closes. */
+} hex_viewer_open_opts_t;
+
+/**
+ * @brief Load the hex viewer screen for any file, read-only.
+ *
+ * Rows of offset, hex bytes and ASCII are drawn straight from a small block
+ * cache (a few KB), and only the rows on screen are fetched, so memory use
+ * does not depend on the file size. Dragging scrolls by pixels, the slider
+ * jumps anywhere in the file, "Offset" goes to a hex offset and "Find"
+ * searches for hex bytes or "quoted text" on a background task (see
+ * fs_text_search_start_bytes()).
+ *
+ * @param[in] opts Options:
+ *   - @c path: full path to the file
+ *   - @c return_screen (required): screen to return to on close
+ *
+ * @return
+ *   - ESP_OK on success
+ *   - ESP_ERR_INVALID_ARG if required options are missing or the path is too long
+ *   - ESP_ERR_NO_MEM if the block cache cannot be allocated
+ *   - ESP_FAIL if the file cannot be opened
+ */
+esp_err_t hex_viewer_open(const hex_viewer_open_opts_t *opts);
+
+#ifdef __cplusplus
+}
+#endif
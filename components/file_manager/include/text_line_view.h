@@ -0,0 +1,100 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+/**
+ * @brief Create a read-only text view that draws only the rows on screen.
+ *
+ * The text is kept as a copy plus an array of line start offsets. A line is
+ * wrapped the first time it is scrolled into view and its wrap points are
+ * cached until the width or font changes, so setting or appending text costs
+ * one newline scan and scrolling lays out at most the lines coming into view.
+ * Dragging scrolls by pixels (with a fling on release); the object itself is
+ * not scrollable and sends LV_EVENT_SCROLL whenever the position changes.
+ *
+ * Style it like any object: background, border, padding, text font, color,
+ * letter and line space are honoured.
+ *
+ * @param parent Parent object.
+ *
+ * @return The new object, or NULL if out of memory.
+ */
+lv_obj_t *text_line_view_create(lv_obj_t *parent);
+
+/**
+ * @brief Replace the text with a copy of @p len bytes of @p text and scroll to the top.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM (the old text is kept).
+ */
+esp_err_t text_line_view_set_text(lv_obj_t *view, const char *text, size_t len);
+
+/**
+ * @brief Append @p len bytes of @p text; lines already laid out keep their wraps and the position is kept.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM (the text is unchanged).
+ */
+esp_err_t text_line_view_append(lv_obj_t *view, const char *text, size_t len);
+
+/**
+ * @brief Drop the first @p len bytes, which must end right after a newline (or be the whole text).
+ *
+ * The remaining lines keep their wraps and the rows on screen stay put unless
+ * they were dropped, in which case the view goes to the top.
+ *
+ * @return ESP_OK or ESP_ERR_INVALID_ARG if @p len is not on a line start.
+ */
+esp_err_t text_line_view_drop_front(lv_obj_t *view, size_t len);
+
+/**
+ * @brief Current text (null-terminated, owned by the view; valid until the next change).
+ *
+ * @param out_len Optional; receives the length in bytes.
+ */
+const char *text_line_view_get_text(lv_obj_t *view, size_t *out_len);
+
+/**
+ * @brief Byte offset of the first character on the row at the top of the view.
+ */
+size_t text_line_view_get_top(lv_obj_t *view);
+
+/**
+ * @brief Put the row holding byte @p pos at the top (as far as the end of the text allows).
+ */
+void text_line_view_scroll_to(lv_obj_t *view, size_t pos);
+
+/**
+ * @brief Scroll so the last row sits at the bottom of the view.
+ */
+void text_line_view_scroll_to_end(lv_obj_t *view);
+
+/**
+ * @brief Pixels scrolled out above the view (exact near the top, estimated for lines never shown).
+ */
+int32_t text_line_view_get_scroll_top(lv_obj_t *view);
+
+/**
+ * @brief Pixels left below the view (exact near the bottom, estimated for lines never shown).
+ */
+int32_t text_line_view_get_scroll_bottom(lv_obj_t *view);
+
+/**
+ * @brief Y of the row holding byte @p pos, relative to the top of the content area.
+ *
+ * @param out_y Receives the position (negative when the row is scrolled out above).
+ *
+ * @return true if the row starts above the bottom of the view, false if it is further down.
+ */
+bool text_line_view_get_row_y(lv_obj_t *view, size_t pos, int32_t *out_y);
+
+#ifdef __cplusplus
+}
+#endif
@@ -33,7 +33,12 @@ typedef struct {
  *
  * Reads the file at @p opts->path, builds the screen (on first use),
  * sets edit/view mode, populates the text area and status, and loads
- * the screen. Original content is snapshotted to support dirty tracking.
+ * the screen. Edits are tracked against the loaded text for dirty tracking.
+ * Existing files are line-indexed in the background (see fs_text_index_start())
+ * to number the visible lines and to jump to any line of a huge file. Find
+ * searches the whole file on a background task (see fs_text_search_start()).
+ * In view mode, Follow tails a growing file: lines appended by another
+ * writer are added to the view as they land.
  *
  * @param[in] opts Options:
  *   - @c path: full path to the text file to view/edit (omit or empty for new files)
@@ -47,7 +52,7 @@ typedef struct {
  * @return
  *   - ESP_OK on success
  *   - ESP_ERR_INVALID_ARG if required options are missing
- *   - fs_text_read_range error codes if reading fails
+ *   - fs_text_read_chunk error codes if reading fails
  */
 esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts);
 
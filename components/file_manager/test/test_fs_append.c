@@ -0,0 +1,167 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "unity.h"
+#include "sdkconfig.h"
+#include "fs_append.h"
+#include "sd_card.h"
+
+#define TEST_LOG_PATH       CONFIG_SDSPI_MOUNT_POINT "/fs_append_test.log"
+#define TEST_RESERVE        512
+
+/**
+ * @brief Mount the card once, or skip the test when there is none.
+ */
+static void test_mount(void)
+{
+    static bool s_mounted;
+    if (!s_mounted) {
+        s_mounted = (init_sdspi() == ESP_OK);
+    }
+    if (!s_mounted) {
+        TEST_IGNORE_MESSAGE("No SD card mounted at " CONFIG_SDSPI_MOUNT_POINT);
+    }
+}
+
+/**
+ * @brief Replace the test log with @p len bytes of @p data followed by @p zeros zero bytes.
+ */
+static void test_write_raw(const char *data, size_t len, size_t zeros)
+{
+    static const char s_zeros[TEST_RESERVE];
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(s_zeros), zeros);
+
+    int fd = open(TEST_LOG_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0664);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    TEST_ASSERT_EQUAL(len, write(fd, data, len));
+    TEST_ASSERT_EQUAL(zeros, write(fd, s_zeros, zeros));
+    TEST_ASSERT_EQUAL(0, fsync(fd));
+    TEST_ASSERT_EQUAL(0, close(fd));
+}
+
+/**
+ * @brief Check that the test log holds exactly @p expected.
+ */
+static void test_expect_file(const char *expected)
+{
+    char buf[128];
+    FILE *f = fopen(TEST_LOG_PATH, "rb");
+    TEST_ASSERT_NOT_NULL(f);
+    size_t n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    TEST_ASSERT_EQUAL(strlen(expected), n);
+    TEST_ASSERT_EQUAL_MEMORY(expected, buf, n);
+}
+
+TEST_CASE("fs_append drops a record torn over the reserve", "[fs_append]")
+{
+    test_mount();
+
+    /* What a power loss in the middle of an in-place flush leaves behind */
+    static const char torn[] = "one\ntwo\nthr";
+    test_write_raw(torn, sizeof(torn) - 1, TEST_RESERVE);
+
+    fs_append_config_t config = { .prealloc = TEST_RESERVE };
+    fs_append_t stream;
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_open(&stream, TEST_LOG_PATH, &config));
+    TEST_ASSERT_EQUAL(8, stream.data_end);
+    TEST_ASSERT_EQUAL(8, stream.alloc_end);
+    test_expect_file("one\ntwo\n");
+
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_write(&stream, "four\n", 5));
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_close(&stream));
+    test_expect_file("one\ntwo\nfour\n");
+    unlink(TEST_LOG_PATH);
+}
+
+TEST_CASE("fs_append keeps complete records before the reserve", "[fs_append]")
+{
+    test_mount();
+
+    static const char whole[] = "one\ntwo\n";
+    test_write_raw(whole, sizeof(whole) - 1, TEST_RESERVE);
+
+    fs_append_config_t config = { .prealloc = TEST_RESERVE };
+    fs_append_t stream;
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_open(&stream, TEST_LOG_PATH, &config));
+    TEST_ASSERT_EQUAL(8, stream.data_end);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, fs_append_write(&stream, "three", 5));
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_write(&stream, "three\n", 6));
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_close(&stream));
+    test_expect_file("one\ntwo\nthree\n");
+    unlink(TEST_LOG_PATH);
+}
+
+TEST_CASE("fs_append leaves a cleanly closed file alone", "[fs_append]")
+{
+    test_mount();
+
+    /* No trailing zeros: the last line is kept even without its newline */
+    static const char closed[] = "one\ntwo";
+    test_write_raw(closed, sizeof(closed) - 1, 0);
+
+    fs_append_config_t config = { .prealloc = TEST_RESERVE };
+    fs_append_t stream;
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_open(&stream, TEST_LOG_PATH, &config));
+    TEST_ASSERT_EQUAL(7, stream.data_end);
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_close(&stream));
+    test_expect_file("one\ntwo");
+    unlink(TEST_LOG_PATH);
+}
+
+TEST_CASE("fs_append keeps a zero after records that fill the reserve", "[fs_append]")
+{
+    test_mount();
+    unlink(TEST_LOG_PATH);
+
+    /* The second record ends exactly where the first flush's reserve ended */
+    static const char record[] = "0123456789abcde\n";
+    const size_t len = sizeof(record) - 1;
+    fs_append_config_t config = { .prealloc = len };
+    fs_append_t stream;
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_open(&stream, TEST_LOG_PATH, &config));
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_write(&stream, record, len));
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_flush(&stream));
+    TEST_ASSERT_EQUAL(2 * len, stream.alloc_end);
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_write(&stream, record, len));
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_flush(&stream));
+    TEST_ASSERT_EQUAL(2 * len, stream.data_end);
+    TEST_ASSERT_GREATER_THAN(stream.data_end, stream.alloc_end);
+
+    /* A flush torn at this point must still leave zeros for fs_append_open() to find */
+    struct stat st;
+    char after = 'x';
+    int fd = open(TEST_LOG_PATH, O_RDONLY);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    TEST_ASSERT_EQUAL(0, fstat(fd, &st));
+    TEST_ASSERT_EQUAL(stream.alloc_end, st.st_size);
+    TEST_ASSERT_EQUAL(stream.data_end, lseek(fd, (off_t)stream.data_end, SEEK_SET));
+    TEST_ASSERT_EQUAL(1, read(fd, &after, 1));
+    TEST_ASSERT_EQUAL(0, after);
+    close(fd);
+
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_close(&stream));
+    test_expect_file("0123456789abcde\n0123456789abcde\n");
+    unlink(TEST_LOG_PATH);
+}
+
+TEST_CASE("fs_append drops a torn record that stops one byte short of the end", "[fs_append]")
+{
+    test_mount();
+
+    /* The furthest a torn flush can reach: the last byte of the reserve is never written */
+    static const char torn[] = "one\ntwo\nthr";
+    test_write_raw(torn, sizeof(torn) - 1, 1);
+
+    fs_append_config_t config = { .prealloc = TEST_RESERVE };
+    fs_append_t stream;
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_open(&stream, TEST_LOG_PATH, &config));
+    TEST_ASSERT_EQUAL(8, stream.data_end);
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_write(&stream, "four\n", 5));
+    TEST_ASSERT_EQUAL(ESP_OK, fs_append_close(&stream));
+    test_expect_file("one\ntwo\nfour\n");
+    unlink(TEST_LOG_PATH);
+}
@@ -0,0 +1,837 @@
+#include "text_line_view.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+
+#define TEXT_LINE_VIEW_THROW_PERIOD_MS  20
+#define TEXT_LINE_VIEW_THROW_DECAY      10          /* Percent of the fling speed lost per period */
+#define TEXT_LINE_VIEW_NO_WRAP          (INT32_MAX / 2)
+
+/**
+ * @brief One logical line of the text and its cached wrap.
+ */
+typedef struct
+{
+    uint32_t start;                             /**< Offset of the line in the text */
+    uint32_t brk;                               /**< First wrap point of the line in the break pool */
+    uint32_t rows;                              /**< Rows once laid out, 0 until then */
+} text_line_view_line_t;
+
+/**
+ * @brief State kept behind the user data of a line view object.
+ */
+typedef struct
+{
+    lv_obj_t *obj;                              /**< The view object */
+    char *text;                                 /**< Null-terminated copy of the text */
+    size_t len;                                 /**< Bytes in @c text */
+    size_t cap;                                 /**< Bytes allocated for @c text (without the terminator) */
+    text_line_view_line_t *lines;               /**< Line starts, always at least one */
+    size_t line_count;
+    size_t line_cap;
+    uint32_t *breaks;                           /**< Wrap points (offsets inside their line), rows - 1 per laid-out line */
+    size_t break_count;                         /**< Entries used in @c breaks, including those of dropped lines */
+    size_t break_cap;
+    size_t break_live;                          /**< Entries still owned by a line */
+    const lv_font_t *font;                      /**< Font the wraps were computed with */
+    int32_t letter_space;
+    int32_t width;                              /**< Content width the wraps were computed for */
+    int32_t row_h;                              /**< Font line height plus line space */
+    int32_t avg_w;                              /**< Typical glyph width, for estimating lines never laid out */
+    size_t top_line;                            /**< Line holding the top row */
+    int32_t top_px;                             /**< Pixels of @c top_line scrolled out above the view */
+    int32_t throw_v;                            /**< Fling speed in pixels per period */
+    lv_timer_t *throw_timer;                    /**< Timer carrying the fling after release */
+} text_line_view_t;
+
+static const char *TAG = "text_line_view";
+
+/*************************************** Text & lines ****************************************/
+
+/**
+ * @brief Add the lines starting after each newline in text[@p from, len).
+ *
+ * @return ESP_OK or ESP_ERR_NO_MEM (lines found so far are kept).
+ */
+static esp_err_t text_line_view_scan(text_line_view_t *tlv, size_t from);
+
+/**
+ * @brief Bytes shown for line @p i (without its newline or a carriage return before it).
+ */
+static size_t text_line_view_line_len(const text_line_view_t *tlv, size_t i);
+
+/**
+ * @brief Forget the wrap of line @p i.
+ */
+static void text_line_view_unwrap(text_line_view_t *tlv, size_t i);
+
+/**
+ * @brief Forget every wrap and empty the break pool.
+ */
+static void text_line_view_unwrap_all(text_line_view_t *tlv);
+
+/**
+ * @brief Pick up font, spacing and width from the object; drop the wraps if any changed.
+ */
+static void text_line_view_sync(text_line_view_t *tlv);
+
+/**
+ * @brief Rows of line @p i, wrapping it first if needed.
+ */
+static uint32_t text_line_view_rows(text_line_view_t *tlv, size_t i);
+
+/**
+ * @brief Rows of line @p i if laid out, otherwise an estimate from its length.
+ */
+static uint32_t text_line_view_rows_estimate(const text_line_view_t *tlv, size_t i);
+
+/**
+ * @brief Offset inside line @p i where row @p row starts (row must be below text_line_view_rows()).
+ */
+static size_t text_line_view_row_start(const text_line_view_t *tlv, size_t i, uint32_t row);
+
+/**
+ * @brief Line holding byte @p pos.
+ */
+static size_t text_line_view_find_line(const text_line_view_t *tlv, size_t pos);
+
+/**
+ * @brief Row of line @p i holding byte @p pos.
+ */
+static uint32_t text_line_view_find_row(text_line_view_t *tlv, size_t i, size_t pos);
+
+/*********************************************************************************************/
+
+/***************************************** Scrolling *****************************************/
+
+/**
+ * @brief Move the top of the view by @p dy pixels (positive shows later rows), bounded by the text.
+ *
+ * Sends LV_EVENT_SCROLL and redraws if the position changed.
+ */
+static void text_line_view_scroll_by(text_line_view_t *tlv, int32_t dy);
+
+/**
+ * @brief Set the top to (@p line, @p px), bounded by the text, and notify as text_line_view_scroll_by() does.
+ */
+static void text_line_view_set_top(text_line_view_t *tlv, size_t line, int32_t px);
+
+/**
+ * @brief Normalise the top so @c top_px lies inside @c top_line and no blank space shows below the text.
+ */
+static void text_line_view_clamp(text_line_view_t *tlv);
+
+/**
+ * @brief Draw the rows inside the clip area.
+ *
+ * @param e LVGL event (LV_EVENT_DRAW_MAIN).
+ */
+static void text_line_view_on_draw(lv_event_t *e);
+
+/**
+ * @brief Drag-to-scroll, fling, resize, restyle and delete handling.
+ *
+ * @param e LVGL event.
+ */
+static void text_line_view_on_event(lv_event_t *e);
+
+/**
+ * @brief Carry on a fling after release, slowing down every period.
+ *
+ * @param timer LVGL timer (user data: view state).
+ */
+static void text_line_view_on_throw_timer(lv_timer_t *timer);
+
+/**
+ * @brief Stop a fling in progress.
+ */
+static void text_line_view_stop_throw(text_line_view_t *tlv);
+
+/*********************************************************************************************/
+
+lv_obj_t *text_line_view_create(lv_obj_t *parent)
+{
+    text_line_view_t *tlv = calloc(1, sizeof(*tlv));
+    char *text = malloc(1);
+    text_line_view_line_t *lines = malloc(sizeof(*lines));
+    if (!tlv || !text || !lines)
+    {
+        free(tlv);
+        free(text);
+        free(lines);
+        return NULL;
+    }
+    text[0] = '\0';
+    lines[0] = (text_line_view_line_t){0};
+    tlv->text = text;
+    tlv->lines = lines;
+    tlv->line_count = 1;
+    tlv->line_cap = 1;
+
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_user_data(obj, tlv);
+    tlv->obj = obj;
+    lv_obj_add_event_cb(obj, text_line_view_on_draw, LV_EVENT_DRAW_MAIN, tlv);
+    lv_obj_add_event_cb(obj, text_line_view_on_event, LV_EVENT_PRESSED, tlv);
+    lv_obj_add_event_cb(obj, text_line_view_on_event, LV_EVENT_PRESSING, tlv);
+    lv_obj_add_event_cb(obj, text_line_view_on_event, LV_EVENT_RELEASED, tlv);
+    lv_obj_add_event_cb(obj, text_line_view_on_event, LV_EVENT_SIZE_CHANGED, tlv);
+    lv_obj_add_event_cb(obj, text_line_view_on_event, LV_EVENT_STYLE_CHANGED, tlv);
+    lv_obj_add_event_cb(obj, text_line_view_on_event, LV_EVENT_DELETE, tlv);
+    return obj;
+}
+
+esp_err_t text_line_view_set_text(lv_obj_t *view, const char *text, size_t len)
+{
+    text_line_view_t *tlv = view ? lv_obj_get_user_data(view) : NULL;
+    if (!tlv || (!text && len > 0) || len >= UINT32_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (len > tlv->cap)
+    {
+        char *buf = malloc(len + 1);
+        if (!buf)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        free(tlv->text);
+        tlv->text = buf;
+        tlv->cap = len;
+    }
+    if (len > 0)
+    {
+        memcpy(tlv->text, text, len);
+    }
+    tlv->text[len] = '\0';
+    tlv->len = len;
+
+    tlv->line_count = 1;
+    tlv->lines[0] = (text_line_view_line_t){0};
+    text_line_view_unwrap_all(tlv);
+    tlv->top_line = 0;
+    tlv->top_px = 0;
+    text_line_view_stop_throw(tlv);
+    esp_err_t err = text_line_view_scan(tlv, 0);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Only %u lines indexed", (unsigned)tlv->line_count);
+    }
+    lv_obj_invalidate(view);
+    return ESP_OK;
+}
+
+esp_err_t text_line_view_append(lv_obj_t *view, const char *text, size_t len)
+{
+    text_line_view_t *tlv = view ? lv_obj_get_user_data(view) : NULL;
+    if (!tlv || (!text && len > 0) || tlv->len + len >= UINT32_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len == 0)
+    {
+        return ESP_OK;
+    }
+
+    if (tlv->len + len > tlv->cap)
+    {
+        size_t cap = tlv->cap ? tlv->cap : 64;
+        while (cap < tlv->len + len)
+        {
+            cap *= 2;
+        }
+        char *buf = realloc(tlv->text, cap + 1);
+        if (!buf)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        tlv->text = buf;
+        tlv->cap = cap;
+    }
+    size_t from = tlv->len;
+    memcpy(tlv->text + from, text, len);
+    tlv->len += len;
+    tlv->text[tlv->len] = '\0';
+
+    /* Only the last line grows: every other line keeps its wrap */
+    text_line_view_unwrap(tlv, tlv->line_count - 1);
+    if (text_line_view_scan(tlv, from) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Only %u lines indexed", (unsigned)tlv->line_count);
+    }
+    lv_obj_invalidate(view);
+    return ESP_OK;
+}
+
+esp_err_t text_line_view_drop_front(lv_obj_t *view, size_t len)
+{
+    text_line_view_t *tlv = view ? lv_obj_get_user_data(view) : NULL;
+    if (!tlv || len > tlv->len)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len == 0)
+    {
+        return ESP_OK;
+    }
+    if (len == tlv->len)
+    {
+        return text_line_view_set_text(view, "", 0);
+    }
+
+    size_t first = text_line_view_find_line(tlv, len);
+    if (tlv->lines[first].start != len)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < first; i++)
+    {
+        text_line_view_unwrap(tlv, i);
+    }
+    memmove(tlv->text, tlv->text + len, tlv->len - len + 1);
+    tlv->len -= len;
+    tlv->line_count -= first;
+    memmove(tlv->lines, tlv->lines + first, tlv->line_count * sizeof(*tlv->lines));
+    for (size_t i = 0; i < tlv->line_count; i++)
+    {
+        tlv->lines[i].start -= (uint32_t)len;
+    }
+
+    if (tlv->top_line >= first)
+    {
+        tlv->top_line -= first;
+    }
+    else
+    {
+        tlv->top_line = 0;
+        tlv->top_px = 0;
+    }
+    lv_obj_invalidate(view);
+    return ESP_OK;
+}
+
+const char *text_line_view_get_text(lv_obj_t *view, size_t *out_len)
+{
+    text_line_view_t *tlv = view ? lv_obj_get_user_data(view) : NULL;
+    if (out_len)
+    {
+        *out_len = tlv ? tlv->len : 0;
+    }
+    return tlv ? tlv->text : "";
+}
+
+size_t text_line_view_get_top(lv_obj_t *view)
+{
+    text_line_view_t *tlv = view ? lv_obj_get_user_data(view) : NULL;
+    if (!tlv)
+    {
+        return 0;
+    }
+    text_line_view_sync(tlv);
+    uint32_t row = (uint32_t)(tlv->top_px / tlv->row_h);
+    uint32_t rows = text_line_view_rows(tlv, tlv->top_line);
+    if (row >= rows)
+    {
+        row = rows - 1;
+    }
+    return tlv->lines[tlv->top_line].start + text_line_view_row_start(tlv, tlv->top_line, row);
+}
+
+void text_line_view_scroll_to(lv_obj_t *view, size_t pos)
+{
+    text_line_view_t *tlv = view ? lv_obj_get_user_data(view) : NULL;
+    if (!tlv)
+    {
+        return;
+    }
+    text_line_view_sync(tlv);
+    size_t line = text_line_view_find_line(tlv, pos);
+    uint32_t row = text_line_view_find_row(tlv, line, pos);
+    text_line_view_set_top(tlv, line, (int32_t)row * tlv->row_h);
+}
+
+void text_line_view_scroll_to_end(lv_obj_t *view)
+{
+    text_line_view_t *tlv = view ? lv_obj_get_user_data(view) : NULL;
+    if (!tlv)
+    {
+        return;
+    }
+    text_line_view_sync(tlv);
+    size_t last = tlv->line_count - 1;
+    text_line_view_set_top(tlv, last, (int32_t)text_line_view_rows(tlv, last) * tlv->row_h);
+}
+
+int32_t text_line_view_get_scroll_top(lv_obj_t *view)
+{
+    text_line_view_t *tlv = view ? lv_obj_get_user_data(view) : NULL;
+    if (!tlv)
+    {
+        return 0;
+    }
+    text_line_view_sync(tlv);
+    int64_t px = tlv->top_px;
+    for (size_t i = 0; i < tlv->top_line && px < INT32_MAX; i++)
+    {
+        px += (int64_t)text_line_view_rows_estimate(tlv, i) * tlv->row_h;
+    }
+    return (px < INT32_MAX) ? (int32_t)px : INT32_MAX;
+}
+
+int32_t text_line_view_get_scroll_bottom(lv_obj_t *view)
+{
+    text_line_view_t *tlv = view ? lv_obj_get_user_data(view) : NULL;
+    if (!tlv)
+    {
+        return 0;
+    }
+    text_line_view_sync(tlv);
+
+    /* Lay out what a screen of scrolling would reach; estimate the rest */
+    int32_t view_h = lv_obj_get_content_height(tlv->obj);
+    int64_t px = -(int64_t)tlv->top_px - view_h;
+    for (size_t i = tlv->top_line; i < tlv->line_count && px < INT32_MAX; i++)
+    {
+        uint32_t rows = (px < view_h) ? text_line_view_rows(tlv, i) : text_line_view_rows_estimate(tlv, i);
+        px += (int64_t)rows * tlv->row_h;
+    }
+    return (px < INT32_MAX) ? (int32_t)px : INT32_MAX;
+}
+
+bool text_line_view_get_row_y(lv_obj_t *view, size_t pos, int32_t *out_y)
+{
+    text_line_view_t *tlv = view ? lv_obj_get_user_data(view) : NULL;
+    if (!tlv || !out_y)
+    {
+        return false;
+    }
+    text_line_view_sync(tlv);
+    int32_t view_h = lv_obj_get_content_height(tlv->obj);
+    size_t line = text_line_view_find_line(tlv, pos);
+    int32_t y = -tlv->top_px;
+    if (line >= tlv->top_line)
+    {
+        for (size_t i = tlv->top_line; i < line; i++)
+        {
+            y += (int32_t)text_line_view_rows(tlv, i) * tlv->row_h;
+            if (y >= view_h)
+            {
+                *out_y = y;
+                return false;
+            }
+        }
+    }
+    else
+    {
+        for (size_t i = tlv->top_line; i > line; i--)
+        {
+            y -= (int32_t)text_line_view_rows(tlv, i - 1) * tlv->row_h;
+        }
+    }
+    y += (int32_t)text_line_view_find_row(tlv, line, pos) * tlv->row_h;
+    *out_y = y;
+    return y < view_h;
+}
+
+static esp_err_t text_line_view_scan(text_line_view_t *tlv, size_t from)
+{
+    const char *p = tlv->text + from;
+    const char *end = tlv->text + tlv->len;
+    while ((p = memchr(p, '\n', (size_t)(end - p))) != NULL)
+    {
+        p++;
+        if (tlv->line_count == tlv->line_cap)
+        {
+            size_t cap = tlv->line_cap * 2;
+            text_line_view_line_t *lines = realloc(tlv->lines, cap * sizeof(*lines));
+            if (!lines)
+            {
+                return ESP_ERR_NO_MEM;
+            }
+            tlv->lines = lines;
+            tlv->line_cap = cap;
+        }
+        tlv->lines[tlv->line_count++] = (text_line_view_line_t){.start = (uint32_t)(p - tlv->text)};
+    }
+    return ESP_OK;
+}
+
+static size_t text_line_view_line_len(const text_line_view_t *tlv, size_t i)
+{
+    size_t start = tlv->lines[i].start;
+    size_t end = (i + 1 < tlv->line_count) ? tlv->lines[i + 1].start - 1 : tlv->len;
+    if (end > start && tlv->text[end - 1] == '\r')
+    {
+        end--;
+    }
+    return end - start;
+}
+
+static void text_line_view_unwrap(text_line_view_t *tlv, size_t i)
+{
+    if (tlv->lines[i].rows > 1)
+    {
+        tlv->break_live -= tlv->lines[i].rows - 1;
+    }
+    tlv->lines[i].rows = 0;
+}
+
+static void text_line_view_unwrap_all(text_line_view_t *tlv)
+{
+    for (size_t i = 0; i < tlv->line_count; i++)
+    {
+        tlv->lines[i].rows = 0;
+    }
+    tlv->break_count = 0;
+    tlv->break_live = 0;
+}
+
+static void text_line_view_sync(text_line_view_t *tlv)
+{
+    const lv_font_t *font = lv_obj_get_style_text_font(tlv->obj, LV_PART_MAIN);
+    int32_t letter_space = lv_obj_get_style_text_letter_space(tlv->obj, LV_PART_MAIN);
+    int32_t width = lv_obj_get_content_width(tlv->obj);
+    if (width <= 0)
+    {
+        width = TEXT_LINE_VIEW_NO_WRAP; // Not laid out yet: SIZE_CHANGED brings the real width
+    }
+    if (font == tlv->font && letter_space == tlv->letter_space && width == tlv->width && tlv->row_h > 0)
+    {
+        return;
+    }
+
+    tlv->font = font;
+    tlv->letter_space = letter_space;
+    tlv->width = width;
+    tlv->row_h = lv_font_get_line_height(font) + lv_obj_get_style_text_line_space(tlv->obj, LV_PART_MAIN);
+    if (tlv->row_h <= 0)
+    {
+        tlv->row_h = 1;
+    }
+    tlv->avg_w = lv_font_get_glyph_width(font, 'n', '\0') + letter_space;
+    if (tlv->avg_w <= 0)
+    {
+        tlv->avg_w = 1;
+    }
+    text_line_view_unwrap_all(tlv);
+    tlv->top_px = 0;
+}
+
+static uint32_t text_line_view_rows(text_line_view_t *tlv, size_t i)
+{
+    text_line_view_line_t *line = &tlv->lines[i];
+    if (line->rows)
+    {
+        return line->rows;
+    }
+
+    /* The pool is mostly lines dropped or re-wrapped since: start it over */
+    if (tlv->break_count == tlv->break_cap && tlv->break_live * 2 < tlv->break_count)
+    {
+        text_line_view_unwrap_all(tlv);
+    }
+
+    const char *s = tlv->text + line->start;
+    size_t n = text_line_view_line_len(tlv, i);
+    size_t pos = 0;
+    size_t row_start = 0;
+    size_t last_space = 0;                      /* Just past the last space of the row, 0 if none */
+    int32_t x = 0;
+    int32_t x_at_space = 0;
+    uint32_t rows = 1;
+    line->brk = (uint32_t)tlv->break_count;
+    while (pos < n)
+    {
+        uint32_t letter = (uint8_t)s[pos];
+        size_t size = 1;
+        if (letter >= 0xC0 && letter < 0xF8)
+        {
+            size = (letter >= 0xF0) ? 4 : (letter >= 0xE0) ? 3 : 2;
+            size = (pos + size <= n) ? size : 1;
+            letter &= (size == 4) ? 0x07 : (size == 3) ? 0x0F : 0x1F;
+            for (size_t k = 1; k < size; k++)
+            {
+                letter = (letter << 6) | ((uint8_t)s[pos + k] & 0x3F);
+            }
+        }
+        uint32_t next = (pos + size < n) ? (uint8_t)s[pos + size] : 0;
+        int32_t w = lv_font_get_glyph_width(tlv->font, letter, next < 0x80 ? next : 0) + tlv->letter_space;
+
+        /* Break after the last space of the row if there is one, else right before this glyph */
+        while (x + w > tlv->width && pos > row_start)
+        {
+            size_t cut = (last_space > row_start) ? last_space : pos;
+            x = (cut == pos) ? 0 : x - x_at_space;
+            if (tlv->break_count == tlv->break_cap)
+            {
+                size_t cap = tlv->break_cap ? tlv->break_cap * 2 : 64;
+                uint32_t *breaks = realloc(tlv->breaks, cap * sizeof(*breaks));
+                if (!breaks)
+                {
+                    /* Rows past the last recorded break are clipped at the right edge */
+                    line->rows = rows;
+                    tlv->break_live += rows - 1;
+                    return rows;
+                }
+                tlv->breaks = breaks;
+                tlv->break_cap = cap;
+            }
+            tlv->breaks[tlv->break_count++] = (uint32_t)cut;
+            rows++;
+            row_start = cut;
+        }
+        x += w;
+        pos += size;
+        if (letter == ' ')
+        {
+            last_space = pos;
+            x_at_space = x;
+        }
+    }
+    line->rows = rows;
+    tlv->break_live += rows - 1;
+    return rows;
+}
+
+static uint32_t text_line_view_rows_estimate(const text_line_view_t *tlv, size_t i)
+{
+    if (tlv->lines[i].rows)
+    {
+        return tlv->lines[i].rows;
+    }
+    int64_t px = (int64_t)text_line_view_line_len(tlv, i) * tlv->avg_w;
+    return 1 + (uint32_t)(px / tlv->width);
+}
+
+static size_t text_line_view_row_start(const text_line_view_t *tlv, size_t i, uint32_t row)
+{
+    return row ? tlv->breaks[tlv->lines[i].brk + row - 1] : 0;
+}
+
+static size_t text_line_view_find_line(const text_line_view_t *tlv, size_t pos)
+{
+    size_t lo = 0;
+    size_t hi = tlv->line_count;
+    while (hi - lo > 1)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (tlv->lines[mid].start <= pos)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static uint32_t text_line_view_find_row(text_line_view_t *tlv, size_t i, size_t pos)
+{
+    uint32_t rows = text_line_view_rows(tlv, i);
+    size_t rel = (pos > tlv->lines[i].start) ? pos - tlv->lines[i].start : 0;
+    uint32_t row = 0;
+    while (row + 1 < rows && text_line_view_row_start(tlv, i, row + 1) <= rel)
+    {
+        row++;
+    }
+    return row;
+}
+
+static void text_line_view_scroll_by(text_line_view_t *tlv, int32_t dy)
+{
+    text_line_view_sync(tlv);
+    text_line_view_set_top(tlv, tlv->top_line, tlv->top_px + dy);
+}
+
+static void text_line_view_set_top(text_line_view_t *tlv, size_t line, int32_t px)
+{
+    size_t old_line = tlv->top_line;
+    int32_t old_px = tlv->top_px;
+    tlv->top_line = line;
+    tlv->top_px = px;
+    text_line_view_clamp(tlv);
+    if (tlv->top_line != old_line || tlv->top_px != old_px)
+    {
+        lv_obj_invalidate(tlv->obj);
+        lv_obj_send_event(tlv->obj, LV_EVENT_SCROLL, NULL);
+    }
+}
+
+static void text_line_view_clamp(text_line_view_t *tlv)
+{
+    while (tlv->top_px < 0 && tlv->top_line > 0)
+    {
+        tlv->top_line--;
+        tlv->top_px += (int32_t)text_line_view_rows(tlv, tlv->top_line) * tlv->row_h;
+    }
+    if (tlv->top_px < 0)
+    {
+        tlv->top_px = 0;
+    }
+    while (tlv->top_line + 1 < tlv->line_count)
+    {
+        int32_t h = (int32_t)text_line_view_rows(tlv, tlv->top_line) * tlv->row_h;
+        if (tlv->top_px < h)
+        {
+            break;
+        }
+        tlv->top_px -= h;
+        tlv->top_line++;
+    }
+
+    /* Pull back if the end of the text is above the bottom of the view */
+    int32_t view_h = lv_obj_get_content_height(tlv->obj);
+    int32_t shown = -tlv->top_px;
+    for (size_t i = tlv->top_line; i < tlv->line_count && shown < view_h; i++)
+    {
+        shown += (int32_t)text_line_view_rows(tlv, i) * tlv->row_h;
+    }
+    if (shown >= view_h)
+    {
+        return;
+    }
+    tlv->top_px -= view_h - shown;
+    while (tlv->top_px < 0 && tlv->top_line > 0)
+    {
+        tlv->top_line--;
+        tlv->top_px += (int32_t)text_line_view_rows(tlv, tlv->top_line) * tlv->row_h;
+    }
+    if (tlv->top_px < 0)
+    {
+        tlv->top_px = 0;
+    }
+}
+
+static void text_line_view_on_draw(lv_event_t *e)
+{
+    text_line_view_t *tlv = lv_event_get_user_data(e);
+    lv_layer_t *layer = lv_event_get_layer(e);
+    if (!tlv || !layer)
+    {
+        return;
+    }
+    text_line_view_sync(tlv);
+
+    lv_area_t content;
+    lv_obj_get_content_coords(tlv->obj, &content);
+    lv_area_t clip = {
+        LV_MAX(layer->_clip_area.x1, content.x1), LV_MAX(layer->_clip_area.y1, content.y1),
+        LV_MIN(layer->_clip_area.x2, content.x2), LV_MIN(layer->_clip_area.y2, content.y2),
+    };
+    if (clip.x1 > clip.x2 || clip.y1 > clip.y2)
+    {
+        return;
+    }
+    lv_area_t old_clip = layer->_clip_area;
+    layer->_clip_area = clip;
+
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    lv_obj_init_draw_label_dsc(tlv->obj, LV_PART_MAIN, &dsc);
+    dsc.font = tlv->font;
+    dsc.flag = LV_TEXT_FLAG_EXPAND; // Rows are already cut to the width
+
+    /* Only the rows crossing the clip area become draw tasks, each pointing into the text */
+    int32_t y = content.y1 - tlv->top_px;
+    for (size_t i = tlv->top_line; i < tlv->line_count && y <= clip.y2; i++)
+    {
+        uint32_t rows = text_line_view_rows(tlv, i);
+        size_t n = text_line_view_line_len(tlv, i);
+        for (uint32_t r = 0; r < rows && y <= clip.y2; r++, y += tlv->row_h)
+        {
+            if (y + tlv->row_h <= clip.y1)
+            {
+                continue;
+            }
+            size_t from = text_line_view_row_start(tlv, i, r);
+            size_t to = (r + 1 < rows) ? text_line_view_row_start(tlv, i, r + 1) : n;
+            if (to <= from)
+            {
+                continue;
+            }
+            lv_area_t area = {content.x1, y, content.x2, y + tlv->row_h - 1};
+            dsc.text = tlv->text + tlv->lines[i].start + from;
+            dsc.text_length = (uint32_t)(to - from);
+            lv_draw_label(layer, &dsc, &area);
+        }
+    }
+
+    layer->_clip_area = old_clip;
+}
+
+static void text_line_view_on_event(lv_event_t *e)
+{
+    text_line_view_t *tlv = lv_event_get_user_data(e);
+    if (!tlv)
+    {
+        return;
+    }
+
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_DELETE)
+    {
+        text_line_view_stop_throw(tlv);
+        free(tlv->text);
+        free(tlv->lines);
+        free(tlv->breaks);
+        free(tlv);
+    }
+    else if (code == LV_EVENT_SIZE_CHANGED || code == LV_EVENT_STYLE_CHANGED)
+    {
+        /* Keep the top line; its rows are wrapped again on the next draw */
+        text_line_view_sync(tlv);
+        text_line_view_clamp(tlv);
+        lv_obj_invalidate(tlv->obj);
+    }
+    else if (code == LV_EVENT_PRESSED)
+    {
+        text_line_view_stop_throw(tlv);
+        tlv->throw_v = 0;
+    }
+    else if (code == LV_EVENT_PRESSING)
+    {
+        lv_point_t vect = {0};
+        lv_indev_get_vect(lv_indev_active(), &vect);
+        if (vect.y != 0)
+        {
+            tlv->throw_v = -vect.y;
+            text_line_view_scroll_by(tlv, -vect.y);
+        }
+    }
+    else if (code == LV_EVENT_RELEASED)
+    {
+        if (tlv->throw_v > 1 || tlv->throw_v < -1)
+        {
+            tlv->throw_timer = lv_timer_create(text_line_view_on_throw_timer, TEXT_LINE_VIEW_THROW_PERIOD_MS, tlv);
+        }
+    }
+}
+
+static void text_line_view_on_throw_timer(lv_timer_t *timer)
+{
+    text_line_view_t *tlv = lv_timer_get_user_data(timer);
+    tlv->throw_v = tlv->throw_v * (100 - TEXT_LINE_VIEW_THROW_DECAY) / 100;
+    if (tlv->throw_v == 0)
+    {
+        text_line_view_stop_throw(tlv);
+        return;
+    }
+    text_line_view_scroll_by(tlv, tlv->throw_v);
+}
+
+static void text_line_view_stop_throw(text_line_view_t *tlv)
+{
+    if (tlv->throw_timer)
+    {
+        lv_timer_del(tlv->throw_timer);
+        tlv->throw_timer = NULL;
+    }
+}
@@ -6,15 +6,27 @@
 #include <string.h>
 #include <stdio.h>
 #include <errno.h>
+#include <inttypes.h>
 
 #include "fs_navigator.h"
 #include "fs_text_ops.h"
+#include "fs_text_index.h"
+#include "fs_text_cache.h"
+#include "fs_text_search.h"
+#include "text_line_view.h"
 #include "Domine_16.h"
 #include "esp_log.h"
 #include "sd_card.h"
 #include "styles.h"
 
 #define TEXT_VIEWER_PATH_SCROLL_DELAY_MS 2000
+#define TEXT_VIEWER_INDEX_POLL_MS        100
+#define TEXT_VIEWER_SEARCH_POLL_MS       100
+#define TEXT_VIEWER_FOLLOW_POLL_MS       500
+#define TEXT_VIEWER_FOLLOW_MAX_READ      (2 * READ_CHUNK_SIZE_B)  /* Larger bursts reload the last window instead */
+#define TEXT_VIEWER_FOLLOW_WINDOW        (4 * READ_CHUNK_SIZE_B)  /* Text kept while following before old lines are dropped */
+#define TEXT_VIEWER_GUTTER_ROWS          32          /* Line numbers shown at once (more than fit the panel) */
+#define TEXT_VIEWER_LINE_UNKNOWN         UINT32_MAX
 
 /**
  * @brief Actions in the chunk-change prompt.
@@ -35,6 +47,28 @@ typedef enum
     TEXT_VIEWER_SD_CHUNK,
 } text_viewer_sd_action_t;
 
+/**
+ * @brief Edit log of the loaded window, kept as one changed span.
+ *
+ * The first @c start bytes and the last @c tail bytes of the text area are
+ * known to match the window as loaded (or last saved); everything in between
+ * is the edit. Each insert or delete at the cursor only widens the span, so
+ * recording a keystroke and asking whether the text is dirty are both O(1)
+ * and no copy of the original text is kept. Undoing an edit at the same spot
+ * shrinks the span back to nothing. The cursor's byte offset is found by
+ * walking from the last one looked up (@c mark_char / @c mark_byte), so
+ * typing costs the same anywhere in the window.
+ */
+typedef struct
+{
+    size_t orig_len;                            /**< Bytes of the window as loaded or last saved */
+    size_t cur_len;                             /**< Bytes currently in the text area */
+    size_t start;                               /**< Length of the unchanged prefix */
+    size_t tail;                                /**< Length of the unchanged suffix */
+    uint32_t mark_char;                         /**< Character index of the last cursor looked up */
+    size_t mark_byte;                           /**< Byte offset of @c mark_char in the text area */
+} text_viewer_edits_t;
+
 /**
  * @brief Runtime state for the singleton text viewer/editor screen.
  */
@@ -46,18 +80,43 @@ typedef struct
     bool new_file;                              /**< True if creating a new file */
     bool at_top_edge;                           /**< Tracks if the scroll is currently at the top edge */
     bool at_bottom_edge;                        /**< Tracks if the scroll is currently at the bottom edge */
+    bool prefetched_next;                       /**< Read-ahead of the following chunk requested for this window */
+    bool prefetched_prev;                       /**< Read-ahead of the preceding window requested for this window */
     bool suppress_events;                       /**< Temporarily disable change detection */
-    size_t lasf_file_offset_kb;                 /**< Offset (in KB) used for the last read chunk */
-    size_t current_file_offset_kb;              /**< Offset (in KB) used for the current/next chunk */
-    size_t max_file_offset_kb;                  /**< Maximum readable offset (in KB) for the loaded file */
+    size_t window_start;                        /**< File offset of the first byte in the text area */
+    size_t window_mid;                          /**< File offset where the second chunk of the window begins */
+    size_t window_end;                          /**< File offset just past the last byte in the text area */
+    size_t file_size;                           /**< File size as last read or saved */
+    uint32_t window_line;                       /**< 0-based line at window_start, TEXT_VIEWER_LINE_UNKNOWN until known */
+    fs_text_index_t index;                      /**< Sparse line index of the file (valid if index_ready) */
+    bool index_ready;                           /**< True once the background index build has been collected */
+    lv_timer_t *index_timer;                    /**< Timer polling the background index build */
     lv_obj_t *screen;                           /**< Root LVGL screen object */
     lv_obj_t *toolbar;                          /**< Toolbar container */
     lv_obj_t *path_label;                       /**< Label showing the file path */
     lv_obj_t *status_label;                     /**< Label showing transient status messages */
     lv_obj_t *save_btn;                         /**< Save button (hidden/disabled in view mode) */
-    lv_obj_t *text_area;                        /**< Text area for viewing/editing content */
+    lv_obj_t *text_area;                        /**< Text area for editing (NULL in view mode) */
+    lv_obj_t *line_view;                        /**< Read-only renderer of visible lines (NULL in edit mode) */
     lv_obj_t *keyboard;                         /**< On-screen keyboard */
     lv_obj_t *chunk_slider;                     /**< Vertical slider for chunk navigation */
+    lv_obj_t *gutter;                           /**< Line-number column left of the text area */
+    lv_obj_t *gutter_rows[TEXT_VIEWER_GUTTER_ROWS]; /**< Line-number labels, placed on visible line starts */
+    lv_obj_t *goto_dialog;                      /**< Go-to-line dialog */
+    lv_obj_t *goto_textarea;                    /**< Line number entry inside the go-to-line dialog */
+    lv_obj_t *find_dialog;                      /**< Find dialog */
+    lv_obj_t *find_textarea;                    /**< Pattern entry inside the find dialog */
+    lv_obj_t *replace_textarea;                 /**< Replacement entry inside the find dialog (edit mode) */
+    lv_obj_t *replace_mbox;                     /**< Progress box shown while replace-all rewrites the file */
+    lv_obj_t *replace_label;                    /**< Progress text inside replace_mbox */
+    lv_timer_t *search_timer;                   /**< Timer polling the background search or replace, NULL when idle */
+    size_t search_hit;                          /**< File offset of the last match, SIZE_MAX if none */
+    char search_pattern[FS_TEXT_SEARCH_MAX_PATTERN + 1]; /**< Last pattern searched for */
+    lv_obj_t *follow_btn;                       /**< Follow button (view mode only) */
+    lv_obj_t *follow_label;                     /**< Label of the follow button */
+    lv_timer_t *follow_timer;                   /**< Timer polling the file size while following, NULL when off */
+    size_t follow_size;                         /**< File size at the last follow poll */
+    bool follow_behind;                         /**< A burst outran the tail window while scrolled up: reload it once back at the bottom */
     lv_obj_t *return_screen;                    /**< Screen to return to on close */
     lv_obj_t *confirm_mbox;                     /**< Confirmation message box (save/discard) */
     lv_obj_t *chunk_mbox;                       /**< Chunk-change confirmation message box */
@@ -70,10 +129,10 @@ typedef struct
     char path[FS_TEXT_MAX_PATH];                /**< Current file path */
     char directory[FS_TEXT_MAX_PATH];           /**< Directory used for new files */
     char pending_name[FS_NAV_MAX_NAME];         /**< Suggested filename for new files */
-    char *original_text;                        /**< Snapshot of text at load/save time */
-    size_t pending_first_offset_kb;             /**< Pending first chunk offset when prompting */
-    size_t pending_second_offset_kb;            /**< Pending second chunk offset when prompting */
-    bool pending_scroll_up;                     /**< True if pending load comes from top edge */
+    text_viewer_edits_t edits;                  /**< Changed span against the loaded window */
+    size_t pending_start;                       /**< Window start (chunk boundary) of the pending load */
+    size_t pending_anchor;                      /**< File offset to keep at the top of the view after the pending load */
+    uint32_t pending_line;                      /**< Line at pending_start if known, TEXT_VIEWER_LINE_UNKNOWN otherwise */
     bool pending_chunk;                         /**< True if a chunk load is pending confirmation */
     bool waiting_sd;                            /**< True while waiting SD reconnection */
     text_viewer_sd_action_t sd_retry_action;    /**< Pending action after SD reconnect */
@@ -118,6 +177,31 @@ static void text_viewer_build_screen(text_viewer_ctx_t *ctx);
  */
 static void text_viewer_apply_mode(text_viewer_ctx_t *ctx);
 
+/**
+ * @brief Text of the loaded window, from whichever widget shows it.
+ *
+ * @param ctx Pointer to the text viewer context. Must not be NULL.
+ */
+static const char *text_viewer_text(text_viewer_ctx_t *ctx);
+
+/**
+ * @brief Show @p len bytes of @p text (null-terminated) in the line view or the text area.
+ *
+ * @param ctx  Pointer to the text viewer context. Must not be NULL.
+ * @param text Window text.
+ * @param len  Bytes of @p text.
+ *
+ * @return ESP_OK, or ESP_ERR_NO_MEM if the line view could not take the copy.
+ */
+static esp_err_t text_viewer_set_text(text_viewer_ctx_t *ctx, const char *text, size_t len);
+
+/**
+ * @brief Object the window is shown in: the line view when viewing, the text area when editing.
+ *
+ * @param ctx Pointer to the text viewer context. Must not be NULL.
+ */
+static lv_obj_t *text_viewer_text_obj(text_viewer_ctx_t *ctx);
+
 /**
  * @brief Set a short status message in the toolbar.
  *
@@ -163,14 +247,59 @@ static void text_viewer_restart_path_scroll(text_viewer_ctx_t *ctx);
 static void text_viewer_path_scroll_timer_cb(lv_timer_t *timer);
 
 /**
- * @brief Replace the stored original text snapshot.
+ * @brief Make the current text area content the new clean baseline.
  *
- * Frees the previous snapshot and stores a duplicate of @p text.
+ * @param ctx Viewer context.
+ * @param len Byte length of the text now in the text area.
+ */
+static void text_viewer_reset_edits(text_viewer_ctx_t *ctx, size_t len);
+
+/**
+ * @brief Widen the edit span for @p len bytes inserted or deleted at byte @p pos.
  *
- * @param ctx  Viewer context.
- * @param text New baseline text (may be NULL, which clears the snapshot).
+ * @param edits Edit log.
+ * @param pos   Byte offset of the edit in the current text.
+ * @param len   Bytes inserted (or removed).
+ * @param del   true for a deletion of [pos, pos + len).
+ */
+static void text_viewer_record_edit(text_viewer_edits_t *edits, size_t pos, size_t len, bool del);
+
+/**
+ * @brief Returns true if the text area differs from the baseline (O(1)).
+ */
+static bool text_viewer_edits_dirty(const text_viewer_edits_t *edits);
+
+/**
+ * @brief Changed byte range of the window: @p old_len bytes at @p start became @p new_len bytes.
+ *
+ * @param edits   Edit log.
+ * @param start   Receives the offset of the change within the window.
+ * @param old_len Receives the bytes replaced in the window as loaded.
+ * @param new_len Receives the bytes that replace them in the text area.
+ */
+static void text_viewer_edit_range(const text_viewer_edits_t *edits, size_t *start, size_t *old_len, size_t *new_len);
+
+/**
+ * @brief Byte offset of character @p char_pos in UTF-8 @p text (clamped to the end).
+ */
+static size_t text_viewer_utf8_offset(const char *text, uint32_t char_pos);
+
+/**
+ * @brief Byte offset of character @p char_pos in @p text, walked from the edit log's mark.
+ *
+ * Moves the mark to @p char_pos: a keystroke costs the characters typed since
+ * the previous one, a cursor jump costs its distance once.
+ *
+ * @param edits    Edit log whose mark matches @p text.
+ * @param text     Current text of the text area.
+ * @param char_pos Character index (clamped to the end of @p text).
+ */
+static size_t text_viewer_cursor_offset(text_viewer_edits_t *edits, const char *text, uint32_t char_pos);
+
+/**
+ * @brief Character index of byte offset @p byte_pos in UTF-8 @p text (inverse of text_viewer_utf8_offset()).
  */
-static void text_viewer_set_original(text_viewer_ctx_t *ctx, const char *text);
+static uint32_t text_viewer_utf8_index(const char *text, size_t byte_pos);
 
 /**
  * @brief Resolve slider window size and step (in KB chunks) with defaults.
@@ -181,6 +310,21 @@ static void text_viewer_set_original(text_viewer_ctx_t *ctx, const char *text);
  */
 static void text_viewer_get_slider_params(text_viewer_ctx_t *ctx, size_t *window_size, size_t *step);
 
+/**
+ * @brief Number of slider positions: line-index checkpoints once the index is ready, KB chunks before.
+ *
+ * @param ctx Viewer context.
+ * @return Positions (>= 1); 1 when the whole file is loaded.
+ */
+static size_t text_viewer_slider_total(text_viewer_ctx_t *ctx);
+
+/**
+ * @brief Slider position of the loaded window (see text_viewer_slider_total()).
+ *
+ * @param ctx Viewer context.
+ */
+static size_t text_viewer_slider_current(text_viewer_ctx_t *ctx);
+
 /**
  * @brief Sync the chunk slider with the current window and file size.
  *
@@ -202,14 +346,57 @@ static void text_viewer_update_slider(text_viewer_ctx_t *ctx);
 static void text_viewer_on_slider_value_changed(lv_event_t *e);
 
 /**
- * @brief Load two consecutive chunks into the textarea and position the cursor at the boundary.
+ * @brief Read the two chunks starting at @p start into one null-terminated buffer.
+ *
+ * Chunks come from the read-ahead ring (see fs_text_cache_read()), so a
+ * window step only reads the card for chunks that were not prefetched.
+ *
+ * @param path  File to read.
+ * @param start Chunk boundary where the window begins.
+ * @param out   Receives the allocated text (caller frees).
+ * @param len   Receives the window length in bytes.
+ * @param mid   Receives the length of the first chunk.
+ * @return ESP_OK on success, fs_text_read_chunk() error codes otherwise.
+ */
+static esp_err_t text_viewer_read_window(const char *path, size_t start, char **out, size_t *len, size_t *mid);
+
+/**
+ * @brief Load the window starting at chunk boundary @p start into the textarea.
+ *
+ * An unknown @p line is carried over from the replaced window when the two
+ * overlap, or looked up in the line index.
  *
- * @param ctx             Viewer context.
- * @param first_offset_kb Offset (KB) of the first chunk.
- * @param second_offset_kb Offset (KB) of the second chunk.
+ * @param ctx   Viewer context.
+ * @param start File offset of the window (see fs_text_chunk_align()).
+ * @param line  0-based line starting at @p start, or TEXT_VIEWER_LINE_UNKNOWN.
  * @return ESP_OK on success, error code otherwise.
  */
-static esp_err_t text_viewer_load_window(text_viewer_ctx_t *ctx, size_t first_offset_kb, size_t second_offset_kb);
+static esp_err_t text_viewer_load_window(text_viewer_ctx_t *ctx, size_t start, uint32_t line);
+
+/**
+ * @brief Start indexing the lines of the open file in the background.
+ *
+ * Drops the current index; @ref text_viewer_on_index_timer collects the new one.
+ *
+ * @param ctx Viewer context with a valid @c path.
+ */
+static void text_viewer_start_index(text_viewer_ctx_t *ctx);
+
+/**
+ * @brief Collect the background index build and refresh the gutter and slider.
+ *
+ * @param timer LVGL timer whose user data is the viewer context.
+ */
+static void text_viewer_on_index_timer(lv_timer_t *timer);
+
+/**
+ * @brief Number the logical lines that start inside the visible part of the text area.
+ *
+ * Hides the numbers while the line of the window start is unknown.
+ *
+ * @param ctx Viewer context.
+ */
+static void text_viewer_update_gutter(text_viewer_ctx_t *ctx);
 
 /**
  * @brief Enable/disable the Save button based on @c editable and @c dirty.
@@ -244,20 +431,41 @@ static void text_viewer_hide_keyboard(text_viewer_ctx_t *ctx);
  */
 static void text_viewer_on_text_area_clicked(lv_event_t *e);
 /**
- * @brief Immediately jump the text area's scroll to the cursor position.
+ * @brief File offset of the first character visible in the text area.
+ *
+ * @param ctx Pointer to the text viewer context. Must not be NULL.
+ */
+static size_t text_viewer_top_offset(text_viewer_ctx_t *ctx);
+
+/**
+ * @brief Put the line holding file offset @p offset at the top of the view, without animation.
  *
- * Skips LVGL's default smooth scroll animation and forces the text area
- * to scroll instantly to the final cursor location. Useful when loading
- * a new text chunk and repositioning the cursor manually.
+ * Also moves the cursor there, so scroll position carries across chunk swaps
+ * by exact byte offset rather than by an estimated cursor index.
+ *
+ * @param ctx    Pointer to the text viewer context. Must not be NULL.
+ * @param offset File offset inside the loaded window.
+ */
+static void text_viewer_scroll_to_offset(text_viewer_ctx_t *ctx, size_t offset);
+
+/**
+ * @brief Pixels scrolled out above the view.
+ *
+ * @param ctx Pointer to the text viewer context. Must not be NULL.
+ */
+static int32_t text_viewer_scroll_top(text_viewer_ctx_t *ctx);
+
+/**
+ * @brief Pixels left below the view.
  *
  * @param ctx Pointer to the text viewer context. Must not be NULL.
  */
-static void text_viewer_skip_cursor_animation(text_viewer_ctx_t *ctx);
+static int32_t text_viewer_scroll_bottom(text_viewer_ctx_t *ctx);
 
 /**
  * @brief Handle scroll events and load new text chunks when reaching edges.
  *
- * Triggered whenever the LVGL text area scrolls.  
+ * Triggered whenever the line view or the text area scrolls.
  * Detects when the user reaches the top or bottom of the current buffer window
  * and loads the previous/next chunk of the file accordingly.
  *
@@ -312,22 +520,36 @@ static void text_viewer_on_screen_clicked(lv_event_t *e);
  */
 static void text_viewer_on_text_changed(lv_event_t *e);
 
+/**
+ * @brief Record the pending insert/delete (LV_EVENT_INSERT) in the edit log.
+ *
+ * Fired by the text area before it applies the change, while the cursor still
+ * marks the edit position.
+ *
+ * @param e LVGL event whose parameter is the inserted text, or LV_KEY_DEL for a backspace.
+ */
+static void text_viewer_on_text_insert(lv_event_t *e);
+
 /**
  * @brief Save the currently loaded text chunk back to the underlying file.
  *
  * This function writes the contents of the LVGL textarea in @p ctx->text_area
  * into the backing file at @p ctx->path, only within the byte window
- * corresponding to the currently loaded chunks (defined by
- * ctx->lasf_file_offset_kb and ctx->current_file_offset_kb).
+ * corresponding to the currently loaded chunks (ctx->window_start to
+ * ctx->window_end).
  *
  * Save strategy:
  * - If @p ctx is NULL, the function returns immediately.
  * - If this is a new file with no name yet, a name dialog is shown and
  *   the function returns without writing.
  * - If the file name is still missing, a "Missing file name" status is set.
- * - Computes a byte window [window_start, window_end) for the loaded text
- *   (based on chunk offsets and READ_CHUNK_SIZE_B), with overflow checks.
+ * - Takes the byte window [window_start, window_end) of the loaded text.
  * - Clamps the window to the existing file size to avoid seeking past EOF.
+ * - For an existing file whose window still matches the loaded text, hands
+ *   only the changed span (see text_viewer_edit_range()) to fs_text_patch(),
+ *   which writes it in place under a journal and shifts the tail only when
+ *   the length changed. Otherwise (new file, or no memory for the patch) it
+ *   falls back to rewriting the whole file:
  * - Builds a temporary file path in the same directory as @p dest_path.
  * - Opens the existing file (if any) as @p src and a temporary file as @p tmp.
  * - Writes:
@@ -345,7 +567,7 @@ static void text_viewer_on_text_changed(lv_event_t *e);
  *      - Cleans up open FILE handles and removes the temporary file.
  *
  * On success:
- * - Updates the "original" text snapshot via text_viewer_set_original().
+ * - Makes the saved text the new clean baseline via text_viewer_reset_edits().
  * - Clears @p ctx->dirty (sets it to false).
  * - Sets status to "Saved".
  *
@@ -354,6 +576,16 @@ static void text_viewer_on_text_changed(lv_event_t *e);
  */
 static void text_viewer_handle_save(text_viewer_ctx_t *ctx);
 
+/**
+ * @brief Write @p text over the current window of the file (body of text_viewer_handle_save()).
+ *
+ * Runs while the read-ahead ring has released its handles on the file.
+ *
+ * @param ctx  Text viewer context with a file name.
+ * @param text Textarea contents.
+ */
+static void text_viewer_write_window(text_viewer_ctx_t *ctx, const char *text);
+
 /**
  * @brief "Save" button event handler.
  *
@@ -399,12 +631,12 @@ static void text_viewer_apply_pending_chunk(text_viewer_ctx_t *ctx);
 /**
  * @brief Schedule loading a new chunk window (with optional prompt if dirty).
  *
- * @param ctx Viewer context.
- * @param first_offset_kb First chunk offset to load.
- * @param second_offset_kb Second chunk offset to load.
- * @param from_top True if triggered from top edge scroll.
+ * @param ctx    Viewer context.
+ * @param start  Chunk boundary where the new window begins.
+ * @param anchor File offset to show at the top of the view once loaded.
+ * @param line   0-based line starting at @p start, or TEXT_VIEWER_LINE_UNKNOWN.
  */
-static void text_viewer_request_chunk_load(text_viewer_ctx_t *ctx, size_t first_offset_kb, size_t second_offset_kb, bool from_top);
+static void text_viewer_request_chunk_load(text_viewer_ctx_t *ctx, size_t start, size_t anchor, uint32_t line);
 
 /**
  * @brief Poll SD reconnection and retry pending actions.
@@ -475,6 +707,211 @@ static void text_viewer_on_name_dialog(lv_event_t *e);
 
 /*********************************************************************************************/
 
+/************************************** Go-to-line dialog ************************************/
+
+/**
+ * @brief Show the go-to-line dialog with the numeric keyboard.
+ *
+ * @param ctx Viewer context.
+ */
+static void text_viewer_show_goto_dialog(text_viewer_ctx_t *ctx);
+
+/**
+ * @brief Close the go-to-line dialog (if present) and restore the keyboard.
+ *
+ * @param ctx Viewer context.
+ */
+static void text_viewer_close_goto_dialog(text_viewer_ctx_t *ctx);
+
+/**
+ * @brief Go-to-line dialog button handler (also used by the keyboard's OK button).
+ *
+ * @param e LVGL event.
+ */
+static void text_viewer_on_goto_dialog(lv_event_t *e);
+
+/**
+ * @brief "Line" button handler: opens the go-to-line dialog.
+ *
+ * @param e LVGL event.
+ */
+static void text_viewer_on_goto(lv_event_t *e);
+
+/**
+ * @brief Put 0-based @p line at the top of the view.
+ *
+ * Lines inside the loaded window are reached without I/O; others need the
+ * line index and load the window starting at that line.
+ *
+ * @param ctx  Viewer context.
+ * @param line Target line (clamped to the last line).
+ */
+static void text_viewer_goto_line(text_viewer_ctx_t *ctx, uint32_t line);
+
+/**
+ * @brief Show the find dialog, prefilled with the last pattern.
+ *
+ * @param ctx Viewer context.
+ */
+static void text_viewer_show_find_dialog(text_viewer_ctx_t *ctx);
+
+/**
+ * @brief Close the find dialog if open.
+ *
+ * @param ctx Viewer context.
+ */
+static void text_viewer_close_find_dialog(text_viewer_ctx_t *ctx);
+
+/**
+ * @brief Find dialog button handler ("Next", "Prev", "All" or "Cancel").
+ */
+static void text_viewer_on_find_dialog(lv_event_t *e);
+
+/**
+ * @brief Point the keyboard at the find dialog field that was tapped.
+ *
+ * @param e LVGL event whose target is the text area.
+ */
+static void text_viewer_on_find_field_clicked(lv_event_t *e);
+
+/**
+ * @brief "Find" button handler: opens the find dialog, or cancels a search in progress.
+ *
+ * @param e LVGL event.
+ */
+static void text_viewer_on_find(lv_event_t *e);
+
+/**
+ * @brief Start a background search for ctx->search_pattern, continuing after the last match.
+ *
+ * Without a previous match the search starts at the top of the view. It
+ * wraps around the file.
+ *
+ * @param ctx     Viewer context.
+ * @param forward true for the next match, false for the previous one.
+ */
+static void text_viewer_find(text_viewer_ctx_t *ctx, bool forward);
+
+/**
+ * @brief Poll the background search, show its progress and jump to the match.
+ *
+ * @param timer LVGL timer (user data: viewer context).
+ */
+static void text_viewer_on_search_timer(lv_timer_t *timer);
+
+/**
+ * @brief Cancel a background search and drop its timer.
+ *
+ * @param ctx Viewer context.
+ */
+static void text_viewer_stop_search(text_viewer_ctx_t *ctx);
+
+/**
+ * @brief Replace every match of ctx->search_pattern in the whole file on the background task.
+ *
+ * The file handles of the read-ahead ring and the line index are released
+ * first, and a modal progress box blocks the view until the file is back.
+ *
+ * @param ctx         Viewer context.
+ * @param replacement Replacement text.
+ */
+static void text_viewer_replace_all(text_viewer_ctx_t *ctx, const char *replacement);
+
+/**
+ * @brief Poll the background replace, update the progress box and finish when it ends.
+ *
+ * @param timer LVGL timer (user data: viewer context).
+ */
+static void text_viewer_on_replace_timer(lv_timer_t *timer);
+
+/**
+ * @brief Progress box "Cancel" handler: abandon the replace, leaving the file unchanged.
+ *
+ * @param e LVGL event.
+ */
+static void text_viewer_on_replace_cancel(lv_event_t *e);
+
+/**
+ * @brief Close the progress box, reopen the file and reload the window after a replace.
+ *
+ * @param ctx   Viewer context.
+ * @param err   Result of the replace.
+ * @param count Replacements made.
+ */
+static void text_viewer_finish_replace(text_viewer_ctx_t *ctx, esp_err_t err, size_t count);
+
+/**
+ * @brief Bring file offset @p offset into view, loading the window around it if needed.
+ *
+ * @param ctx    Viewer context.
+ * @param offset File offset of the match.
+ */
+static void text_viewer_show_match(text_viewer_ctx_t *ctx, size_t offset);
+
+/*********************************************************************************************/
+
+/**************************************** Follow mode ****************************************/
+
+/**
+ * @brief Toolbar "Follow" handler: start or stop following the end of the file.
+ *
+ * @param e LVGL event.
+ */
+static void text_viewer_on_follow(lv_event_t *e);
+
+/**
+ * @brief Stop polling the file size and restore the button label.
+ *
+ * @param ctx Viewer context.
+ */
+static void text_viewer_stop_follow(text_viewer_ctx_t *ctx);
+
+/**
+ * @brief Poll the file size and bring appended lines into the window.
+ *
+ * Only the bytes past the old end are read. The window grows by the new
+ * lines until it holds TEXT_VIEWER_FOLLOW_WINDOW bytes, then its oldest
+ * lines are dropped. The view stays at the bottom unless the user scrolled up.
+ *
+ * @param timer LVGL timer (user data: viewer context).
+ */
+static void text_viewer_on_follow_timer(lv_timer_t *timer);
+
+/**
+ * @brief Append the complete lines in [window_end, @p size) to the line view.
+ *
+ * @param ctx   Viewer context (window at the end of the file).
+ * @param size  Current file size.
+ * @param stick True to keep the view at the bottom.
+ *
+ * @return ESP_OK (also when no line is complete yet), ESP_ERR_NO_MEM, or a read error.
+ */
+static esp_err_t text_viewer_follow_append(text_viewer_ctx_t *ctx, size_t size, bool stick);
+
+/**
+ * @brief Load the window ending at @p size and scroll to its bottom.
+ *
+ * @param ctx  Viewer context.
+ * @param size Current file size.
+ */
+static void text_viewer_follow_jump(text_viewer_ctx_t *ctx, size_t size);
+
+/**
+ * @brief Line number at file offset @p offset past the window, counted over the bytes in between.
+ *
+ * @return The 0-based line, or TEXT_VIEWER_LINE_UNKNOWN.
+ */
+static uint32_t text_viewer_follow_line(text_viewer_ctx_t *ctx, size_t offset);
+
+/**
+ * @brief Scroll the text area to its last line.
+ *
+ * @param ctx Viewer context.
+ */
+static void text_viewer_scroll_to_end(text_viewer_ctx_t *ctx);
+
+/*********************************************************************************************/
+
 /************************************ Confirmation dialog ************************************/
 
 /**
@@ -511,7 +948,7 @@ static void text_viewer_on_confirm(lv_event_t *e);
 /**
  * @brief Close the viewer, unload the screen, and invoke the close callback.
  *
- * Resets mode and frees resources (keyboard target, original snapshot).
+ * Resets mode and frees resources (keyboard target, edit log).
  *
  * @param ctx     Viewer context.
  * @param changed True if file content was saved/changed (passed to callback).
@@ -538,9 +975,9 @@ esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts)
     }
 
     char *content = NULL;
-    size_t file_size_kb = 0;
-    size_t first_offset_kb = 0;
-    size_t second_offset_kb = 0;
+    size_t file_size = 0;
+    size_t window_len = 0;
+    size_t window_mid = 0;
     if (new_file)
     {
         content = strdup("");
@@ -551,58 +988,32 @@ esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts)
     }
     else
     {
-        char *chunk_a = NULL;
-        char *chunk_b = NULL;
-        size_t len_a = 0;
-        size_t len_b = 0;
-        struct stat st = {0};
-        if (stat(opts->path, &st) == 0 && S_ISREG(st.st_mode))
-        {
-            file_size_kb = (st.st_size > 0) ? ((size_t)st.st_size - 1u) / 1024u : 0;
-        }
-        second_offset_kb = (file_size_kb > 0) ? 1 : 0;
-
-        esp_err_t err = fs_text_read_range(opts->path, first_offset_kb, &chunk_a, &len_a);
-        if (err != ESP_OK)
+        /* Finish a save cut short by power loss before showing the file */
+        if (fs_text_recover(opts->path) != ESP_OK)
         {
-            free(chunk_a);
-            return err;
+            ESP_LOGW(TAG, "Pending patch journal next to %s could not be replayed", opts->path);
         }
-
-        if (second_offset_kb != first_offset_kb)
+        struct stat st = {0};
+        if (stat(opts->path, &st) == 0 && S_ISREG(st.st_mode))
         {
-            err = fs_text_read_range(opts->path, second_offset_kb, &chunk_b, &len_b);
-            if (err != ESP_OK)
-            {
-                free(chunk_a);
-                free(chunk_b);
-                return err;
-            }
+            file_size = (size_t)st.st_size;
         }
 
-        size_t total = len_a + len_b;
-        content = (char *)malloc(total + 1);
-        if (!content)
+        if (fs_text_cache_open(opts->path) != ESP_OK)
         {
-            free(chunk_a);
-            free(chunk_b);
-            return ESP_ERR_NO_MEM;
-        }
-        if (len_a)
-        {
-            memcpy(content, chunk_a, len_a);
+            ESP_LOGW(TAG, "No read-ahead for %s, reading chunks on demand", opts->path);
         }
-        if (len_b)
+        esp_err_t err = text_viewer_read_window(opts->path, 0, &content, &window_len, &window_mid);
+        if (err != ESP_OK)
         {
-            memcpy(content + len_a, chunk_b, len_b);
+            fs_text_cache_close();
+            return err;
         }
-        content[total] = '\0';
-
-        free(chunk_a);
-        free(chunk_b);
     }
 
     text_viewer_ctx_t *ctx = &s_viewer;
+    ctx->editable = new_file ? true : opts->editable;
+    ctx->new_file = new_file;
     if (!ctx->screen)
     {
         text_viewer_build_screen(ctx);
@@ -610,28 +1021,40 @@ esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts)
 
     text_viewer_close_confirm(ctx);
     ctx->active = true;
-    ctx->editable = new_file ? true : opts->editable;
-    ctx->new_file = new_file;
     ctx->dirty = new_file ? true : false;
     ctx->suppress_events = true;
     ctx->return_screen = opts->return_screen;
     ctx->close_cb = opts->on_close;
     ctx->close_ctx = opts->user_ctx;
 
-    ctx->current_file_offset_kb = second_offset_kb;
-    ctx->lasf_file_offset_kb = first_offset_kb;
-    ctx->max_file_offset_kb = file_size_kb;
+    ctx->window_start = 0;
+    ctx->window_mid = window_mid;
+    ctx->window_end = window_len;
+    ctx->file_size = file_size;
+    ctx->window_line = 0;
 
     ctx->name_dialog = NULL;
+    ctx->goto_dialog = NULL;
+    ctx->goto_textarea = NULL;
+    ctx->find_dialog = NULL;
+    ctx->find_textarea = NULL;
+    ctx->replace_textarea = NULL;
+    ctx->replace_mbox = NULL;
+    ctx->replace_label = NULL;
+    ctx->search_hit = SIZE_MAX;
+    ctx->follow_timer = NULL;
+    ctx->follow_size = file_size;
     ctx->name_textarea = NULL;
     ctx->chunk_mbox = NULL;
     ctx->sd_retry_timer = NULL;
     ctx->at_top_edge = false;
     ctx->at_bottom_edge = false;
+    ctx->prefetched_next = false;
+    ctx->prefetched_prev = false;
     ctx->pending_chunk = false;
-    ctx->pending_first_offset_kb = 0;
-    ctx->pending_second_offset_kb = 0;
-    ctx->pending_scroll_up = false;
+    ctx->pending_start = 0;
+    ctx->pending_anchor = 0;
+    ctx->pending_line = TEXT_VIEWER_LINE_UNKNOWN;
     ctx->waiting_sd = false;
     ctx->sd_retry_action = TEXT_VIEWER_SD_NONE;
     ctx->content_changed = false;
@@ -654,8 +1077,11 @@ esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts)
         text_viewer_set_path_label(ctx, ctx->path);
     }
 
-    lv_textarea_set_text(ctx->text_area, content);
-    text_viewer_set_original(ctx, content);
+    if (text_viewer_set_text(ctx, content, strlen(content)) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "No memory to show %s", ctx->path);
+    }
+    text_viewer_reset_edits(ctx, strlen(content));
     free(content);
     ctx->suppress_events = false;
     if (ctx->new_file)
@@ -669,6 +1095,12 @@ esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts)
     text_viewer_apply_mode(ctx);
     text_viewer_update_slider(ctx);
     lv_screen_load(ctx->screen);
+    lv_obj_update_layout(ctx->screen);
+    text_viewer_update_gutter(ctx);
+    if (!ctx->new_file)
+    {
+        text_viewer_start_index(ctx);
+    }
     if (ctx->new_file)
     {
         lv_textarea_set_cursor_pos(ctx->text_area, 0);
@@ -722,6 +1154,36 @@ static void text_viewer_build_screen(text_viewer_ctx_t *ctx)
     lv_obj_set_style_text_color(save_lbl, UI_COLOR_TEXT_DARK, 0);
     lv_obj_center(save_lbl);
 
+    lv_obj_t *goto_btn = lv_button_create(toolbar);
+    lv_obj_set_style_radius(goto_btn, 6, 0);
+    lv_obj_set_style_pad_all(goto_btn, 6, 0);
+    styles_build_button(goto_btn);
+    lv_obj_add_event_cb(goto_btn, text_viewer_on_goto, LV_EVENT_CLICKED, ctx);
+    lv_obj_t *goto_lbl = lv_label_create(goto_btn);
+    lv_label_set_text(goto_lbl, LV_SYMBOL_RIGHT " Line");
+    lv_obj_set_style_text_color(goto_lbl, UI_COLOR_TEXT_DARK, 0);
+    lv_obj_center(goto_lbl);
+
+    lv_obj_t *find_btn = lv_button_create(toolbar);
+    lv_obj_set_style_radius(find_btn, 6, 0);
+    lv_obj_set_style_pad_all(find_btn, 6, 0);
+    styles_build_button(find_btn);
+    lv_obj_add_event_cb(find_btn, text_viewer_on_find, LV_EVENT_CLICKED, ctx);
+    lv_obj_t *find_lbl = lv_label_create(find_btn);
+    lv_label_set_text(find_lbl, LV_SYMBOL_EYE_OPEN " Find");
+    lv_obj_set_style_text_color(find_lbl, UI_COLOR_TEXT_DARK, 0);
+    lv_obj_center(find_lbl);
+
+    ctx->follow_btn = lv_button_create(toolbar);
+    lv_obj_set_style_radius(ctx->follow_btn, 6, 0);
+    lv_obj_set_style_pad_all(ctx->follow_btn, 6, 0);
+    styles_build_button(ctx->follow_btn);
+    lv_obj_add_event_cb(ctx->follow_btn, text_viewer_on_follow, LV_EVENT_CLICKED, ctx);
+    ctx->follow_label = lv_label_create(ctx->follow_btn);
+    lv_label_set_text(ctx->follow_label, LV_SYMBOL_PLAY " Follow");
+    lv_obj_set_style_text_color(ctx->follow_label, UI_COLOR_TEXT_DARK, 0);
+    lv_obj_center(ctx->follow_label);
+
     lv_obj_t *status_spacer_left = lv_obj_create(toolbar);
     lv_obj_remove_style_all(status_spacer_left);
     lv_obj_set_flex_grow(status_spacer_left, 1);
@@ -773,22 +1235,52 @@ static void text_viewer_build_screen(text_viewer_ctx_t *ctx)
     lv_obj_set_style_pad_right(text_row, slider_gap, 0);
     lv_obj_set_flex_grow(text_row, 1);    
 
-    ctx->text_area = lv_textarea_create(text_row);
-    lv_obj_set_flex_grow(ctx->text_area, 1);
-    lv_obj_set_height(ctx->text_area, LV_PCT(100));
-    lv_obj_set_style_pad_all(ctx->text_area, 0, 0);
-    lv_obj_set_style_bg_color(ctx->text_area, UI_COLOR_CARD_DARK, 0);
-    lv_obj_set_style_bg_opa(ctx->text_area, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_color(ctx->text_area, UI_COLOR_BORDER_DARK, 0);
-    lv_obj_set_style_border_width(ctx->text_area, 1, 0);
-    lv_obj_set_style_text_color(ctx->text_area, UI_COLOR_TEXT_DARK, 0);
-    lv_textarea_set_cursor_click_pos(ctx->text_area, false);
-    lv_obj_set_scrollbar_mode(ctx->text_area, LV_SCROLLBAR_MODE_AUTO);
-    //lv_obj_set_width(ctx->text_area, LV_PCT(100));
-    styles_build_textarea(ctx->text_area);
-    lv_obj_add_event_cb(ctx->text_area, text_viewer_on_text_changed, LV_EVENT_VALUE_CHANGED, ctx);
-    lv_obj_add_event_cb(ctx->text_area, text_viewer_on_text_area_clicked, LV_EVENT_CLICKED, ctx);
-    lv_obj_add_event_cb(ctx->text_area, text_viewer_on_text_scrolled, LV_EVENT_SCROLL, ctx);
+    /* Line numbers: absolutely placed labels, so the column never scrolls on its own */
+    ctx->gutter = lv_obj_create(text_row);
+    lv_obj_remove_style_all(ctx->gutter);
+    lv_obj_set_size(ctx->gutter, 0, LV_PCT(100));
+    lv_obj_clear_flag(ctx->gutter, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_style_text_color(ctx->gutter, UI_COLOR_TEXT_DARK, 0);
+    lv_obj_set_style_text_opa(ctx->gutter, LV_OPA_60, 0);
+    for (size_t i = 0; i < TEXT_VIEWER_GUTTER_ROWS; i++)
+    {
+        lv_obj_t *row = lv_label_create(ctx->gutter);
+        lv_obj_set_width(row, LV_PCT(100));
+        lv_obj_set_style_text_align(row, LV_TEXT_ALIGN_RIGHT, 0);
+        lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+        ctx->gutter_rows[i] = row;
+    }
+
+    /* Viewing draws only the visible lines; the text area (cursor, selection, relayout on every change) is for editing */
+    lv_obj_t *text_obj = NULL;
+    if (ctx->editable)
+    {
+        ctx->text_area = lv_textarea_create(text_row);
+        ctx->line_view = NULL;
+        text_obj = ctx->text_area;
+        lv_textarea_set_cursor_click_pos(ctx->text_area, false);
+        lv_obj_set_scrollbar_mode(ctx->text_area, LV_SCROLLBAR_MODE_AUTO);
+        lv_obj_add_event_cb(ctx->text_area, text_viewer_on_text_insert, LV_EVENT_INSERT, ctx);
+        lv_obj_add_event_cb(ctx->text_area, text_viewer_on_text_changed, LV_EVENT_VALUE_CHANGED, ctx);
+        lv_obj_add_event_cb(ctx->text_area, text_viewer_on_text_area_clicked, LV_EVENT_CLICKED, ctx);
+    }
+    else
+    {
+        ctx->line_view = text_line_view_create(text_row);
+        ctx->text_area = NULL;
+        text_obj = ctx->line_view;
+    }
+    lv_obj_set_flex_grow(text_obj, 1);
+    lv_obj_set_height(text_obj, LV_PCT(100));
+    lv_obj_set_style_pad_all(text_obj, 0, 0);
+    lv_obj_set_style_bg_color(text_obj, UI_COLOR_CARD_DARK, 0);
+    lv_obj_set_style_bg_opa(text_obj, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_color(text_obj, UI_COLOR_BORDER_DARK, 0);
+    lv_obj_set_style_border_width(text_obj, 1, 0);
+    lv_obj_set_style_text_color(text_obj, UI_COLOR_TEXT_DARK, 0);
+    styles_build_textarea(text_obj);
+    lv_obj_add_event_cb(text_obj, text_viewer_on_text_scrolled, LV_EVENT_SCROLL, ctx);
+    lv_obj_set_style_text_font(ctx->gutter, lv_obj_get_style_text_font(text_obj, LV_PART_MAIN), 0);
     
     lv_obj_t *list_slider = lv_slider_create(text_row);
     lv_slider_set_orientation(list_slider, LV_SLIDER_ORIENTATION_VERTICAL);
@@ -838,21 +1330,50 @@ static void text_viewer_apply_mode(text_viewer_ctx_t *ctx)
         lv_obj_add_flag(ctx->text_area, LV_OBJ_FLAG_CLICK_FOCUSABLE);
         text_viewer_hide_keyboard(ctx);
         lv_obj_clear_flag(ctx->save_btn, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_add_flag(ctx->follow_btn, LV_OBJ_FLAG_HIDDEN);
         lv_textarea_set_cursor_pos(ctx->text_area, 0);
     }
     else
     {
-        lv_textarea_set_cursor_click_pos(ctx->text_area, false);
-        lv_obj_clear_flag(ctx->text_area, LV_OBJ_FLAG_CLICK_FOCUSABLE);
         text_viewer_hide_keyboard(ctx);
         lv_obj_add_flag(ctx->save_btn, LV_OBJ_FLAG_HIDDEN);
-        lv_textarea_clear_selection(ctx->text_area);
-        lv_textarea_set_cursor_pos(ctx->text_area, 0);
+        lv_obj_clear_flag(ctx->follow_btn, LV_OBJ_FLAG_HIDDEN);
+    }
+    if (ctx->text_area)
+    {
+        lv_obj_scroll_to_y(ctx->text_area, 0, LV_ANIM_OFF);
+    }
+    else
+    {
+        text_line_view_scroll_to(ctx->line_view, 0);
     }
-    lv_obj_scroll_to_y(ctx->text_area, 0, LV_ANIM_OFF);
     text_viewer_update_buttons(ctx);
 }
 
+static const char *text_viewer_text(text_viewer_ctx_t *ctx)
+{
+    if (ctx->line_view)
+    {
+        return text_line_view_get_text(ctx->line_view, NULL);
+    }
+    return ctx->text_area ? lv_textarea_get_text(ctx->text_area) : "";
+}
+
+static esp_err_t text_viewer_set_text(text_viewer_ctx_t *ctx, const char *text, size_t len)
+{
+    if (ctx->line_view)
+    {
+        return text_line_view_set_text(ctx->line_view, text, len);
+    }
+    lv_textarea_set_text(ctx->text_area, text);
+    return ESP_OK;
+}
+
+static lv_obj_t *text_viewer_text_obj(text_viewer_ctx_t *ctx)
+{
+    return ctx->line_view ? ctx->line_view : ctx->text_area;
+}
+
 static void text_viewer_set_status(text_viewer_ctx_t *ctx, const char *msg)
 {
     if (ctx->status_label && msg)
@@ -927,20 +1448,136 @@ static void text_viewer_restart_path_scroll(text_viewer_ctx_t *ctx)
     }
 }
 
-static void text_viewer_set_original(text_viewer_ctx_t *ctx, const char *text)
+static void text_viewer_reset_edits(text_viewer_ctx_t *ctx, size_t len)
+{
+    ctx->edits.orig_len = len;
+    ctx->edits.cur_len = len;
+    ctx->edits.start = len;
+    ctx->edits.tail = len;
+    ctx->edits.mark_char = 0;
+    ctx->edits.mark_byte = 0;
+}
+
+static void text_viewer_record_edit(text_viewer_edits_t *edits, size_t pos, size_t len, bool del)
+{
+    size_t end = del ? pos + len : pos;     /* First byte after the edit that stays untouched */
+    if (end > edits->cur_len)
+    {
+        end = edits->cur_len;
+    }
+    if (pos < edits->start)
+    {
+        edits->start = pos;
+    }
+    if (edits->cur_len - end < edits->tail)
+    {
+        edits->tail = edits->cur_len - end;
+    }
+    edits->cur_len = del ? edits->cur_len - (end - pos) : edits->cur_len + len;
+}
+
+static bool text_viewer_edits_dirty(const text_viewer_edits_t *edits)
+{
+    return edits->cur_len != edits->orig_len || edits->start + edits->tail < edits->cur_len;
+}
+
+static void text_viewer_edit_range(const text_viewer_edits_t *edits, size_t *start, size_t *old_len, size_t *new_len)
+{
+    size_t shortest = (edits->orig_len < edits->cur_len) ? edits->orig_len : edits->cur_len;
+    size_t head = (edits->start < shortest) ? edits->start : shortest;
+    size_t tail = (edits->tail < shortest - head) ? edits->tail : shortest - head;
+    *start = head;
+    *old_len = edits->orig_len - head - tail;
+    *new_len = edits->cur_len - head - tail;
+}
+
+static uint32_t text_viewer_utf8_index(const char *text, size_t byte_pos)
+{
+    uint32_t index = 0;
+    for (size_t i = 0; i < byte_pos && text[i] != '\0'; i++)
+    {
+        if ((text[i] & 0xC0) != 0x80)
+        {
+            index++;
+        }
+    }
+    return index;
+}
+
+static size_t text_viewer_utf8_offset(const char *text, uint32_t char_pos)
 {
-    free(ctx->original_text);
-    ctx->original_text = text ? strdup(text) : NULL;
+    size_t i = 0;
+    while (text[i] != '\0' && char_pos > 0)
+    {
+        i++;
+        while ((text[i] & 0xC0) == 0x80)
+        {
+            i++; /* Skip continuation bytes */
+        }
+        char_pos--;
+    }
+    return i;
+}
+
+static size_t text_viewer_cursor_offset(text_viewer_edits_t *edits, const char *text, uint32_t char_pos)
+{
+    uint32_t c = edits->mark_char;
+    size_t b = edits->mark_byte;
+    if (b > edits->cur_len)
+    {
+        c = 0;
+        b = 0;
+    }
+    while (c > char_pos && b > 0)
+    {
+        b--;
+        while (b > 0 && (text[b] & 0xC0) == 0x80)
+        {
+            b--; /* Back over continuation bytes */
+        }
+        c--;
+    }
+    while (c < char_pos && text[b] != '\0')
+    {
+        b++;
+        while ((text[b] & 0xC0) == 0x80)
+        {
+            b++; /* Skip continuation bytes */
+        }
+        c++;
+    }
+    edits->mark_char = c;
+    edits->mark_byte = b;
+    return b;
 }
 
 static void text_viewer_get_slider_params(text_viewer_ctx_t *ctx, size_t *window_size, size_t *step)
 {
-    (void)ctx;
     if (!window_size || !step) {
         return;
     }
-    *window_size = 2; /* two adjacent chunks = one window */
-    *step = 1;        /* one chunk per step */
+    *window_size = ctx->index_ready ? 1 : 2; /* a window opens at any checkpoint, or spans two chunks */
+    *step = 1;                               /* one checkpoint / chunk per step */
+}
+
+static size_t text_viewer_slider_total(text_viewer_ctx_t *ctx)
+{
+    if (ctx->window_start == 0 && ctx->window_end >= ctx->file_size) {
+        return 1; /* Whole file loaded */
+    }
+    if (ctx->index_ready) {
+        return ctx->index.count;
+    }
+    size_t total_chunks = (ctx->file_size + READ_CHUNK_SIZE_B - 1) / READ_CHUNK_SIZE_B; /* slider steps are chunk-sized */
+    return total_chunks ? total_chunks : 1;
+}
+
+static size_t text_viewer_slider_current(text_viewer_ctx_t *ctx)
+{
+    if (ctx->index_ready && ctx->window_line != TEXT_VIEWER_LINE_UNKNOWN) {
+        return ctx->window_line / ctx->index.stride;
+    }
+    return ctx->window_start / READ_CHUNK_SIZE_B;
 }
 
 static void text_viewer_update_slider(text_viewer_ctx_t *ctx)
@@ -953,11 +1590,7 @@ static void text_viewer_update_slider(text_viewer_ctx_t *ctx)
     size_t step = 1;
     text_viewer_get_slider_params(ctx, &window_size, &step);
 
-    size_t total_chunks = ctx->max_file_offset_kb + 1; /* offsets are in KB chunks */
-    if (total_chunks == 0) {
-        total_chunks = 1;
-    }
-
+    size_t total_chunks = text_viewer_slider_total(ctx);
     if (total_chunks <= window_size) {
         bool prev = ctx->slider_suppress_change;
         ctx->slider_suppress_change = true;
@@ -974,7 +1607,7 @@ static void text_viewer_update_slider(text_viewer_ctx_t *ctx)
     size_t max_step_index = step ? ((max_start + step - 1) / step) : 0;
     int32_t max_val = (int32_t)max_step_index;
 
-    size_t current_start = ctx->lasf_file_offset_kb;
+    size_t current_start = text_viewer_slider_current(ctx);
     if (current_start > max_start) {
         current_start = max_start;
     }
@@ -1005,10 +1638,7 @@ static void text_viewer_on_slider_value_changed(lv_event_t *e)
     size_t window_size = 1;
     size_t step = 1;
     text_viewer_get_slider_params(ctx, &window_size, &step);
-    size_t total_chunks = ctx->max_file_offset_kb + 1;
-    if (total_chunks == 0) {
-        total_chunks = 1;
-    }
+    size_t total_chunks = text_viewer_slider_total(ctx);
     if (total_chunks <= window_size) {
         return; /* Nothing to scroll */
     }
@@ -1056,7 +1686,7 @@ static void text_viewer_on_slider_value_changed(lv_event_t *e)
             target_step = max_step_index;
         }
 
-        size_t current_start = ctx->lasf_file_offset_kb;
+        size_t current_start = text_viewer_slider_current(ctx);
         if (current_start > max_start) {
             current_start = max_start;
         }
@@ -1076,82 +1706,262 @@ static void text_viewer_on_slider_value_changed(lv_event_t *e)
             new_start = max_start;
         }
 
-        size_t first_offset = new_start;
-        size_t second_offset = first_offset + (window_size > 1 ? (window_size - 1) : 0);
-        if (second_offset > ctx->max_file_offset_kb) {
-            second_offset = ctx->max_file_offset_kb;
-        }
-        if (window_size > 1 && second_offset == first_offset && first_offset > 0) {
-            first_offset -= 1;
-        }
-
-        bool from_top = target_step < current_step;
         ctx->slider_pending_step = SIZE_MAX;
         ctx->slider_drag_active = false;
-        text_viewer_request_chunk_load(ctx, first_offset, second_offset, from_top);
+
+        if (ctx->index_ready) {
+            /* Checkpoints are line starts: open the window right there */
+            size_t offset = ctx->index.offsets[new_start];
+            text_viewer_request_chunk_load(ctx, offset, offset, (uint32_t)new_start * ctx->index.stride);
+            return;
+        }
+
+        /* Snap the slider position to the next line start so the window never opens mid-character */
+        size_t start = 0;
+        esp_err_t err = fs_text_chunk_align(ctx->path, new_start * READ_CHUNK_SIZE_B, &start);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to align chunk: %s", esp_err_to_name(err));
+            text_viewer_update_slider(ctx);
+            return;
+        }
+        text_viewer_request_chunk_load(ctx, start, start, TEXT_VIEWER_LINE_UNKNOWN);
     }
 }
 
-static esp_err_t text_viewer_load_window(text_viewer_ctx_t *ctx, size_t first_offset_kb, size_t second_offset_kb)
+static esp_err_t text_viewer_read_window(const char *path, size_t start, char **out, size_t *len, size_t *mid)
 {
-    if (!ctx || ctx->path[0] == '\0')
+    char *joined = (char *)malloc(2 * READ_CHUNK_SIZE_B + 1);
+    if (!joined)
     {
-        return ESP_ERR_INVALID_ARG;
+        return ESP_ERR_NO_MEM;
     }
 
-    char *chunk_a = NULL;
-    char *chunk_b = NULL;
-    char *joined = NULL;
     size_t len_a = 0;
     size_t len_b = 0;
-
-    esp_err_t err = fs_text_read_range(ctx->path, first_offset_kb, &chunk_a, &len_a);
+    esp_err_t err = fs_text_cache_read(path, start, joined, &len_a);
+    if (err == ESP_OK)
+    {
+        /* The second chunk starts exactly where the first one was cut */
+        err = fs_text_cache_read(path, start + len_a, joined + len_a, &len_b);
+    }
     if (err != ESP_OK)
     {
-        goto cleanup;
+        free(joined);
+        return err;
     }
 
-    if (second_offset_kb != first_offset_kb)
+    *out = joined;
+    *len = len_a + len_b;
+    *mid = len_a;
+    return ESP_OK;
+}
+
+static esp_err_t text_viewer_load_window(text_viewer_ctx_t *ctx, size_t start, uint32_t line)
+{
+    if (!ctx || ctx->path[0] == '\0')
     {
-        err = fs_text_read_range(ctx->path, second_offset_kb, &chunk_b, &len_b);
-        if (err != ESP_OK)
-        {
-            goto cleanup;
-        }
+        return ESP_ERR_INVALID_ARG;
     }
 
-    size_t total = len_a + len_b;
-    joined = (char *)malloc(total + 1);
-    if (!joined)
+    char *joined = NULL;
+    size_t total = 0;
+    size_t mid = 0;
+    esp_err_t err = text_viewer_read_window(ctx->path, start, &joined, &total, &mid);
+    if (err != ESP_OK)
     {
-        err = ESP_ERR_NO_MEM;
-        goto cleanup;
+        return err;
     }
 
-    if (len_a)
+    /* Count the line number across from the window being replaced where the two overlap */
+    if (line == TEXT_VIEWER_LINE_UNKNOWN && ctx->window_line != TEXT_VIEWER_LINE_UNKNOWN)
     {
-        memcpy(joined, chunk_a, len_a);
+        if (start >= ctx->window_start && start <= ctx->window_end && !text_viewer_edits_dirty(&ctx->edits))
+        {
+            const char *old_text = text_viewer_text(ctx);
+            line = ctx->window_line + (uint32_t)fs_text_count_newlines(old_text, start - ctx->window_start);
+        }
+        else if (start < ctx->window_start && ctx->window_start - start <= total)
+        {
+            uint32_t before = (uint32_t)fs_text_count_newlines(joined, ctx->window_start - start);
+            line = (before <= ctx->window_line) ? ctx->window_line - before : TEXT_VIEWER_LINE_UNKNOWN;
+        }
     }
-    if (len_b)
+    if (line == TEXT_VIEWER_LINE_UNKNOWN && ctx->index_ready && start <= ctx->index.size &&
+        fs_text_index_offset_line(ctx->path, &ctx->index, start, &line) != ESP_OK)
     {
-        memcpy(joined + len_a, chunk_b, len_b);
+        line = TEXT_VIEWER_LINE_UNKNOWN;
     }
-    joined[total] = '\0';
 
     bool prev_suppress = ctx->suppress_events;
     ctx->suppress_events = true;
-    lv_textarea_set_text(ctx->text_area, joined);
-    text_viewer_set_original(ctx, joined);
+    err = text_viewer_set_text(ctx, joined, total);
+    if (err != ESP_OK)
+    {
+        ctx->suppress_events = prev_suppress;
+        free(joined);
+        return err;
+    }
+    text_viewer_reset_edits(ctx, total);
+    ctx->window_line = line;
+    ctx->window_start = start;
+    ctx->window_mid = start + mid;
+    ctx->window_end = start + total;
+    ctx->prefetched_next = false;
+    ctx->prefetched_prev = false;
     ctx->dirty = false;
     text_viewer_update_buttons(ctx);
 
     ctx->suppress_events = prev_suppress;
-
-cleanup:
     free(joined);
-    free(chunk_a);
-    free(chunk_b);
-    return err;
+    return ESP_OK;
+}
+
+static void text_viewer_start_index(text_viewer_ctx_t *ctx)
+{
+    fs_text_index_free(&ctx->index);
+    ctx->index_ready = false;
+    esp_err_t err = fs_text_index_start(ctx->path);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Line index not started: %s", esp_err_to_name(err));
+        return;
+    }
+    if (!ctx->index_timer)
+    {
+        ctx->index_timer = lv_timer_create(text_viewer_on_index_timer, TEXT_VIEWER_INDEX_POLL_MS, ctx);
+    }
+}
+
+static void text_viewer_on_index_timer(lv_timer_t *timer)
+{
+    text_viewer_ctx_t *ctx = lv_timer_get_user_data(timer);
+    fs_text_index_t index;
+    esp_err_t err = fs_text_index_poll(&index);
+    if (err == ESP_ERR_NOT_FINISHED)
+    {
+        return;
+    }
+    lv_timer_del(timer);
+    ctx->index_timer = NULL;
+    if (err != ESP_OK)
+    {
+        if (err != ESP_ERR_INVALID_STATE)
+        {
+            ESP_LOGW(TAG, "Line index unavailable: %s", esp_err_to_name(err));
+        }
+        return;
+    }
+
+    fs_text_index_free(&ctx->index);
+    ctx->index = index;
+    ctx->index_ready = true;
+    if (ctx->window_line == TEXT_VIEWER_LINE_UNKNOWN &&
+        fs_text_index_offset_line(ctx->path, &ctx->index, ctx->window_start, &ctx->window_line) != ESP_OK)
+    {
+        ctx->window_line = TEXT_VIEWER_LINE_UNKNOWN;
+    }
+    text_viewer_update_gutter(ctx);
+    if (!ctx->slider_drag_active)
+    {
+        text_viewer_update_slider(ctx);
+    }
+}
+
+static void text_viewer_update_gutter(text_viewer_ctx_t *ctx)
+{
+    if (!ctx->gutter)
+    {
+        return;
+    }
+
+    size_t row = 0;
+    if (ctx->window_line != TEXT_VIEWER_LINE_UNKNOWN)
+    {
+        const char *text = text_viewer_text(ctx);
+        size_t len = strlen(text);
+
+        /* Wide enough for the largest number this file can show */
+        uint32_t last = ctx->window_line + (uint32_t)fs_text_count_newlines(text, len) + 1;
+        if (ctx->index_ready && ctx->index.lines > last)
+        {
+            last = ctx->index.lines;
+        }
+        int32_t digits = 3;
+        for (uint32_t n = last / 1000; n > 0; n /= 10)
+        {
+            digits++;
+        }
+        const lv_font_t *font = lv_obj_get_style_text_font(ctx->gutter, LV_PART_MAIN);
+        int32_t width = digits * lv_font_get_glyph_width(font, '0', '\0') + 4;
+        if (lv_obj_get_width(ctx->gutter) != width)
+        {
+            lv_obj_set_width(ctx->gutter, width);
+            lv_obj_update_layout(ctx->screen);
+        }
+
+        lv_obj_t *label = ctx->text_area ? lv_textarea_get_label(ctx->text_area) : NULL;
+        lv_area_t view;
+        lv_area_t label_area = {0};
+        lv_area_t gutter_area;
+        lv_obj_get_content_coords(text_viewer_text_obj(ctx), &view);
+        if (label)
+        {
+            lv_obj_get_coords(label, &label_area);
+        }
+        lv_obj_get_coords(ctx->gutter, &gutter_area);
+
+        /* Start with the logical line the top row belongs to (it may be wrapped) */
+        size_t pos = text_viewer_top_offset(ctx) - ctx->window_start;
+        while (pos > 0 && text[pos - 1] != '\n')
+        {
+            pos--;
+        }
+        uint32_t line = ctx->window_line + (uint32_t)fs_text_count_newlines(text, pos);
+        uint32_t char_id = label ? text_viewer_utf8_index(text, pos) : 0; // Only the text area counts in characters
+
+        while (row < TEXT_VIEWER_GUTTER_ROWS)
+        {
+            int32_t y = 0;
+            if (ctx->line_view)
+            {
+                if (!text_line_view_get_row_y(ctx->line_view, pos, &y))
+                {
+                    break;
+                }
+                y += view.y1;
+            }
+            else
+            {
+                lv_point_t letter = {0};
+                lv_label_get_letter_pos(label, char_id, &letter);
+                y = label_area.y1 + letter.y;
+            }
+            if (y > view.y2)
+            {
+                break;
+            }
+            lv_obj_t *number = ctx->gutter_rows[row++];
+            lv_label_set_text_fmt(number, "%" PRIu32, line + 1);
+            lv_obj_set_y(number, y - gutter_area.y1);
+            lv_obj_clear_flag(number, LV_OBJ_FLAG_HIDDEN);
+
+            const char *nl = memchr(text + pos, '\n', len - pos);
+            if (!nl)
+            {
+                break;
+            }
+            if (label)
+            {
+                char_id += text_viewer_utf8_index(text + pos, (size_t)(nl - text) + 1 - pos);
+            }
+            pos = (size_t)(nl - text) + 1;
+            line++;
+        }
+    }
+    for (; row < TEXT_VIEWER_GUTTER_ROWS; row++)
+    {
+        lv_obj_add_flag(ctx->gutter_rows[row], LV_OBJ_FLAG_HIDDEN);
+    }
 }
 
 static void text_viewer_update_buttons(text_viewer_ctx_t *ctx)
@@ -1172,7 +1982,7 @@ static void text_viewer_update_buttons(text_viewer_ctx_t *ctx)
 
 static void text_viewer_show_keyboard(text_viewer_ctx_t *ctx, lv_obj_t *target)
 {
-    if (!ctx || !ctx->editable)
+    if (!ctx || (!ctx->editable && !ctx->goto_dialog && !ctx->find_dialog))
     {
         return;
     }
@@ -1213,12 +2023,67 @@ static void text_viewer_on_text_area_clicked(lv_event_t *e)
     text_viewer_show_keyboard(ctx, ctx->text_area);
 }
 
-static void text_viewer_skip_cursor_animation(text_viewer_ctx_t *ctx)
+static size_t text_viewer_top_offset(text_viewer_ctx_t *ctx)
+{
+    if (ctx->line_view)
+    {
+        return ctx->window_start + text_line_view_get_top(ctx->line_view);
+    }
+    lv_obj_t *label = lv_textarea_get_label(ctx->text_area);
+    lv_area_t view;
+    lv_area_t label_area;
+    lv_obj_get_content_coords(ctx->text_area, &view);
+    lv_obj_get_coords(label, &label_area);
+
+    lv_point_t pos = {
+        .x = 0,
+        .y = (view.y1 > label_area.y1) ? view.y1 - label_area.y1 : 0,
+    };
+    uint32_t char_id = lv_label_get_letter_on(label, &pos, false);
+    return ctx->window_start + text_viewer_utf8_offset(lv_textarea_get_text(ctx->text_area), char_id);
+}
+
+static void text_viewer_scroll_to_offset(text_viewer_ctx_t *ctx, size_t offset)
+{
+    size_t rel = (offset > ctx->window_start) ? offset - ctx->window_start : 0;
+    if (ctx->line_view)
+    {
+        text_line_view_scroll_to(ctx->line_view, rel);
+        text_viewer_update_gutter(ctx);
+        return;
+    }
+    uint32_t char_id = text_viewer_utf8_index(lv_textarea_get_text(ctx->text_area), rel);
+    lv_textarea_set_cursor_pos(ctx->text_area, (int32_t)char_id);
+    lv_obj_update_layout(ctx->text_area);
+
+    // Put that line at the top right away (this also drops the cursor's scroll animation)
+    lv_obj_t *label = lv_textarea_get_label(ctx->text_area);
+    lv_point_t letter = {0};
+    lv_area_t view;
+    lv_area_t label_area;
+    lv_label_get_letter_pos(label, char_id, &letter);
+    lv_obj_get_content_coords(ctx->text_area, &view);
+    lv_obj_get_coords(label, &label_area);
+    lv_obj_scroll_by_bounded(ctx->text_area, 0, view.y1 - (label_area.y1 + letter.y), LV_ANIM_OFF);
+    text_viewer_update_gutter(ctx);
+}
+
+static int32_t text_viewer_scroll_top(text_viewer_ctx_t *ctx)
 {
-    // Jump to the new cursor position immediately (skip the default scroll animation)
-    lv_point_t target_scroll = {0};
-    lv_obj_get_scroll_end(ctx->text_area, &target_scroll);
-    lv_obj_scroll_to(ctx->text_area, target_scroll.x, target_scroll.y, LV_ANIM_OFF);    
+    if (ctx->line_view)
+    {
+        return text_line_view_get_scroll_top(ctx->line_view);
+    }
+    return lv_obj_get_scroll_top(ctx->text_area);
+}
+
+static int32_t text_viewer_scroll_bottom(text_viewer_ctx_t *ctx)
+{
+    if (ctx->line_view)
+    {
+        return text_line_view_get_scroll_bottom(ctx->line_view);
+    }
+    return lv_obj_get_scroll_bottom(ctx->text_area);
 }
 
 static void text_viewer_on_text_scrolled(lv_event_t *e)
@@ -1228,6 +2093,7 @@ static void text_viewer_on_text_scrolled(lv_event_t *e)
     {
         return;
     }
+    text_viewer_update_gutter(ctx);
     if (ctx->waiting_sd)
     {
         return;
@@ -1237,18 +2103,40 @@ static void text_viewer_on_text_scrolled(lv_event_t *e)
         return;
     }
 
-    bool at_top = lv_obj_get_scroll_top(ctx->text_area) <= 0;
-    bool at_bottom = lv_obj_get_scroll_bottom(ctx->text_area) <= 0;
+    int32_t scroll_top = text_viewer_scroll_top(ctx);
+    int32_t scroll_bottom = text_viewer_scroll_bottom(ctx);
+    bool at_top = scroll_top <= 0;
+    bool at_bottom = scroll_bottom <= 0;
+
+    /* Within a screen of an edge: have the read-ahead task fetch what the swap will need */
+    int32_t view_h = lv_obj_get_content_height(text_viewer_text_obj(ctx));
+    if (!ctx->new_file && !ctx->prefetched_next && scroll_bottom < view_h && ctx->window_end < ctx->file_size)
+    {
+        ctx->prefetched_next = true;
+        fs_text_cache_prefetch(ctx->window_end, SIZE_MAX);
+    }
+    if (!ctx->new_file && !ctx->prefetched_prev && scroll_top < view_h && ctx->window_start > 0)
+    {
+        ctx->prefetched_prev = true;
+        fs_text_cache_prefetch(SIZE_MAX, ctx->window_start);
+    }
 
     if (at_top && !ctx->at_top_edge)
     {
         ctx->at_top_edge = true;
 
-        if (!ctx->new_file && ctx->lasf_file_offset_kb > 0)
+        if (!ctx->new_file && ctx->window_start > 0)
         {
-            size_t new_first = ctx->lasf_file_offset_kb - 1;
-            size_t new_second = ctx->lasf_file_offset_kb;
-            text_viewer_request_chunk_load(ctx, new_first, new_second, true);
+            size_t start = 0;
+            esp_err_t err = fs_text_cache_before(ctx->path, ctx->window_start, &start);
+            if (err == ESP_OK)
+            {
+                text_viewer_request_chunk_load(ctx, start, text_viewer_top_offset(ctx), TEXT_VIEWER_LINE_UNKNOWN);
+            }
+            else
+            {
+                ESP_LOGE(TAG, "Failed to find previous chunk: %s", esp_err_to_name(err));
+            }
         }
     }
     else if (!at_top)
@@ -1260,11 +2148,9 @@ static void text_viewer_on_text_scrolled(lv_event_t *e)
     {
         ctx->at_bottom_edge = true;
 
-        if (!ctx->new_file && ctx->current_file_offset_kb < ctx->max_file_offset_kb)
+        if (!ctx->new_file && ctx->window_end < ctx->file_size)
         {
-            size_t next_offset = ctx->current_file_offset_kb + 1;
-            size_t first_offset = ctx->current_file_offset_kb;
-            text_viewer_request_chunk_load(ctx, first_offset, next_offset, false);
+            text_viewer_request_chunk_load(ctx, ctx->window_mid, text_viewer_top_offset(ctx), TEXT_VIEWER_LINE_UNKNOWN);
         }
     }
     else if (!at_bottom)
@@ -1296,6 +2182,16 @@ static void text_viewer_on_name_textarea_clicked(lv_event_t *e)
 static void text_viewer_on_keyboard_ready(lv_event_t *e)
 {
     text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (ctx && ctx->goto_dialog)
+    {
+        text_viewer_on_goto_dialog(e);
+        return;
+    }
+    if (ctx && ctx->find_dialog)
+    {
+        text_viewer_on_find_dialog(e);
+        return;
+    }
     if (!ctx || !ctx->editable)
     {
         return;
@@ -1310,7 +2206,7 @@ static void text_viewer_on_screen_clicked(lv_event_t *e)
     {
         return;
     }
-    if (ctx->name_dialog)
+    if (ctx->name_dialog || ctx->goto_dialog || ctx->find_dialog)
     {
         return;
     }
@@ -1334,9 +2230,8 @@ static void text_viewer_on_text_changed(lv_event_t *e)
     {
         return;
     }
-    const char *text = lv_textarea_get_text(ctx->text_area);
-    const char *orig = ctx->original_text ? ctx->original_text : "";
-    bool dirty = strcmp(text, orig) != 0;
+    text_viewer_update_gutter(ctx);
+    bool dirty = text_viewer_edits_dirty(&ctx->edits);
     if (dirty != ctx->dirty)
     {
         ctx->dirty = dirty;
@@ -1345,6 +2240,34 @@ static void text_viewer_on_text_changed(lv_event_t *e)
     }
 }
 
+static void text_viewer_on_text_insert(lv_event_t *e)
+{
+    text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    const char *txt = lv_event_get_param(e);
+    if (!ctx || !ctx->editable || ctx->suppress_events || !txt)
+    {
+        return;
+    }
+
+    const char *text = lv_textarea_get_text(ctx->text_area);
+    uint32_t cursor = lv_textarea_get_cursor_pos(ctx->text_area);
+    size_t pos = text_viewer_cursor_offset(&ctx->edits, text, cursor);
+    if (txt[0] == LV_KEY_DEL && txt[1] == '\0')
+    {
+        /* Backspace removes the character before the cursor; the mark stays in front of it */
+        if (cursor == 0)
+        {
+            return;
+        }
+        size_t prev = text_viewer_cursor_offset(&ctx->edits, text, cursor - 1);
+        text_viewer_record_edit(&ctx->edits, prev, pos - prev, true);
+    }
+    else
+    {
+        text_viewer_record_edit(&ctx->edits, pos, strlen(txt), false);
+    }
+}
+
 static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
 {
     if (!ctx)
@@ -1374,25 +2297,23 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
         return;
     }
 
-    const char *dest_path = ctx->path;
-    size_t first_kb = ctx->lasf_file_offset_kb;
-    size_t second_kb = ctx->current_file_offset_kb;
-    size_t chunk_count = (second_kb > first_kb) ? (second_kb - first_kb + 1u) : 1u;
-
-    /* Compute byte window for the currently loaded textarea (two chunks) */
-    if (first_kb > SIZE_MAX / 1024u || chunk_count > SIZE_MAX / READ_CHUNK_SIZE_B)
-    {
-        text_viewer_set_status(ctx, "Range overflow");
-        return;
-    }
-    size_t window_start = first_kb * 1024u;
-    size_t window_span = chunk_count * READ_CHUNK_SIZE_B;
-    size_t window_end = window_start + window_span;
-    if (window_end < window_start)
+    /* The index is rebuilt after the save; a scan racing the write could persist a stale one */
+    fs_text_index_stop();
+    text_viewer_stop_search(ctx);
+    /* The ring holds the file open: close it for the write and reopen it on the new contents */
+    fs_text_cache_close();
+    text_viewer_write_window(ctx, text);
+    if (fs_text_cache_open(ctx->path) != ESP_OK)
     {
-        text_viewer_set_status(ctx, "Range overflow");
-        return;
+        ESP_LOGW(TAG, "No read-ahead for %s, reading chunks on demand", ctx->path);
     }
+}
+
+static void text_viewer_write_window(text_viewer_ctx_t *ctx, const char *text)
+{
+    const char *dest_path = ctx->path;
+    size_t window_start = ctx->window_start;
+    size_t window_end = ctx->window_end;
 
     struct stat st = {0};
     bool have_existing = (stat(dest_path, &st) == 0 && S_ISREG(st.st_mode));
@@ -1411,13 +2332,36 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
     size_t prefix_size = window_start;
     size_t suffix_start = window_end;
     size_t suffix_size = (suffix_start < file_size) ? (file_size - suffix_start) : 0u;
+    size_t text_len = strlen(text);
 
-    /* Build temp path in same dir for atomic-ish replacement */
-    char dir[FS_TEXT_MAX_PATH];
-    const char *slash = strrchr(dest_path, '/');
-    if (slash)
+    /* Patch only what changed when the edit log still describes this window */
+    bool have_edits = ctx->edits.orig_len == window_end - window_start && ctx->edits.cur_len == text_len;
+    size_t edit_start = 0;
+    size_t old_len = 0;
+    size_t new_len = 0;
+    text_viewer_edit_range(&ctx->edits, &edit_start, &old_len, &new_len);
+    if (have_existing && have_edits)
     {
-        size_t dir_len = (size_t)(slash - dest_path);
+        esp_err_t err = fs_text_patch(dest_path, window_start + edit_start, old_len, text + edit_start, new_len);
+        if (err == ESP_OK)
+        {
+            goto save_done;
+        }
+        if (err != ESP_ERR_NO_MEM && err != ESP_ERR_INVALID_ARG)
+        {
+            text_viewer_set_status(ctx, "Write failed");
+            ESP_LOGE(TAG, "Failed to patch %s (%s)", dest_path, esp_err_to_name(err));
+            text_viewer_schedule_sd_retry(ctx, TEXT_VIEWER_SD_SAVE);
+            return;
+        }
+    }
+
+    /* Build temp path in same dir for atomic-ish replacement */
+    char dir[FS_TEXT_MAX_PATH];
+    const char *slash = strrchr(dest_path, '/');
+    if (slash)
+    {
+        size_t dir_len = (size_t)(slash - dest_path);
         if (dir_len == 0)
         {
             dir[0] = '/';
@@ -1448,11 +2392,15 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
     }
     remove(tmp_path);
 
-    FILE *src = NULL;
+    fs_text_reader_t reader;
+    fs_text_reader_t *src = NULL;
     if (have_existing)
     {
-        src = fopen(dest_path, "rb");
-        if (!src)
+        if (fs_text_reader_open(&reader, dest_path) == ESP_OK)
+        {
+            src = &reader;
+        }
+        else
         {
             text_viewer_set_status(ctx, "Open failed");
             ESP_LOGE(TAG, "Failed to open %s for patching", dest_path);
@@ -1464,10 +2412,7 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
     FILE *tmp = fopen(tmp_path, "wb");
     if (!tmp)
     {
-        if (src)
-        {
-            fclose(src);
-        }
+        fs_text_reader_close(src);
         text_viewer_set_status(ctx, "Temp open failed");
         ESP_LOGE(TAG, "Failed to open %s", tmp_path);
         text_viewer_schedule_sd_retry(ctx, TEXT_VIEWER_SD_SAVE);
@@ -1475,11 +2420,11 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
     }
 
     char buf[READ_CHUNK_SIZE_B];
-    size_t remaining = prefix_size;
-    while (remaining > 0)
+    size_t got = 0;
+    for (size_t offset = 0; offset < prefix_size; offset += got)
     {
-        size_t chunk = remaining > sizeof(buf) ? sizeof(buf) : remaining;
-        if (!src || fread(buf, 1, chunk, src) != chunk)
+        size_t chunk = prefix_size - offset > sizeof(buf) ? sizeof(buf) : prefix_size - offset;
+        if (!src || fs_text_reader_pread(src, offset, buf, chunk, &got) != ESP_OK || got != chunk)
         {
             text_viewer_set_status(ctx, "Read failed");
             ESP_LOGE(TAG, "Failed to read prefix from %s", dest_path);
@@ -1493,10 +2438,8 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
             text_viewer_schedule_sd_retry(ctx, TEXT_VIEWER_SD_SAVE);
             goto save_cleanup;
         }
-        remaining -= chunk;
     }
 
-    size_t text_len = strlen(text);
     if (text_len > 0)
     {
         if (fwrite(text, 1, text_len, tmp) != text_len)
@@ -1510,20 +2453,10 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
 
     if (suffix_size > 0 && src)
     {
-        if (fseek(src, (long)suffix_start, SEEK_SET) != 0)
+        for (size_t offset = suffix_start; offset < file_size; offset += got)
         {
-            text_viewer_set_status(ctx, "Seek failed");
-            ESP_LOGE(TAG, "Failed to seek %s to %zu", dest_path, suffix_start);
-            text_viewer_schedule_sd_retry(ctx, TEXT_VIEWER_SD_SAVE);
-            goto save_cleanup;
-        }
-
-        remaining = suffix_size;
-        while (remaining > 0)
-        {
-            size_t chunk = remaining > sizeof(buf) ? sizeof(buf) : remaining;
-            size_t got = fread(buf, 1, chunk, src);
-            if (got != chunk)
+            size_t chunk = file_size - offset > sizeof(buf) ? sizeof(buf) : file_size - offset;
+            if (fs_text_reader_pread(src, offset, buf, chunk, &got) != ESP_OK || got != chunk)
             {
                 text_viewer_set_status(ctx, "Read failed");
                 ESP_LOGE(TAG, "Failed to read suffix from %s", dest_path);
@@ -1537,15 +2470,11 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
                 text_viewer_schedule_sd_retry(ctx, TEXT_VIEWER_SD_SAVE);
                 goto save_cleanup;
             }
-            remaining -= chunk;
         }
     }
 
-    if (src)
-    {
-        fclose(src);
-        src = NULL;
-    }
+    fs_text_reader_close(src);
+    src = NULL;
     fclose(tmp);
     tmp = NULL;
 
@@ -1565,31 +2494,37 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
         }
     }
 
+save_done:;
     size_t new_size = prefix_size + text_len + suffix_size;
-    ctx->max_file_offset_kb = (new_size > 0) ? ((new_size - 1u) / 1024u) : 0u;
-    if (ctx->lasf_file_offset_kb > ctx->max_file_offset_kb)
+
+    /* The chunk boundary stays on the same text: edits before it move it */
+    size_t mid = (ctx->window_mid > window_start) ? ctx->window_mid - window_start : 0u;
+    if (have_edits && edit_start + old_len <= mid)
     {
-        ctx->lasf_file_offset_kb = ctx->max_file_offset_kb;
+        mid = mid - old_len + new_len;
     }
-    if (ctx->current_file_offset_kb > ctx->max_file_offset_kb)
+    else if (have_edits && edit_start < mid)
     {
-        ctx->current_file_offset_kb = ctx->max_file_offset_kb;
+        mid = edit_start + new_len;
     }
+    ctx->window_start = window_start;
+    ctx->window_mid = window_start + ((mid < text_len) ? mid : text_len);
+    ctx->window_end = window_start + text_len;
+    ctx->file_size = new_size;
     ctx->at_top_edge = false;
     ctx->at_bottom_edge = false;
 
-    text_viewer_set_original(ctx, text);
+    text_viewer_reset_edits(ctx, text_len);
     ctx->dirty = false;
     ctx->content_changed = true;
     text_viewer_set_status(ctx, "Saved");
+    fs_text_index_forget(dest_path);
+    text_viewer_start_index(ctx);
     text_viewer_update_slider(ctx);
     return;
 
 save_cleanup:
-    if (src)
-    {
-        fclose(src);
-    }
+    fs_text_reader_close(src);
     if (tmp)
     {
         fclose(tmp);
@@ -1674,22 +2609,10 @@ static void text_viewer_apply_pending_chunk(text_viewer_ctx_t *ctx)
         return;
     }
 
-    esp_err_t err = text_viewer_load_window(ctx, ctx->pending_first_offset_kb, ctx->pending_second_offset_kb);
+    esp_err_t err = text_viewer_load_window(ctx, ctx->pending_start, ctx->pending_line);
     if (err == ESP_OK)
     {
-        lv_coord_t content_h = lv_obj_get_content_height(ctx->text_area);
-        if (ctx->pending_scroll_up)
-        {
-            lv_textarea_set_cursor_pos(ctx->text_area, (int32_t)READ_CHUNK_SIZE_B + content_h);
-            text_viewer_skip_cursor_animation(ctx);
-        }
-        else
-        {
-            lv_textarea_set_cursor_pos(ctx->text_area, (int32_t)READ_CHUNK_SIZE_B - content_h);
-            text_viewer_skip_cursor_animation(ctx);
-        }
-        ctx->lasf_file_offset_kb = ctx->pending_first_offset_kb;
-        ctx->current_file_offset_kb = ctx->pending_second_offset_kb;
+        text_viewer_scroll_to_offset(ctx, ctx->pending_anchor);
         ctx->at_top_edge = false;
         ctx->at_bottom_edge = false;
         text_viewer_update_slider(ctx);
@@ -1745,24 +2668,25 @@ static void text_viewer_on_chunk_prompt(lv_event_t *e)
     }
 }
 
-static void text_viewer_request_chunk_load(text_viewer_ctx_t *ctx, size_t first_offset_kb, size_t second_offset_kb, bool from_top)
+static void text_viewer_request_chunk_load(text_viewer_ctx_t *ctx, size_t start, size_t anchor, uint32_t line)
 {
     if (!ctx || ctx->chunk_mbox)
     {
         return;
     }
+    ctx->follow_behind = false;
     if (ctx->waiting_sd)
     {
-        ctx->pending_first_offset_kb = first_offset_kb;
-        ctx->pending_second_offset_kb = second_offset_kb;
-        ctx->pending_scroll_up = from_top;
+        ctx->pending_start = start;
+        ctx->pending_anchor = anchor;
+        ctx->pending_line = line;
         ctx->pending_chunk = true;
         return;
     }
 
-    ctx->pending_first_offset_kb = first_offset_kb;
-    ctx->pending_second_offset_kb = second_offset_kb;
-    ctx->pending_scroll_up = from_top;
+    ctx->pending_start = start;
+    ctx->pending_anchor = anchor;
+    ctx->pending_line = line;
     ctx->pending_chunk = true;
 
     if (ctx->dirty)
@@ -2042,6 +2966,823 @@ static void text_viewer_on_name_dialog(lv_event_t *e)
     text_viewer_handle_save(ctx);
 }
 
+static void text_viewer_show_goto_dialog(text_viewer_ctx_t *ctx)
+{
+    if (!ctx || ctx->goto_dialog || ctx->find_dialog || ctx->name_dialog || ctx->confirm_mbox || ctx->chunk_mbox)
+    {
+        return;
+    }
+    lv_obj_t *dlg = lv_msgbox_create(ctx->screen);
+    styles_build_msgbox(dlg);
+    ctx->goto_dialog = dlg;
+    lv_obj_add_flag(dlg, LV_OBJ_FLAG_FLOATING);
+    lv_obj_set_style_max_width(dlg, LV_PCT(65), 0);
+    lv_obj_set_width(dlg, LV_PCT(65));
+
+    lv_obj_t *content = lv_msgbox_get_content(dlg);
+    lv_obj_t *label = lv_label_create(content);
+    if (ctx->index_ready)
+    {
+        lv_label_set_text_fmt(label, "Go to line (1-%" PRIu32 ")", ctx->index.lines ? ctx->index.lines : 1);
+    }
+    else
+    {
+        lv_label_set_text(label, "Go to line");
+    }
+    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+    lv_obj_set_width(label, LV_PCT(100));
+    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_LEFT, 0);
+
+    ctx->goto_textarea = lv_textarea_create(content);
+    lv_textarea_set_one_line(ctx->goto_textarea, true);
+    lv_textarea_set_accepted_chars(ctx->goto_textarea, "0123456789");
+    lv_textarea_set_max_length(ctx->goto_textarea, 10);
+    lv_obj_add_state(ctx->goto_textarea, LV_STATE_FOCUSED);
+    styles_build_textarea(ctx->goto_textarea);
+    lv_obj_set_width(ctx->goto_textarea, LV_PCT(100));
+
+    lv_obj_t *go_btn = lv_msgbox_add_footer_button(dlg, "Go");
+    lv_obj_set_user_data(go_btn, (void *)1);
+    styles_build_button(go_btn);
+    lv_obj_add_event_cb(go_btn, text_viewer_on_goto_dialog, LV_EVENT_CLICKED, ctx);
+
+    lv_obj_t *cancel_btn = lv_msgbox_add_footer_button(dlg, "Cancel");
+    lv_obj_set_user_data(cancel_btn, (void *)0);
+    styles_build_button(cancel_btn);
+    lv_obj_add_event_cb(cancel_btn, text_viewer_on_goto_dialog, LV_EVENT_CLICKED, ctx);
+
+    lv_keyboard_set_mode(ctx->keyboard, LV_KEYBOARD_MODE_NUMBER);
+    text_viewer_show_keyboard(ctx, ctx->goto_textarea);
+
+    lv_obj_update_layout(ctx->keyboard);
+    lv_obj_update_layout(dlg);
+    lv_coord_t keyboard_top = lv_obj_get_y(ctx->keyboard);
+    lv_coord_t dialog_h = lv_obj_get_height(dlg);
+    lv_coord_t margin = 10;
+    if (keyboard_top > dialog_h)
+    {
+        lv_coord_t candidate = (keyboard_top - dialog_h) / 2;
+        if (candidate > 0)
+        {
+            margin = candidate;
+        }
+    }
+    lv_obj_align(dlg, LV_ALIGN_TOP_MID, 0, margin);
+}
+
+static void text_viewer_close_goto_dialog(text_viewer_ctx_t *ctx)
+{
+    if (!ctx || !ctx->goto_dialog)
+    {
+        return;
+    }
+    lv_msgbox_close(ctx->goto_dialog);
+    ctx->goto_dialog = NULL;
+    ctx->goto_textarea = NULL;
+    text_viewer_hide_keyboard(ctx);
+    lv_keyboard_set_mode(ctx->keyboard, LV_KEYBOARD_MODE_TEXT_LOWER);
+}
+
+static void text_viewer_on_goto_dialog(lv_event_t *e)
+{
+    text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->goto_dialog)
+    {
+        return;
+    }
+    /* The keyboard's OK button lands here too and confirms */
+    lv_obj_t *target = lv_event_get_target(e);
+    bool confirm = (target == ctx->keyboard) || (bool)(uintptr_t)lv_obj_get_user_data(target);
+    if (!confirm)
+    {
+        text_viewer_close_goto_dialog(ctx);
+        return;
+    }
+
+    const char *raw = ctx->goto_textarea ? lv_textarea_get_text(ctx->goto_textarea) : "";
+    unsigned long value = strtoul(raw ? raw : "", NULL, 10);
+    if (value == 0)
+    {
+        text_viewer_set_status(ctx, "Invalid line");
+        return;
+    }
+    text_viewer_close_goto_dialog(ctx);
+    text_viewer_goto_line(ctx, (value > UINT32_MAX) ? UINT32_MAX - 1 : (uint32_t)(value - 1));
+}
+
+static void text_viewer_on_goto(lv_event_t *e)
+{
+    text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || ctx->waiting_sd || ctx->pending_chunk)
+    {
+        return;
+    }
+    text_viewer_show_goto_dialog(ctx);
+}
+
+static void text_viewer_goto_line(text_viewer_ctx_t *ctx, uint32_t line)
+{
+    if (ctx->index_ready && ctx->index.lines > 0 && line >= ctx->index.lines)
+    {
+        line = ctx->index.lines - 1;
+    }
+
+    /* Inside the loaded window: just scroll */
+    if (ctx->window_line != TEXT_VIEWER_LINE_UNKNOWN && line >= ctx->window_line)
+    {
+        const char *text = text_viewer_text(ctx);
+        size_t pos = 0;
+        uint32_t current = ctx->window_line;
+        while (current < line)
+        {
+            const char *nl = strchr(text + pos, '\n');
+            if (!nl)
+            {
+                break;
+            }
+            pos = (size_t)(nl - text) + 1;
+            current++;
+        }
+        bool complete = ctx->window_end >= ctx->file_size || ctx->new_file;
+        if ((current == line && (ctx->window_start + pos < ctx->window_end || complete)) ||
+            (current < line && complete))
+        {
+            text_viewer_scroll_to_offset(ctx, ctx->window_start + pos);
+            return;
+        }
+    }
+
+    if (!ctx->index_ready)
+    {
+        text_viewer_set_status(ctx, "Counting lines...");
+        return;
+    }
+    size_t offset = 0;
+    esp_err_t err = fs_text_index_line_offset(ctx->path, &ctx->index, line, &offset);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to find line %" PRIu32 ": %s", line + 1, esp_err_to_name(err));
+        text_viewer_set_status(ctx, "Read failed");
+        return;
+    }
+    text_viewer_request_chunk_load(ctx, offset, offset, line);
+}
+
+static void text_viewer_show_find_dialog(text_viewer_ctx_t *ctx)
+{
+    if (!ctx || ctx->find_dialog || ctx->goto_dialog || ctx->name_dialog || ctx->confirm_mbox || ctx->chunk_mbox)
+    {
+        return;
+    }
+    lv_obj_t *dlg = lv_msgbox_create(ctx->screen);
+    styles_build_msgbox(dlg);
+    ctx->find_dialog = dlg;
+    lv_obj_add_flag(dlg, LV_OBJ_FLAG_FLOATING);
+    lv_obj_set_style_max_width(dlg, LV_PCT(65), 0);
+    lv_obj_set_width(dlg, LV_PCT(65));
+
+    lv_obj_t *content = lv_msgbox_get_content(dlg);
+    lv_obj_t *label = lv_label_create(content);
+    lv_label_set_text(label, "Find text");
+    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+    lv_obj_set_width(label, LV_PCT(100));
+    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_LEFT, 0);
+
+    ctx->find_textarea = lv_textarea_create(content);
+    lv_textarea_set_one_line(ctx->find_textarea, true);
+    lv_textarea_set_max_length(ctx->find_textarea, FS_TEXT_SEARCH_MAX_PATTERN);
+    lv_textarea_set_text(ctx->find_textarea, ctx->search_pattern);
+    lv_obj_add_state(ctx->find_textarea, LV_STATE_FOCUSED);
+    styles_build_textarea(ctx->find_textarea);
+    lv_obj_set_width(ctx->find_textarea, LV_PCT(100));
+    lv_obj_add_event_cb(ctx->find_textarea, text_viewer_on_find_field_clicked, LV_EVENT_CLICKED, ctx);
+
+    if (ctx->editable)
+    {
+        lv_obj_t *replace_label = lv_label_create(content);
+        lv_label_set_text(replace_label, "Replace with");
+        lv_obj_set_width(replace_label, LV_PCT(100));
+        lv_obj_set_style_text_align(replace_label, LV_TEXT_ALIGN_LEFT, 0);
+
+        ctx->replace_textarea = lv_textarea_create(content);
+        lv_textarea_set_one_line(ctx->replace_textarea, true);
+        lv_textarea_set_max_length(ctx->replace_textarea, FS_TEXT_SEARCH_MAX_PATTERN);
+        styles_build_textarea(ctx->replace_textarea);
+        lv_obj_set_width(ctx->replace_textarea, LV_PCT(100));
+        lv_obj_add_event_cb(ctx->replace_textarea, text_viewer_on_find_field_clicked, LV_EVENT_CLICKED, ctx);
+    }
+
+    lv_obj_t *prev_btn = lv_msgbox_add_footer_button(dlg, "Prev");
+    lv_obj_set_user_data(prev_btn, (void *)2);
+    styles_build_button(prev_btn);
+    lv_obj_add_event_cb(prev_btn, text_viewer_on_find_dialog, LV_EVENT_CLICKED, ctx);
+
+    lv_obj_t *next_btn = lv_msgbox_add_footer_button(dlg, "Next");
+    lv_obj_set_user_data(next_btn, (void *)1);
+    styles_build_button(next_btn);
+    lv_obj_add_event_cb(next_btn, text_viewer_on_find_dialog, LV_EVENT_CLICKED, ctx);
+
+    if (ctx->editable)
+    {
+        lv_obj_t *all_btn = lv_msgbox_add_footer_button(dlg, "All");
+        lv_obj_set_user_data(all_btn, (void *)3);
+        styles_build_button(all_btn);
+        lv_obj_add_event_cb(all_btn, text_viewer_on_find_dialog, LV_EVENT_CLICKED, ctx);
+    }
+
+    lv_obj_t *cancel_btn = lv_msgbox_add_footer_button(dlg, "Cancel");
+    lv_obj_set_user_data(cancel_btn, (void *)0);
+    styles_build_button(cancel_btn);
+    lv_obj_add_event_cb(cancel_btn, text_viewer_on_find_dialog, LV_EVENT_CLICKED, ctx);
+
+    text_viewer_show_keyboard(ctx, ctx->find_textarea);
+
+    lv_obj_update_layout(ctx->keyboard);
+    lv_obj_update_layout(dlg);
+    lv_coord_t keyboard_top = lv_obj_get_y(ctx->keyboard);
+    lv_coord_t dialog_h = lv_obj_get_height(dlg);
+    lv_coord_t margin = 10;
+    if (keyboard_top > dialog_h)
+    {
+        lv_coord_t candidate = (keyboard_top - dialog_h) / 2;
+        if (candidate > 0)
+        {
+            margin = candidate;
+        }
+    }
+    lv_obj_align(dlg, LV_ALIGN_TOP_MID, 0, margin);
+}
+
+static void text_viewer_close_find_dialog(text_viewer_ctx_t *ctx)
+{
+    if (!ctx || !ctx->find_dialog)
+    {
+        return;
+    }
+    lv_msgbox_close(ctx->find_dialog);
+    ctx->find_dialog = NULL;
+    ctx->find_textarea = NULL;
+    ctx->replace_textarea = NULL;
+    text_viewer_hide_keyboard(ctx);
+}
+
+static void text_viewer_on_find_dialog(lv_event_t *e)
+{
+    text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->find_dialog)
+    {
+        return;
+    }
+    /* The keyboard's OK button lands here too and searches forward */
+    lv_obj_t *target = lv_event_get_target(e);
+    uintptr_t action = (target == ctx->keyboard) ? 1u : (uintptr_t)lv_obj_get_user_data(target);
+    if (action == 0)
+    {
+        text_viewer_close_find_dialog(ctx);
+        return;
+    }
+
+    const char *raw = ctx->find_textarea ? lv_textarea_get_text(ctx->find_textarea) : "";
+    if (!raw || raw[0] == '\0')
+    {
+        text_viewer_set_status(ctx, "Enter text");
+        return;
+    }
+    if (strcmp(raw, ctx->search_pattern) != 0)
+    {
+        strlcpy(ctx->search_pattern, raw, sizeof(ctx->search_pattern));
+        ctx->search_hit = SIZE_MAX; // New pattern: start from the view
+    }
+    if (action == 3)
+    {
+        char replacement[FS_TEXT_SEARCH_MAX_PATTERN + 1];
+        const char *with = ctx->replace_textarea ? lv_textarea_get_text(ctx->replace_textarea) : "";
+        strlcpy(replacement, with ? with : "", sizeof(replacement));
+        text_viewer_close_find_dialog(ctx);
+        text_viewer_replace_all(ctx, replacement);
+        return;
+    }
+    text_viewer_close_find_dialog(ctx);
+    text_viewer_find(ctx, action == 1);
+}
+
+static void text_viewer_on_find_field_clicked(lv_event_t *e)
+{
+    text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->find_dialog)
+    {
+        return;
+    }
+    text_viewer_show_keyboard(ctx, lv_event_get_target(e));
+}
+
+static void text_viewer_on_find(lv_event_t *e)
+{
+    text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || ctx->waiting_sd || ctx->pending_chunk)
+    {
+        return;
+    }
+    if (ctx->replace_mbox)
+    {
+        return;
+    }
+    if (ctx->search_timer)
+    {
+        text_viewer_stop_search(ctx);
+        text_viewer_set_status(ctx, "Search cancelled");
+        return;
+    }
+    if (ctx->new_file || ctx->path[0] == '\0')
+    {
+        text_viewer_set_status(ctx, "Save the file first");
+        return;
+    }
+    text_viewer_show_find_dialog(ctx);
+}
+
+static void text_viewer_find(text_viewer_ctx_t *ctx, bool forward)
+{
+    size_t from = text_viewer_top_offset(ctx);
+    if (ctx->search_hit != SIZE_MAX)
+    {
+        from = forward ? ctx->search_hit + 1 : ctx->search_hit;
+    }
+
+    esp_err_t err = fs_text_search_start(ctx->path, ctx->search_pattern, from, forward);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Search not started: %s", esp_err_to_name(err));
+        text_viewer_set_status(ctx, "Search failed");
+        return;
+    }
+    if (!ctx->search_timer)
+    {
+        ctx->search_timer = lv_timer_create(text_viewer_on_search_timer, TEXT_VIEWER_SEARCH_POLL_MS, ctx);
+    }
+    text_viewer_set_status(ctx, "Searching...");
+}
+
+static void text_viewer_on_search_timer(lv_timer_t *timer)
+{
+    text_viewer_ctx_t *ctx = lv_timer_get_user_data(timer);
+    size_t offset = 0;
+    uint8_t percent = 0;
+    esp_err_t err = fs_text_search_poll(&offset, &percent);
+    if (err == ESP_ERR_NOT_FINISHED)
+    {
+        char msg[32];
+        snprintf(msg, sizeof(msg), "Searching %u%%", (unsigned)percent);
+        text_viewer_set_status(ctx, msg);
+        return;
+    }
+    lv_timer_del(timer);
+    ctx->search_timer = NULL;
+
+    if (err == ESP_ERR_NOT_FOUND)
+    {
+        text_viewer_set_status(ctx, "Not found");
+        return;
+    }
+    if (err != ESP_OK)
+    {
+        if (err != ESP_ERR_INVALID_STATE)
+        {
+            ESP_LOGE(TAG, "Search failed: %s", esp_err_to_name(err));
+            text_viewer_set_status(ctx, "Search failed");
+        }
+        return;
+    }
+    ctx->search_hit = offset;
+    text_viewer_set_status(ctx, "Found");
+    text_viewer_show_match(ctx, offset);
+}
+
+static void text_viewer_stop_search(text_viewer_ctx_t *ctx)
+{
+    fs_text_search_stop();
+    if (ctx->search_timer)
+    {
+        lv_timer_del(ctx->search_timer);
+        ctx->search_timer = NULL;
+    }
+}
+
+static void text_viewer_replace_all(text_viewer_ctx_t *ctx, const char *replacement)
+{
+    if (ctx->dirty)
+    {
+        text_viewer_set_status(ctx, "Save changes first");
+        return;
+    }
+
+    /* The file is renamed away under any open handle: release them all for the rewrite */
+    text_viewer_stop_search(ctx);
+    fs_text_index_stop();
+    fs_text_cache_close();
+    esp_err_t err = fs_text_replace_start(ctx->path, ctx->search_pattern, replacement);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Replace not started: %s", esp_err_to_name(err));
+        text_viewer_finish_replace(ctx, err, 0);
+        return;
+    }
+
+    lv_obj_t *mbox = lv_msgbox_create(NULL);
+    styles_build_msgbox(mbox);
+    lv_obj_set_style_max_width(mbox, LV_PCT(70), 0);
+    lv_obj_set_width(mbox, LV_PCT(70));
+    lv_obj_center(mbox);
+    ctx->replace_mbox = mbox;
+
+    ctx->replace_label = lv_label_create(lv_msgbox_get_content(mbox));
+    lv_label_set_text(ctx->replace_label, "Replacing...");
+    lv_label_set_long_mode(ctx->replace_label, LV_LABEL_LONG_WRAP);
+    lv_obj_set_width(ctx->replace_label, LV_PCT(100));
+    lv_obj_set_style_text_align(ctx->replace_label, LV_TEXT_ALIGN_CENTER, 0);
+
+    lv_obj_t *cancel_btn = lv_msgbox_add_footer_button(mbox, "Cancel");
+    styles_build_button(cancel_btn);
+    lv_obj_add_event_cb(cancel_btn, text_viewer_on_replace_cancel, LV_EVENT_CLICKED, ctx);
+
+    ctx->search_timer = lv_timer_create(text_viewer_on_replace_timer, TEXT_VIEWER_SEARCH_POLL_MS, ctx);
+}
+
+static void text_viewer_on_replace_timer(lv_timer_t *timer)
+{
+    text_viewer_ctx_t *ctx = lv_timer_get_user_data(timer);
+    size_t count = 0;
+    uint8_t percent = 0;
+    esp_err_t err = fs_text_replace_poll(&count, &percent);
+    if (err == ESP_ERR_NOT_FINISHED)
+    {
+        lv_label_set_text_fmt(ctx->replace_label, "Replacing... %u%%\n%u matches",
+                              (unsigned)percent, (unsigned)count);
+        return;
+    }
+    text_viewer_finish_replace(ctx, err, count);
+}
+
+static void text_viewer_on_replace_cancel(lv_event_t *e)
+{
+    text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->replace_mbox)
+    {
+        return;
+    }
+    fs_text_search_stop();
+    text_viewer_finish_replace(ctx, ESP_ERR_INVALID_STATE, 0);
+}
+
+static void text_viewer_finish_replace(text_viewer_ctx_t *ctx, esp_err_t err, size_t count)
+{
+    if (ctx->search_timer)
+    {
+        lv_timer_del(ctx->search_timer);
+        ctx->search_timer = NULL;
+    }
+    if (ctx->replace_mbox)
+    {
+        lv_msgbox_close(ctx->replace_mbox);
+        ctx->replace_mbox = NULL;
+        ctx->replace_label = NULL;
+    }
+
+    if (fs_text_cache_open(ctx->path) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "No read-ahead for %s, reading chunks on demand", ctx->path);
+    }
+    if (err != ESP_OK || count == 0)
+    {
+        text_viewer_set_status(ctx, (err == ESP_ERR_INVALID_STATE) ? "Replace cancelled"
+                                    : (err != ESP_OK)             ? "Replace failed"
+                                                                  : "Not found");
+        text_viewer_start_index(ctx);
+        return;
+    }
+
+    /* Every offset after the first match moved: reload from scratch */
+    struct stat st = {0};
+    if (stat(ctx->path, &st) == 0 && S_ISREG(st.st_mode))
+    {
+        ctx->file_size = (size_t)st.st_size;
+    }
+    size_t start = 0;
+    if (fs_text_chunk_align(ctx->path, (ctx->window_start < ctx->file_size) ? ctx->window_start : 0, &start) != ESP_OK)
+    {
+        start = 0;
+    }
+    fs_text_index_forget(ctx->path);
+    fs_text_index_free(&ctx->index);
+    ctx->index_ready = false;
+    ctx->window_line = TEXT_VIEWER_LINE_UNKNOWN;
+    ctx->search_hit = SIZE_MAX;
+    ctx->content_changed = true;
+    text_viewer_request_chunk_load(ctx, start, start, TEXT_VIEWER_LINE_UNKNOWN);
+    text_viewer_start_index(ctx);
+
+    char msg[32];
+    snprintf(msg, sizeof(msg), "Replaced %u", (unsigned)count);
+    text_viewer_set_status(ctx, msg);
+}
+
+static void text_viewer_show_match(text_viewer_ctx_t *ctx, size_t offset)
+{
+    size_t len = strlen(ctx->search_pattern);
+    if (offset >= ctx->window_start && offset + len <= ctx->window_end)
+    {
+        text_viewer_scroll_to_offset(ctx, offset);
+        return;
+    }
+
+    /* Open the window at most half a chunk above the match: both chunks together always reach past it */
+    size_t start = 0;
+    size_t back = (offset > READ_CHUNK_SIZE_B / 2) ? offset - READ_CHUNK_SIZE_B / 2 : 0;
+    esp_err_t err = fs_text_chunk_align(ctx->path, back, &start);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to align chunk: %s", esp_err_to_name(err));
+        text_viewer_set_status(ctx, "Read failed");
+        return;
+    }
+    text_viewer_request_chunk_load(ctx, start, offset, TEXT_VIEWER_LINE_UNKNOWN);
+}
+
+static void text_viewer_on_follow(lv_event_t *e)
+{
+    text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || ctx->editable || ctx->waiting_sd || ctx->pending_chunk)
+    {
+        return;
+    }
+    if (ctx->follow_timer)
+    {
+        text_viewer_stop_follow(ctx);
+        /* The line index still describes the file as it was when following started */
+        if (ctx->follow_size != ctx->index.size)
+        {
+            text_viewer_start_index(ctx);
+        }
+        text_viewer_set_status(ctx, "View mode");
+        return;
+    }
+
+    if (ctx->window_end < ctx->file_size)
+    {
+        text_viewer_follow_jump(ctx, ctx->file_size);
+    }
+    else
+    {
+        text_viewer_scroll_to_end(ctx);
+    }
+    ctx->follow_size = ctx->file_size;
+    ctx->follow_behind = false;
+    ctx->follow_timer = lv_timer_create(text_viewer_on_follow_timer, TEXT_VIEWER_FOLLOW_POLL_MS, ctx);
+    lv_label_set_text(ctx->follow_label, LV_SYMBOL_STOP " Stop");
+    text_viewer_set_status(ctx, "Following");
+}
+
+static void text_viewer_stop_follow(text_viewer_ctx_t *ctx)
+{
+    if (!ctx->follow_timer)
+    {
+        return;
+    }
+    lv_timer_del(ctx->follow_timer);
+    ctx->follow_timer = NULL;
+    if (ctx->follow_label)
+    {
+        lv_label_set_text(ctx->follow_label, LV_SYMBOL_PLAY " Follow");
+    }
+}
+
+static void text_viewer_on_follow_timer(lv_timer_t *timer)
+{
+    text_viewer_ctx_t *ctx = lv_timer_get_user_data(timer);
+    if (ctx->waiting_sd || ctx->pending_chunk || ctx->chunk_mbox || ctx->slider_drag_active)
+    {
+        return;
+    }
+
+    /* stat() reads the directory entry: a FAT handle held open keeps reporting the size it was opened at */
+    struct stat st;
+    if (stat(ctx->path, &st) != 0)
+    {
+        return;
+    }
+    size_t size = (size_t)st.st_size;
+    bool stick = text_viewer_scroll_bottom(ctx) <= 0;
+    bool catch_up = ctx->follow_behind && stick;
+    if (size == ctx->follow_size && !catch_up)
+    {
+        return;
+    }
+    if (size != ctx->follow_size)
+    {
+        ctx->follow_size = size;
+        if (fs_text_cache_refresh() != ESP_OK)
+        {
+            ESP_LOGW(TAG, "No read-ahead for %s, reading chunks on demand", ctx->path);
+        }
+    }
+
+    if (size < ctx->file_size)
+    {
+        /* Truncated or rotated: the old lines, offsets and index no longer apply */
+        fs_text_index_stop();
+        fs_text_index_free(&ctx->index);
+        ctx->index_ready = false;
+        ctx->window_line = TEXT_VIEWER_LINE_UNKNOWN;
+        text_viewer_follow_jump(ctx, size);
+        text_viewer_start_index(ctx);
+        text_viewer_set_status(ctx, "File truncated");
+        return;
+    }
+
+    if (catch_up)
+    {
+        text_viewer_follow_jump(ctx, size);
+        return;
+    }
+
+    /* Reading elsewhere in the file: only the slider learns about the new end */
+    if (ctx->window_end < ctx->file_size || (!stick && size - ctx->window_end > TEXT_VIEWER_FOLLOW_MAX_READ))
+    {
+        if (ctx->window_end == ctx->file_size)
+        {
+            /* The tail window is about to fall behind: appends can no longer extend it */
+            ctx->follow_behind = true;
+        }
+        ctx->file_size = size;
+        text_viewer_update_slider(ctx);
+        return;
+    }
+
+    if (size - ctx->window_end > TEXT_VIEWER_FOLLOW_MAX_READ)
+    {
+        text_viewer_follow_jump(ctx, size);
+        return;
+    }
+    esp_err_t err = text_viewer_follow_append(ctx, size, stick);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to read appended lines: %s", esp_err_to_name(err));
+        text_viewer_set_status(ctx, "Read failed");
+    }
+}
+
+static esp_err_t text_viewer_follow_append(text_viewer_ctx_t *ctx, size_t size, bool stick)
+{
+    size_t want = size - ctx->window_end;
+    char *buf = (char *)malloc(want + 1);
+    if (!buf)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    fs_text_reader_t reader;
+    size_t got = 0;
+    esp_err_t err = fs_text_reader_open(&reader, ctx->path);
+    if (err == ESP_OK)
+    {
+        err = fs_text_reader_pread(&reader, ctx->window_end, buf, want, &got);
+        fs_text_reader_close(&reader);
+    }
+    /* Whole lines only: a line still being written shows up once its newline lands */
+    while (got > 0 && buf[got - 1] != '\n')
+    {
+        got--;
+    }
+    if (err != ESP_OK || got == 0)
+    {
+        free(buf);
+        return err;
+    }
+    buf[got] = '\0';
+
+    const char *text = text_viewer_text(ctx);
+    size_t len = ctx->window_end - ctx->window_start;
+    size_t top = text_viewer_top_offset(ctx);
+
+    /* Drop whole lines from the front once the window outgrows the limit, down to about two chunks */
+    size_t drop = 0;
+    if (len + got > TEXT_VIEWER_FOLLOW_WINDOW)
+    {
+        drop = len + got - 2 * READ_CHUNK_SIZE_B;
+        if (drop < len)
+        {
+            const char *nl = memchr(text + drop, '\n', len - drop);
+            drop = nl ? (size_t)(nl - text) + 1 : len;
+        }
+        else
+        {
+            drop = len;
+        }
+    }
+    uint32_t dropped_lines = (uint32_t)fs_text_count_newlines(text, drop);
+
+    /* Lines already shown keep their wraps: only the new ones get laid out, and only once visible */
+    err = text_line_view_append(ctx->line_view, buf, got);
+    if (err == ESP_OK)
+    {
+        err = text_line_view_drop_front(ctx->line_view, drop);
+    }
+    free(buf);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    if (ctx->window_line != TEXT_VIEWER_LINE_UNKNOWN)
+    {
+        ctx->window_line += dropped_lines;
+    }
+    ctx->window_start += drop;
+    ctx->window_end += got;
+    if (ctx->window_mid < ctx->window_start)
+    {
+        ctx->window_mid = ctx->window_start;
+    }
+    text_viewer_reset_edits(ctx, len - drop + got);
+
+    ctx->file_size = ctx->window_end;
+    if (stick)
+    {
+        text_viewer_scroll_to_end(ctx);
+    }
+    else
+    {
+        text_viewer_scroll_to_offset(ctx, top > ctx->window_start ? top : ctx->window_start);
+    }
+    text_viewer_update_slider(ctx);
+    return ESP_OK;
+}
+
+static void text_viewer_follow_jump(text_viewer_ctx_t *ctx, size_t size)
+{
+    size_t start = 0;
+    esp_err_t err = fs_text_cache_before(ctx->path, size, &start);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to find the last chunk: %s", esp_err_to_name(err));
+        text_viewer_set_status(ctx, "Read failed");
+        return;
+    }
+
+    ctx->file_size = size;
+    text_viewer_request_chunk_load(ctx, start, start, text_viewer_follow_line(ctx, start));
+    if (ctx->pending_chunk)
+    {
+        return;
+    }
+    if (ctx->window_end > ctx->file_size)
+    {
+        ctx->file_size = ctx->window_end;
+    }
+    text_viewer_scroll_to_end(ctx);
+    text_viewer_update_slider(ctx);
+}
+
+static uint32_t text_viewer_follow_line(text_viewer_ctx_t *ctx, size_t offset)
+{
+    if (ctx->window_line == TEXT_VIEWER_LINE_UNKNOWN || offset < ctx->window_end)
+    {
+        return TEXT_VIEWER_LINE_UNKNOWN;
+    }
+    const char *text = text_viewer_text(ctx);
+    uint32_t line = ctx->window_line + (uint32_t)fs_text_count_newlines(text, ctx->window_end - ctx->window_start);
+
+    /* Count the lines skipped between the window and @p offset: only the new bytes are read */
+    char *buf = (char *)malloc(READ_CHUNK_SIZE_B);
+    fs_text_reader_t reader;
+    if (!buf || fs_text_reader_open(&reader, ctx->path) != ESP_OK)
+    {
+        free(buf);
+        return TEXT_VIEWER_LINE_UNKNOWN;
+    }
+    size_t pos = ctx->window_end;
+    while (pos < offset)
+    {
+        size_t want = (offset - pos < READ_CHUNK_SIZE_B) ? offset - pos : READ_CHUNK_SIZE_B;
+        size_t got = 0;
+        if (fs_text_reader_pread(&reader, pos, buf, want, &got) != ESP_OK || got == 0)
+        {
+            line = TEXT_VIEWER_LINE_UNKNOWN;
+            break;
+        }
+        line += (uint32_t)fs_text_count_newlines(buf, got);
+        pos += got;
+    }
+    fs_text_reader_close(&reader);
+    free(buf);
+    return line;
+}
+
+static void text_viewer_scroll_to_end(text_viewer_ctx_t *ctx)
+{
+    text_line_view_scroll_to_end(ctx->line_view);
+    text_viewer_update_gutter(ctx);
+}
+
 static void text_viewer_show_confirm(text_viewer_ctx_t *ctx)
 {
     if (ctx->confirm_mbox)
@@ -2127,11 +3868,30 @@ static void text_viewer_close(text_viewer_ctx_t *ctx, bool changed)
     text_viewer_close_confirm(ctx);
     text_viewer_close_chunk_prompt(ctx);
     text_viewer_close_name_dialog(ctx);
+    text_viewer_close_goto_dialog(ctx);
+    text_viewer_close_find_dialog(ctx);
+    text_viewer_stop_search(ctx);
+    text_viewer_stop_follow(ctx);
+    if (ctx->replace_mbox)
+    {
+        lv_msgbox_close(ctx->replace_mbox);
+        ctx->replace_mbox = NULL;
+        ctx->replace_label = NULL;
+    }
     if (ctx->sd_retry_timer)
     {
         lv_timer_del(ctx->sd_retry_timer);
         ctx->sd_retry_timer = NULL;
     }
+    fs_text_index_stop();
+    if (ctx->index_timer)
+    {
+        lv_timer_del(ctx->index_timer);
+        ctx->index_timer = NULL;
+    }
+    fs_text_index_free(&ctx->index);
+    ctx->index_ready = false;
+    fs_text_cache_close();
     ctx->active = false;
     ctx->editable = false;
     ctx->dirty = false;
@@ -2153,12 +3913,16 @@ static void text_viewer_close(text_viewer_ctx_t *ctx, bool changed)
         ctx->path_label = NULL;
         ctx->status_label = NULL;
         ctx->save_btn = NULL;
+        ctx->follow_btn = NULL;
+        ctx->follow_label = NULL;
         ctx->text_area = NULL;
+        ctx->line_view = NULL;
         ctx->keyboard = NULL;
         ctx->chunk_slider = NULL;
+        ctx->gutter = NULL;
+        memset(ctx->gutter_rows, 0, sizeof(ctx->gutter_rows));
     }
-    free(ctx->original_text);
-    ctx->original_text = NULL;
+    text_viewer_reset_edits(ctx, 0);
     if (ctx->return_screen)
     {
         lv_screen_load(ctx->return_screen);
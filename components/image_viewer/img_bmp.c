@@ -0,0 +1,328 @@
+#include "img_bmp.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#define TAG "img_bmp"
+
+#define BMP_RGB_CHUNK       32u         /* Pixels converted per row sink call */
+#define BMP_MAX_DIM         0xFFFFu
+
+#define BMP_BI_RGB          0u
+#define BMP_BI_BITFIELDS    3u
+#define BMP_BI_ALPHABITFIELDS 6u
+
+typedef struct {
+    uint32_t mask;
+    uint8_t shift;
+    uint8_t bits;
+} bmp_channel_t;
+
+typedef struct {
+    lv_fs_file_t *file;
+    uint32_t width;
+    uint32_t height;
+    bool top_down;
+    uint16_t bpp;
+    uint32_t stride;
+    uint32_t data_offset;
+    uint8_t palette[256][3];            /* R, G, B */
+    uint32_t pal_count;
+    bmp_channel_t ch[3];                /* R, G, B masks for 16/32-bit */
+} bmp_info_t;
+
+/**
+ * @brief Read exactly @p len bytes at absolute offset @p off.
+ */
+static bool bmp_read_at(lv_fs_file_t *file, uint32_t off, void *buf, uint32_t len);
+
+/**
+ * @brief Read a little-endian 16-bit value.
+ */
+static uint16_t bmp_le16(const uint8_t *p);
+
+/**
+ * @brief Read a little-endian 32-bit value.
+ */
+static uint32_t bmp_le32(const uint8_t *p);
+
+/**
+ * @brief Parse the file and DIB headers, bit masks and palette.
+ */
+static esp_err_t bmp_read_header(bmp_info_t *bmp);
+
+/**
+ * @brief Derive shift/width of a bit mask; an empty mask yields a channel that reads 0.
+ */
+static void bmp_channel_init(bmp_channel_t *ch, uint32_t mask);
+
+/**
+ * @brief Extract and expand one masked channel to 8 bits.
+ */
+static inline uint8_t bmp_channel_get(const bmp_channel_t *ch, uint32_t px);
+
+/**
+ * @brief Convert pixels [@p x, @p x + @p n) of a raw row to RGB888.
+ */
+static void bmp_convert(const bmp_info_t *bmp, const uint8_t *row, uint32_t x, uint32_t n, uint8_t *rgb);
+
+esp_err_t img_bmp_draw(const img_stream_cfg_t *cfg)
+{
+    if (!cfg || !cfg->file || !cfg->draw || !cfg->max_w || !cfg->max_h) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bmp_info_t *bmp = heap_caps_calloc(1, sizeof(*bmp), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!bmp) {
+        return ESP_ERR_NO_MEM;
+    }
+    bmp->file = cfg->file;
+
+    img_stream_rows_t rows = {0};
+    uint8_t *row = NULL;
+    esp_err_t err = bmp_read_header(bmp);
+    if (err != ESP_OK) {
+        goto cleanup;
+    }
+
+    err = img_stream_rows_begin(&rows, cfg, bmp->width, bmp->height, !bmp->top_down);
+    if (err != ESP_OK) {
+        goto cleanup;
+    }
+
+    row = heap_caps_malloc(bmp->stride, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!row) {
+        ESP_LOGE(TAG, "Failed to allocate a %lu B row", (unsigned long)bmp->stride);
+        err = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    if (lv_fs_seek(bmp->file, bmp->data_offset, LV_FS_SEEK_SET) != LV_FS_RES_OK) {
+        err = ESP_FAIL;
+        goto cleanup;
+    }
+
+    uint8_t rgb[BMP_RGB_CHUNK * 3];
+    for (uint32_t y = 0; y < bmp->height; y++) {
+        uint32_t br = 0;
+        if (lv_fs_read(bmp->file, row, bmp->stride, &br) != LV_FS_RES_OK) {
+            err = ESP_FAIL;
+            goto cleanup;
+        }
+        if (br != bmp->stride) {
+            ESP_LOGW(TAG, "Pixel data ends after %lu of %lu rows", (unsigned long)y, (unsigned long)bmp->height);
+            err = img_stream_rows_flush(&rows);
+            goto cleanup;
+        }
+
+        for (uint32_t x = 0; x < bmp->width; ) {
+            uint32_t n = bmp->width - x < BMP_RGB_CHUNK ? bmp->width - x : BMP_RGB_CHUNK;
+            bmp_convert(bmp, row, x, n, rgb);
+            img_stream_rows_put(&rows, rgb, n);
+            x += n;
+        }
+        err = img_stream_rows_next(&rows);
+        if (err != ESP_OK) {
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    img_stream_rows_end(&rows);
+    free(row);
+    free(bmp);
+    return err;
+}
+
+static bool bmp_read_at(lv_fs_file_t *file, uint32_t off, void *buf, uint32_t len)
+{
+    uint32_t br = 0;
+    if (lv_fs_seek(file, off, LV_FS_SEEK_SET) != LV_FS_RES_OK) {
+        return false;
+    }
+    return lv_fs_read(file, buf, len, &br) == LV_FS_RES_OK && br == len;
+}
+
+static uint16_t bmp_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t bmp_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static esp_err_t bmp_read_header(bmp_info_t *bmp)
+{
+    uint8_t h[14 + 124];
+    if (!bmp_read_at(bmp->file, 0, h, 18) || h[0] != 'B' || h[1] != 'M') {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    bmp->data_offset = bmp_le32(h + 10);
+    const uint32_t dib = bmp_le32(h + 14);
+    if (dib != 12 && (dib < 40 || dib > 124)) {
+        ESP_LOGE(TAG, "Unknown DIB header size %lu", (unsigned long)dib);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (!bmp_read_at(bmp->file, 14, h + 14, dib)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    int32_t w;
+    int32_t ht;
+    uint32_t compression = BMP_BI_RGB;
+    uint32_t clr_used = 0;
+    uint32_t pal_entry = 4;
+    if (dib == 12) {
+        /* OS/2 BITMAPCOREHEADER */
+        w = bmp_le16(h + 18);
+        ht = bmp_le16(h + 20);
+        bmp->bpp = bmp_le16(h + 24);
+        pal_entry = 3;
+    } else {
+        w = (int32_t)bmp_le32(h + 18);
+        ht = (int32_t)bmp_le32(h + 22);
+        bmp->bpp = bmp_le16(h + 28);
+        compression = bmp_le32(h + 30);
+        clr_used = bmp_le32(h + 46);
+    }
+
+    if (ht < 0) {
+        bmp->top_down = true;
+        ht = -ht;
+    }
+    if (w <= 0 || ht <= 0 || (uint32_t)w > BMP_MAX_DIM || (uint32_t)ht > BMP_MAX_DIM) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    bmp->width = (uint32_t)w;
+    bmp->height = (uint32_t)ht;
+
+    uint32_t masks_end = 14 + dib;
+    if (compression == BMP_BI_BITFIELDS || compression == BMP_BI_ALPHABITFIELDS) {
+        if (bmp->bpp != 16 && bmp->bpp != 32) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        uint8_t m[12];
+        if (dib >= 52) {
+            memcpy(m, h + 54, sizeof(m));       /* Masks are part of V2+ headers */
+        } else {
+            /* INFO header: masks follow it */
+            if (!bmp_read_at(bmp->file, masks_end, m, sizeof(m))) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            masks_end += (compression == BMP_BI_ALPHABITFIELDS) ? 16u : 12u;
+        }
+        for (int c = 0; c < 3; c++) {
+            bmp_channel_init(&bmp->ch[c], bmp_le32(m + 4 * c));
+        }
+    } else if (compression != BMP_BI_RGB) {
+        ESP_LOGE(TAG, "BMP compression %lu is not supported", (unsigned long)compression);
+        return ESP_ERR_NOT_SUPPORTED;
+    } else if (bmp->bpp == 16) {
+        bmp_channel_init(&bmp->ch[0], 0x7C00);
+        bmp_channel_init(&bmp->ch[1], 0x03E0);
+        bmp_channel_init(&bmp->ch[2], 0x001F);
+    } else if (bmp->bpp == 32) {
+        bmp_channel_init(&bmp->ch[0], 0x00FF0000);
+        bmp_channel_init(&bmp->ch[1], 0x0000FF00);
+        bmp_channel_init(&bmp->ch[2], 0x000000FF);
+    }
+
+    if (bmp->bpp != 1 && bmp->bpp != 4 && bmp->bpp != 8 && bmp->bpp != 16 && bmp->bpp != 24 && bmp->bpp != 32) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    bmp->stride = ((bmp->width * bmp->bpp + 31u) / 32u) * 4u;
+
+    if (bmp->bpp <= 8) {
+        const uint32_t max = 1u << bmp->bpp;
+        bmp->pal_count = (clr_used && clr_used < max) ? clr_used : max;
+        uint8_t raw[256 * 4];
+        if (!bmp_read_at(bmp->file, masks_end, raw, bmp->pal_count * pal_entry)) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        for (uint32_t i = 0; i < bmp->pal_count; i++) {
+            const uint8_t *entry = raw + i * pal_entry;   /* B, G, R[, reserved] */
+            bmp->palette[i][0] = entry[2];
+            bmp->palette[i][1] = entry[1];
+            bmp->palette[i][2] = entry[0];
+        }
+    }
+    return ESP_OK;
+}
+
+static void bmp_channel_init(bmp_channel_t *ch, uint32_t mask)
+{
+    ch->mask = mask;
+    ch->shift = 0;
+    ch->bits = 0;
+    if (!mask) {
+        return;
+    }
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        ch->shift++;
+    }
+    while (mask & 1u) {
+        mask >>= 1;
+        ch->bits++;
+    }
+}
+
+static inline uint8_t bmp_channel_get(const bmp_channel_t *ch, uint32_t px)
+{
+    if (!ch->bits) {
+        return 0;
+    }
+    const uint32_t v = (px & ch->mask) >> ch->shift;
+    if (ch->bits >= 8) {
+        return (uint8_t)(v >> (ch->bits - 8u));
+    }
+    return (uint8_t)(v * 255u / ((1u << ch->bits) - 1u));
+}
+
+static void bmp_convert(const bmp_info_t *bmp, const uint8_t *row, uint32_t x, uint32_t n, uint8_t *rgb)
+{
+    switch (bmp->bpp) {
+    case 24: {
+        const uint8_t *p = row + x * 3u;
+        for (uint32_t i = 0; i < n; i++, p += 3, rgb += 3) {
+            rgb[0] = p[2];
+            rgb[1] = p[1];
+            rgb[2] = p[0];
+        }
+        break;
+    }
+    case 16:
+    case 32: {
+        const uint32_t bytes = bmp->bpp / 8u;
+        const uint8_t *p = row + x * bytes;
+        for (uint32_t i = 0; i < n; i++, p += bytes, rgb += 3) {
+            const uint32_t px = bytes == 2 ? bmp_le16(p) : bmp_le32(p);
+            rgb[0] = bmp_channel_get(&bmp->ch[0], px);
+            rgb[1] = bmp_channel_get(&bmp->ch[1], px);
+            rgb[2] = bmp_channel_get(&bmp->ch[2], px);
+        }
+        break;
+    }
+    default: {
+        /* 1/4/8-bit palette indices, MSB first */
+        const uint32_t depth = bmp->bpp;
+        const uint32_t mask = (1u << depth) - 1u;
+        for (uint32_t i = 0; i < n; i++, rgb += 3) {
+            const uint32_t bit = (x + i) * depth;
+            const uint32_t idx = (row[bit >> 3] >> (8u - depth - (bit & 7u))) & mask;
+            if (idx < bmp->pal_count) {
+                memcpy(rgb, bmp->palette[idx], 3);
+            } else {
+                rgb[0] = rgb[1] = rgb[2] = 0;
+            }
+        }
+        break;
+    }
+    }
+}
@@ -0,0 +1,898 @@
+#include "img_png.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#define TAG "img_png"
+
+#define PNG_IN_BUF_SIZE     1024u
+#define PNG_FAST_BITS       9u          /* Huffman lookup table width */
+#define PNG_MAX_LIT         288u
+#define PNG_MAX_DIST        30u
+#define PNG_RGB_CHUNK       32u         /* Pixels converted per row sink call */
+#define PNG_MAX_PAD_BYTES   4u          /* Zero bytes fed past the end before calling it truncated */
+
+#define PNG_CHUNK(a, b, c, d) (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+
+typedef struct {
+    uint16_t count[16];                 /* Codes per length */
+    uint16_t symbol[PNG_MAX_LIT];       /* Symbols in canonical order */
+    uint16_t fast[1u << PNG_FAST_BITS]; /* (len << 9) | symbol for codes <= PNG_FAST_BITS, 0 otherwise */
+} png_huff_t;
+
+typedef struct {
+    lv_fs_file_t *file;
+    uint8_t in[PNG_IN_BUF_SIZE];
+    uint32_t in_pos;
+    uint32_t in_len;
+    bool io_error;
+
+    /* IDAT byte stream */
+    uint32_t idat_left;                 /* Bytes left in the current IDAT chunk */
+    bool idat_end;
+    uint32_t bitbuf;
+    uint32_t bitcnt;
+    uint32_t pad;
+    bool truncated;
+
+    /* Inflate */
+    png_huff_t lit;
+    png_huff_t dist;
+    uint8_t *win;
+    uint32_t win_size;
+    uint32_t win_pos;                   /* Total bytes produced (window index = win_pos & (win_size - 1)) */
+    bool corrupt;
+
+    /* Image */
+    uint32_t width;
+    uint32_t height;
+    uint8_t depth;
+    uint8_t color_type;
+    uint8_t channels;
+    uint32_t bpp;                       /* Filter distance in bytes */
+    uint32_t row_bytes;                 /* Without the filter byte */
+    uint8_t *cur;
+    uint8_t *prev;
+    uint32_t row_fill;
+    uint32_t rows_done;
+    bool done;
+    esp_err_t sink_err;
+
+    uint8_t palette[256][3];
+    uint8_t pal_alpha[256];
+    uint16_t pal_count;
+    bool has_key;
+    uint16_t key[3];                    /* tRNS color key for gray / truecolor */
+
+    img_stream_rows_t rows;
+} png_dec_t;
+
+/**
+ * @brief Fill the input buffer from the file. Sets @c io_error on read failure.
+ *
+ * @return Number of bytes now available.
+ */
+static uint32_t png_fill(png_dec_t *d);
+
+/**
+ * @brief Read exactly @p len bytes of raw file data.
+ */
+static bool png_read(png_dec_t *d, void *buf, uint32_t len);
+
+/**
+ * @brief Skip @p len bytes of raw file data.
+ */
+static bool png_skip(png_dec_t *d, uint32_t len);
+
+/**
+ * @brief Read a big-endian 32-bit value.
+ */
+static uint32_t png_be32(const uint8_t *p);
+
+/**
+ * @brief Parse chunks up to the first IDAT (IHDR, PLTE, tRNS; others are skipped).
+ */
+static esp_err_t png_read_header(png_dec_t *d);
+
+/**
+ * @brief Next byte of the concatenated IDAT payload, or -1 at the end of the image data.
+ */
+static int png_idat_byte(png_dec_t *d);
+
+/**
+ * @brief Top the bit buffer up to at least 25 bits, padding with zeros past the end.
+ */
+static void png_refill(png_dec_t *d);
+
+/**
+ * @brief Take @p n (<= 16) bits from the deflate stream, LSB first.
+ */
+static uint32_t png_bits(png_dec_t *d, uint32_t n);
+
+/**
+ * @brief Build canonical Huffman tables from code lengths (puff-style, plus a fast table).
+ *
+ * @return 0 if complete, > 0 if incomplete, < 0 if over-subscribed.
+ */
+static int png_huff_build(png_huff_t *h, const uint8_t *lens, uint32_t n);
+
+/**
+ * @brief Decode one Huffman symbol, or -1 on an invalid code.
+ */
+static int png_huff_decode(png_dec_t *d, const png_huff_t *h);
+
+/**
+ * @brief Inflate the zlib stream until the final block ends or every row is out.
+ */
+static void png_inflate(png_dec_t *d);
+
+/**
+ * @brief Copy a stored (uncompressed) deflate block.
+ */
+static void png_inflate_stored(png_dec_t *d);
+
+/**
+ * @brief Read the dynamic Huffman code definitions of a block into @c lit / @c dist.
+ */
+static bool png_inflate_dynamic_tables(png_dec_t *d);
+
+/**
+ * @brief Decode literal/length + distance codes until end of block.
+ */
+static void png_inflate_codes(png_dec_t *d);
+
+/**
+ * @brief Append one inflated byte to the window and the current scanline.
+ */
+static inline void png_out(png_dec_t *d, uint8_t b);
+
+/**
+ * @brief Unfilter the completed scanline, convert it and hand it to the row sink.
+ */
+static void png_row_done(png_dec_t *d);
+
+/**
+ * @brief Reverse the PNG filter of one scanline in place.
+ *
+ * @return false on an unknown filter type.
+ */
+static bool png_unfilter(uint8_t filter, uint8_t *row, const uint8_t *prev, uint32_t len, uint32_t bpp);
+
+/**
+ * @brief Convert pixel @p x of an unfiltered scanline to RGB composited over black.
+ */
+static inline void png_pixel(const png_dec_t *d, const uint8_t *row, uint32_t x, uint8_t *rgb);
+
+static const uint16_t s_len_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t s_len_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t s_dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t s_dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+esp_err_t img_png_draw(const img_stream_cfg_t *cfg)
+{
+    if (!cfg || !cfg->file || !cfg->draw || !cfg->max_w || !cfg->max_h) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    png_dec_t *d = heap_caps_calloc(1, sizeof(*d), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!d) {
+        return ESP_ERR_NO_MEM;
+    }
+    d->file = cfg->file;
+
+    esp_err_t err = ESP_OK;
+    if (lv_fs_seek(d->file, 0, LV_FS_SEEK_SET) != LV_FS_RES_OK) {
+        err = ESP_FAIL;
+        goto cleanup;
+    }
+
+    err = png_read_header(d);
+    if (err != ESP_OK) {
+        goto cleanup;
+    }
+
+    err = img_stream_rows_begin(&d->rows, cfg, d->width, d->height, false);
+    if (err != ESP_OK) {
+        goto cleanup;
+    }
+
+    d->cur = heap_caps_malloc(d->row_bytes + 1u, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    d->prev = heap_caps_calloc(1, d->row_bytes + 1u, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!d->cur || !d->prev) {
+        ESP_LOGE(TAG, "Failed to allocate %lu B scanlines", (unsigned long)(2u * (d->row_bytes + 1u)));
+        err = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    png_inflate(d);
+
+    if (d->sink_err != ESP_OK) {
+        err = d->sink_err;
+    } else if (d->win_size == 0 && !d->corrupt && !d->io_error && !d->truncated) {
+        err = ESP_ERR_NO_MEM;           /* Window allocation failed */
+    } else if (d->io_error) {
+        err = ESP_FAIL;
+    } else if (d->rows_done < d->height && (d->truncated || !d->corrupt)) {
+        ESP_LOGW(TAG, "Image data ends after %lu of %lu rows",
+                 (unsigned long)d->rows_done, (unsigned long)d->height);
+        err = img_stream_rows_flush(&d->rows);
+    } else if (d->corrupt && d->rows_done < d->height) {
+        ESP_LOGE(TAG, "Corrupt deflate stream at row %lu", (unsigned long)d->rows_done);
+        err = ESP_ERR_INVALID_RESPONSE;
+    }
+
+cleanup:
+    img_stream_rows_end(&d->rows);
+    free(d->win);
+    free(d->cur);
+    free(d->prev);
+    free(d);
+    return err;
+}
+
+static uint32_t png_fill(png_dec_t *d)
+{
+    if (d->in_pos < d->in_len) {
+        return d->in_len - d->in_pos;
+    }
+    uint32_t br = 0;
+    if (lv_fs_read(d->file, d->in, sizeof(d->in), &br) != LV_FS_RES_OK) {
+        d->io_error = true;
+        br = 0;
+    }
+    d->in_pos = 0;
+    d->in_len = br;
+    return br;
+}
+
+static bool png_read(png_dec_t *d, void *buf, uint32_t len)
+{
+    uint8_t *dst = buf;
+    while (len) {
+        uint32_t avail = png_fill(d);
+        if (!avail) {
+            return false;
+        }
+        uint32_t n = avail < len ? avail : len;
+        memcpy(dst, d->in + d->in_pos, n);
+        d->in_pos += n;
+        dst += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool png_skip(png_dec_t *d, uint32_t len)
+{
+    uint32_t avail = d->in_len - d->in_pos;
+    if (len <= avail) {
+        d->in_pos += len;
+        return true;
+    }
+    len -= avail;
+    d->in_pos = d->in_len = 0;
+    return lv_fs_seek(d->file, len, LV_FS_SEEK_CUR) == LV_FS_RES_OK;
+}
+
+static uint32_t png_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static esp_err_t png_read_header(png_dec_t *d)
+{
+    static const uint8_t sig[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    uint8_t buf[13];
+    if (!png_read(d, buf, 8)) {
+        return d->io_error ? ESP_FAIL : ESP_ERR_NOT_SUPPORTED;
+    }
+    if (memcmp(buf, sig, sizeof(sig)) != 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    bool have_ihdr = false;
+    for (int i = 0; i < 256; i++) {
+        d->pal_alpha[i] = 255;
+    }
+
+    for (;;) {
+        if (!png_read(d, buf, 8)) {
+            return d->io_error ? ESP_FAIL : ESP_ERR_INVALID_RESPONSE;
+        }
+        const uint32_t len = png_be32(buf);
+        const uint32_t type = png_be32(buf + 4);
+        if (len > 0x7FFFFFFFu) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+
+        if (type == PNG_CHUNK('I', 'H', 'D', 'R')) {
+            if (len != 13 || !png_read(d, buf, 13) || !png_skip(d, 4)) {
+                return d->io_error ? ESP_FAIL : ESP_ERR_INVALID_RESPONSE;
+            }
+            d->width = png_be32(buf);
+            d->height = png_be32(buf + 4);
+            d->depth = buf[8];
+            d->color_type = buf[9];
+            if (buf[10] != 0 || buf[11] != 0) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            if (buf[12] != 0) {
+                ESP_LOGE(TAG, "Interlaced PNGs are not supported");
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            switch (d->color_type) {
+            case 0: d->channels = 1; break;
+            case 2: d->channels = 3; break;
+            case 3: d->channels = 1; break;
+            case 4: d->channels = 2; break;
+            case 6: d->channels = 4; break;
+            default: return ESP_ERR_INVALID_RESPONSE;
+            }
+            const uint8_t dp = d->depth;
+            const bool depth_ok = (dp == 8) ||
+                                  (dp == 16 && d->color_type != 3) ||
+                                  ((dp == 1 || dp == 2 || dp == 4) && (d->color_type == 0 || d->color_type == 3));
+            if (!depth_ok || !d->width || !d->height || d->width > 0xFFFFu || d->height > 0xFFFFu) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            const uint32_t bits = (uint32_t)d->channels * d->depth;
+            d->row_bytes = (d->width * bits + 7u) / 8u;
+            d->bpp = bits >= 8 ? bits / 8u : 1u;
+            have_ihdr = true;
+        } else if (!have_ihdr) {
+            return ESP_ERR_INVALID_RESPONSE;
+        } else if (type == PNG_CHUNK('P', 'L', 'T', 'E')) {
+            if (len % 3u || len > 768u || !png_read(d, d->palette, len) || !png_skip(d, 4)) {
+                return d->io_error ? ESP_FAIL : ESP_ERR_INVALID_RESPONSE;
+            }
+            d->pal_count = (uint16_t)(len / 3u);
+        } else if (type == PNG_CHUNK('t', 'R', 'N', 'S')) {
+            uint8_t t[256];
+            const uint32_t n = len < sizeof(t) ? len : sizeof(t);
+            if (!png_read(d, t, n) || !png_skip(d, len - n + 4u)) {
+                return d->io_error ? ESP_FAIL : ESP_ERR_INVALID_RESPONSE;
+            }
+            if (d->color_type == 3) {
+                memcpy(d->pal_alpha, t, n);
+            } else if (d->color_type == 0 && n >= 2) {
+                d->key[0] = (uint16_t)((t[0] << 8) | t[1]);
+                d->has_key = true;
+            } else if (d->color_type == 2 && n >= 6) {
+                for (int c = 0; c < 3; c++) {
+                    d->key[c] = (uint16_t)((t[2 * c] << 8) | t[2 * c + 1]);
+                }
+                d->has_key = true;
+            }
+        } else if (type == PNG_CHUNK('I', 'D', 'A', 'T')) {
+            if (d->color_type == 3 && !d->pal_count) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            d->idat_left = len;
+            return ESP_OK;
+        } else if (type == PNG_CHUNK('I', 'E', 'N', 'D')) {
+            return ESP_ERR_INVALID_RESPONSE;
+        } else if (!png_skip(d, len + 4u)) {
+            return ESP_FAIL;
+        }
+    }
+}
+
+static int png_idat_byte(png_dec_t *d)
+{
+    while (d->idat_left == 0) {
+        if (d->idat_end) {
+            return -1;
+        }
+        /* CRC of the finished chunk, then the next chunk header */
+        uint8_t hdr[12];
+        if (!png_read(d, hdr, sizeof(hdr)) || png_be32(hdr + 8) != PNG_CHUNK('I', 'D', 'A', 'T')) {
+            d->idat_end = true;
+            return -1;
+        }
+        d->idat_left = png_be32(hdr + 4);
+    }
+    if (d->in_pos == d->in_len && !png_fill(d)) {
+        d->idat_end = true;
+        return -1;
+    }
+    d->idat_left--;
+    return d->in[d->in_pos++];
+}
+
+static void png_refill(png_dec_t *d)
+{
+    while (d->bitcnt <= 24) {
+        int c = png_idat_byte(d);
+        if (c < 0) {
+            if (++d->pad > PNG_MAX_PAD_BYTES) {
+                d->truncated = true;
+            }
+            c = 0;
+        }
+        d->bitbuf |= (uint32_t)c << d->bitcnt;
+        d->bitcnt += 8;
+    }
+}
+
+static uint32_t png_bits(png_dec_t *d, uint32_t n)
+{
+    if (d->bitcnt < n) {
+        png_refill(d);
+    }
+    const uint32_t v = d->bitbuf & ((1u << n) - 1u);
+    d->bitbuf >>= n;
+    d->bitcnt -= n;
+    return v;
+}
+
+static int png_huff_build(png_huff_t *h, const uint8_t *lens, uint32_t n)
+{
+    memset(h->count, 0, sizeof(h->count));
+    memset(h->fast, 0, sizeof(h->fast));
+    for (uint32_t i = 0; i < n; i++) {
+        h->count[lens[i]]++;
+    }
+    if (h->count[0] == n) {
+        return 0;                       /* No codes: complete, but decoding will fail */
+    }
+
+    int left = 1;
+    for (int len = 1; len < 16; len++) {
+        left <<= 1;
+        left -= h->count[len];
+        if (left < 0) {
+            return left;
+        }
+    }
+
+    uint16_t offs[16];
+    offs[1] = 0;
+    for (int len = 1; len < 15; len++) {
+        offs[len + 1] = offs[len] + h->count[len];
+    }
+    for (uint32_t sym = 0; sym < n; sym++) {
+        if (lens[sym]) {
+            h->symbol[offs[lens[sym]]++] = (uint16_t)sym;
+        }
+    }
+
+    /* Deflate packs codes MSB-first into an LSB-first stream: index the fast table by reversed code */
+    uint32_t code = 0;
+    uint32_t idx = 0;
+    for (uint32_t len = 1; len <= PNG_FAST_BITS; len++) {
+        for (uint32_t k = 0; k < h->count[len]; k++, code++, idx++) {
+            uint32_t rev = 0;
+            for (uint32_t b = 0; b < len; b++) {
+                rev |= ((code >> b) & 1u) << (len - 1u - b);
+            }
+            for (uint32_t e = rev; e < (1u << PNG_FAST_BITS); e += 1u << len) {
+                h->fast[e] = (uint16_t)((len << 9) | h->symbol[idx]);
+            }
+        }
+        code <<= 1;
+    }
+    return left;
+}
+
+static int png_huff_decode(png_dec_t *d, const png_huff_t *h)
+{
+    if (d->bitcnt < 16) {
+        png_refill(d);
+    }
+    const uint16_t e = h->fast[d->bitbuf & ((1u << PNG_FAST_BITS) - 1u)];
+    if (e) {
+        const uint32_t len = e >> 9;
+        d->bitbuf >>= len;
+        d->bitcnt -= len;
+        return e & 0x1FF;
+    }
+
+    /* Long code: walk the canonical code one bit at a time */
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len < 16; len++) {
+        code |= (int)png_bits(d, 1);
+        const int count = h->count[len];
+        if (code - count < first) {
+            return h->symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static void png_inflate(png_dec_t *d)
+{
+    const uint32_t cmf = png_bits(d, 8);
+    const uint32_t flg = png_bits(d, 8);
+    if ((cmf & 0x0F) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31u != 0 || (flg & 0x20)) {
+        d->corrupt = true;
+        return;
+    }
+
+    /* The encoder never refers further back than its declared window */
+    d->win_size = 1u << ((cmf >> 4) + 8);
+    d->win = heap_caps_malloc(d->win_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!d->win) {
+        ESP_LOGE(TAG, "Failed to allocate the %lu B inflate window", (unsigned long)d->win_size);
+        d->win_size = 0;
+        return;
+    }
+
+    bool final = false;
+    while (!final && !d->done && !d->corrupt && !d->truncated && !d->io_error) {
+        final = png_bits(d, 1);
+        switch (png_bits(d, 2)) {
+        case 0:
+            png_inflate_stored(d);
+            break;
+        case 1: {
+            uint8_t lens[PNG_MAX_LIT];
+            memset(lens, 8, 144);
+            memset(lens + 144, 9, 112);
+            memset(lens + 256, 7, 24);
+            memset(lens + 280, 8, 8);
+            png_huff_build(&d->lit, lens, PNG_MAX_LIT);
+            memset(lens, 5, PNG_MAX_DIST);
+            png_huff_build(&d->dist, lens, PNG_MAX_DIST);
+            png_inflate_codes(d);
+            break;
+        }
+        case 2:
+            if (png_inflate_dynamic_tables(d)) {
+                png_inflate_codes(d);
+            }
+            break;
+        default:
+            d->corrupt = true;
+            break;
+        }
+    }
+}
+
+static void png_inflate_stored(png_dec_t *d)
+{
+    /* Drop to the byte boundary; whole bytes still in the bit buffer are consumed first */
+    png_bits(d, d->bitcnt & 7u);
+    const uint32_t len = png_bits(d, 16);
+    const uint32_t nlen = png_bits(d, 16);
+    if (len != (~nlen & 0xFFFFu)) {
+        d->corrupt = true;
+        return;
+    }
+    for (uint32_t i = 0; i < len && !d->done && !d->truncated; i++) {
+        png_out(d, (uint8_t)png_bits(d, 8));
+    }
+}
+
+static bool png_inflate_dynamic_tables(png_dec_t *d)
+{
+    static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    uint8_t lens[PNG_MAX_LIT + PNG_MAX_DIST];
+
+    const uint32_t nlen = png_bits(d, 5) + 257u;
+    const uint32_t ndist = png_bits(d, 5) + 1u;
+    const uint32_t ncode = png_bits(d, 4) + 4u;
+    if (nlen > PNG_MAX_LIT || ndist > PNG_MAX_DIST) {
+        d->corrupt = true;
+        return false;
+    }
+
+    memset(lens, 0, 19);
+    for (uint32_t i = 0; i < ncode; i++) {
+        lens[order[i]] = (uint8_t)png_bits(d, 3);
+    }
+    /* The code-length code must be complete; build it in the distance table slot */
+    if (png_huff_build(&d->dist, lens, 19) != 0) {
+        d->corrupt = true;
+        return false;
+    }
+
+    uint32_t index = 0;
+    while (index < nlen + ndist) {
+        int sym = png_huff_decode(d, &d->dist);
+        if (sym < 0 || d->truncated) {
+            d->corrupt = true;
+            return false;
+        }
+        if (sym < 16) {
+            lens[index++] = (uint8_t)sym;
+            continue;
+        }
+        uint8_t len = 0;
+        uint32_t rep;
+        if (sym == 16) {
+            if (index == 0) {
+                d->corrupt = true;
+                return false;
+            }
+            len = lens[index - 1];
+            rep = 3u + png_bits(d, 2);
+        } else if (sym == 17) {
+            rep = 3u + png_bits(d, 3);
+        } else {
+            rep = 11u + png_bits(d, 7);
+        }
+        if (index + rep > nlen + ndist) {
+            d->corrupt = true;
+            return false;
+        }
+        while (rep--) {
+            lens[index++] = len;
+        }
+    }
+    if (lens[256] == 0) {
+        d->corrupt = true;              /* No end-of-block code */
+        return false;
+    }
+
+    /* Incomplete codes are only allowed when a single code is used */
+    int err = png_huff_build(&d->lit, lens, nlen);
+    if (err < 0 || (err > 0 && nlen - d->lit.count[0] != 1)) {
+        d->corrupt = true;
+        return false;
+    }
+    err = png_huff_build(&d->dist, lens + nlen, ndist);
+    if (err < 0 || (err > 0 && ndist - d->dist.count[0] != 1)) {
+        d->corrupt = true;
+        return false;
+    }
+    return true;
+}
+
+static void png_inflate_codes(png_dec_t *d)
+{
+    const uint32_t mask = d->win_size - 1u;
+    while (!d->done) {
+        int sym = png_huff_decode(d, &d->lit);
+        if (d->truncated) {
+            return;
+        }
+        if (sym < 0) {
+            d->corrupt = true;
+            return;
+        }
+        if (sym < 256) {
+            png_out(d, (uint8_t)sym);
+            continue;
+        }
+        if (sym == 256) {
+            return;
+        }
+
+        sym -= 257;
+        if (sym >= 29) {
+            d->corrupt = true;
+            return;
+        }
+        uint32_t len = s_len_base[sym] + png_bits(d, s_len_extra[sym]);
+        int dsym = png_huff_decode(d, &d->dist);
+        if (dsym < 0 || dsym >= (int)PNG_MAX_DIST) {
+            d->corrupt = true;
+            return;
+        }
+        const uint32_t dist = s_dist_base[dsym] + png_bits(d, s_dist_extra[dsym]);
+        if (dist > d->win_size || dist > d->win_pos) {
+            d->corrupt = true;
+            return;
+        }
+        while (len-- && !d->done) {
+            png_out(d, d->win[(d->win_pos - dist) & mask]);
+        }
+    }
+}
+
+static inline void png_out(png_dec_t *d, uint8_t b)
+{
+    d->win[d->win_pos++ & (d->win_size - 1u)] = b;
+    d->cur[d->row_fill++] = b;
+    if (d->row_fill == d->row_bytes + 1u) {
+        png_row_done(d);
+    }
+}
+
+static void png_row_done(png_dec_t *d)
+{
+    d->row_fill = 0;
+    if (!png_unfilter(d->cur[0], d->cur + 1, d->prev + 1, d->row_bytes, d->bpp)) {
+        d->corrupt = true;
+        d->done = true;
+        return;
+    }
+
+    const uint8_t *row = d->cur + 1;
+    uint8_t rgb[PNG_RGB_CHUNK * 3];
+    for (uint32_t x = 0; x < d->width; ) {
+        uint32_t n = d->width - x < PNG_RGB_CHUNK ? d->width - x : PNG_RGB_CHUNK;
+        for (uint32_t i = 0; i < n; i++) {
+            png_pixel(d, row, x + i, rgb + i * 3u);
+        }
+        img_stream_rows_put(&d->rows, rgb, n);
+        x += n;
+    }
+    esp_err_t err = img_stream_rows_next(&d->rows);
+    if (err != ESP_OK) {
+        d->sink_err = err;
+        d->done = true;
+        return;
+    }
+
+    uint8_t *t = d->prev;
+    d->prev = d->cur;
+    d->cur = t;
+    if (++d->rows_done == d->height) {
+        d->done = true;
+    }
+}
+
+static bool png_unfilter(uint8_t filter, uint8_t *row, const uint8_t *prev, uint32_t len, uint32_t bpp)
+{
+    uint32_t i;
+    switch (filter) {
+    case 0:
+        break;
+    case 1:
+        for (i = bpp; i < len; i++) {
+            row[i] = (uint8_t)(row[i] + row[i - bpp]);
+        }
+        break;
+    case 2:
+        for (i = 0; i < len; i++) {
+            row[i] = (uint8_t)(row[i] + prev[i]);
+        }
+        break;
+    case 3:
+        for (i = 0; i < bpp && i < len; i++) {
+            row[i] = (uint8_t)(row[i] + (prev[i] >> 1));
+        }
+        for (; i < len; i++) {
+            row[i] = (uint8_t)(row[i] + ((row[i - bpp] + prev[i]) >> 1));
+        }
+        break;
+    case 4:
+        for (i = 0; i < bpp && i < len; i++) {
+            row[i] = (uint8_t)(row[i] + prev[i]);
+        }
+        for (; i < len; i++) {
+            const int a = row[i - bpp];
+            const int b = prev[i];
+            const int c = prev[i - bpp];
+            const int p = a + b - c;
+            const int pa = abs(p - a);
+            const int pb = abs(p - b);
+            const int pc = abs(p - c);
+            const int pred = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+            row[i] = (uint8_t)(row[i] + pred);
+        }
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+static inline void png_pixel(const png_dec_t *d, const uint8_t *row, uint32_t x, uint8_t *rgb)
+{
+    uint32_t r;
+    uint32_t g;
+    uint32_t b;
+    uint32_t a = 255;
+
+    if (d->depth < 8) {
+        const uint32_t bit = x * d->depth;
+        const uint32_t v = (row[bit >> 3] >> (8u - d->depth - (bit & 7u))) & ((1u << d->depth) - 1u);
+        if (d->color_type == 3) {
+            if (v >= d->pal_count) {
+                rgb[0] = rgb[1] = rgb[2] = 0;
+                return;
+            }
+            r = d->palette[v][0];
+            g = d->palette[v][1];
+            b = d->palette[v][2];
+            a = d->pal_alpha[v];
+        } else {
+            r = g = b = v * 255u / ((1u << d->depth) - 1u);
+            if (d->has_key && v == d->key[0]) {
+                a = 0;
+            }
+        }
+    } else if (d->depth == 8) {
+        const uint8_t *p = row + x * d->channels;
+        switch (d->color_type) {
+        case 0:
+            r = g = b = p[0];
+            if (d->has_key && p[0] == d->key[0]) {
+                a = 0;
+            }
+            break;
+        case 2:
+            r = p[0];
+            g = p[1];
+            b = p[2];
+            if (d->has_key && r == d->key[0] && g == d->key[1] && b == d->key[2]) {
+                a = 0;
+            }
+            break;
+        case 3:
+            if (p[0] >= d->pal_count) {
+                rgb[0] = rgb[1] = rgb[2] = 0;
+                return;
+            }
+            r = d->palette[p[0]][0];
+            g = d->palette[p[0]][1];
+            b = d->palette[p[0]][2];
+            a = d->pal_alpha[p[0]];
+            break;
+        case 4:
+            r = g = b = p[0];
+            a = p[1];
+            break;
+        default:
+            r = p[0];
+            g = p[1];
+            b = p[2];
+            a = p[3];
+            break;
+        }
+    } else {
+        /* 16-bit samples: keep the high byte, compare the full value against the key */
+        const uint8_t *p = row + x * d->channels * 2u;
+        switch (d->color_type) {
+        case 0:
+            r = g = b = p[0];
+            if (d->has_key && (uint16_t)((p[0] << 8) | p[1]) == d->key[0]) {
+                a = 0;
+            }
+            break;
+        case 2:
+            r = p[0];
+            g = p[2];
+            b = p[4];
+            if (d->has_key && (uint16_t)((p[0] << 8) | p[1]) == d->key[0] &&
+                (uint16_t)((p[2] << 8) | p[3]) == d->key[1] && (uint16_t)((p[4] << 8) | p[5]) == d->key[2]) {
+                a = 0;
+            }
+            break;
+        case 4:
+            r = g = b = p[0];
+            a = p[2];
+            break;
+        default:
+            r = p[0];
+            g = p[2];
+            b = p[4];
+            a = p[6];
+            break;
+        }
+    }
+
+    if (a != 255) {
+        /* Composite over the black viewer background: c * a / 255 */
+        r = (r * a + 128u + ((r * a + 128u) >> 8)) >> 8;
+        g = (g * a + 128u + ((g * a + 128u) >> 8)) >> 8;
+        b = (b * a + 128u + ((b * a + 128u) >> 8)) >> 8;
+    }
+    rgb[0] = (uint8_t)r;
+    rgb[1] = (uint8_t)g;
+    rgb[2] = (uint8_t)b;
+}
@@ -0,0 +1,210 @@
+#include "img_stream.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#define TAG "img_stream"
+
+#define IMG_STREAM_BAND_ROWS   8u      /* Output rows per stripe */
+
+/**
+ * @brief Pack 8-bit RGB into byte-swapped RGB565 as the SPI panel expects it.
+ */
+static inline uint16_t img_stream_pack565(uint32_t r, uint32_t g, uint32_t b);
+
+/**
+ * @brief Row of the current stripe that receives the output row being assembled.
+ */
+static uint16_t *img_stream_slot(img_stream_rows_t *rows);
+
+/**
+ * @brief Hand the current stripe to the sink and switch to the other one.
+ */
+static esp_err_t img_stream_emit(img_stream_rows_t *rows);
+
+bool img_stream_pick_scale(uint32_t w, uint32_t h, uint32_t bw, uint32_t bh,
+                           uint8_t *scale, uint32_t *out_w, uint32_t *out_h)
+{
+    uint8_t s = 0;
+    while (s < 3 && (w > bw || h > bh)) {
+        s++;
+        w = (w + 1) >> 1;
+        h = (h + 1) >> 1;
+    }
+    *scale = s;
+    *out_w = w;
+    *out_h = h;
+    return w <= bw && h <= bh;
+}
+
+esp_err_t img_stream_rows_begin(img_stream_rows_t *rows, const img_stream_cfg_t *cfg,
+                                uint32_t w, uint32_t h, bool bottom_up)
+{
+    memset(rows, 0, sizeof(*rows));
+    rows->cfg = cfg;
+    rows->src_w = w;
+    rows->src_h = h;
+    rows->bottom_up = bottom_up;
+    rows->src_y = bottom_up ? h - 1u : 0;
+
+    if (!w || !h || !img_stream_pick_scale(w, h, cfg->max_w, cfg->max_h, &rows->scale, &rows->out_w, &rows->out_h)) {
+        ESP_LOGE(TAG, "Image %lux%lu does not fit %ux%u even at 1/8 scale",
+                 (unsigned long)w, (unsigned long)h, cfg->max_w, cfg->max_h);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    rows->band_h = rows->out_h < IMG_STREAM_BAND_ROWS ? rows->out_h : IMG_STREAM_BAND_ROWS;
+    const size_t stripe_bytes = (size_t)rows->out_w * rows->band_h * sizeof(uint16_t);
+    for (int i = 0; i < 2; i++) {
+        rows->stripe[i] = heap_caps_malloc(stripe_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!rows->stripe[i]) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (rows->scale) {
+        rows->acc = heap_caps_calloc((size_t)rows->out_w * 3u, sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!rows->acc) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGD(TAG, "Streaming %lux%lu scaled 1/%u -> %lux%lu", (unsigned long)w, (unsigned long)h,
+             1u << rows->scale, (unsigned long)rows->out_w, (unsigned long)rows->out_h);
+    if (cfg->size) {
+        cfg->size(cfg->user, rows->out_w, rows->out_h);
+    }
+    return ESP_OK;
+}
+
+void img_stream_rows_put(img_stream_rows_t *rows, const uint8_t *rgb, uint32_t n)
+{
+    if (rows->src_x >= rows->src_w) {
+        return;
+    }
+    if (n > rows->src_w - rows->src_x) {
+        n = rows->src_w - rows->src_x;
+    }
+
+    if (!rows->scale) {
+        uint16_t *dst = img_stream_slot(rows) + rows->src_x;
+        for (uint32_t i = 0; i < n; i++, rgb += 3) {
+            dst[i] = img_stream_pack565(rgb[0], rgb[1], rgb[2]);
+        }
+    } else {
+        const uint8_t s = rows->scale;
+        uint32_t x = rows->src_x;
+        for (uint32_t i = 0; i < n; i++, x++, rgb += 3) {
+            uint32_t *a = rows->acc + (x >> s) * 3u;
+            a[0] += rgb[0];
+            a[1] += rgb[1];
+            a[2] += rgb[2];
+        }
+    }
+    rows->src_x += n;
+}
+
+esp_err_t img_stream_rows_next(img_stream_rows_t *rows)
+{
+    if (img_stream_cancelled(rows->cfg)) {
+        return ESP_FAIL;
+    }
+    if (rows->rows_done >= rows->src_h) {
+        return ESP_OK;
+    }
+
+    const uint8_t s = rows->scale;
+    const uint32_t mask = (1u << s) - 1u;
+    const uint32_t y = rows->src_y;
+    const uint32_t oy = y >> s;
+    const bool complete = rows->bottom_up ? (y & mask) == 0 : (((y + 1u) & mask) == 0 || y + 1u == rows->src_h);
+
+    if (complete) {
+        if (rows->band_rows == 0) {
+            rows->band_y = oy;
+        }
+        if (s) {
+            /* Box average; edge cells cover fewer source pixels */
+            const uint32_t top = oy << s;
+            const uint32_t ch = (rows->src_h - top) < (1u << s) ? rows->src_h - top : (1u << s);
+            uint16_t *dst = img_stream_slot(rows);
+            uint32_t *a = rows->acc;
+            for (uint32_t ox = 0; ox < rows->out_w; ox++, a += 3) {
+                const uint32_t left = ox << s;
+                const uint32_t cw = (rows->src_w - left) < (1u << s) ? rows->src_w - left : (1u << s);
+                const uint32_t cnt = cw * ch;
+                if (cnt == (1u << (2u * s))) {
+                    dst[ox] = img_stream_pack565(a[0] >> (2u * s), a[1] >> (2u * s), a[2] >> (2u * s));
+                } else {
+                    dst[ox] = img_stream_pack565(a[0] / cnt, a[1] / cnt, a[2] / cnt);
+                }
+                a[0] = a[1] = a[2] = 0;
+            }
+        }
+        rows->band_rows++;
+
+        const bool last = rows->bottom_up ? oy == 0 : oy + 1u == rows->out_h;
+        if (rows->band_rows == rows->band_h || last) {
+            esp_err_t err = img_stream_emit(rows);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+
+    rows->src_x = 0;
+    rows->rows_done++;
+    if (rows->bottom_up) {
+        rows->src_y--;
+    } else {
+        rows->src_y++;
+    }
+    return ESP_OK;
+}
+
+esp_err_t img_stream_rows_flush(img_stream_rows_t *rows)
+{
+    return rows->band_rows ? img_stream_emit(rows) : ESP_OK;
+}
+
+void img_stream_rows_end(img_stream_rows_t *rows)
+{
+    free(rows->stripe[0]);
+    free(rows->stripe[1]);
+    free(rows->acc);
+    rows->stripe[0] = rows->stripe[1] = NULL;
+    rows->acc = NULL;
+}
+
+static inline uint16_t img_stream_pack565(uint32_t r, uint32_t g, uint32_t b)
+{
+    uint16_t c = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+    return (uint16_t)((c >> 8) | (c << 8));
+}
+
+static uint16_t *img_stream_slot(img_stream_rows_t *rows)
+{
+    /* Bottom-up bands fill the stripe from its last row upwards */
+    const uint32_t slot = rows->bottom_up ? rows->band_h - 1u - rows->band_rows : rows->band_rows;
+    return rows->stripe[rows->cur] + (size_t)slot * rows->out_w;
+}
+
+static esp_err_t img_stream_emit(img_stream_rows_t *rows)
+{
+    const img_stream_cfg_t *cfg = rows->cfg;
+    const uint32_t n = rows->band_rows;
+    uint32_t y0;
+    const uint16_t *px = rows->stripe[rows->cur];
+    if (rows->bottom_up) {
+        y0 = rows->band_y + 1u - n;
+        px += (size_t)(rows->band_h - n) * rows->out_w;
+    } else {
+        y0 = rows->band_y;
+    }
+
+    rows->band_rows = 0;
+    rows->cur ^= 1u;
+    return cfg->draw(cfg->user, 0, y0, rows->out_w, y0 + n, px) ? ESP_OK : ESP_FAIL;
+}
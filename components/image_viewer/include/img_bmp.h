@@ -0,0 +1,38 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "img_stream.h"
+
+/**
+ * @brief Decode an uncompressed BMP one row at a time and stream it to @p cfg->draw in bands.
+ *
+ * Rows are read in file order, so bottom-up bitmaps (the common case) are drawn
+ * from the bottom band upwards without ever seeking backwards. Only one raw row
+ * (stride = width * bpp / 8 rounded up to 4 bytes) and the row sink buffers are
+ * allocated.
+ *
+ * Supports 1/4/8-bit palettes, 16-bit 5-5-5 and 24-bit BGR, and 16/32-bit
+ * BI_BITFIELDS with OS/2 core, INFO and V4/V5 headers. Alpha is ignored. RLE and
+ * embedded JPEG/PNG compressions are rejected. Truncated files render the rows
+ * that were present.
+ *
+ * @param cfg Decode request.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if @p cfg is incomplete
+ *      - ESP_ERR_NOT_SUPPORTED if the file is not a BMP or uses an unsupported compression
+ *      - ESP_ERR_INVALID_SIZE if the image cannot fit the bounds even at 1/8
+ *      - ESP_ERR_NO_MEM if the row buffer cannot be allocated
+ *      - ESP_ERR_INVALID_RESPONSE on an inconsistent header
+ *      - ESP_FAIL on read errors or if the sink aborted the decode
+ */
+esp_err_t img_bmp_draw(const img_stream_cfg_t *cfg);
+
+#ifdef __cplusplus
+}
+#endif
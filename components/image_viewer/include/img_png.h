@@ -0,0 +1,44 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "img_stream.h"
+
+/**
+ * @brief Decode a PNG one scanline at a time and stream it to @p cfg->draw in bands.
+ *
+ * The zlib stream is inflated incrementally into a sliding window sized from the
+ * zlib header (32 KB for almost every encoder). Each completed scanline is
+ * unfiltered against the previous one, converted to RGB (transparent pixels are
+ * composited over black) and fed to the downscaling row sink.
+ *
+ * Peak memory is independent of the image height:
+ *  - inflate window: up to 32 KB;
+ *  - two raw scanlines (current and previous): 2 * width * bytes-per-pixel;
+ *  - decoder state (Huffman tables, 1 KB input buffer, palette): about 6 KB;
+ *  - row sink: two 8-row DMA stripes plus 12 B per output pixel of width.
+ *
+ * Supports every non-interlaced color type and bit depth (1..16, palette with
+ * tRNS alpha). Adam7 interlaced files are rejected: their passes cannot be
+ * streamed without holding the whole image. Truncated files render the rows
+ * that were complete.
+ *
+ * @param cfg Decode request.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if @p cfg is incomplete
+ *      - ESP_ERR_NOT_SUPPORTED if the file is not a PNG or is interlaced
+ *      - ESP_ERR_INVALID_SIZE if the image cannot fit the bounds even at 1/8
+ *      - ESP_ERR_NO_MEM if the scanline or window buffers cannot be allocated
+ *      - ESP_ERR_INVALID_RESPONSE on corrupt chunk or deflate data
+ *      - ESP_FAIL on read errors or if the sink aborted the decode
+ */
+esp_err_t img_png_draw(const img_stream_cfg_t *cfg);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,127 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+/**
+ * @brief Receives one finished band of panel-order RGB565 pixels.
+ *
+ * Coordinates follow esp_lcd_panel_draw_bitmap(): @p x1 / @p y1 are exclusive.
+ * The buffer stays valid until the callback after next returns (two stripes are
+ * used alternately), so a queued DMA transfer may still be reading it.
+ *
+ * @return Non-zero to continue, 0 to abort the decode.
+ */
+typedef int (*img_stream_draw_cb_t)(void *user, uint32_t x0, uint32_t y0,
+                                    uint32_t x1, uint32_t y1, const uint16_t *pixels);
+
+/**
+ * @brief Reports the output size once the scale is chosen, before the first band.
+ */
+typedef void (*img_stream_size_cb_t)(void *user, uint32_t w, uint32_t h);
+
+/**
+ * @brief Streaming decode request shared by the progressive JPEG, PNG and BMP decoders.
+ */
+typedef struct {
+    lv_fs_file_t *file;                 /**< Open image file; decoding starts from offset 0 */
+    uint16_t max_w;                     /**< Output bounds (panel size) */
+    uint16_t max_h;
+    img_stream_draw_cb_t draw;          /**< Band sink */
+    img_stream_size_cb_t size;          /**< Optional output size notification */
+    void *user;                         /**< Passed to @ref draw and @ref size */
+    const volatile bool *cancel;        /**< Optional abort flag, polled once per source row / MCU row */
+} img_stream_cfg_t;
+
+/**
+ * @brief Returns true once the request's cancel flag has been raised.
+ */
+static inline bool img_stream_cancelled(const img_stream_cfg_t *cfg)
+{
+    return cfg->cancel && *cfg->cancel;
+}
+
+/**
+ * @brief Downscaling row sink: turns source rows of RGB888 into RGB565 bands.
+ *
+ * Each output pixel is the box average of a 2^scale x 2^scale block of source
+ * pixels, so besides the two DMA stripes only one row of 32-bit accumulators
+ * (3 per output pixel) is kept. Rows may arrive top-down or bottom-up (BMP).
+ */
+typedef struct {
+    const img_stream_cfg_t *cfg;
+    uint32_t src_w;
+    uint32_t src_h;
+    uint32_t out_w;
+    uint32_t out_h;
+    uint8_t scale;
+    bool bottom_up;
+    uint32_t src_y;                     /* Image row currently being filled */
+    uint32_t src_x;                     /* Pixels already put into that row */
+    uint32_t rows_done;                 /* Source rows completed */
+    uint32_t *acc;                      /* out_w * 3 accumulators (scale > 0 only) */
+    uint16_t *stripe[2];
+    uint8_t cur;
+    uint32_t band_h;
+    uint32_t band_rows;                 /* Output rows already in the current stripe */
+    uint32_t band_y;                    /* Output row of the band's first (top-down) or last row */
+} img_stream_rows_t;
+
+/**
+ * @brief Pick the smallest power-of-two downscale (up to 1/8) that fits the bounds.
+ *
+ * @return true if the image fits at some scale up to 1/8.
+ */
+bool img_stream_pick_scale(uint32_t w, uint32_t h, uint32_t bw, uint32_t bh,
+                           uint8_t *scale, uint32_t *out_w, uint32_t *out_h);
+
+/**
+ * @brief Choose the scale, allocate the accumulators and stripes and announce the output size.
+ *
+ * @param rows      Sink to initialise.
+ * @param cfg       Decode request (bounds and callbacks).
+ * @param w         Source width.
+ * @param h         Source height.
+ * @param bottom_up true if rows arrive from the last image row upwards.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_SIZE if the image does not fit even at 1/8
+ *      - ESP_ERR_NO_MEM if the buffers cannot be allocated
+ */
+esp_err_t img_stream_rows_begin(img_stream_rows_t *rows, const img_stream_cfg_t *cfg,
+                                uint32_t w, uint32_t h, bool bottom_up);
+
+/**
+ * @brief Append @p n RGB888 pixels to the current source row.
+ */
+void img_stream_rows_put(img_stream_rows_t *rows, const uint8_t *rgb, uint32_t n);
+
+/**
+ * @brief Close the current source row, drawing a band when a stripe fills up.
+ *
+ * @return ESP_OK, or ESP_FAIL if the sink aborted or the request was cancelled.
+ */
+esp_err_t img_stream_rows_next(img_stream_rows_t *rows);
+
+/**
+ * @brief Flush the partially filled band (truncated images draw what was decoded).
+ *
+ * @return ESP_OK, or ESP_FAIL if the sink aborted.
+ */
+esp_err_t img_stream_rows_flush(img_stream_rows_t *rows);
+
+/**
+ * @brief Release the sink buffers. Safe on a zeroed or partially initialised sink.
+ */
+void img_stream_rows_end(img_stream_rows_t *rows);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,32 +4,131 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include "esp_err.h"
 #include "lvgl.h"
 
+/**
+ * @brief Resolve the viewable image next to @p current in the browsed directory.
+ *
+ * Called from the LVGL task when the user swipes or the slideshow advances.
+ *
+ * @param user    Opaque pointer from jpg_viewer_open_opts_t::user.
+ * @param current Path of the image currently shown (as passed to the viewer).
+ * @param dir     +1 for the next image, -1 for the previous one.
+ * @param out     Buffer receiving the drive-prefixed path of the neighbour.
+ * @param out_len Size of @p out.
+ *
+ * @return true if @p out holds a different image, false if there is none.
+ */
+typedef bool (*jpg_viewer_step_cb_t)(void *user, const char *current, int dir, char *out, size_t out_len);
+
+/**
+ * @brief Report that the image passed to jpg_viewer_open() could not be shown.
+ *
+ * Called on the LVGL task after the viewer has closed itself again.
+ *
+ * @param user Opaque pointer from jpg_viewer_open_opts_t::user.
+ * @param err  Decode error, with the same meaning as the jpg_viewer_open() return codes.
+ */
+typedef void (*jpg_viewer_error_cb_t)(void *user, esp_err_t err);
+
 typedef struct {
-    const char *path;          /**< Absolute or drive-prefixed path to JPEG file (e.g. "S:/img.jpg"). */
+    const char *path;          /**< Absolute or drive-prefixed path to the image file (e.g. "S:/img.jpg"). */
     lv_obj_t *return_screen;   /**< Screen to return to when closing the viewer (may be NULL). */
+    jpg_viewer_step_cb_t step; /**< Optional sibling lookup enabling swipe navigation and the slideshow. */
+    jpg_viewer_error_cb_t on_error; /**< Optional report of a failed decode of @p path. */
+    void *user;                /**< User pointer passed to @p step and @p on_error. */
 } jpg_viewer_open_opts_t;
 
 /**
- * @brief Open a simple viewer screen that displays a JPEG file.
+ * @brief Decoded image held in memory, ready to be pushed to the panel.
+ */
+typedef struct {
+    uint16_t *pixels;          /**< Panel-order RGB565 with EXIF orientation applied, rows packed (w * h). */
+    size_t cap;                /**< Capacity of @p pixels in pixels. */
+    uint16_t w;                /**< Rendered width on the panel (0 until a render succeeds). */
+    uint16_t h;                /**< Rendered height on the panel. */
+} jpg_frame_t;
+
+/**
+ * @brief Open a simple viewer screen that displays a JPEG, PNG or BMP file.
+ *
+ * PNG and BMP support depends on CONFIG_JPG_VIEWER_PNG / CONFIG_JPG_VIEWER_BMP;
+ * the decoder is chosen from the file extension.
  *
  * The viewer builds a new LVGL screen with a close button and an image widget
  * whose source is the provided @p path. On close, it returns to @p return_screen
  * if provided; otherwise it loads the previously active screen.
  *
+ * The image is decoded on a worker task that takes the display lock only
+ * around each band it pushes to the panel (or, with CONFIG_JPG_VIEWER_DRAW_BUF,
+ * invalidates in the PSRAM draw buffer shown by the image widget), so LVGL keeps handling input while
+ * a large file renders; closing or swiping cancels the decode within one MCU
+ * row. The call returns once the screen is up and the decode has started; a
+ * decode failure closes the viewer again and is reported through @p on_error.
+ *
+ * With CONFIG_JPG_VIEWER_SLIDESHOW and a @p step callback, swiping left/right
+ * shows the next/previous image and a play button starts an auto-advancing
+ * slideshow; with CONFIG_JPG_VIEWER_PREFETCH the upcoming image is decoded in
+ * the background so the step is a single panel blit.
+ *
  * @param opts Options struct (must not be NULL); @p path must be non-empty.
  * @return 
  *         - ESP_OK on success
  *         - ESP_ERR_INVALID_ARG on bad input
- *         - ESP_ERR_NOT_FOUND if the file is missing
- *         - ESP_ERR_TIMEOUT if display lock cannot be acquired, or ESP_FAIL on LVGL source set failure.
- *         - ESP_ERR_NOT_SUPPORTED if the jpg file is corrupted or it's specific type is not supported
+ *         - ESP_ERR_TIMEOUT if display lock cannot be acquired
+ *         - ESP_ERR_NO_MEM if the render task cannot be started
+ *
+ * Errors passed to @p on_error:
+ *         - ESP_FAIL if the file cannot be opened or read
+ *         - ESP_ERR_NO_MEM if the decoder buffers cannot be allocated
+ *         - ESP_ERR_NOT_SUPPORTED if the image file is corrupted or it's specific type is not supported
  *         - ESP_ERR_INVALID_SIZE if the image can't fit in the screen even after the downscale
  */
 esp_err_t jpg_viewer_open(const jpg_viewer_open_opts_t *opts);
 
+/**
+ * @brief Decode an image into @p frame instead of the panel.
+ *
+ * Uses the same decoders, downscaling and orientation handling as the viewer,
+ * fitted to the panel size. Does not touch the display, so it may run on any
+ * task without the display lock.
+ *
+ * @param path   Drive-prefixed path to a JPEG, PNG or BMP file.
+ * @param frame  Destination; @p frame->pixels / @p frame->cap must be set. w/h are filled in.
+ * @param cancel Optional flag polled once per MCU row / band; the decode stops once it is set.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG on bad input
+ *      - ESP_ERR_INVALID_STATE if the decode was cancelled
+ *      - ESP_ERR_INVALID_SIZE if the fitted image does not fit @p frame->cap
+ *      - any error jpg_viewer_open() reports for the same file
+ */
+esp_err_t jpg_frame_render(const char *path, jpg_frame_t *frame, const volatile bool *cancel);
+
+/**
+ * @brief Push a rendered frame to the top-left of the panel.
+ *
+ * The frame is copied through small DMA bands, so it may live in PSRAM and may
+ * be overwritten as soon as the call returns. While a viewer with an LVGL draw
+ * buffer (CONFIG_JPG_VIEWER_DRAW_BUF) is open, the frame is copied into that
+ * buffer and invalidated instead. Call with the display lock held.
+ *
+ * @param frame Frame filled by jpg_frame_render().
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if @p frame is empty
+ *      - ESP_ERR_INVALID_STATE if no panel is available
+ *      - ESP_ERR_NO_MEM if the band buffers cannot be allocated
+ */
+esp_err_t jpg_frame_blit(const jpg_frame_t *frame);
+
 #ifdef __cplusplus
 }
 #endif
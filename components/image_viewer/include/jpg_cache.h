@@ -0,0 +1,96 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "jpg.h"
+
+/**
+ * @brief Counters exposed for tuning the cache budget.
+ */
+typedef struct {
+    uint32_t hits;              /**< Lookups answered with a blit from the cache */
+    uint32_t misses;            /**< Lookups that had to decode (including stale entries) */
+    uint32_t insertions;        /**< Frames stored */
+    uint32_t evictions;         /**< Frames dropped (budget, changed file or jpg_cache_clear()) */
+    uint32_t entries;           /**< Frames currently held */
+    size_t bytes;               /**< PSRAM currently used by the held frames */
+    size_t budget;              /**< CONFIG_JPG_VIEWER_CACHE_BUDGET_KB in bytes */
+} jpg_cache_stats_t;
+
+/**
+ * @brief Blit the cached frame of @p path to the panel if it is still current.
+ *
+ * An entry matches when the path, modification time and size of the file are
+ * unchanged; a stale entry is dropped. Counts a hit or a miss. The cache is
+ * only used from the LVGL task; call with the display lock held.
+ *
+ * @param path Drive-prefixed path of the image.
+ *
+ * @return true if the frame was pushed to the panel.
+ */
+bool jpg_cache_show(const char *path);
+
+/**
+ * @brief Returns true if a current frame of @p path is cached (no counters, no blit).
+ */
+bool jpg_cache_contains(const char *path);
+
+/**
+ * @brief Allocate a panel-sized PSRAM frame for a decode that will be inserted afterwards.
+ *
+ * Evicts least recently used entries until the frame fits the budget.
+ *
+ * @param frame Receives the buffer and its capacity; w/h are cleared.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NO_MEM without PSRAM, with a budget below one frame or if the allocation fails
+ */
+esp_err_t jpg_cache_frame_alloc(jpg_frame_t *frame);
+
+/**
+ * @brief Release a frame from jpg_cache_frame_alloc() that is not going to be inserted.
+ */
+void jpg_cache_frame_free(jpg_frame_t *frame);
+
+/**
+ * @brief Store a rendered frame of @p path, taking ownership of @p frame->pixels.
+ *
+ * The buffer is shrunk to the rendered size and becomes the most recently used
+ * entry. @p frame is cleared on return, whether or not it could be stored.
+ *
+ * @param path  Drive-prefixed path of the image.
+ * @param frame Frame from jpg_cache_frame_alloc() filled by a successful render.
+ */
+void jpg_cache_insert(const char *path, jpg_frame_t *frame);
+
+/**
+ * @brief Store a copy of a rendered frame owned by someone else (e.g. the prefetcher).
+ *
+ * Does nothing if @p path is already cached or the copy does not fit the budget.
+ *
+ * @param path  Drive-prefixed path of the image.
+ * @param frame Rendered frame.
+ */
+void jpg_cache_put(const char *path, const jpg_frame_t *frame);
+
+/**
+ * @brief Drop every entry and release its memory (counters are kept).
+ */
+void jpg_cache_clear(void);
+
+/**
+ * @brief Copy the current counters into @p out.
+ */
+void jpg_cache_get_stats(jpg_cache_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
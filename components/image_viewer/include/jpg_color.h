@@ -0,0 +1,43 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Convert a run of YCbCr samples straight to panel-order RGB565.
+ *
+ * Generic 32-bit SWAR kernel: two pixels are processed per 32-bit word using
+ * 16-bit lanes with guard bits for the saturation step, so no lookup tables or
+ * per-channel branches are needed. Output words are packed as R5G6B5 and then
+ * byte-swapped, matching what the SPI panel expects on the wire.
+ *
+ * The kernel only depends on the C standard library so it can be built and
+ * checked on the host.
+ *
+ * @param y     Luma samples (0..255), @p count entries.
+ * @param cb    Blue-difference chroma samples (0..255, 128 = neutral).
+ * @param cr    Red-difference chroma samples (0..255, 128 = neutral).
+ * @param dst   Destination RGB565 buffer, @p count entries.
+ * @param count Number of pixels to convert.
+ */
+void jpg_color_ycc_to_rgb565(const uint8_t *y, const uint8_t *cb, const uint8_t *cr,
+                             uint16_t *dst, size_t count);
+
+/**
+ * @brief Run the color-conversion micro-benchmark and log the results.
+ *
+ * Times the legacy two-pass path (YCbCr -> RGB888 work buffer -> RGB565) against
+ * jpg_color_ycc_to_rgb565() on a synthetic MCU row and reports ns/pixel plus the
+ * largest per-pixel difference between both outputs.
+ *
+ * Only available when CONFIG_JPG_VIEWER_COLOR_BENCHMARK is enabled.
+ */
+void jpg_color_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
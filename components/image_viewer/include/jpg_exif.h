@@ -0,0 +1,44 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+/**
+ * @brief Metadata gathered from the segments that precede the JPEG scan data.
+ */
+typedef struct {
+    uint16_t width;             /**< Frame width from the SOFn header, 0 if not reached */
+    uint16_t height;            /**< Frame height from the SOFn header, 0 if not reached */
+    uint8_t orientation;        /**< EXIF orientation 1..8 (1 = as stored / tag absent) */
+    uint32_t thumb_offset;      /**< Absolute file offset of the embedded JPEG thumbnail */
+    uint32_t thumb_len;         /**< Thumbnail length in bytes, 0 if there is none */
+} jpg_exif_info_t;
+
+/**
+ * @brief Walk the JPEG header segments of @p file and extract EXIF orientation,
+ *        the IFD1 JPEG thumbnail location and the frame size.
+ *
+ * Only the APP1 "Exif" TIFF directories (IFD0 and IFD1) and the SOFn header are
+ * read; parsing stops at the first SOFn or SOS. The file position is left
+ * undefined, callers must seek before decoding.
+ *
+ * @param file Open JPEG file.
+ * @param info Filled with defaults (orientation 1, no thumbnail) and then with
+ *             whatever could be parsed.
+ *
+ * @return
+ *      - ESP_OK if the header was walked up to the frame header
+ *      - ESP_ERR_INVALID_ARG on NULL arguments
+ *      - ESP_ERR_NOT_SUPPORTED if the file does not start with SOI or the
+ *        segment chain is malformed (fields parsed so far are still valid)
+ */
+esp_err_t jpg_exif_read(lv_fs_file_t *file, jpg_exif_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
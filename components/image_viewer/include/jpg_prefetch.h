@@ -0,0 +1,58 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief Start the background decoder used to prefetch the next slideshow image.
+ *
+ * Allocates one panel-sized RGB565 frame (PSRAM first, then internal RAM if
+ * enough heap stays free) and a low-priority worker task that renders requested
+ * images into it with jpg_frame_render(). Calling it again while running is a
+ * no-op.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NO_MEM if the frame, task or locks cannot be allocated; the
+ *        viewer then simply decodes every image on demand
+ */
+esp_err_t jpg_prefetch_start(void);
+
+/**
+ * @brief Abort any decode in flight, stop the worker and release the frame.
+ *
+ * Blocks until the worker has exited (at most one MCU row / band of work).
+ * Safe to call when the prefetcher is not running.
+ */
+void jpg_prefetch_stop(void);
+
+/**
+ * @brief Replace the pending request with @p path and wake the worker.
+ *
+ * A stale decode in flight is cancelled first. Does nothing if the prefetcher
+ * is not running.
+ *
+ * @param path Drive-prefixed path of the image expected to be shown next.
+ */
+void jpg_prefetch_request(const char *path);
+
+/**
+ * @brief Blit the prefetched frame if it holds @p path.
+ *
+ * If the worker is still decoding @p path the call waits for it to finish;
+ * a decode of any other image is cancelled. Call with the display lock held.
+ *
+ * @param path Drive-prefixed path of the image to show.
+ *
+ * @return true if the frame was pushed to the panel, false if the caller has to
+ *         decode @p path itself.
+ */
+bool jpg_prefetch_show(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
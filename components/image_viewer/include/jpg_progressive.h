@@ -0,0 +1,49 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "img_stream.h"
+
+/**
+ * @brief Decode a progressive (SOF2) JPEG and stream it to @p cfg->draw in MCU-row bands.
+ *
+ * All scans are run first into a coefficient store that only keeps the
+ * low-frequency coefficients needed for the output resolution (a 1/2^s downscale
+ * keeps (8>>s)^2 coefficients per block), then every MCU row is IDCT'd at the
+ * reduced size, color-converted and handed to the sink.
+ *
+ * Peak memory is bounded and allocated up front:
+ *  - coefficient store: at most CONFIG_JPG_PROGRESSIVE_COEF_BUDGET_KB of internal
+ *    RAM, or CONFIG_JPG_PROGRESSIVE_PSRAM_BUDGET_KB of PSRAM when enabled. Per
+ *    8x8 block it costs 128 B at 1:1, 40 B at 1/2, 16 B at 1/4 and 2 B at 1/8
+ *    (the 1/2 and 1/4 figures include a 64-bit nonzero map needed to parse
+ *    refinement scans). If the store does not fit at the scale that fits the
+ *    panel, a coarser scale is tried before giving up with ESP_ERR_NO_MEM;
+ *  - decoder state (Huffman/quant tables, 1 KB input buffer): about 10 KB;
+ *  - one MCU row of samples plus two DMA stripes: at most about 30 KB for a
+ *    320 px wide panel.
+ *
+ * Supports 8-bit grayscale and YCbCr with 4:4:4, 4:2:2, 4:4:0 and 4:2:0 sampling,
+ * restart intervals and successive approximation. Truncated files render the
+ * scans that were complete.
+ *
+ * @param cfg Decode request.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if @p cfg is incomplete
+ *      - ESP_ERR_NOT_SUPPORTED if the file is not a supported progressive JPEG
+ *      - ESP_ERR_INVALID_SIZE if the image cannot fit the bounds even at 1/8
+ *      - ESP_ERR_NO_MEM if the coefficient store exceeds every budget
+ *      - ESP_ERR_INVALID_RESPONSE on corrupt entropy-coded data
+ *      - ESP_FAIL if the sink aborted the decode
+ */
+esp_err_t jpg_progressive_draw(const img_stream_cfg_t *cfg);
+
+#ifdef __cplusplus
+}
+#endif
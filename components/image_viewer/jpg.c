@@ -1,31 +1,86 @@
 #include "jpg.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
+#include <strings.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "lvgl/src/libs/tjpgd/tjpgd.h"
 #include "lvgl/src/misc/lv_fs.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "bsp/esp-bsp.h"
+#include "sdkconfig.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "jpg_color.h"
+#include "jpg_cache.h"
+#include "jpg_exif.h"
+#include "jpg_prefetch.h"
+#include "jpg_progressive.h"
+#include "img_bmp.h"
+#include "img_png.h"
+#include "img_stream.h"
 #include "styles.h"
 
 #define TAG "jpg_viewer"
 #define IMG_VIEWER_MAX_PATH 256
+#define JPG_FRAME_BLIT_ROWS 16      /* Rows per DMA band when pushing an in-memory frame */
+#define JPG_RENDER_TASK_STACK (10 * 1024)  /* tjpgd keeps its 4 KB work buffer on the stack */
+#define JPG_RENDER_TASK_PRIO  (2)          /* Below the LVGL task so touch stays responsive, above prefetch */
+#define JPG_RENDER_LOCK_POLL_MS 10         /* Display lock wait between cancel checks */
+
+/* Decoders that deliver finished bands through img_stream_cfg_t */
+#define JPG_VIEWER_STREAM_DECODERS (CONFIG_JPG_VIEWER_PROGRESSIVE || CONFIG_JPG_VIEWER_PNG || CONFIG_JPG_VIEWER_BMP)
 
 typedef struct {
     lv_fs_file_t file;
     esp_lcd_panel_handle_t panel;
     uint16_t *stripe;               /* DMA-capable stripe buffer */
+    uint16_t *stripe_alt;           /* Second stripe for ping-pong panel transfers (native RGB565 mode) */
     uint32_t stripe_w;
     uint32_t stripe_h;
-    uint16_t disp_w;
+    uint16_t disp_w;                /* Output bounds in image space (swapped for 90/270 orientations) */
     uint16_t disp_h;
     uint8_t scale;
+    uint8_t orientation;            /* EXIF orientation 1..8 applied by jpg_emit_band() */
+    uint32_t out_w;                 /* Scaled image size in image space */
+    uint32_t out_h;
+    uint16_t *xform[2];             /* Ping-pong DMA buffers for re-oriented / copied bands */
+    size_t xform_cap;               /* Capacity of each xform buffer in pixels */
+    uint8_t xform_cur;
+    uint16_t *frame;                /* Optional in-memory copy of the output (packed panel-space rows) */
+    size_t frame_cap;               /* Capacity of frame in pixels */
+    const volatile bool *cancel;    /* Optional abort flag polled once per MCU row / band */
+    bool lock_panel;                /* Take the display lock around each panel transfer (worker renders) */
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    lv_draw_buf_t *canvas;          /* Draw buffer shown by canvas_obj; replaces the panel as target */
+    lv_obj_t *canvas_obj;
+#endif
 } jpg_stripe_ctx_t;
 
+typedef struct {
+    uint32_t px0;                   /* Panel rectangle covered by a band */
+    uint32_t py0;
+    uint32_t pw;
+    uint32_t ph;
+    bool transpose;                 /* Image rows run along panel columns */
+    bool flip_x;
+    bool flip_y;
+} jpg_band_map_t;
+
+typedef struct {
+    uint32_t seq;                   /* Matches s_jpg_render_seq while the job is current */
+    char path[IMG_VIEWER_MAX_PATH];
+    int dir;                        /* Step direction, 0 for the first image of the session */
+    jpg_frame_t frame;              /* Copy for the decoded-frame cache, empty if unused */
+    esp_err_t err;
+} jpg_viewer_job_t;
+
 typedef struct {
     bool active;
     lv_obj_t *screen;
@@ -35,9 +90,28 @@ typedef struct {
     lv_obj_t *return_screen;
     lv_obj_t *previous_screen;
     char path[IMG_VIEWER_MAX_PATH];
+    void *user;
+    jpg_viewer_error_cb_t on_error;
+    TaskHandle_t render_task;       /* Worker decoding the visible image, NULL when idle */
+    SemaphoreHandle_t render_done;  /* Given by the worker right before it deletes itself */
+    volatile bool render_cancel;    /* Polled by the worker's decoder */
+    jpg_viewer_job_t job;
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    lv_draw_buf_t canvas;           /* Panel-sized RGB565 source of the image widget */
+    void *canvas_data;              /* PSRAM backing of canvas, NULL in direct-to-panel mode */
+#endif
+#if CONFIG_JPG_VIEWER_SLIDESHOW
+    jpg_viewer_step_cb_t step;
+    lv_obj_t *play_btn;
+    lv_obj_t *play_label;
+    lv_timer_t *slideshow_timer;
+    bool playing;
+    bool prefetch;                  /* Background decoder started for this session */
+#endif
 } jpg_viewer_ctx_t;
 
 static jpg_viewer_ctx_t s_jpg_viewer;
+static uint32_t s_jpg_render_seq;   /* Outlives the context so completions queued before a reset stay stale */
 
 /**
  * @brief Destroy the currently active JPG viewer screen and reset its context.
@@ -62,15 +136,20 @@ static void jpg_viewer_destroy_active(jpg_viewer_ctx_t *ctx);
 static void jpg_viewer_build_ui(jpg_viewer_ctx_t *ctx);
 
 /**
- * @brief Render the JPEG at the given path to the display panel.
+ * @brief Render the image at the given path to the display panel.
  *
  * This function validates the LVGL image object and path, retrieves the
  * display panel from the BSP and calls jpg_draw_striped() to decode and
- * draw the JPEG in stripes.
+ * draw the JPEG in stripes, or jpg_draw_streamed() for PNG and BMP files.
+ * It runs on the render worker without the display lock: the lock is only
+ * taken around each band pushed to the panel.
  *
- * @param img  LVGL image object associated with the viewer (not used for
- *             rendering in this implementation, but kept for API symmetry).
- * @param path Path to the JPEG file to be rendered.
+ * @param img    LVGL image object associated with the viewer; invalidated band by
+ *               band when rendering into @p canvas.
+ * @param path   Path to the image file to be rendered.
+ * @param canvas Draw buffer shown by @p img, or NULL to draw to the panel directly.
+ * @param frame  Optional frame receiving a copy of the output (w/h set on success).
+ * @param cancel Abort flag polled once per MCU row / band.
  *
  * @return
  *      - ESP_OK on success
@@ -79,7 +158,113 @@ static void jpg_viewer_build_ui(jpg_viewer_ctx_t *ctx);
  *      - ESP_ERR_NOT_SUPPORTED if the jpg file is corrupted or it's specific type is not supported
  *      - ESP_ERR_INVALID_SIZE if the image can't fit in the screen even after the downscale
  */
-static esp_err_t jpg_handler_set_src(lv_obj_t *img, const char *path);
+static esp_err_t jpg_handler_set_src(lv_obj_t *img, const char *path, lv_draw_buf_t *canvas,
+                                     jpg_frame_t *frame, const volatile bool *cancel);
+
+/**
+ * @brief Decode @p path with the decoder matching its extension into @p ctx's target.
+ *
+ * @param path Path to the image file in the LVGL filesystem.
+ * @param ctx  Stripe context with the panel or frame target (and optional cancel flag) set.
+ *
+ * @return Result of jpg_draw_striped() / jpg_draw_streamed(); ESP_ERR_INVALID_STATE if cancelled.
+ */
+static esp_err_t jpg_render(const char *path, jpg_stripe_ctx_t *ctx);
+
+/**
+ * @brief Record the panel-space size of a finished render in @p frame.
+ *
+ * @return false if nothing was rendered or the image does not fit the frame.
+ */
+static bool jpg_frame_set_size(const jpg_stripe_ctx_t *ctx, jpg_frame_t *frame);
+
+/**
+ * @brief Put @p path on screen from the fastest source available.
+ *
+ * Tries the decoded-frame cache, then the prefetched frame, and finally
+ * starts a background decode with jpg_viewer_render_start(). Call with the
+ * display lock held and no render in flight.
+ *
+ * @param ctx  Viewer context.
+ * @param path Path to the image file.
+ * @param dir  Step direction, 0 when opening the viewer.
+ *
+ * @return ESP_OK when a stored frame was shown or the decode was started.
+ */
+static esp_err_t jpg_viewer_show(jpg_viewer_ctx_t *ctx, const char *path, int dir);
+
+/**
+ * @brief Start the render worker for @p path, cancelling any render in flight.
+ *
+ * The worker decodes straight to the panel and reports back on the LVGL task
+ * through jpg_viewer_render_done().
+ *
+ * @return
+ *      - ESP_OK if the worker was started
+ *      - ESP_ERR_NO_MEM if the task or its semaphore cannot be created
+ */
+static esp_err_t jpg_viewer_render_start(jpg_viewer_ctx_t *ctx, const char *path, int dir);
+
+/**
+ * @brief Abort the render in flight (if any) and wait for its worker to exit.
+ *
+ * The decoder notices the flag within one MCU row / band and the worker polls
+ * the display lock, so this may be called with the lock held.
+ */
+static void jpg_viewer_render_cancel(jpg_viewer_ctx_t *ctx);
+
+/**
+ * @brief Render worker: decode the current job, then queue its completion on the LVGL task.
+ *
+ * @param arg Viewer context.
+ */
+static void jpg_viewer_render_task(void *arg);
+
+/**
+ * @brief lv_async_call() completion of a render job, run on the LVGL task.
+ *
+ * Ignores jobs that were cancelled in the meantime. Stores the frame in the
+ * cache, and closes the viewer and reports through the on_error callback if
+ * the first image of the session could not be shown.
+ *
+ * @param user Sequence number of the finished job.
+ */
+static void jpg_viewer_render_done(void *user);
+
+/**
+ * @brief Finish showing an image: redraw the buttons over it and prefetch the next one.
+ */
+static void jpg_viewer_shown(jpg_viewer_ctx_t *ctx, int dir);
+
+/**
+ * @brief Stop rendering, load @p target (if any), delete the viewer screen and reset the context.
+ */
+static void jpg_viewer_close(jpg_viewer_ctx_t *ctx, lv_obj_t *target);
+
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+/**
+ * @brief Allocate the viewer's panel-sized draw buffer in PSRAM and clear it to black.
+ *
+ * On failure the viewer falls back to drawing on the panel directly.
+ */
+static void jpg_viewer_canvas_init(jpg_viewer_ctx_t *ctx);
+
+/**
+ * @brief Copy an oriented band into the draw buffer and invalidate just that area.
+ */
+static void jpg_canvas_band(jpg_stripe_ctx_t *ctx, const jpg_band_map_t *map, uint32_t w, uint32_t h,
+                            const uint16_t *src, uint32_t stride);
+#endif
+
+/**
+ * @brief Returns true once the context's cancel flag has been raised.
+ */
+static inline bool jpg_cancelled(const jpg_stripe_ctx_t *ctx);
+
+/**
+ * @brief Returns true if the render is visible (panel or draw buffer), not only a frame copy.
+ */
+static inline bool jpg_on_screen(const jpg_stripe_ctx_t *ctx);
 
 /**
  * @brief Reset the JPG viewer context to a clean state.
@@ -92,6 +277,40 @@ static esp_err_t jpg_handler_set_src(lv_obj_t *img, const char *path);
  */
 static void jpg_viewer_reset(jpg_viewer_ctx_t *ctx);
 
+#if CONFIG_JPG_VIEWER_SLIDESHOW
+/**
+ * @brief Show the neighbouring image in direction @p dir (+1 next, -1 previous).
+ *
+ * Clears the previous picture through an LVGL refresh, shows the image with
+ * jpg_viewer_show() and finally queues the following image for prefetch.
+ * Runs on the LVGL task.
+ *
+ * @param ctx Active viewer context.
+ * @param dir Step direction.
+ */
+static void jpg_viewer_step(jpg_viewer_ctx_t *ctx, int dir);
+
+/**
+ * @brief Queue the image after the current one (in direction @p dir) for background decode.
+ */
+static void jpg_viewer_prefetch_next(jpg_viewer_ctx_t *ctx, int dir);
+
+/**
+ * @brief LVGL gesture callback: swipe left shows the next image, swipe right the previous.
+ */
+static void jpg_viewer_on_gesture(lv_event_t *e);
+
+/**
+ * @brief Play/pause button callback toggling the slideshow timer.
+ */
+static void jpg_viewer_on_play(lv_event_t *e);
+
+/**
+ * @brief Slideshow timer callback advancing to the next image.
+ */
+static void jpg_viewer_slideshow_timer_cb(lv_timer_t *timer);
+#endif
+
 /**
  * @brief LVGL event callback used to close the JPG viewer.
  *
@@ -119,6 +338,7 @@ static void jpg_viewer_on_close(lv_event_t *e);
  */
 static size_t input_cb(JDEC *jd, uint8_t *buff, size_t nbytes);
 
+#if !CONFIG_JPG_VIEWER_NATIVE_RGB565
 /**
  * @brief TJpgDec output callback to convert and push decoded pixels to the panel.
  *
@@ -136,6 +356,156 @@ static size_t input_cb(JDEC *jd, uint8_t *buff, size_t nbytes);
  *      - 0 to abort decoding due to error or invalid parameters
  */
 static int output_cb(JDEC *jd, void *bitmap, JRECT *rect);
+#endif
+
+#if CONFIG_JPG_VIEWER_NATIVE_RGB565
+/**
+ * @brief Run the tjpgd MCU loop and emit panel-order RGB565 without the RGB888 stage.
+ *
+ * Mirrors jd_decomp() (including restart-interval handling) but replaces
+ * jd_mcu_output() with jpg_mcu_to_stripe(), which converts the YCbCr MCU buffer
+ * straight into the stripe. A stripe covers one full MCU row and is pushed to the
+ * panel with a single draw call; two stripes are used alternately so the next row
+ * can be decoded while the previous one is still being transferred.
+ *
+ * @param jd  Prepared decoder (jd_prepare() succeeded).
+ * @param ctx Stripe context with both stripe buffers allocated.
+ *
+ * @return JDR_OK on success or the first tjpgd error encountered.
+ */
+static JRESULT jpg_decomp_rgb565(JDEC *jd, jpg_stripe_ctx_t *ctx);
+
+/**
+ * @brief Saturate a decoded sample (IDCT output may overshoot) to 0..255.
+ */
+static inline uint8_t jpg_clip8(int v);
+
+/**
+ * @brief Convert the decoded MCU at (@p x, @p y) into the current stripe.
+ *
+ * Samples the Y/Cb/Cr blocks at the configured downscale (top-left sampling, as
+ * the legacy path did), honours 4:4:4, 4:2:2 and 4:2:0 chroma layouts and writes
+ * byte-swapped RGB565 through jpg_color_ycc_to_rgb565().
+ *
+ * @param jd  Decoder holding the freshly loaded MCU in @c mcubuf.
+ * @param ctx Stripe context.
+ * @param x   MCU left edge in source image pixels.
+ * @param y   MCU top edge in source image pixels.
+ */
+static void jpg_mcu_to_stripe(JDEC *jd, jpg_stripe_ctx_t *ctx, unsigned int x, unsigned int y);
+
+/**
+ * @brief Push @p rows lines of the current stripe to the panel and swap stripes.
+ *
+ * @param ctx  Stripe context.
+ * @param top  Destination row on the panel (already scaled).
+ * @param rows Number of valid rows in the stripe.
+ */
+static void jpg_flush_stripe(jpg_stripe_ctx_t *ctx, unsigned int top, unsigned int rows);
+#endif
+
+#if JPG_VIEWER_STREAM_DECODERS
+/**
+ * @brief Band sink for the streaming decoders: push one decoded band to the panel.
+ *
+ * @param user   Stripe context (panel or frame target).
+ * @param x0     Left edge in image space.
+ * @param y0     Top edge in image space.
+ * @param x1     Right edge (exclusive).
+ * @param y1     Bottom edge (exclusive).
+ * @param pixels Panel-order RGB565 band.
+ *
+ * @return 1 to continue, 0 once the decode has been cancelled.
+ */
+static int jpg_stream_band_cb(void *user, uint32_t x0, uint32_t y0,
+                              uint32_t x1, uint32_t y1, const uint16_t *pixels);
+
+/**
+ * @brief Record the streamed output size so bands can be clipped and re-oriented.
+ */
+static void jpg_stream_size_cb(void *user, uint32_t w, uint32_t h);
+#endif
+
+/**
+ * @brief Push a band of image-space pixels to the panel, applying the EXIF orientation.
+ *
+ * The band is clipped to the scaled image. With orientation 1 and a stable
+ * source (a buffer that is not reused before the next draw call) it is drawn in
+ * place; otherwise it is copied, rotated or mirrored as needed into one of two
+ * ping-pong DMA buffers, so no full-frame buffer is ever required. When the
+ * context carries a frame target the band is also written into the frame; a
+ * context without a panel only fills the frame.
+ *
+ * @param ctx    Stripe context.
+ * @param x      Band left edge in image space.
+ * @param y      Band top edge in image space.
+ * @param w      Band width.
+ * @param h      Band height.
+ * @param src    Panel-order RGB565 pixels.
+ * @param stride Source row pitch in pixels.
+ * @param stable true if @p src stays untouched until the next band is emitted.
+ */
+static void jpg_emit_band(jpg_stripe_ctx_t *ctx, uint32_t x, uint32_t y, uint32_t w, uint32_t h,
+                          const uint16_t *src, uint32_t stride, bool stable);
+
+/**
+ * @brief Copy a clipped band into a destination rectangle described by @p map.
+ *
+ * @param map    Panel rectangle and axis flips of the band.
+ * @param w      Band width in image space.
+ * @param h      Band height in image space.
+ * @param src    Source pixels.
+ * @param stride Source row pitch in pixels.
+ * @param dst    Top-left pixel of the destination rectangle.
+ * @param pitch  Destination row pitch in pixels.
+ */
+static void jpg_band_copy(const jpg_band_map_t *map, uint32_t w, uint32_t h,
+                          const uint16_t *src, uint32_t stride, uint16_t *dst, uint32_t pitch);
+
+/**
+ * @brief Take the display lock for a worker render, polling the cancel flag while waiting.
+ *
+ * Does nothing (and succeeds) for renders that run under the lock already.
+ *
+ * @return false if the render was cancelled; the lock is not held then.
+ */
+static bool jpg_display_lock(const jpg_stripe_ctx_t *ctx);
+
+/**
+ * @brief Release the lock taken by jpg_display_lock().
+ */
+static void jpg_display_unlock(const jpg_stripe_ctx_t *ctx);
+
+/**
+ * @brief Queue a panel transfer, holding the display lock around it for worker renders.
+ *
+ * While waiting for the lock the cancel flag is polled, so the lock holder can
+ * cancel the render without a deadlock.
+ *
+ * @return false if the render was cancelled and nothing was drawn.
+ */
+static bool jpg_panel_draw(const jpg_stripe_ctx_t *ctx, uint32_t x0, uint32_t y0,
+                           uint32_t x1, uint32_t y1, const uint16_t *pixels);
+
+#if CONFIG_JPG_VIEWER_EXIF_THUMBNAIL
+/**
+ * @brief Decode the EXIF thumbnail and blit it upscaled to the final image size.
+ *
+ * Gives immediate feedback while the full image decodes over it. Failures are
+ * silent: the full decode still runs.
+ *
+ * @param ctx   Stripe context with orientation and output size set.
+ * @param exif  Parsed EXIF data (thumbnail location).
+ * @param workb tjpgd work buffer.
+ * @param size  Size of @p workb.
+ */
+static void jpg_draw_thumbnail(jpg_stripe_ctx_t *ctx, const jpg_exif_info_t *exif, uint8_t *workb, size_t size);
+
+/**
+ * @brief TJpgDec output callback for the thumbnail: nearest-neighbour upscale of one MCU.
+ */
+static int jpg_thumb_output_cb(JDEC *jd, void *bitmap, JRECT *rect);
+#endif
 
 /**
  * @brief Decode and draw a JPEG image in stripes directly to an LCD panel.
@@ -147,7 +517,7 @@ static int output_cb(JDEC *jd, void *bitmap, JRECT *rect);
  * the image to the panel without loading it fully into memory.
  *
  * @param path  Path to the JPEG file in the LVGL filesystem.
- * @param panel Handle to the LCD panel used for drawing.
+ * @param ctx   Stripe context with the output target set up by jpg_render().
  *
  * @return
  *      - ESP_OK on successful decode and draw
@@ -156,7 +526,38 @@ static int output_cb(JDEC *jd, void *bitmap, JRECT *rect);
  *      - ESP_ERR_NOT_SUPPORTED if the jpg file is corrupted or it's specific type is not supported
  *      - ESP_ERR_INVALID_SIZE if the image can't fit in the screen even after the downscale
  */
-static esp_err_t jpg_draw_striped(const char *path, esp_lcd_panel_handle_t panel);
+static esp_err_t jpg_draw_striped(const char *path, jpg_stripe_ctx_t *ctx);
+
+#if CONFIG_JPG_VIEWER_PNG || CONFIG_JPG_VIEWER_BMP
+/**
+ * @brief Streaming decoder entry point (img_png_draw(), img_bmp_draw()).
+ */
+typedef esp_err_t (*jpg_stream_decoder_t)(const img_stream_cfg_t *cfg);
+
+/**
+ * @brief Returns true if @p path ends in @p ext (case-insensitive, ext includes the dot).
+ */
+static bool jpg_path_has_ext(const char *path, const char *ext);
+
+/**
+ * @brief Decode and draw a PNG or BMP through the shared band pipeline.
+ *
+ * Opens the file and runs @p decode with the same band sink used for progressive
+ * JPEGs, so output is clipped and drawn in DMA stripes without a frame buffer.
+ *
+ * @param path   Path to the image in the LVGL filesystem.
+ * @param ctx    Stripe context with the output target set up by jpg_render().
+ * @param decode Streaming decoder for the file type.
+ *
+ * @return
+ *      - ESP_OK on successful decode and draw
+ *      - ESP_FAIL on file open or read failure
+ *      - ESP_ERR_NO_MEM if the decoder buffers cannot be allocated
+ *      - ESP_ERR_NOT_SUPPORTED if the file is corrupted or its specific type is not supported
+ *      - ESP_ERR_INVALID_SIZE if the image can't fit in the screen even after the downscale
+ */
+static esp_err_t jpg_draw_streamed(const char *path, jpg_stripe_ctx_t *ctx, jpg_stream_decoder_t decode);
+#endif
 
 esp_err_t jpg_viewer_open(const jpg_viewer_open_opts_t *opts)
 {
@@ -172,12 +573,20 @@ esp_err_t jpg_viewer_open(const jpg_viewer_open_opts_t *opts)
 
     ctx->return_screen = opts->return_screen;
     strlcpy(ctx->path, opts->path, sizeof(ctx->path));
+    ctx->user = opts->user;
+    ctx->on_error = opts->on_error;
+#if CONFIG_JPG_VIEWER_SLIDESHOW
+    ctx->step = opts->step;
+#endif
 
     if (!bsp_display_lock(0)) {
         return ESP_ERR_TIMEOUT;
     }
 
     ctx->previous_screen = lv_screen_active();
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    jpg_viewer_canvas_init(ctx);
+#endif
     jpg_viewer_build_ui(ctx);
 
     /* Load the screen before drawing so LVGL flushes its background/UI first */
@@ -185,7 +594,14 @@ esp_err_t jpg_viewer_open(const jpg_viewer_open_opts_t *opts)
     /* Force a refresh now so subsequent LVGL cycles don't clear our direct draw */
     lv_refr_now(NULL);
 
-    esp_err_t err = jpg_handler_set_src(ctx->image, opts->path);
+#if CONFIG_JPG_VIEWER_SLIDESHOW && CONFIG_JPG_VIEWER_PREFETCH
+    /* The worker idles until the first image is on screen and asks for the next one */
+    if (ctx->step) {
+        ctx->prefetch = jpg_prefetch_start() == ESP_OK;
+    }
+#endif
+
+    esp_err_t err = jpg_viewer_show(ctx, opts->path, 0);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to render image: (%s)", esp_err_to_name(err));
         if (ctx->previous_screen) {
@@ -213,6 +629,8 @@ static void jpg_viewer_destroy_active(jpg_viewer_ctx_t *ctx)
         return;
     }
 
+    /* Stop the worker before its bands land on whatever screen comes next */
+    jpg_viewer_render_cancel(ctx);
     if (bsp_display_lock(0)) {
         if (ctx->screen) {
             lv_obj_del(ctx->screen);
@@ -233,6 +651,13 @@ static void jpg_viewer_build_ui(jpg_viewer_ctx_t *ctx)
 
     ctx->image = lv_image_create(ctx->screen);
     lv_obj_center(ctx->image);
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    if (ctx->canvas_data) {
+        /* Decoders place the picture at the panel origin, as in direct mode */
+        lv_image_set_src(ctx->image, &ctx->canvas);
+        lv_obj_align(ctx->image, LV_ALIGN_TOP_LEFT, 0, 0);
+    }
+#endif
 
     lv_obj_t *close_btn = lv_button_create(ctx->screen);
     ctx->close_btn = close_btn;
@@ -247,45 +672,236 @@ static void jpg_viewer_build_ui(jpg_viewer_ctx_t *ctx)
     lv_label_set_text(close_lbl, LV_SYMBOL_CLOSE);
     lv_obj_set_style_text_color(close_lbl, UI_COLOR_TEXT_DARK, 0);
     lv_obj_center(close_lbl);
+
+#if CONFIG_JPG_VIEWER_SLIDESHOW
+    if (!ctx->step) {
+        return;
+    }
+
+    /* Swipes land on the screen itself: the image widget is not clickable */
+    lv_obj_remove_flag(ctx->screen, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(ctx->screen, jpg_viewer_on_gesture, LV_EVENT_GESTURE, ctx);
+
+    lv_obj_t *play_btn = lv_button_create(ctx->screen);
+    ctx->play_btn = play_btn;
+    lv_obj_set_size(play_btn, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+    lv_obj_set_style_pad_all(play_btn, 3, 0);
+    lv_obj_align(play_btn, LV_ALIGN_TOP_LEFT, 10, 10);
+    styles_build_button(play_btn);
+    lv_obj_set_style_radius(play_btn, 20, 0);
+    lv_obj_add_event_cb(play_btn, jpg_viewer_on_play, LV_EVENT_CLICKED, ctx);
+    ctx->play_label = lv_label_create(play_btn);
+    lv_label_set_text(ctx->play_label, LV_SYMBOL_PLAY);
+    lv_obj_set_style_text_color(ctx->play_label, UI_COLOR_TEXT_DARK, 0);
+    lv_obj_center(ctx->play_label);
+
+    ctx->slideshow_timer = lv_timer_create(jpg_viewer_slideshow_timer_cb, CONFIG_JPG_VIEWER_SLIDESHOW_INTERVAL_MS, ctx);
+    lv_timer_pause(ctx->slideshow_timer);
+#endif
 }
 
-static esp_err_t jpg_handler_set_src(lv_obj_t *img, const char *path)
+static esp_err_t jpg_handler_set_src(lv_obj_t *img, const char *path, lv_draw_buf_t *canvas,
+                                     jpg_frame_t *frame, const volatile bool *cancel)
 {
     if (!img || !path || path[0] == '\0') {
         return ESP_ERR_INVALID_ARG;
     }
 
-    esp_lcd_panel_handle_t panel = bsp_display_get_panel();
-    if (!panel) {
-        return ESP_ERR_INVALID_STATE;
+    jpg_stripe_ctx_t ctx = {
+        .cancel = cancel,
+        .lock_panel = true,
+    };
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    ctx.canvas = canvas;
+    ctx.canvas_obj = img;
+#else
+    (void)canvas;
+#endif
+    if (!canvas) {
+        ctx.panel = bsp_display_get_panel();
+        if (!ctx.panel) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    if (frame && frame->pixels) {
+        /* Keep a copy of the bands for the cache while they go to the panel */
+        ctx.frame = frame->pixels;
+        ctx.frame_cap = frame->cap;
     }
-    
-    esp_err_t err = jpg_draw_striped(path, panel);
 
+    esp_err_t err = jpg_render(path, &ctx);
+    if (err == ESP_OK && ctx.frame) {
+        jpg_frame_set_size(&ctx, frame);
+    }
     return err;
 }
 
-static void jpg_viewer_reset(jpg_viewer_ctx_t *ctx)
+static esp_err_t jpg_viewer_show(jpg_viewer_ctx_t *ctx, const char *path, int dir)
 {
-    if (!ctx) {
+#if CONFIG_JPG_VIEWER_CACHE
+    if (jpg_cache_show(path)) {
+        jpg_viewer_shown(ctx, dir);
+        return ESP_OK;
+    }
+#endif
+#if CONFIG_JPG_VIEWER_SLIDESHOW && CONFIG_JPG_VIEWER_PREFETCH
+    if (ctx->prefetch && jpg_prefetch_show(path)) {
+        jpg_viewer_shown(ctx, dir);
+        return ESP_OK;
+    }
+#endif
+    return jpg_viewer_render_start(ctx, path, dir);
+}
+
+static esp_err_t jpg_viewer_render_start(jpg_viewer_ctx_t *ctx, const char *path, int dir)
+{
+    jpg_viewer_render_cancel(ctx);
+    if (!ctx->render_done) {
+        ctx->render_done = xSemaphoreCreateBinary();
+        if (!ctx->render_done) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    jpg_viewer_job_t *job = &ctx->job;
+    memset(job, 0, sizeof(*job));
+    job->seq = ++s_jpg_render_seq;
+    job->dir = dir;
+    strlcpy(job->path, path, sizeof(job->path));
+#if CONFIG_JPG_VIEWER_CACHE
+    /* The cache is only touched here and in the completion, both on the LVGL task */
+    jpg_cache_frame_alloc(&job->frame);
+#endif
+
+    if (xTaskCreate(jpg_viewer_render_task, "jpg_render", JPG_RENDER_TASK_STACK,
+                    ctx, JPG_RENDER_TASK_PRIO, &ctx->render_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start the render task");
+        ctx->render_task = NULL;
+        free(job->frame.pixels);
+        memset(&job->frame, 0, sizeof(job->frame));
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static void jpg_viewer_render_cancel(jpg_viewer_ctx_t *ctx)
+{
+    /* A completion already queued on the LVGL task is stale from now on */
+    s_jpg_render_seq++;
+    if (!ctx->render_task) {
         return;
     }
-    memset(ctx, 0, sizeof(*ctx));
+
+    int64_t t0 = esp_timer_get_time();
+    ctx->render_cancel = true;
+    xSemaphoreTake(ctx->render_done, portMAX_DELAY);
+    ctx->render_task = NULL;
+    ctx->render_cancel = false;
+    free(ctx->job.frame.pixels);
+    memset(&ctx->job.frame, 0, sizeof(ctx->job.frame));
+    ESP_LOGD(TAG, "Cancelled render of %s in %lld us", ctx->job.path, (long long)(esp_timer_get_time() - t0));
 }
 
-static void jpg_viewer_on_close(lv_event_t *e)
+static void jpg_viewer_render_task(void *arg)
 {
-    jpg_viewer_ctx_t *ctx = lv_event_get_user_data(e);
-    if (!ctx || !ctx->active) {
+    jpg_viewer_ctx_t *ctx = (jpg_viewer_ctx_t *)arg;
+    jpg_viewer_job_t *job = &ctx->job;
+
+    int64_t t0 = esp_timer_get_time();
+    lv_draw_buf_t *canvas = NULL;
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    canvas = ctx->canvas_data ? &ctx->canvas : NULL;
+#endif
+    job->err = jpg_handler_set_src(ctx->image, job->path, canvas, &job->frame, &ctx->render_cancel);
+    ESP_LOGD(TAG, "Rendered %s: %s after %lld us", job->path, esp_err_to_name(job->err),
+             (long long)(esp_timer_get_time() - t0));
+
+    /* lv_async_call() needs the display lock; a cancelled job has nobody left to tell */
+    while (!ctx->render_cancel) {
+        if (bsp_display_lock(JPG_RENDER_LOCK_POLL_MS)) {
+            lv_async_call(jpg_viewer_render_done, (void *)(uintptr_t)job->seq);
+            bsp_display_unlock();
+            break;
+        }
+    }
+
+    xSemaphoreGive(ctx->render_done);
+    vTaskDelete(NULL);
+}
+
+static void jpg_viewer_render_done(void *user)
+{
+    jpg_viewer_ctx_t *ctx = &s_jpg_viewer;
+    if ((uint32_t)(uintptr_t)user != s_jpg_render_seq || !ctx->render_task) {
+        return;
+    }
+
+    /* The worker gives the semaphore right after queueing this call */
+    xSemaphoreTake(ctx->render_done, portMAX_DELAY);
+    ctx->render_task = NULL;
+
+    jpg_viewer_job_t *job = &ctx->job;
+#if CONFIG_JPG_VIEWER_CACHE
+    if (job->err == ESP_OK) {
+        jpg_cache_insert(job->path, &job->frame);
+    } else {
+        jpg_cache_frame_free(&job->frame);
+    }
+#endif
+    if (job->err == ESP_OK) {
+        jpg_viewer_shown(ctx, job->dir);
+        return;
+    }
+
+    ESP_LOGE(TAG, "Failed to render %s: (%s)", job->path, esp_err_to_name(job->err));
+    if (job->dir != 0) {
+        /* Stay on the viewer so the user can keep swiping past the broken file */
+        jpg_viewer_shown(ctx, job->dir);
         return;
     }
 
+    /* The first image failed: leave the viewer and let the opener explain why */
+    jpg_viewer_error_cb_t on_error = ctx->on_error;
+    void *on_error_user = ctx->user;
+    esp_err_t err = job->err;
+    jpg_viewer_close(ctx, ctx->previous_screen);
+    if (on_error) {
+        on_error(on_error_user, err);
+    }
+}
+
+static void jpg_viewer_shown(jpg_viewer_ctx_t *ctx, int dir)
+{
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    const bool direct = !ctx->canvas_data;
+#else
+    const bool direct = true;
+#endif
+    if (direct) {
+        /* The picture covers the buttons; let LVGL draw them again on top */
+        lv_obj_invalidate(ctx->close_btn);
+#if CONFIG_JPG_VIEWER_SLIDESHOW
+        if (ctx->play_btn) {
+            lv_obj_invalidate(ctx->play_btn);
+        }
+#endif
+    }
+#if CONFIG_JPG_VIEWER_SLIDESHOW
+    jpg_viewer_prefetch_next(ctx, dir < 0 ? -1 : 1);
+#else
+    (void)dir;
+#endif
+}
+
+static void jpg_viewer_close(jpg_viewer_ctx_t *ctx, lv_obj_t *target)
+{
+    jpg_viewer_render_cancel(ctx);
+
     if (!bsp_display_lock(0)) {
         return;
     }
 
     lv_obj_t *old_screen = ctx->screen;
-    lv_obj_t *target = ctx->return_screen ? ctx->return_screen : ctx->previous_screen;
     if (target) {
         lv_screen_load(target);
     }
@@ -298,6 +914,320 @@ static void jpg_viewer_on_close(lv_event_t *e)
     jpg_viewer_reset(ctx);
 }
 
+static esp_err_t jpg_render(const char *path, jpg_stripe_ctx_t *ctx)
+{
+    ctx->disp_w = BSP_LCD_H_RES;
+    ctx->disp_h = BSP_LCD_V_RES;
+    ctx->orientation = 1;
+
+    esp_err_t err;
+#if CONFIG_JPG_VIEWER_PNG || CONFIG_JPG_VIEWER_BMP
+    jpg_stream_decoder_t decode = NULL;
+#if CONFIG_JPG_VIEWER_PNG
+    if (jpg_path_has_ext(path, ".png")) {
+        decode = img_png_draw;
+    }
+#endif
+#if CONFIG_JPG_VIEWER_BMP
+    if (jpg_path_has_ext(path, ".bmp")) {
+        decode = img_bmp_draw;
+    }
+#endif
+    err = decode ? jpg_draw_streamed(path, ctx, decode) : jpg_draw_striped(path, ctx);
+#else
+    err = jpg_draw_striped(path, ctx);
+#endif
+
+    free(ctx->xform[0]);
+    free(ctx->xform[1]);
+    ctx->xform[0] = ctx->xform[1] = NULL;
+    ctx->xform_cap = 0;
+
+    if (err != ESP_OK && jpg_cancelled(ctx)) {
+        err = ESP_ERR_INVALID_STATE;
+    }
+    return err;
+}
+
+static inline bool jpg_cancelled(const jpg_stripe_ctx_t *ctx)
+{
+    return ctx->cancel && *ctx->cancel;
+}
+
+static inline bool jpg_on_screen(const jpg_stripe_ctx_t *ctx)
+{
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    if (ctx->canvas) {
+        return true;
+    }
+#endif
+    return ctx->panel != NULL;
+}
+
+esp_err_t jpg_frame_render(const char *path, jpg_frame_t *frame, const volatile bool *cancel)
+{
+    if (!path || path[0] == '\0' || !frame || !frame->pixels) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    frame->w = 0;
+    frame->h = 0;
+    jpg_stripe_ctx_t ctx = {
+        .frame = frame->pixels,
+        .frame_cap = frame->cap,
+        .cancel = cancel,
+    };
+    esp_err_t err = jpg_render(path, &ctx);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return jpg_frame_set_size(&ctx, frame) ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+static bool jpg_frame_set_size(const jpg_stripe_ctx_t *ctx, jpg_frame_t *frame)
+{
+    if (!ctx->out_w || !ctx->out_h || (size_t)ctx->out_w * ctx->out_h > frame->cap) {
+        return false;
+    }
+
+    const bool transpose = ctx->orientation >= 5;
+    frame->w = (uint16_t)(transpose ? ctx->out_h : ctx->out_w);
+    frame->h = (uint16_t)(transpose ? ctx->out_w : ctx->out_h);
+    return true;
+}
+
+esp_err_t jpg_frame_blit(const jpg_frame_t *frame)
+{
+    if (!frame || !frame->pixels || !frame->w || !frame->h) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    jpg_stripe_ctx_t ctx = {
+        .orientation = 1,
+        .out_w = frame->w,
+        .out_h = frame->h,
+    };
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    /* With an open draw-buffer viewer the frame goes into its buffer instead */
+    if (s_jpg_viewer.canvas_data) {
+        ctx.canvas = &s_jpg_viewer.canvas;
+        ctx.canvas_obj = s_jpg_viewer.image;
+    }
+    if (!ctx.canvas)
+#endif
+    {
+        ctx.panel = bsp_display_get_panel();
+        if (!ctx.panel) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+
+    /* Bounce through the DMA band buffers: the frame may sit in PSRAM and is reused right away */
+    esp_err_t err = ESP_OK;
+    for (uint32_t y = 0; y < frame->h; y += JPG_FRAME_BLIT_ROWS) {
+        jpg_emit_band(&ctx, 0, y, frame->w, JPG_FRAME_BLIT_ROWS,
+                      frame->pixels + (size_t)y * frame->w, frame->w, false);
+        if (ctx.panel && !ctx.xform[0]) {
+            err = ESP_ERR_NO_MEM;
+            break;
+        }
+    }
+
+    free(ctx.xform[0]);
+    free(ctx.xform[1]);
+    return err;
+}
+
+static void jpg_viewer_reset(jpg_viewer_ctx_t *ctx)
+{
+    if (!ctx) {
+        return;
+    }
+    jpg_viewer_render_cancel(ctx);
+    if (ctx->render_done) {
+        vSemaphoreDelete(ctx->render_done);
+    }
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    /* The screen (and with it the image widget) is gone by now */
+    free(ctx->canvas_data);
+#endif
+#if CONFIG_JPG_VIEWER_SLIDESHOW
+    if (ctx->slideshow_timer) {
+        lv_timer_delete(ctx->slideshow_timer);
+    }
+#if CONFIG_JPG_VIEWER_PREFETCH
+    if (ctx->prefetch) {
+        jpg_prefetch_stop();
+    }
+#endif
+#endif
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+#if CONFIG_JPG_VIEWER_SLIDESHOW
+static void jpg_viewer_step(jpg_viewer_ctx_t *ctx, int dir)
+{
+    char next[IMG_VIEWER_MAX_PATH];
+    if (!ctx->step || !ctx->step(ctx->user, ctx->path, dir, next, sizeof(next))) {
+        return;
+    }
+
+    if (!bsp_display_lock(0)) {
+        return;
+    }
+
+    /* A half-drawn previous image is abandoned within one MCU row */
+    jpg_viewer_render_cancel(ctx);
+
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    if (ctx->canvas_data) {
+        lv_draw_buf_clear(&ctx->canvas, NULL);
+        lv_obj_invalidate(ctx->image);
+    } else
+#endif
+    {
+        /* LVGL does not know about the direct draw: repaint the background over the old picture */
+        lv_obj_invalidate(ctx->screen);
+        lv_refr_now(NULL);
+    }
+
+    strlcpy(ctx->path, next, sizeof(ctx->path));
+    esp_err_t err = jpg_viewer_show(ctx, next, dir);
+    if (err != ESP_OK) {
+        /* Stay on the viewer so the user can keep swiping past the broken file */
+        ESP_LOGE(TAG, "Failed to render %s: (%s)", next, esp_err_to_name(err));
+        jpg_viewer_shown(ctx, dir);
+    }
+    bsp_display_unlock();
+}
+
+static void jpg_viewer_prefetch_next(jpg_viewer_ctx_t *ctx, int dir)
+{
+#if CONFIG_JPG_VIEWER_PREFETCH
+    char next[IMG_VIEWER_MAX_PATH];
+    if (!ctx->prefetch || !ctx->step(ctx->user, ctx->path, dir, next, sizeof(next))) {
+        return;
+    }
+#if CONFIG_JPG_VIEWER_CACHE
+    if (jpg_cache_contains(next)) {
+        return;
+    }
+#endif
+    jpg_prefetch_request(next);
+#else
+    (void)ctx;
+    (void)dir;
+#endif
+}
+
+static void jpg_viewer_on_gesture(lv_event_t *e)
+{
+    jpg_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active) {
+        return;
+    }
+
+    lv_dir_t dir = lv_indev_get_gesture_dir(lv_indev_active());
+    if (dir != LV_DIR_LEFT && dir != LV_DIR_RIGHT) {
+        return;
+    }
+    lv_indev_wait_release(lv_indev_active());
+
+    /* A manual step restarts the slideshow interval */
+    if (ctx->slideshow_timer) {
+        lv_timer_reset(ctx->slideshow_timer);
+    }
+    jpg_viewer_step(ctx, dir == LV_DIR_LEFT ? 1 : -1);
+}
+
+static void jpg_viewer_on_play(lv_event_t *e)
+{
+    jpg_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active || !ctx->slideshow_timer) {
+        return;
+    }
+
+    ctx->playing = !ctx->playing;
+    if (ctx->playing) {
+        lv_timer_reset(ctx->slideshow_timer);
+        lv_timer_resume(ctx->slideshow_timer);
+    } else {
+        lv_timer_pause(ctx->slideshow_timer);
+    }
+    lv_label_set_text(ctx->play_label, ctx->playing ? LV_SYMBOL_PAUSE : LV_SYMBOL_PLAY);
+}
+
+static void jpg_viewer_slideshow_timer_cb(lv_timer_t *timer)
+{
+    jpg_viewer_ctx_t *ctx = lv_timer_get_user_data(timer);
+    if (!ctx || !ctx->active) {
+        return;
+    }
+    jpg_viewer_step(ctx, 1);
+}
+#endif
+
+static void jpg_viewer_on_close(lv_event_t *e)
+{
+    jpg_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->active) {
+        return;
+    }
+
+    jpg_viewer_close(ctx, ctx->return_screen ? ctx->return_screen : ctx->previous_screen);
+}
+
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+static void jpg_viewer_canvas_init(jpg_viewer_ctx_t *ctx)
+{
+    const uint32_t size = LV_DRAW_BUF_SIZE(BSP_LCD_H_RES, BSP_LCD_V_RES, LV_COLOR_FORMAT_RGB565);
+    ctx->canvas_data = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!ctx->canvas_data) {
+        ESP_LOGI(TAG, "No PSRAM for the %lu B draw buffer, drawing to the panel directly", (unsigned long)size);
+        return;
+    }
+    if (lv_draw_buf_init(&ctx->canvas, BSP_LCD_H_RES, BSP_LCD_V_RES, LV_COLOR_FORMAT_RGB565, 0,
+                         ctx->canvas_data, size) != LV_RESULT_OK) {
+        free(ctx->canvas_data);
+        ctx->canvas_data = NULL;
+        return;
+    }
+    lv_draw_buf_clear(&ctx->canvas, NULL);
+}
+
+static void jpg_canvas_band(jpg_stripe_ctx_t *ctx, const jpg_band_map_t *map, uint32_t w, uint32_t h,
+                            const uint16_t *src, uint32_t stride)
+{
+    lv_draw_buf_t *buf = ctx->canvas;
+    if (map->px0 + map->pw > buf->header.w || map->py0 + map->ph > buf->header.h) {
+        return;
+    }
+
+    /* Pixels are written outside the lock: LVGL only reads them after the invalidation below */
+    const uint32_t pitch = buf->header.stride / sizeof(uint16_t);
+    uint16_t *dst = (uint16_t *)buf->data + (size_t)map->py0 * pitch + map->px0;
+    jpg_band_copy(map, w, h, src, stride, dst, pitch);
+#if BSP_LCD_BIGENDIAN
+    /* The decoders emit panel byte order; LVGL renders from native RGB565 and swaps on flush */
+    for (uint32_t r = 0; r < map->ph; r++) {
+        lv_draw_sw_rgb565_swap(dst + (size_t)r * pitch, map->pw);
+    }
+#endif
+
+    if (!jpg_display_lock(ctx)) {
+        return;
+    }
+    lv_area_t area;
+    lv_obj_get_coords(ctx->canvas_obj, &area);
+    area.x1 += (int32_t)map->px0;
+    area.y1 += (int32_t)map->py0;
+    area.x2 = area.x1 + (int32_t)map->pw - 1;
+    area.y2 = area.y1 + (int32_t)map->ph - 1;
+    lv_obj_invalidate_area(ctx->canvas_obj, &area);
+    jpg_display_unlock(ctx);
+}
+#endif
+
 static size_t input_cb(JDEC *jd, uint8_t *buff, size_t nbytes)
 {
     jpg_stripe_ctx_t *ctx = (jpg_stripe_ctx_t *)jd->device;
@@ -322,6 +1252,7 @@ static size_t input_cb(JDEC *jd, uint8_t *buff, size_t nbytes)
     return nbytes;
 }
 
+#if !CONFIG_JPG_VIEWER_NATIVE_RGB565
 static int output_cb(JDEC *jd, void *bitmap, JRECT *rect)
 {
     jpg_stripe_ctx_t *ctx = (jpg_stripe_ctx_t *)jd->device; /* user context */
@@ -329,6 +1260,10 @@ static int output_cb(JDEC *jd, void *bitmap, JRECT *rect)
         return 0;
     }
 
+    if (jpg_cancelled(ctx)) {
+        return 0;
+    }
+
     const int w = rect->right - rect->left + 1;
     const int h = rect->bottom - rect->top + 1;
 
@@ -358,52 +1293,17 @@ static int output_cb(JDEC *jd, void *bitmap, JRECT *rect)
         }
     }
 
-    /* Clip to panel bounds to avoid wrap-around when images exceed display size */
-    if (rect->left >= ctx->disp_w || rect->top >= ctx->disp_h) {
-        return 1;
-    }
-
-    const int draw_left = rect->left;
-    const int draw_top = rect->top;
-    const int draw_right = (rect->right < (ctx->disp_w - 1)) ? rect->right : (int)(ctx->disp_w - 1);
-    const int draw_bottom = (rect->bottom < (ctx->disp_h - 1)) ? rect->bottom : (int)(ctx->disp_h - 1);
-    const int clipped_w = draw_right - draw_left + 1;
-    const int clipped_h = draw_bottom - draw_top + 1;
-
-    if (clipped_w <= 0 || clipped_h <= 0) {
-        return 1;
-    }
-
-    if (clipped_w == w && clipped_h == h) {
-        esp_lcd_panel_draw_bitmap(ctx->panel,
-                                  draw_left, draw_top,
-                                  draw_right + 1, draw_bottom + 1,
-                                  dst);
-    } else {
-        for (int row = 0; row < clipped_h; row++) {
-            esp_lcd_panel_draw_bitmap(ctx->panel,
-                                      draw_left, draw_top + row,
-                                      draw_left + clipped_w, draw_top + row + 1,
-                                      dst + (row * w));
-        }
-    }
+    /* Clipping to the image and orientation are handled by the band emitter */
+    jpg_emit_band(ctx, (uint32_t)rect->left, (uint32_t)rect->top, (uint32_t)w, (uint32_t)h, dst, (uint32_t)w, true);
     return 1; /* continue */
 }
+#endif
 
-static esp_err_t jpg_draw_striped(const char *path, esp_lcd_panel_handle_t panel)
+static esp_err_t jpg_draw_striped(const char *path, jpg_stripe_ctx_t *ctx)
 {
     esp_err_t err = ESP_OK;
-    jpg_stripe_ctx_t ctx = {
-        .panel = panel,
-        .stripe = NULL,
-        .stripe_w = 0,
-        .stripe_h = 0,
-        .disp_w = BSP_LCD_H_RES,
-        .disp_h = BSP_LCD_V_RES,
-        .scale = 0,
-    };
 
-    lv_fs_res_t res = lv_fs_open(&ctx.file, path, LV_FS_MODE_RD);
+    lv_fs_res_t res = lv_fs_open(&ctx->file, path, LV_FS_MODE_RD);
     if (res != LV_FS_RES_OK) {
         ESP_LOGE(TAG, "Failed to open image file, lv_fs_res: (%d)", res);
         return ESP_FAIL;
@@ -411,8 +1311,51 @@ static esp_err_t jpg_draw_striped(const char *path, esp_lcd_panel_handle_t panel
 
     uint8_t workb[4096];      /* tjpgd work buffer */
 
+#if CONFIG_JPG_VIEWER_EXIF_ORIENTATION || CONFIG_JPG_VIEWER_EXIF_THUMBNAIL
+    jpg_exif_info_t exif;
+    jpg_exif_read(&ctx->file, &exif);
+#if CONFIG_JPG_VIEWER_EXIF_ORIENTATION
+    ctx->orientation = exif.orientation;
+    if (ctx->orientation >= 5) {
+        /* Transposed orientations: the image's rows run along the panel's columns */
+        ctx->disp_w = BSP_LCD_V_RES;
+        ctx->disp_h = BSP_LCD_H_RES;
+    }
+#endif
+#if CONFIG_JPG_VIEWER_EXIF_THUMBNAIL
+    /* The preview only helps on screen; frame renders go straight to the full decode */
+    if (jpg_on_screen(ctx) && exif.thumb_len && exif.width && exif.height &&
+        img_stream_pick_scale(exif.width, exif.height, ctx->disp_w, ctx->disp_h, &ctx->scale, &ctx->out_w, &ctx->out_h)) {
+        jpg_draw_thumbnail(ctx, &exif, workb, sizeof(workb));
+    }
+#endif
+    lv_fs_seek(&ctx->file, 0, LV_FS_SEEK_SET);
+#endif
+
     JDEC jd;
-    JRESULT rc = jd_prepare(&jd, input_cb, workb, sizeof(workb), &ctx);
+    JRESULT rc = jd_prepare(&jd, input_cb, workb, sizeof(workb), ctx);
+#if CONFIG_JPG_VIEWER_PROGRESSIVE
+    if (rc == JDR_FMT3) {
+        /* tjpgd only handles baseline; try the progressive path before giving up */
+        img_stream_cfg_t prog = {
+            .file = &ctx->file,
+            .max_w = ctx->disp_w,
+            .max_h = ctx->disp_h,
+            .draw = jpg_stream_band_cb,
+            .size = jpg_stream_size_cb,
+            .user = ctx,
+            .cancel = ctx->cancel,
+        };
+        err = jpg_progressive_draw(&prog);
+        if (err != ESP_OK && !jpg_cancelled(ctx)) {
+            ESP_LOGE(TAG, "Progressive decode failed: %s", esp_err_to_name(err));
+            if (err == ESP_ERR_INVALID_RESPONSE) {
+                err = ESP_ERR_NOT_SUPPORTED; /* Corrupt data, not an SD card problem */
+            }
+        }
+        goto cleanup;
+    }
+#endif
     if (rc != JDR_OK) {
         ESP_LOGE(TAG, "Failed to initialize tjpgd decoder, JRESULT: (%d)", rc);
         if (rc == JDR_INP || rc == JDR_FMT1 || rc == JDR_FMT2 || rc == JDR_FMT3){
@@ -424,50 +1367,435 @@ static esp_err_t jpg_draw_striped(const char *path, esp_lcd_panel_handle_t panel
     }
 
     /* Choose the smallest power-of-two downscale that fits the panel */
-    uint32_t scaled_w = jd.width;
-    uint32_t scaled_h = jd.height;
-    while (ctx.scale < 3 && (scaled_w > ctx.disp_w || scaled_h > ctx.disp_h)) {
-        ctx.scale++;
-        scaled_w = (scaled_w + 1) >> 1;
-        scaled_h = (scaled_h + 1) >> 1;
-    }
-
-    if (scaled_w > ctx.disp_w || scaled_h > ctx.disp_h) {
+    uint32_t scaled_w = 0;
+    uint32_t scaled_h = 0;
+    if (!img_stream_pick_scale(jd.width, jd.height, ctx->disp_w, ctx->disp_h, &ctx->scale, &scaled_w, &scaled_h)) {
         ESP_LOGE(TAG, "Image %ux%u is too large to fit display %ux%u even at 1/%u scale",
-                 jd.width, jd.height, ctx.disp_w, ctx.disp_h, 1U << ctx.scale);
+                 jd.width, jd.height, ctx->disp_w, ctx->disp_h, 1U << ctx->scale);
         err = ESP_ERR_INVALID_SIZE;
         goto cleanup;
     }
 
     ESP_LOGD(TAG, "Drawing JPEG %ux%u scaled 1/%u -> %lux%lu",
-             jd.width, jd.height, 1U << ctx.scale,
+             jd.width, jd.height, 1U << ctx->scale,
              (unsigned long)scaled_w, (unsigned long)scaled_h);
 
+    ctx->out_w = scaled_w;
+    ctx->out_h = scaled_h;
+
     /* MCU height = msy * 8 lines; width capped to scaled image width */
-    ctx.stripe_w = scaled_w;
-    ctx.stripe_h = (uint32_t)((jd.msy * 8u) >> ctx.scale);
-    if (ctx.stripe_h == 0) {
-        ctx.stripe_h = 1;
+    ctx->stripe_w = scaled_w;
+    ctx->stripe_h = (uint32_t)((jd.msy * 8u) >> ctx->scale);
+    if (ctx->stripe_h == 0) {
+        ctx->stripe_h = 1;
     }
-    size_t stripe_size = ctx.stripe_w * ctx.stripe_h * sizeof(uint16_t);
+    size_t stripe_size = ctx->stripe_w * ctx->stripe_h * sizeof(uint16_t);
     ESP_LOGW(TAG, "Stripe size is %lu", stripe_size);
-    ctx.stripe = heap_caps_malloc(stripe_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
-    if (!ctx.stripe) {
+    ctx->stripe = heap_caps_malloc(stripe_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!ctx->stripe) {
         ESP_LOGE(TAG, "Failed to allocate memory for the stripe buffer used for image draw");
         err = ESP_ERR_NO_MEM;
         goto cleanup;
     }
 
-    rc = jd_decomp(&jd, output_cb, ctx.scale); /* scale: 0=full, 1=1/2, 2=1/4, 3=1/8 */
+#if CONFIG_JPG_VIEWER_NATIVE_RGB565
+    ctx->stripe_alt = heap_caps_malloc(stripe_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!ctx->stripe_alt) {
+        ESP_LOGE(TAG, "Failed to allocate memory for the second stripe buffer used for image draw");
+        err = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+    jd.scale = ctx->scale;
+    rc = jpg_decomp_rgb565(&jd, ctx);
+#else
+    rc = jd_decomp(&jd, output_cb, ctx->scale); /* scale: 0=full, 1=1/2, 2=1/4, 3=1/8 */
+#endif
     if (rc != JDR_OK) {
-        ESP_LOGE(TAG, "Failed to draw image, JRESULT: (%d)", rc);
+        if (!jpg_cancelled(ctx)) {
+            ESP_LOGE(TAG, "Failed to draw image, JRESULT: (%d)", rc);
+        }
         err = ESP_FAIL;
     }
 
 cleanup:
-    lv_fs_close(&ctx.file);
-    if (ctx.stripe) {
-        free(ctx.stripe);
+    lv_fs_close(&ctx->file);
+    if (ctx->stripe) {
+        free(ctx->stripe);
     }
+    if (ctx->stripe_alt) {
+        free(ctx->stripe_alt);
+    }
+    ctx->stripe = ctx->stripe_alt = NULL;
     return err;
 }
+
+#if CONFIG_JPG_VIEWER_PNG || CONFIG_JPG_VIEWER_BMP
+static bool jpg_path_has_ext(const char *path, const char *ext)
+{
+    const char *dot = strrchr(path, '.');
+    return dot && strcasecmp(dot, ext) == 0;
+}
+
+static esp_err_t jpg_draw_streamed(const char *path, jpg_stripe_ctx_t *ctx, jpg_stream_decoder_t decode)
+{
+    lv_fs_res_t res = lv_fs_open(&ctx->file, path, LV_FS_MODE_RD);
+    if (res != LV_FS_RES_OK) {
+        ESP_LOGE(TAG, "Failed to open image file, lv_fs_res: (%d)", res);
+        return ESP_FAIL;
+    }
+
+    img_stream_cfg_t cfg = {
+        .file = &ctx->file,
+        .max_w = ctx->disp_w,
+        .max_h = ctx->disp_h,
+        .draw = jpg_stream_band_cb,
+        .size = jpg_stream_size_cb,
+        .user = ctx,
+        .cancel = ctx->cancel,
+    };
+    esp_err_t err = decode(&cfg);
+    if (err != ESP_OK && !jpg_cancelled(ctx)) {
+        ESP_LOGE(TAG, "Streaming decode failed: %s", esp_err_to_name(err));
+        if (err == ESP_ERR_INVALID_RESPONSE) {
+            err = ESP_ERR_NOT_SUPPORTED; /* Corrupt data, not an SD card problem */
+        }
+    }
+
+    lv_fs_close(&ctx->file);
+    return err;
+}
+#endif
+
+static void jpg_emit_band(jpg_stripe_ctx_t *ctx, uint32_t x, uint32_t y, uint32_t w, uint32_t h,
+                          const uint16_t *src, uint32_t stride, bool stable)
+{
+    if (x >= ctx->out_w || y >= ctx->out_h || !w || !h) {
+        return;
+    }
+    if (x + w > ctx->out_w) {
+        w = ctx->out_w - x;
+    }
+    if (y + h > ctx->out_h) {
+        h = ctx->out_h - y;
+    }
+
+    /*
+     * Map image (ix, iy) to panel (px, py) for the EXIF orientation, with
+     * W/H = scaled image size:
+     *   1 (ix, iy)          2 (W-1-ix, iy)        3 (W-1-ix, H-1-iy)   4 (ix, H-1-iy)
+     *   5 (iy, ix)          6 (H-1-iy, ix)        7 (H-1-iy, W-1-ix)   8 (iy, W-1-ix)
+     * The band maps to a panel rectangle; jpg_band_copy() walks the source and
+     * steps through the destination with per-axis strides.
+     */
+    const uint8_t o = ctx->orientation ? ctx->orientation : 1;
+    const uint32_t W = ctx->out_w;
+    const uint32_t H = ctx->out_h;
+    jpg_band_map_t map = {
+        .transpose = o >= 5,
+        .flip_x = (o == 2 || o == 3 || o == 6 || o == 7),   /* Panel x decreases as the source advances */
+        .flip_y = (o == 3 || o == 4 || o == 7 || o == 8),   /* Panel y decreases as the source advances */
+    };
+    map.pw = map.transpose ? h : w;
+    map.ph = map.transpose ? w : h;
+    if (!map.transpose) {
+        map.px0 = map.flip_x ? W - (x + w) : x;
+        map.py0 = map.flip_y ? H - (y + h) : y;
+    } else {
+        map.px0 = map.flip_x ? H - (y + h) : y;
+        map.py0 = map.flip_y ? W - (x + w) : x;
+    }
+
+    /* The frame holds the whole image in panel orientation, rows packed */
+    if (ctx->frame && (size_t)W * H <= ctx->frame_cap) {
+        const uint32_t pitch = map.transpose ? H : W;
+        jpg_band_copy(&map, w, h, src, stride, ctx->frame + (size_t)map.py0 * pitch + map.px0, pitch);
+    }
+#if CONFIG_JPG_VIEWER_DRAW_BUF
+    if (ctx->canvas) {
+        jpg_canvas_band(ctx, &map, w, h, src, stride);
+        return;
+    }
+#endif
+    if (!ctx->panel) {
+        return;
+    }
+
+    if (o <= 1 && stable && w == stride) {
+        jpg_panel_draw(ctx, x, y, x + w, y + h, src);
+        return;
+    }
+
+    const size_t need = (size_t)w * h;
+    if (need > ctx->xform_cap) {
+        for (int i = 0; i < 2; i++) {
+            free(ctx->xform[i]);
+            ctx->xform[i] = heap_caps_malloc(need * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        }
+        if (!ctx->xform[0] || !ctx->xform[1]) {
+            ESP_LOGE(TAG, "Failed to allocate the band transform buffers");
+            free(ctx->xform[0]);
+            free(ctx->xform[1]);
+            ctx->xform[0] = ctx->xform[1] = NULL;
+            ctx->xform_cap = 0;
+            return;
+        }
+        ctx->xform_cap = need;
+    }
+    uint16_t *dst = ctx->xform[ctx->xform_cur];
+    ctx->xform_cur ^= 1u;
+
+    jpg_band_copy(&map, w, h, src, stride, dst, map.pw);
+    jpg_panel_draw(ctx, map.px0, map.py0, map.px0 + map.pw, map.py0 + map.ph, dst);
+}
+
+static bool jpg_display_lock(const jpg_stripe_ctx_t *ctx)
+{
+    if (!ctx->lock_panel) {
+        return true;
+    }
+    /* Short waits: the lock holder may be the task cancelling this render */
+    while (!bsp_display_lock(JPG_RENDER_LOCK_POLL_MS)) {
+        if (jpg_cancelled(ctx)) {
+            return false;
+        }
+    }
+    if (jpg_cancelled(ctx)) {
+        bsp_display_unlock();
+        return false;
+    }
+    return true;
+}
+
+static void jpg_display_unlock(const jpg_stripe_ctx_t *ctx)
+{
+    if (ctx->lock_panel) {
+        bsp_display_unlock();
+    }
+}
+
+static bool jpg_panel_draw(const jpg_stripe_ctx_t *ctx, uint32_t x0, uint32_t y0,
+                           uint32_t x1, uint32_t y1, const uint16_t *pixels)
+{
+    if (!jpg_display_lock(ctx)) {
+        return false;
+    }
+    esp_lcd_panel_draw_bitmap(ctx->panel, (int)x0, (int)y0, (int)x1, (int)y1, pixels);
+    jpg_display_unlock(ctx);
+    return true;
+}
+
+static void jpg_band_copy(const jpg_band_map_t *map, uint32_t w, uint32_t h,
+                          const uint16_t *src, uint32_t stride, uint16_t *dst, uint32_t pitch)
+{
+    /* Destination index of source (0, 0) and the steps for +1 column / +1 row */
+    int32_t di;         /* Step per source column */
+    int32_t dj;         /* Step per source row */
+    if (!map->transpose) {
+        di = map->flip_x ? -1 : 1;
+        dj = map->flip_y ? -(int32_t)pitch : (int32_t)pitch;
+    } else {
+        di = map->flip_y ? -(int32_t)pitch : (int32_t)pitch;
+        dj = map->flip_x ? -1 : 1;
+    }
+    const int32_t d0 = (map->flip_x ? (int32_t)map->pw - 1 : 0) +
+                       (map->flip_y ? (int32_t)(map->ph - 1) * (int32_t)pitch : 0);
+
+    for (uint32_t j = 0; j < h; j++) {
+        const uint16_t *row = src + (size_t)j * stride;
+        int32_t d = d0 + (int32_t)j * dj;
+        for (uint32_t i = 0; i < w; i++, d += di) {
+            dst[d] = row[i];
+        }
+    }
+}
+
+#if CONFIG_JPG_VIEWER_EXIF_THUMBNAIL
+static void jpg_draw_thumbnail(jpg_stripe_ctx_t *ctx, const jpg_exif_info_t *exif, uint8_t *workb, size_t size)
+{
+    if (lv_fs_seek(&ctx->file, exif->thumb_offset, LV_FS_SEEK_SET) != LV_FS_RES_OK) {
+        return;
+    }
+
+    JDEC jd;
+    if (jd_prepare(&jd, input_cb, workb, size, ctx) != JDR_OK) {
+        ESP_LOGD(TAG, "EXIF thumbnail is not a baseline JPEG, skipping preview");
+        return;
+    }
+    /* Embedded thumbnails are ~160x120; anything larger would not be "instant" */
+    if ((uint32_t)jd.width * jd.height > (uint32_t)BSP_LCD_H_RES * BSP_LCD_V_RES) {
+        return;
+    }
+
+    /* Largest upscaled MCU: one MCU of the thumbnail stretched to the output size */
+    const uint32_t mcu_w = jd.msx * 8u;
+    const uint32_t mcu_h = jd.msy * 8u;
+    const uint32_t max_w = (mcu_w * ctx->out_w + jd.width - 1u) / jd.width + 1u;
+    const uint32_t max_h = (mcu_h * ctx->out_h + jd.height - 1u) / jd.height + 1u;
+    ctx->stripe = heap_caps_malloc(max_w * max_h * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!ctx->stripe) {
+        return;
+    }
+    ctx->stripe_w = jd.width;      /* Thumbnail size, used by the output callback */
+    ctx->stripe_h = jd.height;
+
+    int64_t t0 = esp_timer_get_time();
+    JRESULT rc = jd_decomp(&jd, jpg_thumb_output_cb, 0);
+    ESP_LOGD(TAG, "EXIF thumbnail %ux%u drawn in %lld us (rc %d)",
+             jd.width, jd.height, (long long)(esp_timer_get_time() - t0), rc);
+
+    free(ctx->stripe);
+    ctx->stripe = NULL;
+    ctx->stripe_w = 0;
+    ctx->stripe_h = 0;
+}
+
+static int jpg_thumb_output_cb(JDEC *jd, void *bitmap, JRECT *rect)
+{
+    jpg_stripe_ctx_t *ctx = (jpg_stripe_ctx_t *)jd->device;
+    const uint32_t tw = ctx->stripe_w;
+    const uint32_t th = ctx->stripe_h;
+
+    /* Destination span covered by this MCU at the final image size */
+    const uint32_t x0 = rect->left * ctx->out_w / tw;
+    const uint32_t x1 = (rect->right + 1u) * ctx->out_w / tw;
+    const uint32_t y0 = rect->top * ctx->out_h / th;
+    const uint32_t y1 = (rect->bottom + 1u) * ctx->out_h / th;
+    if (x1 <= x0 || y1 <= y0) {
+        return 1;
+    }
+
+    const uint8_t *src = (const uint8_t *)bitmap;   /* B,G,R from tjpgd */
+    const uint32_t src_stride = jd->msx * 8u;       /* tjpgd always outputs full MCU width */
+    const uint32_t dw = x1 - x0;
+    uint16_t *dst = ctx->stripe;
+    for (uint32_t y = y0; y < y1; y++) {
+        uint32_t sy = y * th / ctx->out_h;
+        sy = (sy > (uint32_t)rect->bottom ? (uint32_t)rect->bottom : sy) - rect->top;
+        for (uint32_t x = x0; x < x1; x++) {
+            uint32_t sx = x * tw / ctx->out_w;
+            sx = (sx > (uint32_t)rect->right ? (uint32_t)rect->right : sx) - rect->left;
+            const uint8_t *p = src + (sy * src_stride + sx) * 3u;
+            uint16_t c = ((p[2] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[0] >> 3);
+            *dst++ = (uint16_t)((c >> 8) | (c << 8));
+        }
+    }
+
+    jpg_emit_band(ctx, x0, y0, dw, y1 - y0, ctx->stripe, dw, false);
+    return 1;
+}
+#endif
+
+#if CONFIG_JPG_VIEWER_NATIVE_RGB565
+static inline uint8_t jpg_clip8(int v)
+{
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static JRESULT jpg_decomp_rgb565(JDEC *jd, jpg_stripe_ctx_t *ctx)
+{
+    const unsigned int mx = jd->msx * 8u;
+    const unsigned int my = jd->msy * 8u;
+    uint16_t rst = 0;
+    uint16_t rsc = 0;
+
+    jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;
+
+    for (unsigned int y = 0; y < jd->height; y += my) {
+        if (jpg_cancelled(ctx)) {
+            return JDR_INTR;
+        }
+        for (unsigned int x = 0; x < jd->width; x += mx) {
+            if (jd->nrst && rst++ == jd->nrst) {
+                JRESULT rc = jd_restart(jd, rsc++);
+                if (rc != JDR_OK) {
+                    return rc;
+                }
+                rst = 1;
+            }
+            JRESULT rc = jd_mcu_load(jd);
+            if (rc != JDR_OK) {
+                return rc;
+            }
+            jpg_mcu_to_stripe(jd, ctx, x, y);
+        }
+
+        const unsigned int rem = (y + my <= jd->height) ? my : jd->height - y;
+        unsigned int rows = (rem + (1u << ctx->scale) - 1u) >> ctx->scale; /* round up like scaled_h */
+        if (rows) {
+            jpg_flush_stripe(ctx, y >> ctx->scale, rows);
+        }
+    }
+    return JDR_OK;
+}
+
+static void jpg_mcu_to_stripe(JDEC *jd, jpg_stripe_ctx_t *ctx, unsigned int x, unsigned int y)
+{
+    const unsigned int mx = jd->msx * 8u;
+    const unsigned int my = jd->msy * 8u;
+    const unsigned int scale = ctx->scale;
+
+    const unsigned int round = (1u << scale) - 1u; /* round partial edges up like scaled_w/h */
+    unsigned int rx = (((x + mx <= jd->width) ? mx : jd->width - x) + round) >> scale;
+    unsigned int ry = (((y + my <= jd->height) ? my : jd->height - y) + round) >> scale;
+    const unsigned int left = x >> scale;
+    if (!rx || !ry || left >= ctx->stripe_w) {
+        return;
+    }
+    if (left + rx > ctx->stripe_w) {
+        rx = ctx->stripe_w - left;
+    }
+    if (ry > ctx->stripe_h) {
+        ry = ctx->stripe_h;
+    }
+
+    const jd_yuv_t *ybuf = jd->mcubuf;
+    const jd_yuv_t *cbuf = jd->mcubuf + 64u * jd->msx * jd->msy; /* Cb block, Cr follows at +64 */
+    const unsigned int cshift_x = jd->msx - 1u;
+    const unsigned int cshift_y = jd->msy - 1u;
+
+    uint8_t ys[16];
+    uint8_t cbs[16];
+    uint8_t crs[16];
+
+    for (unsigned int oy = 0; oy < ry; oy++) {
+        const unsigned int sy = oy << scale;
+        const jd_yuv_t *yrow = ybuf + (sy >> 3) * jd->msx * 64u + (sy & 7u) * 8u;
+        const jd_yuv_t *crow = cbuf + (sy >> cshift_y) * 8u;
+        for (unsigned int ox = 0; ox < rx; ox++) {
+            const unsigned int sx = ox << scale;
+            const unsigned int ci = sx >> cshift_x;
+            ys[ox] = jpg_clip8(yrow[(sx >> 3) * 64u + (sx & 7u)]);
+            cbs[ox] = jpg_clip8(crow[ci]);
+            crs[ox] = jpg_clip8(crow[64u + ci]);
+        }
+        jpg_color_ycc_to_rgb565(ys, cbs, crs, ctx->stripe + oy * ctx->stripe_w + left, rx);
+    }
+}
+
+static void jpg_flush_stripe(jpg_stripe_ctx_t *ctx, unsigned int top, unsigned int rows)
+{
+    /* Queued DMA transfer; the next draw call waits for it before reusing the bus */
+    jpg_emit_band(ctx, 0, top, ctx->stripe_w, rows, ctx->stripe, ctx->stripe_w, true);
+
+    uint16_t *next = ctx->stripe_alt;
+    ctx->stripe_alt = ctx->stripe;
+    ctx->stripe = next;
+}
+#endif
+
+#if JPG_VIEWER_STREAM_DECODERS
+static int jpg_stream_band_cb(void *user, uint32_t x0, uint32_t y0,
+                              uint32_t x1, uint32_t y1, const uint16_t *pixels)
+{
+    jpg_stripe_ctx_t *ctx = (jpg_stripe_ctx_t *)user;
+    jpg_emit_band(ctx, x0, y0, x1 - x0, y1 - y0, pixels, x1 - x0, true);
+    return !jpg_cancelled(ctx);
+}
+
+static void jpg_stream_size_cb(void *user, uint32_t w, uint32_t h)
+{
+    jpg_stripe_ctx_t *ctx = (jpg_stripe_ctx_t *)user;
+    ctx->out_w = w;
+    ctx->out_h = h;
+}
+#endif
@@ -0,0 +1,311 @@
+#include "jpg_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "bsp/esp-bsp.h"
+#include "lvgl.h"
+#include "sdkconfig.h"
+
+#define TAG "jpg_cache"
+
+#define JPG_CACHE_MAX_ENTRIES   16
+#define JPG_CACHE_MAX_PATH      256
+#define JPG_CACHE_BUDGET        ((size_t)CONFIG_JPG_VIEWER_CACHE_BUDGET_KB * 1024u)
+
+typedef struct {
+    char path[JPG_CACHE_MAX_PATH];  /* Empty if the slot is free */
+    time_t mtime;
+    off_t size;
+    uint32_t stamp;                 /* Last use; the smallest stamp is evicted first */
+    jpg_frame_t frame;
+} jpg_cache_entry_t;
+
+typedef struct {
+    jpg_cache_entry_t entries[JPG_CACHE_MAX_ENTRIES];
+    uint32_t clock;
+    jpg_cache_stats_t stats;
+} jpg_cache_ctx_t;
+
+static jpg_cache_ctx_t s_cache;
+
+/**
+ * @brief Read the modification time and size of an LVGL "S:" path through the VFS.
+ *
+ * @param path  Drive-prefixed path.
+ * @param mtime Receives the modification time.
+ * @param size  Receives the file size.
+ *
+ * @return true if the file exists.
+ */
+static bool jpg_cache_stat(const char *path, time_t *mtime, off_t *size);
+
+/**
+ * @brief Find the entry of @p path whose key still matches the file on the card.
+ *
+ * Entries whose file changed or disappeared are evicted on the way.
+ *
+ * @return The entry, or NULL.
+ */
+static jpg_cache_entry_t *jpg_cache_find(const char *path);
+
+/**
+ * @brief Free an entry's frame and mark the slot empty.
+ */
+static void jpg_cache_evict(jpg_cache_entry_t *entry);
+
+/**
+ * @brief Evict least recently used entries until @p bytes more fit the budget and a slot is free.
+ *
+ * @return true if there is room.
+ */
+static bool jpg_cache_make_room(size_t bytes);
+
+/**
+ * @brief Store @p frame (its pixels now owned by the cache) under @p path as the most recent entry.
+ */
+static void jpg_cache_store(const char *path, time_t mtime, off_t size, const jpg_frame_t *frame);
+
+bool jpg_cache_show(const char *path)
+{
+    if (!path) {
+        return false;
+    }
+
+    jpg_cache_entry_t *entry = jpg_cache_find(path);
+    if (!entry || jpg_frame_blit(&entry->frame) != ESP_OK) {
+        s_cache.stats.misses++;
+        ESP_LOGD(TAG, "Miss %s (%lu hits / %lu misses)", path,
+                 (unsigned long)s_cache.stats.hits, (unsigned long)s_cache.stats.misses);
+        return false;
+    }
+
+    entry->stamp = ++s_cache.clock;
+    s_cache.stats.hits++;
+    ESP_LOGD(TAG, "Hit %s (%lu hits / %lu misses)", path,
+             (unsigned long)s_cache.stats.hits, (unsigned long)s_cache.stats.misses);
+    return true;
+}
+
+bool jpg_cache_contains(const char *path)
+{
+    return path && jpg_cache_find(path) != NULL;
+}
+
+esp_err_t jpg_cache_frame_alloc(jpg_frame_t *frame)
+{
+    if (!frame) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(frame, 0, sizeof(*frame));
+
+#if CONFIG_SPIRAM
+    const size_t cap = (size_t)BSP_LCD_H_RES * BSP_LCD_V_RES;
+    if (!jpg_cache_make_room(cap * sizeof(uint16_t))) {
+        return ESP_ERR_NO_MEM;
+    }
+    frame->pixels = heap_caps_malloc(cap * sizeof(uint16_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!frame->pixels) {
+        return ESP_ERR_NO_MEM;
+    }
+    frame->cap = cap;
+    return ESP_OK;
+#else
+    /* Internal RAM is reserved for the decoders: no PSRAM, no cache */
+    return ESP_ERR_NO_MEM;
+#endif
+}
+
+void jpg_cache_frame_free(jpg_frame_t *frame)
+{
+    if (!frame) {
+        return;
+    }
+    free(frame->pixels);
+    memset(frame, 0, sizeof(*frame));
+}
+
+void jpg_cache_insert(const char *path, jpg_frame_t *frame)
+{
+    if (!frame) {
+        return;
+    }
+
+    time_t mtime;
+    off_t size;
+    if (!path || !frame->pixels || !frame->w || !frame->h ||
+        jpg_cache_find(path) || !jpg_cache_stat(path, &mtime, &size)) {
+        jpg_cache_frame_free(frame);
+        return;
+    }
+
+    /* Give back the part of the panel-sized buffer the image did not use */
+    const size_t used = (size_t)frame->w * frame->h;
+    if (used < frame->cap) {
+        uint16_t *shrunk = heap_caps_realloc(frame->pixels, used * sizeof(uint16_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (shrunk) {
+            frame->pixels = shrunk;
+            frame->cap = used;
+        }
+    }
+
+    if (!jpg_cache_make_room(frame->cap * sizeof(uint16_t))) {
+        jpg_cache_frame_free(frame);
+        return;
+    }
+    jpg_cache_store(path, mtime, size, frame);
+    memset(frame, 0, sizeof(*frame));
+}
+
+void jpg_cache_put(const char *path, const jpg_frame_t *frame)
+{
+#if CONFIG_SPIRAM
+    time_t mtime;
+    off_t size;
+    if (!path || !frame || !frame->pixels || !frame->w || !frame->h ||
+        jpg_cache_find(path) || !jpg_cache_stat(path, &mtime, &size)) {
+        return;
+    }
+
+    const size_t bytes = (size_t)frame->w * frame->h * sizeof(uint16_t);
+    if (!jpg_cache_make_room(bytes)) {
+        return;
+    }
+    jpg_frame_t copy = {
+        .pixels = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT),
+        .cap = (size_t)frame->w * frame->h,
+        .w = frame->w,
+        .h = frame->h,
+    };
+    if (!copy.pixels) {
+        return;
+    }
+    memcpy(copy.pixels, frame->pixels, bytes);
+    jpg_cache_store(path, mtime, size, &copy);
+#else
+    (void)path;
+    (void)frame;
+#endif
+}
+
+void jpg_cache_clear(void)
+{
+    for (size_t i = 0; i < JPG_CACHE_MAX_ENTRIES; i++) {
+        if (s_cache.entries[i].path[0] != '\0') {
+            jpg_cache_evict(&s_cache.entries[i]);
+        }
+    }
+}
+
+void jpg_cache_get_stats(jpg_cache_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    *out = s_cache.stats;
+    out->budget = JPG_CACHE_BUDGET;
+}
+
+static bool jpg_cache_stat(const char *path, time_t *mtime, off_t *size)
+{
+    char vfs_path[JPG_CACHE_MAX_PATH + 16];
+    if (path[0] == LV_FS_STDIO_LETTER && path[1] == ':') {
+        snprintf(vfs_path, sizeof(vfs_path), "%s%s", LV_FS_STDIO_PATH, path + 2);
+    } else {
+        strlcpy(vfs_path, path, sizeof(vfs_path));
+    }
+
+    struct stat st = {0};
+    if (stat(vfs_path, &st) != 0) {
+        return false;
+    }
+    *mtime = st.st_mtime;
+    *size = st.st_size;
+    return true;
+}
+
+static jpg_cache_entry_t *jpg_cache_find(const char *path)
+{
+    for (size_t i = 0; i < JPG_CACHE_MAX_ENTRIES; i++) {
+        jpg_cache_entry_t *entry = &s_cache.entries[i];
+        if (entry->path[0] == '\0' || strcmp(entry->path, path) != 0) {
+            continue;
+        }
+
+        time_t mtime;
+        off_t size;
+        if (!jpg_cache_stat(path, &mtime, &size) || mtime != entry->mtime || size != entry->size) {
+            ESP_LOGD(TAG, "Dropping stale frame of %s", path);
+            jpg_cache_evict(entry);
+            return NULL;
+        }
+        return entry;
+    }
+    return NULL;
+}
+
+static void jpg_cache_evict(jpg_cache_entry_t *entry)
+{
+    s_cache.stats.bytes -= entry->frame.cap * sizeof(uint16_t);
+    s_cache.stats.entries--;
+    s_cache.stats.evictions++;
+    free(entry->frame.pixels);
+    memset(entry, 0, sizeof(*entry));
+}
+
+static bool jpg_cache_make_room(size_t bytes)
+{
+    if (bytes > JPG_CACHE_BUDGET) {
+        return false;
+    }
+
+    for (;;) {
+        jpg_cache_entry_t *oldest = NULL;
+        bool free_slot = false;
+        for (size_t i = 0; i < JPG_CACHE_MAX_ENTRIES; i++) {
+            jpg_cache_entry_t *entry = &s_cache.entries[i];
+            if (entry->path[0] == '\0') {
+                free_slot = true;
+            } else if (!oldest || entry->stamp < oldest->stamp) {
+                oldest = entry;
+            }
+        }
+        if (free_slot && s_cache.stats.bytes + bytes <= JPG_CACHE_BUDGET) {
+            return true;
+        }
+        if (!oldest) {
+            return false;
+        }
+        jpg_cache_evict(oldest);
+    }
+}
+
+static void jpg_cache_store(const char *path, time_t mtime, off_t size, const jpg_frame_t *frame)
+{
+    for (size_t i = 0; i < JPG_CACHE_MAX_ENTRIES; i++) {
+        jpg_cache_entry_t *entry = &s_cache.entries[i];
+        if (entry->path[0] != '\0') {
+            continue;
+        }
+
+        strlcpy(entry->path, path, sizeof(entry->path));
+        entry->mtime = mtime;
+        entry->size = size;
+        entry->stamp = ++s_cache.clock;
+        entry->frame = *frame;
+        s_cache.stats.bytes += frame->cap * sizeof(uint16_t);
+        s_cache.stats.entries++;
+        s_cache.stats.insertions++;
+        ESP_LOGD(TAG, "Cached %ux%u frame of %s (%u entries, %u / %u B)", frame->w, frame->h, path,
+                 (unsigned)s_cache.stats.entries, (unsigned)s_cache.stats.bytes, (unsigned)JPG_CACHE_BUDGET);
+        return;
+    }
+
+    /* jpg_cache_make_room() guarantees a free slot */
+    free(frame->pixels);
+}
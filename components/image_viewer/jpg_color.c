@@ -0,0 +1,95 @@
+#include "jpg_color.h"
+
+/*
+ * Fixed-point coefficients (Q5) for the JFIF YCbCr -> RGB transform:
+ *   R = Y + 1.402 (Cr - 128)
+ *   G = Y - 0.344 (Cb - 128) - 0.714 (Cr - 128)
+ *   B = Y + 1.772 (Cb - 128)
+ *
+ * Q5 keeps every intermediate lane value below 0x8000, which leaves bit 15 of
+ * each 16-bit lane free to act as a guard bit during saturation.
+ */
+#define JPG_COLOR_Q             5
+#define JPG_COLOR_CR_R          45u     /* 1.402 * 32 */
+#define JPG_COLOR_CB_G          11u     /* 0.344 * 32 */
+#define JPG_COLOR_CR_G          23u     /* 0.714 * 32 */
+#define JPG_COLOR_CB_B          57u     /* 1.772 * 32 */
+#define JPG_COLOR_G_BIAS        (255u * (JPG_COLOR_CB_G + JPG_COLOR_CR_G))
+#define JPG_COLOR_ROUND         (1u << (JPG_COLOR_Q - 1))
+
+/* Per-channel offsets removed before descaling (includes +0.5 rounding) */
+#define JPG_COLOR_OFF_R         (128u * JPG_COLOR_CR_R - JPG_COLOR_ROUND)
+#define JPG_COLOR_OFF_G         (JPG_COLOR_G_BIAS - 128u * (JPG_COLOR_CB_G + JPG_COLOR_CR_G) - JPG_COLOR_ROUND)
+#define JPG_COLOR_OFF_B         (128u * JPG_COLOR_CB_B - JPG_COLOR_ROUND)
+
+#define JPG_COLOR_LANES(v)      ((uint32_t)(v) * 0x00010001u)
+#define JPG_COLOR_GUARD         0x80008000u
+
+/**
+ * @brief Remove @p off2 from both lanes, descale and saturate each lane to 0..255.
+ *
+ * @param v    Two 16-bit lanes, each < 0x8000.
+ * @param off2 Lane offset replicated in both halves (each < 0x8000).
+ * @return Two lanes holding the clamped 8-bit channel values.
+ */
+static inline uint32_t jpg_color_clamp2(uint32_t v, uint32_t off2);
+
+/**
+ * @brief Scalar fallback used for an odd trailing pixel.
+ */
+static inline uint16_t jpg_color_pixel(uint8_t y, uint8_t cb, uint8_t cr);
+
+void jpg_color_ycc_to_rgb565(const uint8_t *y, const uint8_t *cb, const uint8_t *cr,
+                             uint16_t *dst, size_t count)
+{
+    const uint32_t off_r = JPG_COLOR_LANES(JPG_COLOR_OFF_R);
+    const uint32_t off_g = JPG_COLOR_LANES(JPG_COLOR_OFF_G);
+    const uint32_t off_b = JPG_COLOR_LANES(JPG_COLOR_OFF_B);
+    const uint32_t bias_g = JPG_COLOR_LANES(JPG_COLOR_G_BIAS);
+
+    size_t i = 0;
+    for (; i + 1 < count; i += 2) {
+        const uint32_t y2 = (uint32_t)y[i] | ((uint32_t)y[i + 1] << 16);
+        const uint32_t cb2 = (uint32_t)cb[i] | ((uint32_t)cb[i + 1] << 16);
+        const uint32_t cr2 = (uint32_t)cr[i] | ((uint32_t)cr[i + 1] << 16);
+        const uint32_t ys = y2 << JPG_COLOR_Q;
+
+        uint32_t r = jpg_color_clamp2(ys + cr2 * JPG_COLOR_CR_R, off_r);
+        uint32_t g = jpg_color_clamp2(ys + bias_g - (cb2 * JPG_COLOR_CB_G + cr2 * JPG_COLOR_CR_G), off_g);
+        uint32_t b = jpg_color_clamp2(ys + cb2 * JPG_COLOR_CB_B, off_b);
+
+        uint32_t c = ((r & 0x00F800F8u) << 8) | ((g & 0x00FC00FCu) << 3) | ((b >> 3) & 0x001F001Fu);
+        c = ((c & 0x00FF00FFu) << 8) | ((c >> 8) & 0x00FF00FFu); /* byte-swap each lane for the panel */
+
+        dst[i] = (uint16_t)c;
+        dst[i + 1] = (uint16_t)(c >> 16);
+    }
+
+    if (i < count) {
+        dst[i] = jpg_color_pixel(y[i], cb[i], cr[i]);
+    }
+}
+
+static inline uint32_t jpg_color_clamp2(uint32_t v, uint32_t off2)
+{
+    /* Guard bit survives only in lanes where v >= off (no borrow into the next lane) */
+    uint32_t t = (v | JPG_COLOR_GUARD) - off2;
+    uint32_t keep = ((t & JPG_COLOR_GUARD) >> 15) * 0xFFFFu;
+    t = ((t & keep & ~JPG_COLOR_GUARD) >> JPG_COLOR_Q) & 0x07FF07FFu;
+
+    /* Saturate lanes >= 256 to 255 */
+    uint32_t over = (((t | JPG_COLOR_GUARD) - 0x01000100u) & JPG_COLOR_GUARD) >> 15;
+    over *= 0xFFFFu;
+    return (t & ~over) | (0x00FF00FFu & over);
+}
+
+static inline uint16_t jpg_color_pixel(uint8_t y, uint8_t cb, uint8_t cr)
+{
+    const uint32_t ys = (uint32_t)y << JPG_COLOR_Q;
+    uint32_t r = jpg_color_clamp2(ys + cr * JPG_COLOR_CR_R, JPG_COLOR_OFF_R);
+    uint32_t g = jpg_color_clamp2(ys + JPG_COLOR_G_BIAS - (cb * JPG_COLOR_CB_G + cr * JPG_COLOR_CR_G), JPG_COLOR_OFF_G);
+    uint32_t b = jpg_color_clamp2(ys + cb * JPG_COLOR_CB_B, JPG_COLOR_OFF_B);
+
+    uint16_t out = (uint16_t)(((r & 0xF8u) << 8) | ((g & 0xFCu) << 3) | ((b & 0xFFu) >> 3));
+    return (uint16_t)((out >> 8) | (out << 8));
+}
@@ -0,0 +1,122 @@
+#include "jpg_color.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#define TAG "jpg_color_bench"
+
+#define JPG_BENCH_PIXELS        (320u * 16u)   /* one full-width MCU row on the panel */
+#define JPG_BENCH_ITERATIONS    200u
+
+/**
+ * @brief Legacy stage 1: tjpgd-style YCbCr -> RGB888 (B,G,R order) into a work buffer.
+ */
+static void jpg_bench_ycc_to_rgb888(const uint8_t *y, const uint8_t *cb, const uint8_t *cr,
+                                    uint8_t *rgb, size_t count);
+
+/**
+ * @brief Legacy stage 2: the per-pixel RGB888 -> byte-swapped RGB565 loop from output_cb().
+ */
+static void jpg_bench_rgb888_to_rgb565(const uint8_t *rgb, uint16_t *dst, size_t count);
+
+/**
+ * @brief Return the largest per-channel distance between two byte-swapped RGB565 pixels.
+ */
+static int jpg_bench_pixel_delta(uint16_t a, uint16_t b);
+
+void jpg_color_run_benchmark(void)
+{
+    const size_t n = JPG_BENCH_PIXELS;
+    uint8_t *y = heap_caps_malloc(n * 3, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint8_t *rgb = heap_caps_malloc(n * 3, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint16_t *legacy = heap_caps_malloc(n * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+    uint16_t *swar = heap_caps_malloc(n * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+    if (!y || !rgb || !legacy || !swar) {
+        ESP_LOGE(TAG, "Not enough memory for the benchmark buffers");
+        goto cleanup;
+    }
+    uint8_t *cb = y + n;
+    uint8_t *cr = cb + n;
+
+    /* Deterministic pseudo-random samples covering the full 8-bit range */
+    uint32_t seed = 0x1234567u;
+    for (size_t i = 0; i < n * 3; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        y[i] = (uint8_t)(seed >> 24);
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    for (uint32_t it = 0; it < JPG_BENCH_ITERATIONS; it++) {
+        jpg_bench_ycc_to_rgb888(y, cb, cr, rgb, n);
+        jpg_bench_rgb888_to_rgb565(rgb, legacy, n);
+    }
+    int64_t t1 = esp_timer_get_time();
+    for (uint32_t it = 0; it < JPG_BENCH_ITERATIONS; it++) {
+        jpg_color_ycc_to_rgb565(y, cb, cr, swar, n);
+    }
+    int64_t t2 = esp_timer_get_time();
+
+    int max_delta = 0;
+    for (size_t i = 0; i < n; i++) {
+        int d = jpg_bench_pixel_delta(legacy[i], swar[i]);
+        if (d > max_delta) {
+            max_delta = d;
+        }
+    }
+
+    const double total_px = (double)n * JPG_BENCH_ITERATIONS;
+    double legacy_ns = (double)(t1 - t0) * 1000.0 / total_px;
+    double swar_ns = (double)(t2 - t1) * 1000.0 / total_px;
+    ESP_LOGI(TAG, "legacy RGB888 path: %.1f ns/px (%u bytes/px work buffer)", legacy_ns, 3u);
+    ESP_LOGI(TAG, "SWAR RGB565 kernel: %.1f ns/px (%u bytes/px work buffer)", swar_ns, 2u);
+    ESP_LOGI(TAG, "speedup x%.2f, max channel delta %d LSB", swar_ns > 0 ? legacy_ns / swar_ns : 0.0, max_delta);
+
+cleanup:
+    heap_caps_free(y);
+    heap_caps_free(rgb);
+    heap_caps_free(legacy);
+    heap_caps_free(swar);
+}
+
+static void jpg_bench_ycc_to_rgb888(const uint8_t *y, const uint8_t *cb, const uint8_t *cr,
+                                    uint8_t *rgb, size_t count)
+{
+    const int CVACC = 1024;
+    for (size_t i = 0; i < count; i++) {
+        int yy = y[i];
+        int b = cb[i] - 128;
+        int r = cr[i] - 128;
+        int vb = yy + ((int)(1.772 * CVACC) * b) / CVACC;
+        int vg = yy - ((int)(0.344 * CVACC) * b + (int)(0.714 * CVACC) * r) / CVACC;
+        int vr = yy + ((int)(1.402 * CVACC) * r) / CVACC;
+        *rgb++ = (uint8_t)(vb < 0 ? 0 : (vb > 255 ? 255 : vb));
+        *rgb++ = (uint8_t)(vg < 0 ? 0 : (vg > 255 ? 255 : vg));
+        *rgb++ = (uint8_t)(vr < 0 ? 0 : (vr > 255 ? 255 : vr));
+    }
+}
+
+static void jpg_bench_rgb888_to_rgb565(const uint8_t *rgb, uint16_t *dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        uint8_t b = rgb[i * 3];
+        uint8_t g = rgb[i * 3 + 1];
+        uint8_t r = rgb[i * 3 + 2];
+        uint16_t c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+        dst[i] = (uint16_t)((c >> 8) | (c << 8));
+    }
+}
+
+static int jpg_bench_pixel_delta(uint16_t a, uint16_t b)
+{
+    a = (uint16_t)((a >> 8) | (a << 8));
+    b = (uint16_t)((b >> 8) | (b << 8));
+    int dr = abs((int)(a >> 11) - (int)(b >> 11));
+    int dg = abs((int)((a >> 5) & 0x3F) - (int)((b >> 5) & 0x3F));
+    int db = abs((int)(a & 0x1F) - (int)(b & 0x1F));
+    int d = dr > dg ? dr : dg;
+    return d > db ? d : db;
+}
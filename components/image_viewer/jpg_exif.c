@@ -0,0 +1,180 @@
+#include "jpg_exif.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define JPG_EXIF_MAX_IFD_ENTRIES    128u
+
+#define JPG_EXIF_TAG_ORIENTATION    0x0112
+#define JPG_EXIF_TAG_COMPRESSION    0x0103
+#define JPG_EXIF_TAG_THUMB_OFFSET   0x0201
+#define JPG_EXIF_TAG_THUMB_LENGTH   0x0202
+
+typedef struct {
+    lv_fs_file_t *file;
+    uint32_t tiff_base;     /* Absolute offset of the TIFF header */
+    uint32_t tiff_len;      /* Bytes of TIFF data inside the APP1 segment */
+    bool big_endian;
+} jpg_exif_tiff_t;
+
+/**
+ * @brief Read exactly @p len bytes at absolute offset @p off.
+ */
+static bool jpg_exif_read_at(lv_fs_file_t *file, uint32_t off, void *buf, uint32_t len);
+
+/**
+ * @brief Decode a 16-bit TIFF value honouring the byte order.
+ */
+static uint16_t jpg_exif_u16(const jpg_exif_tiff_t *t, const uint8_t *p);
+
+/**
+ * @brief Decode a 32-bit TIFF value honouring the byte order.
+ */
+static uint32_t jpg_exif_u32(const jpg_exif_tiff_t *t, const uint8_t *p);
+
+/**
+ * @brief Parse the TIFF structure of an APP1 Exif payload (IFD0 orientation, IFD1 thumbnail).
+ */
+static void jpg_exif_parse_tiff(jpg_exif_tiff_t *t, jpg_exif_info_t *info);
+
+esp_err_t jpg_exif_read(lv_fs_file_t *file, jpg_exif_info_t *info)
+{
+    if (!file || !info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(info, 0, sizeof(*info));
+    info->orientation = 1;
+
+    uint8_t hdr[4];
+    if (!jpg_exif_read_at(file, 0, hdr, 2) || hdr[0] != 0xFF || hdr[1] != 0xD8) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    uint32_t pos = 2;
+    for (;;) {
+        if (!jpg_exif_read_at(file, pos, hdr, 4) || hdr[0] != 0xFF) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        if (hdr[1] == 0xFF) {
+            pos++;                      /* Fill byte before the marker */
+            continue;
+        }
+        const uint8_t marker = hdr[1];
+        const uint32_t seg_len = ((uint32_t)hdr[2] << 8) | hdr[3];
+        if (marker == 0xD9 || marker == 0xDA || seg_len < 2) {
+            return ESP_ERR_NOT_SUPPORTED; /* Scan data before a frame header */
+        }
+
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            uint8_t sof[5];
+            if (!jpg_exif_read_at(file, pos + 4, sof, sizeof(sof))) {
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            info->height = (uint16_t)((sof[1] << 8) | sof[2]);
+            info->width = (uint16_t)((sof[3] << 8) | sof[4]);
+            return ESP_OK;
+        }
+
+        if (marker == 0xE1 && seg_len > 8 + 6) {
+            uint8_t id[6];
+            if (jpg_exif_read_at(file, pos + 4, id, sizeof(id)) && memcmp(id, "Exif\0\0", 6) == 0) {
+                jpg_exif_tiff_t t = {
+                    .file = file,
+                    .tiff_base = pos + 4 + 6,
+                    .tiff_len = seg_len - 2 - 6,
+                };
+                jpg_exif_parse_tiff(&t, info);
+            }
+        }
+
+        pos += 2 + seg_len;
+    }
+}
+
+static bool jpg_exif_read_at(lv_fs_file_t *file, uint32_t off, void *buf, uint32_t len)
+{
+    uint32_t br = 0;
+    if (lv_fs_seek(file, off, LV_FS_SEEK_SET) != LV_FS_RES_OK) {
+        return false;
+    }
+    return lv_fs_read(file, buf, len, &br) == LV_FS_RES_OK && br == len;
+}
+
+static uint16_t jpg_exif_u16(const jpg_exif_tiff_t *t, const uint8_t *p)
+{
+    return t->big_endian ? (uint16_t)((p[0] << 8) | p[1]) : (uint16_t)((p[1] << 8) | p[0]);
+}
+
+static uint32_t jpg_exif_u32(const jpg_exif_tiff_t *t, const uint8_t *p)
+{
+    return t->big_endian
+           ? ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]
+           : ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+}
+
+static void jpg_exif_parse_tiff(jpg_exif_tiff_t *t, jpg_exif_info_t *info)
+{
+    uint8_t th[8];
+    if (!jpg_exif_read_at(t->file, t->tiff_base, th, sizeof(th))) {
+        return;
+    }
+    if (th[0] == 'M' && th[1] == 'M') {
+        t->big_endian = true;
+    } else if (!(th[0] == 'I' && th[1] == 'I')) {
+        return;
+    }
+    if (jpg_exif_u16(t, th + 2) != 42) {
+        return;
+    }
+
+    uint32_t ifd = jpg_exif_u32(t, th + 4);
+    uint32_t thumb_off = 0;
+    uint32_t thumb_len = 0;
+    uint16_t compression = 6;
+
+    /* IFD0 holds the orientation, IFD1 (the next one) describes the thumbnail */
+    for (int index = 0; index < 2 && ifd && ifd + 2 <= t->tiff_len; index++) {
+        uint8_t cnt[2];
+        if (!jpg_exif_read_at(t->file, t->tiff_base + ifd, cnt, sizeof(cnt))) {
+            return;
+        }
+        uint32_t entries = jpg_exif_u16(t, cnt);
+        if (entries > JPG_EXIF_MAX_IFD_ENTRIES || ifd + 2 + entries * 12 + 4 > t->tiff_len) {
+            return;
+        }
+
+        for (uint32_t e = 0; e < entries; e++) {
+            uint8_t ent[12];
+            if (!jpg_exif_read_at(t->file, t->tiff_base + ifd + 2 + e * 12, ent, sizeof(ent))) {
+                return;
+            }
+            const uint16_t tag = jpg_exif_u16(t, ent);
+            const uint16_t type = jpg_exif_u16(t, ent + 2);
+            /* SHORT values sit in the first two bytes of the value field, LONG in all four */
+            const uint32_t value = (type == 3) ? jpg_exif_u16(t, ent + 8) : jpg_exif_u32(t, ent + 8);
+
+            if (index == 0 && tag == JPG_EXIF_TAG_ORIENTATION && value >= 1 && value <= 8) {
+                info->orientation = (uint8_t)value;
+            } else if (index == 1 && tag == JPG_EXIF_TAG_THUMB_OFFSET) {
+                thumb_off = value;
+            } else if (index == 1 && tag == JPG_EXIF_TAG_THUMB_LENGTH) {
+                thumb_len = value;
+            } else if (index == 1 && tag == JPG_EXIF_TAG_COMPRESSION) {
+                compression = (uint16_t)value;
+            }
+        }
+
+        uint8_t next[4];
+        if (!jpg_exif_read_at(t->file, t->tiff_base + ifd + 2 + entries * 12, next, sizeof(next))) {
+            return;
+        }
+        uint32_t next_ifd = jpg_exif_u32(t, next);
+        ifd = (next_ifd > ifd) ? next_ifd : 0;   /* Refuse loops */
+    }
+
+    /* Only JPEG-compressed thumbnails that lie fully inside the APP1 segment */
+    if (compression == 6 && thumb_len > 4 && thumb_off < t->tiff_len && thumb_len <= t->tiff_len - thumb_off) {
+        info->thumb_offset = t->tiff_base + thumb_off;
+        info->thumb_len = thumb_len;
+    }
+}
@@ -0,0 +1,209 @@
+#include "jpg_prefetch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "bsp/esp-bsp.h"
+#include "sdkconfig.h"
+#include "jpg.h"
+#include "jpg_cache.h"
+
+#define TAG "jpg_prefetch"
+
+#define JPG_PREFETCH_MAX_PATH           256
+#define JPG_PREFETCH_TASK_STACK         (10 * 1024)    /* tjpgd keeps its 4 KB work buffer on the stack */
+#define JPG_PREFETCH_TASK_PRIO          (1)            /* Below the LVGL task: prefetch only uses idle time */
+#define JPG_PREFETCH_INTERNAL_RESERVE   ((size_t)CONFIG_JPG_PREFETCH_INTERNAL_RESERVE_KB * 1024u)
+
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t lock;             /* Held by the worker for a whole decode; guards the fields below */
+    SemaphoreHandle_t exited;           /* Given by the worker right before it deletes itself */
+    jpg_frame_t frame;
+    char want[JPG_PREFETCH_MAX_PATH];   /* Pending request, empty if none */
+    char path[JPG_PREFETCH_MAX_PATH];   /* Image held in (or being decoded into) the frame */
+    bool ready;                         /* Frame holds @c path completely */
+    volatile bool busy;                 /* Worker is decoding @c path right now */
+    volatile bool cancel;               /* Polled by the decoder */
+    volatile bool quit;
+} jpg_prefetch_ctx_t;
+
+static jpg_prefetch_ctx_t s_prefetch;
+
+/**
+ * @brief Allocate the panel-sized frame, preferring PSRAM over internal RAM.
+ *
+ * Internal RAM is only used when at least CONFIG_JPG_PREFETCH_INTERNAL_RESERVE_KB
+ * would remain free for the on-demand decoders and the rest of the UI.
+ *
+ * @param bytes Frame size in bytes.
+ *
+ * @return The frame buffer, or NULL if neither heap can spare it.
+ */
+static uint16_t *jpg_prefetch_alloc_frame(size_t bytes);
+
+/**
+ * @brief Worker task: decode each requested image into the frame until told to quit.
+ *
+ * @param arg Unused.
+ */
+static void jpg_prefetch_task(void *arg);
+
+esp_err_t jpg_prefetch_start(void)
+{
+    jpg_prefetch_ctx_t *ctx = &s_prefetch;
+    if (ctx->task) {
+        return ESP_OK;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->frame.cap = (size_t)BSP_LCD_H_RES * BSP_LCD_V_RES;
+    ctx->frame.pixels = jpg_prefetch_alloc_frame(ctx->frame.cap * sizeof(uint16_t));
+    ctx->lock = xSemaphoreCreateMutex();
+    ctx->exited = xSemaphoreCreateBinary();
+    if (!ctx->frame.pixels || !ctx->lock || !ctx->exited) {
+        goto fail;
+    }
+
+    if (xTaskCreate(jpg_prefetch_task, "jpg_prefetch", JPG_PREFETCH_TASK_STACK,
+                    ctx, JPG_PREFETCH_TASK_PRIO, &ctx->task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start the prefetch task");
+        ctx->task = NULL;
+        goto fail;
+    }
+    return ESP_OK;
+
+fail:
+    free(ctx->frame.pixels);
+    if (ctx->lock) {
+        vSemaphoreDelete(ctx->lock);
+    }
+    if (ctx->exited) {
+        vSemaphoreDelete(ctx->exited);
+    }
+    memset(ctx, 0, sizeof(*ctx));
+    return ESP_ERR_NO_MEM;
+}
+
+void jpg_prefetch_stop(void)
+{
+    jpg_prefetch_ctx_t *ctx = &s_prefetch;
+    if (!ctx->task) {
+        return;
+    }
+
+    ctx->cancel = true;
+    ctx->quit = true;
+    xTaskNotifyGive(ctx->task);
+    xSemaphoreTake(ctx->exited, portMAX_DELAY);
+
+    free(ctx->frame.pixels);
+    vSemaphoreDelete(ctx->lock);
+    vSemaphoreDelete(ctx->exited);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void jpg_prefetch_request(const char *path)
+{
+    jpg_prefetch_ctx_t *ctx = &s_prefetch;
+    if (!ctx->task || !path) {
+        return;
+    }
+
+    ctx->cancel = true;
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    ctx->cancel = false;
+    if (ctx->ready && strcmp(ctx->path, path) == 0) {
+        /* Already decoded (e.g. swiping back and forth between two images) */
+        ctx->want[0] = '\0';
+        xSemaphoreGive(ctx->lock);
+        return;
+    }
+    strlcpy(ctx->want, path, sizeof(ctx->want));
+    ctx->ready = false;
+    xSemaphoreGive(ctx->lock);
+    xTaskNotifyGive(ctx->task);
+}
+
+bool jpg_prefetch_show(const char *path)
+{
+    jpg_prefetch_ctx_t *ctx = &s_prefetch;
+    if (!ctx->task || !path) {
+        return false;
+    }
+
+    /* A decode of the wanted image is cheaper to finish than to restart cold */
+    if (!(ctx->busy && strcmp(ctx->path, path) == 0)) {
+        ctx->cancel = true;
+    }
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    ctx->cancel = false;
+    ctx->want[0] = '\0';
+
+    bool hit = ctx->ready && strcmp(ctx->path, path) == 0;
+    if (hit) {
+        int64_t t0 = esp_timer_get_time();
+        hit = jpg_frame_blit(&ctx->frame) == ESP_OK;
+        ESP_LOGD(TAG, "Blitted prefetched %ux%u frame in %lld us",
+                 ctx->frame.w, ctx->frame.h, (long long)(esp_timer_get_time() - t0));
+#if CONFIG_JPG_VIEWER_CACHE
+        /* The frame is reused for the next prefetch; keep a copy for going back */
+        jpg_cache_put(path, &ctx->frame);
+#endif
+    }
+    xSemaphoreGive(ctx->lock);
+    return hit;
+}
+
+static uint16_t *jpg_prefetch_alloc_frame(size_t bytes)
+{
+#if CONFIG_SPIRAM
+    uint16_t *frame = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (frame) {
+        return frame;
+    }
+#endif
+    const uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    if (heap_caps_get_free_size(caps) < bytes + JPG_PREFETCH_INTERNAL_RESERVE ||
+        heap_caps_get_largest_free_block(caps) < bytes) {
+        ESP_LOGI(TAG, "Not enough spare RAM for a %u B prefetch frame, decoding on demand", (unsigned)bytes);
+        return NULL;
+    }
+    return heap_caps_malloc(bytes, caps);
+}
+
+static void jpg_prefetch_task(void *arg)
+{
+    jpg_prefetch_ctx_t *ctx = (jpg_prefetch_ctx_t *)arg;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (ctx->quit) {
+            break;
+        }
+
+        xSemaphoreTake(ctx->lock, portMAX_DELAY);
+        if (ctx->want[0] != '\0') {
+            strlcpy(ctx->path, ctx->want, sizeof(ctx->path));
+            ctx->want[0] = '\0';
+            ctx->busy = true;
+
+            int64_t t0 = esp_timer_get_time();
+            esp_err_t err = jpg_frame_render(ctx->path, &ctx->frame, &ctx->cancel);
+            ctx->busy = false;
+            ctx->ready = (err == ESP_OK);
+            ESP_LOGD(TAG, "Prefetch of %s: %s after %lld us", ctx->path, esp_err_to_name(err),
+                     (long long)(esp_timer_get_time() - t0));
+        }
+        xSemaphoreGive(ctx->lock);
+    }
+
+    xSemaphoreGive(ctx->exited);
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,1010 @@
+#include "jpg_progressive.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "jpg_color.h"
+
+#define TAG "jpg_progressive"
+
+#define JPG_PROG_INBUF          1024u
+#define JPG_PROG_MAX_COMP       3u
+
+#define JPG_PROG_COEF_BUDGET    ((size_t)CONFIG_JPG_PROGRESSIVE_COEF_BUDGET_KB * 1024u)
+#if CONFIG_JPG_PROGRESSIVE_PSRAM
+#define JPG_PROG_PSRAM_BUDGET   ((size_t)CONFIG_JPG_PROGRESSIVE_PSRAM_BUDGET_KB * 1024u)
+#endif
+
+/* Markers */
+#define M_SOF0  0xC0
+#define M_SOF2  0xC2
+#define M_DHT   0xC4
+#define M_RST0  0xD0
+#define M_SOI   0xD8
+#define M_EOI   0xD9
+#define M_SOS   0xDA
+#define M_DQT   0xDB
+#define M_DRI   0xDD
+
+/** Bit-reader / marker state: no pending marker, or end of input. */
+#define JPG_PROG_NO_MARKER      0
+#define JPG_PROG_EOF_MARKER     (-1)
+
+typedef struct {
+    uint8_t look_len[256];          /* 8-bit lookahead: code length, 0 = slow path */
+    uint8_t look_sym[256];
+    int32_t maxcode[17];
+    int32_t mincode[17];
+    uint16_t valptr[17];
+    uint8_t huffval[256];
+    bool defined;
+} jpg_prog_huff_t;
+
+typedef struct {
+    uint8_t id;
+    uint8_t h;                      /* Sampling factors */
+    uint8_t v;
+    uint8_t tq;                     /* Quantization table */
+    uint8_t td;                     /* DC / AC tables of the current scan */
+    uint8_t ta;
+    uint32_t bw;                    /* Blocks per row, padded to whole MCUs (store stride) */
+    uint32_t bh;
+    uint32_t bw_real;               /* Blocks actually covering the component */
+    uint32_t bh_real;
+    int16_t *coef;                  /* bw * bh * kept coefficients, natural n x n order */
+    uint64_t *nz;                   /* Nonzero map of discarded coefficients (zigzag bits) */
+    int dc_pred;
+} jpg_prog_comp_t;
+
+typedef struct {
+    lv_fs_file_t *file;
+    const volatile bool *cancel;    /* Abort flag from the request, polled per MCU row */
+    uint8_t in[JPG_PROG_INBUF];
+    uint32_t in_pos;
+    uint32_t in_len;
+
+    uint32_t bits;                  /* MSB-aligned bit accumulator */
+    int nbits;
+    int marker;                     /* Marker hit by the bit reader */
+
+    uint16_t qt[4][64];             /* Zigzag order, as stored in the file */
+    jpg_prog_huff_t dc[4];
+    jpg_prog_huff_t ac[4];
+
+    uint32_t width;
+    uint32_t height;
+    uint8_t ncomp;
+    uint8_t hmax;
+    uint8_t vmax;
+    jpg_prog_comp_t comp[JPG_PROG_MAX_COMP];
+    uint32_t mcux;
+    uint32_t mcuy;
+    uint16_t restart_interval;
+    uint32_t eobrun;
+
+    unsigned scale;                 /* Output is 1/2^scale of the source */
+    unsigned n;                     /* Output samples per block edge (8 >> scale) */
+    unsigned kept;                  /* n * n */
+    int8_t keep[64];                /* Zigzag index -> kept index, -1 if discarded */
+    uint8_t keep_zz[64];            /* Kept index -> zigzag index */
+    void *store;                    /* Single allocation backing coef/nz of all components */
+    bool frame_ready;
+    bool any_scan;
+} jpg_prog_dec_t;
+
+/* Zigzag index -> natural (row * 8 + col) index */
+static const uint8_t s_zigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+/**
+ * @brief Return the next input byte, refilling from the file; -1 at end of input.
+ */
+static int jpg_prog_byte(jpg_prog_dec_t *d);
+
+/**
+ * @brief Read a big-endian 16-bit value from the marker segment stream; -1 at end of input.
+ */
+static int jpg_prog_word(jpg_prog_dec_t *d);
+
+/**
+ * @brief Discard @p len bytes of a marker segment.
+ */
+static bool jpg_prog_skip(jpg_prog_dec_t *d, uint32_t len);
+
+/**
+ * @brief Return the next marker code, honouring a marker already hit by the bit reader.
+ *
+ * @return Marker code (0x01..0xFE) or JPG_PROG_EOF_MARKER.
+ */
+static int jpg_prog_next_marker(jpg_prog_dec_t *d);
+
+/**
+ * @brief Top up the bit accumulator; feeds zeros once a marker or end of input is reached.
+ */
+static void jpg_prog_fill(jpg_prog_dec_t *d);
+
+/**
+ * @brief Consume @p n (0..16) bits and return them as an unsigned value.
+ */
+static inline uint32_t jpg_prog_bits(jpg_prog_dec_t *d, int n);
+
+/**
+ * @brief Decode one Huffman symbol; -1 on an invalid code.
+ */
+static int jpg_prog_huff_decode(jpg_prog_dec_t *d, const jpg_prog_huff_t *h);
+
+/**
+ * @brief Parse a DQT segment.
+ */
+static esp_err_t jpg_prog_parse_dqt(jpg_prog_dec_t *d);
+
+/**
+ * @brief Parse a DHT segment and build the decode tables.
+ */
+static esp_err_t jpg_prog_parse_dht(jpg_prog_dec_t *d);
+
+/**
+ * @brief Parse SOF2, pick the output scale and allocate the coefficient store.
+ */
+static esp_err_t jpg_prog_parse_sof(jpg_prog_dec_t *d, const img_stream_cfg_t *cfg);
+
+/**
+ * @brief Parse an SOS header and decode (or skip) the scan that follows it.
+ */
+static esp_err_t jpg_prog_parse_scan(jpg_prog_dec_t *d);
+
+/**
+ * @brief Handle the restart marker expected after @c restart_interval MCUs.
+ */
+static void jpg_prog_restart(jpg_prog_dec_t *d, unsigned ns, jpg_prog_comp_t **sc);
+
+/**
+ * @brief Decode one block of a scan, dispatching on the spectral / approximation parameters.
+ *
+ * @return false on corrupt data.
+ */
+static bool jpg_prog_decode_block(jpg_prog_dec_t *d, jpg_prog_comp_t *c, uint32_t blk,
+                                  unsigned ss, unsigned se, unsigned ah, unsigned al);
+
+/**
+ * @brief IDCT every block of an MCU row and stream the converted rows to the sink.
+ */
+static esp_err_t jpg_prog_output(jpg_prog_dec_t *d, const img_stream_cfg_t *cfg);
+
+static inline int jpg_prog_extend(uint32_t v, int s)
+{
+    return (v < (1u << (s - 1))) ? (int)v - (1 << s) + 1 : (int)v;
+}
+
+static inline uint8_t jpg_prog_clip8(int v)
+{
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+esp_err_t jpg_progressive_draw(const img_stream_cfg_t *cfg)
+{
+    if (!cfg || !cfg->file || !cfg->draw || !cfg->max_w || !cfg->max_h) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    jpg_prog_dec_t *d = heap_caps_calloc(1, sizeof(*d), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!d) {
+        return ESP_ERR_NO_MEM;
+    }
+    d->file = cfg->file;
+    d->cancel = cfg->cancel;
+
+    esp_err_t err = ESP_OK;
+    if (lv_fs_seek(cfg->file, 0, LV_FS_SEEK_SET) != LV_FS_RES_OK ||
+        jpg_prog_byte(d) != 0xFF || jpg_prog_byte(d) != M_SOI) {
+        err = ESP_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    for (;;) {
+        int m = jpg_prog_next_marker(d);
+        if (m == JPG_PROG_EOF_MARKER || m == M_EOI) {
+            if (!d->any_scan) {
+                ESP_LOGE(TAG, "No complete scan found");
+                err = ESP_ERR_NOT_SUPPORTED;
+            } else if (m != M_EOI) {
+                ESP_LOGW(TAG, "Truncated file, rendering the scans that were read");
+            }
+            break;
+        }
+
+        switch (m) {
+            case M_DQT:
+                err = jpg_prog_parse_dqt(d);
+                break;
+            case M_DHT:
+                err = jpg_prog_parse_dht(d);
+                break;
+            case M_DRI: {
+                int len = jpg_prog_word(d);
+                int ri = jpg_prog_word(d);
+                if (len != 4 || ri < 0) {
+                    err = ESP_ERR_NOT_SUPPORTED;
+                }
+                d->restart_interval = (uint16_t)ri;
+                break;
+            }
+            case M_SOF2:
+                err = jpg_prog_parse_sof(d, cfg);
+                break;
+            case M_SOS:
+                err = d->frame_ready ? jpg_prog_parse_scan(d) : ESP_ERR_NOT_SUPPORTED;
+                break;
+            default:
+                if ((m >= M_SOF0 && m <= 0xCF && m != M_DHT && m != 0xC8 && m != 0xCC)) {
+                    /* Any other SOFn: baseline is tjpgd's job, the rest is unsupported */
+                    err = ESP_ERR_NOT_SUPPORTED;
+                } else if (m >= M_RST0 && m <= M_RST0 + 7) {
+                    /* Stray restart marker between segments: no payload */
+                } else {
+                    int len = jpg_prog_word(d);
+                    if (len < 2 || !jpg_prog_skip(d, (uint32_t)len - 2u)) {
+                        err = ESP_ERR_NOT_SUPPORTED;
+                    }
+                }
+                break;
+        }
+        if (err != ESP_OK) {
+            goto cleanup;
+        }
+    }
+
+    if (err == ESP_OK) {
+        err = jpg_prog_output(d, cfg);
+    }
+
+cleanup:
+    heap_caps_free(d->store);
+    heap_caps_free(d);
+    return err;
+}
+
+static int jpg_prog_byte(jpg_prog_dec_t *d)
+{
+    if (d->in_pos >= d->in_len) {
+        uint32_t br = 0;
+        if (lv_fs_read(d->file, d->in, sizeof(d->in), &br) != LV_FS_RES_OK || br == 0) {
+            return -1;
+        }
+        d->in_len = br;
+        d->in_pos = 0;
+    }
+    return d->in[d->in_pos++];
+}
+
+static int jpg_prog_word(jpg_prog_dec_t *d)
+{
+    int hi = jpg_prog_byte(d);
+    int lo = jpg_prog_byte(d);
+    return (hi < 0 || lo < 0) ? -1 : ((hi << 8) | lo);
+}
+
+static bool jpg_prog_skip(jpg_prog_dec_t *d, uint32_t len)
+{
+    uint32_t buffered = d->in_len - d->in_pos;
+    if (len <= buffered) {
+        d->in_pos += len;
+        return true;
+    }
+    d->in_pos = d->in_len;
+    return lv_fs_seek(d->file, len - buffered, LV_FS_SEEK_CUR) == LV_FS_RES_OK;
+}
+
+static int jpg_prog_next_marker(jpg_prog_dec_t *d)
+{
+    if (d->marker != JPG_PROG_NO_MARKER) {
+        int m = d->marker;
+        d->marker = JPG_PROG_NO_MARKER;
+        return m;
+    }
+
+    /* Skip leftover entropy-coded bytes until 0xFF followed by a non-zero code */
+    for (;;) {
+        int b = jpg_prog_byte(d);
+        if (b < 0) {
+            return JPG_PROG_EOF_MARKER;
+        }
+        if (b != 0xFF) {
+            continue;
+        }
+        do {
+            b = jpg_prog_byte(d);
+        } while (b == 0xFF);
+        if (b < 0) {
+            return JPG_PROG_EOF_MARKER;
+        }
+        if (b != 0x00) {
+            return b;
+        }
+    }
+}
+
+static void jpg_prog_fill(jpg_prog_dec_t *d)
+{
+    while (d->nbits <= 24) {
+        int b = 0;
+        if (d->marker == JPG_PROG_NO_MARKER) {
+            b = jpg_prog_byte(d);
+            if (b < 0) {
+                d->marker = JPG_PROG_EOF_MARKER;
+                b = 0;
+            } else if (b == 0xFF) {
+                int b2;
+                do {
+                    b2 = jpg_prog_byte(d);
+                } while (b2 == 0xFF);
+                if (b2 != 0x00) {
+                    d->marker = (b2 < 0) ? JPG_PROG_EOF_MARKER : b2;
+                    b = 0;
+                }
+            }
+        }
+        d->bits |= (uint32_t)b << (24 - d->nbits);
+        d->nbits += 8;
+    }
+}
+
+static inline uint32_t jpg_prog_bits(jpg_prog_dec_t *d, int n)
+{
+    if (n == 0) {
+        return 0;
+    }
+    if (d->nbits < n) {
+        jpg_prog_fill(d);
+    }
+    uint32_t v = d->bits >> (32 - n);
+    d->bits <<= n;
+    d->nbits -= n;
+    return v;
+}
+
+static int jpg_prog_huff_decode(jpg_prog_dec_t *d, const jpg_prog_huff_t *h)
+{
+    if (d->nbits < 16) {
+        jpg_prog_fill(d);
+    }
+
+    unsigned peek = d->bits >> 24;
+    if (h->look_len[peek]) {
+        unsigned len = h->look_len[peek];
+        d->bits <<= len;
+        d->nbits -= (int)len;
+        return h->look_sym[peek];
+    }
+
+    for (int l = 9; l <= 16; l++) {
+        int32_t code = (int32_t)(d->bits >> (32 - l));
+        if (code <= h->maxcode[l]) {
+            d->bits <<= l;
+            d->nbits -= l;
+            return h->huffval[h->valptr[l] + code - h->mincode[l]];
+        }
+    }
+    return -1;
+}
+
+static esp_err_t jpg_prog_parse_dqt(jpg_prog_dec_t *d)
+{
+    int len = jpg_prog_word(d);
+    if (len < 2) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    len -= 2;
+    while (len > 0) {
+        int pq_tq = jpg_prog_byte(d);
+        if (pq_tq < 0 || (pq_tq & 0x0F) > 3) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        bool wide = (pq_tq >> 4) != 0;
+        uint16_t *q = d->qt[pq_tq & 0x0F];
+        for (int i = 0; i < 64; i++) {
+            int v = wide ? jpg_prog_word(d) : jpg_prog_byte(d);
+            if (v < 0) {
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            q[i] = (uint16_t)v;
+        }
+        len -= 1 + (wide ? 128 : 64);
+    }
+    return len == 0 ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+}
+
+static esp_err_t jpg_prog_parse_dht(jpg_prog_dec_t *d)
+{
+    int len = jpg_prog_word(d);
+    if (len < 2) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    len -= 2;
+    while (len > 0) {
+        int tc_th = jpg_prog_byte(d);
+        if (tc_th < 0 || (tc_th & 0x0F) > 3 || (tc_th >> 4) > 1) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        jpg_prog_huff_t *h = (tc_th >> 4) ? &d->ac[tc_th & 0x0F] : &d->dc[tc_th & 0x0F];
+
+        uint8_t counts[17] = {0};
+        unsigned total = 0;
+        for (int l = 1; l <= 16; l++) {
+            int c = jpg_prog_byte(d);
+            if (c < 0) {
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            counts[l] = (uint8_t)c;
+            total += (unsigned)c;
+        }
+        if (total > 256) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        for (unsigned i = 0; i < total; i++) {
+            int v = jpg_prog_byte(d);
+            if (v < 0) {
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            h->huffval[i] = (uint8_t)v;
+        }
+
+        /* Canonical code assignment (ITU T.81 Annex C / F.2.2.3) */
+        memset(h->look_len, 0, sizeof(h->look_len));
+        int32_t code = 0;
+        unsigned k = 0;
+        for (int l = 1; l <= 16; l++) {
+            h->valptr[l] = (uint16_t)k;
+            h->mincode[l] = code;
+            if (code + counts[l] > (1 << l)) {
+                return ESP_ERR_NOT_SUPPORTED; /* Over-subscribed code lengths */
+            }
+            for (unsigned i = 0; i < counts[l]; i++, k++, code++) {
+                if (l <= 8) {
+                    unsigned first = (unsigned)code << (8 - l);
+                    unsigned span = 1u << (8 - l);
+                    for (unsigned j = 0; j < span; j++) {
+                        h->look_len[first + j] = (uint8_t)l;
+                        h->look_sym[first + j] = h->huffval[k];
+                    }
+                }
+            }
+            h->maxcode[l] = counts[l] ? code - 1 : -1;
+            code <<= 1;
+        }
+        h->defined = true;
+        len -= 17 + (int)total;
+    }
+    return len == 0 ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+}
+
+static esp_err_t jpg_prog_parse_sof(jpg_prog_dec_t *d, const img_stream_cfg_t *cfg)
+{
+    int len = jpg_prog_word(d);
+    int precision = jpg_prog_byte(d);
+    int height = jpg_prog_word(d);
+    int width = jpg_prog_word(d);
+    int ncomp = jpg_prog_byte(d);
+    if (d->frame_ready || precision != 8 || height <= 0 || width <= 0 ||
+        (ncomp != 1 && ncomp != 3) || len != 8 + 3 * ncomp) {
+        ESP_LOGE(TAG, "Unsupported frame header");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    d->width = (uint32_t)width;
+    d->height = (uint32_t)height;
+    d->ncomp = (uint8_t)ncomp;
+    d->hmax = 1;
+    d->vmax = 1;
+    for (int i = 0; i < ncomp; i++) {
+        jpg_prog_comp_t *c = &d->comp[i];
+        int id = jpg_prog_byte(d);
+        int hv = jpg_prog_byte(d);
+        int tq = jpg_prog_byte(d);
+        if (id < 0 || hv < 0 || tq < 0 || tq > 3) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        c->id = (uint8_t)id;
+        c->h = (uint8_t)(hv >> 4);
+        c->v = (uint8_t)(hv & 0x0F);
+        c->tq = (uint8_t)tq;
+        if (ncomp == 1) {
+            c->h = c->v = 1; /* A single component is always coded one block per MCU */
+        }
+        /* Same subset as tjpgd: luma 1x1 / 2x1 / 1x2 / 2x2, chroma 1x1 */
+        if (c->h < 1 || c->h > 2 || c->v < 1 || c->v > 2 || (i > 0 && (c->h != 1 || c->v != 1))) {
+            ESP_LOGE(TAG, "Unsupported sampling factors 0x%02x", hv);
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        if (c->h > d->hmax) {
+            d->hmax = c->h;
+        }
+        if (c->v > d->vmax) {
+            d->vmax = c->v;
+        }
+    }
+
+    d->mcux = (d->width + 8u * d->hmax - 1u) / (8u * d->hmax);
+    d->mcuy = (d->height + 8u * d->vmax - 1u) / (8u * d->vmax);
+    size_t blocks = 0;
+    for (int i = 0; i < ncomp; i++) {
+        jpg_prog_comp_t *c = &d->comp[i];
+        c->bw = d->mcux * c->h;
+        c->bh = d->mcuy * c->v;
+        c->bw_real = ((d->width * c->h + d->hmax - 1u) / d->hmax + 7u) / 8u;
+        c->bh_real = ((d->height * c->v + d->vmax - 1u) / d->vmax + 7u) / 8u;
+        blocks += (size_t)c->bw * c->bh;
+    }
+
+    /* Smallest downscale that fits the panel, same rule as the baseline path */
+    unsigned fit = 0;
+    while (fit < 3 && (((d->width + (1u << fit) - 1u) >> fit) > cfg->max_w ||
+                       ((d->height + (1u << fit) - 1u) >> fit) > cfg->max_h)) {
+        fit++;
+    }
+    if (((d->width + (1u << fit) - 1u) >> fit) > cfg->max_w ||
+        ((d->height + (1u << fit) - 1u) >> fit) > cfg->max_h) {
+        ESP_LOGE(TAG, "Image %lux%lu is too large to fit %ux%u even at 1/8 scale",
+                 (unsigned long)d->width, (unsigned long)d->height, cfg->max_w, cfg->max_h);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    /* Walk towards coarser scales until the coefficient store fits a budget */
+    for (unsigned s = fit; s <= 3 && !d->store; s++) {
+        const unsigned n = 8u >> s;
+        const bool need_nz = (s == 1 || s == 2);    /* 1:1 keeps all, 1/8 skips AC scans */
+        const size_t nz_bytes = need_nz ? blocks * sizeof(uint64_t) : 0;
+        const size_t bytes = nz_bytes + blocks * n * n * sizeof(int16_t);
+
+        if (bytes <= JPG_PROG_COEF_BUDGET) {
+            d->store = heap_caps_calloc(1, bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        }
+#if CONFIG_JPG_PROGRESSIVE_PSRAM
+        if (!d->store && bytes <= JPG_PROG_PSRAM_BUDGET) {
+            d->store = heap_caps_calloc(1, bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        }
+#endif
+        if (!d->store) {
+            ESP_LOGD(TAG, "Coefficient store for 1/%u scale (%u bytes) does not fit", 1u << s, (unsigned)bytes);
+            continue;
+        }
+
+        d->scale = s;
+        d->n = n;
+        d->kept = n * n;
+        uint64_t *nz = need_nz ? d->store : NULL;
+        int16_t *coef = (int16_t *)((uint8_t *)d->store + nz_bytes);
+        for (int i = 0; i < ncomp; i++) {
+            jpg_prog_comp_t *c = &d->comp[i];
+            const size_t cb = (size_t)c->bw * c->bh;
+            c->nz = nz;
+            c->coef = coef;
+            if (nz) {
+                nz += cb;
+            }
+            coef += cb * d->kept;
+        }
+        if (s != fit) {
+            ESP_LOGW(TAG, "Rendering at 1/%u instead of 1/%u to stay within the coefficient budget",
+                     1u << s, 1u << fit);
+        }
+        ESP_LOGD(TAG, "Progressive %lux%lu, %u comps, 1/%u scale, %u-byte coefficient store",
+                 (unsigned long)d->width, (unsigned long)d->height, ncomp, 1u << s, (unsigned)bytes);
+    }
+    if (!d->store) {
+        ESP_LOGE(TAG, "Progressive image %lux%lu needs more coefficient memory than allowed",
+                 (unsigned long)d->width, (unsigned long)d->height);
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (unsigned zz = 0; zz < 64; zz++) {
+        unsigned row = s_zigzag[zz] >> 3;
+        unsigned col = s_zigzag[zz] & 7u;
+        d->keep[zz] = -1;
+        if (row < d->n && col < d->n) {
+            d->keep[zz] = (int8_t)(row * d->n + col);
+            d->keep_zz[row * d->n + col] = (uint8_t)zz;
+        }
+    }
+
+    d->frame_ready = true;
+    return ESP_OK;
+}
+
+static esp_err_t jpg_prog_parse_scan(jpg_prog_dec_t *d)
+{
+    int len = jpg_prog_word(d);
+    int ns = jpg_prog_byte(d);
+    if (ns < 1 || ns > d->ncomp || len != 6 + 2 * ns) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    jpg_prog_comp_t *sc[JPG_PROG_MAX_COMP] = {0};
+    for (int i = 0; i < ns; i++) {
+        int id = jpg_prog_byte(d);
+        int tables = jpg_prog_byte(d);
+        for (int c = 0; c < d->ncomp; c++) {
+            if (d->comp[c].id == id) {
+                sc[i] = &d->comp[c];
+            }
+        }
+        if (!sc[i] || tables < 0 || (tables >> 4) > 3 || (tables & 0x0F) > 3) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        sc[i]->td = (uint8_t)(tables >> 4);
+        sc[i]->ta = (uint8_t)(tables & 0x0F);
+    }
+    int ss = jpg_prog_byte(d);
+    int se = jpg_prog_byte(d);
+    int a = jpg_prog_byte(d);
+    if (ss < 0 || se < ss || se > 63 || a < 0 || (ss == 0 && se != 0) || (ss > 0 && ns != 1)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    const unsigned ah = (unsigned)a >> 4;
+    const unsigned al = (unsigned)a & 0x0F;
+
+    d->bits = 0;
+    d->nbits = 0;
+    d->marker = JPG_PROG_NO_MARKER;
+    d->eobrun = 0;
+    for (int i = 0; i < ns; i++) {
+        sc[i]->dc_pred = 0;
+        const jpg_prog_huff_t *h = (ss == 0) ? &d->dc[sc[i]->td] : &d->ac[sc[i]->ta];
+        if (!h->defined && !(ss == 0 && ah != 0)) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    }
+
+    /* At 1/8 only DC survives, so AC scans are skipped without entropy decoding */
+    if (ss > 0 && d->scale == 3) {
+        d->any_scan = true;
+        return ESP_OK;
+    }
+
+    uint32_t todo = d->restart_interval;
+    if (ns == 1) {
+        jpg_prog_comp_t *c = sc[0];
+        for (uint32_t by = 0; by < c->bh_real; by++) {
+            if (d->cancel && *d->cancel) {
+                return ESP_FAIL;
+            }
+            for (uint32_t bx = 0; bx < c->bw_real; bx++) {
+                if (d->restart_interval) {
+                    if (todo == 0) {
+                        jpg_prog_restart(d, 1, sc);
+                        todo = d->restart_interval;
+                    }
+                    todo--;
+                }
+                if (!jpg_prog_decode_block(d, c, by * c->bw + bx, (unsigned)ss, (unsigned)se, ah, al)) {
+                    return ESP_ERR_INVALID_RESPONSE;
+                }
+            }
+        }
+    } else {
+        for (uint32_t my = 0; my < d->mcuy; my++) {
+            if (d->cancel && *d->cancel) {
+                return ESP_FAIL;
+            }
+            for (uint32_t mx = 0; mx < d->mcux; mx++) {
+                if (d->restart_interval) {
+                    if (todo == 0) {
+                        jpg_prog_restart(d, (unsigned)ns, sc);
+                        todo = d->restart_interval;
+                    }
+                    todo--;
+                }
+                for (int i = 0; i < ns; i++) {
+                    jpg_prog_comp_t *c = sc[i];
+                    for (uint32_t v = 0; v < c->v; v++) {
+                        for (uint32_t h = 0; h < c->h; h++) {
+                            uint32_t blk = (my * c->v + v) * c->bw + mx * c->h + h;
+                            if (!jpg_prog_decode_block(d, c, blk, 0, 0, ah, al)) {
+                                return ESP_ERR_INVALID_RESPONSE;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    d->any_scan = true;
+    return ESP_OK;
+}
+
+static void jpg_prog_restart(jpg_prog_dec_t *d, unsigned ns, jpg_prog_comp_t **sc)
+{
+    d->bits = 0;
+    d->nbits = 0;
+    if (d->marker == JPG_PROG_NO_MARKER) {
+        d->marker = jpg_prog_next_marker(d);
+    }
+    if (d->marker >= M_RST0 && d->marker <= M_RST0 + 7) {
+        d->marker = JPG_PROG_NO_MARKER;
+    }
+    /* Any other marker leaves the reader feeding zeros until the scan ends */
+    d->eobrun = 0;
+    for (unsigned i = 0; i < ns; i++) {
+        sc[i]->dc_pred = 0;
+    }
+}
+
+static bool jpg_prog_decode_block(jpg_prog_dec_t *d, jpg_prog_comp_t *c, uint32_t blk,
+                                  unsigned ss, unsigned se, unsigned ah, unsigned al)
+{
+    int16_t *coef = c->coef + (size_t)blk * d->kept;
+    uint64_t *nz = c->nz ? &c->nz[blk] : NULL;
+
+    if (ss == 0) {
+        if (ah == 0) {
+            int t = jpg_prog_huff_decode(d, &d->dc[c->td]);
+            if (t < 0 || t > 16) {
+                return false;
+            }
+            int diff = t ? jpg_prog_extend(jpg_prog_bits(d, t), t) : 0;
+            c->dc_pred += diff;
+            coef[0] = (int16_t)(c->dc_pred * (1 << al));
+        } else if (jpg_prog_bits(d, 1)) {
+            coef[0] |= (int16_t)(1 << al);
+        }
+        return true;
+    }
+
+    const jpg_prog_huff_t *hac = &d->ac[c->ta];
+
+    if (ah == 0) {
+        /* AC first pass */
+        if (d->eobrun) {
+            d->eobrun--;
+            return true;
+        }
+        for (unsigned k = ss; k <= se;) {
+            int rs = jpg_prog_huff_decode(d, hac);
+            if (rs < 0) {
+                return false;
+            }
+            unsigned r = (unsigned)rs >> 4;
+            int s = rs & 15;
+            if (s == 0) {
+                if (r < 15) {
+                    d->eobrun = (1u << r) - 1u;
+                    if (r) {
+                        d->eobrun += jpg_prog_bits(d, (int)r);
+                    }
+                    break;
+                }
+                k += 16;
+                continue;
+            }
+            k += r;
+            if (k > 63) {
+                return false;
+            }
+            int val = jpg_prog_extend(jpg_prog_bits(d, s), s) * (1 << al);
+            int idx = d->keep[k];
+            if (idx >= 0) {
+                coef[idx] = (int16_t)val;
+            } else if (nz) {
+                *nz |= 1ull << k;
+            }
+            k++;
+        }
+        return true;
+    }
+
+    /* AC refinement pass (successive approximation, T.81 G.1.2.3) */
+    const int p1 = 1 << al;
+    unsigned k = ss;
+
+    if (d->eobrun == 0) {
+        while (k <= se) {
+            int rs = jpg_prog_huff_decode(d, hac);
+            if (rs < 0) {
+                return false;
+            }
+            int r = rs >> 4;
+            int s = rs & 15;
+            int val = 0;
+            if (s == 0) {
+                if (r < 15) {
+                    d->eobrun = 1u << r;
+                    if (r) {
+                        d->eobrun += jpg_prog_bits(d, r);
+                    }
+                    break; /* Remaining coefficients are refined below */
+                }
+            } else {
+                if (s != 1) {
+                    return false;
+                }
+                val = jpg_prog_bits(d, 1) ? p1 : -p1;
+            }
+
+            while (k <= se) {
+                int idx = d->keep[k];
+                bool nonzero = (idx >= 0) ? (coef[idx] != 0) : (nz && ((*nz >> k) & 1u));
+                if (nonzero) {
+                    if (jpg_prog_bits(d, 1) && idx >= 0 && (coef[idx] & p1) == 0) {
+                        coef[idx] = (int16_t)(coef[idx] + (coef[idx] >= 0 ? p1 : -p1));
+                    }
+                } else {
+                    if (r == 0) {
+                        if (val) {
+                            if (idx >= 0) {
+                                coef[idx] = (int16_t)val;
+                            } else if (nz) {
+                                *nz |= 1ull << k;
+                            }
+                        }
+                        k++;
+                        break;
+                    }
+                    r--;
+                }
+                k++;
+            }
+        }
+    }
+
+    if (d->eobrun > 0) {
+        for (; k <= se; k++) {
+            int idx = d->keep[k];
+            bool nonzero = (idx >= 0) ? (coef[idx] != 0) : (nz && ((*nz >> k) & 1u));
+            if (nonzero && jpg_prog_bits(d, 1) && idx >= 0 && (coef[idx] & p1) == 0) {
+                coef[idx] = (int16_t)(coef[idx] + (coef[idx] >= 0 ? p1 : -p1));
+            }
+        }
+        d->eobrun--;
+    }
+    return true;
+}
+
+static esp_err_t jpg_prog_output(jpg_prog_dec_t *d, const img_stream_cfg_t *cfg)
+{
+    const unsigned n = d->n;
+    const uint32_t out_w_full = (d->width + (1u << d->scale) - 1u) >> d->scale;
+    const uint32_t out_h_full = (d->height + (1u << d->scale) - 1u) >> d->scale;
+    const uint32_t out_w = out_w_full < cfg->max_w ? out_w_full : cfg->max_w;
+    const uint32_t out_h = out_h_full < cfg->max_h ? out_h_full : cfg->max_h;
+    const uint32_t band_h = d->vmax * n;
+
+    if (cfg->size) {
+        cfg->size(cfg->user, out_w, out_h);
+    }
+
+    /* One MCU row of samples per component, plus the stripes and a row of chroma */
+    size_t plane_bytes = 0;
+    for (unsigned i = 0; i < d->ncomp; i++) {
+        plane_bytes += (size_t)d->comp[i].bw * n * d->comp[i].v * n;
+    }
+    uint8_t *planes = heap_caps_malloc(plane_bytes + 2u * out_w, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint16_t *stripe[2] = {
+        heap_caps_malloc(out_w * band_h * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL),
+        heap_caps_malloc(out_w * band_h * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL),
+    };
+    esp_err_t err = ESP_OK;
+    if (!planes || !stripe[0] || !stripe[1]) {
+        ESP_LOGE(TAG, "Failed to allocate output buffers");
+        err = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    uint8_t *plane[JPG_PROG_MAX_COMP];
+    uint32_t pstride[JPG_PROG_MAX_COMP];
+    uint8_t *p = planes;
+    for (unsigned i = 0; i < d->ncomp; i++) {
+        plane[i] = p;
+        pstride[i] = d->comp[i].bw * n;
+        p += (size_t)pstride[i] * d->comp[i].v * n;
+    }
+    uint8_t *cb_row = p;
+    uint8_t *cr_row = p + out_w;
+    if (d->ncomp == 1) {
+        memset(cb_row, 128, out_w);
+        memset(cr_row, 128, out_w);
+    }
+
+    /* Reduced-size IDCT basis, Q12: T[x][u] = C(u)/2 * cos((2x+1) u pi / 2n) */
+    int32_t basis[8][8];
+    for (unsigned x = 0; x < n; x++) {
+        for (unsigned u = 0; u < n; u++) {
+            float cu = (u == 0) ? 0.70710678f : 1.0f;
+            basis[x][u] = (int32_t)lroundf(4096.0f * 0.5f * cu *
+                                           cosf((float)((2 * x + 1) * u) * 3.14159265f / (float)(2 * n)));
+        }
+    }
+
+    int32_t deq[64];
+    int32_t tmp[64];
+    unsigned cur = 0;
+
+    for (uint32_t my = 0; my < d->mcuy; my++) {
+        const uint32_t top = my * band_h;
+        if (top >= out_h) {
+            break;
+        }
+        if (img_stream_cancelled(cfg)) {
+            err = ESP_FAIL;
+            goto cleanup;
+        }
+
+        for (unsigned i = 0; i < d->ncomp; i++) {
+            const jpg_prog_comp_t *c = &d->comp[i];
+            const uint16_t *q = d->qt[c->tq];
+            for (uint32_t v = 0; v < c->v; v++) {
+                const uint32_t brow = my * c->v + v;
+                for (uint32_t bx = 0; bx < c->bw; bx++) {
+                    const int16_t *coef = c->coef + ((size_t)brow * c->bw + bx) * d->kept;
+                    for (unsigned j = 0; j < d->kept; j++) {
+                        int32_t f = (int32_t)coef[j] * q[d->keep_zz[j]];
+                        deq[j] = f < -4096 ? -4096 : (f > 4095 ? 4095 : f);
+                    }
+                    /* Rows: tmp[v][x] = sum_u T[x][u] F[v][u] (2 fractional bits kept) */
+                    for (unsigned fv = 0; fv < n; fv++) {
+                        for (unsigned x = 0; x < n; x++) {
+                            int32_t acc = 0;
+                            for (unsigned u = 0; u < n; u++) {
+                                acc += basis[x][u] * deq[fv * n + u];
+                            }
+                            tmp[fv * n + x] = (acc + (1 << 9)) >> 10;
+                        }
+                    }
+                    /* Columns, then level shift */
+                    uint8_t *dst = plane[i] + (size_t)v * n * pstride[i] + bx * n;
+                    for (unsigned y = 0; y < n; y++) {
+                        for (unsigned x = 0; x < n; x++) {
+                            int32_t acc = 0;
+                            for (unsigned fv = 0; fv < n; fv++) {
+                                acc += basis[y][fv] * tmp[fv * n + x];
+                            }
+                            dst[y * pstride[i] + x] = jpg_prog_clip8(((acc + (1 << 13)) >> 14) + 128);
+                        }
+                    }
+                }
+            }
+        }
+
+        uint32_t rows = out_h - top < band_h ? out_h - top : band_h;
+        uint16_t *px = stripe[cur];
+        for (uint32_t r = 0; r < rows; r++) {
+            if (d->ncomp == 3) {
+                const uint32_t cy = r * d->comp[1].v / d->vmax;
+                const uint8_t *cbs = plane[1] + cy * pstride[1];
+                const uint8_t *crs = plane[2] + cy * pstride[2];
+                for (uint32_t x = 0; x < out_w; x++) {
+                    const uint32_t cx = x * d->comp[1].h / d->hmax;
+                    cb_row[x] = cbs[cx];
+                    cr_row[x] = crs[cx];
+                }
+            }
+            const uint32_t ly = r * d->comp[0].v / d->vmax;
+            jpg_color_ycc_to_rgb565(plane[0] + ly * pstride[0], cb_row, cr_row, px + r * out_w, out_w);
+        }
+
+        if (!cfg->draw(cfg->user, 0, top, out_w, top + rows, px)) {
+            err = ESP_FAIL;
+            goto cleanup;
+        }
+        cur ^= 1u;
+    }
+
+cleanup:
+    heap_caps_free(planes);
+    heap_caps_free(stripe[0]);
+    heap_caps_free(stripe[1]);
+    return err;
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define SD_BENCH_MAX_RESULTS    32
+#define SD_BENCH_SEQ_BYTES      (4 * 1024 * 1024)   /* File written, then read back, per buffer size */
+#define SD_BENCH_RANDOM_BLOCK   4096                /* Bytes per random read */
+#define SD_BENCH_RANDOM_READS   256                 /* Random reads timed */
+#define SD_BENCH_DIR_FILES      256                 /* Empty files for the directory tests */
+#define SD_BENCH_DIR_PASSES     4                   /* opendir()/readdir() passes over them */
+#define SD_BENCH_SEEK_OPENS     4                   /* open()/close() pairs timed by the seek test */
+#define SD_BENCH_SEEK_SAMPLES   64                  /* Far seeks timed by the seek test */
+#define SD_BENCH_SEEK_READ      512                 /* Bytes read after each seek */
+#define SD_BENCH_SEEK_SMALL     (1 * 1024 * 1024)   /* Extra seek test files, besides the sequential one */
+#define SD_BENCH_SEEK_LARGE     (16 * 1024 * 1024)
+#define SD_BENCH_FRAG_BYTES     (4 * 1024 * 1024)   /* Fragmented seek test file */
+#define SD_BENCH_FRAG_CHUNK     4096                /* Write interleaving that fragments it, at most a cluster */
+
+/**
+ * @brief Kinds of measurement.
+ */
+typedef enum {
+    SD_BENCH_SEQ_WRITE = 0,     /**< Sequential write, MB/s (fsync included) */
+    SD_BENCH_SEQ_READ,          /**< Sequential read, MB/s */
+    SD_BENCH_RANDOM_READ,       /**< SD_BENCH_RANDOM_BLOCK reads at random aligned offsets, IOPS */
+    SD_BENCH_CREATE,            /**< Empty files created, files/s */
+    SD_BENCH_READDIR,           /**< Directory entries listed, entries/s */
+    SD_BENCH_STAT,              /**< stat() latency, us per call */
+    SD_BENCH_DELETE,            /**< Files deleted, files/s */
+    SD_BENCH_OPEN,              /**< Read-only open() of a seek test file (builds the fast-seek map), us per call */
+    SD_BENCH_SEEK,              /**< lseek() between the head and the tail plus a SD_BENCH_SEEK_READ read, us per call */
+    SD_BENCH_SEEK_RW,           /**< Same seeks through a read-write handle, which never gets the map, us per call */
+    SD_BENCH_TEST_COUNT
+} sd_bench_test_t;
+
+/**
+ * @brief One measurement.
+ */
+typedef struct {
+    sd_bench_test_t test;
+    uint32_t block;             /**< Bytes per read()/write(), 0 for the directory tests */
+    uint32_t ops;               /**< Calls (entries for readdir) timed */
+    uint64_t bytes;             /**< Bytes moved; file size for the open and seek tests */
+    bool fragmented;            /**< Open and seek tests: the file was written interleaved with another one */
+    int64_t us;                 /**< Wall time */
+    double value;               /**< Result in sd_bench_unit() */
+} sd_bench_result_t;
+
+/**
+ * @brief Clock and I/O buffer of a run, supplied by the caller.
+ *
+ * The measurement itself only makes POSIX calls; the app's background job
+ * plugs in esp_timer and DMA-capable memory, a host build clock_gettime() and
+ * malloc(), so the same run can be repeated on a FAT image off the device.
+ */
+typedef struct {
+    int64_t (*now_us)(void);            /**< Monotonic clock in microseconds */
+    void *(*alloc)(size_t size);        /**< I/O buffer, ideally one the driver can transfer from directly */
+    void (*free)(void *ptr);            /**< Releases what @c alloc returned */
+} sd_bench_probe_t;
+
+/**
+ * @brief Progress callback of sd_bench_run().
+ *
+ * @param percent Overall progress, 0-100.
+ * @param arg     User argument.
+ *
+ * @return false to stop the run.
+ */
+typedef bool (*sd_bench_progress_cb_t)(uint8_t percent, void *arg);
+
+/**
+ * @brief Name of a test ("seq_write", "readdir", ...), as written to the CSV.
+ */
+const char *sd_bench_test_name(sd_bench_test_t test);
+
+/**
+ * @brief Unit of a test's value ("MB/s", "IOPS", "files/s", "entries/s", "us").
+ */
+const char *sd_bench_unit(sd_bench_test_t test);
+
+/**
+ * @brief Measure the storage mounted under @p dir, blocking until done.
+ *
+ * Sequential write and read of SD_BENCH_SEQ_BYTES with 512 B, 4 KB, 16 KB and
+ * 64 KB buffers, random 4 KB reads, then create, list, stat and delete
+ * SD_BENCH_DIR_FILES empty files. sd_bench_seek() runs on the sequential file,
+ * on SD_BENCH_SEEK_SMALL and SD_BENCH_SEEK_LARGE files written in one go, and
+ * on a SD_BENCH_FRAG_BYTES file written in SD_BENCH_FRAG_CHUNK pieces
+ * alternating with a twin file, so its clusters are scattered. Only POSIX
+ * calls and @p probe are used, so the same run works on the SD card, on a FAT
+ * image (mounted through esp_vfs_fat, or by the host build under host/) or on
+ * a host directory. Everything is created in @p dir and removed afterwards.
+ *
+ * @param dir       Scratch directory; created if missing.
+ * @param probe     Clock and buffer allocator.
+ * @param out       Receives the results.
+ * @param max       Capacity of @p out (SD_BENCH_MAX_RESULTS fits a full run).
+ * @param out_count Receives the number of results, also on failure.
+ * @param cb        Optional progress callback.
+ * @param arg       Passed to @p cb.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG on bad arguments
+ *      - ESP_ERR_NO_MEM if the I/O buffer cannot be allocated
+ *      - ESP_ERR_NOT_FINISHED if @p cb stopped the run
+ *      - ESP_FAIL on an I/O error
+ */
+esp_err_t sd_bench_run(const char *dir, const sd_bench_probe_t *probe, sd_bench_result_t *out, size_t max,
+                       size_t *out_count, sd_bench_progress_cb_t cb, void *arg);
+
+/**
+ * @brief Time far seeks into an existing file.
+ *
+ * FatFs resolves a seek by walking the file's cluster chain from the start (or
+ * from the current position going forward), so without a cluster link map the
+ * cost grows with the file size and its fragmentation. With
+ * CONFIG_FATFS_USE_FASTSEEK the VFS builds that map when a file is opened
+ * read-only (opens get slower, seeks become constant), but never for a
+ * read-write handle. Timing both handles in one build gives the mapped and
+ * the chain-walk cost side by side; on a build without the option they match.
+ * A file with more fragments than CONFIG_FATFS_FAST_SEEK_BUFFER_SIZE can map
+ * falls back to the chain walk on both.
+ *
+ * Times SD_BENCH_SEEK_OPENS read-only opens, then SD_BENCH_SEEK_SAMPLES seeks
+ * alternating between the last and the first quarter of the file, each
+ * followed by a SD_BENCH_SEEK_READ read, first on the read-only handle and
+ * then on a read-write one. Blocks; the file is not modified.
+ *
+ * @param path        File to measure, at least 2 * SD_BENCH_SEEK_READ bytes.
+ * @param probe       Clock (the allocator is not used).
+ * @param out_open    Receives the SD_BENCH_OPEN result.
+ * @param out_seek    Receives the SD_BENCH_SEEK result.
+ * @param out_seek_rw Receives the SD_BENCH_SEEK_RW result.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_SIZE if the file is too small, or ESP_FAIL.
+ */
+esp_err_t sd_bench_seek(const char *path, const sd_bench_probe_t *probe, sd_bench_result_t *out_open,
+                        sd_bench_result_t *out_seek, sd_bench_result_t *out_seek_rw);
+
+/**
+ * @brief Append results to a CSV file, writing the header first if the file is new.
+ *
+ * One row per result: local time, whether FatFs fast seek was built in, test,
+ * block bytes, ops, bytes, microseconds, value, unit and whether the file was
+ * fragmented, so runs on different cards and builds can be compared in a
+ * spreadsheet.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_FAIL if the file cannot be written.
+ */
+esp_err_t sd_bench_write_csv(const char *path, const sd_bench_result_t *results, size_t count);
+
+/**
+ * @brief Run sd_bench_run() on @p dir on a background task.
+ *
+ * Times with esp_timer and reads and writes from DMA-capable memory when
+ * there is some. A run already in progress is stopped first. This and the two
+ * functions below are the target-only part of the benchmark.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on a bad path, ESP_ERR_NO_MEM if the task cannot be created.
+ */
+esp_err_t sd_bench_start(const char *dir);
+
+/**
+ * @brief Collect the results of sd_bench_start() without blocking.
+ *
+ * @param out         Receives the results once the run is over.
+ * @param max         Capacity of @p out.
+ * @param out_count   Receives the number of results once the run is over.
+ * @param out_percent Optional; receives the progress (0-100).
+ *
+ * @return
+ *      - ESP_ERR_NOT_FINISHED while the run is going
+ *      - ESP_ERR_INVALID_STATE if no run was started
+ *      - otherwise the sd_bench_run() result (the run is over)
+ */
+esp_err_t sd_bench_poll(sd_bench_result_t *out, size_t max, size_t *out_count, uint8_t *out_percent);
+
+/**
+ * @brief Cancel a background run and wait for its task to exit (one I/O call at most).
+ *
+ * Safe to call when nothing is running.
+ */
+void sd_bench_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
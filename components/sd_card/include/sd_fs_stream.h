@@ -0,0 +1,75 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Counters collected by the read-ahead LVGL filesystem driver.
+ *
+ * @c read_calls / @c bytes_returned describe what LVGL asked for, while
+ * @c device_reads / @c device_bytes describe what actually hit the SD card.
+ */
+typedef struct {
+    uint32_t read_calls;        /**< read_cb invocations from LVGL */
+    uint64_t bytes_returned;    /**< Bytes handed back to LVGL */
+    uint32_t buffer_hits;       /**< read_cb calls fully served from the read-ahead buffer */
+    uint32_t device_reads;      /**< read() calls issued to the VFS/FatFs layer */
+    uint64_t device_bytes;      /**< Bytes fetched from the card */
+    uint32_t seeks_in_buffer;   /**< Seeks that landed inside the buffered window */
+} sd_fs_stream_stats_t;
+
+/**
+ * @brief Register the read-ahead block stream driver for the LVGL "S:" letter.
+ *
+ * The driver shadows the stock @c lv_fs_stdio driver (LVGL resolves letters
+ * newest-first) and keeps its directory callbacks. File reads go through a
+ * DMA-capable, cluster-aligned buffer of @c CONFIG_SD_FS_STREAM_BUFFER_SIZE
+ * bytes so decoders issuing small reads (tjpgd uses 512 bytes) still reach the
+ * card in large sequential blocks.
+ *
+ * Safe to call more than once; only the first call registers the driver.
+ * Must be called after LVGL is initialized.
+ *
+ * @return
+ *      - ESP_OK on success (or if already registered)
+ *      - ESP_ERR_INVALID_STATE if LVGL's stdio driver for the letter is missing
+ *      - ESP_ERR_TIMEOUT if the display lock could not be taken
+ */
+esp_err_t sd_fs_stream_register(void);
+
+/**
+ * @brief Copy the current driver counters into @p out.
+ *
+ * @param out Destination, must not be NULL.
+ */
+void sd_fs_stream_get_stats(sd_fs_stream_stats_t *out);
+
+/**
+ * @brief Reset all driver counters to zero.
+ */
+void sd_fs_stream_reset_stats(void);
+
+/**
+ * @brief Read @p path end to end through the stock stdio driver and through the
+ *        read-ahead driver using 512-byte requests, and log bytes per device call
+ *        and milliseconds per MB for both.
+ *
+ * Only available when CONFIG_SD_FS_STREAM_BENCHMARK is enabled.
+ *
+ * @param path LVGL path of the file to read (e.g. "S:/bench.jpg").
+ *
+ * @return
+ *      - ESP_OK when both passes completed
+ *      - ESP_ERR_INVALID_STATE if the driver is not registered
+ *      - ESP_ERR_NOT_FOUND if the file cannot be opened
+ *      - ESP_ERR_NO_MEM if the read buffer cannot be allocated
+ */
+esp_err_t sd_fs_stream_run_benchmark(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
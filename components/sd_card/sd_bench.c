@@ -0,0 +1,634 @@
+#include "sd_bench.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#define SD_BENCH_MAX_PATH       256
+#define SD_BENCH_SEQ_NAME       "seq.bin"
+#define SD_BENCH_SEEK_NAME      "seek.bin"
+#define SD_BENCH_TWIN_NAME      "twin.bin"  /* Written alongside the fragmented seek file */
+#define SD_BENCH_DIR_NAME       "files"
+#define SD_BENCH_SEEK_FILES     4           /* Sequential, small, large, fragmented */
+#define SD_BENCH_STAGES         (13 + 3 * SD_BENCH_SEEK_FILES)  /* 4 writes + 4 reads, random, open/seek/seek_rw per file, create, readdir, stat, delete */
+
+typedef struct {
+    const sd_bench_probe_t *probe;
+    sd_bench_progress_cb_t cb;
+    void *arg;
+    uint32_t stage;             /* Stages finished */
+    sd_bench_result_t *out;
+    size_t max;
+    size_t count;
+} sd_bench_run_t;
+
+static const char *TAG = "sd_bench";
+static const uint32_t s_seq_blocks[] = { 512, 4 * 1024, 16 * 1024, 64 * 1024 };
+
+static const char *const s_test_names[SD_BENCH_TEST_COUNT] = {
+    [SD_BENCH_SEQ_WRITE] = "seq_write",
+    [SD_BENCH_SEQ_READ] = "seq_read",
+    [SD_BENCH_RANDOM_READ] = "random_read",
+    [SD_BENCH_CREATE] = "create",
+    [SD_BENCH_READDIR] = "readdir",
+    [SD_BENCH_STAT] = "stat",
+    [SD_BENCH_DELETE] = "delete",
+    [SD_BENCH_OPEN] = "open",
+    [SD_BENCH_SEEK] = "seek",
+    [SD_BENCH_SEEK_RW] = "seek_rw",
+};
+
+static const char *const s_units[SD_BENCH_TEST_COUNT] = {
+    [SD_BENCH_SEQ_WRITE] = "MB/s",
+    [SD_BENCH_SEQ_READ] = "MB/s",
+    [SD_BENCH_RANDOM_READ] = "IOPS",
+    [SD_BENCH_CREATE] = "files/s",
+    [SD_BENCH_READDIR] = "entries/s",
+    [SD_BENCH_STAT] = "us",
+    [SD_BENCH_DELETE] = "files/s",
+    [SD_BENCH_OPEN] = "us",
+    [SD_BENCH_SEEK] = "us",
+    [SD_BENCH_SEEK_RW] = "us",
+};
+
+/**
+ * @brief Report progress within the current stage; returns false once the callback asked to stop.
+ */
+static bool sd_bench_tick(sd_bench_run_t *run, uint64_t done, uint64_t total);
+
+/**
+ * @brief Fill and log a result, deriving its value from the counters and the unit of @p test.
+ */
+static void sd_bench_fill(sd_bench_result_t *r, sd_bench_test_t test, uint32_t block,
+                          uint32_t ops, uint64_t bytes, int64_t us);
+
+/**
+ * @brief Store a result made with sd_bench_fill() and count its stage.
+ */
+static void sd_bench_keep(sd_bench_run_t *run, const sd_bench_result_t *r);
+
+/**
+ * @brief sd_bench_fill() a result and sd_bench_keep() it.
+ */
+static void sd_bench_add(sd_bench_run_t *run, sd_bench_test_t test, uint32_t block,
+                         uint32_t ops, uint64_t bytes, int64_t us);
+
+/**
+ * @brief Write SD_BENCH_SEQ_BYTES to @p path in @p block chunks, then read them back.
+ */
+static esp_err_t sd_bench_seq(sd_bench_run_t *run, const char *path, uint8_t *buf, uint32_t block);
+
+/**
+ * @brief Time SD_BENCH_RANDOM_READS aligned reads spread over the sequential test file.
+ */
+static esp_err_t sd_bench_random(sd_bench_run_t *run, const char *path, uint8_t *buf);
+
+/**
+ * @brief Write @p size bytes to @p path in @p chunk pieces.
+ *
+ * With @p twin set, every chunk is followed by one for @p twin, so the two
+ * files take turns allocating clusters and both end up fragmented.
+ */
+static esp_err_t sd_bench_make_file(sd_bench_run_t *run, const char *path, const char *twin,
+                                    const uint8_t *buf, uint32_t chunk, uint64_t size);
+
+/**
+ * @brief sd_bench_seek() @p path and keep its three results.
+ */
+static esp_err_t sd_bench_seek_file(sd_bench_run_t *run, const char *path, bool fragmented);
+
+/**
+ * @brief Time SD_BENCH_SEEK_SAMPLES far seeks and reads on @p fd, a @p size byte file.
+ */
+static esp_err_t sd_bench_far_seeks(const sd_bench_probe_t *probe, int fd, const char *path, uint64_t size,
+                                    int64_t *out_us);
+
+/**
+ * @brief Create, list, stat and delete SD_BENCH_DIR_FILES empty files in @p dir.
+ */
+static esp_err_t sd_bench_dir(sd_bench_run_t *run, const char *dir);
+
+/**
+ * @brief Remove what an interrupted run may have left in @p dir.
+ */
+static void sd_bench_cleanup(const char *dir);
+
+const char *sd_bench_test_name(sd_bench_test_t test)
+{
+    return (test < SD_BENCH_TEST_COUNT) ? s_test_names[test] : "?";
+}
+
+const char *sd_bench_unit(sd_bench_test_t test)
+{
+    return (test < SD_BENCH_TEST_COUNT) ? s_units[test] : "";
+}
+
+esp_err_t sd_bench_run(const char *dir, const sd_bench_probe_t *probe, sd_bench_result_t *out, size_t max,
+                       size_t *out_count, sd_bench_progress_cb_t cb, void *arg)
+{
+    if (out_count) {
+        *out_count = 0;
+    }
+    if (!dir || dir[0] != '/' || !probe || !probe->now_us || !probe->alloc || !probe->free || !out || !out_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char seq_path[SD_BENCH_MAX_PATH];
+    char seek_path[SD_BENCH_MAX_PATH];
+    char twin_path[SD_BENCH_MAX_PATH];
+    char files_dir[SD_BENCH_MAX_PATH];
+    int ns = snprintf(seq_path, sizeof(seq_path), "%s/%s", dir, SD_BENCH_SEQ_NAME);
+    int nk = snprintf(seek_path, sizeof(seek_path), "%s/%s", dir, SD_BENCH_SEEK_NAME);
+    int nt = snprintf(twin_path, sizeof(twin_path), "%s/%s", dir, SD_BENCH_TWIN_NAME);
+    int nd = snprintf(files_dir, sizeof(files_dir), "%s/%s", dir, SD_BENCH_DIR_NAME);
+    if (ns < 0 || ns >= (int)sizeof(seq_path) || nk < 0 || nk >= (int)sizeof(seek_path) ||
+        nt < 0 || nt >= (int)sizeof(twin_path) || nd < 0 || nd >= (int)sizeof(files_dir) - 6) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (mkdir(dir, 0775) != 0 && errno != EEXIST) {
+        ESP_LOGE(TAG, "mkdir(%s) failed (errno=%d)", dir, errno);
+        return ESP_FAIL;
+    }
+    sd_bench_cleanup(dir);
+
+    uint32_t buf_size = s_seq_blocks[sizeof(s_seq_blocks) / sizeof(s_seq_blocks[0]) - 1];
+    uint8_t *buf = probe->alloc(buf_size);
+    if (!buf) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint32_t i = 0; i < buf_size; ++i) {
+        buf[i] = (uint8_t)(i * 31u);
+    }
+
+    sd_bench_run_t run = {
+        .probe = probe,
+        .cb = cb,
+        .arg = arg,
+        .out = out,
+        .max = max,
+    };
+    esp_err_t err = ESP_OK;
+    for (size_t i = 0; err == ESP_OK && i < sizeof(s_seq_blocks) / sizeof(s_seq_blocks[0]); ++i) {
+        err = sd_bench_seq(&run, seq_path, buf, s_seq_blocks[i]);
+    }
+    if (err == ESP_OK) {
+        err = sd_bench_random(&run, seq_path, buf);
+    }
+    if (err == ESP_OK) {
+        err = sd_bench_seek_file(&run, seq_path, false);
+    }
+    unlink(seq_path);
+
+    /* Seek cost grows with the chain length, so also try a shorter and a longer file */
+    static const uint64_t seek_sizes[] = { SD_BENCH_SEEK_SMALL, SD_BENCH_SEEK_LARGE };
+    for (size_t i = 0; err == ESP_OK && i < sizeof(seek_sizes) / sizeof(seek_sizes[0]); ++i) {
+        err = sd_bench_make_file(&run, seek_path, NULL, buf, buf_size, seek_sizes[i]);
+        if (err == ESP_OK) {
+            err = sd_bench_seek_file(&run, seek_path, false);
+        }
+        unlink(seek_path);
+    }
+    if (err == ESP_OK) {
+        err = sd_bench_make_file(&run, seek_path, twin_path, buf, SD_BENCH_FRAG_CHUNK, SD_BENCH_FRAG_BYTES);
+        if (err == ESP_OK) {
+            err = sd_bench_seek_file(&run, seek_path, true);
+        }
+    }
+    unlink(seek_path);
+    unlink(twin_path);
+    probe->free(buf);
+
+    if (err == ESP_OK) {
+        err = sd_bench_dir(&run, files_dir);
+    }
+    sd_bench_cleanup(dir);
+    rmdir(dir);
+
+    *out_count = run.count;
+    return err;
+}
+
+esp_err_t sd_bench_seek(const char *path, const sd_bench_probe_t *probe, sd_bench_result_t *out_open,
+                        sd_bench_result_t *out_seek, sd_bench_result_t *out_seek_rw)
+{
+    if (!path || !probe || !probe->now_us || !out_open || !out_seek || !out_seek_rw) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int fd = -1;
+    int64_t t0 = probe->now_us();
+    for (uint32_t i = 0; i < SD_BENCH_SEEK_OPENS; ++i) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            ESP_LOGE(TAG, "open(%s) failed (errno=%d)", path, errno);
+            return ESP_FAIL;
+        }
+    }
+    int64_t open_us = probe->now_us() - t0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ESP_LOGE(TAG, "fstat(%s) failed (errno=%d)", path, errno);
+        close(fd);
+        return ESP_FAIL;
+    }
+    uint64_t size = (uint64_t)st.st_size;
+    if (size < 2 * SD_BENCH_SEEK_READ) {
+        close(fd);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int64_t seek_us = 0;
+    esp_err_t err = sd_bench_far_seeks(probe, fd, path, size, &seek_us);
+    close(fd);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    /* The VFS only builds the cluster link map for read-only handles */
+    int64_t seek_rw_us = 0;
+    fd = open(path, O_RDWR);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "open(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    err = sd_bench_far_seeks(probe, fd, path, size, &seek_rw_us);
+    close(fd);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    sd_bench_fill(out_open, SD_BENCH_OPEN, 0, SD_BENCH_SEEK_OPENS, size, open_us);
+    sd_bench_fill(out_seek, SD_BENCH_SEEK, SD_BENCH_SEEK_READ, SD_BENCH_SEEK_SAMPLES, size, seek_us);
+    sd_bench_fill(out_seek_rw, SD_BENCH_SEEK_RW, SD_BENCH_SEEK_READ, SD_BENCH_SEEK_SAMPLES, size, seek_rw_us);
+    return ESP_OK;
+}
+
+esp_err_t sd_bench_write_csv(const char *path, const sd_bench_result_t *results, size_t count)
+{
+    if (!path || (!results && count > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct stat st;
+    bool fresh = (stat(path, &st) != 0 || st.st_size == 0);
+    FILE *f = fopen(path, "a");
+    if (!f) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+
+    char when[24];
+    time_t now = time(NULL);
+    struct tm tm_now;
+    localtime_r(&now, &tm_now);
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm_now);
+
+    int ok = 1;
+    if (fresh) {
+        ok = fprintf(f, "time,fast_seek,test,block_bytes,ops,bytes,us,value,unit,fragmented\n") > 0;
+    }
+#ifdef CONFIG_FATFS_USE_FASTSEEK
+    const int fast_seek = 1;
+#else
+    const int fast_seek = 0;
+#endif
+    for (size_t i = 0; ok && i < count; ++i) {
+        const sd_bench_result_t *r = &results[i];
+        ok = fprintf(f, "%s,%d,%s,%lu,%lu,%llu,%lld,%.3f,%s,%d\n", when, fast_seek, sd_bench_test_name(r->test),
+                     (unsigned long)r->block, (unsigned long)r->ops, (unsigned long long)r->bytes,
+                     (long long)r->us, r->value, sd_bench_unit(r->test), r->fragmented ? 1 : 0) > 0;
+    }
+    if (fclose(f) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        ESP_LOGE(TAG, "Writing %s failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static bool sd_bench_tick(sd_bench_run_t *run, uint64_t done, uint64_t total)
+{
+    if (!run->cb) {
+        return true;
+    }
+    uint64_t pct = (run->stage * 100u + (total ? done * 100u / total : 0)) / SD_BENCH_STAGES;
+    return run->cb((uint8_t)(pct > 100 ? 100 : pct), run->arg);
+}
+
+static void sd_bench_fill(sd_bench_result_t *r, sd_bench_test_t test, uint32_t block,
+                          uint32_t ops, uint64_t bytes, int64_t us)
+{
+    if (us <= 0) {
+        us = 1;
+    }
+
+    r->test = test;
+    r->fragmented = false;
+    r->block = block;
+    r->ops = ops;
+    r->bytes = bytes;
+    r->us = us;
+    switch (test) {
+        case SD_BENCH_SEQ_WRITE:
+        case SD_BENCH_SEQ_READ:
+            r->value = ((double)bytes / (1024.0 * 1024.0)) / ((double)us / 1e6);
+            break;
+        case SD_BENCH_STAT:
+        case SD_BENCH_OPEN:
+        case SD_BENCH_SEEK:
+        case SD_BENCH_SEEK_RW:
+            r->value = ops ? (double)us / ops : 0.0;
+            break;
+        default:
+            r->value = (double)ops / ((double)us / 1e6);
+            break;
+    }
+    ESP_LOGI(TAG, "%-11s %6lu B %8.2f %s", s_test_names[test], (unsigned long)block, r->value, s_units[test]);
+}
+
+static void sd_bench_keep(sd_bench_run_t *run, const sd_bench_result_t *r)
+{
+    run->stage++;
+    if (run->count < run->max) {
+        run->out[run->count++] = *r;
+    }
+}
+
+static void sd_bench_add(sd_bench_run_t *run, sd_bench_test_t test, uint32_t block,
+                         uint32_t ops, uint64_t bytes, int64_t us)
+{
+    sd_bench_result_t r;
+    sd_bench_fill(&r, test, block, ops, bytes, us);
+    sd_bench_keep(run, &r);
+}
+
+static esp_err_t sd_bench_seq(sd_bench_run_t *run, const char *path, uint8_t *buf, uint32_t block)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0664);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "open(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    uint32_t ops = 0;
+    uint64_t done = 0;
+    int64_t t0 = run->probe->now_us();
+    while (done < SD_BENCH_SEQ_BYTES) {
+        if (write(fd, buf, block) != (ssize_t)block) {
+            ESP_LOGE(TAG, "write(%s) failed (errno=%d)", path, errno);
+            close(fd);
+            return ESP_FAIL;
+        }
+        done += block;
+        ops++;
+        if (!sd_bench_tick(run, done, SD_BENCH_SEQ_BYTES)) {
+            close(fd);
+            return ESP_ERR_NOT_FINISHED;
+        }
+    }
+    int synced = fsync(fd);
+    int closed = close(fd);
+    int64_t us = run->probe->now_us() - t0;
+    if (synced != 0 || closed != 0) {
+        ESP_LOGE(TAG, "Flushing %s failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    sd_bench_add(run, SD_BENCH_SEQ_WRITE, block, ops, done, us);
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "open(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+    ops = 0;
+    done = 0;
+    t0 = run->probe->now_us();
+    while (done < SD_BENCH_SEQ_BYTES) {
+        ssize_t r = read(fd, buf, block);
+        if (r <= 0) {
+            ESP_LOGE(TAG, "read(%s) failed (errno=%d)", path, errno);
+            close(fd);
+            return ESP_FAIL;
+        }
+        done += (uint64_t)r;
+        ops++;
+        if (!sd_bench_tick(run, done, SD_BENCH_SEQ_BYTES)) {
+            close(fd);
+            return ESP_ERR_NOT_FINISHED;
+        }
+    }
+    us = run->probe->now_us() - t0;
+    close(fd);
+    sd_bench_add(run, SD_BENCH_SEQ_READ, block, ops, done, us);
+    return ESP_OK;
+}
+
+static esp_err_t sd_bench_random(sd_bench_run_t *run, const char *path, uint8_t *buf)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "open(%s) failed (errno=%d)", path, errno);
+        return ESP_FAIL;
+    }
+
+    const uint32_t slots = SD_BENCH_SEQ_BYTES / SD_BENCH_RANDOM_BLOCK;
+    uint32_t seed = 0x2545F491u;    /* Fixed, so every card sees the same offsets */
+    int64_t t0 = run->probe->now_us();
+    for (uint32_t i = 0; i < SD_BENCH_RANDOM_READS; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        off_t offset = (off_t)((seed >> 8) % slots) * SD_BENCH_RANDOM_BLOCK;
+        if (lseek(fd, offset, SEEK_SET) != offset ||
+            read(fd, buf, SD_BENCH_RANDOM_BLOCK) != SD_BENCH_RANDOM_BLOCK) {
+            ESP_LOGE(TAG, "Random read of %s failed (errno=%d)", path, errno);
+            close(fd);
+            return ESP_FAIL;
+        }
+        if (!sd_bench_tick(run, i + 1, SD_BENCH_RANDOM_READS)) {
+            close(fd);
+            return ESP_ERR_NOT_FINISHED;
+        }
+    }
+    int64_t us = run->probe->now_us() - t0;
+    close(fd);
+    sd_bench_add(run, SD_BENCH_RANDOM_READ, SD_BENCH_RANDOM_BLOCK, SD_BENCH_RANDOM_READS,
+                 (uint64_t)SD_BENCH_RANDOM_READS * SD_BENCH_RANDOM_BLOCK, us);
+    return ESP_OK;
+}
+
+static esp_err_t sd_bench_make_file(sd_bench_run_t *run, const char *path, const char *twin,
+                                    const uint8_t *buf, uint32_t chunk, uint64_t size)
+{
+    int fds[2] = { -1, -1 };
+    const char *paths[2] = { path, twin };
+    size_t nfds = twin ? 2 : 1;
+    esp_err_t err = ESP_OK;
+    for (size_t i = 0; i < nfds; ++i) {
+        fds[i] = open(paths[i], O_WRONLY | O_CREAT | O_TRUNC, 0664);
+        if (fds[i] < 0) {
+            ESP_LOGE(TAG, "open(%s) failed (errno=%d)", paths[i], errno);
+            err = ESP_FAIL;
+        }
+    }
+
+    for (uint64_t done = 0; err == ESP_OK && done < size; done += chunk) {
+        for (size_t i = 0; i < nfds; ++i) {
+            if (write(fds[i], buf, chunk) != (ssize_t)chunk) {
+                ESP_LOGE(TAG, "write(%s) failed (errno=%d)", paths[i], errno);
+                err = ESP_FAIL;
+                break;
+            }
+        }
+        if (err == ESP_OK && !sd_bench_tick(run, done + chunk, size)) {
+            err = ESP_ERR_NOT_FINISHED;
+        }
+    }
+
+    for (size_t i = 0; i < nfds; ++i) {
+        if (fds[i] < 0) {
+            continue;
+        }
+        if ((fsync(fds[i]) != 0 || close(fds[i]) != 0) && err == ESP_OK) {
+            ESP_LOGE(TAG, "Flushing %s failed (errno=%d)", paths[i], errno);
+            err = ESP_FAIL;
+        }
+    }
+    return err;
+}
+
+static esp_err_t sd_bench_seek_file(sd_bench_run_t *run, const char *path, bool fragmented)
+{
+    sd_bench_result_t results[3];
+    esp_err_t err = sd_bench_seek(path, run->probe, &results[0], &results[1], &results[2]);
+    if (err != ESP_OK) {
+        return err;
+    }
+    for (size_t i = 0; i < sizeof(results) / sizeof(results[0]); ++i) {
+        results[i].fragmented = fragmented;
+        sd_bench_keep(run, &results[i]);
+    }
+    return sd_bench_tick(run, 0, 1) ? ESP_OK : ESP_ERR_NOT_FINISHED;
+}
+
+static esp_err_t sd_bench_far_seeks(const sd_bench_probe_t *probe, int fd, const char *path, uint64_t size,
+                                    int64_t *out_us)
+{
+    /* Every seek crosses at least half the file: the tail, then the head, then the tail... */
+    uint8_t buf[SD_BENCH_SEEK_READ];
+    uint64_t quarter = size / 4;
+    uint32_t seed = 0x9E3779B9u;    /* Fixed, so every run and handle sees the same offsets */
+    int64_t t0 = probe->now_us();
+    for (uint32_t i = 0; i < SD_BENCH_SEEK_SAMPLES; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        uint64_t jitter = ((uint64_t)seed * quarter) >> 32;
+        uint64_t offset = (i & 1) ? jitter : size - SD_BENCH_SEEK_READ - jitter;
+        offset &= ~(uint64_t)(SD_BENCH_SEEK_READ - 1);
+        if (lseek(fd, (off_t)offset, SEEK_SET) != (off_t)offset || read(fd, buf, sizeof(buf)) <= 0) {
+            ESP_LOGE(TAG, "Seek in %s failed (errno=%d)", path, errno);
+            return ESP_FAIL;
+        }
+    }
+    *out_us = probe->now_us() - t0;
+    return ESP_OK;
+}
+
+static esp_err_t sd_bench_dir(sd_bench_run_t *run, const char *dir)
+{
+    if (mkdir(dir, 0775) != 0) {
+        ESP_LOGE(TAG, "mkdir(%s) failed (errno=%d)", dir, errno);
+        return ESP_FAIL;
+    }
+
+    char path[SD_BENCH_MAX_PATH];
+    int64_t t0 = run->probe->now_us();
+    for (uint32_t i = 0; i < SD_BENCH_DIR_FILES; ++i) {
+        snprintf(path, sizeof(path), "%s/f%04lu", dir, (unsigned long)i);
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0664);
+        if (fd < 0 || close(fd) != 0) {
+            ESP_LOGE(TAG, "Creating %s failed (errno=%d)", path, errno);
+            return ESP_FAIL;
+        }
+        if (!sd_bench_tick(run, i + 1, SD_BENCH_DIR_FILES)) {
+            return ESP_ERR_NOT_FINISHED;
+        }
+    }
+    sd_bench_add(run, SD_BENCH_CREATE, 0, SD_BENCH_DIR_FILES, 0, run->probe->now_us() - t0);
+
+    uint32_t entries = 0;
+    t0 = run->probe->now_us();
+    for (uint32_t pass = 0; pass < SD_BENCH_DIR_PASSES; ++pass) {
+        DIR *d = opendir(dir);
+        if (!d) {
+            ESP_LOGE(TAG, "opendir(%s) failed (errno=%d)", dir, errno);
+            return ESP_FAIL;
+        }
+        struct dirent *dent = NULL;
+        while ((dent = readdir(d)) != NULL) {
+            if (strcmp(dent->d_name, ".") != 0 && strcmp(dent->d_name, "..") != 0) {
+                entries++;
+            }
+        }
+        closedir(d);
+        if (!sd_bench_tick(run, pass + 1, SD_BENCH_DIR_PASSES)) {
+            return ESP_ERR_NOT_FINISHED;
+        }
+    }
+    sd_bench_add(run, SD_BENCH_READDIR, 0, entries, 0, run->probe->now_us() - t0);
+
+    t0 = run->probe->now_us();
+    for (uint32_t i = 0; i < SD_BENCH_DIR_FILES; ++i) {
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/f%04lu", dir, (unsigned long)i);
+        if (stat(path, &st) != 0) {
+            ESP_LOGE(TAG, "stat(%s) failed (errno=%d)", path, errno);
+            return ESP_FAIL;
+        }
+        if (!sd_bench_tick(run, i + 1, SD_BENCH_DIR_FILES)) {
+            return ESP_ERR_NOT_FINISHED;
+        }
+    }
+    sd_bench_add(run, SD_BENCH_STAT, 0, SD_BENCH_DIR_FILES, 0, run->probe->now_us() - t0);
+
+    t0 = run->probe->now_us();
+    for (uint32_t i = 0; i < SD_BENCH_DIR_FILES; ++i) {
+        snprintf(path, sizeof(path), "%s/f%04lu", dir, (unsigned long)i);
+        if (unlink(path) != 0) {
+            ESP_LOGE(TAG, "unlink(%s) failed (errno=%d)", path, errno);
+            return ESP_FAIL;
+        }
+        if (!sd_bench_tick(run, i + 1, SD_BENCH_DIR_FILES)) {
+            return ESP_ERR_NOT_FINISHED;
+        }
+    }
+    sd_bench_add(run, SD_BENCH_DELETE, 0, SD_BENCH_DIR_FILES, 0, run->probe->now_us() - t0);
+    return ESP_OK;
+}
+
+static void sd_bench_cleanup(const char *dir)
+{
+    char path[SD_BENCH_MAX_PATH];
+    snprintf(path, sizeof(path), "%s/%s", dir, SD_BENCH_SEQ_NAME);
+    unlink(path);
+    snprintf(path, sizeof(path), "%s/%s", dir, SD_BENCH_SEEK_NAME);
+    unlink(path);
+    snprintf(path, sizeof(path), "%s/%s", dir, SD_BENCH_TWIN_NAME);
+    unlink(path);
+    for (uint32_t i = 0; i < SD_BENCH_DIR_FILES; ++i) {
+        snprintf(path, sizeof(path), "%s/%s/f%04lu", dir, SD_BENCH_DIR_NAME, (unsigned long)i);
+        unlink(path);
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, SD_BENCH_DIR_NAME);
+    rmdir(path);
+}
@@ -0,0 +1,139 @@
+#include "sd_bench.h"
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define SD_BENCH_JOB_MAX_PATH   256
+#define SD_BENCH_TASK_STACK     (4 * 1024)
+#define SD_BENCH_TASK_PRIO      (1)         /* Below the LVGL task so the UI stays responsive */
+
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t exited;   /* Given by the worker right before it deletes itself */
+    char dir[SD_BENCH_JOB_MAX_PATH];
+    sd_bench_result_t results[SD_BENCH_MAX_RESULTS];
+    size_t count;
+    esp_err_t err;
+    volatile uint8_t percent;
+    volatile bool done;
+    volatile bool cancel;       /* Polled through the progress callback */
+} sd_bench_job_t;
+
+static const char *TAG = "sd_bench";
+static sd_bench_job_t s_job;
+
+/**
+ * @brief I/O buffer of the background run: DMA-capable when possible, so the driver transfers straight from it.
+ */
+static void *sd_bench_job_alloc(size_t size);
+
+/**
+ * @brief Progress callback of the background run: publishes the percentage and polls the cancel flag.
+ */
+static bool sd_bench_job_progress(uint8_t percent, void *arg);
+
+/**
+ * @brief Background task running sd_bench_run() for sd_bench_start().
+ */
+static void sd_bench_task(void *arg);
+
+esp_err_t sd_bench_start(const char *dir)
+{
+    if (!dir || strlen(dir) >= sizeof(s_job.dir)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sd_bench_stop();
+
+    sd_bench_job_t *job = &s_job;
+    strlcpy(job->dir, dir, sizeof(job->dir));
+    job->exited = xSemaphoreCreateBinary();
+    if (!job->exited) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(sd_bench_task, "sd_bench", SD_BENCH_TASK_STACK,
+                    job, SD_BENCH_TASK_PRIO, &job->task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start the benchmark task");
+        vSemaphoreDelete(job->exited);
+        memset(job, 0, sizeof(*job));
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t sd_bench_poll(sd_bench_result_t *out, size_t max, size_t *out_count, uint8_t *out_percent)
+{
+    sd_bench_job_t *job = &s_job;
+    if (!out || !out_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!job->task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (out_percent) {
+        *out_percent = job->percent;
+    }
+    if (!job->done) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    xSemaphoreTake(job->exited, portMAX_DELAY);
+    esp_err_t err = job->err;
+    size_t count = (job->count < max) ? job->count : max;
+    memcpy(out, job->results, count * sizeof(out[0]));
+    *out_count = count;
+    vSemaphoreDelete(job->exited);
+    memset(job, 0, sizeof(*job));
+    return err;
+}
+
+void sd_bench_stop(void)
+{
+    sd_bench_job_t *job = &s_job;
+    if (!job->task) {
+        return;
+    }
+
+    job->cancel = true;
+    xSemaphoreTake(job->exited, portMAX_DELAY);
+    vSemaphoreDelete(job->exited);
+    memset(job, 0, sizeof(*job));
+}
+
+static void *sd_bench_job_alloc(size_t size)
+{
+    void *buf = heap_caps_malloc(size, MALLOC_CAP_DMA);
+    if (!buf) {
+        buf = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    return buf;
+}
+
+static bool sd_bench_job_progress(uint8_t percent, void *arg)
+{
+    sd_bench_job_t *job = (sd_bench_job_t *)arg;
+    job->percent = percent;
+    return !job->cancel;
+}
+
+static void sd_bench_task(void *arg)
+{
+    static const sd_bench_probe_t probe = {
+        .now_us = esp_timer_get_time,
+        .alloc = sd_bench_job_alloc,
+        .free = heap_caps_free,
+    };
+    sd_bench_job_t *job = (sd_bench_job_t *)arg;
+
+    job->err = sd_bench_run(job->dir, &probe, job->results, SD_BENCH_MAX_RESULTS, &job->count,
+                            sd_bench_job_progress, job);
+    job->done = true;
+
+    xSemaphoreGive(job->exited);
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,471 @@
+#include "sd_fs_stream.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bsp/esp-bsp.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "lvgl.h"
+#include "sdkconfig.h"
+
+#if CONFIG_SD_FS_STREAM_BENCHMARK
+#include "esp_timer.h"
+#endif
+
+#define SD_FS_STREAM_MIN_WINDOW     2048u   /* Window used after a random seek (4 sectors) */
+#define SD_FS_STREAM_BUF_SIZE       ((uint32_t)CONFIG_SD_FS_STREAM_BUFFER_SIZE)
+
+_Static_assert((SD_FS_STREAM_BUF_SIZE & (SD_FS_STREAM_BUF_SIZE - 1u)) == 0,
+               "CONFIG_SD_FS_STREAM_BUFFER_SIZE must be a power of two");
+_Static_assert(SD_FS_STREAM_BUF_SIZE >= SD_FS_STREAM_MIN_WINDOW,
+               "CONFIG_SD_FS_STREAM_BUFFER_SIZE must be at least 2048 bytes");
+
+typedef struct {
+    int fd;
+    lv_fs_mode_t mode;
+    uint32_t size;          /* File size at open time, grown by writes */
+    uint32_t pos;           /* Logical position seen by LVGL */
+    uint32_t fd_pos;        /* Current position of the underlying descriptor */
+    uint8_t *buf;           /* DMA-capable read-ahead buffer (NULL = unbuffered) */
+    uint32_t buf_cap;
+    uint32_t buf_start;     /* File offset of buf[0], 2 KB aligned */
+    uint32_t buf_len;       /* Valid bytes in buf */
+    uint32_t window;        /* Current read-ahead window, grows on sequential access */
+    uint32_t next_seq;      /* Offset a sequential reader would ask for next */
+} sd_fs_stream_file_t;
+
+static const char *TAG = "sd_fs_stream";
+
+static lv_fs_drv_t s_stream_drv;
+static lv_fs_drv_t *s_stdio_drv = NULL;
+static bool s_registered = false;
+static sd_fs_stream_stats_t s_stats;
+
+/**
+ * @brief Open @p path (relative to LV_FS_STDIO_PATH) and allocate the read-ahead buffer.
+ *
+ * Write-only handles are left unbuffered. If the configured buffer size cannot be
+ * allocated from DMA-capable memory the size is halved down to the minimum window,
+ * then the handle falls back to direct reads.
+ */
+static void *sd_fs_stream_open(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode);
+
+/**
+ * @brief Close the descriptor and release the read-ahead buffer.
+ */
+static lv_fs_res_t sd_fs_stream_close(lv_fs_drv_t *drv, void *file_p);
+
+/**
+ * @brief Serve a read from the buffer, refilling it in window-aligned blocks on a miss.
+ *
+ * Requests at least as large as the current window bypass the buffer and land
+ * directly in the caller's memory.
+ */
+static lv_fs_res_t sd_fs_stream_read(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br);
+
+/**
+ * @brief Write through to the descriptor, invalidating any buffered data first.
+ */
+static lv_fs_res_t sd_fs_stream_write(lv_fs_drv_t *drv, void *file_p, const void *buf, uint32_t btw, uint32_t *bw);
+
+/**
+ * @brief Move the logical position only; the card is not touched until the next read.
+ */
+static lv_fs_res_t sd_fs_stream_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos, lv_fs_whence_t whence);
+
+/**
+ * @brief Report the logical position.
+ */
+static lv_fs_res_t sd_fs_stream_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p);
+
+/**
+ * @brief Read up to @p len bytes at @p offset from the descriptor, looping over short reads.
+ *
+ * @return Number of bytes read, or -1 on I/O error.
+ */
+static int32_t sd_fs_stream_device_read(sd_fs_stream_file_t *f, uint32_t offset, uint8_t *dst, uint32_t len);
+
+esp_err_t sd_fs_stream_register(void)
+{
+    if (s_registered) {
+        return ESP_OK;
+    }
+
+    if (!bsp_display_lock(0)) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    s_stdio_drv = lv_fs_get_drv(LV_FS_STDIO_LETTER);
+    if (!s_stdio_drv) {
+        bsp_display_unlock();
+        ESP_LOGE(TAG, "No LVGL stdio driver registered for letter '%c'", LV_FS_STDIO_LETTER);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    lv_fs_drv_init(&s_stream_drv);
+    s_stream_drv.letter = LV_FS_STDIO_LETTER;
+    s_stream_drv.cache_size = 0;                /* Buffering happens in this driver */
+    s_stream_drv.open_cb = sd_fs_stream_open;
+    s_stream_drv.close_cb = sd_fs_stream_close;
+    s_stream_drv.read_cb = sd_fs_stream_read;
+    s_stream_drv.write_cb = sd_fs_stream_write;
+    s_stream_drv.seek_cb = sd_fs_stream_seek;
+    s_stream_drv.tell_cb = sd_fs_stream_tell;
+    s_stream_drv.dir_open_cb = s_stdio_drv->dir_open_cb;
+    s_stream_drv.dir_read_cb = s_stdio_drv->dir_read_cb;
+    s_stream_drv.dir_close_cb = s_stdio_drv->dir_close_cb;
+
+    /* Registered drivers are inserted at the head, so this one shadows lv_fs_stdio */
+    lv_fs_drv_register(&s_stream_drv);
+    s_registered = true;
+
+    bsp_display_unlock();
+
+    ESP_LOGI(TAG, "Read-ahead driver registered for '%c:' (%lu-byte window)",
+             LV_FS_STDIO_LETTER, (unsigned long)SD_FS_STREAM_BUF_SIZE);
+    return ESP_OK;
+}
+
+void sd_fs_stream_get_stats(sd_fs_stream_stats_t *out)
+{
+    if (out) {
+        *out = s_stats;
+    }
+}
+
+void sd_fs_stream_reset_stats(void)
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+}
+
+static void *sd_fs_stream_open(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode)
+{
+    LV_UNUSED(drv);
+
+    int flags = O_RDONLY;
+    if (mode == LV_FS_MODE_WR) {
+        flags = O_WRONLY | O_CREAT | O_TRUNC;
+    } else if (mode == (LV_FS_MODE_WR | LV_FS_MODE_RD)) {
+        flags = O_RDWR;
+    }
+
+    char full[LV_FS_MAX_PATH_LEN];
+    snprintf(full, sizeof(full), LV_FS_STDIO_PATH "%s", path);
+
+    int fd = open(full, flags, 0666);
+    if (fd < 0) {
+        ESP_LOGD(TAG, "open(%s) failed: errno %d", full, errno);
+        return NULL;
+    }
+
+    sd_fs_stream_file_t *f = calloc(1, sizeof(*f));
+    if (!f) {
+        close(fd);
+        return NULL;
+    }
+    f->fd = fd;
+    f->mode = mode;
+    f->window = SD_FS_STREAM_MIN_WINDOW;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+        f->size = (uint32_t)st.st_size;
+    }
+
+    if (mode & LV_FS_MODE_RD) {
+        for (uint32_t cap = SD_FS_STREAM_BUF_SIZE; cap >= SD_FS_STREAM_MIN_WINDOW; cap >>= 1) {
+            f->buf = heap_caps_malloc(cap, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+            if (f->buf) {
+                f->buf_cap = cap;
+                break;
+            }
+        }
+        if (!f->buf) {
+            ESP_LOGW(TAG, "No DMA memory for read-ahead, reading %s unbuffered", full);
+        }
+    }
+
+    return f;
+}
+
+static lv_fs_res_t sd_fs_stream_close(lv_fs_drv_t *drv, void *file_p)
+{
+    LV_UNUSED(drv);
+    sd_fs_stream_file_t *f = file_p;
+
+    int rc = close(f->fd);
+    heap_caps_free(f->buf);
+    free(f);
+    return rc == 0 ? LV_FS_RES_OK : LV_FS_RES_HW_ERR;
+}
+
+static lv_fs_res_t sd_fs_stream_read(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br)
+{
+    LV_UNUSED(drv);
+    sd_fs_stream_file_t *f = file_p;
+    uint8_t *dst = buf;
+    uint32_t done = 0;
+    bool touched_device = false;
+
+    s_stats.read_calls++;
+
+    while (done < btr) {
+        /* Serve whatever is already buffered at the current position */
+        if (f->buf_len && f->pos >= f->buf_start && f->pos < f->buf_start + f->buf_len) {
+            uint32_t off = f->pos - f->buf_start;
+            uint32_t n = f->buf_len - off;
+            if (n > btr - done) {
+                n = btr - done;
+            }
+            memcpy(dst + done, f->buf + off, n);
+            done += n;
+            f->pos += n;
+            continue;
+        }
+
+        if (f->pos >= f->size) {
+            break;  /* EOF */
+        }
+
+        /* Miss: grow the window while the reader stays sequential, shrink it after a jump */
+        if (f->pos == f->next_seq) {
+            if (f->window < f->buf_cap) {
+                f->window <<= 1;
+            }
+        } else {
+            f->window = SD_FS_STREAM_MIN_WINDOW;
+        }
+        if (f->window > f->buf_cap) {
+            f->window = f->buf_cap;
+        }
+        touched_device = true;
+
+        uint32_t want = btr - done;
+        if (!f->buf || want >= f->window) {
+            /* Large request (or no buffer): read straight into the caller's memory */
+            int32_t n = sd_fs_stream_device_read(f, f->pos, dst + done, want);
+            if (n < 0) {
+                *br = done;
+                return LV_FS_RES_HW_ERR;
+            }
+            done += (uint32_t)n;
+            f->pos += (uint32_t)n;
+            break;
+        }
+
+        /*
+         * Refill from the enclosing 2 KB granule up to the next window boundary. Once
+         * the window reaches the buffer size every refill covers exactly one
+         * cluster-aligned block, and the ramp-up never re-reads consumed data.
+         */
+        uint32_t start = f->pos & ~(SD_FS_STREAM_MIN_WINDOW - 1u);
+        uint32_t len = f->window - (start & (f->window - 1u));
+        int32_t n = sd_fs_stream_device_read(f, start, f->buf, len);
+        if (n < 0) {
+            f->buf_len = 0;
+            *br = done;
+            return LV_FS_RES_HW_ERR;
+        }
+        f->buf_start = start;
+        f->buf_len = (uint32_t)n;
+        if (f->pos >= start + f->buf_len) {
+            break;  /* File shrank underneath us */
+        }
+    }
+
+    if (!touched_device && done) {
+        s_stats.buffer_hits++;
+    }
+    s_stats.bytes_returned += done;
+    f->next_seq = f->pos;
+    *br = done;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t sd_fs_stream_write(lv_fs_drv_t *drv, void *file_p, const void *buf, uint32_t btw, uint32_t *bw)
+{
+    LV_UNUSED(drv);
+    sd_fs_stream_file_t *f = file_p;
+
+    f->buf_len = 0;
+    if (f->fd_pos != f->pos) {
+        if (lseek(f->fd, (off_t)f->pos, SEEK_SET) < 0) {
+            *bw = 0;
+            return LV_FS_RES_HW_ERR;
+        }
+        f->fd_pos = f->pos;
+    }
+
+    ssize_t n = write(f->fd, buf, btw);
+    if (n < 0) {
+        *bw = 0;
+        return LV_FS_RES_HW_ERR;
+    }
+    f->pos += (uint32_t)n;
+    f->fd_pos = f->pos;
+    if (f->pos > f->size) {
+        f->size = f->pos;
+    }
+    *bw = (uint32_t)n;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t sd_fs_stream_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos, lv_fs_whence_t whence)
+{
+    LV_UNUSED(drv);
+    sd_fs_stream_file_t *f = file_p;
+
+    switch (whence) {
+        case LV_FS_SEEK_SET:
+            f->pos = pos;
+            break;
+        case LV_FS_SEEK_CUR:
+            f->pos += pos;
+            break;
+        case LV_FS_SEEK_END:
+            f->pos = f->size + pos;
+            break;
+        default:
+            return LV_FS_RES_INV_PARAM;
+    }
+
+    if (f->buf_len && f->pos >= f->buf_start && f->pos < f->buf_start + f->buf_len) {
+        s_stats.seeks_in_buffer++;
+        /* Forward skips inside the window (tjpgd skipping segments) keep the stream sequential */
+        if (f->pos >= f->next_seq) {
+            f->next_seq = f->pos;
+        }
+    }
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t sd_fs_stream_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p)
+{
+    LV_UNUSED(drv);
+    sd_fs_stream_file_t *f = file_p;
+    *pos_p = f->pos;
+    return LV_FS_RES_OK;
+}
+
+static int32_t sd_fs_stream_device_read(sd_fs_stream_file_t *f, uint32_t offset, uint8_t *dst, uint32_t len)
+{
+    if (f->fd_pos != offset) {
+        if (lseek(f->fd, (off_t)offset, SEEK_SET) < 0) {
+            return -1;
+        }
+        f->fd_pos = offset;
+    }
+
+    uint32_t total = 0;
+    while (total < len) {
+        ssize_t n = read(f->fd, dst + total, len - total);
+        if (n < 0) {
+            ESP_LOGE(TAG, "read() failed at %lu: errno %d", (unsigned long)(offset + total), errno);
+            return -1;
+        }
+        s_stats.device_reads++;
+        if (n == 0) {
+            break;
+        }
+        total += (uint32_t)n;
+    }
+    f->fd_pos = offset + total;
+    s_stats.device_bytes += total;
+    return (int32_t)total;
+}
+
+#if CONFIG_SD_FS_STREAM_BENCHMARK
+#define SD_FS_BENCH_CHUNK   512u    /* Same request size tjpgd uses (JD_SZBUF) */
+
+/**
+ * @brief Read a whole file through @p drv in SD_FS_BENCH_CHUNK requests.
+ *
+ * @param drv     Driver whose callbacks are invoked directly.
+ * @param path    Path without the drive letter.
+ * @param chunk   Scratch buffer of SD_FS_BENCH_CHUNK bytes.
+ * @param calls   Incremented once per read_cb call.
+ * @param bytes   Total bytes read.
+ * @param elapsed Elapsed time in microseconds.
+ *
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the file cannot be opened.
+ */
+static esp_err_t sd_fs_bench_pass(lv_fs_drv_t *drv, const char *path, uint8_t *chunk,
+                                  uint32_t *calls, uint64_t *bytes, int64_t *elapsed)
+{
+    void *file = drv->open_cb(drv, path, LV_FS_MODE_RD);
+    if (!file) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    uint32_t br = 0;
+    do {
+        if (drv->read_cb(drv, file, chunk, SD_FS_BENCH_CHUNK, &br) != LV_FS_RES_OK) {
+            break;
+        }
+        (*calls)++;
+        *bytes += br;
+    } while (br == SD_FS_BENCH_CHUNK);
+    *elapsed = esp_timer_get_time() - t0;
+
+    drv->close_cb(drv, file);
+    return ESP_OK;
+}
+
+esp_err_t sd_fs_stream_run_benchmark(const char *path)
+{
+    if (!s_registered || !path) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Accept both "S:/file" and "/file" */
+    const char *rel = (path[0] == LV_FS_STDIO_LETTER && path[1] == ':') ? path + 2 : path;
+
+    uint8_t *chunk = heap_caps_malloc(SD_FS_BENCH_CHUNK, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!chunk) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t stdio_calls = 0;
+    uint64_t stdio_bytes = 0;
+    int64_t stdio_us = 0;
+    esp_err_t err = sd_fs_bench_pass(s_stdio_drv, rel, chunk, &stdio_calls, &stdio_bytes, &stdio_us);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Benchmark file %s cannot be opened", path);
+        heap_caps_free(chunk);
+        return err;
+    }
+
+    uint32_t stream_calls = 0;
+    uint64_t stream_bytes = 0;
+    int64_t stream_us = 0;
+    sd_fs_stream_stats_t before = s_stats;
+    err = sd_fs_bench_pass(&s_stream_drv, rel, chunk, &stream_calls, &stream_bytes, &stream_us);
+    heap_caps_free(chunk);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    const uint32_t dev_reads = s_stats.device_reads - before.device_reads;
+    const uint64_t dev_bytes = s_stats.device_bytes - before.device_bytes;
+    const double mb = (double)stdio_bytes / (1024.0 * 1024.0);
+
+    ESP_LOGI(TAG, "Benchmark %s: %llu bytes in %u-byte requests", path,
+             (unsigned long long)stdio_bytes, SD_FS_BENCH_CHUNK);
+    ESP_LOGI(TAG, "  stdio      : %lu calls, %lu B/call, %.1f ms/MB",
+             (unsigned long)stdio_calls,
+             (unsigned long)(stdio_calls ? stdio_bytes / stdio_calls : 0),
+             mb > 0 ? (double)stdio_us / 1000.0 / mb : 0.0);
+    ESP_LOGI(TAG, "  read-ahead : %lu calls -> %lu device reads, %lu B/device call, %.1f ms/MB",
+             (unsigned long)stream_calls, (unsigned long)dev_reads,
+             (unsigned long)(dev_reads ? dev_bytes / dev_reads : 0),
+             mb > 0 ? (double)stream_us / 1000.0 / mb : 0.0);
+    return ESP_OK;
+}
+#endif
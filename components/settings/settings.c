@@ -17,9 +17,11 @@
 #include "nvs_flash.h"
 #include "esp_log.h"
 #include "nvs.h"
+#include "sdkconfig.h"
 
 #include "calibration_xpt2046.h"
 #include "touch_xpt2046.h"
+#include "sd_bench.h"
 #include "styles.h"
 
 #define SETTINGS_NVS_NS                 "settings"
@@ -44,6 +46,10 @@
 #define SETTINGS_OFF_FADE_MS             500
 #define SETTINGS_UP_FADE_MS              250
 
+#define SETTINGS_BENCH_DIR               CONFIG_SDSPI_MOUNT_POINT "/.storage_bench"   /**< Scratch directory, removed after each run */
+#define SETTINGS_BENCH_CSV               CONFIG_SDSPI_MOUNT_POINT "/storage_bench.csv" /**< Results are appended here */
+#define SETTINGS_BENCH_POLL_MS           250
+
 #define STR_HELPER(x)               #x
 #define STR(x)                      STR_HELPER(x)
 
@@ -102,6 +108,11 @@ typedef struct{
     lv_obj_t *ss_off_seconds_lbl;       /**< Label: "seconds." */
     lv_obj_t *ss_off_after_ta;          /**< Screensaver off delay input (seconds) */
     lv_obj_t *ss_keyboard;              /**< Screensaver numeric keyboard */
+    lv_obj_t *bench_overlay;            /**< Active storage benchmark overlay (NULL when closed) */
+    lv_obj_t *bench_results_lbl;        /**< Benchmark results, one line per measurement */
+    lv_obj_t *bench_status_lbl;         /**< Benchmark progress or CSV status */
+    lv_obj_t *bench_run_btn;            /**< "Run" button, disabled while a run is going */
+    lv_timer_t *bench_timer;            /**< Polls the background run (NULL when idle) */
     settings_t settings;                /**< Information about the current session */
 }settings_ctx_t;
 
@@ -264,6 +275,43 @@ static void settings_apply_screensaver(lv_event_t *e);
  */
 static void settings_close_screensaver(lv_event_t *e);
 
+/**
+ * @brief Open the storage benchmark dialog from settings.
+ *
+ * @param e LVGL event (CLICKED) with user data = settings_ctx_t*.
+ */
+static void settings_storage_bench(lv_event_t *e);
+
+/**
+ * @brief Start a benchmark run on the SD card (see sd_bench_start()) and poll it.
+ *
+ * @param e LVGL event (CLICKED) with user data = settings_ctx_t*.
+ */
+static void settings_on_bench_run(lv_event_t *e);
+
+/**
+ * @brief Timer callback: show progress, then the results, and append them to SETTINGS_BENCH_CSV.
+ *
+ * @param timer LVGL timer with user data = settings_ctx_t*.
+ */
+static void settings_bench_poll_cb(lv_timer_t *timer);
+
+/**
+ * @brief Fill the results label, one line per measurement.
+ *
+ * @param ctx     Active settings context.
+ * @param results Measurements from the run.
+ * @param count   Number of measurements.
+ */
+static void settings_bench_show_results(settings_ctx_t *ctx, const sd_bench_result_t *results, size_t count);
+
+/**
+ * @brief Close the storage benchmark dialog, cancelling a run in progress.
+ *
+ * @param e LVGL event (CLICKED) with user data = settings_ctx_t*.
+ */
+static void settings_close_storage_bench(lv_event_t *e);
+
 /**
  * @brief Background task to run touch calibration and restore UI state.
  *
@@ -1019,6 +1067,16 @@ static void settings_build_screen(settings_ctx_t *ctx)
     lv_label_set_text(calibration_lbl, "Run Calibration");
     lv_obj_center(calibration_lbl);   
 
+    lv_obj_t *bench_button = lv_button_create(settings_list);
+    lv_obj_set_width(bench_button, LV_PCT(100));
+    lv_obj_set_style_radius(bench_button, 8, 0);
+    lv_obj_set_style_pad_all(bench_button, 10, 0);
+    styles_build_button(bench_button);
+    lv_obj_add_event_cb(bench_button, settings_storage_bench, LV_EVENT_CLICKED, ctx);
+    lv_obj_t *bench_lbl = lv_label_create(bench_button);
+    lv_label_set_text(bench_lbl, "Storage Benchmark");
+    lv_obj_center(bench_lbl);
+
     /* Row: Restart + Reset */
     lv_obj_t *row_actions2 = lv_obj_create(settings_list);
     lv_obj_remove_style_all(row_actions2);
@@ -1096,6 +1154,7 @@ static void settings_on_about(lv_event_t *e)
         "Set Date/Time: opens the date/time picker to set clock values (HH:MM MM/DD/YY).",
         "Rotate Screen: rotates the display 90 degrees each time.",
         "Run Calibration: starts the touch calibration wizard and saves the new calibration data. Also offers startup calibration toggle.",
+        "Storage Benchmark: measures the SD card (read/write speed, random reads, seek latency on plain and fragmented files, directory listing, create/delete) and appends the results to storage_bench.csv on the card.",
         "Restart: reboots the device after saving system changes. Note: settings are also saved by simply leaving settings.",
         "Reset: restores and saves screensaver, brightness, rotation and date/time to defaults.",
     };
@@ -2738,6 +2797,10 @@ static void settings_clear_ui_refs(settings_ctx_t *ctx)
     ctx->ss_off_seconds_lbl = NULL;
     ctx->ss_off_after_ta = NULL;
     ctx->ss_keyboard = NULL;
+    ctx->bench_overlay = NULL;
+    ctx->bench_results_lbl = NULL;
+    ctx->bench_status_lbl = NULL;
+    ctx->bench_run_btn = NULL;
 }
 
 static void settings_screensaver(lv_event_t *e)
@@ -3152,3 +3215,220 @@ static void settings_close_screensaver(lv_event_t *e)
         ctx->ss_keyboard = NULL;
     }    
 }
+
+static void settings_storage_bench(lv_event_t *e)
+{
+    settings_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->screen || ctx->bench_overlay)
+    {
+        return;
+    }
+
+    lv_obj_t *overlay = lv_obj_create(lv_layer_top());
+    lv_obj_remove_style_all(overlay);
+    lv_obj_set_size(overlay, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_style_bg_color(overlay, UI_COLOR_BG_DARK, 0);
+    lv_obj_set_style_bg_opa(overlay, LV_OPA_30, 0);
+    lv_obj_add_flag(overlay, LV_OBJ_FLAG_FLOATING | LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_CLICK_FOCUSABLE);
+    ctx->bench_overlay = overlay;
+
+    lv_obj_t *dlg = lv_obj_create(overlay);
+    lv_obj_set_style_radius(dlg, 12, 0);
+    lv_obj_set_style_pad_all(dlg, 8, 0);
+    lv_obj_set_style_pad_gap(dlg, 6, 0);
+    lv_obj_set_style_bg_color(dlg, UI_COLOR_CARD_DARK, 0);
+    lv_obj_set_style_bg_opa(dlg, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(dlg, 2, 0);
+    lv_obj_set_style_border_color(dlg, UI_COLOR_BORDER_DARK, 0);
+    lv_obj_set_size(dlg, LV_PCT(85), LV_PCT(95));
+    lv_obj_set_flex_flow(dlg, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(dlg, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_clear_flag(dlg, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_center(dlg);
+
+    lv_obj_t *title = lv_label_create(dlg);
+    lv_label_set_text(title, "Storage Benchmark");
+    lv_obj_set_style_text_color(title, UI_COLOR_TEXT_DARK, 0);
+
+    lv_obj_t *list = lv_obj_create(dlg);
+    lv_obj_remove_style_all(list);
+    lv_obj_set_width(list, LV_PCT(100));
+    lv_obj_set_flex_grow(list, 1);
+    lv_obj_set_scroll_dir(list, LV_DIR_VER);
+    lv_obj_set_scrollbar_mode(list, LV_SCROLLBAR_MODE_AUTO);
+
+    ctx->bench_results_lbl = lv_label_create(list);
+    lv_label_set_long_mode(ctx->bench_results_lbl, LV_LABEL_LONG_WRAP);
+    lv_obj_set_width(ctx->bench_results_lbl, LV_PCT(100));
+    lv_obj_set_style_text_color(ctx->bench_results_lbl, UI_COLOR_TEXT_DARK, 0);
+    lv_label_set_text(ctx->bench_results_lbl,
+                      "Writes and reads a 4 MB file with 512 B to 64 KB buffers, times random 4 KB reads, "
+                      "then creates, lists, stats and deletes " STR(SD_BENCH_DIR_FILES) " files. "
+                      "Takes a minute or more on slow cards.");
+
+    ctx->bench_status_lbl = lv_label_create(dlg);
+    lv_label_set_long_mode(ctx->bench_status_lbl, LV_LABEL_LONG_WRAP);
+    lv_obj_set_width(ctx->bench_status_lbl, LV_PCT(100));
+    lv_obj_set_style_text_align(ctx->bench_status_lbl, LV_TEXT_ALIGN_CENTER, 0);
+    lv_obj_set_style_text_color(ctx->bench_status_lbl, UI_COLOR_TEXT_DARK, 0);
+    lv_label_set_text(ctx->bench_status_lbl, "Results are appended to " SETTINGS_BENCH_CSV);
+
+    lv_obj_t *row = lv_obj_create(dlg);
+    lv_obj_remove_style_all(row);
+    lv_obj_set_flex_flow(row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_width(row, LV_PCT(100));
+    lv_obj_set_height(row, LV_SIZE_CONTENT);
+    lv_obj_set_style_pad_gap(row, 6, 0);
+
+    lv_obj_t *run_btn = lv_button_create(row);
+    lv_obj_set_flex_grow(run_btn, 1);
+    lv_obj_set_style_radius(run_btn, 8, 0);
+    lv_obj_set_style_pad_all(run_btn, 8, 0);
+    styles_build_button(run_btn);
+    lv_obj_add_event_cb(run_btn, settings_on_bench_run, LV_EVENT_CLICKED, ctx);
+    lv_obj_t *run_lbl = lv_label_create(run_btn);
+    lv_label_set_text(run_lbl, "Run");
+    lv_obj_center(run_lbl);
+    ctx->bench_run_btn = run_btn;
+
+    lv_obj_t *close_btn = lv_button_create(row);
+    lv_obj_set_flex_grow(close_btn, 1);
+    lv_obj_set_style_radius(close_btn, 8, 0);
+    lv_obj_set_style_pad_all(close_btn, 8, 0);
+    styles_build_button(close_btn);
+    lv_obj_add_event_cb(close_btn, settings_close_storage_bench, LV_EVENT_CLICKED, ctx);
+    lv_obj_t *close_lbl = lv_label_create(close_btn);
+    lv_label_set_text(close_lbl, "Close");
+    lv_obj_center(close_lbl);
+}
+
+static void settings_on_bench_run(lv_event_t *e)
+{
+    settings_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->bench_overlay || ctx->bench_timer) {
+        return;
+    }
+
+    esp_err_t err = sd_bench_start(SETTINGS_BENCH_DIR);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start the storage benchmark: (%s)", esp_err_to_name(err));
+        lv_label_set_text_fmt(ctx->bench_status_lbl, "Could not start (%s)", esp_err_to_name(err));
+        return;
+    }
+
+    lv_obj_add_state(ctx->bench_run_btn, LV_STATE_DISABLED);
+    lv_label_set_text(ctx->bench_results_lbl, "");
+    lv_label_set_text(ctx->bench_status_lbl, "Running... 0%");
+    ctx->bench_timer = lv_timer_create(settings_bench_poll_cb, SETTINGS_BENCH_POLL_MS, ctx);
+}
+
+static void settings_bench_poll_cb(lv_timer_t *timer)
+{
+    settings_ctx_t *ctx = lv_timer_get_user_data(timer);
+    sd_bench_result_t results[SD_BENCH_MAX_RESULTS];
+    size_t count = 0;
+    uint8_t percent = 0;
+
+    esp_err_t err = sd_bench_poll(results, SD_BENCH_MAX_RESULTS, &count, &percent);
+    if (err == ESP_ERR_NOT_FINISHED) {
+        lv_label_set_text_fmt(ctx->bench_status_lbl, "Running... %u%%", (unsigned)percent);
+        return;
+    }
+
+    lv_timer_delete(timer);
+    ctx->bench_timer = NULL;
+    lv_obj_remove_state(ctx->bench_run_btn, LV_STATE_DISABLED);
+    settings_bench_show_results(ctx, results, count);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Storage benchmark failed: (%s)", esp_err_to_name(err));
+        lv_label_set_text_fmt(ctx->bench_status_lbl, "Failed (%s). Is the SD card inserted?", esp_err_to_name(err));
+        return;
+    }
+
+    err = sd_bench_write_csv(SETTINGS_BENCH_CSV, results, count);
+    lv_label_set_text(ctx->bench_status_lbl, (err == ESP_OK) ? "Saved to " SETTINGS_BENCH_CSV
+                                                             : "Could not write " SETTINGS_BENCH_CSV);
+}
+
+static void settings_bench_show_results(settings_ctx_t *ctx, const sd_bench_result_t *results, size_t count)
+{
+    char text[SD_BENCH_MAX_RESULTS * 40];
+    size_t len = 0;
+    text[0] = '\0';
+
+    for (size_t i = 0; i < count && len < sizeof(text); i++) {
+        const sd_bench_result_t *r = &results[i];
+        char block[12];
+        if (r->block >= 1024) {
+            snprintf(block, sizeof(block), "%lu KB", (unsigned long)(r->block / 1024));
+        } else {
+            snprintf(block, sizeof(block), "%lu B", (unsigned long)r->block);
+        }
+
+        /* snprintf, not lv_snprintf: LVGL's formatter is built without float support */
+        int n = 0;
+        switch (r->test) {
+            case SD_BENCH_SEQ_WRITE:
+                n = snprintf(text + len, sizeof(text) - len, "Write %s: %.2f MB/s\n", block, r->value);
+                break;
+            case SD_BENCH_SEQ_READ:
+                n = snprintf(text + len, sizeof(text) - len, "Read %s: %.2f MB/s\n", block, r->value);
+                break;
+            case SD_BENCH_RANDOM_READ:
+                n = snprintf(text + len, sizeof(text) - len, "Random %s read: %.0f IOPS\n", block, r->value);
+                break;
+            case SD_BENCH_CREATE:
+                n = snprintf(text + len, sizeof(text) - len, "Create: %.0f files/s\n", r->value);
+                break;
+            case SD_BENCH_READDIR:
+                n = snprintf(text + len, sizeof(text) - len, "List: %.0f entries/s\n", r->value);
+                break;
+            case SD_BENCH_STAT:
+                n = snprintf(text + len, sizeof(text) - len, "Stat: %.0f us\n", r->value);
+                break;
+            case SD_BENCH_DELETE:
+                n = snprintf(text + len, sizeof(text) - len, "Delete: %.0f files/s\n", r->value);
+                break;
+            case SD_BENCH_OPEN:
+                n = snprintf(text + len, sizeof(text) - len, "Open %lu MB%s file: %.0f us\n",
+                             (unsigned long)(r->bytes / (1024 * 1024)), r->fragmented ? " fragmented" : "",
+                             r->value);
+                break;
+            case SD_BENCH_SEEK:
+                n = snprintf(text + len, sizeof(text) - len, "  Far seek + %s read: %.0f us\n", block, r->value);
+                break;
+            case SD_BENCH_SEEK_RW:
+                n = snprintf(text + len, sizeof(text) - len, "  Same, read-write handle: %.0f us\n", r->value);
+                break;
+            default:
+                break;
+        }
+        if (n > 0) {
+            len += (size_t)n;
+        }
+    }
+    if (len > 0 && len < sizeof(text) && text[len - 1] == '\n') {
+        text[len - 1] = '\0';
+    }
+    lv_label_set_text(ctx->bench_results_lbl, text);
+}
+
+static void settings_close_storage_bench(lv_event_t *e)
+{
+    settings_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->bench_overlay) {
+        return;
+    }
+
+    if (ctx->bench_timer) {
+        sd_bench_stop();
+        lv_timer_delete(ctx->bench_timer);
+        ctx->bench_timer = NULL;
+    }
+    lv_obj_del(ctx->bench_overlay);
+    ctx->bench_overlay = NULL;
+    ctx->bench_results_lbl = NULL;
+    ctx->bench_status_lbl = NULL;
+    ctx->bench_run_btn = NULL;
+}
@@ -0,0 +1,356 @@
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "fs_bench.h"
+#include "host_storage.h"
+#include "sd_bench.h"
+
+#define BENCH_MAX_PRESETS       8
+#define BENCH_PATH_MAX          256
+#define BENCH_MOUNT_POINT       "/sdcard"
+
+typedef struct {
+    const char *dir;
+    const char *image;
+    uint32_t format_mb;
+    bool fast_seek;
+    uint32_t sector_us;
+    const char *presets[BENCH_MAX_PRESETS];
+    size_t preset_count;
+    bool slow;
+    bool trees;
+    bool append;
+    bool sd_bench;
+    const char *csv;
+    uint32_t runs;
+} bench_args_t;
+
+static const char *TAG = "fs_bench_host";
+
+static uint32_t s_sector_us;
+static int32_t s_allocs;
+static int64_t s_held_blocks;
+static int64_t s_held_bytes;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+/**
+ * @brief Parse the command line into @p out; false (after printing usage) on a bad argument.
+ */
+static bool bench_parse_args(int argc, char **argv, bench_args_t *out);
+
+/**
+ * @brief Whether @p spec was picked on the command line (everything fast, by default).
+ */
+static bool bench_wants_preset(const bench_args_t *args, const fs_bench_tree_spec_t *spec);
+
+/**
+ * @brief Count steps that failed for a reason other than not applying.
+ */
+static int bench_failures(const fs_bench_result_t *results, size_t count);
+
+/**
+ * @brief Log the image's sector traffic since @p before.
+ */
+static void bench_log_sectors(const char *label, const host_storage_stats_t *before);
+
+/**
+ * @brief Host clock, plus the configured cost of every sector the FAT image moved.
+ */
+static int64_t bench_now_us(void);
+
+static int32_t bench_allocs(void);
+static void bench_heap_held(size_t *blocks, size_t *bytes);
+
+int main(int argc, char **argv)
+{
+    bench_args_t args;
+    if (!bench_parse_args(argc, argv, &args)) {
+        return 2;
+    }
+
+    const char *root = args.dir;
+    if (args.image) {
+        host_storage_set_fast_seek(args.fast_seek);
+        esp_err_t err = host_storage_mount_fat(BENCH_MOUNT_POINT, args.image, args.format_mb);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Mounting %s failed: %s", args.image, esp_err_to_name(err));
+            return 1;
+        }
+        root = BENCH_MOUNT_POINT;
+    }
+    s_sector_us = args.sector_us;
+
+    char scratch[BENCH_PATH_MAX];
+    char sd_scratch[BENCH_PATH_MAX];
+    int len = snprintf(scratch, sizeof(scratch), "%s/.fs_bench", root);
+    int sd_len = snprintf(sd_scratch, sizeof(sd_scratch), "%s/.sd_bench", root);
+    if (len < 0 || (size_t)len >= sizeof(scratch) || sd_len < 0 || (size_t)sd_len >= sizeof(sd_scratch)) {
+        ESP_LOGE(TAG, "Path too long: %s", root);
+        host_storage_unmount();
+        return 2;
+    }
+
+    static const fs_bench_probe_t probe = {
+        .now_us = bench_now_us,
+        .allocs = bench_allocs,
+        .heap_held = bench_heap_held,
+    };
+    static const sd_bench_probe_t sd_probe = {
+        .now_us = bench_now_us,
+        .alloc = malloc,
+        .free = free,
+    };
+
+    size_t count = 0;
+    const fs_bench_tree_spec_t *presets = fs_bench_tree_presets(&count);
+    int failures = 0;
+    for (uint32_t run = 0; run < args.runs; run++) {
+        if (args.runs > 1) {
+            ESP_LOGI(TAG, "Run %" PRIu32 "/%" PRIu32, run + 1, args.runs);
+        }
+        for (size_t i = 0; args.trees && i < count; i++) {
+            if (!bench_wants_preset(&args, &presets[i])) {
+                continue;
+            }
+            host_storage_stats_t before = host_storage_stats();
+            fs_bench_tree_report_t report;
+            esp_err_t err = fs_bench_tree_run(scratch, &presets[i], &probe, &report);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Storage benchmark %s failed: %s", presets[i].name, esp_err_to_name(err));
+                failures++;
+                continue;
+            }
+            fs_bench_tree_log(&report);
+            bench_log_sectors(presets[i].name, &before);
+            failures += bench_failures(report.steps, FS_BENCH_STEP_COUNT);
+        }
+
+        if (args.append) {
+            host_storage_stats_t before = host_storage_stats();
+            fs_bench_append_report_t append;
+            esp_err_t err = fs_bench_append_run(scratch, FS_BENCH_APPEND_RECORDS, FS_BENCH_APPEND_BYTES,
+                                                &probe, &append);
+            if (err == ESP_OK) {
+                fs_bench_append_log(&append);
+                bench_log_sectors("append", &before);
+                failures += bench_failures(append.modes, FS_BENCH_APPEND_MODE_COUNT);
+            } else {
+                ESP_LOGE(TAG, "Append benchmark failed: %s", esp_err_to_name(err));
+                failures++;
+            }
+        }
+
+        if (args.sd_bench) {
+            host_storage_stats_t before = host_storage_stats();
+            sd_bench_result_t results[SD_BENCH_MAX_RESULTS];
+            size_t result_count = 0;
+            esp_err_t err = sd_bench_run(sd_scratch, &sd_probe, results, SD_BENCH_MAX_RESULTS, &result_count,
+                                         NULL, NULL);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "SD benchmark failed: %s", esp_err_to_name(err));
+                failures++;
+            }
+            bench_log_sectors("sd_bench", &before);
+            if (args.csv && result_count > 0 && sd_bench_write_csv(args.csv, results, result_count) != ESP_OK) {
+                failures++;
+            }
+        }
+    }
+
+    rmdir(scratch);
+    host_storage_unmount();
+    if (failures > 0) {
+        ESP_LOGE(TAG, "%d step(s) failed", failures);
+        return 1;
+    }
+    return 0;
+}
+
+void *__wrap_malloc(size_t size)
+{
+    void *ptr = __real_malloc(size);
+    if (ptr) {
+        __atomic_fetch_add(&s_allocs, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&s_held_blocks, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&s_held_bytes, (int64_t)malloc_usable_size(ptr), __ATOMIC_RELAXED);
+    }
+    return ptr;
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    void *ptr = __real_calloc(n, size);
+    if (ptr) {
+        __atomic_fetch_add(&s_allocs, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&s_held_blocks, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&s_held_bytes, (int64_t)malloc_usable_size(ptr), __ATOMIC_RELAXED);
+    }
+    return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    size_t old_bytes = ptr ? malloc_usable_size(ptr) : 0;
+    void *moved = __real_realloc(ptr, size);
+    if (!moved && size > 0) {
+        return NULL;
+    }
+    __atomic_fetch_add(&s_allocs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s_held_blocks, (int64_t)(moved != NULL) - (int64_t)(ptr != NULL), __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s_held_bytes, (int64_t)(moved ? malloc_usable_size(moved) : 0) - (int64_t)old_bytes,
+                       __ATOMIC_RELAXED);
+    return moved;
+}
+
+void __wrap_free(void *ptr)
+{
+    if (ptr) {
+        __atomic_fetch_sub(&s_held_blocks, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_sub(&s_held_bytes, (int64_t)malloc_usable_size(ptr), __ATOMIC_RELAXED);
+    }
+    __real_free(ptr);
+}
+
+static bool bench_parse_args(int argc, char **argv, bench_args_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->fast_seek = true;
+    out->trees = true;
+    out->append = true;
+    out->runs = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool takes_value = true;
+        if (strcmp(arg, "--dir") == 0 && value) {
+            out->dir = value;
+        } else if (strcmp(arg, "--image") == 0 && value) {
+            out->image = value;
+        } else if (strcmp(arg, "--format") == 0 && value) {
+            out->format_mb = (uint32_t)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--sector-us") == 0 && value) {
+            out->sector_us = (uint32_t)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--csv") == 0 && value) {
+            out->csv = value;
+        } else if (strcmp(arg, "--runs") == 0 && value) {
+            out->runs = (uint32_t)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--preset") == 0 && value && out->preset_count < BENCH_MAX_PRESETS) {
+            out->presets[out->preset_count++] = value;
+        } else {
+            takes_value = false;
+            if (strcmp(arg, "--slow") == 0) {
+                out->slow = true;
+            } else if (strcmp(arg, "--no-trees") == 0) {
+                out->trees = false;
+            } else if (strcmp(arg, "--no-append") == 0) {
+                out->append = false;
+            } else if (strcmp(arg, "--sd-bench") == 0) {
+                out->sd_bench = true;
+            } else if (strcmp(arg, "--no-fast-seek") == 0) {
+                out->fast_seek = false;
+            } else {
+                out->runs = 0;
+                break;
+            }
+        }
+        if (takes_value) {
+            i++;
+        }
+    }
+
+    if (out->runs > 0 && (out->dir != NULL) != (out->image != NULL)) {
+        return true;
+    }
+    fprintf(stderr,
+            "usage: %s (--dir PATH | --image FILE [--format MB] [--no-fast-seek]) [--sector-us N]\n"
+            "       [--preset NAME]... [--slow] [--no-trees] [--no-append] [--sd-bench [--csv FILE]] [--runs N]\n"
+            "\n"
+            "  --dir PATH       run in PATH on the host file system\n"
+            "  --image FILE     run on the FAT image FILE, mounted at " BENCH_MOUNT_POINT "\n"
+            "  --format MB      recreate FILE at MB MiB and format it first\n"
+            "  --no-fast-seek   open read-only files without the FatFs cluster map\n"
+            "  --sector-us N    charge N us to the clock per sector the image reads or writes\n"
+            "  --preset NAME    tree preset to run (repeatable; default: all but the slow ones)\n"
+            "  --slow           include the slow presets when none is named\n"
+            "  --no-trees       skip the tree presets\n"
+            "  --no-append      skip the append benchmark\n"
+            "  --sd-bench       also run the SD card benchmark (sd_bench_run())\n"
+            "  --csv FILE       append the SD card benchmark results to FILE\n"
+            "  --runs N         repeat everything N times\n",
+            argv[0]);
+    return false;
+}
+
+static bool bench_wants_preset(const bench_args_t *args, const fs_bench_tree_spec_t *spec)
+{
+    if (args->preset_count == 0) {
+        return !spec->slow || args->slow;
+    }
+    for (size_t i = 0; i < args->preset_count; i++) {
+        if (strcmp(args->presets[i], spec->name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int bench_failures(const fs_bench_result_t *results, size_t count)
+{
+    int failures = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (results[i].err != ESP_OK && results[i].err != ESP_ERR_NOT_SUPPORTED) {
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static void bench_log_sectors(const char *label, const host_storage_stats_t *before)
+{
+    if (!host_storage_fat_available()) {
+        return;
+    }
+    host_storage_stats_t now = host_storage_stats();
+    if (now.sectors_read == 0 && now.sectors_written == 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "%s: %" PRIu64 " sectors read, %" PRIu64 " written, %" PRIu32 " syncs", label,
+             now.sectors_read - before->sectors_read, now.sectors_written - before->sectors_written,
+             now.syncs - before->syncs);
+}
+
+static int64_t bench_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t now = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    if (s_sector_us > 0) {
+        host_storage_stats_t stats = host_storage_stats();
+        now += (int64_t)s_sector_us * (int64_t)(stats.sectors_read + stats.sectors_written);
+    }
+    return now;
+}
+
+static int32_t bench_allocs(void)
+{
+    return __atomic_load_n(&s_allocs, __ATOMIC_RELAXED);
+}
+
+static void bench_heap_held(size_t *blocks, size_t *bytes)
+{
+    *blocks = (size_t)__atomic_load_n(&s_held_blocks, __ATOMIC_RELAXED);
+    *bytes = (size_t)__atomic_load_n(&s_held_bytes, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,273 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define HOST_NVS_MAX_BLOBS      8
+#define HOST_NVS_MAX_KEY        16
+
+typedef struct {
+    char key[HOST_NVS_MAX_KEY];
+    void *data;
+    size_t len;
+} host_nvs_blob_t;
+
+struct host_semaphore {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool available;
+};
+
+static esp_log_level_t s_log_level = ESP_LOG_INFO;
+static host_nvs_blob_t s_nvs[HOST_NVS_MAX_BLOBS];
+
+/**
+ * @brief Blob stored under @p key, or NULL.
+ */
+static host_nvs_blob_t *host_nvs_find(const char *key);
+
+/**
+ * @brief Allocate a semaphore that starts out given (@p available) or taken.
+ */
+static SemaphoreHandle_t host_semaphore_create(bool available);
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_INVALID_CRC: return "ESP_ERR_INVALID_CRC";
+        case ESP_ERR_INVALID_VERSION: return "ESP_ERR_INVALID_VERSION";
+        case ESP_ERR_INVALID_MAC: return "ESP_ERR_INVALID_MAC";
+        case ESP_ERR_NOT_FINISHED: return "ESP_ERR_NOT_FINISHED";
+        case ESP_ERR_NOT_ALLOWED: return "ESP_ERR_NOT_ALLOWED";
+        case ESP_ERR_NVS_NOT_INITIALIZED: return "ESP_ERR_NVS_NOT_INITIALIZED";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_INVALID_LENGTH: return "ESP_ERR_NVS_INVALID_LENGTH";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static const char s_letters[] = "?EWIDV";
+    if (level > s_log_level || level == ESP_LOG_NONE) {
+        return;
+    }
+
+    FILE *out = (level <= ESP_LOG_WARN) ? stderr : stdout;
+    va_list args;
+    va_start(args, format);
+    fprintf(out, "%c (%s) ", s_letters[level], tag);
+    vfprintf(out, format, args);
+    fputc('\n', out);
+    va_end(args);
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    (void)tag;
+    s_log_level = level;
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    while (len-- > 0) {
+        crc ^= *buf++;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    (void)name;
+    (void)open_mode;
+    if (!out_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    (void)handle;
+    if (!key || strlen(key) >= HOST_NVS_MAX_KEY || (!value && length > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    host_nvs_blob_t *blob = host_nvs_find(key);
+    for (size_t i = 0; !blob && i < HOST_NVS_MAX_BLOBS; ++i) {
+        if (s_nvs[i].key[0] == '\0') {
+            blob = &s_nvs[i];
+        }
+    }
+    if (!blob) {
+        return ESP_ERR_NO_MEM;
+    }
+    void *copy = malloc(length ? length : 1);
+    if (!copy) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, value, length);
+    free(blob->data);
+    strlcpy(blob->key, key, sizeof(blob->key));
+    blob->data = copy;
+    blob->len = length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    (void)handle;
+    if (!key || !length) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const host_nvs_blob_t *blob = host_nvs_find(key);
+    if (!blob) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value) {
+        if (*length < blob->len) {
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        memcpy(out_value, blob->data, blob->len);
+    }
+    *length = blob->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return host_semaphore_create(true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return host_semaphore_create(false);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    if (ticks != portMAX_DELAY) {
+        uint64_t ns = (uint64_t)ticks * portTICK_PERIOD_MS * 1000000u + (uint64_t)deadline.tv_nsec;
+        deadline.tv_sec += (time_t)(ns / 1000000000u);
+        deadline.tv_nsec = (long)(ns % 1000000000u);
+    }
+
+    pthread_mutex_lock(&sem->lock);
+    int rc = 0;
+    while (!sem->available && rc != ETIMEDOUT) {
+        rc = (ticks == portMAX_DELAY) ? pthread_cond_wait(&sem->cond, &sem->lock)
+                                      : pthread_cond_timedwait(&sem->cond, &sem->lock, &deadline);
+    }
+    bool taken = sem->available;
+    sem->available = false;
+    pthread_mutex_unlock(&sem->lock);
+    return taken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    pthread_mutex_lock(&sem->lock);
+    bool was_available = sem->available;
+    sem->available = true;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+    return was_available ? pdFALSE : pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    if (!sem) {
+        return;
+    }
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+    free(sem);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    uint64_t ns = (uint64_t)ticks * portTICK_PERIOD_MS * 1000000u;
+    struct timespec ts = { .tv_sec = (time_t)(ns / 1000000000u), .tv_nsec = (long)(ns % 1000000000u) };
+    nanosleep(&ts, NULL);
+}
+
+#ifndef HOST_HAVE_STRLCPY
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = (len < size - 1) ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+size_t strlcat(char *dst, const char *src, size_t size)
+{
+    size_t used = strnlen(dst, size);
+    return used + strlcpy(dst + used, src, size - used);
+}
+#endif
+
+static host_nvs_blob_t *host_nvs_find(const char *key)
+{
+    for (size_t i = 0; i < HOST_NVS_MAX_BLOBS; ++i) {
+        if (s_nvs[i].key[0] != '\0' && strcmp(s_nvs[i].key, key) == 0) {
+            return &s_nvs[i];
+        }
+    }
+    return NULL;
+}
+
+static SemaphoreHandle_t host_semaphore_create(bool available)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+    if (!sem) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->available = available;
+    return sem;
+}
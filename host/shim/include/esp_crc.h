@@ -0,0 +1,16 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_rom_crc.h"
+
+static inline uint32_t esp_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    return esp_rom_crc32_le(crc, buf, len);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,7 @@
+#pragma once
+
+/* Forced into every host translation unit when the C library lacks the BSD string helpers */
+#include <stddef.h>
+
+size_t strlcpy(char *dst, const char *src, size_t size);
+size_t strlcat(char *dst, const char *src, size_t size);
@@ -0,0 +1,23 @@
+#pragma once
+
+/*
+ * Host configuration: the storage options of sdkconfig.defaults, plus the
+ * FatFs settings ESP-IDF's ffconf.h expects.
+ */
+#define CONFIG_FILE_MANAGER_STORAGE_BENCHMARK   1
+#define CONFIG_SDSPI_MOUNT_POINT                "/sdcard"
+
+#define CONFIG_FATFS_VOLUME_COUNT               2
+#define CONFIG_FATFS_CODEPAGE_437               1
+#define CONFIG_FATFS_CODEPAGE                   437
+#define CONFIG_FATFS_LFN_HEAP                   1
+#define CONFIG_FATFS_MAX_LFN                    255
+#define CONFIG_FATFS_API_ENCODING_UTF_8         1
+#define CONFIG_FATFS_SECTOR_512                 1
+#define CONFIG_FATFS_FS_LOCK                    0
+#define CONFIG_FATFS_TIMEOUT_MS                 10000
+#define CONFIG_FATFS_PER_FILE_CACHE             1
+#define CONFIG_FATFS_VFS_FSTAT_BLKSIZE          4096
+#define CONFIG_FATFS_USE_FASTSEEK               1
+#define CONFIG_FATFS_FAST_SEEK_BUFFER_SIZE      512
+#define CONFIG_FATFS_LINK_LOCK                  1
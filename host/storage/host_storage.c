@@ -0,0 +1,887 @@
+#include "host_storage.h"
+
+#include "esp_log.h"
+
+#if HOST_STORAGE_FATFS
+
+/* Built with _GNU_SOURCE for fopencookie() */
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* FatFs names its directory object DIR as well: keep it apart from <dirent.h> */
+#define DIR FF_DIR
+#include "ff.h"
+#include "diskio.h"
+#undef DIR
+#include <dirent.h>
+
+#include "sdkconfig.h"
+
+#define HOST_FAT_FD_BASE        0x40000
+#define HOST_FAT_MAX_FILES      5       /* max_files of the SD card mount */
+#define HOST_FAT_PATH_MAX       512
+#define HOST_FAT_PREFIX_MAX     32
+#define HOST_FAT_SECTOR_SIZE    512
+#define HOST_FAT_AU_SIZE        (16 * 1024)
+#define HOST_FAT_MKFS_WORK      4096
+#define HOST_FAT_DRIVE          "0:"
+
+typedef struct {
+    FIL fil;
+    bool append;
+    DWORD *clmt;
+    FILE *stream;
+} host_fat_file_t;
+
+typedef struct host_fat_dir {
+    FF_DIR dir;
+    struct dirent ent;
+    struct host_fat_dir *next;
+} host_fat_dir_t;
+
+static const char *TAG = "host_storage";
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static FATFS s_fs;
+static int s_image = -1;
+static char s_prefix[HOST_FAT_PREFIX_MAX];
+static bool s_fast_seek = true;
+static host_storage_stats_t s_stats;
+static host_fat_file_t *s_files[HOST_FAT_MAX_FILES];
+static host_fat_dir_t *s_dirs;     /* Open directories: unbounded, like the VFS */
+
+#if FF_MULTI_PARTITION
+/* Volume 0 is the first partition of drive 0, found by f_mount like on the card */
+PARTITION VolToPart[FF_VOLUMES] = { { 0, 0 } };
+#endif
+
+int __real_open(const char *path, int flags, ...);
+int __real_close(int fd);
+ssize_t __real_read(int fd, void *buf, size_t len);
+ssize_t __real_write(int fd, const void *buf, size_t len);
+off_t __real_lseek(int fd, off_t offset, int whence);
+int __real_fsync(int fd);
+int __real_ftruncate(int fd, off_t length);
+int __real_fstat(int fd, struct stat *st);
+int __real_stat(const char *path, struct stat *st);
+int __real_mkdir(const char *path, mode_t mode);
+int __real_rmdir(const char *path);
+int __real_unlink(const char *path);
+int __real_remove(const char *path);
+int __real_rename(const char *src, const char *dst);
+DIR *__real_opendir(const char *path);
+struct dirent *__real_readdir(DIR *dir);
+int __real_closedir(DIR *dir);
+FILE *__real_fopen(const char *path, const char *mode);
+int __real_fileno(FILE *stream);
+
+/**
+ * @brief Map @p path onto the FAT volume.
+ *
+ * @return 1 with the FatFs path in @p out, 0 for a host path, or -1 with errno set.
+ */
+static int host_fat_path(const char *path, char out[HOST_FAT_PATH_MAX]);
+
+/**
+ * @brief Set errno for @p res and return -1.
+ */
+static int host_fat_fail(FRESULT res);
+
+/**
+ * @brief Open file behind a backend descriptor, or NULL (errno EBADF) for any other fd.
+ */
+static host_fat_file_t *host_fat_file(int fd);
+
+/**
+ * @brief Whether @p fd was handed out by this backend.
+ */
+static bool host_fat_is_fd(int fd);
+
+/**
+ * @brief Backend directory behind @p dir, or NULL for a host DIR.
+ */
+static host_fat_dir_t *host_fat_dir(DIR *dir);
+
+/**
+ * @brief Translate open(2) @p flags into an f_open mode.
+ */
+static BYTE host_fat_mode(int flags);
+
+/**
+ * @brief Translate an fopen mode string into open(2) flags, or -1.
+ */
+static int host_fat_stream_flags(const char *mode);
+
+/**
+ * @brief Fill @p st from a FatFs directory entry.
+ */
+static void host_fat_fill_stat(const FILINFO *info, struct stat *st);
+
+static ssize_t host_fat_cookie_read(void *cookie, char *buf, size_t len);
+static ssize_t host_fat_cookie_write(void *cookie, const char *buf, size_t len);
+static int host_fat_cookie_seek(void *cookie, off64_t *offset, int whence);
+static int host_fat_cookie_close(void *cookie);
+
+bool host_storage_fat_available(void)
+{
+    return true;
+}
+
+esp_err_t host_storage_mount_fat(const char *prefix, const char *image, uint32_t format_mb)
+{
+    if (!prefix || prefix[0] != '/' || strlen(prefix) >= sizeof(s_prefix) || !image) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_image >= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int flags = O_RDWR | (format_mb > 0 ? (O_CREAT | O_TRUNC) : 0);
+    s_image = __real_open(image, flags, 0644);
+    if (s_image < 0) {
+        ESP_LOGE(TAG, "open(%s) failed (errno=%d)", image, errno);
+        return ESP_FAIL;
+    }
+    memset(&s_stats, 0, sizeof(s_stats));
+
+    FRESULT res = FR_OK;
+    if (format_mb > 0) {
+        if (__real_ftruncate(s_image, (off_t)format_mb * 1024 * 1024) != 0) {
+            ESP_LOGE(TAG, "sizing %s to %" PRIu32 " MiB failed (errno=%d)", image, format_mb, errno);
+            host_storage_unmount();
+            return ESP_FAIL;
+        }
+        void *work = malloc(HOST_FAT_MKFS_WORK);
+        if (!work) {
+            host_storage_unmount();
+            return ESP_ERR_NO_MEM;
+        }
+        const MKFS_PARM opt = { .fmt = FM_ANY, .au_size = HOST_FAT_AU_SIZE };
+        res = f_mkfs(HOST_FAT_DRIVE, &opt, work, HOST_FAT_MKFS_WORK);
+        free(work);
+        if (res != FR_OK) {
+            ESP_LOGE(TAG, "f_mkfs(%s) failed (%d)", image, (int)res);
+            host_storage_unmount();
+            return ESP_FAIL;
+        }
+    }
+
+    res = f_mount(&s_fs, HOST_FAT_DRIVE, 1);
+    if (res != FR_OK) {
+        ESP_LOGE(TAG, "f_mount(%s) failed (%d)", image, (int)res);
+        host_storage_unmount();
+        return ESP_FAIL;
+    }
+    strlcpy(s_prefix, prefix, sizeof(s_prefix));
+    ESP_LOGI(TAG, "%s mounted at %s (%s)", image, prefix,
+             s_fs.fs_type == FS_FAT32 ? "FAT32" : (s_fs.fs_type == FS_FAT16 ? "FAT16" : "FAT12"));
+    return ESP_OK;
+}
+
+void host_storage_unmount(void)
+{
+    if (s_image < 0) {
+        return;
+    }
+    if (s_prefix[0] != '\0') {
+        f_mount(NULL, HOST_FAT_DRIVE, 0);
+        s_prefix[0] = '\0';
+    }
+    __real_close(s_image);
+    s_image = -1;
+}
+
+void host_storage_set_fast_seek(bool enable)
+{
+    s_fast_seek = enable;
+}
+
+host_storage_stats_t host_storage_stats(void)
+{
+    return s_stats;
+}
+
+int __wrap_open(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, mode_t);
+        va_end(args);
+    }
+
+    char fpath[HOST_FAT_PATH_MAX];
+    int route = host_fat_path(path, fpath);
+    if (route <= 0) {
+        return route < 0 ? -1 : __real_open(path, flags, mode);
+    }
+
+    host_fat_file_t *file = calloc(1, sizeof(*file));
+    if (!file) {
+        errno = ENOMEM;
+        return -1;
+    }
+    FRESULT res = f_open(&file->fil, fpath, host_fat_mode(flags));
+    if (res == FR_OK && (flags & O_TRUNC) && !(flags & O_CREAT)) {
+        res = f_truncate(&file->fil);
+    }
+    if (res != FR_OK) {
+        free(file);
+        return host_fat_fail(res);
+    }
+    file->append = (flags & O_APPEND) != 0;
+
+#if FF_USE_FASTSEEK
+    /* Same as the ESP-IDF VFS: read-only files get a cluster map, and seeks stop walking the FAT */
+    if (s_fast_seek && (flags & O_ACCMODE) == O_RDONLY) {
+        file->clmt = malloc(sizeof(DWORD) * CONFIG_FATFS_FAST_SEEK_BUFFER_SIZE);
+        if (file->clmt) {
+            file->clmt[0] = CONFIG_FATFS_FAST_SEEK_BUFFER_SIZE;
+            file->fil.cltbl = file->clmt;
+            if (f_lseek(&file->fil, CREATE_LINKMAP) != FR_OK) {
+                file->fil.cltbl = NULL;
+                free(file->clmt);
+                file->clmt = NULL;
+            }
+        }
+    }
+#endif
+
+    pthread_mutex_lock(&s_lock);
+    int slot = 0;
+    while (slot < HOST_FAT_MAX_FILES && s_files[slot]) {
+        ++slot;
+    }
+    if (slot < HOST_FAT_MAX_FILES) {
+        s_files[slot] = file;
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    if (slot == HOST_FAT_MAX_FILES) {
+        f_close(&file->fil);
+        free(file->clmt);
+        free(file);
+        errno = ENFILE;
+        return -1;
+    }
+    return HOST_FAT_FD_BASE + slot;
+}
+
+int __wrap_close(int fd)
+{
+    if (!host_fat_is_fd(fd)) {
+        return __real_close(fd);
+    }
+    host_fat_file_t *file = host_fat_file(fd);
+    if (!file) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    s_files[fd - HOST_FAT_FD_BASE] = NULL;
+    pthread_mutex_unlock(&s_lock);
+
+    FRESULT res = f_close(&file->fil);
+    free(file->clmt);
+    free(file);
+    return res == FR_OK ? 0 : host_fat_fail(res);
+}
+
+ssize_t __wrap_read(int fd, void *buf, size_t len)
+{
+    if (!host_fat_is_fd(fd)) {
+        return __real_read(fd, buf, len);
+    }
+    host_fat_file_t *file = host_fat_file(fd);
+    if (!file) {
+        return -1;
+    }
+    UINT done = 0;
+    FRESULT res = f_read(&file->fil, buf, (UINT)len, &done);
+    return res == FR_OK ? (ssize_t)done : host_fat_fail(res);
+}
+
+ssize_t __wrap_write(int fd, const void *buf, size_t len)
+{
+    if (!host_fat_is_fd(fd)) {
+        return __real_write(fd, buf, len);
+    }
+    host_fat_file_t *file = host_fat_file(fd);
+    if (!file) {
+        return -1;
+    }
+    FRESULT res = file->append ? f_lseek(&file->fil, f_size(&file->fil)) : FR_OK;
+    UINT done = 0;
+    if (res == FR_OK) {
+        res = f_write(&file->fil, buf, (UINT)len, &done);
+    }
+    if (res != FR_OK) {
+        return host_fat_fail(res);
+    }
+    if (done == 0 && len > 0) {
+        errno = ENOSPC;
+        return -1;
+    }
+    return (ssize_t)done;
+}
+
+off_t __wrap_lseek(int fd, off_t offset, int whence)
+{
+    if (!host_fat_is_fd(fd)) {
+        return __real_lseek(fd, offset, whence);
+    }
+    host_fat_file_t *file = host_fat_file(fd);
+    if (!file) {
+        return -1;
+    }
+
+    off_t base = 0;
+    switch (whence) {
+        case SEEK_SET: base = 0; break;
+        case SEEK_CUR: base = (off_t)f_tell(&file->fil); break;
+        case SEEK_END: base = (off_t)f_size(&file->fil); break;
+        default: errno = EINVAL; return -1;
+    }
+    off_t target = base + offset;
+    if (target < 0 || target > (off_t)UINT32_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    FRESULT res = f_lseek(&file->fil, (FSIZE_t)target);
+    return res == FR_OK ? target : host_fat_fail(res);
+}
+
+int __wrap_fsync(int fd)
+{
+    if (!host_fat_is_fd(fd)) {
+        return __real_fsync(fd);
+    }
+    host_fat_file_t *file = host_fat_file(fd);
+    if (!file) {
+        return -1;
+    }
+    FRESULT res = f_sync(&file->fil);
+    return res == FR_OK ? 0 : host_fat_fail(res);
+}
+
+int __wrap_ftruncate(int fd, off_t length)
+{
+    if (!host_fat_is_fd(fd)) {
+        return __real_ftruncate(fd, length);
+    }
+    host_fat_file_t *file = host_fat_file(fd);
+    if (!file) {
+        return -1;
+    }
+    if (length < 0 || length > (off_t)UINT32_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    /* f_truncate cuts at the file pointer: move there, cut, then put the pointer back */
+    FSIZE_t pos = f_tell(&file->fil);
+    FRESULT res = f_lseek(&file->fil, (FSIZE_t)length);
+    if (res == FR_OK) {
+        res = f_truncate(&file->fil);
+    }
+    if (res == FR_OK) {
+        res = f_lseek(&file->fil, pos < (FSIZE_t)length ? pos : (FSIZE_t)length);
+    }
+    return res == FR_OK ? 0 : host_fat_fail(res);
+}
+
+int __wrap_fstat(int fd, struct stat *st)
+{
+    if (!host_fat_is_fd(fd)) {
+        return __real_fstat(fd, st);
+    }
+    host_fat_file_t *file = host_fat_file(fd);
+    if (!file) {
+        return -1;
+    }
+    memset(st, 0, sizeof(*st));
+    st->st_mode = S_IFREG | S_IRWXU | S_IRWXG | S_IRWXO;
+    st->st_size = (off_t)f_size(&file->fil);
+    st->st_blksize = CONFIG_FATFS_VFS_FSTAT_BLKSIZE;
+    return 0;
+}
+
+int __wrap_stat(const char *path, struct stat *st)
+{
+    char fpath[HOST_FAT_PATH_MAX];
+    int route = host_fat_path(path, fpath);
+    if (route <= 0) {
+        return route < 0 ? -1 : __real_stat(path, st);
+    }
+
+    /* FatFs has no directory entry for the root */
+    if (strcmp(fpath, HOST_FAT_DRIVE "/") == 0) {
+        memset(st, 0, sizeof(*st));
+        st->st_mode = S_IFDIR | S_IRWXU | S_IRWXG | S_IRWXO;
+        return 0;
+    }
+    FILINFO info;
+    FRESULT res = f_stat(fpath, &info);
+    if (res != FR_OK) {
+        return host_fat_fail(res);
+    }
+    host_fat_fill_stat(&info, st);
+    return 0;
+}
+
+int __wrap_mkdir(const char *path, mode_t mode)
+{
+    char fpath[HOST_FAT_PATH_MAX];
+    int route = host_fat_path(path, fpath);
+    if (route <= 0) {
+        return route < 0 ? -1 : __real_mkdir(path, mode);
+    }
+    FRESULT res = f_mkdir(fpath);
+    return res == FR_OK ? 0 : host_fat_fail(res);
+}
+
+int __wrap_rmdir(const char *path)
+{
+    char fpath[HOST_FAT_PATH_MAX];
+    int route = host_fat_path(path, fpath);
+    if (route <= 0) {
+        return route < 0 ? -1 : __real_rmdir(path);
+    }
+    FRESULT res = f_unlink(fpath);
+    return res == FR_OK ? 0 : host_fat_fail(res);
+}
+
+int __wrap_unlink(const char *path)
+{
+    char fpath[HOST_FAT_PATH_MAX];
+    int route = host_fat_path(path, fpath);
+    if (route <= 0) {
+        return route < 0 ? -1 : __real_unlink(path);
+    }
+    FRESULT res = f_unlink(fpath);
+    return res == FR_OK ? 0 : host_fat_fail(res);
+}
+
+int __wrap_remove(const char *path)
+{
+    char fpath[HOST_FAT_PATH_MAX];
+    int route = host_fat_path(path, fpath);
+    if (route <= 0) {
+        return route < 0 ? -1 : __real_remove(path);
+    }
+    FRESULT res = f_unlink(fpath);
+    return res == FR_OK ? 0 : host_fat_fail(res);
+}
+
+int __wrap_rename(const char *src, const char *dst)
+{
+    char fsrc[HOST_FAT_PATH_MAX];
+    char fdst[HOST_FAT_PATH_MAX];
+    int route_src = host_fat_path(src, fsrc);
+    int route_dst = host_fat_path(dst, fdst);
+    if (route_src < 0 || route_dst < 0) {
+        return -1;
+    }
+    if (route_src == 0 && route_dst == 0) {
+        return __real_rename(src, dst);
+    }
+    if (route_src != route_dst) {
+        errno = EXDEV;
+        return -1;
+    }
+    /* Like the ESP-IDF VFS, an existing target is an error (EEXIST), not replaced */
+    FRESULT res = f_rename(fsrc, fdst);
+    return res == FR_OK ? 0 : host_fat_fail(res);
+}
+
+DIR *__wrap_opendir(const char *path)
+{
+    char fpath[HOST_FAT_PATH_MAX];
+    int route = host_fat_path(path, fpath);
+    if (route <= 0) {
+        return route < 0 ? NULL : __real_opendir(path);
+    }
+
+    host_fat_dir_t *dir = calloc(1, sizeof(*dir));
+    if (!dir) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    FRESULT res = f_opendir(&dir->dir, fpath);
+    if (res != FR_OK) {
+        free(dir);
+        host_fat_fail(res);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    dir->next = s_dirs;
+    s_dirs = dir;
+    pthread_mutex_unlock(&s_lock);
+    return (DIR *)dir;
+}
+
+struct dirent *__wrap_readdir(DIR *handle)
+{
+    host_fat_dir_t *dir = host_fat_dir(handle);
+    if (!dir) {
+        return __real_readdir(handle);
+    }
+
+    FILINFO info;
+    FRESULT res = f_readdir(&dir->dir, &info);
+    if (res != FR_OK) {
+        host_fat_fail(res);
+        return NULL;
+    }
+    if (info.fname[0] == '\0') {
+        return NULL;
+    }
+    dir->ent.d_ino++;
+    dir->ent.d_type = (info.fattrib & AM_DIR) ? DT_DIR : DT_REG;
+    strlcpy(dir->ent.d_name, info.fname, sizeof(dir->ent.d_name));
+    return &dir->ent;
+}
+
+int __wrap_closedir(DIR *handle)
+{
+    host_fat_dir_t *dir = host_fat_dir(handle);
+    if (!dir) {
+        return __real_closedir(handle);
+    }
+
+    pthread_mutex_lock(&s_lock);
+    host_fat_dir_t **link = &s_dirs;
+    while (*link != dir) {
+        link = &(*link)->next;
+    }
+    *link = dir->next;
+    pthread_mutex_unlock(&s_lock);
+
+    FRESULT res = f_closedir(&dir->dir);
+    free(dir);
+    return res == FR_OK ? 0 : host_fat_fail(res);
+}
+
+FILE *__wrap_fopen(const char *path, const char *mode)
+{
+    char fpath[HOST_FAT_PATH_MAX];
+    int route = host_fat_path(path, fpath);
+    if (route <= 0) {
+        return route < 0 ? NULL : __real_fopen(path, mode);
+    }
+
+    int flags = host_fat_stream_flags(mode);
+    if (flags < 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    int fd = __wrap_open(path, flags, 0666);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    static const cookie_io_functions_t s_io = {
+        .read = host_fat_cookie_read,
+        .write = host_fat_cookie_write,
+        .seek = host_fat_cookie_seek,
+        .close = host_fat_cookie_close,
+    };
+    FILE *stream = fopencookie((void *)(intptr_t)fd, mode, s_io);
+    if (!stream) {
+        __wrap_close(fd);
+        return NULL;
+    }
+    host_fat_file(fd)->stream = stream;
+    return stream;
+}
+
+int __wrap_fileno(FILE *stream)
+{
+    pthread_mutex_lock(&s_lock);
+    int fd = -1;
+    for (int slot = 0; slot < HOST_FAT_MAX_FILES && fd < 0; ++slot) {
+        if (s_files[slot] && s_files[slot]->stream == stream) {
+            fd = HOST_FAT_FD_BASE + slot;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return fd >= 0 ? fd : __real_fileno(stream);
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+    return disk_status(pdrv);
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+    return (pdrv == 0 && s_image >= 0) ? 0 : STA_NOINIT;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count)
+{
+    if (pdrv != 0 || s_image < 0) {
+        return RES_NOTRDY;
+    }
+    size_t len = (size_t)count * HOST_FAT_SECTOR_SIZE;
+    if (pread(s_image, buff, len, (off_t)sector * HOST_FAT_SECTOR_SIZE) != (ssize_t)len) {
+        return RES_ERROR;
+    }
+    s_stats.sectors_read += count;
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count)
+{
+    if (pdrv != 0 || s_image < 0) {
+        return RES_NOTRDY;
+    }
+    size_t len = (size_t)count * HOST_FAT_SECTOR_SIZE;
+    if (pwrite(s_image, buff, len, (off_t)sector * HOST_FAT_SECTOR_SIZE) != (ssize_t)len) {
+        return RES_ERROR;
+    }
+    s_stats.sectors_written += count;
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    if (pdrv != 0 || s_image < 0) {
+        return RES_NOTRDY;
+    }
+    struct stat st;
+    switch (cmd) {
+        case CTRL_SYNC:
+            /* Counted, not flushed: the image is scratch, and host fsync would swamp the timings */
+            s_stats.syncs++;
+            return RES_OK;
+        case GET_SECTOR_COUNT:
+            if (__real_fstat(s_image, &st) != 0) {
+                return RES_ERROR;
+            }
+            *(LBA_t *)buff = (LBA_t)(st.st_size / HOST_FAT_SECTOR_SIZE);
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *(WORD *)buff = HOST_FAT_SECTOR_SIZE;
+            return RES_OK;
+        case GET_BLOCK_SIZE:
+            *(DWORD *)buff = 1;
+            return RES_OK;
+        default:
+            return RES_PARERR;
+    }
+}
+
+DWORD get_fattime(void)
+{
+    time_t now = time(NULL);
+    struct tm tm;
+    localtime_r(&now, &tm);
+    return ((DWORD)(tm.tm_year - 80) << 25) | ((DWORD)(tm.tm_mon + 1) << 21) | ((DWORD)tm.tm_mday << 16) |
+           ((DWORD)tm.tm_hour << 11) | ((DWORD)tm.tm_min << 5) | ((DWORD)tm.tm_sec >> 1);
+}
+
+static int host_fat_path(const char *path, char out[HOST_FAT_PATH_MAX])
+{
+    if (!path || s_prefix[0] == '\0') {
+        return 0;
+    }
+    size_t n = strlen(s_prefix);
+    if (strncmp(path, s_prefix, n) != 0 || (path[n] != '\0' && path[n] != '/')) {
+        return 0;
+    }
+    int len = snprintf(out, HOST_FAT_PATH_MAX, HOST_FAT_DRIVE "%s", path[n] ? path + n : "/");
+    if (len < 0 || len >= HOST_FAT_PATH_MAX) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return 1;
+}
+
+static int host_fat_fail(FRESULT res)
+{
+    switch (res) {
+        case FR_NO_FILE:
+        case FR_NO_PATH:
+            errno = ENOENT;
+            break;
+        case FR_EXIST:
+            errno = EEXIST;
+            break;
+        case FR_DENIED:
+            errno = EACCES;
+            break;
+        case FR_INVALID_NAME:
+            errno = EINVAL;
+            break;
+        case FR_TOO_MANY_OPEN_FILES:
+            errno = ENFILE;
+            break;
+        case FR_NOT_ENOUGH_CORE:
+            errno = ENOMEM;
+            break;
+        default:
+            errno = EIO;
+            break;
+    }
+    return -1;
+}
+
+static bool host_fat_is_fd(int fd)
+{
+    return fd >= HOST_FAT_FD_BASE && fd < HOST_FAT_FD_BASE + HOST_FAT_MAX_FILES;
+}
+
+static host_fat_file_t *host_fat_file(int fd)
+{
+    host_fat_file_t *file = host_fat_is_fd(fd) ? s_files[fd - HOST_FAT_FD_BASE] : NULL;
+    if (!file) {
+        errno = EBADF;
+    }
+    return file;
+}
+
+static host_fat_dir_t *host_fat_dir(DIR *dir)
+{
+    pthread_mutex_lock(&s_lock);
+    host_fat_dir_t *found = s_dirs;
+    while (found && (DIR *)found != dir) {
+        found = found->next;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return found;
+}
+
+static BYTE host_fat_mode(int flags)
+{
+    BYTE mode = 0;
+    switch (flags & O_ACCMODE) {
+        case O_RDONLY: mode = FA_READ; break;
+        case O_WRONLY: mode = FA_WRITE; break;
+        default: mode = FA_READ | FA_WRITE; break;
+    }
+    if (flags & O_CREAT) {
+        if (flags & O_EXCL) {
+            mode |= FA_CREATE_NEW;
+        } else if (flags & O_TRUNC) {
+            mode |= FA_CREATE_ALWAYS;
+        } else {
+            mode |= FA_OPEN_ALWAYS;
+        }
+    }
+    return mode;
+}
+
+static int host_fat_stream_flags(const char *mode)
+{
+    int flags;
+    switch (mode[0]) {
+        case 'r': flags = O_RDONLY; break;
+        case 'w': flags = O_WRONLY | O_CREAT | O_TRUNC; break;
+        case 'a': flags = O_WRONLY | O_CREAT | O_APPEND; break;
+        default: return -1;
+    }
+    for (const char *c = mode + 1; *c; ++c) {
+        if (*c == '+') {
+            flags = (flags & ~O_ACCMODE) | O_RDWR;
+        } else if (*c == 'x') {
+            flags |= O_EXCL;
+        }
+    }
+    return flags;
+}
+
+static void host_fat_fill_stat(const FILINFO *info, struct stat *st)
+{
+    memset(st, 0, sizeof(*st));
+    st->st_mode = ((info->fattrib & AM_DIR) ? S_IFDIR : S_IFREG) | S_IRWXU | S_IRWXG | S_IRWXO;
+    st->st_size = (info->fattrib & AM_DIR) ? 0 : (off_t)info->fsize;
+
+    struct tm tm = {
+        .tm_year = ((info->fdate >> 9) & 0x7F) + 80,
+        .tm_mon = ((info->fdate >> 5) & 0x0F) - 1,
+        .tm_mday = info->fdate & 0x1F,
+        .tm_hour = (info->ftime >> 11) & 0x1F,
+        .tm_min = (info->ftime >> 5) & 0x3F,
+        .tm_sec = (info->ftime & 0x1F) * 2,
+        .tm_isdst = -1,
+    };
+    st->st_mtime = mktime(&tm);
+    st->st_atime = st->st_mtime;
+    st->st_ctime = st->st_mtime;
+}
+
+static ssize_t host_fat_cookie_read(void *cookie, char *buf, size_t len)
+{
+    return __wrap_read((int)(intptr_t)cookie, buf, len);
+}
+
+static ssize_t host_fat_cookie_write(void *cookie, const char *buf, size_t len)
+{
+    /* A stream write reports failure as 0, never as a negative count */
+    ssize_t done = __wrap_write((int)(intptr_t)cookie, buf, len);
+    return done < 0 ? 0 : done;
+}
+
+static int host_fat_cookie_seek(void *cookie, off64_t *offset, int whence)
+{
+    off_t pos = __wrap_lseek((int)(intptr_t)cookie, (off_t)*offset, whence);
+    if (pos < 0) {
+        return -1;
+    }
+    *offset = pos;
+    return 0;
+}
+
+static int host_fat_cookie_close(void *cookie)
+{
+    return __wrap_close((int)(intptr_t)cookie);
+}
+
+#else /* !HOST_STORAGE_FATFS */
+
+#include <string.h>
+
+static const char *TAG = "host_storage";
+
+bool host_storage_fat_available(void)
+{
+    return false;
+}
+
+esp_err_t host_storage_mount_fat(const char *prefix, const char *image, uint32_t format_mb)
+{
+    (void)prefix;
+    (void)format_mb;
+    ESP_LOGE(TAG, "cannot mount %s: built without FatFs (configure with IDF_PATH set)", image ? image : "(null)");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void host_storage_unmount(void)
+{
+}
+
+void host_storage_set_fast_seek(bool enable)
+{
+    (void)enable;
+}
+
+host_storage_stats_t host_storage_stats(void)
+{
+    host_storage_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    return stats;
+}
+
+#endif /* HOST_STORAGE_FATFS */
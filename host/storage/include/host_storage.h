@@ -0,0 +1,59 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/**
+ * @brief Sector traffic seen by the FAT image backend since it was mounted.
+ */
+typedef struct {
+    uint64_t sectors_read;
+    uint64_t sectors_written;
+    uint32_t syncs;
+} host_storage_stats_t;
+
+/**
+ * @brief Whether this build carries the FAT image backend (FatFs from ESP-IDF).
+ */
+bool host_storage_fat_available(void);
+
+/**
+ * @brief Serve every path under @p prefix from the FAT image @p image.
+ *
+ * The same FatFs sources the target links are driven over pread/pwrite on the
+ * image with 512-byte sectors, so file, directory and seek behaviour match the
+ * SD card. Paths outside @p prefix still go to the host file system.
+ *
+ * @param prefix    Mount point the storage core sees (e.g. "/sdcard").
+ * @param image     Image file to open.
+ * @param format_mb Non-zero to recreate @p image at this size and format it
+ *                  with the SD card's 16 KiB allocation unit first.
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED without the backend, or ESP_FAIL.
+ */
+esp_err_t host_storage_mount_fat(const char *prefix, const char *image, uint32_t format_mb);
+
+/**
+ * @brief Unmount the FAT image and close it; a no-op when nothing is mounted.
+ */
+void host_storage_unmount(void);
+
+/**
+ * @brief Build the fast-seek cluster map on read-only opens, as the ESP-IDF
+ *        VFS does when CONFIG_FATFS_USE_FASTSEEK is set (the default).
+ */
+void host_storage_set_fast_seek(bool enable);
+
+/**
+ * @brief Snapshot of the sector counters; all zero while nothing is mounted.
+ */
+host_storage_stats_t host_storage_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
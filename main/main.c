@@ -3,26 +3,118 @@
 
 #include "esp_log.h"
 #include "esp_err.h"
+#include "sdkconfig.h"
 
 #include "file_manager.h"
+#include "jpg_color.h"
 #include "settings.h"
 #include "sd_card.h"
+#include "sd_fs_stream.h"
+
+#if CONFIG_FILE_MANAGER_STORAGE_BENCHMARK
+#include <unistd.h>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "fs_bench.h"
+#endif
 
 static char *TAG = "app_main";
 
 #define LOG_MEM_INFO    (0)
 
+#if CONFIG_FILE_MANAGER_STORAGE_BENCHMARK
+#if CONFIG_HEAP_USE_HOOKS
+static uint32_t s_bench_allocs;
+
+/* Heap hook (weak in the heap component): the app owns it, the benchmark only reads the count */
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    (void)ptr;
+    (void)size;
+    (void)caps;
+    __atomic_fetch_add(&s_bench_allocs, 1, __ATOMIC_RELAXED);
+}
+
+static int32_t storage_bench_allocs(void)
+{
+    return (int32_t)__atomic_load_n(&s_bench_allocs, __ATOMIC_RELAXED);
+}
+#endif
+
+static void storage_bench_heap_held(size_t *blocks, size_t *bytes)
+{
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    *blocks = info.allocated_blocks;
+    *bytes = info.total_allocated_bytes;
+}
+
+static void storage_benchmark(void)
+{
+    static const fs_bench_probe_t probe = {
+        .now_us = esp_timer_get_time,
+#if CONFIG_HEAP_USE_HOOKS
+        .allocs = storage_bench_allocs,
+#endif
+        .heap_held = storage_bench_heap_held,
+    };
+
+    size_t count = 0;
+    const fs_bench_tree_spec_t *presets = fs_bench_tree_presets(&count);
+    for (size_t i = 0; i < count; i++) {
+        if (presets[i].slow && !CONFIG_FILE_MANAGER_STORAGE_BENCHMARK_SLOW) {
+            continue;
+        }
+        fs_bench_tree_report_t report;
+        esp_err_t err = fs_bench_tree_run(CONFIG_FILE_MANAGER_STORAGE_BENCHMARK_DIR, &presets[i], &probe, &report);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Storage benchmark %s failed: %s", presets[i].name, esp_err_to_name(err));
+            continue;
+        }
+        fs_bench_tree_log(&report);
+    }
+
+    fs_bench_append_report_t append;
+    esp_err_t err = fs_bench_append_run(CONFIG_FILE_MANAGER_STORAGE_BENCHMARK_DIR, FS_BENCH_APPEND_RECORDS,
+                                        FS_BENCH_APPEND_BYTES, &probe, &append);
+    if (err == ESP_OK) {
+        fs_bench_append_log(&append);
+    } else {
+        ESP_LOGE(TAG, "Append benchmark failed: %s", esp_err_to_name(err));
+    }
+    rmdir(CONFIG_FILE_MANAGER_STORAGE_BENCHMARK_DIR);
+}
+#endif
+
 static void main_task(void *arg)
 {
     ESP_LOGI(TAG, "\n\n ********** LVGL File Display ********** \n");
 
     starting_routine();
 
+    esp_err_t fs_err = sd_fs_stream_register();
+    if (fs_err != ESP_OK) {
+        ESP_LOGW(TAG, "Read-ahead fs driver not registered: %s", esp_err_to_name(fs_err));
+    }
+
+#if CONFIG_JPG_VIEWER_COLOR_BENCHMARK
+    jpg_color_run_benchmark();
+#endif
+
     esp_err_t err = init_sdspi();
     if (err != ESP_OK){
         retry_init_sdspi();
     }    
 
+#if CONFIG_SD_FS_STREAM_BENCHMARK
+    sd_fs_stream_run_benchmark(CONFIG_SD_FS_STREAM_BENCHMARK_FILE);
+#endif
+
+#if CONFIG_FILE_MANAGER_STORAGE_BENCHMARK
+    storage_benchmark();
+#endif
+
     esp_err_t fb_err = file_manager_start();
     if (fb_err != ESP_OK) {
         ESP_LOGE(TAG, "file_manager_start failed: %s (waiting for SD retry)", esp_err_to_name(fb_err));